@@ -27,6 +27,7 @@
 #include "Observability.hpp"
 #include "ObservabilityDialog.hpp"
 
+#include "EphemerisEngine.hpp"
 #include "Planet.hpp"
 #include "SolarSystem.hpp"
 #include "StarMgr.hpp"
@@ -1292,9 +1293,8 @@ void Observability::getSunMoonCoords(StelCore *core, QPair<double, double> JD,
 	} 
 	else // Compute coordinates:
 	{
-		myEarth->computePosition(JD.second);
-		myEarth->computeTransMatrix(JD.first, JD.second);
-		Vec3d earthPos = myEarth->getHeliocentricEclipticPos();
+		// The ephemeris engine leaves the Earth and the Moon untouched.
+		Vec3d earthPos = EphemerisEngine::computeHeliocentricEclipticPos(myEarth, JD.second);
 		double curSidT;
 
 // Sun coordinates:
@@ -1305,9 +1305,7 @@ void Observability::getSunMoonCoords(StelCore *core, QPair<double, double> JD,
 		curSidT = myEarth->getSiderealTime(JD.first, JD.second)/Rad2Deg;
 		RotObserver = (Mat4d::zrotation(curSidT))*ObserverLoc;
 		LocTrans = (StelCore::matVsop87ToJ2000)*(Mat4d::translation(-earthPos));
-		myMoon->computePosition(JD.second);
-		myMoon->computeTransMatrix(JD.first, JD.second);
-		Vec3d moonPos = myMoon->getHeliocentricEclipticPos();
+		Vec3d moonPos = EphemerisEngine::computeHeliocentricEclipticPos(myMoon, JD.second);
 		sunPos = (core->j2000ToEquinoxEqu(LocTrans*moonPos, StelCore::RefractionOff))-RotObserver;
 		
 		eclLon = moonPos[0]*earthPos[1] - moonPos[1]*earthPos[0];
@@ -1334,9 +1332,7 @@ void Observability::getMoonDistance(StelCore *core, QPair<double, double> JD, do
 	} 
 	else
 	{	// Compute coordinates:
-		myEarth->computePosition(JD.second);
-		myEarth->computeTransMatrix(JD.first, JD.second);
-		Vec3d earthPos = myEarth->getHeliocentricEclipticPos();
+		Vec3d earthPos = EphemerisEngine::computeHeliocentricEclipticPos(myEarth, JD.second);
 //		double curSidT;
 
 // Sun coordinates:
@@ -1347,9 +1343,7 @@ void Observability::getMoonDistance(StelCore *core, QPair<double, double> JD, do
 //		curSidT = myEarth->getSiderealTime(JD)/Rad2Deg;
 //		RotObserver = (Mat4d::zrotation(curSidT))*ObserverLoc;
 		LocTrans = (StelCore::matVsop87ToJ2000)*(Mat4d::translation(-earthPos));
-		myMoon->computePosition(JD.second);
-		myMoon->computeTransMatrix(JD.first, JD.second);
-		Pos1 = myMoon->getHeliocentricEclipticPos();
+		Pos1 = EphemerisEngine::computeHeliocentricEclipticPos(myMoon, JD.second);
 		Pos2 = (core->j2000ToEquinoxEqu(LocTrans*Pos1), StelCore::RefractionOff); //-RotObserver;
 
 		distance = std::sqrt(Pos2*Pos2);
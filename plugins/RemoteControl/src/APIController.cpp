@@ -18,6 +18,7 @@
  */
 
 #include "APIController.hpp"
+#include "EventStream.hpp"
 #include "StelApp.hpp"
 #include <QJsonDocument>
 #include <QThread>
@@ -27,7 +28,7 @@ int APIServiceResponse::parametersMetaTypeId = qRegisterMetaType<APIParameters>(
 
 APIController::APIController(int prefixLength, QObject* parent) : HttpRequestHandler(parent), m_prefixLength(prefixLength)
 {
-
+	m_eventStream = new EventStream(this);
 }
 
 APIController::~APIController()
@@ -42,6 +43,7 @@ void APIController::update(double deltaTime)
 	{
 		(*it)->update(deltaTime);
 	}
+	m_eventStream->update();
 }
 
 void APIController::registerService(RemoteControlServiceInterface *service)
@@ -88,6 +90,20 @@ void APIController::service(HttpRequest &request, HttpResponse &response)
 		operation = pathWithoutPrefix.mid(slashIdx+1);
 	}
 
+	//the event stream is served in this thread until the client disconnects,
+	//it does not need the main thread
+	if(serviceString=="stream" && operation.isEmpty())
+	{
+		if(request.getMethod()=="GET")
+			m_eventStream->service(request,response);
+		else
+		{
+			response.setStatus(405,"Method Not allowed");
+			response.write("Method not allowed for the event stream, use GET",true);
+		}
+		return;
+	}
+
 	//try to find service
 	ServiceMap::iterator it = m_serviceMap.find(serviceString);
 	if(it!=m_serviceMap.end())
@@ -23,10 +23,13 @@
 #include "httpserver/httprequesthandler.h"
 #include "AbstractAPIService.hpp"
 
+class EventStream;
+
 //! @ingroup remoteControl
 //! This class handles the API-specific requests and dispatches them to the correct RemoteControlServiceInterface implementation.
 //! Services are registered using registerService().
 //! To see the default services used, see the RequestHandler::RequestHandler constructor.
+//! Requests to the \c stream path are passed to the EventStream.
 class APIController : public HttpRequestHandler
 {
 	Q_OBJECT
@@ -38,7 +41,8 @@ public:
 	virtual ~APIController();
 
 	//! Should be called each frame from the main thread, like from StelModule::update.
-	//! Passed on to each AbstractAPIService::update method for optional processing.
+	//! Passed on to each AbstractAPIService::update method for optional processing,
+	//! then the changes of the frame are published with EventStream::update.
 	void update(double deltaTime);
 
 	//! Handles an API-specific request. It finds out which RemoteControlServiceInterface to use
@@ -52,6 +56,9 @@ public:
 	//! Registers a service with the APIController.
 	//! The RemoteControlServiceInterface::getPath() determines the request path of the service.
 	void registerService(RemoteControlServiceInterface* service);
+
+	//! Returns the EventStream which serves the \c stream path
+	EventStream* getEventStream() const { return m_eventStream; }
 private slots:
 	void performGet(RemoteControlServiceInterface* service, const QByteArray& operation, const APIParameters& parameters, APIServiceResponse* response);
 	void performPost(RemoteControlServiceInterface* service, const QByteArray& operation, const APIParameters& parameters, const QByteArray& data, APIServiceResponse* response);
@@ -60,6 +67,7 @@ private:
 	int m_prefixLength;
 	typedef QMap<QByteArray,RemoteControlServiceInterface*> ServiceMap;
 	ServiceMap m_serviceMap;
+	EventStream* m_eventStream;
 };
 
 #endif
@@ -0,0 +1,57 @@
+/*
+ * Stellarium Remote Control plugin
+ * Copyright (C) 2017 Stellarium Developers
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Suite 500, Boston, MA  02110-1335, USA.
+ */
+
+#ifndef EVENTQUEUE_HPP_
+#define EVENTQUEUE_HPP_
+
+#include <QByteArray>
+#include <QList>
+#include <QQueue>
+
+//! @ingroup remoteControl
+//! The events waiting to be sent to a subscriber of the EventStream.
+//! The queue is bounded: when the client does not read fast enough, the oldest events are dropped,
+//! and the client must get the complete state instead of the remaining events.
+//! It is not thread-safe, EventStream protects the queues with its mutex.
+class EventQueue
+{
+public:
+	EventQueue(int maxSize);
+
+	//! Append an event. When the queue is full, the oldest event is dropped.
+	void enqueue(const QByteArray& event);
+	//! Move all events to the end of events, the oldest first.
+	void takeAll(QList<QByteArray>& events);
+	//! Remove all events, and forget the dropped ones, when the client gets the complete state.
+	void clear();
+
+	//! True if there are events, or events were dropped since the last clear()
+	bool hasChanges() const { return !queue.isEmpty() || dropped>0; }
+	int size() const { return queue.size(); }
+	int getMaxSize() const { return maxSize; }
+	//! Number of events dropped since the last clear()
+	int getDropped() const { return dropped; }
+
+private:
+	QQueue<QByteArray> queue;
+	int maxSize;
+	int dropped;
+};
+
+#endif
@@ -0,0 +1,296 @@
+/*
+ * Stellarium Remote Control plugin
+ * Copyright (C) 2017 Stellarium Developers
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Suite 500, Boston, MA  02110-1335, USA.
+ */
+
+#include "EventStream.hpp"
+#include "httpserver/httprequest.h"
+#include "httpserver/httpresponse.h"
+
+#include "StelApp.hpp"
+#include "StelActionMgr.hpp"
+#include "StelCore.hpp"
+#include "StelObjectMgr.hpp"
+#include "StelPropertyMgr.hpp"
+
+#include <QDateTime>
+#include <QElapsedTimer>
+#include <QJsonDocument>
+
+EventStream::EventStream(QObject *parent)
+	: QObject(parent),
+	  lastTimeUpdate(0),
+	  lastEventId(0),
+	  maxSubscribers(0),
+	  closed(true)
+{
+	actionMgr = StelApp::getInstance().getStelActionManager();
+	core = StelApp::getInstance().getCore();
+	objMgr = &StelApp::getInstance().getStelObjectMgr();
+	propMgr = StelApp::getInstance().getStelPropertyManager();
+
+	connect(actionMgr,SIGNAL(actionToggled(QString,bool)),this,SLOT(actionToggled(QString,bool)));
+	connect(propMgr,SIGNAL(stelPropertyChanged(StelProperty*,QVariant)),this,SLOT(propertyChanged(StelProperty*,QVariant)));
+}
+
+void EventStream::open(int maxSubscribers)
+{
+	//collect the complete state again, the plugins may have added actions and properties
+	state = State();
+	foreach(StelAction* ac, actionMgr->getActionList())
+	{
+		if(ac->isCheckable())
+			state.actions.insert(ac->getId(),ac->isChecked());
+	}
+	const StelPropertyMgr::StelPropertyMap& map = propMgr->getPropertyMap();
+	for(StelPropertyMgr::StelPropertyMap::const_iterator it = map.constBegin();it!=map.constEnd();++it)
+	{
+		state.properties.insert(it.key(), QJsonValue::fromVariant((*it)->getValue()));
+	}
+	pendingActions = QJsonObject();
+	pendingProperties = QJsonObject();
+
+	const QList<StelObjectP>& selected = objMgr->getSelectedObject();
+	lastSelected = selected.isEmpty() ? StelObjectP() : selected.first();
+	state.selection = getSelection();
+	state.time = getTime();
+	lastTimeUpdate = QDateTime::currentMSecsSinceEpoch();
+
+	QMutexLocker locker(&mutex);
+	publishedState = state;
+	this->maxSubscribers = maxSubscribers;
+	closed = false;
+}
+
+void EventStream::close()
+{
+	QMutexLocker locker(&mutex);
+	closed = true;
+	eventsAvailable.wakeAll();
+}
+
+void EventStream::actionToggled(const QString &id, bool val)
+{
+	//only the last value of each frame is sent
+	pendingActions.insert(id,val);
+}
+
+void EventStream::propertyChanged(StelProperty *prop, const QVariant &val)
+{
+	pendingProperties.insert(prop->getId(),QJsonValue::fromVariant(val));
+}
+
+void EventStream::update()
+{
+	QJsonObject changes;
+
+	//skip the values which were changed back during the frame
+	QJsonObject actions;
+	for(QJsonObject::const_iterator it = pendingActions.constBegin();it!=pendingActions.constEnd();++it)
+	{
+		if(state.actions.value(it.key())!=it.value())
+		{
+			state.actions.insert(it.key(),it.value());
+			actions.insert(it.key(),it.value());
+		}
+	}
+	pendingActions = QJsonObject();
+	if(!actions.isEmpty())
+		changes.insert("actions",actions);
+
+	QJsonObject properties;
+	for(QJsonObject::const_iterator it = pendingProperties.constBegin();it!=pendingProperties.constEnd();++it)
+	{
+		if(state.properties.value(it.key())!=it.value())
+		{
+			state.properties.insert(it.key(),it.value());
+			properties.insert(it.key(),it.value());
+		}
+	}
+	pendingProperties = QJsonObject();
+	if(!properties.isEmpty())
+		changes.insert("properties",properties);
+
+	const QList<StelObjectP>& selected = objMgr->getSelectedObject();
+	const StelObjectP obj = selected.isEmpty() ? StelObjectP() : selected.first();
+	if(obj!=lastSelected)
+	{
+		lastSelected = obj;
+		state.selection = getSelection();
+		changes.insert("selection",state.selection);
+	}
+
+	//the clients advance the time with the time rate themselves,
+	//so it is only sent when it does not run as they expect
+	const qint64 now = QDateTime::currentMSecsSinceEpoch();
+	const double timeRate = core->getTimeRate();
+	const double expectedJD = state.time.value("jday").toDouble() + state.time.value("timerate").toDouble() * (now-lastTimeUpdate) / 1000.0;
+	if(timeRate!=state.time.value("timerate").toDouble()
+	   || core->getIsTimeNow()!=state.time.value("isTimeNow").toBool()
+	   || qAbs(core->getJD()-expectedJD)>StelCore::JD_SECOND)
+	{
+		state.time = getTime();
+		lastTimeUpdate = now;
+		changes.insert("time",state.time);
+	}
+
+	if(changes.isEmpty())
+		return;
+
+	//serialize the event once for all subscribers
+	const qint64 id = lastEventId+1;
+	const QByteArray event = createEvent("change",id,changes);
+
+	QMutexLocker locker(&mutex);
+	publishedState = state;
+	lastEventId = id;
+	foreach(EventQueue* queue, subscribers)
+		queue->enqueue(event);
+	eventsAvailable.wakeAll();
+}
+
+void EventStream::service(HttpRequest &request, HttpResponse &response)
+{
+	Q_UNUSED(request);
+
+	EventQueue queue(MaxQueueSize);
+	{
+		QMutexLocker locker(&mutex);
+		if(closed || subscribers.size()>=maxSubscribers)
+		{
+			response.setStatus(503,"Service Unavailable");
+			response.write("Too many event stream clients",true);
+			return;
+		}
+		subscribers.append(&queue);
+	}
+
+	//a client which does not read must not block this thread in write()
+	response.setWriteTimeout(WriteTimeout);
+	response.setHeader("Content-Type","text/event-stream; charset=utf-8");
+	//the delay [ms] after which the client reconnects when the connection is lost
+	response.write("retry: 2000\n\n");
+
+	bool sendState = true;
+	QElapsedTimer lastWrite, lastProgress;
+	lastWrite.start();
+	lastProgress.start();
+	qint64 lastPending = 0;
+	forever
+	{
+		//pass the buffered data on to the TCP stack without blocking,
+		//and hold back the events while the client does not read them
+		response.flush();
+		const qint64 pending = response.bytesToWrite();
+		const bool writable = pending<=MaxPendingBytes;
+		if(pending<lastPending || pending==0)
+			lastProgress.restart();
+		lastPending = pending;
+
+		State snapshot;
+		qint64 snapshotId = -1;
+		QList<QByteArray> events;
+		{
+			QMutexLocker locker(&mutex);
+			if(!closed && (!writable || (!sendState && !queue.hasChanges())))
+				eventsAvailable.wait(&mutex, writable ? KeepAliveInterval : 100);
+			if(closed)
+				break;
+			if(writable)
+			{
+				if(sendState || queue.getDropped())
+				{
+					//the state replaces all older events
+					snapshot = publishedState;
+					snapshotId = lastEventId;
+					queue.clear();
+					sendState = false;
+				}
+				else
+					queue.takeAll(events);
+			}
+		}
+
+		if(!response.isConnected())
+			break;
+		if(!writable && lastProgress.elapsed()>StallTimeout)
+		{
+			qDebug()<<"[EventStream] Client does not read events, disconnecting";
+			break;
+		}
+
+		//serialize the state outside of the lock, to not block the main thread
+		if(snapshotId>=0)
+			events.prepend(createStateEvent(snapshot,snapshotId));
+		foreach(const QByteArray& event, events)
+			response.write(event);
+		if(!events.isEmpty())
+			lastWrite.restart();
+		else if(lastWrite.elapsed()>=KeepAliveInterval)
+		{
+			response.write(": keep-alive\n\n");
+			lastWrite.restart();
+		}
+	}
+
+	QMutexLocker locker(&mutex);
+	subscribers.removeOne(&queue);
+}
+
+QJsonObject EventStream::getTime() const
+{
+	QJsonObject obj;
+	obj.insert("jday",core->getJD());
+	obj.insert("timerate",core->getTimeRate());
+	obj.insert("isTimeNow",core->getIsTimeNow());
+	return obj;
+}
+
+QJsonObject EventStream::getSelection() const
+{
+	QJsonObject obj;
+	if(lastSelected)
+	{
+		obj.insert("name",lastSelected->getEnglishName());
+		obj.insert("localizedName",lastSelected->getNameI18n());
+		obj.insert("type",lastSelected->getType());
+	}
+	return obj;
+}
+
+QByteArray EventStream::createEvent(const QByteArray &type, qint64 id, const QJsonObject &obj)
+{
+	//compact JSON has no line breaks, so it fits into a single data line
+	QByteArray event("id: ");
+	event.append(QByteArray::number(id));
+	event.append("\nevent: ");
+	event.append(type);
+	event.append("\ndata: ");
+	event.append(QJsonDocument(obj).toJson(QJsonDocument::Compact));
+	event.append("\n\n");
+	return event;
+}
+
+QByteArray EventStream::createStateEvent(const State &state, qint64 id)
+{
+	QJsonObject obj;
+	obj.insert("actions",state.actions);
+	obj.insert("properties",state.properties);
+	obj.insert("time",state.time);
+	obj.insert("selection",state.selection);
+	return createEvent("state",id,obj);
+}
@@ -0,0 +1,125 @@
+/*
+ * Stellarium Remote Control plugin
+ * Copyright (C) 2017 Stellarium Developers
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Suite 500, Boston, MA  02110-1335, USA.
+ */
+
+#ifndef EVENTSTREAM_HPP_
+#define EVENTSTREAM_HPP_
+
+#include "EventQueue.hpp"
+#include "StelObjectType.hpp"
+
+#include <QJsonObject>
+#include <QMutex>
+#include <QObject>
+#include <QWaitCondition>
+
+class HttpRequest;
+class HttpResponse;
+class StelActionMgr;
+class StelCore;
+class StelObjectMgr;
+class StelProperty;
+class StelPropertyMgr;
+
+//! @ingroup remoteControl
+//! Pushes the changes of StelActions, StelProperties, the time and the selection to the web clients as
+//! <a href="https://html.spec.whatwg.org/multipage/server-sent-events.html">Server-Sent Events</a>,
+//! so that they do not have to poll the \c status operation of the MainService.
+//!
+//! The changes are collected in the main thread. Once per frame, update() coalesces them into a single event,
+//! which is serialized once and appended to the queue of each subscriber. A subscriber is an HTTP worker thread
+//! which waits in service() for events and writes them to its client, without ever calling into the main thread.
+//! The queues are bounded: when a client does not read fast enough, the oldest events are dropped, and the client
+//! gets the complete current state instead of the remaining events, see EventQueue. A client which does not read
+//! at all is disconnected, so that it does not block its worker thread.
+//!
+//! @see @ref rcEventStream
+class EventStream : public QObject
+{
+	Q_OBJECT
+public:
+	//! Must be constructed in the main thread
+	EventStream(QObject* parent = Q_NULLPTR);
+
+	//! Called in the main thread each frame. Publishes the changes since the last frame to all subscribers.
+	void update();
+
+	//! Serves a subscriber: sends the current state, then the events of each frame with changes,
+	//! until the client disconnects or close() is called.
+	//! @note This method runs in an HTTP worker thread, which it blocks while the client is connected.
+	void service(HttpRequest& request, HttpResponse& response);
+
+	//! Accepts at most maxSubscribers clients. Each of them blocks an HTTP worker thread.
+	void open(int maxSubscribers);
+	//! Disconnects all subscribers and rejects new ones. Must be called before the HTTP server is stopped,
+	//! because the server waits for its worker threads.
+	void close();
+
+	//! Maximal number of events in the queue of a subscriber
+	static const int MaxQueueSize = 64;
+	//! Interval [ms] of the comments sent to an idle client, to find out whether it is still connected
+	static const int KeepAliveInterval = 15000;
+	//! Maximal number of bytes waiting to be sent to a client before the events of its queue are held back
+	static const int MaxPendingBytes = 16384;
+	//! Maximal time [ms] a client may not read anything before it is disconnected
+	static const int StallTimeout = 30000;
+	//! Maximal time [ms] a write to a client may wait for the output buffer, before the client is disconnected
+	static const int WriteTimeout = 2000;
+
+private slots:
+	void actionToggled(const QString& id, bool val);
+	void propertyChanged(StelProperty* prop, const QVariant& val);
+
+private:
+	//! The complete state sent to new subscribers
+	struct State
+	{
+		QJsonObject actions;
+		QJsonObject properties;
+		QJsonObject time;
+		QJsonObject selection;
+	};
+
+	QJsonObject getTime() const;
+	QJsonObject getSelection() const;
+	static QByteArray createEvent(const QByteArray& type, qint64 id, const QJsonObject& obj);
+	static QByteArray createStateEvent(const State& state, qint64 id);
+
+	StelActionMgr* actionMgr;
+	StelCore* core;
+	StelObjectMgr* objMgr;
+	StelPropertyMgr* propMgr;
+
+	// Only used in the main thread
+	State state;
+	QJsonObject pendingActions;
+	QJsonObject pendingProperties;
+	StelObjectP lastSelected;
+	qint64 lastTimeUpdate; //[ms]
+
+	// Shared with the subscribers, protected by mutex
+	QMutex mutex;
+	QWaitCondition eventsAvailable;
+	State publishedState;
+	qint64 lastEventId;
+	QList<EventQueue*> subscribers;
+	int maxSubscribers;
+	bool closed;
+};
+
+#endif
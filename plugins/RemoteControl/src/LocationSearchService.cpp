@@ -41,8 +41,8 @@ void LocationSearchService::mainLocationManagerUpdated()
 {
 	//this is run in the main thread
 	locMgrMutex.lock();
-	//copy the contents of the location manager
-	locMgr.setLocations(StelApp::getInstance().getLocationMgr().getAll());
+	//copy the contents of the location manager, sharing its base locations
+	locMgr.setLocations(StelApp::getInstance().getLocationMgr());
 	locMgrMutex.unlock();
 }
 
@@ -62,11 +62,10 @@ void LocationSearchService::get(const QByteArray& operation, const APIParameters
 		//the filtering in the app is provided by QSortFilterProxyModel in the view
 		//we dont have that luxury, but we make sure the filtering happens in the separate HTTP thread
 		locMgrMutex.lock();
-		LocationMap allItems = locMgr.getAllMap();
+		const QStringList list = locMgr.getAllIDs();
 		locMgrMutex.unlock();
 
 		QJsonArray results;
-		const QList<QString>& list = allItems.keys();
 
 		//use a regexp in wildcard mode, the app does the same
 		QRegExp exp(term,Qt::CaseInsensitive, QRegExp::Wildcard);
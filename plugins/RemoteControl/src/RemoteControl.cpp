@@ -92,6 +92,7 @@ RemoteControl::~RemoteControl()
 	{
 		//we manually delete the listener here to make sure
 		//all connections are closed before the requesthandler is deleted
+		requestHandler->closeEventStream();
 		delete httpListener;
 		httpListener = Q_NULLPTR;
 	}
@@ -247,6 +248,8 @@ void RemoteControl::startServer()
 	settings.port = port;
 	settings.minThreads = minThreads;
 	settings.maxThreads = maxThreads;
+	//keep half of the threads for the other requests
+	requestHandler->openEventStream(qMax(1, maxThreads/2));
 	httpListener = new HttpListener(settings,requestHandler);
 }
 
@@ -254,6 +257,8 @@ void RemoteControl::stopServer()
 {
 	if(httpListener)
 	{
+		//the event streams block their threads, which the listener waits for
+		requestHandler->closeEventStream();
 		delete httpListener;
 		httpListener = Q_NULLPTR;
 	}
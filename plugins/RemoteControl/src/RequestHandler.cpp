@@ -22,6 +22,7 @@
 #include "templateengine/template.h"
 
 #include "APIController.hpp"
+#include "EventStream.hpp"
 #include "LocationService.hpp"
 #include "LocationSearchService.hpp"
 #include "MainService.hpp"
@@ -132,6 +133,16 @@ void RequestHandler::update(double deltaTime)
 	apiController->update(deltaTime);
 }
 
+void RequestHandler::openEventStream(int maxSubscribers)
+{
+	apiController->getEventStream()->open(maxSubscribers);
+}
+
+void RequestHandler::closeEventStream()
+{
+	apiController->getEventStream()->close();
+}
+
 void RequestHandler::service(HttpRequest &request, HttpResponse &response)
 {
 
@@ -44,6 +44,12 @@ public:
 	//! Called in the main thread each frame, only passed on to APIController::update
 	void update(double deltaTime);
 
+	//! Accepts at most maxSubscribers clients on the event stream, see EventStream::open
+	void openEventStream(int maxSubscribers);
+	//! Disconnects all clients of the event stream. Must be called before the HttpListener is deleted,
+	//! see EventStream::close
+	void closeEventStream();
+
 	//! Receives the HttpRequest from the HttpListener.
 	//! It checks the optional HTTP authentication and sets the keep-alive header if requested
 	//! by the client.
@@ -13,6 +13,7 @@ HttpResponse::HttpResponse(QTcpSocket* socket)
     sentHeaders=false;
     sentLastPart=false;
     chunkedMode=false;
+    writeTimeout=-1;
 }
 
 void HttpResponse::setHeader(QByteArray name, QByteArray value)
@@ -82,9 +83,14 @@ bool HttpResponse::writeToSocket(QByteArray data)
     while (socket->isOpen() && remaining>0)
     {
         // If the output buffer has become large, then wait until it has been sent.
+        // A client which does not read within the write timeout is disconnected.
         if (socket->bytesToWrite()>16384)
         {
-            socket->waitForBytesWritten(-1);
+            if (!socket->waitForBytesWritten(writeTimeout) && writeTimeout>=0)
+            {
+                socket->abort();
+                return false;
+            }
         }
 
         int written=socket->write(ptr,remaining);
@@ -200,3 +206,14 @@ bool HttpResponse::isConnected() const
 {
     return socket->isOpen();
 }
+
+
+qint64 HttpResponse::bytesToWrite() const
+{
+    return socket->bytesToWrite();
+}
+
+void HttpResponse::setWriteTimeout(int msecs)
+{
+    writeTimeout=msecs;
+}
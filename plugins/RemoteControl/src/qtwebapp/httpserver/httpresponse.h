@@ -122,6 +122,19 @@ public:
      */
     bool isConnected() const;
 
+    /**
+     * Returns the number of bytes which have not been passed to the TCP buffer yet.
+     * Long-lived responses can check it before write() to not block on a client which does not read.
+     */
+    qint64 bytesToWrite() const;
+
+    /**
+     * Limit the time that write() waits for the client when the output buffer is full.
+     * When it expires, the connection is aborted and isConnected() returns false.
+     * @param msecs timeout in milliseconds, -1 (the default) waits forever
+     */
+    void setWriteTimeout(int msecs);
+
 private:
 
     /** Request headers */
@@ -148,7 +161,13 @@ private:
     /** Cookies */
     QMap<QByteArray,HttpCookie> cookies;
 
-    /** Write raw data to the socket. This method blocks until all bytes have been passed to the TCP buffer */
+    /** Maximal time [ms] to wait for the client when the output buffer is full, -1 for no limit */
+    int writeTimeout;
+
+    /**
+      Write raw data to the socket. This method blocks until all bytes have been passed to the TCP buffer,
+      or until the write timeout expires, which aborts the connection and returns false.
+    */
     bool writeToSocket(QByteArray data);
 
     /**
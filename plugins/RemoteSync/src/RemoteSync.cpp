@@ -125,9 +125,14 @@ void RemoteSync::update(double deltaTime)
 	Q_UNUSED(deltaTime);
 	if(server)
 	{
-		//pass update on to server, client does not need this
+		//pass update on to server, which broadcasts the changes of this frame
 		server->update();
 	}
+	else if(client)
+	{
+		//the client interpolates the view between the frames of the server
+		client->update();
+	}
 }
 
 double RemoteSync::getCallOrder(StelModuleActionName actionName) const
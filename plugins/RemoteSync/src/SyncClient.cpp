@@ -37,30 +37,30 @@ SyncClient::SyncClient(SyncOptions options, const QStringList &excludeProperties
 	  stelPropFilter(excludeProperties),
 	  isConnecting(false),
 	  server(Q_NULLPTR),
-	  timeoutTimerId(-1)
+	  timeoutTimerId(-1),
+	  stateFrameHandler(Q_NULLPTR)
 {
 	handlerList.resize(MSGTYPE_SIZE);
 	handlerList[ERROR] = new ClientErrorHandler(this);
 	handlerList[SERVER_CHALLENGE] = new ClientAuthHandler(this);
 	handlerList[SERVER_CHALLENGERESPONSEVALID] = new ClientAuthHandler(this);
 	handlerList[ALIVE] = new ClientAliveHandler();
+	handlerList[CLOCK_SYNC] = new ClientClockSyncHandler();
 
 	//these are the actual sync handlers
-	if(options.testFlag(SyncTime))
-		handlerList[TIME] = new ClientTimeHandler();
 	if(options.testFlag(SyncLocation))
 		handlerList[LOCATION] = new ClientLocationHandler();
 	if(options.testFlag(SyncSelection))
 		handlerList[SELECTION] = new ClientSelectionHandler();
-	if(options.testFlag(SyncStelProperty))
-		handlerList[STELPROPERTY] = new ClientStelPropertyUpdateHandler(options.testFlag(SkipGUIProps), stelPropFilter);
-	if(options.testFlag(SyncView))
-		handlerList[VIEW] = new ClientViewHandler();
-	if(options.testFlag(SyncFov))
-		handlerList[FOV] = new ClientFovHandler();
+	//the time, StelProperty, view and fov changes are all in the state frames
+	if(options & (SyncTime | SyncStelProperty | SyncView | SyncFov))
+	{
+		stateFrameHandler = new ClientStateFrameHandler(options, stelPropFilter);
+		handlerList[STATE_FRAME] = stateFrameHandler;
+	}
 
 	//fill unused handlers with dummies
-	for(int t = TIME;t<MSGTYPE_SIZE;++t)
+	for(int t = CLOCK_SYNC;t<MSGTYPE_SIZE;++t)
 	{
 		if(!handlerList[t]) handlerList[t] = new DummyMessageHandler();
 	}
@@ -108,6 +108,12 @@ void SyncClient::disconnectFromServer()
 	}
 }
 
+void SyncClient::update()
+{
+	if(server && server->isAuthenticated() && stateFrameHandler)
+		stateFrameHandler->update();
+}
+
 void SyncClient::timerEvent(QTimerEvent *evt)
 {
 	if(evt->timerId() == timeoutTimerId)
@@ -122,6 +128,9 @@ void SyncClient::checkTimeout()
 	if(!server)
 		return;
 
+	//the clock offset is estimated from the last requests
+	if(server->isAuthenticated())
+		server->requestClockSync();
 	server->checkTimeout();
 }
 
@@ -28,6 +28,7 @@ Q_DECLARE_LOGGING_CATEGORY(syncClient)
 
 class SyncMessageHandler;
 class SyncRemotePeer;
+class ClientStateFrameHandler;
 
 //! A client which can connect to a SyncServer to receive state changes, and apply them
 class SyncClient : public QObject
@@ -56,6 +57,9 @@ public:
 
 	QString errorString() const { return errorStr; }
 
+	//! This should be called in the StelModule::update function, to apply the interpolated view and fov
+	void update();
+
 public slots:
 	void connectToServer(const QString& host, const int port);
 	void disconnectFromServer();
@@ -80,6 +84,7 @@ private:
 	SyncRemotePeer* server;
 	int timeoutTimerId;
 	QVector<SyncMessageHandler*> handlerList;
+	ClientStateFrameHandler* stateFrameHandler;
 
 	friend class ClientErrorHandler;
 };
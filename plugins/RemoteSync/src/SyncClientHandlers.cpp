@@ -29,6 +29,8 @@
 #include "StelObjectMgr.hpp"
 #include "StelPropertyMgr.hpp"
 
+#include <QDateTime>
+
 using namespace SyncProtocol;
 
 ClientHandler::ClientHandler()
@@ -39,9 +41,10 @@ ClientHandler::ClientHandler()
 
 ClientHandler::ClientHandler(SyncClient *client)
 	: client(client)
+	, core(Q_NULLPTR)
 {
+	//the handlers of the connection only use the client
 	Q_ASSERT(client);
-	core = StelApp::getInstance().getCore();
 }
 
 
@@ -137,6 +140,8 @@ bool ClientAuthHandler::handleMessage(QDataStream &stream, SyncProtocol::tPayloa
 			peer.authenticated = true;
 			qDebug()<<"[SyncClient] Connection authenticated";
 			emit authenticated();
+			//the first estimate of the clock offset, repeated by SyncClient::checkTimeout
+			peer.requestClockSync();
 			return true;
 		}
 		else
@@ -160,20 +165,15 @@ bool ClientAliveHandler::handleMessage(QDataStream &stream, SyncProtocol::tPaylo
 	return p.deserialize(stream,dataSize);
 }
 
-bool ClientTimeHandler::handleMessage(QDataStream &stream, SyncProtocol::tPayloadSize dataSize, SyncRemotePeer &peer)
+bool ClientClockSyncHandler::handleMessage(QDataStream &stream, SyncProtocol::tPayloadSize dataSize, SyncRemotePeer &peer)
 {
-	Time msg;
+	ClockSync msg;
 	bool ok = msg.deserialize(stream, dataSize);
 
 	if(!ok)
 		return false;
 
-	//set time variables, time rate first because it causes a resetSync which we overwrite
-	core->setTimeRate(msg.timeRate);
-	core->setJD(msg.jDay);
-	//This is needed for compensation of network delay. Requires system clocks of client/server to be calibrated to the same values.
-	core->setMilliSecondsOfLastJDUpdate(msg.lastTimeSyncTime);
-
+	peer.getClock().addSample(msg.clientSendTime, msg.serverReceiveTime, msg.serverSendTime, QDateTime::currentMSecsSinceEpoch());
 	return true;
 }
 
@@ -253,8 +253,10 @@ bool ClientSelectionHandler::handleMessage(QDataStream &stream, SyncProtocol::tP
 	return true;
 }
 
-ClientStelPropertyUpdateHandler::ClientStelPropertyUpdateHandler(bool skipGuiProps, const QStringList &excludeProps)
+ClientStateFrameHandler::ClientStateFrameHandler(SyncClient::SyncOptions options, const QStringList &excludeProps)
+	: options(options), lastView(0.0), lastFov(0.0)
 {
+	mvMgr = core->getMovementMgr();
 	propMgr = StelApp::getInstance().getStelPropertyManager();
 
 	QString pattern("^(");
@@ -273,7 +275,7 @@ ClientStelPropertyUpdateHandler::ClientStelPropertyUpdateHandler(bool skipGuiPro
 		pattern += tmp;
 	}
 
-	if(skipGuiProps)
+	if(options.testFlag(SyncClient::SkipGUIProps))
 	{
 		if(!first)
 		{
@@ -298,53 +300,72 @@ ClientStelPropertyUpdateHandler::ClientStelPropertyUpdateHandler(bool skipGuiPro
 	filter.optimize();
 }
 
-bool ClientStelPropertyUpdateHandler::handleMessage(QDataStream &stream, SyncProtocol::tPayloadSize dataSize, SyncRemotePeer &peer)
+bool ClientStateFrameHandler::handleMessage(QDataStream &stream, SyncProtocol::tPayloadSize dataSize, SyncRemotePeer &peer)
 {
-	StelPropertyUpdate msg;
+	StateFrame msg;
 	bool ok = msg.deserialize(stream, dataSize);
 
 	if(!ok)
 		return false;
 
-	qDebug()<<msg;
+	SyncStateFrame frame;
+	if(!decoder.decode(msg.payload, frame))
+		return false;
 
-	QRegularExpressionMatch match = filter.match(msg.propId);
-	if(match.hasMatch())
+	const SyncClock& clock = peer.getClock();
+	if(frame.has(SyncStateFrame::KeyFrame))
+		interpolator.clear();
+
+	if(options.testFlag(SyncClient::SyncTime) && frame.has(SyncStateFrame::Time))
 	{
-		//filtered property
-		qDebug()<<"Filtered"<<msg;
-		return true;
+		//set time variables, time rate first because it causes a resetSync which we overwrite
+		core->setTimeRate(frame.state.timeRate);
+		core->setJD(frame.state.jDay);
+		//The time of the last update on the server clock is converted to the client clock,
+		//so that the client continues the time from the same instant as the server.
+		core->setMilliSecondsOfLastJDUpdate(clock.toLocalTime(frame.state.lastTimeSyncTime));
 	}
-	propMgr->setStelPropertyValue(msg.propId,msg.value);
-	return true;
-}
 
-ClientViewHandler::ClientViewHandler()
-{
-	mvMgr = core->getMovementMgr();
-}
+	if(options.testFlag(SyncClient::SyncStelProperty))
+	{
+		for(int i=0;i<frame.properties.size();++i)
+		{
+			const QString& propId = frame.properties.at(i).first;
+			QRegularExpressionMatch match = filter.match(propId);
+			if(match.hasMatch())
+			{
+				//filtered property
+				qDebug()<<"Filtered"<<propId;
+				continue;
+			}
+			propMgr->setStelPropertyValue(propId,frame.properties.at(i).second);
+		}
+	}
 
-bool ClientViewHandler::handleMessage(QDataStream &stream, SyncProtocol::tPayloadSize dataSize, SyncRemotePeer &peer)
-{
-	View msg;
-	bool ok = msg.deserialize(stream, dataSize);
-	if(!ok) return false;
+	//the view and fov are set by update()
+	if(frame.has(SyncStateFrame::View) || frame.has(SyncStateFrame::Fov))
+		interpolator.addSample(clock.toLocalTime(frame.serverTime), QDateTime::currentMSecsSinceEpoch(), frame.state.viewAltAz, frame.state.fov);
 
-	mvMgr->setViewDirectionJ2000(core->altAzToJ2000(msg.viewAltAz, StelCore::RefractionOff));
 	return true;
 }
 
-ClientFovHandler::ClientFovHandler()
-{
-	mvMgr = core->getMovementMgr();
-}
-
-bool ClientFovHandler::handleMessage(QDataStream &stream, SyncProtocol::tPayloadSize dataSize, SyncRemotePeer &peer)
+void ClientStateFrameHandler::update()
 {
-	Fov msg;
-	bool ok = msg.deserialize(stream, dataSize);
-	if(!ok) return false;
-
-	mvMgr->zoomTo(msg.fov, 0.0f);
-	return true;
+	Vec3d view;
+	double fov;
+	//the state of the server some time ago, so that the following frame has already arrived
+	const qint64 time = QDateTime::currentMSecsSinceEpoch() - qRound64(interpolator.getDelay());
+	if(!interpolator.getState(time, view, fov))
+		return;
+
+	if(options.testFlag(SyncClient::SyncView) && view!=lastView)
+	{
+		mvMgr->setViewDirectionJ2000(core->altAzToJ2000(view, StelCore::RefractionOff));
+		lastView = view;
+	}
+	if(options.testFlag(SyncClient::SyncFov) && fov!=lastFov)
+	{
+		mvMgr->zoomTo(fov, 0.0f);
+		lastFov = fov;
+	}
 }
@@ -20,11 +20,12 @@
 #ifndef SYNCCLIENTHANDLERS_HPP_
 #define SYNCCLIENTHANDLERS_HPP_
 
+#include "SyncClient.hpp"
 #include "SyncProtocol.hpp"
+#include "SyncStateFrame.hpp"
 
 #include <QRegularExpression>
 
-class SyncClient;
 class StelCore;
 
 class ClientHandler : public QObject, public SyncMessageHandler
@@ -34,6 +35,7 @@ class ClientHandler : public QObject, public SyncMessageHandler
 
 public:
 	ClientHandler();
+	//! For the handlers of the connection, which do not use StelCore
 	ClientHandler(SyncClient *client);
 protected:
 	SyncClient* client;
@@ -65,7 +67,8 @@ public:
 	bool handleMessage(QDataStream &stream, SyncProtocol::tPayloadSize dataSize, SyncRemotePeer &peer) Q_DECL_OVERRIDE;
 };
 
-class ClientTimeHandler : public ClientHandler
+//! Adds the times of the replies to CLOCK_SYNC requests to the clock of the server peer
+class ClientClockSyncHandler : public SyncMessageHandler
 {
 public:
 	bool handleMessage(QDataStream &stream, SyncProtocol::tPayloadSize dataSize, SyncRemotePeer &peer) Q_DECL_OVERRIDE;
@@ -87,34 +90,27 @@ private:
 	StelObjectMgr* objMgr;
 };
 
-class StelPropertyMgr;
-class ClientStelPropertyUpdateHandler : public ClientHandler
-{
-public:
-	ClientStelPropertyUpdateHandler(bool skipGuiProps, const QStringList& excludeProps);
-	bool handleMessage(QDataStream &stream, SyncProtocol::tPayloadSize dataSize, SyncRemotePeer &peer) Q_DECL_OVERRIDE;
-private:
-	StelPropertyMgr* propMgr;
-	QRegularExpression filter;
-};
-
 class StelMovementMgr;
-class ClientViewHandler : public ClientHandler
+class StelPropertyMgr;
+//! Applies the time and StelProperty changes of the state frames, and interpolates the view and fov between them
+class ClientStateFrameHandler : public ClientHandler
 {
 public:
-	ClientViewHandler();
+	ClientStateFrameHandler(SyncClient::SyncOptions options, const QStringList& excludeProps);
 	bool handleMessage(QDataStream &stream, SyncProtocol::tPayloadSize dataSize, SyncRemotePeer &peer) Q_DECL_OVERRIDE;
-private:
-	StelMovementMgr* mvMgr;
-};
 
-class ClientFovHandler : public ClientHandler
-{
-public:
-	ClientFovHandler();
-	bool handleMessage(QDataStream &stream, SyncProtocol::tPayloadSize dataSize, SyncRemotePeer &peer) Q_DECL_OVERRIDE;
+	//! Sets the view and fov interpolated for the current time. Should be called once per frame.
+	void update();
 private:
+	SyncClient::SyncOptions options;
 	StelMovementMgr* mvMgr;
+	StelPropertyMgr* propMgr;
+	QRegularExpression filter;
+	SyncStateDecoder decoder;
+	SyncStateInterpolator interpolator;
+	//the last values set by update(), which does not override the local changes of the view when the server does not move it
+	Vec3d lastView;
+	double lastFov;
 };
 
 #endif
@@ -0,0 +1,85 @@
+/*
+ * Stellarium Remote Sync plugin
+ * Copyright (C) 2017 Stellarium Developers
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Suite 500, Boston, MA  02110-1335, USA.
+ */
+
+#include "SyncClock.hpp"
+
+#include <cmath>
+
+SyncClock::SyncClock()
+	: nextSample(0)
+	, offset(0.0)
+	, delay(0.0)
+{
+	samples.reserve(WindowSize);
+}
+
+void SyncClock::clear()
+{
+	samples.clear();
+	nextSample = 0;
+	offset = 0.0;
+	delay = 0.0;
+}
+
+void SyncClock::addSample(qint64 t0, qint64 t1, qint64 t2, qint64 t3)
+{
+	Sample s;
+	s.offset = 0.5 * (static_cast<double>(t1-t0) + static_cast<double>(t2-t3));
+	// The clocks count whole ms, so that a fast exchange can give a slightly negative delay
+	s.delay = qMax(0.0, static_cast<double>((t3-t0) - (t2-t1)));
+
+	if (samples.size()<WindowSize)
+		samples.append(s);
+	else
+		samples[nextSample] = s;
+	nextSample = (nextSample+1) % WindowSize;
+
+	const Sample* best = &samples.first();
+	for (int i=1; i<samples.size(); ++i)
+	{
+		if (samples.at(i).delay<best->delay)
+			best = &samples.at(i);
+	}
+	offset = best->offset;
+	delay = best->delay;
+}
+
+double SyncClock::getJitter() const
+{
+	if (samples.size()<2)
+		return 0.0;
+	double mean = 0.0;
+	for (int i=0; i<samples.size(); ++i)
+		mean += samples.at(i).offset;
+	mean /= samples.size();
+	double variance = 0.0;
+	for (int i=0; i<samples.size(); ++i)
+		variance += (samples.at(i).offset-mean) * (samples.at(i).offset-mean);
+	return std::sqrt(variance/(samples.size()-1));
+}
+
+qint64 SyncClock::toLocalTime(qint64 remoteTime) const
+{
+	return remoteTime - qRound64(offset);
+}
+
+qint64 SyncClock::toRemoteTime(qint64 localTime) const
+{
+	return localTime + qRound64(offset);
+}
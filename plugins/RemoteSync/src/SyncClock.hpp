@@ -0,0 +1,73 @@
+/*
+ * Stellarium Remote Sync plugin
+ * Copyright (C) 2017 Stellarium Developers
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Suite 500, Boston, MA  02110-1335, USA.
+ */
+
+#ifndef SYNCCLOCK_HPP_
+#define SYNCCLOCK_HPP_
+
+#include <QVector>
+
+//! Estimates the offset between the clock of a remote peer and the local clock, as NTP does.
+//! For each CLOCK_SYNC exchange, the request leaves at local time t0, reaches the peer at remote
+//! time t1, the reply leaves at remote time t2 and arrives at local time t3. Then
+//! offset = ((t1-t0)+(t2-t3))/2 and delay = (t3-t0)-(t2-t1).
+//! The error of the offset is at most delay/2, and most of the delay is caused by queueing,
+//! so the estimate is the offset of the sample with the smallest delay among the last WindowSize.
+//! All times are in ms since the epoch, as QDateTime::currentMSecsSinceEpoch().
+class SyncClock
+{
+public:
+	SyncClock();
+
+	//! Forget all samples.
+	void clear();
+	//! Add the times of an exchange.
+	void addSample(qint64 t0, qint64 t1, qint64 t2, qint64 t3);
+
+	//! True when at least one sample was added.
+	bool isValid() const { return !samples.isEmpty(); }
+	//! Remote time minus local time [ms]. 0 until a sample was added.
+	double getOffset() const { return offset; }
+	//! Round trip delay of the sample used for the offset [ms].
+	double getDelay() const { return delay; }
+	//! Standard deviation of the offsets of the samples in the window [ms].
+	double getJitter() const;
+
+	//! Convert a time of the remote clock to the local clock.
+	qint64 toLocalTime(qint64 remoteTime) const;
+	//! Convert a time of the local clock to the remote clock.
+	qint64 toRemoteTime(qint64 localTime) const;
+
+	//! Number of samples the estimate is taken from
+	static const int WindowSize = 8;
+
+private:
+	struct Sample
+	{
+		double offset;
+		double delay;
+	};
+
+	//! The last samples, used as a ring buffer once full
+	QVector<Sample> samples;
+	int nextSample;
+	double offset;
+	double delay;
+};
+
+#endif
@@ -115,23 +115,29 @@ bool ClientChallengeResponse::deserialize(QDataStream &stream, tPayloadSize data
 	return !stream.status();;
 }
 
-void Time::serialize(QDataStream &stream) const
+ClockSync::ClockSync()
+	: clientSendTime(0), serverReceiveTime(0), serverSendTime(0)
 {
-	stream<<lastTimeSyncTime;
-	stream<<jDay;
-	stream<<timeRate;
+
+}
+
+void ClockSync::serialize(QDataStream &stream) const
+{
+	stream<<clientSendTime;
+	stream<<serverReceiveTime;
+	stream<<serverSendTime;
 }
 
-bool Time::deserialize(QDataStream &stream, tPayloadSize dataSize)
+bool ClockSync::deserialize(QDataStream &stream, tPayloadSize dataSize)
 {
 	if(dataSize != 24)
 		return false;
 
-	stream>>lastTimeSyncTime;
-	stream>>jDay;
-	stream>>timeRate;
+	stream>>clientSendTime;
+	stream>>serverReceiveTime;
+	stream>>serverSendTime;
 
-	return !stream.status();;
+	return !stream.status();
 }
 
 Location::Location()
@@ -170,46 +176,17 @@ bool Selection::deserialize(QDataStream &stream, tPayloadSize dataSize)
 	return !stream.status();
 }
 
-void StelPropertyUpdate::serialize(QDataStream &stream) const
+void StateFrame::serialize(QDataStream &stream) const
 {
-	writeString(stream,propId);
-	stream<<value;
+	//the payload is already encoded
+	stream.writeRawData(payload.constData(), payload.size());
 }
 
-bool StelPropertyUpdate::deserialize(QDataStream &stream, tPayloadSize dataSize)
+bool StateFrame::deserialize(QDataStream &stream, tPayloadSize dataSize)
 {
-	Q_UNUSED(dataSize);
-	propId = readString(stream);
-	stream>>value;
-	return !stream.status();
-}
-
-void View::serialize(QDataStream &stream) const
-{
-	stream<<viewAltAz;
-}
-
-bool View::deserialize(QDataStream &stream, tPayloadSize dataSize)
-{
-	if(dataSize != 3 * sizeof(double))
-		return false;
-
-	stream>>viewAltAz;
-
-	return !stream.status();
-}
-
-void Fov::serialize(QDataStream &stream) const
-{
-	stream<<fov;
-}
-
-bool Fov::deserialize(QDataStream &stream, tPayloadSize dataSize)
-{
-	if(dataSize != sizeof(double))
+	payload.resize(dataSize);
+	if(stream.readRawData(payload.data(), dataSize) != dataSize)
 		return false;
 
-	stream>>fov;
-
 	return !stream.status();
 }
@@ -22,7 +22,6 @@
 
 #include "SyncProtocol.hpp"
 #include "StelLocation.hpp"
-#include "VecMath.hpp"
 
 namespace SyncProtocol
 {
@@ -79,20 +78,26 @@ public:
 	SyncProtocol::SyncMessageType getMessageType() const Q_DECL_OVERRIDE { return SyncProtocol::SERVER_CHALLENGERESPONSEVALID; }
 };
 
-class Time : public SyncMessage
+//! Sent by the client with clientSendTime, and returned by the server with the other times.
+//! See SyncClock for the computation of the clock offset.
+class ClockSync : public SyncMessage
 {
 public:
-	SyncProtocol::SyncMessageType getMessageType() const Q_DECL_OVERRIDE { return SyncProtocol::TIME; }
+	ClockSync();
+
+	SyncProtocol::SyncMessageType getMessageType() const Q_DECL_OVERRIDE { return SyncProtocol::CLOCK_SYNC; }
 
 	void serialize(QDataStream &stream) const Q_DECL_OVERRIDE;
 	bool deserialize(QDataStream &stream, SyncProtocol::tPayloadSize dataSize) Q_DECL_OVERRIDE;
 
-	//TODO implement network delay compensation (also for other message types where it makes sense)
-	//TODO maybe split up so that each message is only for 1 thing?
-	qint64 lastTimeSyncTime; //corresponds to StelCore::milliSecondsOfLastJDayUpdate
-	double jDay; //current jDay, without any time zone/deltaT adjustments
-	double timeRate; //current time rate
+	QDebug debugOutput(QDebug dbg) const Q_DECL_OVERRIDE
+	{
+		return dbg<<clientSendTime<<serverReceiveTime<<serverSendTime;
+	}
 
+	qint64 clientSendTime; //on the clock of the client
+	qint64 serverReceiveTime; //on the clock of the server
+	qint64 serverSendTime; //on the clock of the server
 };
 
 class Location : public SyncMessage
@@ -133,43 +138,22 @@ public:
 	SyncProtocol::SyncMessageType getMessageType() const Q_DECL_OVERRIDE  { return SyncProtocol::ALIVE; }
 };
 
-class StelPropertyUpdate : public SyncMessage
+//! The changes of the view, fov, time and StelProperties in a frame of the server.
+//! The payload is encoded by SyncStateEncoder, see SyncStateFrame for its layout.
+class StateFrame : public SyncMessage
 {
 public:
-	SyncMessageType getMessageType() const Q_DECL_OVERRIDE { return SyncProtocol::STELPROPERTY; }
+	SyncMessageType getMessageType() const Q_DECL_OVERRIDE { return SyncProtocol::STATE_FRAME; }
 
-	void serialize(QDataStream &stream) const Q_DECL_OVERRIDE;
-	bool deserialize(QDataStream &stream, SyncProtocol::tPayloadSize dataSize) Q_DECL_OVERRIDE;
+	void serialize(QDataStream& stream) const Q_DECL_OVERRIDE;
+	bool deserialize(QDataStream &stream, tPayloadSize dataSize) Q_DECL_OVERRIDE;
 
 	QDebug debugOutput(QDebug dbg) const Q_DECL_OVERRIDE
 	{
-		return dbg<<propId<<value;
+		return dbg<<payload.size()<<"bytes";
 	}
 
-	QString propId;
-	QVariant value;
-};
-
-class View : public SyncMessage
-{
-public:
-	SyncMessageType getMessageType() const Q_DECL_OVERRIDE { return SyncProtocol::VIEW; }
-
-	void serialize(QDataStream& stream) const Q_DECL_OVERRIDE;
-	bool deserialize(QDataStream &stream, tPayloadSize dataSize) Q_DECL_OVERRIDE;
-
-	Vec3d viewAltAz;
-};
-
-class Fov : public SyncMessage
-{
-public:
-	SyncMessageType getMessageType() const Q_DECL_OVERRIDE { return SyncProtocol::FOV; }
-
-	void serialize(QDataStream& stream) const Q_DECL_OVERRIDE;
-	bool deserialize(QDataStream &stream, tPayloadSize dataSize) Q_DECL_OVERRIDE;
-
-	double fov;
+	QByteArray payload;
 };
 
 }
@@ -302,6 +302,13 @@ void SyncRemotePeer::writeData(const QByteArray &data, int size)
 		peerLog("Can't write message, not connected");
 }
 
+void SyncRemotePeer::requestClockSync()
+{
+	ClockSync msg;
+	msg.clientSendTime = QDateTime::currentMSecsSinceEpoch();
+	writeMessage(msg);
+}
+
 void SyncRemotePeer::writeError(const QString &err)
 {
 	qWarning()<<"[SyncPlugin] Disconnecting with error:"<<err;
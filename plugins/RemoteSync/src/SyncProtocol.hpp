@@ -20,6 +20,8 @@
 #ifndef SYNCPROTOCOL_HPP_
 #define SYNCPROTOCOL_HPP_
 
+#include "SyncClock.hpp"
+
 #include <QByteArray>
 #include <QDataStream>
 #include <QAbstractSocket>
@@ -32,7 +34,7 @@ namespace SyncProtocol
 //Important: All data should use the sized typedefs provided by Qt (i.e. qint32 instead of 4 byte int on x86)
 
 //! Should be changed with every breaking change
-const quint8 SYNC_PROTOCOL_VERSION = 2;
+const quint8 SYNC_PROTOCOL_VERSION = 3;
 const QDataStream::Version SYNC_DATASTREAM_VERSION = QDataStream::Qt_5_0;
 //! Magic value for protocol used during connection. Should NEVER change.
 const QByteArray SYNC_MAGIC_VALUE = "StellariumSyncPluginProtocol";
@@ -66,14 +68,12 @@ enum SyncMessageType
 	ALIVE, //sent from a peer after no data was sent for about 5 seconds to indicate it is still alive
 
 	//all messages below here can only be sent from authenticated peers
-	TIME, //time jumps + time scale updates
+	CLOCK_SYNC, //sent from the client to estimate the offset between the clocks, and replied to by the server
 	LOCATION, //location changes
 	SELECTION, //current selection changed
-	STELPROPERTY, //stelproperty updates
-	VIEW, //view change
-	FOV, //fov change
+	STATE_FRAME, //view, fov, time and stelproperty changes of a server frame
 
-	MSGTYPE_MAX = FOV,
+	MSGTYPE_MAX = STATE_FRAME,
 	MSGTYPE_SIZE = MSGTYPE_MAX+1
 };
 
@@ -92,8 +92,8 @@ inline QDebug& operator<<(QDebug& deb, SyncMessageType msg)
 		case SyncProtocol::SERVER_CHALLENGERESPONSEVALID:
 			deb<<"SERVER_CHALLENGERESPONSEVALID";
 			break;
-		case SyncProtocol::TIME:
-			deb<<"TIME";
+		case SyncProtocol::CLOCK_SYNC:
+			deb<<"CLOCK_SYNC";
 			break;
 		case SyncProtocol::LOCATION:
 			deb<<"LOCATION";
@@ -101,14 +101,8 @@ inline QDebug& operator<<(QDebug& deb, SyncMessageType msg)
 		case SyncProtocol::SELECTION:
 			deb<<"SELECTION";
 			break;
-		case SyncProtocol::STELPROPERTY:
-			deb<<"STELPROPERTY";
-			break;
-		case SyncProtocol::VIEW:
-			deb<<"VIEW";
-			break;
-		case SyncProtocol::FOV:
-			deb<<"FOV";
+		case SyncProtocol::STATE_FRAME:
+			deb<<"STATE_FRAME";
 			break;
 		case SyncProtocol::ALIVE:
 			deb<<"ALIVE";
@@ -179,6 +173,8 @@ public:
 	void writeData(const QByteArray& data, int size=-1);
 	//! Can be used to write an error message to the peer and drop the connection
 	void writeError(const QString& err);
+	//! Sends a CLOCK_SYNC request, the reply is added to the clock of this peer
+	void requestClockSync();
 
 	//! Log a message for this peer
 	void peerLog(const QString& msg) const;
@@ -186,6 +182,9 @@ public:
 
 	bool isAuthenticated() const { return authenticated; }
 	QUuid getID() const { return id; }
+	//! The estimate of the offset between the clock of this peer and the local clock
+	SyncClock& getClock() { return clock; }
+	const SyncClock& getClock() const { return clock; }
 
 	void checkTimeout();
 	void disconnectPeer();
@@ -216,6 +215,7 @@ private:
 	qint64 lastSendTime; //The time the last data was written to this peer
 	QVector<SyncMessageHandler*> handlerList;
 	QByteArray msgWriteBuffer; //Byte array used to construct messages before writing them
+	SyncClock clock;
 
 	friend class ServerAuthHandler;
 	friend class ClientAuthHandler;
@@ -43,6 +43,7 @@ SyncServer::SyncServer(QObject* parent)
 	handlerList[ERROR] =  new ServerErrorHandler();
 	handlerList[CLIENT_CHALLENGE_RESPONSE] = new ServerAuthHandler(this, false);
 	handlerList[ALIVE] = new ServerAliveHandler();
+	handlerList[CLOCK_SYNC] = new ServerClockSyncHandler();
 }
 
 SyncServer::~SyncServer()
@@ -72,19 +73,20 @@ bool SyncServer::start(int port)
 
 		timeoutTimerId = startTimer(5000,Qt::VeryCoarseTimer);
 
-		//create senders
-		addSender(new TimeEventSender());
-		addSender(new LocationEventSender());
-		addSender(new SelectionEventSender());
-		addSender(new StelPropertyEventSender());
-		addSender(new ViewEventSender());
-		addSender(new FovEventSender());
+		createSenders();
 	}
 	else
 		qCCritical(syncServer)<<"Error while starting:"<<qserver->errorString();
 	return ok;
 }
 
+void SyncServer::createSenders()
+{
+	addSender(new LocationEventSender());
+	addSender(new SelectionEventSender());
+	addSender(new StateFrameEventSender());
+}
+
 void SyncServer::addSender(SyncServerEventSender *snd)
 {
 	snd->server = this;
@@ -60,6 +60,10 @@ signals:
 
 protected:
 	void timerEvent(QTimerEvent* evt) Q_DECL_OVERRIDE;
+	//! Called by start() to create the senders of the application state with addSender().
+	//! They are deleted by stop().
+	virtual void createSenders();
+	void addSender(SyncServerEventSender* snd);
 private slots:
 	void handleNewConnection();
 	void connectionError(QAbstractSocket::SocketError err);
@@ -68,7 +72,6 @@ private slots:
 	void clientDisconnected(bool clean);
 
 private:
-	void addSender(SyncServerEventSender* snd);
 	void checkTimeouts();
 	void checkStopState();
 	//use composition instead of inheritance, cleaner interfaace this way
@@ -27,6 +27,8 @@
 #include "StelObjectMgr.hpp"
 #include "StelPropertyMgr.hpp"
 
+#include <QDateTime>
+
 using namespace SyncProtocol;
 
 SyncServerEventSender::SyncServerEventSender()
@@ -36,24 +38,16 @@ SyncServerEventSender::SyncServerEventSender()
 	core = StelApp::getInstance().getCore();
 }
 
-void SyncServerEventSender::broadcastMessage(const SyncMessage &msg)
-{
-	server->broadcastMessage(msg);
-}
-
-TimeEventSender::TimeEventSender()
+SyncServerEventSender::SyncServerEventSender(StelCore *core)
+	: isDirty(false)
+	, core(core)
+	, server(Q_NULLPTR)
 {
-	//this is the only event we need to listen to
-	connect(core,SIGNAL(timeSyncOccurred(double)),this,SLOT(reactToStellariumEvent()));
 }
 
-Time TimeEventSender::constructMessage()
+void SyncServerEventSender::broadcastMessage(const SyncMessage &msg)
 {
-	Time msg;
-	msg.lastTimeSyncTime = core->getMilliSecondsOfLastJDUpdate();
-	msg.jDay = core->getJDOfLastJDUpdate();
-	msg.timeRate = core->getTimeRate();
-	return msg;
+	server->broadcastMessage(msg);
 }
 
 LocationEventSender::LocationEventSender()
@@ -107,89 +101,75 @@ Selection SelectionEventSender::constructMessage()
 	return msg;
 }
 
-StelPropertyEventSender::StelPropertyEventSender()
+StateFrameEventSender::StateFrameEventSender()
 {
+	mvMgr = core->getMovementMgr();
 	propMgr = StelApp::getInstance().getStelPropertyManager();
-	connect(propMgr, SIGNAL(stelPropertyChanged(StelProperty*,QVariant)), this, SLOT(sendStelPropChange(StelProperty*,QVariant)));
+
+	//the current state is the base of the first frame
+	isDirty = true;
+	collectState();
+	collectProperties();
+	encoder.encodeFrame(QDateTime::currentMSecsSinceEpoch());
+
+	connect(core,SIGNAL(timeSyncOccurred(double)),this,SLOT(reactToStellariumEvent()));
+	connect(propMgr, SIGNAL(stelPropertyChanged(StelProperty*,QVariant)), this, SLOT(stelPropertyChanged(StelProperty*,QVariant)));
 }
 
-void StelPropertyEventSender::sendStelPropChange(StelProperty* prop, const QVariant &val)
+void StateFrameEventSender::stelPropertyChanged(StelProperty* prop, const QVariant &val)
 {
 	//only send changes that can be applied on clients
 	if(prop->isSynchronizable())
-	{
-		StelPropertyUpdate msg;
-		msg.propId = prop->getId();
-		msg.value = val;
-		broadcastMessage(msg);
-	}
+		encoder.setProperty(prop->getId(), val);
 }
 
-void StelPropertyEventSender::newClientConnected(SyncRemotePeer &client)
+void StateFrameEventSender::collectState()
 {
-	//send all current StelProperty values to the client
-	QList<StelProperty*> propList = propMgr->getAllProperties();
-	foreach(StelProperty* prop, propList)
+	if(isDirty)
 	{
-		if(!prop->isSynchronizable())
-			continue;
-
-		StelPropertyUpdate msg;
-		msg.propId = prop->getId();
-		msg.value = prop->getValue();
-		client.writeMessage(msg);
+		encoder.setTime(core->getMilliSecondsOfLastJDUpdate(), core->getJDOfLastJDUpdate(), core->getTimeRate());
+		isDirty = false;
 	}
-}
 
-ViewEventSender::ViewEventSender()
-	: lastView(0.0)
-{
-	mvMgr = core->getMovementMgr();
+	//do not send view updates when tracking
+	if(!mvMgr->getFlagTracking())
+		encoder.setView(core->j2000ToAltAz(mvMgr->getViewDirectionJ2000(), StelCore::RefractionOff));
+	encoder.setFov(mvMgr->getCurrentFov());
 }
 
-SyncProtocol::View ViewEventSender::constructMessage()
+void StateFrameEventSender::collectProperties()
 {
-	View msg;
-	Vec3d viewDirJ2000 = mvMgr->getViewDirectionJ2000();
-	msg.viewAltAz = core->j2000ToAltAz(viewDirJ2000, StelCore::RefractionOff);
-	return msg;
+	foreach(StelProperty* prop, propMgr->getAllProperties())
+	{
+		if(prop->isSynchronizable())
+			encoder.setProperty(prop->getId(), prop->getValue());
+	}
 }
 
-void ViewEventSender::update()
+void StateFrameEventSender::update()
 {
-	//do not send view updates when tracking
-	if(mvMgr->getFlagTracking())
-		return;
+	collectState();
 
-	Vec3d viewDir = mvMgr->getViewDirectionJ2000();
-	viewDir = core->j2000ToAltAz(viewDir, StelCore::RefractionOff);
-	if(!(qFuzzyCompare(viewDir[0], lastView[0]) && qFuzzyCompare(viewDir[1], lastView[1]) && qFuzzyCompare(viewDir[2], lastView[2])))
+	//a frame with many properties is split in several messages
+	foreach(const QByteArray& payload, encoder.encodeFrame(QDateTime::currentMSecsSinceEpoch()))
 	{
-		lastView = viewDir;
-		broadcastMessage(constructMessage());
+		StateFrame msg;
+		msg.payload = payload;
+		broadcastMessage(msg);
 	}
 }
 
-FovEventSender::FovEventSender()
-	: lastFov(0.0)
+void StateFrameEventSender::newClientConnected(SyncRemotePeer &client)
 {
-	mvMgr = core->getMovementMgr();
-}
-
+	//also the properties registered after the start of the server, which did not change since.
+	//The values which differ from the last frame are broadcast again with the next one.
+	collectProperties();
 
-SyncProtocol::Fov FovEventSender::constructMessage()
-{
-	Fov msg;
-	msg.fov = mvMgr->getCurrentFov();
-	return msg;
-}
-
-void FovEventSender::update()
-{
-	double curFov = mvMgr->getCurrentFov();
-	if(curFov!=lastFov)
+	//the client then decodes the changes of the next frames
+	foreach(const QByteArray& payload, encoder.encodeKeyFrame(QDateTime::currentMSecsSinceEpoch()))
 	{
-		lastFov = curFov;
-		broadcastMessage(constructMessage());
+		StateFrame msg;
+		msg.payload = payload;
+		client.writeMessage(msg);
 	}
 }
@@ -22,6 +22,7 @@
 
 #include "SyncProtocol.hpp"
 #include "SyncMessages.hpp"
+#include "SyncStateFrame.hpp"
 
 class SyncServer;
 class StelCore;
@@ -33,6 +34,8 @@ class SyncServerEventSender : public QObject
 	Q_OBJECT
 public:
 	SyncServerEventSender();
+	//! For senders which do not use the application, e.g. in tests
+	explicit SyncServerEventSender(StelCore* core);
 	virtual ~SyncServerEventSender() {}
 
 protected slots:
@@ -97,17 +100,6 @@ void TypedSyncServerEventSender<T>::update()
 	}
 }
 
-//! Notifies clients of simulation time jumps and time scale changes
-class TimeEventSender : public TypedSyncServerEventSender<SyncProtocol::Time>
-{
-	Q_OBJECT
-
-public:
-	TimeEventSender();
-protected:
-	SyncProtocol::Time constructMessage() Q_DECL_OVERRIDE;
-};
-
 class LocationEventSender : public TypedSyncServerEventSender<SyncProtocol::Location>
 {
 	Q_OBJECT
@@ -128,48 +120,32 @@ private:
 	StelObjectMgr* objMgr;
 };
 
+class StelMovementMgr;
 class StelProperty;
 class StelPropertyMgr;
-class StelPropertyEventSender : public SyncServerEventSender
+//! Collects the changes of the view, fov, simulation time and StelProperties during a frame,
+//! and broadcasts them in a single STATE_FRAME at the end of the frame.
+class StateFrameEventSender : public SyncServerEventSender
 {
 	Q_OBJECT
 public:
-	StelPropertyEventSender();
+	StateFrameEventSender();
 protected slots:
-	//! Sends all current StelProperties to the client
+	//! Sends a key frame with the current values of all properties to the client
 	virtual void newClientConnected(SyncRemotePeer& client) Q_DECL_OVERRIDE;
-	void sendStelPropChange(StelProperty* prop, const QVariant& val);
-private:
-	StelPropertyMgr* propMgr;
-};
-
-class StelMovementMgr;
-class ViewEventSender : public TypedSyncServerEventSender<SyncProtocol::View>
-{
-	Q_OBJECT
-public:
-	ViewEventSender();
+	void stelPropertyChanged(StelProperty* prop, const QVariant& val);
 protected:
-	SyncProtocol::View constructMessage() Q_DECL_OVERRIDE;
-
+	//! Broadcasts the changes of this frame, if any.
+	//! isDirty is set by time jumps and time scale changes.
 	void update() Q_DECL_OVERRIDE;
 private:
-	StelMovementMgr* mvMgr;
-	Vec3d lastView;
-};
+	void collectState();
+	//! Set the current values of all synchronizable properties in the encoder
+	void collectProperties();
 
-class FovEventSender : public TypedSyncServerEventSender<SyncProtocol::Fov>
-{
-	Q_OBJECT
-public:
-	FovEventSender();
-protected:
-	SyncProtocol::Fov constructMessage() Q_DECL_OVERRIDE;
-
-	void update() Q_DECL_OVERRIDE;
-private:
 	StelMovementMgr* mvMgr;
-	double lastFov;
+	StelPropertyMgr* propMgr;
+	SyncStateEncoder encoder;
 };
 
 #endif
@@ -20,6 +20,8 @@
 #include "SyncServerHandlers.hpp"
 #include "SyncServer.hpp"
 
+#include <QDateTime>
+
 using namespace SyncProtocol;
 
 ServerHandler::ServerHandler(SyncServer *server)
@@ -105,3 +107,16 @@ bool ServerAliveHandler::handleMessage(QDataStream &stream, SyncProtocol::tPaylo
 	Alive p;
 	return p.deserialize(stream,dataSize);
 }
+
+bool ServerClockSyncHandler::handleMessage(QDataStream &stream, SyncProtocol::tPayloadSize dataSize, SyncRemotePeer &peer)
+{
+	ClockSync msg;
+	bool ok = msg.deserialize(stream,dataSize);
+	if(!ok)
+		return false;
+
+	msg.serverReceiveTime = QDateTime::currentMSecsSinceEpoch();
+	msg.serverSendTime = QDateTime::currentMSecsSinceEpoch();
+	peer.writeMessage(msg);
+	return true;
+}
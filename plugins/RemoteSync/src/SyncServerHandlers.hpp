@@ -58,4 +58,11 @@ public:
 	bool handleMessage(QDataStream &stream, SyncProtocol::tPayloadSize dataSize, SyncRemotePeer &peer) Q_DECL_OVERRIDE;
 };
 
+//! Returns the CLOCK_SYNC requests of the clients with the times of the server
+class ServerClockSyncHandler : public SyncMessageHandler
+{
+public:
+	bool handleMessage(QDataStream &stream, SyncProtocol::tPayloadSize dataSize, SyncRemotePeer &peer) Q_DECL_OVERRIDE;
+};
+
 #endif
@@ -0,0 +1,544 @@
+/*
+ * Stellarium Remote Sync plugin
+ * Copyright (C) 2017 Stellarium Developers
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Suite 500, Boston, MA  02110-1335, USA.
+ */
+
+#include "SyncStateFrame.hpp"
+#include "SyncProtocol.hpp"
+
+#include <QDataStream>
+#include <QDebug>
+
+#include <cmath>
+
+using namespace SyncProtocol;
+
+const double SyncStateEncoder::Tolerance = 1e-9;
+const int SyncStateEncoder::FrameHeaderSize = sizeof(quint32) + sizeof(qint64) + sizeof(quint8);
+// Size of the number of properties in a frame
+static const int CountSize = sizeof(quint16);
+
+// True if value is within Tolerance of base
+static bool isSame(double base, double value)
+{
+	return std::fabs(value-base) <= SyncStateEncoder::Tolerance * qMax(1.0, std::fabs(value));
+}
+
+// Get the float to add to base to get value. The decoder must compute base+double(delta) in the same way.
+// Returns false if the result is not within Tolerance of value.
+static bool getFloatDelta(double base, double value, float& delta)
+{
+	if (!(std::fabs(value-base) <= 1e6))
+		return false;
+	delta = static_cast<float>(value-base);
+	return isSame(base + static_cast<double>(delta), value);
+}
+
+// QDataStream writes floats with 8 bytes unless it is switched to single precision
+static void writeFloat(QDataStream& stream, float value)
+{
+	stream.setFloatingPointPrecision(QDataStream::SinglePrecision);
+	stream<<value;
+	stream.setFloatingPointPrecision(QDataStream::DoublePrecision);
+}
+
+static float readFloat(QDataStream& stream)
+{
+	float value = 0.f;
+	stream.setFloatingPointPrecision(QDataStream::SinglePrecision);
+	stream>>value;
+	stream.setFloatingPointPrecision(QDataStream::DoublePrecision);
+	return value;
+}
+
+// Same encoding as SyncMessage::writeString()
+static void writeString(QDataStream& stream, const QString& str)
+{
+	stream<<str.toUtf8();
+}
+
+static QString readString(QDataStream& stream)
+{
+	QByteArray arr;
+	stream>>arr;
+	return QString::fromUtf8(arr);
+}
+
+SyncState::SyncState()
+	: viewAltAz(0.0)
+	, fov(0.0)
+	, lastTimeSyncTime(0)
+	, jDay(0.0)
+	, timeRate(0.0)
+{
+}
+
+SyncStateFrame::SyncStateFrame()
+	: sequence(0)
+	, serverTime(0)
+	, fields(0)
+{
+}
+
+SyncStateEncoder::SyncStateEncoder()
+	: fieldsSet(0)
+	, fieldsSent(0)
+	, fieldsMoving(0)
+	, timeChanged(false)
+	, sequence(0)
+{
+}
+
+void SyncStateEncoder::setView(const Vec3d &viewAltAz)
+{
+	current.viewAltAz = viewAltAz;
+	fieldsSet |= SyncStateFrame::View;
+}
+
+void SyncStateEncoder::setFov(double fov)
+{
+	current.fov = fov;
+	fieldsSet |= SyncStateFrame::Fov;
+}
+
+void SyncStateEncoder::setTime(qint64 lastTimeSyncTime, double jDay, double timeRate)
+{
+	current.lastTimeSyncTime = lastTimeSyncTime;
+	current.jDay = jDay;
+	current.timeRate = timeRate;
+	fieldsSet |= SyncStateFrame::Time;
+	timeChanged = !(fieldsSent & SyncStateFrame::Time) || lastTimeSyncTime!=sent.lastTimeSyncTime
+			|| jDay!=sent.jDay || timeRate!=sent.timeRate;
+}
+
+void SyncStateEncoder::setProperty(const QString &id, const QVariant &value)
+{
+	QHash<QString, int>::const_iterator it = propertyIndices.constFind(id);
+	int index;
+	if (it!=propertyIndices.constEnd())
+		index = it.value();
+	else
+	{
+		index = properties.size();
+		if (index>=SyncStateFrame::NewProperty)
+		{
+			qWarning()<<"[SyncStateEncoder] Too many properties, ignoring"<<id;
+			return;
+		}
+		Property p;
+		p.id = id;
+		p.pending = false;
+		p.announced = false;
+		properties.append(p);
+		propertyIndices.insert(id, index);
+	}
+
+	Property& p = properties[index];
+	p.value = value;
+	if (!p.pending)
+	{
+		p.pending = true;
+		pendingProperties.append(index);
+	}
+}
+
+QList<QByteArray> SyncStateEncoder::encodeFrame(qint64 serverTime, int maxPayloadSize)
+{
+	quint8 moving = 0;
+	if ((fieldsSet & SyncStateFrame::View) && !(isSame(sent.viewAltAz[0], current.viewAltAz[0])
+						    && isSame(sent.viewAltAz[1], current.viewAltAz[1])
+						    && isSame(sent.viewAltAz[2], current.viewAltAz[2])))
+		moving |= SyncStateFrame::View;
+	if ((fieldsSet & SyncStateFrame::Fov) && !isSame(sent.fov, current.fov))
+		moving |= SyncStateFrame::Fov;
+
+	quint8 fields = moving | fieldsMoving;
+	if (timeChanged)
+		fields |= SyncStateFrame::Time;
+
+	// Only the properties which differ from the last value sent, after all changes of this frame
+	QVector<int> changed;
+	foreach (int index, pendingProperties)
+	{
+		Property& p = properties[index];
+		p.pending = false;
+		if (!p.announced || p.value!=p.sentValue)
+			changed.append(index);
+	}
+	pendingProperties.clear();
+
+	fieldsMoving = moving;
+	if (!fields && changed.isEmpty())
+		return QList<QByteArray>();
+
+	float viewDelta[3];
+	if ((fields & SyncStateFrame::View) && (fieldsSent & SyncStateFrame::View)
+	    && getFloatDelta(sent.viewAltAz[0], current.viewAltAz[0], viewDelta[0])
+	    && getFloatDelta(sent.viewAltAz[1], current.viewAltAz[1], viewDelta[1])
+	    && getFloatDelta(sent.viewAltAz[2], current.viewAltAz[2], viewDelta[2]))
+		fields |= SyncStateFrame::ViewDelta;
+	float fovDelta;
+	if ((fields & SyncStateFrame::Fov) && (fieldsSent & SyncStateFrame::Fov) && getFloatDelta(sent.fov, current.fov, fovDelta))
+		fields |= SyncStateFrame::FovDelta;
+
+	++sequence;
+	QByteArray payload;
+	QDataStream stream(&payload, QIODevice::WriteOnly);
+	stream.setVersion(SYNC_DATASTREAM_VERSION);
+	stream<<sequence<<serverTime<<fields;
+
+	if (fields & SyncStateFrame::View)
+	{
+		if (fields & SyncStateFrame::ViewDelta)
+		{
+			for (int i=0; i<3; ++i)
+			{
+				writeFloat(stream, viewDelta[i]);
+				sent.viewAltAz[i] = sent.viewAltAz[i] + static_cast<double>(viewDelta[i]);
+			}
+		}
+		else
+		{
+			stream<<current.viewAltAz;
+			sent.viewAltAz = current.viewAltAz;
+		}
+	}
+	if (fields & SyncStateFrame::Fov)
+	{
+		if (fields & SyncStateFrame::FovDelta)
+		{
+			writeFloat(stream, fovDelta);
+			sent.fov = sent.fov + static_cast<double>(fovDelta);
+		}
+		else
+		{
+			stream<<current.fov;
+			sent.fov = current.fov;
+		}
+	}
+	if (fields & SyncStateFrame::Time)
+	{
+		stream<<current.lastTimeSyncTime<<current.jDay<<current.timeRate;
+		sent.lastTimeSyncTime = current.lastTimeSyncTime;
+		sent.jDay = current.jDay;
+		sent.timeRate = current.timeRate;
+		timeChanged = false;
+	}
+	fieldsSent |= fields & (SyncStateFrame::View | SyncStateFrame::Fov | SyncStateFrame::Time);
+
+	QVector<QByteArray> entries;
+	foreach (int index, changed)
+	{
+		Property& p = properties[index];
+		const QByteArray entry = encodeProperty(index, !p.announced, p.value, maxPayloadSize);
+		if (entry.isEmpty())
+			continue;
+		entries.append(entry);
+		p.announced = true;
+		p.sentValue = p.value;
+	}
+	return splitFrame(payload, serverTime, entries, maxPayloadSize);
+}
+
+QList<QByteArray> SyncStateEncoder::encodeKeyFrame(qint64 serverTime, int maxPayloadSize) const
+{
+	const quint8 fields = SyncStateFrame::KeyFrame | fieldsSent;
+	QByteArray payload;
+	QDataStream stream(&payload, QIODevice::WriteOnly);
+	stream.setVersion(SYNC_DATASTREAM_VERSION);
+	stream<<sequence<<serverTime<<fields;
+	if (fields & SyncStateFrame::View)
+		stream<<sent.viewAltAz;
+	if (fields & SyncStateFrame::Fov)
+		stream<<sent.fov;
+	if (fields & SyncStateFrame::Time)
+		stream<<sent.lastTimeSyncTime<<sent.jDay<<sent.timeRate;
+
+	// The last values set: those which differ from the last frame are sent again in the next one
+	QVector<QByteArray> entries;
+	for (int i=0; i<properties.size(); ++i)
+	{
+		const QByteArray entry = encodeProperty(i, true, properties.at(i).value, maxPayloadSize);
+		if (!entry.isEmpty())
+			entries.append(entry);
+	}
+	return splitFrame(payload, serverTime, entries, maxPayloadSize);
+}
+
+QByteArray SyncStateEncoder::encodeProperty(int index, bool withId, const QVariant& value, int maxPayloadSize) const
+{
+	const Property& p = properties.at(index);
+	QByteArray entry;
+	QDataStream stream(&entry, QIODevice::WriteOnly);
+	stream.setVersion(SYNC_DATASTREAM_VERSION);
+	if (withId)
+	{
+		stream<<static_cast<quint16>(index | SyncStateFrame::NewProperty);
+		writeString(stream, p.id);
+	}
+	else
+		stream<<static_cast<quint16>(index);
+	stream<<value;
+
+	// It must fit in a Continued frame with only this property
+	if (FrameHeaderSize + CountSize + entry.size() > maxPayloadSize)
+	{
+		qWarning()<<"[SyncStateEncoder] The value of"<<p.id<<"is too large to be sent:"<<entry.size()<<"bytes";
+		return QByteArray();
+	}
+	return entry;
+}
+
+QList<QByteArray> SyncStateEncoder::splitFrame(QByteArray payload, qint64 serverTime, const QVector<QByteArray>& entries, int maxPayloadSize) const
+{
+	QList<QByteArray> payloads;
+	QByteArray block;
+	quint16 count = 0;
+	foreach (const QByteArray& entry, entries)
+	{
+		if (payload.size() + CountSize + block.size() + entry.size() > maxPayloadSize)
+		{
+			appendProperties(payload, count, block);
+			payloads.append(payload);
+
+			payload.clear();
+			QDataStream stream(&payload, QIODevice::WriteOnly);
+			stream.setVersion(SYNC_DATASTREAM_VERSION);
+			stream<<sequence<<serverTime<<static_cast<quint8>(SyncStateFrame::Continued);
+			block.clear();
+			count = 0;
+		}
+		block.append(entry);
+		++count;
+	}
+	if (payloads.isEmpty() || count)
+	{
+		appendProperties(payload, count, block);
+		payloads.append(payload);
+	}
+	return payloads;
+}
+
+void SyncStateEncoder::appendProperties(QByteArray& payload, quint16 count, const QByteArray& block)
+{
+	if (!count)
+		return;
+	payload[FrameHeaderSize-1] = static_cast<char>(payload.at(FrameHeaderSize-1) | SyncStateFrame::Properties);
+	QDataStream stream(&payload, QIODevice::Append);
+	stream.setVersion(SYNC_DATASTREAM_VERSION);
+	stream<<count;
+	payload.append(block);
+}
+
+SyncStateDecoder::SyncStateDecoder()
+	: sequence(0)
+	, synchronized(false)
+{
+}
+
+void SyncStateDecoder::clear()
+{
+	state = SyncState();
+	sequence = 0;
+	synchronized = false;
+	propertyIds.clear();
+}
+
+bool SyncStateDecoder::decode(const QByteArray &payload, SyncStateFrame &frame)
+{
+	QDataStream stream(payload);
+	stream.setVersion(SYNC_DATASTREAM_VERSION);
+
+	frame = SyncStateFrame();
+	stream>>frame.sequence>>frame.serverTime>>frame.fields;
+	if (stream.status()!=QDataStream::Ok)
+		return false;
+
+	const bool keyFrame = frame.has(SyncStateFrame::KeyFrame);
+	if (frame.has(SyncStateFrame::Continued))
+	{
+		// Only more properties of the last frame
+		if (!synchronized || frame.sequence!=sequence || (frame.fields & ~(SyncStateFrame::Continued | SyncStateFrame::Properties)))
+		{
+			qWarning()<<"[SyncStateDecoder] Invalid continuation of frame"<<sequence;
+			return false;
+		}
+	}
+	else if (!keyFrame && (!synchronized || frame.sequence!=sequence+1))
+	{
+		qWarning()<<"[SyncStateDecoder] Frame"<<frame.sequence<<"does not follow frame"<<sequence;
+		return false;
+	}
+	// The differences are relative to the state before this frame. A key frame starts from scratch.
+	SyncState s = keyFrame ? SyncState() : state;
+	QVector<QString> ids = keyFrame ? QVector<QString>() : propertyIds;
+
+	if (frame.has(SyncStateFrame::View))
+	{
+		if (frame.has(SyncStateFrame::ViewDelta))
+		{
+			for (int i=0; i<3; ++i)
+				s.viewAltAz[i] = s.viewAltAz[i] + static_cast<double>(readFloat(stream));
+		}
+		else
+			stream>>s.viewAltAz;
+	}
+	if (frame.has(SyncStateFrame::Fov))
+	{
+		if (frame.has(SyncStateFrame::FovDelta))
+			s.fov = s.fov + static_cast<double>(readFloat(stream));
+		else
+			stream>>s.fov;
+	}
+	if (frame.has(SyncStateFrame::Time))
+		stream>>s.lastTimeSyncTime>>s.jDay>>s.timeRate;
+	if (frame.has(SyncStateFrame::Properties))
+	{
+		quint16 count = 0;
+		stream>>count;
+		frame.properties.reserve(count);
+		for (int n=0; n<count && stream.status()==QDataStream::Ok; ++n)
+		{
+			quint16 index = 0;
+			stream>>index;
+			const int i = index & ~SyncStateFrame::NewProperty;
+			if (index & SyncStateFrame::NewProperty)
+			{
+				if (i>=ids.size())
+					ids.resize(i+1);
+				ids[i] = readString(stream);
+			}
+			if (i>=ids.size() || ids.at(i).isEmpty())
+			{
+				qWarning()<<"[SyncStateDecoder] Unknown property index"<<i;
+				return false;
+			}
+			QVariant value;
+			stream>>value;
+			frame.properties.append(qMakePair(ids.at(i), value));
+		}
+	}
+	if (stream.status()!=QDataStream::Ok || !stream.atEnd())
+		return false;
+
+	state = s;
+	propertyIds = ids;
+	sequence = frame.sequence;
+	synchronized = true;
+	frame.state = s;
+	return true;
+}
+
+SyncStateInterpolator::SyncStateInterpolator()
+	: meanLateness(0.0)
+	, latenessDeviation(0.0)
+	, meanInterval(0.0)
+{
+	samples.reserve(MaxSamples);
+}
+
+void SyncStateInterpolator::clear()
+{
+	samples.clear();
+	meanLateness = 0.0;
+	latenessDeviation = 0.0;
+	meanInterval = 0.0;
+}
+
+void SyncStateInterpolator::addSample(qint64 time, qint64 arrivalTime, const Vec3d &viewAltAz, double fov)
+{
+	const double lateness = static_cast<double>(arrivalTime-time);
+	if (samples.isEmpty())
+	{
+		meanLateness = lateness;
+		latenessDeviation = 0.0;
+	}
+	else
+	{
+		// The intervals around the pauses of the motion are not the rate of the frames
+		const qint64 interval = time-samples.last().time;
+		if (interval>0 && interval<=MaxExtrapolation)
+			meanInterval += (interval-meanInterval) / 8.0;
+		latenessDeviation += (std::fabs(lateness-meanLateness)-latenessDeviation) / 4.0;
+		meanLateness += (lateness-meanLateness) / 8.0;
+	}
+
+	// A new estimate of the clock offset can move the times of the frames backwards
+	while (!samples.isEmpty() && samples.last().time>=time)
+		samples.removeLast();
+	if (samples.size()>=MaxSamples)
+		samples.removeFirst();
+	Sample s;
+	s.time = time;
+	s.viewAltAz = viewAltAz;
+	s.fov = fov;
+	samples.append(s);
+}
+
+double SyncStateInterpolator::getDelay() const
+{
+	if (samples.isEmpty())
+		return 0.0;
+	return qBound(0.0, meanLateness + 4.0*latenessDeviation + meanInterval, static_cast<double>(MaxDelay));
+}
+
+bool SyncStateInterpolator::getState(qint64 time, Vec3d &viewAltAz, double &fov) const
+{
+	if (samples.isEmpty())
+		return false;
+
+	const Sample& last = samples.last();
+	if (time>=last.time)
+	{
+		viewAltAz = last.viewAltAz;
+		fov = last.fov;
+		if (samples.size()>=2 && time>last.time)
+		{
+			// Continue the last motion, unless it was interrupted by a pause
+			const Sample& prev = samples.at(samples.size()-2);
+			const qint64 interval = last.time-prev.time;
+			if (interval<=MaxExtrapolation)
+			{
+				const double f = static_cast<double>(qMin(time-last.time, static_cast<qint64>(MaxExtrapolation))) / interval;
+				viewAltAz = last.viewAltAz + (last.viewAltAz-prev.viewAltAz)*f;
+				viewAltAz.normalize();
+				fov = last.fov + (last.fov-prev.fov)*f;
+				if (!(fov>0.0))
+					fov = last.fov;
+			}
+		}
+		return true;
+	}
+	if (time<=samples.first().time)
+	{
+		viewAltAz = samples.first().viewAltAz;
+		fov = samples.first().fov;
+		return true;
+	}
+
+	// Interpolate between the samples around time
+	int i = samples.size()-2;
+	while (samples.at(i).time>time)
+		--i;
+	const Sample& a = samples.at(i);
+	const Sample& b = samples.at(i+1);
+	const double f = static_cast<double>(time-a.time) / (b.time-a.time);
+	viewAltAz = a.viewAltAz + (b.viewAltAz-a.viewAltAz)*f;
+	viewAltAz.normalize();
+	fov = a.fov + (b.fov-a.fov)*f;
+	return true;
+}
@@ -0,0 +1,228 @@
+/*
+ * Stellarium Remote Sync plugin
+ * Copyright (C) 2017 Stellarium Developers
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Suite 500, Boston, MA  02110-1335, USA.
+ */
+
+#ifndef SYNCSTATEFRAME_HPP_
+#define SYNCSTATEFRAME_HPP_
+
+#include "VecMath.hpp"
+#include "SyncProtocol.hpp"
+
+#include <QByteArray>
+#include <QHash>
+#include <QList>
+#include <QPair>
+#include <QString>
+#include <QVariant>
+#include <QVector>
+
+//! The continuously changing state of the server, sent in STATE_FRAME messages
+struct SyncState
+{
+	SyncState();
+
+	Vec3d viewAltAz; //view direction, without refraction
+	double fov;
+	qint64 lastTimeSyncTime; //corresponds to StelCore::milliSecondsOfLastJDayUpdate, on the clock of the server
+	double jDay; //jDay at lastTimeSyncTime, without any time zone/deltaT adjustments
+	double timeRate;
+};
+
+//! A STATE_FRAME, as decoded by SyncStateDecoder.
+//! The server sends one frame per update with the changes of the view, field of view, time and
+//! StelProperties since the previous one, so that all changes of a frame arrive and are applied together.
+//!
+//! Payload layout (QDataStream, SyncProtocol::SYNC_DATASTREAM_VERSION):
+//! - quint32 sequence number, incremented with each frame. A key frame has the number of the last frame.
+//! - qint64 server time [ms] at which the values were taken
+//! - quint8 fields, see Field
+//! - View: 3 floats added to the last view if ViewDelta is set, else 3 doubles
+//! - Fov: a float added to the last fov if FovDelta is set, else a double
+//! - Time: qint64 lastTimeSyncTime, double jDay, double timeRate
+//! - Properties: quint16 count, then for each property a quint16 index, the UTF-8 ID if the index
+//!   has the NewProperty bit (the first time the property is sent), and the QVariant value.
+//!
+//! A message can hold at most SyncProtocol::SYNC_MAX_PAYLOAD_SIZE bytes. The properties of a frame
+//! which do not fit follow in Continued frames, which have the same sequence number and server
+//! time, and only the Continued and Properties fields.
+struct SyncStateFrame
+{
+	enum Field
+	{
+		KeyFrame	= 0x01, //complete state, sent to new clients
+		View		= 0x02,
+		ViewDelta	= 0x04,
+		Fov		= 0x08,
+		FovDelta	= 0x10,
+		Time		= 0x20,
+		Properties	= 0x40,
+		Continued	= 0x80  //more properties of the previous frame
+	};
+
+	//! Set on the index of a property when its ID follows
+	static const quint16 NewProperty = 0x8000;
+
+	SyncStateFrame();
+
+	bool has(Field field) const { return (fields & field) != 0; }
+
+	quint32 sequence;
+	qint64 serverTime;
+	quint8 fields;
+	//! The state after this frame, including the fields which did not change
+	SyncState state;
+	//! The changed properties, by ID
+	QVector< QPair<QString, QVariant> > properties;
+};
+
+//! Collects the state of the server during a frame and encodes the changes since the previous frame.
+//! As TCP delivers all frames in order, the view and fov are sent as float differences to the last
+//! values sent when this is accurate to Tolerance, and both ends then add the same float to the same
+//! double, so that they keep exactly the same values without accumulating rounding errors.
+class SyncStateEncoder
+{
+public:
+	SyncStateEncoder();
+
+	void setView(const Vec3d& viewAltAz);
+	void setFov(double fov);
+	void setTime(qint64 lastTimeSyncTime, double jDay, double timeRate);
+	//! Only the last value set for a property before encodeFrame() is sent.
+	void setProperty(const QString& id, const QVariant& value);
+
+	//! Encode the changes since the last frame as the payloads of STATE_FRAMEs, and make the current
+	//! values the base of the next frame. A view or fov which stopped changing is sent once more,
+	//! so that the clients stop extrapolating it.
+	//! @param maxPayloadSize the properties which do not fit in the first payload follow in Continued frames
+	//! @return an empty list if nothing changed
+	QList<QByteArray> encodeFrame(qint64 serverTime, int maxPayloadSize = SyncProtocol::SYNC_MAX_PAYLOAD_SIZE);
+	//! Encode the values of the last frame with the last values set for all properties and their IDs,
+	//! for a new client. The client can then decode the following frames.
+	//! @param maxPayloadSize the properties which do not fit in the first payload follow in Continued frames
+	QList<QByteArray> encodeKeyFrame(qint64 serverTime, int maxPayloadSize = SyncProtocol::SYNC_MAX_PAYLOAD_SIZE) const;
+
+	//! Sequence number of the last frame
+	quint32 getSequence() const { return sequence; }
+
+	//! Relative accuracy of the float differences
+	static const double Tolerance;
+
+private:
+	//! Size of the sequence number, server time and fields at the start of each payload
+	static const int FrameHeaderSize;
+
+	//! Encode the index, the ID if withId is true, and a value of a property.
+	//! @return an empty array, with a warning, if it does not fit in a payload
+	QByteArray encodeProperty(int index, bool withId, const QVariant& value, int maxPayloadSize) const;
+	//! Add the encoded properties to payload, and start Continued frames when it is full.
+	//! @param payload the start of the frame, until the state
+	QList<QByteArray> splitFrame(QByteArray payload, qint64 serverTime, const QVector<QByteArray>& entries, int maxPayloadSize) const;
+	//! Add the count and the encoded properties, and set the Properties field
+	static void appendProperties(QByteArray& payload, quint16 count, const QByteArray& block);
+
+	struct Property
+	{
+		QString id;
+		QVariant value;
+		QVariant sentValue;
+		bool pending; //in pendingProperties
+		bool announced; //the ID was sent in a frame
+	};
+
+	SyncState current;
+	SyncState sent;
+	quint8 fieldsSet; //View, Fov and Time fields set at least once
+	quint8 fieldsSent; //View, Fov and Time fields sent at least once, which are in the key frames
+	quint8 fieldsMoving; //View and Fov fields which changed in the last frame
+	bool timeChanged;
+	quint32 sequence;
+	QVector<Property> properties;
+	QHash<QString, int> propertyIndices;
+	QVector<int> pendingProperties;
+};
+
+//! Decodes the STATE_FRAMEs of a server. The first one must be a key frame.
+class SyncStateDecoder
+{
+public:
+	SyncStateDecoder();
+
+	//! Forget the state, before the key frame of a new connection.
+	void clear();
+	//! Decode the payload of a STATE_FRAME.
+	//! @return false if the frame is invalid, or does not follow the last one decoded.
+	bool decode(const QByteArray& payload, SyncStateFrame& frame);
+
+	bool hasKeyFrame() const { return synchronized; }
+	//! The state after the last frame
+	const SyncState& getState() const { return state; }
+
+private:
+	SyncState state;
+	quint32 sequence;
+	bool synchronized;
+	QVector<QString> propertyIds;
+};
+
+//! Smooths the view and fov received in the frames of a server. The values are shown with a delay
+//! which covers the latency and jitter of the network and the interval between frames, so that the
+//! client can interpolate between two received frames instead of jumping from one to the next.
+//! When the next frame is late, the motion is extrapolated for at most MaxExtrapolation ms.
+//! All times are in ms on the local clock, i.e. the times of the server converted by SyncClock.
+class SyncStateInterpolator
+{
+public:
+	SyncStateInterpolator();
+
+	void clear();
+	//! Add the view and fov of a frame.
+	//! @param time the time of the frame
+	//! @param arrivalTime the time the frame was received
+	void addSample(qint64 time, qint64 arrivalTime, const Vec3d& viewAltAz, double fov);
+
+	bool isEmpty() const { return samples.isEmpty(); }
+	//! The delay [ms] to subtract from the current time for getState()
+	double getDelay() const;
+	//! Get the view and fov at a time.
+	//! @return false if no sample was added
+	bool getState(qint64 time, Vec3d& viewAltAz, double& fov) const;
+
+	//! Number of samples kept
+	static const int MaxSamples = 16;
+	//! Maximal duration of the extrapolation after the last sample [ms]
+	static const int MaxExtrapolation = 250;
+	//! Maximal delay [ms]
+	static const int MaxDelay = 500;
+
+private:
+	struct Sample
+	{
+		qint64 time;
+		Vec3d viewAltAz;
+		double fov;
+	};
+
+	QVector<Sample> samples;
+	//! Smoothed time between the frames and their arrival, and its mean deviation, as for TCP round trip times
+	double meanLateness;
+	double latenessDeviation;
+	//! Smoothed interval between consecutive frames
+	double meanInterval;
+};
+
+#endif
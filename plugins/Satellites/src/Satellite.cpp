@@ -766,34 +766,50 @@ void Satellite::update(double)
 		epochTime = core->getJD(); // + timeShift; // We have "true" JD (UTC) from core, satellites don't need JDE!
 
 		pSatWrapper->setEpoch(epochTime);
-		position                 = pSatWrapper->getTEMEPos();
-		velocity                 = pSatWrapper->getTEMEVel();
-		latLongSubPointPosition  = pSatWrapper->getSubPoint();
-		height                   = latLongSubPointPosition[2]; // km
-		if (height <= 150.0)
-		{
-			// The orbit is no longer valid.  Causes include very out of date
-			// TLE, system date and time out of a reasonable range, and orbital
-			// degradation and re-entry of a satellite.  In any of these cases
-			// we might end up with a problem - usually a crash of Stellarium
-			// because of a div/0 or something.  To prevent this, we turn off
-			// the satellite when the computed height is 150km. (We can assume bogus at 250km or so...)
-			qWarning() << "Satellite has invalid orbit:" << name << id;
-			orbitValid = false;
-			displayed = false; // It shouldn't be displayed!
-			return;
-		}
+		computeState(core);
 
-		elAzPosition = pSatWrapper->getAltAz();
-		elAzPosition.normalize();
+		// Compute orbit points to draw orbit line.
+		if (orbitValid && orbitDisplayed) computeOrbitPoints();
+	}
+}
 
-		pSatWrapper->getSlantRange(range, rangeRate);
-		visibility = pSatWrapper->getVisibilityPredict();
-		phaseAngle = pSatWrapper->getPhaseAngle();
+void Satellite::updatePosition(const StelCore* core)
+{
+	if (pSatWrapper && orbitValid)
+	{
+		epochTime = core->getJD();
+		pSatWrapper->propagate();
+		computeState(core);
+	}
+}
 
-		// Compute orbit points to draw orbit line.
-		if (orbitDisplayed) computeOrbitPoints();
+void Satellite::computeState(const StelCore* core)
+{
+	position                 = pSatWrapper->getTEMEPos();
+	velocity                 = pSatWrapper->getTEMEVel();
+	latLongSubPointPosition  = pSatWrapper->getSubPoint();
+	height                   = latLongSubPointPosition[2]; // km
+	if (height <= 150.0)
+	{
+		// The orbit is no longer valid.  Causes include very out of date
+		// TLE, system date and time out of a reasonable range, and orbital
+		// degradation and re-entry of a satellite.  In any of these cases
+		// we might end up with a problem - usually a crash of Stellarium
+		// because of a div/0 or something.  To prevent this, we turn off
+		// the satellite when the computed height is 150km. (We can assume bogus at 250km or so...)
+		qWarning() << "Satellite has invalid orbit:" << name << id;
+		orbitValid = false;
+		displayed = false; // It shouldn't be displayed!
+		return;
 	}
+
+	elAzPosition = pSatWrapper->getAltAz();
+	elAzPosition.normalize();
+	XYZ = getJ2000EquatorialPos(core);
+
+	pSatWrapper->getSlantRange(range, rangeRate);
+	visibility = pSatWrapper->getVisibilityPredict();
+	phaseAngle = pSatWrapper->getPhaseAngle();
 }
 
 double Satellite::getDoppler(double freq) const
@@ -889,7 +905,7 @@ void Satellite::draw(StelCore* core, StelPainter& painter)
 	if (core->getJD()<jdLaunchYearJan1 || qAbs(core->getTimeRate())>=timeRateLimit)
 		return;
 
-	XYZ = getJ2000EquatorialPos(core);
+	// XYZ has been computed in update()
 	StelSkyDrawer* sd = core->getSkyDrawer();
 	Vec3f drawColor = (visibility == gSatWrapper::VISIBLE) ? hintColor : invisibleSatelliteColor; // Use hintColor for visible satellites only
 	painter.setColor(drawColor[0], drawColor[1], drawColor[2], hintBrightness);
@@ -181,6 +181,11 @@ public:
 	// calculate faders, new position
 	void update(double deltaTime);
 
+	//! Propagate the satellite to the epoch of the frame set by gSatWrapper::setFrameEpoch()
+	//! and compute its position. Unlike update(), the orbit line is not computed, and
+	//! different satellites may be updated from several threads.
+	void updatePosition(const StelCore* core);
+
 	double getDoppler(double freq) const;
 	static bool showLabels;
 	static double roundToDp(float n, int dp);
@@ -211,6 +216,9 @@ public:
 	QString getOperationalStatus() const;
 
 private:
+	//! Compute the position quantities from the propagated state of pSatWrapper.
+	void computeState(const StelCore* core);
+
 	//draw orbits methods
 	void computeOrbitPoints();
 	void drawOrbit(StelCore* core, StelPainter& painter);
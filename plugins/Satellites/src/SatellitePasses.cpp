@@ -0,0 +1,455 @@
+/*
+ * Stellarium
+ * Copyright (C) 2017 Stellarium Developers
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Suite 500, Boston, MA  02110-1335, USA.
+ */
+
+#include "gsatellite/stdsat.h"
+#include "gsatellite/mathUtils.hpp"
+#include "gsatellite/gSatTEME.hpp"
+#include "gsatellite/gTime.hpp"
+
+#include "SatellitePasses.hpp"
+#include "StelUtils.hpp"
+
+#include <QDebug>
+#include <QMutexLocker>
+#include <QtConcurrent>
+#include <QVector>
+
+// Accuracy of the dates of the passes [d]
+static const double TIME_ACCURACY = 1./86400.;
+// Number of samples of the elevation per orbit
+static const double SAMPLES_PER_ORBIT = 90.;
+// Limits of the sampling step [d]
+static const double MIN_STEP = 0.5/1440.;
+static const double MAX_STEP = 10./1440.;
+// Number of dates of a pass where the visibility is tested
+static const int VISIBILITY_SAMPLES = 9;
+
+static QString visibilityToString(gSatWrapper::Visibility v)
+{
+	switch (v)
+	{
+		case gSatWrapper::RADAR_SUN:
+			return "sunlight";
+		case gSatWrapper::VISIBLE:
+			return "visible";
+		case gSatWrapper::RADAR_NIGHT:
+			return "eclipsed";
+		case gSatWrapper::NOT_VISIBLE:
+			return "not-visible";
+		default:
+			return "unknown";
+	}
+}
+
+QVariantMap SatellitePass::toVariantMap() const
+{
+	QVariantMap map;
+	map.insert("id", id);
+	map.insert("name", name);
+	map.insert("aos", aos);
+	map.insert("aos-utc", StelUtils::julianDayToISO8601String(aos));
+	map.insert("aos-azimuth", aosAzimuth);
+	map.insert("tca", tca);
+	map.insert("tca-utc", StelUtils::julianDayToISO8601String(tca));
+	map.insert("tca-azimuth", tcaAzimuth);
+	map.insert("max-elevation", maxElevation);
+	map.insert("los", los);
+	map.insert("los-utc", StelUtils::julianDayToISO8601String(los));
+	map.insert("los-azimuth", losAzimuth);
+	map.insert("visibility-aos", visibilityToString(visibilityAtAos));
+	map.insert("visibility-tca", visibilityToString(visibilityAtTca));
+	map.insert("visibility-los", visibilityToString(visibilityAtLos));
+	map.insert("visible", visible);
+	return map;
+}
+
+//! Position of a satellite seen by an observer, computed with its own copy of the orbit.
+class PassTracker
+{
+public:
+	PassTracker(const SatellitePassPredictor::Elements& satellite, const SatellitePassPredictor::Observer& observer)
+		: observer(observer), valid(true)
+	{
+		// The TLE library modifies the strings, see gSatWrapper.
+		QByteArray t1(satellite.tle1), t2(satellite.tle2);
+		t1.truncate(130);
+		t2.truncate(130);
+		orbit = new gSatTEME(satellite.id.toLatin1().data(), t1.data(), t2.data());
+		valid = orbit->getErrorCode()==0 && orbit->getMeanMotion()>0.;
+	}
+	~PassTracker()
+	{
+		delete orbit;
+	}
+
+	bool isValid() const { return valid; }
+	//! Orbital period [d]
+	double getPeriod() const { return K2PI/orbit->getMeanMotion()/1440.; }
+
+	//! Compute the state of the satellite at jd. Return the elevation in degrees.
+	//! After a propagation error, isValid() returns false and the elevation is -90.
+	double compute(double jd)
+	{
+		const gTime t(jd);
+		orbit->setEpoch(t);
+		if (orbit->getErrorCode()!=0)
+		{
+			valid = false;
+			satECIPos.set(0., 0., 0.);
+			elevation = -90.;
+			azimuth = 0.;
+			return elevation;
+		}
+		const gVector p = orbit->getPos();
+		satECIPos.set(p[0], p[1], p[2]);
+
+		// Observer ECI position, as in gSatWrapper::calcObserverECIPosition()
+		const double radLatitude = observer.latitude*KDEG2RAD;
+		const double theta = t.toThetaLMST(observer.longitude*KDEG2RAD);
+		sinLat = sin(radLatitude);
+		cosLat = cos(radLatitude);
+		sinTheta = sin(theta);
+		cosTheta = cos(theta);
+		const double c = 1/std::sqrt(1 + __f*(__f - 2)*Sqr(sinLat));
+		const double sq = Sqr(1 - __f)*c;
+		const double r = (KEARTHRADIUS*c + observer.altitude/1000)*cosLat;
+		observerECIPos.set(r*cosTheta, r*sinTheta, (KEARTHRADIUS*sq + observer.altitude/1000)*sinLat);
+
+		const Vec3d topo = toTopocentric(satECIPos - observerECIPos);
+		elevation = std::asin(topo[2]/topo.length())/KDEG2RAD;
+		azimuth = std::atan2(topo[1], -topo[0])/KDEG2RAD;
+		if (azimuth<0.)
+			azimuth += 360.;
+		return elevation;
+	}
+
+	//! Visibility of the satellite at the date of the last compute(), as in gSatWrapper::getVisibilityPredict().
+	gSatWrapper::Visibility getVisibility(double jd) const
+	{
+		if (elevation<0.)
+			return gSatWrapper::NOT_VISIBLE;
+		const Vec3d sunECIPos = computeSunECIPos(jd);
+		const Vec3d sunTopo = toTopocentric(sunECIPos - observerECIPos);
+		if (sunTopo[2]>0.)
+			return gSatWrapper::RADAR_SUN;
+		// The satellite is in the shadow of the Earth if it is behind the Earth in the cylinder of its shadow.
+		Vec3d sunDir(sunECIPos);
+		sunDir.normalize();
+		const double along = satECIPos.dot(sunDir);
+		const double across = (satECIPos - sunDir*along).length();
+		return (along>0. || across>KEARTHRADIUS) ? gSatWrapper::VISIBLE : gSatWrapper::RADAR_NIGHT;
+	}
+
+	double elevation;
+	double azimuth;
+
+private:
+	//! Topocentric South, East, Zenith coordinates of an ECI vector from the observer
+	Vec3d toTopocentric(const Vec3d& v) const
+	{
+		return Vec3d(sinLat*cosTheta*v[0] + sinLat*sinTheta*v[1] - cosLat*v[2],
+			     -sinTheta*v[0] + cosTheta*v[1],
+			     cosLat*cosTheta*v[0] + cosLat*sinTheta*v[1] + sinLat*v[2]);
+	}
+
+	//! Low precision geocentric equatorial position of the Sun [km], from the Astronomical Almanac (0.01 deg).
+	static Vec3d computeSunECIPos(double jd)
+	{
+		const double n = jd - 2451545.0;
+		const double L = (280.460 + 0.9856474*n)*KDEG2RAD;
+		const double g = (357.528 + 0.9856003*n)*KDEG2RAD;
+		const double lambda = L + (1.915*sin(g) + 0.020*sin(2*g))*KDEG2RAD;
+		const double epsilon = (23.439 - 0.0000004*n)*KDEG2RAD;
+		const double r = (1.00014 - 0.01671*cos(g) - 0.00014*cos(2*g))*AU;
+		return Vec3d(r*cos(lambda), r*cos(epsilon)*sin(lambda), r*sin(epsilon)*sin(lambda));
+	}
+
+	gSatTEME* orbit;
+	const SatellitePassPredictor::Observer observer;
+	bool valid;
+	Vec3d satECIPos;
+	Vec3d observerECIPos;
+	double sinLat, cosLat, sinTheta, cosTheta;
+};
+
+//! Find the date of the maximum elevation in [a, b] by golden section search.
+static double findMaximum(PassTracker& tracker, double a, double b)
+{
+	static const double ratio = 0.6180339887498949;
+	double c = b - ratio*(b-a);
+	double d = a + ratio*(b-a);
+	double ec = tracker.compute(c);
+	double ed = tracker.compute(d);
+	while (b-a > TIME_ACCURACY && tracker.isValid())
+	{
+		if (ec>ed)
+		{
+			b = d;
+			d = c;
+			ed = ec;
+			c = b - ratio*(b-a);
+			ec = tracker.compute(c);
+		}
+		else
+		{
+			a = c;
+			c = d;
+			ec = ed;
+			d = a + ratio*(b-a);
+			ed = tracker.compute(d);
+		}
+	}
+	return 0.5*(a+b);
+}
+
+//! Find the date where the elevation crosses minElevation in [below, above] by bisection.
+//! @return the end of the last interval above minElevation
+static double findCrossing(PassTracker& tracker, double below, double above, double minElevation)
+{
+	while (qAbs(above-below) > TIME_ACCURACY && tracker.isValid())
+	{
+		const double m = 0.5*(below+above);
+		if (tracker.compute(m)>=minElevation)
+			above = m;
+		else
+			below = m;
+	}
+	return above;
+}
+
+bool SatellitePassPredictor::computePasses(const Elements& satellite, const Observer& observer,
+					   double startJD, double endJD, double minElevation, QList<SatellitePass>& passes)
+{
+	passes.clear();
+	PassTracker tracker(satellite, observer);
+	if (!tracker.isValid() || endJD<=startJD)
+		return false;
+
+	// Coarse sampling of the elevation
+	const double step = qBound(MIN_STEP, tracker.getPeriod()/SAMPLES_PER_ORBIT, MAX_STEP);
+	const int n = static_cast<int>(std::ceil((endJD-startJD)/step));
+	QVector<double> t(n+1), e(n+1);
+	for (int i=0; i<=n; ++i)
+	{
+		t[i] = qMin(startJD + i*step, endJD);
+		e[i] = tracker.compute(t[i]);
+		if (!tracker.isValid())
+			return false;
+	}
+
+	// Each local maximum of the samples above minElevation is refined, and gives a pass if the refined
+	// maximum is above minElevation. Passes too short to contain a sample are found this way too.
+	for (int i=0; i<=n; ++i)
+	{
+		if ((i>0 && e[i]<e[i-1]) || (i<n && e[i]<=e[i+1]))
+			continue;
+		double tca = findMaximum(tracker, t[qMax(i-1, 0)], t[qMin(i+1, n)]);
+		double maxElevation = tracker.compute(tca);
+		// The highest point of a pass cut by the time window is at its start or end.
+		if ((i==0 || i==n) && e[i]>maxElevation)
+		{
+			tca = t[i];
+			maxElevation = tracker.compute(tca);
+		}
+		if (!tracker.isValid())
+			return false;
+		if (maxElevation<minElevation)
+			continue;
+		if (!passes.isEmpty() && tca<=passes.last().los)
+		{
+			// Another local maximum of the same pass: the closest approach is the highest one.
+			SatellitePass& last = passes.last();
+			if (maxElevation>last.maxElevation)
+			{
+				last.tca = tca;
+				last.maxElevation = maxElevation;
+				last.tcaAzimuth = tracker.azimuth;
+				last.visibilityAtTca = tracker.getVisibility(tca);
+			}
+			continue;
+		}
+
+		SatellitePass pass;
+		pass.id = satellite.id;
+		pass.name = satellite.name;
+		pass.tca = tca;
+		pass.maxElevation = maxElevation;
+		pass.tcaAzimuth = tracker.azimuth;
+		pass.visibilityAtTca = tracker.getVisibility(tca);
+
+		// Step back to below minElevation, then bisect.
+		double above = tca;
+		pass.aos = startJD;
+		while (above>startJD)
+		{
+			const double below = qMax(startJD, above-step);
+			if (tracker.compute(below)<minElevation)
+			{
+				pass.aos = findCrossing(tracker, below, above, minElevation);
+				break;
+			}
+			above = below;
+		}
+		// Same forward
+		above = tca;
+		pass.los = endJD;
+		while (above<endJD)
+		{
+			const double below = qMin(endJD, above+step);
+			if (tracker.compute(below)<minElevation)
+			{
+				pass.los = findCrossing(tracker, below, above, minElevation);
+				break;
+			}
+			above = below;
+		}
+		if (!tracker.isValid())
+			return false;
+
+		tracker.compute(pass.aos);
+		pass.aosAzimuth = tracker.azimuth;
+		pass.visibilityAtAos = tracker.getVisibility(pass.aos);
+		tracker.compute(pass.los);
+		pass.losAzimuth = tracker.azimuth;
+		pass.visibilityAtLos = tracker.getVisibility(pass.los);
+		for (int k=0; k<VISIBILITY_SAMPLES && !pass.visible; ++k)
+		{
+			const double jd = pass.aos + (pass.los-pass.aos)*k/(VISIBILITY_SAMPLES-1);
+			tracker.compute(jd);
+			pass.visible = tracker.getVisibility(jd)==gSatWrapper::VISIBLE;
+		}
+		passes.append(pass);
+	}
+	return tracker.isValid();
+}
+
+void SatellitePassPredictor::appendPasses(const Elements& satellite, const Observer& observer, const QList<SatellitePass>& passes,
+					  double startJD, double endJD, double minElevation, QList<SatellitePass>& result)
+{
+	foreach (const SatellitePass& pass, passes)
+	{
+		if (pass.los<startJD || pass.aos>endJD)
+			continue;
+		if (pass.aos>=startJD && pass.los<=endJD)
+		{
+			result.append(pass);
+			continue;
+		}
+		// The closest approach, the elevation and the visibility of a cut pass depend on the window.
+		QList<SatellitePass> cut;
+		if (computePasses(satellite, observer, qMax(pass.aos, startJD), qMin(pass.los, endJD), minElevation, cut))
+			result.append(cut);
+	}
+}
+
+//! Compute the passes of one satellite of the list.
+class ComputePassesJob
+{
+public:
+	ComputePassesJob(const QList<SatellitePassPredictor::Elements>& satellites, const SatellitePassPredictor::Observer& observer,
+			 double startJD, double endJD, double minElevation, QList<SatellitePass>* passes, bool* ok)
+		: satellites(satellites), observer(observer), startJD(startJD), endJD(endJD), minElevation(minElevation)
+		, passes(passes), ok(ok) {}
+	void operator()(const int& i)
+	{
+		ok[i] = SatellitePassPredictor::computePasses(satellites.at(i), observer, startJD, endJD, minElevation, passes[i]);
+	}
+private:
+	const QList<SatellitePassPredictor::Elements>& satellites;
+	const SatellitePassPredictor::Observer observer;
+	const double startJD;
+	const double endJD;
+	const double minElevation;
+	QList<SatellitePass>* passes;
+	bool* ok;
+};
+
+static bool passLessThan(const SatellitePass& a, const SatellitePass& b)
+{
+	return a.tca<b.tca;
+}
+
+QList<SatellitePass> SatellitePassPredictor::predict(const QList<Elements>& satellites, const Observer& observer,
+						     double startJD, double endJD, double minElevation)
+{
+	QList<SatellitePass> result;
+	QList<Elements> missing;
+	QList<Elements> cached;
+	QList<QList<SatellitePass> > cachedPasses;
+	mutex.lock();
+	foreach (const Elements& sat, satellites)
+	{
+		QHash<QString, CacheEntry>::const_iterator it = cache.constFind(sat.id);
+		if (it!=cache.constEnd() && it->elementsEpoch==getElementsEpoch(sat) && it->covers(observer, startJD, endJD, minElevation))
+		{
+			cached.append(sat);
+			cachedPasses.append(it->passes);
+		}
+		else
+			missing.append(sat);
+	}
+	mutex.unlock();
+
+	for (int i=0; i<cached.size(); ++i)
+		appendPasses(cached.at(i), observer, cachedPasses.at(i), startJD, endJD, minElevation, result);
+
+	if (!missing.isEmpty())
+	{
+		QVector<QList<SatellitePass> > passes(missing.size());
+		QVector<bool> ok(missing.size());
+		QVector<int> indices(missing.size());
+		for (int i=0; i<missing.size(); ++i)
+			indices[i] = i;
+		QtConcurrent::blockingMap(indices, ComputePassesJob(missing, observer, startJD, endJD, minElevation,
+								    passes.data(), ok.data()));
+		QMutexLocker locker(&mutex);
+		for (int i=0; i<missing.size(); ++i)
+		{
+			if (!ok[i])
+			{
+				qWarning() << "[Satellites] cannot predict the passes of" << missing.at(i).id << missing.at(i).name;
+				continue;
+			}
+			CacheEntry entry;
+			entry.elementsEpoch = getElementsEpoch(missing.at(i));
+			entry.observer = observer;
+			entry.startJD = startJD;
+			entry.endJD = endJD;
+			entry.minElevation = minElevation;
+			entry.passes = passes.at(i);
+			cache.insert(missing.at(i).id, entry);
+			result.append(entry.passes);
+		}
+	}
+
+	qSort(result.begin(), result.end(), passLessThan);
+	return result;
+}
+
+void SatellitePassPredictor::invalidate(const QString& id)
+{
+	QMutexLocker locker(&mutex);
+	cache.remove(id);
+}
+
+void SatellitePassPredictor::clear()
+{
+	QMutexLocker locker(&mutex);
+	cache.clear();
+}
@@ -0,0 +1,167 @@
+/*
+ * Stellarium
+ * Copyright (C) 2017 Stellarium Developers
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Suite 500, Boston, MA  02110-1335, USA.
+ */
+
+#ifndef _SATELLITEPASSES_HPP_
+#define _SATELLITEPASSES_HPP_ 1
+
+#include "gSatWrapper.hpp"
+
+#include <QByteArray>
+#include <QHash>
+#include <QList>
+#include <QMetaType>
+#include <QMutex>
+#include <QString>
+#include <QVariantMap>
+
+//! One pass of a satellite above the horizon of an observer.
+//! Dates are Julian days (UTC), angles are in degrees.
+//! @ingroup satellites
+struct SatellitePass
+{
+	SatellitePass()
+		: aos(0.), tca(0.), los(0.)
+		, aosAzimuth(0.), tcaAzimuth(0.), losAzimuth(0.), maxElevation(0.)
+		, visibilityAtAos(gSatWrapper::UNKNOWN)
+		, visibilityAtTca(gSatWrapper::UNKNOWN)
+		, visibilityAtLos(gSatWrapper::UNKNOWN)
+		, visible(false) {}
+
+	QString id;
+	QString name;
+	//! Acquisition of signal: the satellite rises above the minimum elevation.
+	double aos;
+	//! Time of closest approach: the satellite is at its highest elevation.
+	double tca;
+	//! Loss of signal: the satellite sets below the minimum elevation.
+	double los;
+	double aosAzimuth;
+	double tcaAzimuth;
+	double losAzimuth;
+	double maxElevation;
+	gSatWrapper::Visibility visibilityAtAos;
+	gSatWrapper::Visibility visibilityAtTca;
+	gSatWrapper::Visibility visibilityAtLos;
+	//! Whether the satellite is sunlit while the observer is in the dark at some time of the pass.
+	bool visible;
+
+	//! The pass as a map for scripts and the remote control API.
+	QVariantMap toVariantMap() const;
+};
+
+//! Predicts the passes of satellites over an observer, independently of the current
+//! date of the program.
+//!
+//! Each satellite is propagated with its own copy of its orbit, so that satellites are
+//! computed in parallel in the global thread pool. The elevation of the satellite is sampled
+//! with a step of about 1/90 of its orbital period; the maxima of the elevation are then
+//! refined by golden section search, and the times of rising and setting by bisection.
+//! The illumination of the satellite uses a low precision position of the Sun, which is
+//! enough to tell whether the satellite is in the shadow of the Earth.
+//!
+//! The passes found are kept for each satellite with the epoch of its orbital elements.
+//! They are reused for later requests within the same time window and location, until
+//! invalidate() is called or the orbital elements change. All methods are thread-safe, so
+//! that the remote control API computes the passes outside of the main thread.
+//! @ingroup satellites
+class SatellitePassPredictor
+{
+public:
+	//! Orbital elements of a satellite to predict.
+	struct Elements
+	{
+		QString id;
+		QString name;
+		QByteArray tle1;
+		QByteArray tle2;
+	};
+
+	//! Location of the observer. Angles in degrees, altitude in meters.
+	struct Observer
+	{
+		Observer() : latitude(0.), longitude(0.), altitude(0.) {}
+		Observer(double latitude, double longitude, double altitude)
+			: latitude(latitude), longitude(longitude), altitude(altitude) {}
+		bool operator==(const Observer& o) const
+		{
+			return latitude==o.latitude && longitude==o.longitude && altitude==o.altitude;
+		}
+		double latitude;
+		double longitude;
+		double altitude;
+	};
+
+	//! Satellites and observer of a prediction, collected in the main thread by Satellites::getPassRequest().
+	struct Request
+	{
+		Request() : currentJD(0.) {}
+		QList<Elements> satellites;
+		Observer observer;
+		//! Current date of the program (Julian day, UTC), the default start of the time window.
+		double currentJD;
+	};
+
+	//! Get the passes of the satellites which begin, end or culminate within [startJD, endJD],
+	//! sorted by time of closest approach.
+	//! @param minElevation minimum elevation of a pass in degrees
+	QList<SatellitePass> predict(const QList<Elements>& satellites, const Observer& observer,
+				     double startJD, double endJD, double minElevation);
+
+	//! Drop the passes kept for a satellite.
+	void invalidate(const QString& id);
+	//! Drop all passes kept.
+	void clear();
+
+	//! Compute the passes of one satellite. Thread-safe.
+	//! Passes in progress at startJD or endJD are cut at these dates.
+	//! @return false if the orbital elements cannot be propagated.
+	static bool computePasses(const Elements& satellite, const Observer& observer,
+				  double startJD, double endJD, double minElevation, QList<SatellitePass>& passes);
+
+private:
+	//! Passes of a satellite for a time window.
+	struct CacheEntry
+	{
+		//! Epoch field of the first line of the TLE set.
+		QByteArray elementsEpoch;
+		Observer observer;
+		double startJD;
+		double endJD;
+		double minElevation;
+		QList<SatellitePass> passes;
+		bool covers(const Observer& o, double start, double end, double minEl) const
+		{
+			return observer==o && startJD<=start && endJD>=end && minElevation==minEl;
+		}
+	};
+
+	static QByteArray getElementsEpoch(const Elements& satellite) { return satellite.tle1.mid(18, 14); }
+	//! Append to result the cached passes of a satellite within [startJD, endJD]. The passes in progress
+	//! at startJD or endJD are computed again within the window, so that they are cut as by computePasses().
+	static void appendPasses(const Elements& satellite, const Observer& observer, const QList<SatellitePass>& passes,
+				 double startJD, double endJD, double minElevation, QList<SatellitePass>& result);
+
+	//! Protects the cache. It is not held while the passes are computed.
+	QMutex mutex;
+	QHash<QString, CacheEntry> cache;
+};
+
+Q_DECLARE_METATYPE(SatellitePassPredictor::Request)
+
+#endif // _SATELLITEPASSES_HPP_
@@ -33,6 +33,7 @@
 #include "Satellites.hpp"
 #include "Satellite.hpp"
 #include "SatellitesListModel.hpp"
+#include "SatellitesRemoteControlService.hpp"
 #include "Planet.hpp"
 #include "SolarSystem.hpp"
 #include "StelJsonParser.hpp"
@@ -41,6 +42,7 @@
 #include "StelTranslator.hpp"
 #include "StelProgressController.hpp"
 #include "StelUtils.hpp"
+#include "StelGeodesicGrid.hpp"
 
 #include "external/qtcompress/qzipreader.h"
 
@@ -55,12 +57,21 @@
 #include <QVariant>
 #include <QDir>
 #include <QTemporaryFile>
+#include <QThread>
+#include <QtConcurrent>
 
 StelModule* SatellitesStelPluginInterface::getStelModule() const
 {
 	return new Satellites();
 }
 
+QObjectList SatellitesStelPluginInterface::getExtensionList() const
+{
+	QObjectList ret;
+	ret.append(new SatellitesRemoteControlService());
+	return ret;
+}
+
 StelPluginInfo SatellitesStelPluginInterface::getPluginInfo() const
 {
 	// Allow to load the resources when used as a static plugin
@@ -273,21 +284,28 @@ QList<StelObjectP> Satellites::searchAround(const Vec3d& av, double limitFov, co
 	Vec3d v(av);
 	v.normalize();
 	double cosLimFov = cos(limitFov * M_PI/180.);
-	Vec3d equPos;
+	if (zoneStart.isEmpty())
+		return result;
 
-	foreach(const SatelliteP& sat, satellites)
+	// Only the satellites of the zones around v are tested.
+	QVector<SphericalCap> caps;
+	caps.append(SphericalCap(v, cosLimFov));
+	const GeodesicSearchResult* searchResult = core->getGeodesicGrid(ZoneLevel)->search(caps, ZoneLevel);
+	int zone;
+	for (GeodesicSearchInsideIterator it(*searchResult, ZoneLevel); (zone = it.next()) >= 0;)
+		searchAroundInZone(zone, v, cosLimFov, result);
+	for (GeodesicSearchBorderIterator it(*searchResult, ZoneLevel); (zone = it.next()) >= 0;)
+		searchAroundInZone(zone, v, cosLimFov, result);
+	return result;
+}
+
+void Satellites::searchAroundInZone(int zone, const Vec3d& v, double cosLimFov, QList<StelObjectP>& result) const
+{
+	for (int i=zoneStart[zone]; i<zoneStart[zone+1]; ++i)
 	{
-		if (sat->initialized && sat->displayed)
-		{
-			equPos = sat->XYZ;
-			equPos.normalize();
-			if (equPos[0]*v[0] + equPos[1]*v[1] + equPos[2]*v[2]>=cosLimFov)
-			{
-				result.append(qSharedPointerCast<StelObject>(sat));
-			}
-		}
+		if (frameX[i]*v[0] + frameY[i]*v[1] + frameZ[i]*v[2]>=cosLimFov && frameSatellites[i]->displayed)
+			result.append(qSharedPointerCast<StelObject>(frameSatellites[i]));
 	}
-	return result;
 }
 
 StelObjectP Satellites::searchByNameI18n(const QString& nameI18n) const
@@ -815,6 +833,8 @@ void Satellites::setDataMap(const QVariantMap& map)
 		satelliteListModel->beginSatellitesChange();
 	
 	satellites.clear();
+	clearFrameSatellites();
+	passPredictor.clear();
 	groups.clear();
 	QVariantMap satMap = map.value("satellites").toMap();
 	foreach(const QString& satId, satMap.keys())
@@ -1036,12 +1056,15 @@ void Satellites::remove(const QStringList& idList)
 				objMgr->unSelect();
 			
 			qDebug() << "Satellite removed:" << sat->id << sat->name;
+			passPredictor.invalidate(sat->id);
 			satellites.removeAt(i);
 			i--; //Compensate for the change in the array's indexing
 			numRemoved++;
 		}
 	}
 	// As the satellite list is kept sorted, no need for re-sorting.
+	if (numRemoved>0)
+		clearFrameSatellites();
 	
 	if (satelliteListModel)
 		satelliteListModel->endSatellitesChange();
@@ -1402,6 +1425,48 @@ void Satellites::hideMessages()
 	}
 }
 
+QVariantList Satellites::getSatellitePasses(const QStringList& ids, double startJD, double endJD, double minElevation)
+{
+	QVariantList result;
+	SatellitePassPredictor::Request request;
+	if (!getPassRequest(ids, request))
+		return result;
+	foreach(const SatellitePass& pass, passPredictor.predict(request.satellites, request.observer, startJD, endJD, minElevation))
+		result.append(pass.toVariantMap());
+	return result;
+}
+
+bool Satellites::getPassRequest(const QStringList& ids, SatellitePassPredictor::Request& request) const
+{
+	StelCore* core = StelApp::getInstance().getCore();
+	if (core->getCurrentPlanet()!=earth)
+	{
+		qWarning() << "[Satellites] passes can only be predicted for an observer on the Earth";
+		return false;
+	}
+
+	QSet<QString> idSet = ids.toSet();
+	request.satellites.clear();
+	foreach(const SatelliteP& sat, satellites)
+	{
+		if (!sat->initialized || !sat->orbitValid)
+			continue;
+		if (idSet.isEmpty() ? !sat->displayed : !idSet.contains(sat->id))
+			continue;
+		SatellitePassPredictor::Elements e;
+		e.id = sat->id;
+		e.name = sat->name;
+		e.tle1 = sat->tleElements.first;
+		e.tle2 = sat->tleElements.second;
+		request.satellites.append(e);
+	}
+
+	const StelLocation& loc = core->getCurrentLocation();
+	request.observer = SatellitePassPredictor::Observer(loc.latitude, loc.longitude, loc.altitude);
+	request.currentJD = core->getJD();
+	return true;
+}
+
 void Satellites::saveCatalog(QString path)
 {
 	saveDataMap(createDataMap(), path);
@@ -1475,6 +1540,7 @@ void Satellites::updateSatellites(TleDataHash& newTleSets)
 			{
 				// We have updated TLE elements for this satellite
 				sat->setNewTleElements(newTle.first, newTle.second);
+				passPredictor.invalidate(id);
 				
 				// Update the name if it has been changed in the source list
 				sat->name = newTle.name;
@@ -1695,11 +1761,124 @@ void Satellites::update(double deltaTime)
 
 	hintFader.update((int)(deltaTime*1000));
 
+	updateFrameSatellites(core);
+}
+
+// Number of satellites propagated by one job of the thread pool
+static const int SATELLITES_PER_JOB = 256;
+
+//! Propagate the satellites from index start of the frame, and compute their directions and zones.
+class UpdateSatelliteChunk
+{
+public:
+	UpdateSatelliteChunk(const StelCore* core, const StelGeodesicGrid* grid, int level, const QVector<SatelliteP>& sats,
+			     float* x, float* y, float* z, int* zone)
+		: core(core), grid(grid), level(level), sats(sats), x(x), y(y), z(z), zone(zone) {}
+	void operator()(const int& start)
+	{
+		const int end = qMin(start+SATELLITES_PER_JOB, sats.size());
+		for (int i=start; i<end; ++i)
+		{
+			Satellite* sat = sats.at(i).data();
+			sat->updatePosition(core);
+			const Vec3f dir = sat->getJ2000EquatorialPos(core).toVec3f();
+			x[i] = dir[0];
+			y[i] = dir[1];
+			z[i] = dir[2];
+			zone[i] = grid->getZoneNumberForPoint(dir, level);
+		}
+	}
+private:
+	const StelCore* core;
+	const StelGeodesicGrid* grid;
+	const int level;
+	const QVector<SatelliteP>& sats;
+	float* x;
+	float* y;
+	float* z;
+	int* zone;
+};
+
+void Satellites::updateFrameSatellites(const StelCore* core)
+{
+	// The positions of the observer and the Sun are computed once here, the
+	// propagation of each satellite then only modifies the satellite itself.
+	gSatWrapper::setFrameEpoch(core->getJD());
+
+	QVector<SatelliteP> sats;
+	sats.reserve(satellites.size());
 	foreach(const SatelliteP& sat, satellites)
 	{
 		if (sat->initialized && sat->displayed)
-			sat->update(deltaTime);
+			sats.append(sat);
+	}
+	const int n = sats.size();
+	QVector<float> x(n), y(n), z(n);
+	QVector<int> zone(n);
+	const StelGeodesicGrid* grid = core->getGeodesicGrid(ZoneLevel);
+	UpdateSatelliteChunk chunk(core, grid, ZoneLevel, sats, x.data(), y.data(), z.data(), zone.data());
+	if (QThread::idealThreadCount()<2 || n<=SATELLITES_PER_JOB)
+	{
+		for (int i=0; i<n; i+=SATELLITES_PER_JOB)
+			chunk(i);
 	}
+	else
+	{
+		QVector<int> starts;
+		for (int i=0; i<n; i+=SATELLITES_PER_JOB)
+			starts.append(i);
+		QtConcurrent::blockingMap(starts, chunk);
+	}
+
+	// Sort the satellites by zone (counting sort), leaving out those found to have an invalid orbit.
+	// The orbit lines use other epochs, for which gSatWrapper computes the position of the Sun
+	// with the SolarSystem, so they are computed here in the main thread.
+	const int nrOfZones = StelGeodesicGrid::nrOfZones(ZoneLevel);
+	zoneStart.fill(0, nrOfZones+1);
+	frameOrbits.clear();
+	for (int i=0; i<n; ++i)
+	{
+		Satellite* sat = sats[i].data();
+		if (!sat->orbitValid)
+		{
+			zone[i] = -1;
+			continue;
+		}
+		zoneStart[zone[i]+1]++;
+		if (sat->orbitDisplayed)
+		{
+			sat->computeOrbitPoints();
+			frameOrbits.append(sats[i]);
+		}
+	}
+	for (int j=0; j<nrOfZones; ++j)
+		zoneStart[j+1] += zoneStart[j];
+	const int m = zoneStart[nrOfZones];
+	frameSatellites.resize(m);
+	frameX.resize(m);
+	frameY.resize(m);
+	frameZ.resize(m);
+	QVector<int> next(zoneStart);
+	for (int i=0; i<n; ++i)
+	{
+		if (zone[i]<0)
+			continue;
+		const int k = next[zone[i]]++;
+		frameSatellites[k] = sats[i];
+		frameX[k] = x[i];
+		frameY[k] = y[i];
+		frameZ[k] = z[i];
+	}
+}
+
+void Satellites::clearFrameSatellites()
+{
+	frameSatellites.clear();
+	frameX.clear();
+	frameY.clear();
+	frameZ.clear();
+	zoneStart.clear();
+	frameOrbits.clear();
 }
 
 void Satellites::draw(StelCore* core)
@@ -1722,16 +1901,48 @@ void Satellites::draw(StelCore* core)
 	painter.setBlending(true);
 	Satellite::hintTexture->bind();
 	Satellite::viewportHalfspace = painter.getProjector()->getBoundingCap();
-	foreach (const SatelliteP& sat, satellites)
-	{
-		if (sat && sat->initialized && sat->displayed)
-			sat->draw(core, painter);
+	if (!zoneStart.isEmpty())
+	{
+		// Only the satellites of the zones in the viewport are drawn.
+		const GeodesicSearchResult* searchResult = core->getGeodesicGrid(ZoneLevel)->search(
+			prj->getViewportConvexPolygon()->getBoundingSphericalCaps(), ZoneLevel);
+		QVector<bool> drawn(zoneStart.size()-1, false);
+		int zone;
+		for (GeodesicSearchInsideIterator it(*searchResult, ZoneLevel); (zone = it.next()) >= 0;)
+			drawZone(core, painter, zone, drawn);
+		for (GeodesicSearchBorderIterator it(*searchResult, ZoneLevel); (zone = it.next()) >= 0;)
+			drawZone(core, painter, zone, drawn);
+
+		// The orbit lines of the other satellites may still cross the viewport.
+		if (Satellite::orbitLinesFlag)
+		{
+			const StelGeodesicGrid* grid = core->getGeodesicGrid(ZoneLevel);
+			// Same conditions as in Satellite::draw()
+			const bool timeRateOk = qAbs(core->getTimeRate())<Satellite::timeRateLimit;
+			foreach (const SatelliteP& sat, frameOrbits)
+			{
+				if (timeRateOk && sat->displayed && sat->orbitValid && core->getJD()>=sat->jdLaunchYearJan1
+				    && !drawn[grid->getZoneNumberForPoint(sat->XYZ.toVec3f(), ZoneLevel)])
+					sat->drawOrbit(core, painter);
+			}
+		}
 	}
 
 	if (GETSTELMODULE(StelObjectMgr)->getFlagSelectedObjectPointer())
 		drawPointer(core, painter);
 }
 
+void Satellites::drawZone(StelCore* core, StelPainter& painter, int zone, QVector<bool>& drawn)
+{
+	drawn[zone] = true;
+	for (int i=zoneStart[zone]; i<zoneStart[zone+1]; ++i)
+	{
+		const SatelliteP& sat = frameSatellites[i];
+		if (sat->displayed)
+			sat->draw(core, painter);
+	}
+}
+
 void Satellites::drawPointer(StelCore* core, StelPainter& painter)
 {
 	const StelProjectorP prj = core->getProjection(StelCore::FrameJ2000);
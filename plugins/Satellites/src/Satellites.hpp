@@ -22,6 +22,7 @@
 
 #include "StelObjectModule.hpp"
 #include "Satellite.hpp"
+#include "SatellitePasses.hpp"
 #include "StelFader.hpp"
 #include "StelGui.hpp"
 #include "StelDialog.hpp"
@@ -32,6 +33,7 @@
 #include <QDir>
 #include <QUrl>
 #include <QVariantMap>
+#include <QVector>
 
 class StelButton;
 class Planet;
@@ -472,6 +474,23 @@ public slots:
 	//! @param depth in days
 	void setIridiumFlaresPredictionDepth(int depth) { iridiumFlaresPredictionDepth=depth; }
 
+	//! Predict the passes of satellites over the current location of the observer.
+	//! The passes are computed in parallel, and kept until the orbital elements of the satellites change.
+	//! @param ids the catalog numbers of the satellites; all displayed satellites if empty
+	//! @param startJD, endJD the time window (Julian days, UTC)
+	//! @param minElevation the minimum elevation of the passes in degrees
+	//! @return one map per pass (see SatellitePass::toVariantMap()), sorted by time of closest approach
+	QVariantList getSatellitePasses(const QStringList& ids, double startJD, double endJD, double minElevation=0.);
+
+public:
+	//! Collect the orbital elements of satellites and the location of the observer for a prediction
+	//! of passes with getPassPredictor(). Must be called from the main thread.
+	//! @param ids the catalog numbers of the satellites; all displayed satellites if empty
+	//! @return false if the observer is not on the Earth
+	bool getPassRequest(const QStringList& ids, SatellitePassPredictor::Request& request) const;
+	//! The predictor used by getSatellitePasses(), which may be used from any thread.
+	SatellitePassPredictor* getPassPredictor() { return &passPredictor; }
+
 private slots:
 
 private:
@@ -542,6 +561,32 @@ private:
 	QList<SatelliteP> satellites;
 	SatellitesListModel* satelliteListModel;
 
+	//! @name Satellites of the current frame
+	//! The satellites updated by update(), sorted by the zone of the geodesic grid (at level
+	//! ZoneLevel) in which they are, so that draw() and searchAround() only visit the satellites
+	//! of the zones near the viewport or the searched point.
+	//@{
+	//! Level of the geodesic grid used to sort the satellites.
+	static const int ZoneLevel = 3;
+	//! Compute the positions of the satellites and sort them by zone.
+	void updateFrameSatellites(const StelCore* core);
+	void clearFrameSatellites();
+	//! Draw the satellites of a zone and mark it as drawn.
+	void drawZone(StelCore* core, StelPainter& painter, int zone, QVector<bool>& drawn);
+	//! Append to result the satellites of a zone within the angle acos(cosLimFov) of v.
+	void searchAroundInZone(int zone, const Vec3d& v, double cosLimFov, QList<StelObjectP>& result) const;
+	QVector<SatelliteP> frameSatellites;
+	//! J2000 directions of frameSatellites, one array per coordinate.
+	QVector<float> frameX, frameY, frameZ;
+	//! The satellites of zone z are frameSatellites[zoneStart[z]] to frameSatellites[zoneStart[z+1]-1].
+	QVector<int> zoneStart;
+	//! Satellites of the frame with the orbit line displayed, drawn even out of the viewport.
+	QVector<SatelliteP> frameOrbits;
+	//@}
+
+	//! Passes predicted by getSatellitePasses().
+	SatellitePassPredictor passPredictor;
+
 	QHash<QString, double> qsMagList;
 	
 	//! Union of the groups used by all loaded satellites - see @ref groups.
@@ -638,7 +683,7 @@ class SatellitesStelPluginInterface : public QObject, public StelPluginInterface
 public:
 	virtual StelModule* getStelModule() const;
 	virtual StelPluginInfo getPluginInfo() const;
-	virtual QObjectList getExtensionList() const { return QObjectList(); }
+	virtual QObjectList getExtensionList() const;
 };
 
 #endif /*_SATELLITES_HPP_*/
@@ -0,0 +1,124 @@
+/*
+ * Stellarium
+ * Copyright (C) 2017 Stellarium Developers
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Suite 500, Boston, MA  02110-1335, USA.
+ */
+
+#include "SatellitesRemoteControlService.hpp"
+#include "Satellites.hpp"
+
+#include "StelApp.hpp"
+#include "StelCore.hpp"
+#include "StelModuleMgr.hpp"
+
+#include <QJsonArray>
+
+SatellitesRemoteControlService::SatellitesRemoteControlService()
+{
+	satellites = GETSTELMODULE(Satellites);
+	qRegisterMetaType<SatellitePassPredictor::Request>();
+}
+
+QLatin1String SatellitesRemoteControlService::getPath() const
+{
+	return QLatin1String("satellites");
+}
+
+bool SatellitesRemoteControlService::isThreadSafe() const
+{
+	// The passes are computed in the HTTP thread, see get()
+	return true;
+}
+
+void SatellitesRemoteControlService::update(double deltaTime)
+{
+	Q_UNUSED(deltaTime)
+}
+
+SatellitePassPredictor::Request SatellitesRemoteControlService::getPassRequest(const QStringList& ids)
+{
+	SatellitePassPredictor::Request request;
+	if(!satellites->getPassRequest(ids, request))
+		request.currentJD = 0.;
+	return request;
+}
+
+void SatellitesRemoteControlService::get(const QByteArray &operation, const APIParameters &parameters, APIServiceResponse &response)
+{
+	if(operation == "passes")
+	{
+		if(!satellites)
+		{
+			response.setStatus(503, "service unavailable");
+			response.setData("the Satellites plugin is not loaded");
+			return;
+		}
+
+		QStringList ids;
+		QString idsString = QString::fromUtf8(parameters.value("ids"));
+		if(!idsString.isEmpty())
+			ids = idsString.split(',', QString::SkipEmptyParts);
+
+		// Only the satellites and the location are read in the main thread
+		SatellitePassPredictor::Request request;
+		QMetaObject::invokeMethod(this, "getPassRequest", Qt::BlockingQueuedConnection,
+					  Q_RETURN_ARG(SatellitePassPredictor::Request, request),
+					  Q_ARG(QStringList, ids));
+		if(request.currentJD==0.)
+		{
+			response.writeRequestError("passes can only be predicted for an observer on the Earth");
+			return;
+		}
+
+		bool ok = true;
+		double start = request.currentJD;
+		if(parameters.contains("start"))
+			start = parameters.value("start").toDouble(&ok);
+		double end = start + 1.;
+		if(ok && parameters.contains("end"))
+			end = parameters.value("end").toDouble(&ok);
+		double minElevation = 0.;
+		if(ok && parameters.contains("minelevation"))
+			minElevation = parameters.value("minelevation").toDouble(&ok);
+		if(!ok || end<=start)
+		{
+			response.writeRequestError("invalid start, end or minelevation parameter");
+			return;
+		}
+		if(end-start>MaxTimeWindow)
+		{
+			response.writeRequestError(QString("the time window is limited to %1 days").arg(MaxTimeWindow).toUtf8());
+			return;
+		}
+
+		QVariantList passes;
+		foreach(const SatellitePass& pass, satellites->getPassPredictor()->predict(request.satellites, request.observer, start, end, minElevation))
+			passes.append(pass.toVariantMap());
+		response.writeJSON(QJsonDocument(QJsonArray::fromVariantList(passes)));
+	}
+	else
+	{
+		response.writeRequestError("unsupported operation. GET: passes");
+	}
+}
+
+void SatellitesRemoteControlService::post(const QByteArray &operation, const APIParameters &parameters, const QByteArray &data, APIServiceResponse &response)
+{
+	Q_UNUSED(operation)
+	Q_UNUSED(parameters)
+	Q_UNUSED(data)
+	response.writeRequestError("unsupported operation. POST: none");
+}
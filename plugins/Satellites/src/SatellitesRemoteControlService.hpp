@@ -0,0 +1,63 @@
+/*
+ * Stellarium
+ * Copyright (C) 2017 Stellarium Developers
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Suite 500, Boston, MA  02110-1335, USA.
+ */
+
+#ifndef _SATELLITESREMOTECONTROLSERVICE_HPP_
+#define _SATELLITESREMOTECONTROLSERVICE_HPP_
+
+#include "../../RemoteControl/include/RemoteControlServiceInterface.hpp"
+#include "SatellitePasses.hpp"
+
+class Satellites;
+
+//! Provides a Satellites service for the \ref remoteControl plugin.
+//! GET satellites/passes returns the passes predicted by Satellites::getSatellitePasses().
+//! Its parameters are ids (comma-separated catalog numbers, all displayed satellites
+//! if missing), start and end (Julian days UTC, default the next day) and minelevation (degrees).
+//! The time window is limited to MaxTimeWindow days.
+//!
+//! The requests are handled in the HTTP thread: only the satellites and the location are
+//! collected in the main thread, so that the program is not blocked while the passes are computed.
+//! @ingroup satellites
+class SatellitesRemoteControlService : public QObject, public RemoteControlServiceInterface
+{
+	Q_OBJECT
+	Q_INTERFACES(RemoteControlServiceInterface)
+
+public:
+	//! Longest time window of a request of passes [d]
+	static const int MaxTimeWindow = 3;
+
+	SatellitesRemoteControlService();
+
+	// RemoteControlServiceInterface interface
+	virtual QLatin1String getPath() const Q_DECL_OVERRIDE;
+	virtual bool isThreadSafe() const Q_DECL_OVERRIDE;
+	virtual void get(const QByteArray &operation, const APIParameters &parameters, APIServiceResponse &response) Q_DECL_OVERRIDE;
+	virtual void post(const QByteArray &operation, const APIParameters &parameters, const QByteArray &data, APIServiceResponse &response) Q_DECL_OVERRIDE;
+	virtual void update(double deltaTime) Q_DECL_OVERRIDE;
+
+private slots:
+	//! Called in the main thread, see Satellites::getPassRequest()
+	SatellitePassPredictor::Request getPassRequest(const QStringList& ids);
+
+private:
+	Satellites* satellites;
+};
+
+#endif // _SATELLITESREMOTECONTROLSERVICE_HPP_
@@ -123,56 +123,85 @@ void gSatWrapper::setEpoch(double ai_julianDaysEpoch)
 		pSatellite->setEpoch(epoch);
 }
 
+void gSatWrapper::setFrameEpoch(double ai_julianDaysEpoch)
+{
+	// Always recompute: the location may have changed while the time was stopped.
+	frameEpoch = ai_julianDaysEpoch;
+	computeObserverECI(frameEpoch, frameObserver);
+	computeSunECI(frameObserver, frameSunECIPos, frameSunAboveHorizon);
+}
 
-void gSatWrapper::calcObserverECIPosition(Vec3d& ao_position, Vec3d& ao_velocity)
+void gSatWrapper::propagate()
 {
+	epoch = frameEpoch;
+	if (pSatellite)
+		pSatellite->setEpoch(epoch);
+}
 
-	if (epoch != lastCalcObserverECIPosition)
-	{
-		StelLocation loc   = StelApp::getInstance().getCore()->getCurrentLocation();
-
-		double radLatitude = loc.latitude * KDEG2RAD;
-		double theta       = epoch.toThetaLMST(loc.longitude * KDEG2RAD);
-		double r;
-		double c,sq;
-
-		/* Reference:  Explanatory supplement to the Astronomical Almanac 1992, page 209-210. */
-		/* Elipsoid earth model*/
-		/* c = Nlat/a */
-		c = 1/std::sqrt(1 + __f*(__f - 2)*Sqr(sin(radLatitude)));
-		sq = Sqr(1 - __f)*c;
-
-		r = (KEARTHRADIUS*c + (loc.altitude/1000))*cos(radLatitude);
-		ao_position[0] = r * cos(theta);/*kilometers*/
-		ao_position[1] = r * sin(theta);
-		ao_position[2] = (KEARTHRADIUS*sq + (loc.altitude/1000))*sin(radLatitude);
-		ao_velocity[0] = -KMFACTOR*ao_position[1];/*kilometers/second*/
-		ao_velocity[1] =  KMFACTOR*ao_position[0];
-		ao_velocity[2] =  0;
-
-		lastCalcObserverECIPosition=epoch;
-	}
+
+void gSatWrapper::computeObserverECI(const gTime& ai_epoch, ObserverECI& ao_observer)
+{
+	StelLocation loc   = StelApp::getInstance().getCore()->getCurrentLocation();
+
+	double radLatitude = loc.latitude * KDEG2RAD;
+	double theta       = ai_epoch.toThetaLMST(loc.longitude * KDEG2RAD);
+	double r;
+
+	ao_observer.sinRadLatitude = sin(radLatitude);
+	ao_observer.cosRadLatitude = cos(radLatitude);
+	ao_observer.sinTheta       = sin(theta);
+	ao_observer.cosTheta       = cos(theta);
+	double c,sq;
+
+	/* Reference:  Explanatory supplement to the Astronomical Almanac 1992, page 209-210. */
+	/* Elipsoid earth model*/
+	/* c = Nlat/a */
+	c = 1/std::sqrt(1 + __f*(__f - 2)*Sqr(ao_observer.sinRadLatitude));
+	sq = Sqr(1 - __f)*c;
+
+	Vec3d& ao_position = ao_observer.position;
+	Vec3d& ao_velocity = ao_observer.velocity;
+	r = (KEARTHRADIUS*c + (loc.altitude/1000))*ao_observer.cosRadLatitude;
+	ao_position[0] = r * ao_observer.cosTheta;/*kilometers*/
+	ao_position[1] = r * ao_observer.sinTheta;
+	ao_position[2] = (KEARTHRADIUS*sq + (loc.altitude/1000))*ao_observer.sinRadLatitude;
+	ao_velocity[0] = -KMFACTOR*ao_position[1];/*kilometers/second*/
+	ao_velocity[1] =  KMFACTOR*ao_position[0];
+	ao_velocity[2] =  0;
+}
+
+void gSatWrapper::getObserverECI(ObserverECI& ao_observer) const
+{
+	if (epoch == frameEpoch)
+		ao_observer = frameObserver;
+	else
+		computeObserverECI(epoch, ao_observer);
+}
+
+void gSatWrapper::calcObserverECIPosition(Vec3d& ao_position, Vec3d& ao_velocity) const
+{
+	ObserverECI observer;
+	getObserverECI(observer);
+	ao_position = observer.position;
+	ao_velocity = observer.velocity;
 }
 
 
 
 Vec3d gSatWrapper::getAltAz() const
 {
-	StelLocation loc   = StelApp::getInstance().getCore()->getCurrentLocation();
 	Vec3d topoSatPos;
 
-	const double  radLatitude    = loc.latitude * KDEG2RAD;
-	const double  theta          = epoch.toThetaLMST(loc.longitude * KDEG2RAD);
-	const double sinRadLatitude=sin(radLatitude);
-	const double cosRadLatitude=cos(radLatitude);
-	const double sinTheta=sin(theta);
-	const double cosTheta=cos(theta);
-
-	// This now only updates if required.
-	calcObserverECIPosition(observerECIPos, observerECIVel);
+	// The observer position of the frame is computed only once for all satellites.
+	ObserverECI observer;
+	getObserverECI(observer);
+	const double sinRadLatitude = observer.sinRadLatitude;
+	const double cosRadLatitude = observer.cosRadLatitude;
+	const double sinTheta = observer.sinTheta;
+	const double cosTheta = observer.cosTheta;
 
 	Vec3d satECIPos  = getTEMEPos();
-	Vec3d slantRange = satECIPos - observerECIPos;
+	Vec3d slantRange = satECIPos - observer.position;
 
 	//top_s
 	topoSatPos[0] = (sinRadLatitude * cosTheta*slantRange[0]
@@ -192,8 +221,8 @@ Vec3d gSatWrapper::getAltAz() const
 
 void  gSatWrapper::getSlantRange(double &ao_slantRange, double &ao_slantRangeRate) const
 {
-	//Vec3d observerECIPos;
-	//Vec3d observerECIVel;
+	Vec3d observerECIPos;
+	Vec3d observerECIVel;
 	calcObserverECIPosition(observerECIPos, observerECIVel);
 
         Vec3d satECIPos            = getTEMEPos();
@@ -205,50 +234,57 @@ void  gSatWrapper::getSlantRange(double &ao_slantRange, double &ao_slantRangeRat
         ao_slantRangeRate = slantRange.dot(slantRangeVelocity)/ao_slantRange;
 }
 
-// Does the actual computation only if necessary (0.1s apart) and caches the result in a static variable.
-void gSatWrapper::updateSunECIPos()
+// Uses the Sun of the current date of the core, as seen from the observer position at the epoch.
+// Only called from the main thread: by setFrameEpoch(), or for epochs other than the one of the frame.
+void gSatWrapper::computeSunECI(const ObserverECI& ai_observer, Vec3d& ao_sunECIPos, bool& ao_sunAboveHorizon)
 {
 	// All positions in ECI system are positions referenced in a StelCore::EquinoxEq system centered in the earth centre
-	//Vec3d observerECIPos;
-	//Vec3d observerECIVel;
-	calcObserverECIPosition(observerECIPos, observerECIVel);
-
 	static const SolarSystem *solsystem = (SolarSystem*)StelApp::getInstance().getModuleMgr().getModule("SolarSystem");
-	Vec3d sunEquinoxEqPos = solsystem->getSun()->getEquinoxEquatorialPos(StelApp::getInstance().getCore());
+	const StelCore* core = StelApp::getInstance().getCore();
+	Vec3d sunEquinoxEqPos = solsystem->getSun()->getEquinoxEquatorialPos(core);
+	ao_sunAboveHorizon = solsystem->getSun()->getAltAzPosGeometric(core)[2] > 0.0;
 
 	//sunEquinoxEqPos is measured in AU. we need measure it in Km
-	//Vec3d sunECIPos;
-	sunECIPos.set(sunEquinoxEqPos[0]*AU, sunEquinoxEqPos[1]*AU, sunEquinoxEqPos[2]*AU);
-	sunECIPos = sunECIPos + observerECIPos; //Change ref system centre
-
-
-
+	ao_sunECIPos.set(sunEquinoxEqPos[0]*AU, sunEquinoxEqPos[1]*AU, sunEquinoxEqPos[2]*AU);
+	ao_sunECIPos = ao_sunECIPos + ai_observer.position; //Change ref system centre
 }
 
-Vec3d gSatWrapper::getSunECIPos()
+Vec3d gSatWrapper::getSunECIPos() const
 {
-	if (epoch != lastSunECIepoch)
-	{
-		updateSunECIPos();
-		lastSunECIepoch=epoch;
-	}
+	if (epoch == frameEpoch)
+		return frameSunECIPos;
+	ObserverECI observer;
+	computeObserverECI(epoch, observer);
+	Vec3d sunECIPos;
+	bool sunAboveHorizon;
+	computeSunECI(observer, sunECIPos, sunAboveHorizon);
 	return sunECIPos;
 }
 
 // Operation getVisibilityPredict
 // @brief This operation predicts the satellite visibility conditions.
-gSatWrapper::Visibility gSatWrapper::getVisibilityPredict()
+gSatWrapper::Visibility gSatWrapper::getVisibilityPredict() const
 {
 	Vec3d satAltAzPos = getAltAz();
 
 	if (satAltAzPos[2] > 0)
 	{
 		Vec3d satECIPos = getTEMEPos();
-		static const SolarSystem *solsystem = (SolarSystem*)StelApp::getInstance().getModuleMgr().getModule("SolarSystem");
-		Vec3d sunAltAzPos = solsystem->getSun()->getAltAzPosGeometric(StelApp::getInstance().getCore());
-		Vec3d sunECIPos = getSunECIPos();
+		Vec3d sunECIPos;
+		bool sunAboveHorizon;
+		if (epoch == frameEpoch)
+		{
+			sunECIPos = frameSunECIPos;
+			sunAboveHorizon = frameSunAboveHorizon;
+		}
+		else
+		{
+			ObserverECI observer;
+			computeObserverECI(epoch, observer);
+			computeSunECI(observer, sunECIPos, sunAboveHorizon);
+		}
 
-		if (sunAltAzPos[2] > 0.0)
+		if (sunAboveHorizon)
 		{
 			return RADAR_SUN;
 		}
@@ -277,10 +313,7 @@ double gSatWrapper::getPhaseAngle() const
 	return sunECIPos.angle(getTEMEPos());
 }
 
-gTime gSatWrapper::epoch;
-gTime gSatWrapper::lastSunECIepoch=0.0; // store last time of computation to avoid all-1 computations.
-gTime gSatWrapper::lastCalcObserverECIPosition;
-
-Vec3d gSatWrapper::sunECIPos; // enough to have this once.
-Vec3d gSatWrapper::observerECIPos;
-Vec3d gSatWrapper::observerECIVel;
+gTime gSatWrapper::frameEpoch=0.0;
+gSatWrapper::ObserverECI gSatWrapper::frameObserver;
+Vec3d gSatWrapper::frameSunECIPos; // enough to have this once.
+bool gSatWrapper::frameSunAboveHorizon=false;
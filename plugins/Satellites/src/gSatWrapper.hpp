@@ -59,6 +59,19 @@ public:
 	//! from Stellarium Julian Date.
 	void setEpoch(double ai_julianDaysEpoch);
 
+	// Operation setFrameEpoch
+	//! @brief Set the epoch of the current frame, and compute once the positions
+	//! of the observer and the Sun for this epoch, for all satellites.
+	//! Must be called from the main thread before the satellites are propagated with propagate().
+	static void setFrameEpoch(double ai_julianDaysEpoch);
+
+	// Operation propagate
+	//! @brief Propagate the satellite to the epoch set by setFrameEpoch().
+	//! Only the state of this satellite is modified, and the positions of the observer and
+	//! the Sun of the frame are only read, so that different satellites may be propagated and
+	//! queried (getAltAz(), getVisibilityPredict()...) from several threads.
+	void propagate();
+
 	// Operation getTEMEPos
 	//! @brief This operation isolate gSatTEME getPos operation.
 	//! @return Vec3d with TEME position. Units measured in Km.
@@ -67,7 +80,7 @@ public:
 	// Operation getSunECIPos
 	//! @brief Get Sun positions in ECI system.
 	//! @return Vec3d with ECI position.
-	static Vec3d getSunECIPos();
+	Vec3d getSunECIPos() const;
 
 	// Operation getTEMEVel
 	//! @brief This operation isolate gSatTEME getVel operation.
@@ -115,7 +128,7 @@ public:
         //! @par References
         //!   Fundamentals of Astrodynamis and Applications (Third Edition) pg 898
         //!   David A. Vallado
-	Visibility getVisibilityPredict();
+	Visibility getVisibilityPredict() const;
 
 	double getPhaseAngle() const;
 	gTime	getEpoch() const { return epoch; }
@@ -134,22 +147,40 @@ public:
 	//!   http://www.celestrak.com/columns/v02n02/
         //! @param[out] ao_position Observer ECI position vector measured in Km
         //! @param[out] ao_vel Observer ECI velocity vector measured in Km/s
-	static void calcObserverECIPosition(Vec3d& ao_position, Vec3d& ao_vel) ;
+	void calcObserverECIPosition(Vec3d& ao_position, Vec3d& ao_vel) const;
 
 
 private:
-	//! do the actual work to compute a cached value.
-	static void updateSunECIPos();
+	//! Position of the observer in ECI system at one epoch, with the trigonometric
+	//! functions of its latitude and local sidereal time.
+	struct ObserverECI
+	{
+		Vec3d position;
+		Vec3d velocity;
+		double sinRadLatitude;
+		double cosRadLatitude;
+		double sinTheta;
+		double cosTheta;
+	};
+
+	//! Compute the observer position at the epoch ai_epoch.
+	static void computeObserverECI(const gTime& ai_epoch, ObserverECI& ao_observer);
+	//! Compute the Sun position in ECI system as seen by the observer, and whether it is above the horizon.
+	static void computeSunECI(const ObserverECI& ai_observer, Vec3d& ao_sunECIPos, bool& ao_sunAboveHorizon);
+	//! Get the observer position at the epoch of this satellite: the one of the frame when
+	//! the satellite was propagated to the frame epoch, otherwise computed for this call.
+	void getObserverECI(ObserverECI& ao_observer) const;
 
 	gSatTEME *pSatellite;
-	static gTime	 epoch;
+	//! Epoch of this satellite, set by setEpoch() or propagate().
+	gTime	 epoch;
 
 	// GZ We can avoid many computations (solar and observer positions for every satellite) by computing them only once for all objects.
-	static gTime lastSunECIepoch; // store last time of computation to avoid all-1 computations.
-	static Vec3d sunECIPos;       // enough to have these once.
-	static Vec3d observerECIPos;
-	static Vec3d observerECIVel;
-	static gTime lastCalcObserverECIPosition;
+	// They are written by setFrameEpoch() in the main thread, and only read while the satellites are propagated.
+	static gTime frameEpoch;
+	static ObserverECI frameObserver;
+	static Vec3d frameSunECIPos;
+	static bool frameSunAboveHorizon;
 
 };
 
@@ -129,6 +129,18 @@ public:
 		return satrec.error;
 	}
 
+	//! @return Julian day (UTC) of the epoch of the orbital elements
+	double getElementsEpoch() const
+	{
+		return satrec.jdsatepoch;
+	}
+
+	//! @return mean motion in rad/min
+	double getMeanMotion() const
+	{
+		return satrec.no;
+	}
+
 private:
 	// Operation:  computeSubPoint
 	//! @brief Compute the Geographic satellite subpoint Vector
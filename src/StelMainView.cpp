@@ -768,6 +768,7 @@ void StelMainView::init()
 	actionMgr->addAction("actionReload_Shaders", N_("Miscellaneous"), N_("Reload shaders (for development)"), this, "reloadShaders()", "Ctrl+R, P");
 	actionMgr->addAction("actionSet_Full_Screen_Global", N_("Display Options"), N_("Full-screen mode"), this, "fullScreen", "F11");
 	
+	StelPainter::setFlagTextAtlas(conf->value("video/flag_text_atlas", false).toBool());
 	StelPainter::initGLShaders();
 
 	guiItem = new StelGuiItem(rootItem);
@@ -70,6 +70,14 @@ public:
 		*mag += airmass(altAzPos[2], false) * ext_coeff;
 	}
 
+	//! Same as above for arrays of size num, where sinAlt holds only the z components
+	//! of the NORMALIZED (geometrical) altAz position vectors, i.e. sin(geometric_altitude).
+	void forward(const float* sinAlt, float* mag, int num) const
+	{
+		for (int i=0;i<num;++i)
+			mag[i] += airmass(sinAlt[i], false) * ext_coeff;
+	}
+
 	//! Compute inverse extinction effect for arrays of size num position vectors and magnitudes.
 	//! @param altAzPos are the NORMALIZED (!!) (geometrical) star position vectors, and their z components sin(geometric_altitude).
 	//! Note that forward/backward are no absolute reverse operations!
@@ -716,6 +716,7 @@ void StelApp::draw()
 	prepareRenderBuffer();
 	currentFbo = renderBuffer ? renderBuffer->handle() : drawFbo;
 
+	StelPainter::resetTextStatistics();
 	core->preDraw();
 
 	const QList<StelModule*> modules = moduleMgr->getCallOrders(StelModule::ActionDraw);
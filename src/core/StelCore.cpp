@@ -26,6 +26,7 @@
 #include "StelApp.hpp"
 #include "StelUtils.hpp"
 #include "StelGeodesicGrid.hpp"
+#include "StelIAUConstellationIndex.hpp"
 #include "StelMovementMgr.hpp"
 #include "StelModuleMgr.hpp"
 #include "StelPainter.hpp"
@@ -47,7 +48,7 @@
 #include <QSettings>
 #include <QDebug>
 #include <QMetaEnum>
-#include <QTimeZone>
+#include <QDateTime>
 #include <QFile>
 #include <QDir>
 
@@ -98,6 +99,7 @@ StelCore::StelCore()
 	, de431Available(false)
 	, de430Active(false)
 	, de431Active(false)
+	, deltaTCache(computeDeltaTForCache, this)
 {
 	setObjectName("StelCore");
 	registerMathMetaTypes();
@@ -1080,7 +1082,7 @@ qint64 StelCore::getMilliSecondsOfLastJDUpdate() const
 void StelCore::setJD(double newJD)
 {
 	JD.first=newJD;
-	JD.second=computeDeltaT(newJD);	
+	JD.second=computeDeltaTDirect(newJD);
 	resetSync();
 }
 
@@ -1092,7 +1094,7 @@ double StelCore::getJD() const
 void StelCore::setJDE(double newJDE)
 {
 	// nitpickerish this is not exact, but as good as it gets...
-	JD.second=computeDeltaT(newJDE);
+	JD.second=computeDeltaTDirect(newJDE);
 	JD.first=newJDE-JD.second/86400.0;
 	resetSync();
 }
@@ -1158,9 +1160,9 @@ void StelCore::moveObserverToSelected()
 				loc.state = "";
 
 				// Let's try guess name of location...
-				LocationMap results = StelApp::getInstance().getLocationMgr().pickLocationsNearby(loc.planetName, loc.longitude, loc.latitude, 1.0f);
-				if (results.size()>0)
-					loc = results.value(results.firstKey()); // ...and use it!
+				const StelLocation nearest = StelApp::getInstance().getLocationMgr().pickNearestLocation(loc.planetName, loc.longitude, loc.latitude, 1.0f);
+				if (nearest.isValid())
+					loc = nearest; // ...and use it!
 
 				moveObserverTo(loc);
 
@@ -1292,30 +1294,29 @@ void StelCore::moveObserverTo(const StelLocation& target, double duration, doubl
 
 float StelCore::getUTCOffset(const double JD) const
 {
-	int year, month, day, hour, minute, second;
-	StelUtils::getDateFromJulianDay(JD, &year, &month, &day);
-	StelUtils::getTimeFromJulianDay(JD, &hour, &minute, &second);
-	// as analogous to second statement in getJDFromDate, nkerr
-	if ( year <= 0 )
-	{
-		year = year - 1;
-	}
-	//getTime/DateFromJulianDay returns UTC time, not local time
-	QDateTime universal(QDate(year, month, day), QTime(hour, minute, second), Qt::UTC);
-	if (!universal.isValid())
-	{
-		//qWarning() << "JD " << QString("%1").arg(JD) << " out of bounds of QT help with GMT shift, using current datetime";
-		// Assumes the GMT shift was always the same before year -4710
-		universal = QDateTime(QDate(-4710, month, day), QTime(hour, minute, second), Qt::UTC);
-	}
-
-	StelLocation loc = getCurrentLocation();
-	QString tzName = getCurrentTimeZone();
-	QTimeZone* tz = new QTimeZone(tzName.toUtf8());
+	const StelLocation& loc = getCurrentLocation();
+	const QString& tzName = currentTimeZone;
 
 	int shiftInSeconds = 0;
-	if (tzName=="system_default" || (loc.planetName=="Earth" && !tz->isValid() && !QString("LMST LTST").contains(tzName)))
+	if (tzName=="system_default" || (loc.planetName=="Earth" && !utcOffsetTable.isValid() && !QString("LMST LTST").contains(tzName)))
 	{
+		int year, month, day, hour, minute, second;
+		StelUtils::getDateFromJulianDay(JD, &year, &month, &day);
+		StelUtils::getTimeFromJulianDay(JD, &hour, &minute, &second);
+		// as analogous to second statement in getJDFromDate, nkerr
+		if ( year <= 0 )
+		{
+			year = year - 1;
+		}
+		//getTime/DateFromJulianDay returns UTC time, not local time
+		QDateTime universal(QDate(year, month, day), QTime(hour, minute, second), Qt::UTC);
+		if (!universal.isValid())
+		{
+			//qWarning() << "JD " << QString("%1").arg(JD) << " out of bounds of QT help with GMT shift, using current datetime";
+			// Assumes the GMT shift was always the same before year -4710
+			universal = QDateTime(QDate(-4710, month, day), QTime(hour, minute, second), Qt::UTC);
+		}
+
 		QDateTime local = universal.toLocalTime();
 		//Both timezones should be interpreted as UTC because secsTo() converts both
 		//times to UTC if their zones have different daylight saving time rules.
@@ -1325,13 +1326,8 @@ float StelCore::getUTCOffset(const double JD) const
 	else
 	{
 		// The first adoption of a standard time was on December 1, 1847 in Great Britain
-		if (tz->isValid() && loc.planetName=="Earth" && (JD>=StelCore::TZ_ERA_BEGINNING || getUseCustomTimeZone()))
-		{
-			if (getUseDST())
-				shiftInSeconds = tz->offsetFromUtc(universal);
-			else
-				shiftInSeconds = tz->standardTimeOffset(universal);
-		}
+		if (utcOffsetTable.isValid() && loc.planetName=="Earth" && (JD>=StelCore::TZ_ERA_BEGINNING || getUseCustomTimeZone()))
+			shiftInSeconds = utcOffsetTable.getOffset(JD);
 		else
 			shiftInSeconds = (loc.longitude/15.f)*3600.f; // Local Mean Solar Time
 
@@ -1340,9 +1336,6 @@ float StelCore::getUTCOffset(const double JD) const
 
 	}
 
-	delete tz;
-	tz = Q_NULLPTR;
-
 	float shiftInHours = shiftInSeconds / 3600.0f;
 	return shiftInHours;
 }
@@ -1355,6 +1348,7 @@ QString StelCore::getCurrentTimeZone() const
 void StelCore::setCurrentTimeZone(const QString& tz)
 {
 	currentTimeZone = tz;
+	utcOffsetTable.build(currentTimeZone, getUseDST());
 }
 
 bool StelCore::getUseDST() const
@@ -1365,6 +1359,7 @@ bool StelCore::getUseDST() const
 void StelCore::setUseDST(const bool b)
 {
 	flagUseDST = b;
+	utcOffsetTable.build(currentTimeZone, getUseDST());
 	StelApp::getInstance().getSettings()->setValue("localization/flag_dst", b);
 }
 
@@ -1837,7 +1832,7 @@ void StelCore::updateTime(double deltaTime)
 	// Fix time limits to -100000 to +100000 to prevent bugs
 	if (JD.first>38245309.499988) JD.first = 38245309.499988;
 	if (JD.first<-34803211.500012) JD.first = -34803211.500012;
-	JD.second=computeDeltaT(JD.first);
+	JD.second=computeDeltaTDirect(JD.first);
 
 	if (position->isObserverLifeOver())
 	{
@@ -1930,12 +1925,22 @@ double StelCore::getDeltaT() const
 
 // compute and return DeltaT in seconds. Try not to call it directly, current DeltaT, JD, and JDE are available.
 double StelCore::computeDeltaT(const double JD)
+{
+	return deltaTCache.getDeltaT(JD);
+}
+
+void StelCore::computeDeltaT(const double* JD, double* deltaT, const int n)
+{
+	deltaTCache.getDeltaT(JD, deltaT, n);
+}
+
+// compute DeltaT in seconds with the current algorithm, for deltaTCache and the current time.
+double StelCore::computeDeltaTDirect(const double JD) const
 {
 	double DeltaT = 0.;
 	if (currentDeltaTAlgorithm==Custom)
 	{
 		// User defined coefficients for quadratic equation for DeltaT may change frequently.
-		deltaTnDot = deltaTCustomNDot; // n.dot = custom value "/cy/cy
 		int year, month, day;
 		StelUtils::getDateFromJulianDay(JD, &year, &month, &day);
 		double u = (StelUtils::getDecYear(year,month,day)-getDeltaTCustomYear())/100;
@@ -1954,9 +1959,15 @@ double StelCore::computeDeltaT(const double JD)
 	return DeltaT;
 }
 
+double StelCore::computeDeltaTForCache(const double JD, const void* core)
+{
+	return static_cast<const StelCore*>(core)->computeDeltaTDirect(JD);
+}
+
 // set a function pointer here. This should make the actual computation simpler by just calling the function.
 void StelCore::setCurrentDeltaTAlgorithm(DeltaTAlgorithm algorithm)
 {
+	deltaTCache.clear();
 	currentDeltaTAlgorithm=algorithm;
 	deltaTdontUseMoon = false; // most algorithms will use it!
 	switch (currentDeltaTAlgorithm)
@@ -2466,11 +2477,33 @@ bool StelCore::de431IsActive()
 void StelCore::setDe430Active(bool status)
 {
 	de430Active = de430Available && status;
+	deltaTCache.clear();
 }
 
 void StelCore::setDe431Active(bool status)
 {
 	de431Active = de431Available && status;
+	deltaTCache.clear();
+}
+
+void StelCore::setDeltaTCustomYear(float y)
+{
+	deltaTCustomYear=y;
+	deltaTCache.clear();
+}
+
+void StelCore::setDeltaTCustomNDot(float v)
+{
+	deltaTCustomNDot=v;
+	if (currentDeltaTAlgorithm==Custom)
+		deltaTnDot = deltaTCustomNDot; // n.dot = custom value "/cy/cy
+	deltaTCache.clear();
+}
+
+void StelCore::setDeltaTCustomEquationCoefficients(Vec3f c)
+{
+	deltaTCustomEquationCoeff=c;
+	deltaTCache.clear();
 }
 
 void StelCore::initEphemeridesFunctions()
@@ -2513,92 +2546,51 @@ void StelCore::initEphemeridesFunctions()
 }
 
 // Methods for finding constellation from J2000 position.
-typedef struct iau_constline{
-	double RAlow;  // low value of 1875.0 right ascension segment, HH.dddd
-	double RAhigh; // high value of 1875.0 right ascension segment, HH.dddd
-	double decLow; // declination 1875.0 of southern border, DD.dddd
-	QString constellation; // 3-letter code of constellation
-} iau_constelspan;
-
-static QVector<iau_constelspan> iau_constlineVec;
-static bool iau_constlineVecInitialized=false;
-
-// File iau_constellations_spans.dat is converted from file data.dat from ADC catalog VI/42.
-// We converted back to HH:MM:SS format to avoid the inherent rounding errors present in that file (Bug LP:#1690615).
+static StelIAUConstellationIndex iauConstellationIndex;
+static bool iauConstellationIndexInitialized=false;
+
+static bool initIAUConstellationIndex()
+{
+	if (!iauConstellationIndexInitialized)
+	{
+		iauConstellationIndex.load(StelFileMgr::findFile("data/constellations_spans.dat"));
+		iauConstellationIndexInitialized=true;
+	}
+	return !iauConstellationIndex.isEmpty();
+}
+
 QString StelCore::getIAUConstellation(const Vec3d positionEqJnow) const
 {
 	// Precess positionJ2000 to 1875.0
 	Vec3d pos1875=j2000ToJ1875(equinoxEquToJ2000(positionEqJnow));
 	double RA1875;
 	double dec1875;
-	StelUtils::rectToSphe(&RA1875, &dec1875, pos1875);
-	RA1875 *= 12./M_PI; // hours
-	if (RA1875 <0.) RA1875+=24.;
-	dec1875 *= 180./M_PI; // degrees
+	StelIAUConstellationIndex::rectToRaDec(pos1875, RA1875, dec1875);
 	Q_ASSERT(RA1875>=0.0);
 	Q_ASSERT(RA1875<=24.0);
 	Q_ASSERT(dec1875<=90.0);
 	Q_ASSERT(dec1875>=-90.0);
 
-	// read file into structure.
-	if (!iau_constlineVecInitialized)
-	{
-		//struct iau_constline line;
-		QFile file(StelFileMgr::findFile("data/constellations_spans.dat"));
+	if (!initIAUConstellationIndex())
+		return "err";
+	return iauConstellationIndex.find(RA1875, dec1875);
+}
 
-		if (!file.open(QIODevice::ReadOnly | QIODevice::Text))
-		{
-			qWarning() << "IAU constellation line data file data/constellations_spans.dat not found.";
-			return "err";
-		}
-		iau_constelspan span;
-		QRegExp emptyLine("^\\s*$");
-		QTextStream in(&file);
-		while (!in.atEnd())
-		{
-			// Build list of entries. The checks can certainly become more robust. Actually the file must have 4-part lines.
-			QString line = in.readLine();
-			if (line.length()==0) continue;
-			if (emptyLine.exactMatch((line))) continue;
-			if (line.at(0)=='#') continue; // skip comment lines.
-			//QStringList list = line.split(QRegExp("\\b\\s+\\b"));
-			QStringList list = line.trimmed().split(QRegExp("\\s+"));
-			if (list.count() != 4)
-			{
-				qWarning() << "IAU constellation file constellations_spans.dat has bad line:" << line << "with" << list.count() << "elements";
-				continue;
-			}
-			//qDebug() << "Creating span for decl=" << list.at(2) << " from RA=" << list.at(0) << "to" << list.at(1) << ": " << list.at(3);
-			QStringList numList=list.at(0).split(QRegExp(":"));
-			span.RAlow= atof(numList.at(0).toLatin1()) + atof(numList.at(1).toLatin1())/60. + atof(numList.at(2).toLatin1())/3600.;
-			numList=list.at(1).split(QRegExp(":"));
-			span.RAhigh=atof(numList.at(0).toLatin1()) + atof(numList.at(1).toLatin1())/60. + atof(numList.at(2).toLatin1())/3600.;
-			numList=list.at(2).split(QRegExp(":"));
-			span.decLow=atof(numList.at(0).toLatin1()) + atof(numList.at(1).toLatin1())/60.;
-			span.constellation=list.at(3);
-			iau_constlineVec.append(span);
-		}
-		file.close();
-		iau_constlineVecInitialized=true;
+QStringList StelCore::getIAUConstellations(const QVector<Vec3d>& positionsEqJnow, bool multiThreaded) const
+{
+	if (!initIAUConstellationIndex())
+	{
+		QStringList result;
+		for (int i=0; i<positionsEqJnow.size(); ++i)
+			result << "err";
+		return result;
 	}
 
-	// iterate through vector, find entry where declination is lower.
-	int entry=0;
-	while (iau_constlineVec.at(entry).decLow > dec1875)
-		entry++;
-	while (entry<iau_constlineVec.size()){
-
-		while (iau_constlineVec.at(entry).RAhigh <= RA1875)
-			entry++;
-		while (iau_constlineVec.at(entry).RAlow >= RA1875)
-			entry++;
-		if (iau_constlineVec.at(entry).RAhigh > RA1875)
-			return iau_constlineVec.at(entry).constellation;
-		else
-			entry++;
-	}
-	qDebug() << "getIAUconstellation error: Cannot determine, algorithm failed.";
-	return "(?)";
+	QVector<Vec3d> positions1875;
+	positions1875.reserve(positionsEqJnow.size());
+	foreach (const Vec3d& pos, positionsEqJnow)
+		positions1875.append(j2000ToJ1875(equinoxEquToJ2000(pos)));
+	return iauConstellationIndex.find(positions1875, multiThreaded);
 }
 
 Vec3d StelCore::getMouseJ2000Pos() const
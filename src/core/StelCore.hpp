@@ -25,10 +25,13 @@
 #include "StelProjectorType.hpp"
 #include "StelLocation.hpp"
 #include "StelSkyDrawer.hpp"
+#include "StelDeltaTCache.hpp"
+#include "StelUTCOffsetTable.hpp"
 #include <QString>
 #include <QStringList>
 #include <QTime>
 #include <QPair>
+#include <QVector>
 
 class StelToneReproducer;
 class StelSkyDrawer;
@@ -217,6 +220,8 @@ public:
 	Vec3d altAzToJ2000(const Vec3d& v, RefractionMode refMode=RefractionAuto) const;
 	Vec3d j2000ToAltAz(const Vec3d& v, RefractionMode refMode=RefractionAuto) const;
 	void j2000ToAltAzInPlaceNoRefraction(Vec3f* v) const {v->transfo4d(matJ2000ToAltAz);}
+	//! Get the matrix used by j2000ToAltAzInPlaceNoRefraction(), e.g. to transform many vectors in a batch.
+	const Mat4d& getMatJ2000ToAltAz() const {return matJ2000ToAltAz;}
 	Vec3d galacticToJ2000(const Vec3d& v) const;
 	Vec3d supergalacticToJ2000(const Vec3d& v) const;
 	//! Transform position vector v from equatorial coordinates of date (which may also include atmospheric refraction) to those of J2000.
@@ -286,7 +291,8 @@ public:
 
 	//! Get the informations on the current location
 	const StelLocation& getCurrentLocation() const;
-	//! Get the UTC offset on the current location (in hours)
+	//! Get the UTC offset on the current location (in hours).
+	//! The offsets of an IANA time zone are looked up in a table of its transitions.
 	float getUTCOffset(const double JD) const;
 
 	QString getCurrentTimeZone() const;
@@ -487,8 +493,14 @@ public slots:
 	//! @note Up to V0.15.1, if the requested year was outside validity range, we returned zero or some useless value.
 	//!       Starting with V0.15.2 the value from the edge of the defined range is returned instead if not explicitly zero is given in the source.
 	//!       Limits can be queried with getCurrentDeltaTAlgorithmValidRangeDescription()
+	//! @note The values are taken from a cache of the current algorithm, within StelDeltaTCache::Tolerance
+	//!       of the formula. getDeltaT() gives the value of the formula at the current time.
 
 	double computeDeltaT(const double JD);
+	//! Compute DeltaT [s] for n dates, from the cache of the current algorithm.
+	//! @param JD array of n Julian days
+	//! @param deltaT array of n values to fill
+	void computeDeltaT(const double* JD, double* deltaT, const int n);
 	//! Get current DeltaT.
 	double getDeltaT() const;
 
@@ -679,13 +691,13 @@ public slots:
 
 	//! Set central year for custom equation for calculation of DeltaT
 	//! @param y the year, e.g. 1820
-	void setDeltaTCustomYear(float y) { deltaTCustomYear=y; }
+	void setDeltaTCustomYear(float y);
 	//! Set n-dot for custom equation for calculation of DeltaT
 	//! @param v the n-dot value, e.g. -26.0
-	void setDeltaTCustomNDot(float v) { deltaTCustomNDot=v; }
+	void setDeltaTCustomNDot(float v);
 	//! Set coefficients for custom equation for calculation of DeltaT
 	//! @param c the coefficients, e.g. -20,0,32
-	void setDeltaTCustomEquationCoefficients(Vec3f c) { deltaTCustomEquationCoeff=c; }
+	void setDeltaTCustomEquationCoefficients(Vec3f c);
 
 	//! Get central year for custom equation for calculation of DeltaT
 	float getDeltaTCustomYear() const { return deltaTCustomYear; }
@@ -711,6 +723,10 @@ public slots:
 	//! Data file from ADC catalog VI/42 with her amendment from 1999-12-30.
 	//! @param positionEqJnow position vector in rectangular equatorial coordinates of current epoch&equinox.
 	QString getIAUConstellation(const Vec3d positionEqJnow) const;
+	//! Return the 3-letter abbreviations of the IAU constellations of many positions at once, e.g. for lists of objects.
+	//! @param positionsEqJnow position vectors in rectangular equatorial coordinates of current epoch&equinox.
+	//! @param multiThreaded split the work over the threads of the global thread pool
+	QStringList getIAUConstellations(const QVector<Vec3d>& positionsEqJnow, bool multiThreaded=false) const;
 
 
 signals:
@@ -804,6 +820,8 @@ private:
 	double jdOfLastJDUpdate;         // JD when the time rate or time last changed
 
 	QString currentTimeZone;	
+	//! Offsets of currentTimeZone, rebuilt when the zone or flagUseDST change
+	StelUTCOffsetTable utcOffsetTable;
 	bool flagUseDST;
 	bool flagUseCTZ; // custom time zone
 
@@ -822,6 +840,13 @@ private:
 	bool de431Available; // ephem file found
 	bool de430Active;    // available and user-activated.
 	bool de431Active;    // available and user-activated.
+
+	//! Compute DeltaT with the current algorithm, without the cache.
+	double computeDeltaTDirect(const double JD) const;
+	//! Function of deltaTCache, with core the StelCore.
+	static double computeDeltaTForCache(const double JD, const void* core);
+	//! Values of computeDeltaTDirect(), cleared when the algorithm or its parameters change
+	StelDeltaTCache deltaTCache;
 };
 
 #endif // _STELCORE_HPP_
@@ -0,0 +1,123 @@
+/*
+ * Stellarium
+ * Copyright (C) 2017 Stellarium Developers
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Suite 500, Boston, MA  02110-1335, USA.
+ */
+
+#include "StelDeltaTCache.hpp"
+
+#include <QtGlobal>
+
+#include <cmath>
+
+const double StelDeltaTCache::Tolerance = 0.1;
+
+// Distance between the nodes of the polynomial [days]
+static const int NODE_DAYS = StelDeltaTCache::SegmentDays/3;
+// Distance between the days where the polynomial is checked [days]
+static const int CHECK_DAYS = 7;
+// Time of the checks before or after noon [days]. Formulae using the calendar date only are constant
+// during a day, so they differ from a smooth polynomial at the ends of the days.
+static const double CHECK_OFFSET = 0.49;
+// Dates outside +/- this limit are not cached [JD]
+static const double MAX_CACHED_JD = 1e9;
+
+StelDeltaTCache::StelDeltaTCache(DeltaTFunction function, const void* context)
+	: function(function)
+	, context(context)
+	, lastIndex(0)
+{
+	lastSegment.direct = true;
+	lastSegment.y0 = lastSegment.d1 = lastSegment.d2 = lastSegment.d3 = 0.;
+	clear();
+}
+
+void StelDeltaTCache::clear()
+{
+	segments.clear();
+	// No segment has this index.
+	lastIndex = static_cast<qint64>(MAX_CACHED_JD);
+}
+
+StelDeltaTCache::Segment StelDeltaTCache::computeSegment(qint64 index) const
+{
+	const double start = static_cast<double>(index*SegmentDays);
+	const double y0 = function(start, context);
+	const double y1 = function(start+NODE_DAYS, context);
+	const double y2 = function(start+2*NODE_DAYS, context);
+	const double y3 = function(start+3*NODE_DAYS, context);
+
+	// Newton form on the nodes x=0,1,2,3 (x in units of NODE_DAYS):
+	// p(x) = y0 + x*(d1 + (x-1)*(d2 + (x-2)*d3))
+	Segment s;
+	s.direct = false;
+	s.y0 = y0;
+	s.d1 = y1-y0;
+	s.d2 = (y2-2.*y1+y0)/2.;
+	s.d3 = (y3-3.*y2+3.*y1-y0)/6.;
+
+	// The polynomial must be within Tolerance/4 of the function at the checks, to stay within
+	// Tolerance between them, e.g. at the days added by the months of the formulae using getDecYear().
+	double offset = CHECK_OFFSET;
+	for (int day=CHECK_DAYS; day<SegmentDays; day+=CHECK_DAYS)
+	{
+		if (day%NODE_DAYS==0)
+			continue;
+		const double t = day+offset;
+		offset = -offset;
+		const double x = t/NODE_DAYS;
+		const double p = s.y0 + x*(s.d1 + (x-1.)*(s.d2 + (x-2.)*s.d3));
+		if (std::fabs(p-function(start+t, context)) > 0.25*Tolerance)
+		{
+			s.direct = true;
+			break;
+		}
+	}
+	return s;
+}
+
+double StelDeltaTCache::getDeltaT(const double JD)
+{
+	if (!(std::fabs(JD)<MAX_CACHED_JD))
+		return function(JD, context);
+
+	const qint64 index = static_cast<qint64>(std::floor(JD/SegmentDays));
+	if (index!=lastIndex)
+	{
+		QHash<qint64, Segment>::const_iterator it = segments.constFind(index);
+		if (it!=segments.constEnd())
+			lastSegment = it.value();
+		else
+		{
+			if (segments.size()>=MaxSegments)
+				segments.clear();
+			lastSegment = computeSegment(index);
+			segments.insert(index, lastSegment);
+		}
+		lastIndex = index;
+	}
+
+	if (lastSegment.direct)
+		return function(JD, context);
+	const double x = (JD - static_cast<double>(index*SegmentDays))/NODE_DAYS;
+	return lastSegment.y0 + x*(lastSegment.d1 + (x-1.)*(lastSegment.d2 + (x-2.)*lastSegment.d3));
+}
+
+void StelDeltaTCache::getDeltaT(const double* JD, double* deltaT, const int n)
+{
+	for (int i=0; i<n; ++i)
+		deltaT[i] = getDeltaT(JD[i]);
+}
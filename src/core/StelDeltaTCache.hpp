@@ -0,0 +1,79 @@
+/*
+ * Stellarium
+ * Copyright (C) 2017 Stellarium Developers
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Suite 500, Boston, MA  02110-1335, USA.
+ */
+
+#ifndef _STELDELTATCACHE_HPP_
+#define _STELDELTATCACHE_HPP_
+
+#include <QHash>
+
+//! @class StelDeltaTCache
+//! Cache of the values of a DeltaT function, as piecewise cubic polynomials.
+//!
+//! The time is split into segments of SegmentDays days. When a date of a segment is first requested,
+//! the function is sampled at 4 nodes of the segment, and the cubic polynomial through these values
+//! is compared to the function at other days of the segment. If they differ by more than a quarter of
+//! the Tolerance, e.g. around the discontinuities between the periods of a DeltaT formula, or in
+//! remote epochs where the formulae using the calendar date only change by steps of more than
+//! Tolerance from one day to the next, the function is called directly for all dates of the segment.
+//!
+//! The cache is not thread-safe. It must be cleared when the function changes.
+class StelDeltaTCache
+{
+public:
+	//! Function computing DeltaT [s] at a Julian day (UT).
+	//! @param context the pointer given to the constructor
+	typedef double (*DeltaTFunction)(const double JD, const void* context);
+
+	StelDeltaTCache(DeltaTFunction function, const void* context);
+
+	//! Forget all cached values. Call it when the function changes its results.
+	void clear();
+
+	//! Return DeltaT [s] at a Julian day (UT).
+	double getDeltaT(const double JD);
+	//! Compute DeltaT [s] for n Julian days (UT).
+	void getDeltaT(const double* JD, double* deltaT, const int n);
+
+	//! Maximum difference between the cached values and the function [s] (0.1 s, or 0.05" of motion of the Moon)
+	static const double Tolerance;
+	//! Length of a segment [days]
+	static const int SegmentDays = 63;
+	//! Number of segments kept before the cache is cleared (about 11000 years)
+	static const int MaxSegments = 65536;
+
+private:
+	struct Segment
+	{
+		bool direct;    //!< true if the function is called directly in this segment
+		//! Value at the beginning of the segment and divided differences of the Newton polynomial
+		double y0, d1, d2, d3;
+	};
+
+	//! Sample the function in segment index, which begins at JD index*SegmentDays.
+	Segment computeSegment(qint64 index) const;
+
+	DeltaTFunction function;
+	const void* context;
+	QHash<qint64, Segment> segments;
+	//! The last segment used, for series of dates
+	qint64 lastIndex;
+	Segment lastSegment;
+};
+
+#endif // _STELDELTATCACHE_HPP_
@@ -0,0 +1,228 @@
+/*
+ * Stellarium
+ * Copyright (C) 2017 Stellarium Developers
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Suite 500, Boston, MA  02110-1335, USA.
+ */
+
+#include "StelIAUConstellationIndex.hpp"
+
+#include <QDebug>
+#include <QDir>
+#include <QFile>
+#include <QRegExp>
+#include <QTextStream>
+#include <QtConcurrent>
+
+#include <algorithm>
+#include <cmath>
+#include <cstdlib>
+#include <functional>
+
+// Number of positions per job of find()
+static const int POSITIONS_PER_JOB = 4096;
+
+//! Functor for QtConcurrent: constellations of a range of positions.
+class StelIAUConstellationIndex::FindChunk
+{
+public:
+	FindChunk(const StelIAUConstellationIndex* index, const QVector<Vec3d>& positions, int* result)
+		: index(index), positions(positions), result(result) {}
+	void operator()(const int& start)
+	{
+		const int end = qMin(start+POSITIONS_PER_JOB, positions.size());
+		double ra, dec;
+		for (int i=start; i<end; ++i)
+		{
+			rectToRaDec(positions.at(i), ra, dec);
+			result[i] = index->findIndex(ra, dec);
+		}
+	}
+private:
+	const StelIAUConstellationIndex* index;
+	const QVector<Vec3d>& positions;
+	int* result;
+};
+
+StelIAUConstellationIndex::StelIAUConstellationIndex()
+{
+}
+
+// File constellations_spans.dat is converted from file data.dat from ADC catalog VI/42.
+// We converted back to HH:MM:SS format to avoid the inherent rounding errors present in that file (Bug LP:#1690615).
+bool StelIAUConstellationIndex::load(const QString& fileName)
+{
+	QFile file(fileName);
+	if (!file.open(QIODevice::ReadOnly | QIODevice::Text))
+	{
+		qWarning() << "IAU constellation line data file" << QDir::toNativeSeparators(fileName) << "not found.";
+		return false;
+	}
+
+	QVector<Span> fileSpans;
+	Span span;
+	QRegExp emptyLine("^\\s*$");
+	QTextStream in(&file);
+	while (!in.atEnd())
+	{
+		// Build list of entries. The checks can certainly become more robust. Actually the file must have 4-part lines.
+		QString line = in.readLine();
+		if (line.length()==0) continue;
+		if (emptyLine.exactMatch((line))) continue;
+		if (line.at(0)=='#') continue; // skip comment lines.
+		QStringList list = line.trimmed().split(QRegExp("\\s+"));
+		if (list.count() != 4)
+		{
+			qWarning() << "IAU constellation file constellations_spans.dat has bad line:" << line << "with" << list.count() << "elements";
+			continue;
+		}
+		QStringList numList=list.at(0).split(QRegExp(":"));
+		span.RAlow= atof(numList.at(0).toLatin1()) + atof(numList.at(1).toLatin1())/60. + atof(numList.at(2).toLatin1())/3600.;
+		numList=list.at(1).split(QRegExp(":"));
+		span.RAhigh=atof(numList.at(0).toLatin1()) + atof(numList.at(1).toLatin1())/60. + atof(numList.at(2).toLatin1())/3600.;
+		numList=list.at(2).split(QRegExp(":"));
+		span.decLow=atof(numList.at(0).toLatin1()) + atof(numList.at(1).toLatin1())/60.;
+		span.constellation=list.at(3);
+		fileSpans.append(span);
+	}
+	file.close();
+	setSpans(fileSpans);
+	return true;
+}
+
+void StelIAUConstellationIndex::setSpans(const QVector<Span>& newSpans)
+{
+	spans = newSpans;
+	spanConstellations.clear();
+	constellations.clear();
+	decBands.clear();
+	raBreaks.clear();
+	table.clear();
+
+	foreach (const Span& s, spans)
+	{
+		int c = constellations.indexOf(s.constellation);
+		if (c<0)
+		{
+			c = constellations.size();
+			constellations.append(s.constellation);
+		}
+		spanConstellations.append(c);
+		decBands.append(s.decLow);
+		raBreaks.append(s.RAlow);
+		raBreaks.append(s.RAhigh);
+	}
+	std::sort(decBands.begin(), decBands.end(), std::greater<double>());
+	decBands.erase(std::unique(decBands.begin(), decBands.end()), decBands.end());
+	std::sort(raBreaks.begin(), raBreaks.end());
+	raBreaks.erase(std::unique(raBreaks.begin(), raBreaks.end()), raBreaks.end());
+
+	// In band k, the spans tested by the scan are the same for all declinations, so the result of the
+	// scan at the lower limit of the band holds for the whole band.
+	const int m = raBreaks.size();
+	table.reserve(decBands.size()*(2*m+1));
+	foreach (double dec, decBands)
+	{
+		for (int j=0; j<=m; ++j)
+		{
+			double ra;
+			if (m==0)
+				ra = 0.;
+			else if (j==0)
+				ra = raBreaks.first()-1.;
+			else if (j==m)
+				ra = raBreaks.last()+1.;
+			else
+				ra = 0.5*(raBreaks.at(j-1)+raBreaks.at(j));
+			table.append(static_cast<qint16>(scanIndex(ra, dec)));
+			if (j<m)
+				table.append(static_cast<qint16>(scanIndex(raBreaks.at(j), dec)));
+		}
+	}
+}
+
+int StelIAUConstellationIndex::scanIndex(double ra, double dec) const
+{
+	// Find the first entry where declination is lower, then the first span around ra from there.
+	int entry=0;
+	while (entry<spans.size() && spans.at(entry).decLow > dec)
+		entry++;
+	for (; entry<spans.size(); ++entry)
+	{
+		const Span& s = spans.at(entry);
+		if (s.RAlow < ra && s.RAhigh > ra)
+			return spanConstellations.at(entry);
+	}
+	return -1;
+}
+
+int StelIAUConstellationIndex::findIndex(double ra, double dec) const
+{
+	// First band whose lower limit is not above dec
+	const QVector<double>::const_iterator band = std::lower_bound(decBands.constBegin(), decBands.constEnd(), dec,
+								      std::greater<double>());
+	if (band==decBands.constEnd())
+		return -1;
+	const int m = raBreaks.size();
+	const int j = std::lower_bound(raBreaks.constBegin(), raBreaks.constEnd(), ra) - raBreaks.constBegin();
+	const int slot = (j<m && raBreaks.at(j)==ra) ? 2*j+1 : 2*j;
+	return table.at((band-decBands.constBegin())*(2*m+1) + slot);
+}
+
+QString StelIAUConstellationIndex::find(double ra1875, double dec1875) const
+{
+	const int c = findIndex(ra1875, dec1875);
+	return c<0 ? QString("(?)") : constellations.at(c);
+}
+
+QString StelIAUConstellationIndex::scan(double ra1875, double dec1875) const
+{
+	const int c = scanIndex(ra1875, dec1875);
+	return c<0 ? QString("(?)") : constellations.at(c);
+}
+
+QStringList StelIAUConstellationIndex::find(const QVector<Vec3d>& positions1875, bool multiThreaded) const
+{
+	QVector<int> indices(positions1875.size());
+	FindChunk chunk(this, positions1875, indices.data());
+	if (multiThreaded && positions1875.size()>POSITIONS_PER_JOB)
+	{
+		QVector<int> starts;
+		for (int start=0; start<positions1875.size(); start+=POSITIONS_PER_JOB)
+			starts.append(start);
+		QtConcurrent::blockingMap(starts, chunk);
+	}
+	else
+	{
+		for (int start=0; start<positions1875.size(); start+=POSITIONS_PER_JOB)
+			chunk(start);
+	}
+
+	QStringList result;
+	result.reserve(indices.size());
+	foreach (int c, indices)
+		result.append(c<0 ? QString("(?)") : constellations.at(c));
+	return result;
+}
+
+void StelIAUConstellationIndex::rectToRaDec(const Vec3d& pos, double& ra, double& dec)
+{
+	// As StelUtils::rectToSphe()
+	const double r = pos.length();
+	ra = std::atan2(pos[1], pos[0]) * 12./M_PI; // hours
+	if (ra<0.)
+		ra += 24.;
+	dec = (r>0. ? std::asin(pos[2]/r) : 0.) * 180./M_PI; // degrees
+}
@@ -0,0 +1,95 @@
+/*
+ * Stellarium
+ * Copyright (C) 2017 Stellarium Developers
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Suite 500, Boston, MA  02110-1335, USA.
+ */
+
+#ifndef _STELIAUCONSTELLATIONINDEX_HPP_
+#define _STELIAUCONSTELLATIONINDEX_HPP_
+
+#include "VecMath.hpp"
+
+#include <QString>
+#include <QStringList>
+#include <QVector>
+
+//! @class StelIAUConstellationIndex
+//! Find the IAU constellation of a position, following 1987PASP...99..695R: Nancy Roman,
+//! Identification of a Constellation from a Position.
+//!
+//! The boundaries are given as spans of right ascension at the southern declination of a
+//! constellation, in B1875.0 coordinates. Roman's algorithm takes the first span, in the order of the
+//! file, below the position and around its right ascension. The result only changes at the
+//! declinations and right ascensions of the spans, so it is precomputed for each band of declination
+//! between two declinations of spans and each interval between two right ascensions of spans (and at
+//! these right ascensions, where the inequalities of the algorithm matter). A lookup is then two
+//! binary searches, and gives the same result as the scan of the spans.
+class StelIAUConstellationIndex
+{
+public:
+	//! A span of a constellation boundary.
+	struct Span
+	{
+		double RAlow;           //!< low value of 1875.0 right ascension segment [h]
+		double RAhigh;          //!< high value of 1875.0 right ascension segment [h]
+		double decLow;          //!< declination 1875.0 of southern border [deg]
+		QString constellation;  //!< 3-letter code of constellation
+	};
+
+	StelIAUConstellationIndex();
+
+	//! Load the spans from a file in the format of data/constellations_spans.dat and build the index.
+	//! @return false if the file cannot be read.
+	bool load(const QString& fileName);
+	//! Set the spans, in the order of Roman's table, and build the index.
+	void setSpans(const QVector<Span>& spans);
+	bool isEmpty() const {return spans.isEmpty();}
+
+	//! Return the 3-letter abbreviation of the constellation at a B1875.0 position, or "(?)" if none is found.
+	//! @param ra1875 right ascension [h], in [0, 24[
+	//! @param dec1875 declination [deg]
+	QString find(double ra1875, double dec1875) const;
+	//! Return the constellation at a B1875.0 position by scanning the spans, as the index was built.
+	QString scan(double ra1875, double dec1875) const;
+	//! Return the constellations of positions in rectangular B1875.0 equatorial coordinates.
+	//! @param multiThreaded split the work over the threads of the global thread pool
+	QStringList find(const QVector<Vec3d>& positions1875, bool multiThreaded=false) const;
+
+	//! Convert a position in rectangular coordinates to the right ascension [h] in [0, 24[ and the declination [deg].
+	static void rectToRaDec(const Vec3d& pos, double& ra, double& dec);
+
+private:
+	class FindChunk;
+
+	//! Return the index in constellations of the constellation at a position, or -1.
+	int findIndex(double ra, double dec) const;
+	int scanIndex(double ra, double dec) const;
+
+	QVector<Span> spans;
+	//! Index in constellations of the constellation of each span
+	QVector<int> spanConstellations;
+	QStringList constellations;
+
+	//! Declinations of the spans, in decreasing order. Band k is [decBands[k], decBands[k-1][.
+	QVector<double> decBands;
+	//! Right ascensions of the spans, in increasing order
+	QVector<double> raBreaks;
+	//! For each band, 2*raBreaks.size()+1 constellation indices: for the interval before each value
+	//! of raBreaks, at the value, and after the last value.
+	QVector<qint16> table;
+};
+
+#endif // _STELIAUCONSTELLATIONINDEX_HPP_
@@ -151,7 +151,8 @@ StelLocation StelLocation::createFromLine(const QString& rawline)
 float StelLocation::distanceDegrees(const float long1, const float lat1, const float long2, const float lat2)
 {
 	const float DEGREES=M_PI/180.0f;
-	return std::acos( std::sin(lat1*DEGREES)*std::sin(lat2*DEGREES) +
-			  std::cos(lat1*DEGREES)*std::cos(lat2*DEGREES) *
-			  std::cos((long1-long2)*DEGREES) ) / DEGREES;
+	// Rounding errors may give a cosine slightly above 1 for identical locations.
+	return std::acos( qBound(-1.0f, std::sin(lat1*DEGREES)*std::sin(lat2*DEGREES) +
+					std::cos(lat1*DEGREES)*std::cos(lat2*DEGREES) *
+					std::cos((long1-long2)*DEGREES), 1.0f) ) / DEGREES;
 }
@@ -0,0 +1,408 @@
+/*
+ * Stellarium
+ * Copyright (C) 2017 Stellarium Developers
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Suite 500, Boston, MA  02110-1335, USA.
+ */
+
+#include "StelLocationCatalog.hpp"
+
+#include <QDateTime>
+#include <QDebug>
+#include <QDir>
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+
+const char StelLocationCatalog::Magic[4] = {'S', 'L', 'O', 'C'};
+
+// Added to the radius of the searches [deg], so that the rounding errors of StelLocation::distanceDegrees()
+// cannot make findNearby() skip a location which passes its test.
+static const double MARGIN_DEGREES = 1e-3;
+
+// Longitude in [-180, 180] [deg]. Longitudes already in this range are kept unchanged.
+static double normalizeLongitude(double longitude)
+{
+	if (longitude<-180. || longitude>180.)
+		return longitude - 360.*std::floor((longitude+180.)/360.);
+	return longitude;
+}
+
+static bool longitudeLess(const StelLocationCatalog::Coordinates& c, float longitude)
+{
+	return c.longitude<longitude;
+}
+
+//! Order of the locations in the file: by planet, band of latitude and longitude.
+class StelLocationCatalog::RecordOrder
+{
+public:
+	RecordOrder(const QVector<int>& planets, const QVector<int>& bands, const QVector<Coordinates>& coordinates)
+		: planets(planets), bands(bands), coordinates(coordinates) {}
+	bool operator()(int a, int b) const
+	{
+		if (planets.at(a)!=planets.at(b))
+			return planets.at(a)<planets.at(b);
+		if (bands.at(a)!=bands.at(b))
+			return bands.at(a)<bands.at(b);
+		if (coordinates.at(a).longitude!=coordinates.at(b).longitude)
+			return coordinates.at(a).longitude<coordinates.at(b).longitude;
+		return a<b;
+	}
+private:
+	const QVector<int>& planets;
+	const QVector<int>& bands;
+	const QVector<Coordinates>& coordinates;
+};
+
+StelLocationCatalog::StelLocationCatalog()
+	: header(Q_NULLPTR)
+	, coordinates(Q_NULLPTR)
+	, records(Q_NULLPTR)
+	, planets(Q_NULLPTR)
+	, bandIndex(Q_NULLPTR)
+	, idIndex(Q_NULLPTR)
+{
+}
+
+StelLocationCatalog::~StelLocationCatalog()
+{
+	clear();
+}
+
+void StelLocationCatalog::clear()
+{
+	file.close();
+	header = Q_NULLPTR;
+	coordinates = Q_NULLPTR;
+	records = Q_NULLPTR;
+	planets = Q_NULLPTR;
+	bandIndex = Q_NULLPTR;
+	idIndex = Q_NULLPTR;
+	stringValues.clear();
+}
+
+bool StelLocationCatalog::load(const QString& catalogPath)
+{
+	clear();
+	if (!file.open(catalogPath, Magic, Version, sizeof(Header), "location file"))
+		return false;
+
+	const uchar* data = file.getData();
+	const Header* h = reinterpret_cast<const Header*>(data);
+	const quint64 count = h->count;
+	const quint64 nrOfBandEntries = quint64(h->planetCount)*NrOfBands+1;
+	if (h->nrOfBands!=NrOfBands
+	    || !file.containsSection(h->coordinatesOffset, count, sizeof(Coordinates), 8)
+	    || !file.containsSection(h->recordsOffset, count, sizeof(Record), 8)
+	    || !file.containsSection(h->planetsOffset, h->planetCount, sizeof(quint32), 8)
+	    || !file.containsSection(h->bandIndexOffset, nrOfBandEntries, sizeof(quint32), 4)
+	    || !file.containsSection(h->idIndexOffset, count, sizeof(quint32), 4)
+	    || !file.containsStrings(h->stringsOffset, h->stringsSize))
+	{
+		qWarning() << "Invalid location file" << QDir::toNativeSeparators(catalogPath);
+		clear();
+		return false;
+	}
+	const quint32* bands = reinterpret_cast<const quint32*>(data+h->bandIndexOffset);
+	bool validIndex = bands[0]==0 && bands[nrOfBandEntries-1]==count;
+	for (quint64 i=1; validIndex && i<nrOfBandEntries; ++i)
+		validIndex = bands[i-1]<=bands[i];
+	const quint32* ids = reinterpret_cast<const quint32*>(data+h->idIndexOffset);
+	for (quint64 i=0; validIndex && i<count; ++i)
+		validIndex = ids[i]<count;
+	if (!validIndex)
+	{
+		qWarning() << "Invalid index in location file" << QDir::toNativeSeparators(catalogPath);
+		clear();
+		return false;
+	}
+
+	header = h;
+	coordinates = reinterpret_cast<const Coordinates*>(data+h->coordinatesOffset);
+	records = reinterpret_cast<const Record*>(data+h->recordsOffset);
+	planets = reinterpret_cast<const quint32*>(data+h->planetsOffset);
+	bandIndex = bands;
+	idIndex = ids;
+	// Convert each string once, see getLocation(). The string table ends with a 0, see StelMappedCatalog::containsStrings().
+	const char* strings = reinterpret_cast<const char*>(data+h->stringsOffset);
+	stringValues.reserve(static_cast<int>(count));
+	for (quint64 offset=1; offset<h->stringsSize; offset+=strlen(strings+offset)+1)
+		stringValues.insert(offset, QString::fromUtf8(strings+offset));
+	return true;
+}
+
+int StelLocationCatalog::size() const
+{
+	return header ? static_cast<int>(header->count) : 0;
+}
+
+quint32 StelLocationCatalog::getTimeZonesHash() const
+{
+	return header ? header->timeZonesHash : 0;
+}
+
+bool StelLocationCatalog::isImportOf(const QString& sourcePath) const
+{
+	if (!header)
+		return false;
+	const QFileInfo info(sourcePath);
+	return info.exists()
+		&& header->sourceSize==static_cast<quint64>(info.size())
+		&& header->sourceModified==info.lastModified().toMSecsSinceEpoch();
+}
+
+int StelLocationCatalog::findID(const QString& id) const
+{
+	int begin = 0;
+	int end = size();
+	while (begin<end)
+	{
+		const int middle = begin+(end-begin)/2;
+		const QString middleID = getID(static_cast<int>(idIndex[middle]));
+		if (middleID==id)
+			return static_cast<int>(idIndex[middle]);
+		if (middleID<id)
+			begin = middle+1;
+		else
+			end = middle;
+	}
+	return -1;
+}
+
+QStringList StelLocationCatalog::getIDs() const
+{
+	QStringList ids;
+	ids.reserve(size());
+	for (int i=0; i<size(); ++i)
+		ids.append(getID(static_cast<int>(idIndex[i])));
+	return ids;
+}
+
+StelLocation StelLocationCatalog::getLocation(int index) const
+{
+	const Record& r = records[index];
+	const Coordinates& c = coordinates[index];
+	StelLocation loc;
+	loc.name = getString(r.name);
+	loc.state = getString(r.state);
+	loc.country = getString(r.country);
+	loc.planetName = getString(r.planetName);
+	loc.ianaTimeZone = getString(r.ianaTimeZone);
+	loc.landscapeKey = getString(r.landscapeKey);
+	loc.longitude = c.longitude;
+	loc.latitude = c.latitude;
+	loc.altitude = r.altitude;
+	loc.population = r.population;
+	loc.bortleScaleIndex = r.bortleScaleIndex;
+	loc.role = QChar(r.role);
+	loc.isUserLocation = false;
+	return loc;
+}
+
+int StelLocationCatalog::getBand(double latitude)
+{
+	return qBound(0, static_cast<int>(std::floor((latitude+90.)/BandDegrees)), NrOfBands-1);
+}
+
+int StelLocationCatalog::findPlanet(const QString& planetName) const
+{
+	if (!header)
+		return -1;
+	for (quint32 p=0; p<header->planetCount; ++p)
+	{
+		if (getString(planets[p])==planetName)
+			return static_cast<int>(p);
+	}
+	return -1;
+}
+
+void StelLocationCatalog::findInRange(int begin, int end, float minLongitude, float maxLongitude,
+				      float longitude, float latitude, float radiusDegrees, QVector<int>& result) const
+{
+	const Coordinates* c = std::lower_bound(coordinates+begin, coordinates+end, minLongitude, longitudeLess);
+	for (; c!=coordinates+end && c->longitude<=maxLongitude; ++c)
+	{
+		if (StelLocation::distanceDegrees(longitude, latitude, c->longitude, c->latitude) <= radiusDegrees)
+			result.append(static_cast<int>(c-coordinates));
+	}
+}
+
+QVector<int> StelLocationCatalog::findNearby(const QString& planetName, float longitude, float latitude, float radiusDegrees) const
+{
+	QVector<int> result;
+	const int planet = findPlanet(planetName);
+	if (planet<0 || !(radiusDegrees>=0.f) || qIsNaN(longitude) || qIsNaN(latitude))
+		return result;
+
+	const double lng = normalizeLongitude(longitude);
+	const double r = radiusDegrees + MARGIN_DEGREES;
+	// Half width in longitude of the circle, unless it contains a pole
+	double halfWidth = 180.;
+	if (r<90. && std::fabs(latitude)+r<90.)
+		halfWidth = std::asin(std::sin(r*M_PI/180.)/std::cos(latitude*M_PI/180.))*180./M_PI;
+
+	const int lastBand = getBand(latitude+r);
+	for (int band=getBand(latitude-r); band<=lastBand; ++band)
+	{
+		const int begin = static_cast<int>(bandIndex[planet*NrOfBands+band]);
+		const int end = static_cast<int>(bandIndex[planet*NrOfBands+band+1]);
+		if (begin==end)
+			continue;
+		if (halfWidth>=180.)
+		{
+			findInRange(begin, end, -180.f, 180.f, longitude, latitude, radiusDegrees, result);
+			continue;
+		}
+		const double minLongitude = lng-halfWidth;
+		const double maxLongitude = lng+halfWidth;
+		findInRange(begin, end, static_cast<float>(minLongitude), static_cast<float>(maxLongitude),
+			    longitude, latitude, radiusDegrees, result);
+		// Parts of the circle beyond the antimeridian
+		if (minLongitude<-180.)
+			findInRange(begin, end, static_cast<float>(minLongitude+360.), 180.f, longitude, latitude, radiusDegrees, result);
+		if (maxLongitude>180.)
+			findInRange(begin, end, -180.f, static_cast<float>(maxLongitude-360.), longitude, latitude, radiusDegrees, result);
+	}
+	return result;
+}
+
+int StelLocationCatalog::findNearest(const QString& planetName, float longitude, float latitude, float maxDistanceDegrees,
+				     float* distanceDegrees) const
+{
+	if (!(maxDistanceDegrees>=0.f))
+		return -1;
+	// Search in growing circles: a location found in a circle is nearer than all locations outside of it.
+	float radius = qMin(1.f, maxDistanceDegrees);
+	for (;;)
+	{
+		const QVector<int> found = findNearby(planetName, longitude, latitude, radius);
+		if (!found.isEmpty())
+		{
+			int nearest = -1;
+			float nearestDistance = 0.f;
+			foreach (int i, found)
+			{
+				const float d = StelLocation::distanceDegrees(longitude, latitude, coordinates[i].longitude, coordinates[i].latitude);
+				if (nearest<0 || d<nearestDistance)
+				{
+					nearest = i;
+					nearestDistance = d;
+				}
+			}
+			if (distanceDegrees)
+				*distanceDegrees = nearestDistance;
+			return nearest;
+		}
+		if (radius>=maxDistanceDegrees)
+			return -1;
+		radius = qMin(4.f*radius, maxDistanceDegrees);
+	}
+}
+
+bool StelLocationCatalog::write(const QString& catalogPath, const QMap<QString, StelLocation>& locations, quint32 timeZonesHash,
+				const QFileInfo& source)
+{
+	StringTable strings;
+	QStringList planetNames;
+	QVector<int> locationPlanets, locationBands;
+	QVector<Coordinates> locationCoordinates;
+	QVector<Record> locationRecords;
+	for (QMap<QString, StelLocation>::const_iterator it=locations.constBegin(); it!=locations.constEnd(); ++it)
+	{
+		const StelLocation& loc = it.value();
+		int planet = planetNames.indexOf(loc.planetName);
+		if (planet<0)
+		{
+			planet = planetNames.size();
+			planetNames.append(loc.planetName);
+		}
+		locationPlanets.append(planet);
+		locationBands.append(getBand(loc.latitude));
+
+		Coordinates c;
+		c.longitude = normalizeLongitude(loc.longitude);
+		c.latitude = loc.latitude;
+		locationCoordinates.append(c);
+
+		Record r;
+		memset(&r, 0, sizeof(Record));
+		r.id = strings.add(it.key());
+		r.name = strings.add(loc.name);
+		r.state = strings.add(loc.state);
+		r.country = strings.add(loc.country);
+		r.planetName = strings.add(loc.planetName);
+		r.ianaTimeZone = strings.add(loc.ianaTimeZone);
+		r.landscapeKey = strings.add(loc.landscapeKey);
+		r.altitude = loc.altitude;
+		r.population = loc.population;
+		r.bortleScaleIndex = loc.bortleScaleIndex;
+		r.role = loc.role.unicode();
+		locationRecords.append(r);
+	}
+
+	const int count = locationRecords.size();
+	QVector<int> order(count);
+	for (int i=0; i<count; ++i)
+		order[i] = i;
+	std::sort(order.begin(), order.end(), RecordOrder(locationPlanets, locationBands, locationCoordinates));
+	QVector<Coordinates> sortedCoordinates(count);
+	QVector<Record> sortedRecords(count);
+	QVector<quint32> bands(planetNames.size()*NrOfBands+1, 0);
+	// The locations were read in the order of the keys of the map, i.e. sorted by ID.
+	QVector<quint32> ids(count);
+	for (int i=0; i<count; ++i)
+	{
+		sortedCoordinates[i] = locationCoordinates.at(order.at(i));
+		sortedRecords[i] = locationRecords.at(order.at(i));
+		ids[order.at(i)] = i;
+		++bands[locationPlanets.at(i)*NrOfBands+locationBands.at(i)+1];
+	}
+	for (int b=1; b<bands.size(); ++b)
+		bands[b] += bands[b-1];
+	QVector<quint32> planetOffsets;
+	foreach (const QString& planetName, planetNames)
+		planetOffsets.append(strings.add(planetName));
+
+	Header h;
+	memset(&h, 0, sizeof(Header));
+	StelMappedCatalog::initSignature(h.signature, Magic, Version);
+	h.count = count;
+	h.planetCount = planetNames.size();
+	h.nrOfBands = NrOfBands;
+	h.timeZonesHash = timeZonesHash;
+	h.coordinatesOffset = StelMappedCatalog::align8(sizeof(Header));
+	h.recordsOffset = StelMappedCatalog::align8(h.coordinatesOffset + h.count*sizeof(Coordinates));
+	h.planetsOffset = StelMappedCatalog::align8(h.recordsOffset + h.count*sizeof(Record));
+	h.bandIndexOffset = h.planetsOffset + h.planetCount*sizeof(quint32);
+	h.idIndexOffset = h.bandIndexOffset + bands.size()*sizeof(quint32);
+	h.stringsOffset = h.idIndexOffset + ids.size()*sizeof(quint32);
+	h.stringsSize = strings.data.size();
+	h.sourceSize = source.size();
+	h.sourceModified = source.lastModified().toMSecsSinceEpoch();
+
+	StelMappedCatalog::Writer out(catalogPath, "location file");
+	if (!out.open())
+		return false;
+	out.write(0, &h, sizeof(Header));
+	out.write(h.coordinatesOffset, sortedCoordinates.constData(), h.count*sizeof(Coordinates));
+	out.write(h.recordsOffset, sortedRecords.constData(), h.count*sizeof(Record));
+	out.write(h.planetsOffset, planetOffsets.constData(), planetOffsets.size()*sizeof(quint32));
+	out.write(h.bandIndexOffset, bands.constData(), bands.size()*sizeof(quint32));
+	out.write(h.idIndexOffset, ids.constData(), ids.size()*sizeof(quint32));
+	out.write(h.stringsOffset, strings.data);
+	return out.commit(h.stringsOffset+h.stringsSize);
+}
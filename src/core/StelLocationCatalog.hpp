@@ -0,0 +1,177 @@
+/*
+ * Stellarium
+ * Copyright (C) 2017 Stellarium Developers
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Suite 500, Boston, MA  02110-1335, USA.
+ */
+
+#ifndef _STELLOCATIONCATALOG_HPP_
+#define _STELLOCATIONCATALOG_HPP_
+
+#include "StelLocation.hpp"
+#include "StelMappedCatalog.hpp"
+
+#include <QFileInfo>
+#include <QHash>
+#include <QMap>
+#include <QString>
+#include <QStringList>
+#include <QVector>
+
+//! @class StelLocationCatalog
+//! Read-only, memory-mapped binary store of the base locations. The gzipped base_locations.bin.gz
+//! file is converted once by StelLocationMgr, after the check of its time zone names, into this
+//! format, which is then mapped into memory at startup instead of being uncompressed and deserialized.
+//!
+//! The file contains, after a header:
+//! - the coordinates of the locations, in a column of their own for the spatial queries,
+//! - the other data of the locations, as fixed-size records in the same order,
+//! - the names of the planets, and for each planet the index of the first location of each band
+//!   of BandDegrees degrees of latitude. The locations are sorted by planet, band and longitude,
+//!   so that findNearby() only reads the longitudes around the requested position in a few bands,
+//! - the indices of the locations sorted by ID, for findID(),
+//! - a table of UTF-8 strings, where identical strings (countries, time zones...) are stored once.
+//!
+//! The strings are converted to QString once by load(). The StelLocation objects returned by
+//! getLocation() share these strings instead of holding copies. The header keeps the size and date of
+//! modification of the converted file, so that a changed source is detected by isImportOf().
+//!
+//! The file is read and written with StelMappedCatalog, as DsoCatalog.
+class StelLocationCatalog
+{
+public:
+	//! Position of a location [deg]. The longitude is in [-180, 180].
+	struct Coordinates
+	{
+		float longitude;
+		float latitude;
+	};
+
+	//! Data of a location, as in StelLocation (44 bytes).
+	struct Record
+	{
+		quint32 id;                 //!< offsets in the string table
+		quint32 name;
+		quint32 state;
+		quint32 country;
+		quint32 planetName;
+		quint32 ianaTimeZone;
+		quint32 landscapeKey;
+		qint32 altitude;
+		qint32 population;
+		float bortleScaleIndex;
+		quint16 role;
+		quint16 reserved;
+	};
+
+	StelLocationCatalog();
+	~StelLocationCatalog();
+
+	//! Map a location file into memory.
+	//! @return false if the file cannot be read or is not a valid location file for this machine.
+	bool load(const QString& catalogPath);
+	//! Unmap the file.
+	void clear();
+
+	bool isLoaded() const {return header!=Q_NULLPTR;}
+	int size() const;
+	//! Return the value given to write() to identify the time zones known when the file was written.
+	quint32 getTimeZonesHash() const;
+	//! Get whether the file was written from sourcePath in its current state, i.e. whether its size
+	//! and date of modification are those given to write().
+	bool isImportOf(const QString& sourcePath) const;
+
+	//! Return the key of a location in the map given to write().
+	QString getID(int index) const {return getString(records[index].id);}
+	QString getCountry(int index) const {return getString(records[index].country);}
+	//! Return a location. Its strings are shared with the catalogue and with the other locations.
+	StelLocation getLocation(int index) const;
+	const Coordinates& getCoordinates(int index) const {return coordinates[index];}
+
+	//! Return the index of the location with the given ID, or -1 if there is none.
+	int findID(const QString& id) const;
+	//! Return the IDs of all locations, sorted as the keys of a QMap.
+	QStringList getIDs() const;
+
+	//! Return the indices of the locations of a planet within radiusDegrees of a position, as
+	//! tested by StelLocation::distanceDegrees().
+	QVector<int> findNearby(const QString& planetName, float longitude, float latitude, float radiusDegrees) const;
+	//! Return the index of the location of a planet nearest to a position, or -1 if there is none
+	//! within maxDistanceDegrees.
+	//! @param distanceDegrees if not null, receives the distance of the location found.
+	int findNearest(const QString& planetName, float longitude, float latitude, float maxDistanceDegrees,
+			float* distanceDegrees=Q_NULLPTR) const;
+
+	//! Write a location file.
+	//! The file is only replaced when it is complete.
+	//! @param timeZonesHash stored for getTimeZonesHash()
+	//! @param source the file the locations were read from, see isImportOf()
+	static bool write(const QString& catalogPath, const QMap<QString, StelLocation>& locations, quint32 timeZonesHash,
+			  const QFileInfo& source);
+
+	//! Magic number at the beginning of a location file.
+	static const char Magic[4];
+	//! Version of the file format.
+	static const quint32 Version = 2;
+	//! Height of the bands of latitude of the index [deg].
+	static const int BandDegrees = 1;
+	//! Number of bands of latitude per planet.
+	static const int NrOfBands = 180/BandDegrees;
+
+private:
+	//! File header (104 bytes).
+	struct Header
+	{
+		StelMappedCatalog::Signature signature;
+		quint32 count;
+		quint32 planetCount;
+		quint32 nrOfBands;
+		quint32 timeZonesHash;
+		quint32 reserved0;
+		quint64 coordinatesOffset;
+		quint64 recordsOffset;
+		quint64 planetsOffset;
+		quint64 bandIndexOffset;
+		quint64 idIndexOffset;
+		quint64 stringsOffset;
+		quint64 stringsSize;
+		quint64 sourceSize;         //!< [bytes] of the converted file
+		qint64 sourceModified;      //!< [ms] since 1970-01-01 UTC, of the converted file
+	};
+
+	typedef StelMappedCatalog::StringTable StringTable;
+	class RecordOrder;
+	//! Return the band of a latitude [deg].
+	static int getBand(double latitude);
+	QString getString(quint32 offset) const {return stringValues.value(offset);}
+	//! Index of a planet in the file, or -1.
+	int findPlanet(const QString& planetName) const;
+	//! Append to result the locations of [begin, end) with a longitude in [minLongitude, maxLongitude]
+	//! which are within radiusDegrees of a position.
+	void findInRange(int begin, int end, float minLongitude, float maxLongitude,
+			 float longitude, float latitude, float radiusDegrees, QVector<int>& result) const;
+
+	StelMappedCatalog file;
+	const Header* header;
+	const Coordinates* coordinates;
+	const Record* records;
+	const quint32* planets;
+	const quint32* bandIndex;
+	const quint32* idIndex;
+	//! The strings of the string table, by offset
+	QHash<quint32, QString> stringValues;
+};
+
+#endif // _STELLOCATIONCATALOG_HPP_
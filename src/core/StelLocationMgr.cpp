@@ -18,6 +18,7 @@
 
 #include "StelLocationMgr.hpp"
 #include "StelLocationMgr_p.hpp"
+#include "StelLocationCatalog.hpp"
 
 #include "StelApp.hpp"
 #include "StelCore.hpp"
@@ -29,6 +30,7 @@
 #include <QStringListModel>
 #include <QDebug>
 #include <QFile>
+#include <QFileInfo>
 #include <QDir>
 #include <QNetworkInterface>
 #include <QNetworkAccessManager>
@@ -37,6 +39,7 @@
 #include <QUrl>
 #include <QUrlQuery>
 #include <QSettings>
+#include <QSet>
 #include <QTimeZone>
 
 TimezoneNameMap StelLocationMgr::locationDBToIANAtranslations;
@@ -296,7 +299,7 @@ void NMEALookupHelper::nmeaTimeout()
 #endif
 
 StelLocationMgr::StelLocationMgr()
-	: nmeaHelper(Q_NULLPTR), libGpsHelper(Q_NULLPTR)
+	: baseCatalog(new StelLocationCatalog()), nmeaHelper(Q_NULLPTR), libGpsHelper(Q_NULLPTR)
 {
 	// initialize the static QMap first if necessary.
 	if (locationDBToIANAtranslations.count()==0)
@@ -346,8 +349,8 @@ StelLocationMgr::StelLocationMgr()
 	if (conf->value("devel/convert_locations_list", false).toBool())
 		generateBinaryLocationFile("data/base_locations.txt", false, "data/base_locations.bin");
 
-	locations = loadCitiesBin("data/base_locations.bin.gz");
-	locations.unite(loadCities("data/user_locations.txt", true));
+	loadBaseLocations("data/base_locations.bin.gz");
+	otherLocations.unite(loadCities("data/user_locations.txt", true));
 	
 	// Init to Paris France because it's the center of the world.
 	lastResortLocation = locationForString(conf->value("init_location/last_location", "Paris, France").toString());
@@ -359,7 +362,7 @@ StelLocationMgr::~StelLocationMgr()
 }
 
 StelLocationMgr::StelLocationMgr(const LocationList &locations)
-	: nmeaHelper(Q_NULLPTR), libGpsHelper(Q_NULLPTR)
+	: baseCatalog(new StelLocationCatalog()), nmeaHelper(Q_NULLPTR), libGpsHelper(Q_NULLPTR)
 {
 	setLocations(locations);
 
@@ -372,12 +375,55 @@ void StelLocationMgr::setLocations(const LocationList &locations)
 {
 	for(LocationList::const_iterator it = locations.constBegin();it!=locations.constEnd();++it)
 	{
-		this->locations.insert(it->getID(),*it);
+		otherLocations.insert(it->getID(),*it);
 	}
 
 	emit locationListChanged();
 }
 
+void StelLocationMgr::setLocations(const StelLocationMgr& other)
+{
+	otherLocations = other.otherLocations;
+	baseCatalog = other.baseCatalog;
+
+	emit locationListChanged();
+}
+
+LocationList StelLocationMgr::getAll() const
+{
+	return getAllMap().values();
+}
+
+LocationMap StelLocationMgr::getAllMap() const
+{
+	LocationMap result;
+	for (int i=0; i<baseCatalog->size(); ++i)
+		result.insert(baseCatalog->getID(i), baseCatalog->getLocation(i));
+	for (LocationMap::const_iterator it=otherLocations.constBegin(); it!=otherLocations.constEnd(); ++it)
+		result.insert(it.key(), it.value());
+	return result;
+}
+
+QStringList StelLocationMgr::getAllIDs() const
+{
+	// Merge the two sorted lists, without the base locations replaced by other locations.
+	const QStringList baseIDs = baseCatalog->getIDs();
+	QStringList result;
+	result.reserve(baseIDs.size()+otherLocations.size());
+	QStringList::const_iterator base = baseIDs.constBegin();
+	for (LocationMap::const_iterator it=otherLocations.constBegin(); it!=otherLocations.constEnd(); ++it)
+	{
+		for (; base!=baseIDs.constEnd() && *base<it.key(); ++base)
+			result.append(*base);
+		if (base!=baseIDs.constEnd() && *base==it.key())
+			++base;
+		result.append(it.key());
+	}
+	for (; base!=baseIDs.constEnd(); ++base)
+		result.append(*base);
+	return result;
+}
+
 void StelLocationMgr::generateBinaryLocationFile(const QString& fileName, bool isUserLocation, const QString& binFilePath) const
 {
 	qWarning() << "Generating a locations list...";
@@ -420,7 +466,8 @@ LocationMap StelLocationMgr::loadCitiesBin(const QString& fileName)
 	}
 	// Now res has all location data. However, some timezone names are not available in various versions of Qt.
 	// Sanity checks: It seems we must translate timezone names. Quite a number on Windows, but also still some on Linux.
-	QList<QByteArray> availableTimeZoneList=QTimeZone::availableTimeZoneIds();
+	// This is only done when baseCatalog is written, see loadBaseLocations().
+	const QSet<QByteArray> availableTimeZoneList=QTimeZone::availableTimeZoneIds().toSet();
 	QStringList unknownTZlist;
 	QMap<QString, StelLocation>::iterator i=res.begin();
 	while (i!=res.end())
@@ -460,6 +507,45 @@ LocationMap StelLocationMgr::loadCitiesBin(const QString& fileName)
 	return res;
 }
 
+void StelLocationMgr::loadBaseLocations(const QString& fileName)
+{
+	const QString binPath = StelFileMgr::findFile(fileName);
+	if (binPath.isEmpty())
+		return;
+
+	// The location catalogue is a cache of the binary location file in the user directory, one per source path.
+	const QFileInfo sourceInfo(binPath);
+	const QString catalogDir = StelFileMgr::getUserDir()+"/data";
+	const QString catalogPath = QString("%1/locations-%2.cat").arg(catalogDir)
+				    .arg(qHash(sourceInfo.absoluteFilePath()), 8, 16, QChar('0'));
+	const quint32 timeZonesHash = getTimeZonesHash();
+	if (!QFileInfo(catalogPath).exists() || !baseCatalog->load(catalogPath)
+	    || !baseCatalog->isImportOf(binPath) || baseCatalog->getTimeZonesHash()!=timeZonesHash)
+	{
+		baseCatalog->clear();
+		const LocationMap baseLocations = loadCitiesBin(fileName);
+		QDir().mkpath(catalogDir);
+		if (!StelLocationCatalog::write(catalogPath, baseLocations, timeZonesHash, sourceInfo) || !baseCatalog->load(catalogPath))
+		{
+			// Keep the locations without their spatial index.
+			baseCatalog->clear();
+			otherLocations = baseLocations;
+			return;
+		}
+		qDebug() << "Converted" << QDir::toNativeSeparators(binPath) << "to" << QDir::toNativeSeparators(catalogPath);
+	}
+}
+
+quint32 StelLocationMgr::getTimeZonesHash()
+{
+	uint hash = 0;
+	foreach (const QByteArray& id, QTimeZone::availableTimeZoneIds())
+		hash = 31*hash + qHash(id);
+	for (TimezoneNameMap::const_iterator it=locationDBToIANAtranslations.constBegin(); it!=locationDBToIANAtranslations.constEnd(); ++it)
+		hash = 31*hash + qHash(it.key()) + 7*qHash(it.value());
+	return hash;
+}
+
 // Done in the following: TZ name sanitizing also for text file!
 LocationMap StelLocationMgr::loadCities(const QString& fileName, bool isUserLocation)
 {
@@ -541,11 +627,16 @@ static float parseAngle(const QString& s, bool* ok)
 
 const StelLocation StelLocationMgr::locationForString(const QString& s) const
 {
-	QMap<QString, StelLocation>::const_iterator iter = locations.find(s);
-	if (iter!=locations.end())
+	QMap<QString, StelLocation>::const_iterator iter = otherLocations.find(s);
+	if (iter!=otherLocations.end())
 	{
 		return iter.value();
 	}
+	const int index = baseCatalog->findID(s);
+	if (index>=0)
+	{
+		return baseCatalog->getLocation(index);
+	}
 	StelLocation ret;
 	// Maybe it is a coordinate set ? (e.g. GPS 25.107363,121.558807 )
 	QRegExp reg("(?:(.+)\\s+)?(.+),(.+)");
@@ -586,7 +677,7 @@ const StelLocation StelLocationMgr::locationFromCLI() const
 // Get whether a location can be permanently added to the list of user locations
 bool StelLocationMgr::canSaveUserLocation(const StelLocation& loc) const
 {
-	return loc.isValid() && locations.find(loc.getID())==locations.end();
+	return loc.isValid() && !otherLocations.contains(loc.getID()) && baseCatalog->findID(loc.getID())<0;
 }
 
 // Add permanently a location to the list of user locations
@@ -596,7 +687,7 @@ bool StelLocationMgr::saveUserLocation(const StelLocation& loc)
 		return false;
 
 	// Add in the program
-	locations[loc.getID()]=loc;
+	otherLocations[loc.getID()]=loc;
 
 	//emit before saving the list
 	emit locationListChanged();
@@ -638,10 +729,11 @@ bool StelLocationMgr::saveUserLocation(const StelLocation& loc)
 // If the location comes from the base read only list, it cannot be deleted
 bool StelLocationMgr::canDeleteUserLocation(const QString& id) const
 {
-	QMap<QString, StelLocation>::const_iterator iter=locations.find(id);
+	// The base locations are not user locations.
+	QMap<QString, StelLocation>::const_iterator iter=otherLocations.find(id);
 
 	// If it's not known at all there is a problem
-	if (iter==locations.end())
+	if (iter==otherLocations.end())
 		return false;
 
 	return iter.value().isUserLocation;
@@ -654,7 +746,7 @@ bool StelLocationMgr::deleteUserLocation(const QString& id)
 	if (!canDeleteUserLocation(id))
 		return false;
 
-	locations.remove(id);
+	otherLocations.remove(id);
 
 	//emit before saving the list
 	emit locationListChanged();
@@ -687,7 +779,7 @@ bool StelLocationMgr::deleteUserLocation(const QString& id)
 	QTextStream outstream(&sourcefile);
 	outstream.setCodec("UTF-8");
 
-	for (QMap<QString, StelLocation>::ConstIterator iter=locations.constBegin();iter!=locations.constEnd();++iter)
+	for (QMap<QString, StelLocation>::ConstIterator iter=otherLocations.constBegin();iter!=otherLocations.constEnd();++iter)
 	{
 		if (iter.value().isUserLocation)
 		{
@@ -816,7 +908,9 @@ void StelLocationMgr::changeLocationFromNetworkLookup()
 LocationMap StelLocationMgr::pickLocationsNearby(const QString planetName, const float longitude, const float latitude, const float radiusDegrees)
 {
 	QMap<QString, StelLocation> results;
-	QMapIterator<QString, StelLocation> iter(locations);
+	foreach (int i, baseCatalog->findNearby(planetName, longitude, latitude, radiusDegrees))
+		results.insert(baseCatalog->getID(i), baseCatalog->getLocation(i));
+	QMapIterator<QString, StelLocation> iter(otherLocations);
 	while (iter.hasNext())
 	{
 		iter.next();
@@ -830,10 +924,40 @@ LocationMap StelLocationMgr::pickLocationsNearby(const QString planetName, const
 	return results;
 }
 
+StelLocation StelLocationMgr::pickNearestLocation(const QString planetName, const float longitude, const float latitude, const float maxDistanceDegrees)
+{
+	StelLocation result;
+	result.role = '!';
+	float resultDistance = maxDistanceDegrees;
+	const int i = baseCatalog->findNearest(planetName, longitude, latitude, maxDistanceDegrees, &resultDistance);
+	if (i>=0)
+		result = baseCatalog->getLocation(i);
+	QMapIterator<QString, StelLocation> iter(otherLocations);
+	while (iter.hasNext())
+	{
+		iter.next();
+		const StelLocation *loc=&iter.value();
+		if (loc->planetName != planetName)
+			continue;
+		const float distance = StelLocation::distanceDegrees(longitude, latitude, loc->longitude, loc->latitude);
+		if (result.isValid() ? distance < resultDistance : distance <= resultDistance)
+		{
+			result = *loc;
+			resultDistance = distance;
+		}
+	}
+	return result;
+}
+
 LocationMap StelLocationMgr::pickLocationsInCountry(const QString country)
 {
 	QMap<QString, StelLocation> results;
-	QMapIterator<QString, StelLocation> iter(locations);
+	for (int i=0; i<baseCatalog->size(); ++i)
+	{
+		if (baseCatalog->getCountry(i) == country)
+			results.insert(baseCatalog->getID(i), baseCatalog->getLocation(i));
+	}
+	QMapIterator<QString, StelLocation> iter(otherLocations);
 	while (iter.hasNext())
 	{
 		iter.next();
@@ -24,12 +24,15 @@
 #include <QObject>
 #include <QMetaType>
 #include <QMap>
+#include <QStringList>
+#include <QSharedPointer>
 
 typedef QList<StelLocation> LocationList;
 typedef QMap<QString,StelLocation> LocationMap;
 typedef QMap<QByteArray,QByteArray> TimezoneNameMap;
 
 class GPSLookupHelper;
+class StelLocationCatalog;
 
 //! @class StelLocationMgr
 //! Manage the list of available location.
@@ -47,12 +50,20 @@ public:
 
 	//! Replaces the loaded location list
 	void setLocations(const LocationList& locations);
+	//! Replaces the loaded location list by the one of another StelLocationMgr.
+	//! The base locations and their spatial index are shared with it.
+	void setLocations(const StelLocationMgr& other);
 
-	//! Return the list of all loaded locations
-	LocationList getAll() const {return locations.values();}
+	//! Return the list of all loaded locations.
+	//! The base locations are read from their catalogue at each call, see getAllMap().
+	LocationList getAll() const;
 
 	//! Returns a map of all loaded locations. The key is the location ID, suitable for a list view.
-	LocationMap getAllMap() const { return locations; }
+	//! The base locations are read from their catalogue at each call: use getAllIDs() when only the IDs are needed.
+	LocationMap getAllMap() const;
+
+	//! Return the IDs of all loaded locations, sorted as the keys of getAllMap().
+	QStringList getAllIDs() const;
 
 	//! Return the StelLocation from a CLI
 	const StelLocation locationFromCLI() const;
@@ -80,6 +91,9 @@ public:
 
 	//! Find list of locations within @param radiusDegrees of selected (usually screen-clicked) coordinates.
 	LocationMap pickLocationsNearby(const QString planetName, const float longitude, const float latitude, const float radiusDegrees);
+	//! Find the location nearest to selected coordinates.
+	//! @return the location, or an invalid location if there is none within @param maxDistanceDegrees.
+	StelLocation pickNearestLocation(const QString planetName, const float longitude, const float latitude, const float maxDistanceDegrees=180.f);
 	//! Find list of locations in a particular country only.
 	LocationMap pickLocationsInCountry(const QString country);
 
@@ -133,9 +147,19 @@ private:
 	//! Load cities from a file
 	static LocationMap loadCities(const QString& fileName, bool isUserLocation);
 	static LocationMap loadCitiesBin(const QString& fileName);
-
-	//! The list of all loaded locations
-	LocationMap locations;
+	//! Load the base locations into baseCatalog, which is written from the binary location file when it
+	//! was not converted from this file in its current state or with the current list of time zones known to Qt.
+	void loadBaseLocations(const QString& fileName);
+	//! Return a hash of the time zone names known to Qt and of their translations, which decide the
+	//! time zone names stored in baseCatalog.
+	static quint32 getTimeZonesHash();
+
+	//! The base locations, with their spatial index. Read-only once loaded, it can be shared by other
+	//! StelLocationMgr, see setLocations().
+	QSharedPointer<StelLocationCatalog> baseCatalog;
+	//! The locations which are not in baseCatalog: user locations, or all locations given to setLocations().
+	//! They are searched one by one by pickLocationsNearby(), and replace the base locations with the same ID.
+	LocationMap otherLocations;
 	//! A Map which has to be used to replace, system- and Qt-version dependent,
 	//! timezone names from our location database to the code names currently used by Qt.
 	//! Required to avoid https://bugs.launchpad.net/stellarium/+bug/1662132,
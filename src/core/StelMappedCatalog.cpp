@@ -0,0 +1,154 @@
+/*
+ * Stellarium
+ * Copyright (C) 2017 Stellarium Developers
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Suite 500, Boston, MA  02110-1335, USA.
+ */
+
+#include "StelMappedCatalog.hpp"
+
+#include <QDebug>
+#include <QDir>
+
+#include <cstring>
+
+// Written in the signature to detect files from machines with another byte order.
+static const quint32 BYTE_ORDER_MARK = 0x01020304;
+
+quint32 StelMappedCatalog::StringTable::add(const QString& s)
+{
+	if (s.isEmpty())
+		return 0;
+	QHash<QString, quint32>::const_iterator it = offsets.constFind(s);
+	if (it!=offsets.constEnd())
+		return it.value();
+	const quint32 offset = data.size();
+	data.append(s.toUtf8());
+	data.append('\0');
+	offsets.insert(s, offset);
+	return offset;
+}
+
+StelMappedCatalog::Writer::Writer(const QString& path, const char* description)
+	: out(path)
+	, description(description)
+{
+}
+
+bool StelMappedCatalog::Writer::open()
+{
+	if (!out.open(QIODevice::WriteOnly))
+	{
+		qWarning() << "Cannot write" << description << QDir::toNativeSeparators(out.fileName()) << out.errorString();
+		return false;
+	}
+	return true;
+}
+
+void StelMappedCatalog::Writer::write(quint64 offset, const void* data, quint64 size)
+{
+	static const char padding[8] = {0, 0, 0, 0, 0, 0, 0, 0};
+	while (static_cast<quint64>(out.pos())<offset && out.error()==QFile::NoError)
+		out.write(padding, qMin(offset-out.pos(), quint64(sizeof(padding))));
+	out.write(static_cast<const char*>(data), size);
+}
+
+bool StelMappedCatalog::Writer::commit(quint64 expectedSize)
+{
+	if (out.error()!=QFile::NoError || static_cast<quint64>(out.pos())!=expectedSize)
+	{
+		qWarning() << "Error writing" << description << QDir::toNativeSeparators(out.fileName()) << out.errorString();
+		out.cancelWriting();
+		return false;
+	}
+	if (!out.commit())
+	{
+		qWarning() << "Error writing" << description << QDir::toNativeSeparators(out.fileName()) << out.errorString();
+		return false;
+	}
+	return true;
+}
+
+StelMappedCatalog::StelMappedCatalog()
+	: data(Q_NULLPTR)
+	, size(0)
+{
+}
+
+StelMappedCatalog::~StelMappedCatalog()
+{
+	close();
+}
+
+bool StelMappedCatalog::open(const QString& path, const char* magic, quint32 version, quint64 headerSize, const char* description)
+{
+	close();
+	file.setFileName(path);
+	if (!file.open(QIODevice::ReadOnly))
+	{
+		qWarning() << "Cannot open" << description << QDir::toNativeSeparators(path);
+		return false;
+	}
+	size = file.size();
+	if (size<headerSize || size<sizeof(Signature) || !(data = file.map(0, size)))
+	{
+		qWarning() << "Cannot map" << description << QDir::toNativeSeparators(path);
+		close();
+		return false;
+	}
+	const Signature* s = reinterpret_cast<const Signature*>(data);
+	if (memcmp(s->magic, magic, sizeof(s->magic))!=0 || s->version!=version || s->byteOrder!=BYTE_ORDER_MARK)
+	{
+		qWarning() << "Invalid" << description << QDir::toNativeSeparators(path) << "(other format version or byte order)";
+		close();
+		return false;
+	}
+	return true;
+}
+
+void StelMappedCatalog::close()
+{
+	if (data)
+		file.unmap(const_cast<uchar*>(data));
+	file.close();
+	data = Q_NULLPTR;
+	size = 0;
+}
+
+bool StelMappedCatalog::containsSection(quint64 offset, quint64 count, quint64 itemSize, quint64 alignment) const
+{
+	// Written so that a corrupt offset or count cannot overflow
+	return offset<=size && offset%alignment==0 && (itemSize==0 || count<=(size-offset)/itemSize);
+}
+
+bool StelMappedCatalog::containsStrings(quint64 offset, quint64 stringsSize) const
+{
+	return stringsSize>0 && containsSection(offset, stringsSize, 1, 1) && data[offset+stringsSize-1]=='\0';
+}
+
+void StelMappedCatalog::initSignature(Signature& signature, const char* magic, quint32 version)
+{
+	memcpy(signature.magic, magic, sizeof(signature.magic));
+	signature.version = version;
+	signature.byteOrder = BYTE_ORDER_MARK;
+}
+
+QString StelMappedCatalog::getString(const char* strings, quint64 stringsSize, quint32 offset)
+{
+	if (offset>=stringsSize)
+		return QString();
+	// The string table ends with a 0, see containsStrings().
+	return QString::fromUtf8(strings+offset);
+}
@@ -0,0 +1,106 @@
+/*
+ * Stellarium
+ * Copyright (C) 2017 Stellarium Developers
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Suite 500, Boston, MA  02110-1335, USA.
+ */
+
+#ifndef _STELMAPPEDCATALOG_HPP_
+#define _STELMAPPEDCATALOG_HPP_
+
+#include <QByteArray>
+#include <QFile>
+#include <QHash>
+#include <QSaveFile>
+#include <QString>
+
+//! @class StelMappedCatalog
+//! A binary catalogue file mapped into memory, as used by MinorBodyCatalog, DsoCatalog and StelLocationCatalog.
+//! Such a file starts with a Signature, followed by the rest of the header of the catalogue and by its
+//! sections, aligned on 8 bytes. Strings are stored in a table of 0-terminated UTF-8 strings.
+//! All numbers are stored in the byte order of the machine which wrote the file: files written on a
+//! machine with another byte order are rejected by open() and have to be written again.
+class StelMappedCatalog
+{
+public:
+	//! Beginning of the header of every catalogue (12 bytes).
+	struct Signature
+	{
+		char magic[4];
+		quint32 version;
+		quint32 byteOrder;
+	};
+
+	//! Strings of a catalogue being written. Identical strings are stored once, offset 0 is the empty string.
+	class StringTable
+	{
+	public:
+		StringTable() : data(1, '\0') {}
+		quint32 add(const QString& s);
+		QByteArray data;
+	private:
+		QHash<QString, quint32> offsets;
+	};
+
+	//! Writes a catalogue file. The file is only replaced when it is complete,
+	//! so that a failed write keeps the previous catalogue.
+	class Writer
+	{
+	public:
+		//! @param description the kind of catalogue, e.g. "DSO catalogue", used in the warnings
+		Writer(const QString& path, const char* description);
+		bool open();
+		//! Write a section, after padding the file with zeros up to offset.
+		void write(quint64 offset, const void* data, quint64 size);
+		void write(quint64 offset, const QByteArray& data) {write(offset, data.constData(), data.size());}
+		//! Check that the file has expectedSize bytes and replace the previous file.
+		bool commit(quint64 expectedSize);
+	private:
+		QSaveFile out;
+		const char* description;
+	};
+
+	StelMappedCatalog();
+	~StelMappedCatalog();
+
+	//! Map a catalogue file into memory and check its signature.
+	//! @param description the kind of catalogue, e.g. "DSO catalogue", used in the warnings
+	//! @return false if the file cannot be mapped, is smaller than headerSize,
+	//! or has another magic number, version or byte order.
+	bool open(const QString& path, const char* magic, quint32 version, quint64 headerSize, const char* description);
+	//! Unmap and close the file.
+	void close();
+
+	const uchar* getData() const {return data;}
+	quint64 getSize() const {return size;}
+	//! Return whether count items of itemSize bytes at offset are within the file, and offset is a multiple of alignment.
+	bool containsSection(quint64 offset, quint64 count, quint64 itemSize, quint64 alignment) const;
+	//! Return whether a string table of stringsSize bytes at offset is within the file and ends with a 0.
+	bool containsStrings(quint64 offset, quint64 stringsSize) const;
+
+	//! Fill a signature with the byte order of this machine.
+	static void initSignature(Signature& signature, const char* magic, quint32 version);
+	//! Return the string at offset of a string table, or an empty string if offset is out of the table.
+	static QString getString(const char* strings, quint64 stringsSize, quint32 offset);
+	//! Offset of the next section.
+	static quint64 align8(quint64 offset) {return (offset+7) & ~quint64(7);}
+
+private:
+	QFile file;
+	const uchar* data;
+	quint64 size;
+};
+
+#endif // _STELMAPPEDCATALOG_HPP_
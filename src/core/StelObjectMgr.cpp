@@ -453,22 +453,26 @@ QList<StelObjectP> StelObjectMgr::getSelectedObject(const QString& type)
 *******************************************************************************************/
 QStringList StelObjectMgr::listMatchingObjects(const QString& objPrefix, unsigned int maxNbItem, bool useStartOfWords, bool inEnglish) const
 {
-	QStringList result;
-	if (maxNbItem <= 0)
-	{
-		return result;
-	}
+	// Names of all indexed modules, ranked together
+	QStringList result = nameIndex.listMatchingNames(objPrefix, maxNbItem, useStartOfWords, inEnglish);
 
 	// For all StelObjectmodules..
 	foreach (const StelObjectModule* m, objectsModule)
 	{
-		// Get matching object for this module
-		QStringList matchingObj = m->listMatchingObjects(objPrefix, maxNbItem, useStartOfWords, inEnglish);
-		result += matchingObj;
-		maxNbItem-=matchingObj.size();
+		const int remaining = static_cast<int>(maxNbItem) - result.size();
+		if (remaining <= 0)
+			break;
+		// Get matching object for this module, except those already found in the index
+		QStringList matchingObj = nameIndex.contains(m)
+				? m->listMatchingUnindexedObjects(objPrefix, remaining, useStartOfWords, inEnglish)
+				: m->listMatchingObjects(objPrefix, remaining, useStartOfWords, inEnglish);
+		foreach (const QString& name, matchingObj)
+		{
+			if (!result.contains(name))
+				result.append(name);
+		}
 	}
 
-	result.sort();
 	return result;
 }
 
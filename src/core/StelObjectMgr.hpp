@@ -24,6 +24,7 @@
 #include "VecMath.hpp"
 #include "StelModule.hpp"
 #include "StelObject.hpp"
+#include "StelObjectNameIndex.hpp"
 
 #include <QList>
 #include <QString>
@@ -80,12 +81,17 @@ public:
 	bool findAndSelect(const QString &name, StelModule::StelModuleSelectAction action=StelModule::ReplaceSelection);
 
 	//! Find and return the list of at most maxNbItem objects auto-completing the passed object name.
+	//! The names registered in the name index are ranked together, the names of the other modules follow.
 	//! @param objPrefix the case insensitive first letters of the searched object
 	//! @param maxNbItem the maximum number of returned object names.
 	//! @param useStartOfWords the autofill mode for returned objects names
 	//! @return a list of matching object names by order of relevance, or an empty list if nothing match
 	QStringList listMatchingObjects(const QString& objPrefix, unsigned int maxNbItem=5, bool useStartOfWords=false, bool inEnglish=true) const;
 
+	//! Get the index of the names of the objects, in which the StelObjectModules register their names.
+	StelObjectNameIndex& getNameIndex() {return nameIndex;}
+	const StelObjectNameIndex& getNameIndex() const {return nameIndex;}
+
 	QStringList listAllModuleObjects(const QString& moduleId, bool inEnglish) const;
 	QMap<QString, QString> objectModulesMap() const;
 
@@ -156,6 +162,8 @@ private:
 	QList<StelObjectModule*> objectsModule;
 	QMap<QString, StelObjectModule*> typeToModuleMap;
 	QMap<QString, QString> objModulesMap;
+	// Names of the objects of the modules, for listMatchingObjects()
+	StelObjectNameIndex nameIndex;
 
 	// The last selected object in stellarium
 	QList<StelObjectP> lastSelectedObjects;
@@ -19,6 +19,8 @@
  */
 
 #include "StelObjectModule.hpp"
+#include "StelApp.hpp"
+#include "StelObjectMgr.hpp"
 
 StelObjectModule::StelObjectModule()
  : StelModule()
@@ -49,6 +51,21 @@ QStringList StelObjectModule::listMatchingObjects(const QString &objPrefix, int
 		return result;
 	}
 
+	const StelObjectNameIndex& nameIndex = StelApp::getInstance().getStelObjectMgr().getNameIndex();
+	if (nameIndex.contains(this))
+	{
+		result = nameIndex.listMatchingNames(objPrefix, maxNbItem, useStartOfWords, inEnglish, this);
+		if (result.size() < maxNbItem)
+		{
+			foreach (const QString& name, listMatchingUnindexedObjects(objPrefix, maxNbItem-result.size(), useStartOfWords, inEnglish))
+			{
+				if (!result.contains(name))
+					result.append(name);
+			}
+		}
+		return result;
+	}
+
 	QStringList names = listAllObjects(inEnglish);
 	foreach(const QString& name, names)
 	{
@@ -68,6 +85,15 @@ QStringList StelObjectModule::listMatchingObjects(const QString &objPrefix, int
 	return result;
 }
 
+QStringList StelObjectModule::listMatchingUnindexedObjects(const QString &objPrefix, int maxNbItem, bool useStartOfWords, bool inEnglish) const
+{
+	Q_UNUSED(objPrefix);
+	Q_UNUSED(maxNbItem);
+	Q_UNUSED(useStartOfWords);
+	Q_UNUSED(inEnglish);
+	return QStringList();
+}
+
 QStringList StelObjectModule::listAllObjectsByType(const QString &objType, bool inEnglish) const
 {
 	Q_UNUSED(objType);
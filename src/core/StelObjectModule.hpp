@@ -62,7 +62,10 @@ public:
 	//! @param name the english object name
 	virtual StelObjectP searchByID(const QString& id) const = 0;
 
-	//! Find and return the list of at most maxNbItem objects auto-completing passed object name
+	//! Find and return the list of at most maxNbItem objects auto-completing passed object name.
+	//! The default implementation searches the names the module registered in the StelObjectNameIndex
+	//! of the StelObjectMgr, followed by listMatchingUnindexedObjects(). Modules which did not register their
+	//! names are searched in listAllObjects().
 	//! @param objPrefix the first letters of the searched object
 	//! @param maxNbItem the maximum number of returned object names
 	//! @param useStartOfWords decide if start of word is searched
@@ -70,6 +73,12 @@ public:
 	//! @return a list of matching object name by order of relevance, or an empty list if nothing matches
 	virtual QStringList listMatchingObjects(const QString& objPrefix, int maxNbItem=5, bool useStartOfWords=false, bool inEnglish=false) const;
 
+	//! Find the objects auto-completing passed object name which cannot be found in the names registered
+	//! in the StelObjectNameIndex, e.g. catalogue numbers looked up directly or names of large catalogues
+	//! with their own index. Only called for modules which registered their names.
+	//! The parameters are those of listMatchingObjects(). The default implementation returns an empty list.
+	virtual QStringList listMatchingUnindexedObjects(const QString& objPrefix, int maxNbItem, bool useStartOfWords, bool inEnglish) const;
+
 	//! List all StelObjects.
 	//! @param inEnglish list names in English (true) or translated (false)
 	//! @return a list of matching object name by order of relevance, or an empty list if nothing matches
@@ -0,0 +1,251 @@
+/*
+ * Stellarium
+ * Copyright (C) 2017 Stellarium Developers
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Suite 500, Boston, MA  02110-1335, USA.
+ */
+
+#include "StelObjectNameIndex.hpp"
+
+#include <QStringRef>
+
+#include <algorithm>
+#include <climits>
+
+namespace
+{
+	// Order of the keys of a block by folded text
+	struct KeyLess
+	{
+		KeyLess(const QString& folded) : folded(folded) {}
+		template <class Key> QStringRef text(const Key& k) const
+		{
+			return QStringRef(&folded, k.start, k.end-k.start);
+		}
+		template <class Key> bool operator()(const Key& a, const Key& b) const
+		{
+			return QStringRef::compare(text(a), text(b))<0;
+		}
+		template <class Key> bool operator()(const Key& a, const QString& b) const
+		{
+			return text(a).compare(b)<0;
+		}
+		const QString& folded;
+	};
+}
+
+QString StelObjectNameIndex::fold(const QString& name, QVector<int>* wordStarts)
+{
+	const QString decomposed = name.normalized(QString::NormalizationForm_KD);
+	QString result;
+	result.reserve(decomposed.size());
+	bool inWord = false;
+	bool afterBayerLetter = false;
+	for (int i=0; i<decomposed.size(); ++i)
+	{
+		const QChar c = decomposed.at(i);
+		// Diacritics
+		if (c.category()==QChar::Mark_NonSpacing)
+			continue;
+		// Spaces and punctuation only separate words.
+		if (!c.isLetterOrNumber())
+		{
+			inWord = false;
+			afterBayerLetter = false;
+			continue;
+		}
+		// The number of a Bayer letter is optional: "α1 Cen" is indexed as "α Cen".
+		if (afterBayerLetter && c.isDigit())
+			continue;
+		afterBayerLetter = !inWord && c.script()==QChar::Script_Greek;
+		if (!inWord && wordStarts)
+			wordStarts->append(result.size());
+		inWord = true;
+		result.append(c.toCaseFolded());
+	}
+	return result;
+}
+
+void StelObjectNameIndex::setNames(const StelObjectModule* owner, const QVector<Name>& names)
+{
+	Block& block = blocks[owner];
+	block = Block();
+	block.entries.reserve(names.size());
+	block.nameKeys.reserve(names.size());
+
+	// Entries by name, to merge the names registered several times (e.g. a designation given as English and translated name)
+	QHash<QString, int> entryIndex;
+	entryIndex.reserve(names.size());
+	QVector<int> wordStarts;
+	for (int i=0; i<names.size(); ++i)
+	{
+		const Name& n = names.at(i);
+		if (n.name.isEmpty())
+			continue;
+		QHash<QString, int>::const_iterator existing = entryIndex.constFind(n.name);
+		if (existing!=entryIndex.constEnd())
+		{
+			Entry& e = block.entries[existing.value()];
+			e.type |= n.type;
+			e.rank = qMin(e.rank, n.rank);
+			continue;
+		}
+
+		wordStarts.clear();
+		const QString folded = fold(n.name, &wordStarts);
+		if (folded.isEmpty())
+			continue;
+
+		const int index = block.entries.size();
+		Entry e;
+		e.name = n.name;
+		e.start = block.folded.size();
+		e.length = folded.size();
+		e.rank = n.rank;
+		e.type = n.type;
+		block.entries.append(e);
+		entryIndex.insert(n.name, index);
+		block.folded += folded;
+
+		Key key;
+		key.entry = index;
+		key.end = e.start+e.length;
+		for (int w=0; w<wordStarts.size(); ++w)
+		{
+			key.start = e.start+wordStarts.at(w);
+			if (w==0)
+				block.nameKeys.append(key);
+			else
+				block.wordKeys.append(key);
+		}
+	}
+
+	block.minRank = INT_MAX;
+	foreach (const Entry& e, block.entries)
+		block.minRank = qMin(block.minRank, e.rank);
+
+	const KeyLess keyLess(block.folded);
+	std::sort(block.nameKeys.begin(), block.nameKeys.end(), keyLess);
+	std::sort(block.wordKeys.begin(), block.wordKeys.end(), keyLess);
+	block.folded.squeeze();
+	block.wordKeys.squeeze();
+}
+
+void StelObjectNameIndex::removeNames(const StelObjectModule* owner)
+{
+	blocks.remove(owner);
+}
+
+bool StelObjectNameIndex::lessRelevant(const Match& a, const Match& b)
+{
+	if (a.relevance!=b.relevance)
+		return a.relevance<b.relevance;
+	if (a.entry->rank!=b.entry->rank)
+		return a.entry->rank<b.entry->rank;
+	if (a.entry->name.size()!=b.entry->name.size())
+		return a.entry->name.size()<b.entry->name.size();
+	return a.entry->name<b.entry->name;
+}
+
+void StelObjectNameIndex::addMatches(const Block& block, const QVector<Key>& keys, const QString& text, int typeMask,
+				     int maxNbItem, QVector<Match>& matches, QSet<QString>& names)
+{
+	QVector<Key>::const_iterator k = std::lower_bound(keys.constBegin(), keys.constEnd(), text,
+							  KeyLess(block.folded));
+	for (; k!=keys.constEnd(); ++k)
+	{
+		if (k->end-k->start<text.size() || QStringRef(&block.folded, k->start, text.size())!=text)
+			break;
+		const Entry& e = block.entries.at(k->entry);
+
+		Match m;
+		m.entry = &e;
+		m.relevance = k->start!=e.start ? 2 : (k->end-k->start==text.size() ? 0 : 1);
+
+		// matches is a heap with the least relevant match on top.
+		const bool full = matches.size()>=maxNbItem;
+		if (full)
+		{
+			// The keys are sorted by text, so the exact matches come first and the relevance of the
+			// next keys is not lower: stop when none of them can replace the least relevant match.
+			const Match& last = matches.first();
+			if (last.relevance<m.relevance || (last.relevance==m.relevance && last.entry->rank<block.minRank))
+				break;
+		}
+		if (!(e.type & typeMask))
+			continue;
+		if (full && !lessRelevant(m, matches.first()))
+			continue;
+		// The same name can be reached from several of its words, or registered by several modules.
+		if (names.contains(e.name))
+		{
+			for (int i=0; i<matches.size(); ++i)
+			{
+				if (matches.at(i).entry->name==e.name)
+				{
+					if (lessRelevant(m, matches.at(i)))
+					{
+						matches[i] = m;
+						std::make_heap(matches.begin(), matches.end(), lessRelevant);
+					}
+					break;
+				}
+			}
+			continue;
+		}
+		if (full)
+		{
+			std::pop_heap(matches.begin(), matches.end(), lessRelevant);
+			names.remove(matches.last().entry->name);
+			matches.last() = m;
+		}
+		else
+			matches.append(m);
+		names.insert(e.name);
+		std::push_heap(matches.begin(), matches.end(), lessRelevant);
+	}
+}
+
+QStringList StelObjectNameIndex::listMatchingNames(const QString& text, int maxNbItem, bool useStartOfWords, bool inEnglish,
+						   const StelObjectModule* owner) const
+{
+	QStringList result;
+	if (maxNbItem<=0)
+		return result;
+	const QString folded = fold(text);
+	if (folded.isEmpty())
+		return result;
+
+	const int typeMask = inEnglish ? EnglishName : TranslatedName;
+	QVector<Match> matches;
+	matches.reserve(maxNbItem);
+	// Names in matches
+	QSet<QString> names;
+	names.reserve(maxNbItem);
+	for (QHash<const StelObjectModule*, Block>::const_iterator b=blocks.constBegin(); b!=blocks.constEnd(); ++b)
+	{
+		if (owner && b.key()!=owner)
+			continue;
+		addMatches(b.value(), b.value().nameKeys, folded, typeMask, maxNbItem, matches, names);
+		if (!useStartOfWords)
+			addMatches(b.value(), b.value().wordKeys, folded, typeMask, maxNbItem, matches, names);
+	}
+
+	std::sort_heap(matches.begin(), matches.end(), lessRelevant);
+	result.reserve(matches.size());
+	foreach (const Match& m, matches)
+		result.append(m.entry->name);
+	return result;
+}
@@ -0,0 +1,135 @@
+/*
+ * Stellarium
+ * Copyright (C) 2017 Stellarium Developers
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Suite 500, Boston, MA  02110-1335, USA.
+ */
+
+#ifndef _STELOBJECTNAMEINDEX_HPP_
+#define _STELOBJECTNAMEINDEX_HPP_
+
+#include <QHash>
+#include <QSet>
+#include <QString>
+#include <QStringList>
+#include <QVector>
+
+class StelObjectModule;
+
+//! @class StelObjectNameIndex
+//! Names and designations of the objects of the StelObjectModules, indexed to list the names
+//! auto-completing a text without scanning the catalogues at each keystroke.
+//!
+//! Names are compared after folding: case, diacritics and spaces are ignored, so that "m31" matches
+//! "M 31" and "eta car" matches "Eta Carinae". The number following a Greek letter is optional as
+//! well: "α Cen" matches "α1 Cen". Each name can be found from its start or from the start of any
+//! of its words. The folded names of a module are kept in one string and the keys (the positions
+//! of the starts of words) in sorted arrays, searched by binary search.
+//!
+//! Modules register all their names again with setNames() when they load their catalogues and when
+//! the language changes; the names of the other modules are not touched.
+//! The methods are not thread-safe and must be called from the main thread.
+class StelObjectNameIndex
+{
+public:
+	//! Language of an indexed name.
+	enum NameType
+	{
+		EnglishName    = 0x01, //!< Listed when searching English names
+		TranslatedName = 0x02, //!< Listed when searching translated names
+		Designation    = 0x03  //!< Catalogue designation, listed in both cases
+	};
+
+	//! A name to index.
+	struct Name
+	{
+		Name(const QString& name=QString(), NameType type=Designation, int rank=0)
+			: name(name), type(type), rank(rank) {}
+		QString name;
+		NameType type;
+		//! Order of the matches of equal relevance, lower ranks first (e.g. planets before
+		//! named stars before catalogue designations).
+		int rank;
+	};
+
+	//! Replace the names registered by a module.
+	void setNames(const StelObjectModule* owner, const QVector<Name>& names);
+	//! Remove the names registered by a module.
+	void removeNames(const StelObjectModule* owner);
+	//! Return whether a module has registered its names.
+	bool contains(const StelObjectModule* owner) const { return blocks.contains(owner); }
+
+	//! Find the names auto-completing a text, by order of relevance: exact matches first, then names
+	//! starting with the text, then names with a word starting with the text. Matches of equal
+	//! relevance are sorted by rank, then by length.
+	//! @param text the case insensitive text to complete
+	//! @param maxNbItem the maximum number of returned names
+	//! @param useStartOfWords if true, only names starting with the text are returned
+	//! @param inEnglish return English (true) or translated (false) names
+	//! @param owner if set, only return the names of this module
+	QStringList listMatchingNames(const QString& text, int maxNbItem, bool useStartOfWords, bool inEnglish,
+				      const StelObjectModule* owner=Q_NULLPTR) const;
+
+	//! Fold a name as stored in the index.
+	//! @param wordStarts if set, the positions of the starts of words in the folded name are appended to it.
+	static QString fold(const QString& name, QVector<int>* wordStarts=Q_NULLPTR);
+
+private:
+	struct Entry
+	{
+		QString name;
+		int start;	// Position of the folded name in Block::folded
+		int length;	// Length of the folded name
+		int rank;
+		int type;	// NameType flags
+	};
+
+	// Start of a word in a folded name
+	struct Key
+	{
+		int entry;
+		int start;	// Position in Block::folded
+		int end;	// End of the folded name in Block::folded
+	};
+
+	// Names of one module
+	struct Block
+	{
+		Block() : minRank(0) {}
+		QVector<Entry> entries;
+		QString folded;
+		// Keys at the start of the names
+		QVector<Key> nameKeys;
+		// Keys at the start of each word of the names
+		QVector<Key> wordKeys;
+		// Lowest rank of the entries
+		int minRank;
+	};
+
+	// Candidate result
+	struct Match
+	{
+		int relevance;
+		const Entry* entry;
+	};
+
+	static bool lessRelevant(const Match& a, const Match& b);
+	static void addMatches(const Block& block, const QVector<Key>& keys, const QString& text, int typeMask,
+			       int maxNbItem, QVector<Match>& matches, QSet<QString>& names);
+
+	QHash<const StelObjectModule*, Block> blocks;
+};
+
+#endif // _STELOBJECTNAMEINDEX_HPP_
@@ -24,6 +24,7 @@
 #include "StelProjector.hpp"
 #include "StelProjectorClasses.hpp"
 #include "StelUtils.hpp"
+#include "StelTextAtlas.hpp"
 
 #include <QDebug>
 #include <QString>
@@ -33,19 +34,21 @@
 #include <QMutex>
 #include <QVarLengthArray>
 #include <QPaintEngine>
-#include <QCache>
+#include <QElapsedTimer>
 #include <QOpenGLPaintDevice>
 #include <QOpenGLShader>
 #include <QOpenGLTexture>
 #include <QApplication>
 
-static const int TEX_CACHE_LIMIT = 7000000;
-
 #ifndef NDEBUG
 QMutex* StelPainter::globalMutex = new QMutex();
 #endif
 
-QCache<QByteArray, StringTexture> StelPainter::texCache(TEX_CACHE_LIMIT);
+StelTextAtlas* StelPainter::textAtlas=Q_NULLPTR;
+bool StelPainter::flagTextAtlas=false;
+QList<StelPainter*> StelPainter::textPainters;
+StelPainter::TextStatistics StelPainter::textStatistics;
+StelPainter::TextStatistics StelPainter::lastTextStatistics;
 QOpenGLShaderProgram* StelPainter::texturesShaderProgram=Q_NULLPTR;
 QOpenGLShaderProgram* StelPainter::basicShaderProgram=Q_NULLPTR;
 QOpenGLShaderProgram* StelPainter::colorShaderProgram=Q_NULLPTR;
@@ -140,6 +143,8 @@ StelPainter::StelPainter(const StelProjectorP& proj) : QOpenGLFunctions(QOpenGLC
 
 void StelPainter::setProjector(const StelProjectorP& p)
 {
+	// The queued text is positioned for the previous projector
+	flushText();
 	prj=p;
 	// Init GL viewport to current projector values
 	glViewport(prj->viewportXywh[0], prj->viewportXywh[1], prj->viewportXywh[2], prj->viewportXywh[3]);
@@ -148,6 +153,8 @@ void StelPainter::setProjector(const StelProjectorP& p)
 
 StelPainter::~StelPainter()
 {
+	flushText();
+
 	//reset opengl state
 	glState.reset();
 
@@ -592,115 +599,23 @@ void StelPainter::drawText(const Vec3d& v, const QString& str, float angleDeg, f
  Draw the string at the given position and angle with the given font
 *************************************************************************/
 
-// Methods taken from text-use-opengl-buffer
-// Container for one cached string texture
-struct StringTexture
-{
-	QOpenGLTexture* texture;
-	QSize size;
-	QSizeF getTexSize() const {
-		return QSizeF((float)size.width() / texture->width(),
-			      (float)size.height() / texture->height());
-	}
-
-	StringTexture(QOpenGLTexture* tex, const QSize& size) :
-	     texture(tex), size(size) {}
-	~StringTexture() {delete texture;}
-};
-
-StringTexture* StelPainter::getTexTexture(const QString& str, int pixelSize)
-{
-	// Render first the text into a QPixmap, then create a QOpenGLTexture
-	// from it.  We could optimize by directly using a QImage, but for some
-	// reason the result is not exactly the same than with a QPixmap.
-	QByteArray hash = str.toUtf8() + QByteArray::number(pixelSize);
-	StringTexture* cachedTex = texCache.object(hash);
-	if (cachedTex)
-		return cachedTex;
-	QFont tmpFont = currentFont;
-	tmpFont.setPixelSize(currentFont.pixelSize()*prj->getDevicePixelsPerPixel()*StelApp::getInstance().getGlobalScalingRatio());
-	QRect strRect = QFontMetrics(tmpFont).boundingRect(str);
-	int w = strRect.width()+1+(int)(0.02f*strRect.width());
-	int h = strRect.height();
-
-	QPixmap strImage = QPixmap(StelUtils::getBiggerPowerOfTwo(w), StelUtils::getBiggerPowerOfTwo(h));
-	strImage.fill(Qt::transparent);
-	QPainter painter(&strImage);
-	tmpFont.setStyleStrategy(QFont::NoAntialias);
-	painter.setFont(tmpFont);
-	//painter.setRenderHints(QPainter::TextAntialiasing);
-	painter.setPen(Qt::white);
-	painter.drawText(-strRect.x(), -strRect.y(), str);
-	StringTexture* newTex = new StringTexture(new QOpenGLTexture(strImage.toImage()), QSize(w, h));
-	texCache.insert(hash, newTex, 3*w*h);
-	// simply returning newTex is dangerous as the object is owned by the cache now. (Coverity Scan barks.)
-	return texCache.object(hash);
-}
-
 void StelPainter::drawText(float x, float y, const QString& str, float angleDeg, float xshift, float yshift, bool noGravity)
 {
 	if (prj->gravityLabels && !noGravity)
 	{
 		drawTextGravity180(x, y, str, xshift, yshift);
 	}
-	else if (qApp->property("text_texture")==true) // CLI option -t given?
+	else if (flagTextAtlas || qApp->property("text_texture")==true) // CLI option -t given?
 	{
-		//qDebug() <<  "Text texture" << str;
-		// This is taken from branch text-use-opengl-buffer. This is essential on devices like Raspberry Pi (2016-03).
-		StringTexture* tex = getTexTexture(str, currentFont.pixelSize());
-		Q_ASSERT(tex);
+		// This is essential on devices like Raspberry Pi, where QPainter is slow.
 		if (!noGravity)
 			angleDeg += prj->defaultAngleForGravityText;
-		tex->texture->bind();
-
-		static float vertexData[8];
-		// compute the vertex coordinates applying the translation and the rotation
-		static const float vertexBase[] = {0., 0., 1., 0., 0., 1., 1., 1.};
-		if (std::fabs(angleDeg)>1.f*M_PI/180.f)
-		{
-			glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
-			glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
-			const float cosr = std::cos(angleDeg * M_PI/180.);
-			const float sinr = std::sin(angleDeg * M_PI/180.);
-			for (int i = 0; i < 8; i+=2)
-			{
-				vertexData[i] = int(x + (tex->size.width()*vertexBase[i]+xshift) * cosr - (tex->size.height()*vertexBase[i+1]+yshift) * sinr);
-				vertexData[i+1] = int(y  + (tex->size.width()*vertexBase[i]+xshift) * sinr + (tex->size.height()*vertexBase[i+1]+yshift) * cosr);
-			}
-		}
-		else
-		{
-			glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
-			glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
-			for (int i = 0; i < 8; i+=2)
-			{
-				vertexData[i] = int(x + tex->size.width()*vertexBase[i]+xshift);
-				vertexData[i+1] = int(y  + tex->size.height()*vertexBase[i+1]+yshift);
-			}
-		}
-
-		float* texCoords = new float[8];
-		for (int i=0;i<4;i++)
-		{
-			texCoords[i*2+0] = tex->getTexSize().width() * (i % 2);
-			texCoords[i*2+1] = tex->getTexSize().height() * (1 - i / 2);
-		}
-		setTexCoordPointer(2, GL_FLOAT, texCoords);
-
-		//text drawing requires blending, but we reset GL state afterwards if necessary
-		bool oldBlending = glState.blend;
-		GLenum oldSrc = glState.blendSrc, oldDst = glState.blendDst;
-		setBlending(true);
-		enableClientStates(true, true);
-		setVertexPointer(2, GL_FLOAT, vertexData);
-		drawFromArray(TriangleStrip, 4, 0, false);
-		setBlending(oldBlending, oldSrc, oldDst);
-		enableClientStates(false, false);
-		tex->texture->release();
-		delete[] texCoords;
+		queueText(x, y, str, angleDeg, xshift, yshift);
 	}
 	else
 	{
+		QElapsedTimer timer;
+		timer.start();
 		QOpenGLPaintDevice device;
 		device.setSize(QSize(prj->getViewportWidth(), prj->getViewportHeight()));
 		// This doesn't seem to work correctly, so implement the hack below instead.
@@ -749,9 +664,138 @@ void StelPainter::drawText(float x, float y, const QString& str, float angleDeg,
 
 		//QPainter messes up some GL state, begin/endNativePainting or save/restore does not help
 		glState.apply();
+
+		++textStatistics.strings;
+		++textStatistics.drawCalls;
+		textStatistics.cpuTime += timer.nsecsElapsed();
 	}
 }
 
+void StelPainter::queueText(float x, float y, const QString& str, float angleDeg, float xshift, float yshift)
+{
+	QElapsedTimer timer;
+	timer.start();
+
+	QFont tmpFont = currentFont;
+	tmpFont.setPixelSize(currentFont.pixelSize()*prj->getDevicePixelsPerPixel()*StelApp::getInstance().getGlobalScalingRatio());
+	const StelTextAtlas::Layout* layout = textAtlas->getLayout(str, tmpFont);
+	if (!layout)
+	{
+		// The atlas is full: draw the text of all painters which use it, and start again
+		// with the glyphs of the next strings.
+		const QList<StelPainter*> painters = textPainters;
+		foreach (StelPainter* painter, painters)
+			painter->flushText();
+		textAtlas->clear();
+		// The other painters set their own viewport and state
+		glViewport(prj->viewportXywh[0], prj->viewportXywh[1], prj->viewportXywh[2], prj->viewportXywh[3]);
+		glState.apply();
+		layout = textAtlas->getLayout(str, tmpFont);
+		if (!layout)
+			return;
+	}
+	if (textBatches.isEmpty() && !textPainters.contains(this))
+		textPainters.append(this);
+
+	const float scaleRatio = StelApp::getInstance().getGlobalScalingRatio();
+	xshift*=scaleRatio;
+	yshift*=scaleRatio;
+
+	// Same threshold as the previous texture path of the -t option.
+	// Unrotated glyphs are aligned on pixels and sampled without filtering, as in the pages.
+	const bool rotated = std::fabs(angleDeg)>1.f*M_PI/180.f;
+	const float cosr = rotated ? std::cos(angleDeg*M_PI/180.) : 1.f;
+	const float sinr = rotated ? std::sin(angleDeg*M_PI/180.) : 0.f;
+	const float texScale = 1.f/StelTextAtlas::PageSize;
+
+	foreach (const StelTextAtlas::PlacedGlyph& placed, layout->glyphs)
+	{
+		const StelTextAtlas::Glyph& glyph = *placed.glyph;
+		const float w = glyph.pageRect.width();
+		const float h = glyph.pageRect.height();
+		Vec2f corners[4];
+		StelTextAtlas::getGlyphQuad(placed, x, y, xshift, yshift, rotated, cosr, sinr, corners);
+		const float u0 = glyph.pageRect.left()*texScale;
+		const float u1 = (glyph.pageRect.left()+w)*texScale;
+		const float v0 = glyph.pageRect.top()*texScale;
+		const float v1 = (glyph.pageRect.top()+h)*texScale;
+		const Vec2f texCoords[4] = {Vec2f(u0, v0), Vec2f(u1, v0), Vec2f(u0, v1), Vec2f(u1, v1)};
+
+		if (textBatches.isEmpty() || textBatches.last().page!=glyph.page || textBatches.last().linear!=rotated)
+		{
+			TextBatch batch;
+			batch.page = glyph.page;
+			batch.linear = rotated;
+			batch.first = textVertices.size();
+			batch.count = 0;
+			textBatches.append(batch);
+		}
+		// Two triangles per glyph
+		static const int corner[6] = {0, 2, 1, 1, 2, 3};
+		for (int i=0; i<6; ++i)
+		{
+			textVertices.append(corners[corner[i]]);
+			textTexCoords.append(texCoords[corner[i]]);
+			textColors.append(currentColor);
+		}
+		textBatches.last().count += 6;
+	}
+
+	++textStatistics.strings;
+	textStatistics.glyphs += layout->glyphs.size();
+	textStatistics.cpuTime += timer.nsecsElapsed();
+}
+
+void StelPainter::flushText()
+{
+	textPainters.removeOne(this);
+	if (textBatches.isEmpty())
+		return;
+	QElapsedTimer timer;
+	timer.start();
+
+	// The text is positioned for the viewport of this painter
+	glViewport(prj->viewportXywh[0], prj->viewportXywh[1], prj->viewportXywh[2], prj->viewportXywh[3]);
+
+	// Keep the arrays and blending set by the caller
+	const ArrayDesc oldVertexArray = vertexArray, oldTexCoordArray = texCoordArray, oldColorArray = colorArray, oldNormalArray = normalArray;
+	const bool oldBlending = glState.blend;
+	const GLenum oldSrc = glState.blendSrc, oldDst = glState.blendDst;
+	setBlending(true);
+	enableClientStates(true, true, true);
+	setVertexPointer(2, GL_FLOAT, textVertices.constData());
+	setTexCoordPointer(2, GL_FLOAT, textTexCoords.constData());
+	setColorPointer(4, GL_FLOAT, textColors.constData());
+	foreach (const TextBatch& batch, textBatches)
+	{
+		QOpenGLTexture* texture = textAtlas->getPageTexture(batch.page);
+		texture->bind();
+		const GLint filter = batch.linear ? GL_LINEAR : GL_NEAREST;
+		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, filter);
+		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, filter);
+		drawFromArray(Triangles, batch.count, batch.first, false);
+		texture->release();
+		++textStatistics.drawCalls;
+	}
+	vertexArray = oldVertexArray;
+	texCoordArray = oldTexCoordArray;
+	colorArray = oldColorArray;
+	normalArray = oldNormalArray;
+	setBlending(oldBlending, oldSrc, oldDst);
+
+	textVertices.resize(0);
+	textTexCoords.resize(0);
+	textColors.resize(0);
+	textBatches.resize(0);
+	textStatistics.cpuTime += timer.nsecsElapsed();
+}
+
+void StelPainter::resetTextStatistics()
+{
+	lastTextStatistics = textStatistics;
+	textStatistics = TextStatistics();
+}
+
 // Recursive method cutting a small circle in small segments
 inline void fIter(const StelProjectorP& prj, const Vec3d& p1, const Vec3d& p2, Vec3d& win1, Vec3d& win2, QLinkedList<Vec3d>& vertexList, const QLinkedList<Vec3d>::iterator& iter, double radius, const Vec3d& center, int nbI=0, bool checkCrossDiscontinuity=true)
 {
@@ -2086,6 +2130,8 @@ void StelPainter::initGLShaders()
 	texturesColorShaderVars.vertex = texturesColorShaderProgram->attributeLocation("vertex");
 	texturesColorShaderVars.color = texturesColorShaderProgram->attributeLocation("color");
 	texturesColorShaderVars.texture = texturesColorShaderProgram->uniformLocation("tex");
+
+	textAtlas = new StelTextAtlas();
 }
 
 
@@ -2099,7 +2145,8 @@ void StelPainter::deinitGLShaders()
 	texturesShaderProgram = Q_NULLPTR;
 	delete texturesColorShaderProgram;
 	texturesColorShaderProgram = Q_NULLPTR;
-	texCache.clear();
+	delete textAtlas;
+	textAtlas = Q_NULLPTR;
 }
 
 
@@ -26,6 +26,7 @@
 #include "StelProjectorType.hpp"
 #include "StelProjector.hpp"
 #include <QString>
+#include <QList>
 #include <QVarLengthArray>
 #include <QFontMetrics>
 
@@ -88,6 +89,8 @@ public:
 	//! @param yshift shift in pixel in the rotated y direction.
 	//! @param noGravity don't take into account the fact that the text should be written with gravity.
 	//! @param v direction vector of object to draw. GZ20120826: Will draw only if this is in the visible hemisphere.
+	//! When the text atlas is enabled, the text is queued and drawn in batches on top of the other drawings
+	//! of the painter, when the projector is changed or the painter is destroyed.
 	void drawText(float x, float y, const QString& str, float angleDeg=0.f,
               float xshift=0.f, float yshift=0.f, bool noGravity=true);
 	void drawText(const Vec3d& v, const QString& str, float angleDeg=0.f,
@@ -259,6 +262,25 @@ public:
 	//! This method needs to be called once before exit.
 	static void deinitGLShaders();
 
+	//! Set whether text is drawn from the shared glyph atlas (StelTextAtlas) instead of with a QPainter for each string.
+	//! Off by default. The atlas is also used with the -t command line option.
+	static void setFlagTextAtlas(bool b) {flagTextAtlas=b;}
+	static bool getFlagTextAtlas() {return flagTextAtlas;}
+
+	//! Counters of the text drawing, to measure its cost.
+	struct TextStatistics
+	{
+		TextStatistics() : strings(0), glyphs(0), drawCalls(0), cpuTime(0) {}
+		int strings;	//!< Number of strings drawn
+		int glyphs;	//!< Number of glyphs drawn from the atlas
+		int drawCalls;	//!< Number of draw calls issued for text
+		qint64 cpuTime;	//!< Time spent in the text drawing methods [ns]
+	};
+	//! Get the text counters of the last complete frame.
+	static const TextStatistics& getTextStatistics() {return lastTextStatistics;}
+	//! Start counting the text drawing of a new frame. Called by StelApp at the beginning of each frame.
+	static void resetTextStatistics();
+
 	// Thoses methods should eventually be replaced by a single setVertexArray
 	//! use instead of glVertexPointer
 	void setVertexPointer(int size, int type, const void* pointer) {
@@ -333,9 +355,30 @@ private:
 		QOpenGLFunctions* gl;
 	} glState;
 
-	// From text-use-opengl-buffer
-	static QCache<QByteArray, struct StringTexture> texCache;
-	struct StringTexture* getTexTexture(const QString& str, int pixelSize);
+	//! Append the glyphs of a string to the text queue.
+	void queueText(float x, float y, const QString& str, float angleDeg, float xshift, float yshift);
+	//! Draw the queued text, one draw call per atlas page and filtering mode.
+	void flushText();
+
+	//! Glyphs of the text queue drawn with one texture and filtering mode
+	struct TextBatch
+	{
+		int page;
+		bool linear;
+		int first;
+		int count;
+	};
+	QVector<Vec2f> textVertices;
+	QVector<Vec2f> textTexCoords;
+	QVector<Vec4f> textColors;
+	QVector<TextBatch> textBatches;
+
+	static class StelTextAtlas* textAtlas;
+	static bool flagTextAtlas;
+	//! Painters with text queued in the atlas, flushed before it is cleared
+	static QList<StelPainter*> textPainters;
+	static TextStatistics textStatistics;
+	static TextStatistics lastTextStatistics;
 
 	//! Struct describing one opengl array
 	typedef struct ArrayDesc
@@ -39,6 +39,7 @@ class StelProjector
 public:
 	friend class StelPainter;
 	friend class StelCore;
+	friend class TestStelProjector;
 
 	class ModelViewTranform;
 	//! @typedef ModelViewTranformP
@@ -74,6 +75,9 @@ public:
         void combine(const Mat4d& m);
         Mat4d getApproximateLinearTransfo() const;
         ModelViewTranformP clone() const;
+		//! The matrices applied by forward(Vec3d&) and forward(Vec3f&).
+		const Mat4d& getMatrix() const {return transfoMat;}
+		const Mat4f& getMatrixf() const {return transfoMatf;}
 
 	private:
 		//! transfo matrix and invert
@@ -197,6 +201,13 @@ public:
 	//! Get size of a radian in pixels at the center of the viewport disk
 	float getPixelPerRadAtCenter() const;
 
+	//! Get the factors applied to the output of forward() by projectInPlace(), i.e. the pixel per
+	//! radian at the center including horizontal and vertical flips. For code reproducing the projection in shaders.
+	Vec2f getFlippedPixelPerRad() const {return Vec2f(flipHorz*pixelPerRad, flipVert*pixelPerRad);}
+
+	//! Get the horizontal stretch factor applied by forward().
+	float getWidthStretch() const {return widthStretch;}
+
 	//! Get the current FOV diameter in degrees
 	float getFov() const;
 
@@ -229,6 +240,8 @@ public:
 	//! @return true if the projected coordinate is valid.
 	bool project(const Vec3f& v, Vec3f& win) const;
 
+	//! Project n vectors from the current frame into the viewport.
+	//! The projector classes reimplement these methods with batch kernels.
 	virtual void project(int n, const Vec3d* in, Vec3f* out);
 
 	virtual void project(int n, const Vec3f* in, Vec3f* out);
@@ -314,6 +327,16 @@ protected:
 	//! Initialize the bounding cap.
 	virtual void computeBoundingCap();
 
+	//! Number of vertices projected at once by projectBlocks().
+	static const int ProjectBlockSize = 64;
+	//! Project n vectors with a batch kernel, without virtual call per vertex.
+	//! The vectors are transformed by blocks of ProjectBlockSize into arrays of coordinates, with the matrix
+	//! of the model view transform applied inline when it is a Mat4dTransform. The kernel is a class with a static
+	//! method forward(int n, float* x, float* y, float* z, float widthStretch), giving in place the same results
+	//! as the forward() method of the projector, on arrays the compiler can vectorize.
+	//! Only defined in StelProjectorClasses.cpp.
+	template <class Kernel, class Vec> void projectBlocks(int n, const Vec* in, Vec3f* out) const;
+
 	ModelViewTranformP modelViewTransform;	// Operator to apply (if not Q_NULLPTR) before the modelview projection step
 
 	float flipHorz,flipVert;            // Whether to flip in horizontal or vertical directions
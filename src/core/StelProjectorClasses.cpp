@@ -22,6 +22,61 @@
 
 #include <limits>
 
+// Batch projection. For each projector class, a kernel computes in place on arrays of coordinates the same
+// results as the forward() method, with loops the compiler can vectorize. The functions without vector
+// implementation (atan2, asin...) are still computed one by one, but without virtual calls.
+
+static const float MAX_FLOAT = std::numeric_limits<float>::max();
+
+static inline const double* getTransformMatrix(const StelProjector::Mat4dTransform& t, const Vec3d*) {return t.getMatrix().r;}
+static inline const float* getTransformMatrix(const StelProjector::Mat4dTransform& t, const Vec3f*) {return t.getMatrixf().r;}
+
+// Same as Vector3<T>::transfo4d(), to arrays of coordinates
+template <class T>
+static inline void transformBlock(const T* m, const Vector3<T>* v, int n, float* x, float* y, float* z)
+{
+	for (int i=0; i<n; ++i)
+	{
+		x[i] = m[0]*v[i][0] + m[4]*v[i][1] + m[8]*v[i][2] + m[12];
+		y[i] = m[1]*v[i][0] + m[5]*v[i][1] + m[9]*v[i][2] + m[13];
+		z[i] = m[2]*v[i][0] + m[6]*v[i][1] + m[10]*v[i][2] + m[14];
+	}
+}
+
+template <class Kernel, class Vec>
+void StelProjector::projectBlocks(int n, const Vec* in, Vec3f* out) const
+{
+	float x[ProjectBlockSize];
+	float y[ProjectBlockSize];
+	float z[ProjectBlockSize];
+	const Mat4dTransform* transform = dynamic_cast<const Mat4dTransform*>(modelViewTransform.data());
+	const float sx = flipHorz * pixelPerRad;
+	const float sy = flipVert * pixelPerRad;
+	for (int first=0; first<n; first+=ProjectBlockSize)
+	{
+		const int count = n-first<ProjectBlockSize ? n-first : ProjectBlockSize;
+		const Vec* v = in + first;
+		if (transform)
+			transformBlock(getTransformMatrix(*transform, v), v, count, x, y, z);
+		else
+		{
+			// Non linear transformation (e.g. refraction)
+			for (int i=0; i<count; ++i)
+			{
+				Vec t = v[i];
+				modelViewTransform->forward(t);
+				x[i] = t[0];
+				y[i] = t[1];
+				z[i] = t[2];
+			}
+		}
+		Kernel::forward(count, x, y, z, widthStretch);
+		Vec3f* o = out + first;
+		for (int i=0; i<count; ++i)
+			o[i].set(viewportCenter[0] + sx * x[i], viewportCenter[1] + sy * y[i], (z[i] - zNear) * oneOverZNearMinusZFar);
+	}
+}
+
 QString StelProjectorPerspective::getNameI18() const
 {
 	return q_("Perspective");
@@ -53,6 +108,40 @@ bool StelProjectorPerspective::forward(Vec3f &v) const
 	return false;
 }
 
+struct PerspectiveKernel
+{
+	static void forward(int n, float* x, float* y, float* z, float widthStretch)
+	{
+		for (int i=0; i<n; ++i)
+		{
+			const float r = std::sqrt(x[i]*x[i] + y[i]*y[i] + z[i]*z[i]);
+			if (z[i] != 0.f)
+			{
+				const float f = 1.f/std::fabs(z[i]);
+				x[i] *= widthStretch*f;
+				y[i] *= f;
+				z[i] = z[i] < 0.f ? r : -MAX_FLOAT;
+			}
+			else
+			{
+				x[i] = MAX_FLOAT;
+				y[i] = MAX_FLOAT;
+				z[i] = -MAX_FLOAT;
+			}
+		}
+	}
+};
+
+void StelProjectorPerspective::project(int n, const Vec3d* in, Vec3f* out)
+{
+	projectBlocks<PerspectiveKernel>(n, in, out);
+}
+
+void StelProjectorPerspective::project(int n, const Vec3f* in, Vec3f* out)
+{
+	projectBlocks<PerspectiveKernel>(n, in, out);
+}
+
 bool StelProjectorPerspective::backward(Vec3d &v) const
 {
 	v[0] /= widthStretch;
@@ -102,6 +191,31 @@ bool StelProjectorEqualArea::forward(Vec3f &v) const
 	return true;
 }
 
+struct EqualAreaKernel
+{
+	static void forward(int n, float* x, float* y, float* z, float widthStretch)
+	{
+		for (int i=0; i<n; ++i)
+		{
+			const float r = std::sqrt(x[i]*x[i] + y[i]*y[i] + z[i]*z[i]);
+			const float f = std::sqrt(2.f/(r*(r-z[i])));
+			x[i] *= f*widthStretch;
+			y[i] *= f;
+			z[i] = r;
+		}
+	}
+};
+
+void StelProjectorEqualArea::project(int n, const Vec3d* in, Vec3f* out)
+{
+	projectBlocks<EqualAreaKernel>(n, in, out);
+}
+
+void StelProjectorEqualArea::project(int n, const Vec3f* in, Vec3f* out)
+{
+	projectBlocks<EqualAreaKernel>(n, in, out);
+}
+
 bool StelProjectorEqualArea::backward(Vec3d &v) const
 {
 	v[0] /= widthStretch;
@@ -167,6 +281,41 @@ bool StelProjectorStereographic::forward(Vec3f &v) const
 	return true;
 }
 
+struct StereographicKernel
+{
+	static void forward(int n, float* x, float* y, float* z, float widthStretch)
+	{
+		for (int i=0; i<n; ++i)
+		{
+			const float r = std::sqrt(x[i]*x[i] + y[i]*y[i] + z[i]*z[i]);
+			const float h = 0.5f*(r-z[i]);
+			if (h > 0.f)
+			{
+				const float f = 1.f / h;
+				x[i] *= f*widthStretch;
+				y[i] *= f;
+				z[i] = r;
+			}
+			else
+			{
+				x[i] = MAX_FLOAT;
+				y[i] = MAX_FLOAT;
+				z[i] = -std::numeric_limits<float>::min();
+			}
+		}
+	}
+};
+
+void StelProjectorStereographic::project(int n, const Vec3d* in, Vec3f* out)
+{
+	projectBlocks<StereographicKernel>(n, in, out);
+}
+
+void StelProjectorStereographic::project(int n, const Vec3f* in, Vec3f* out)
+{
+	projectBlocks<StereographicKernel>(n, in, out);
+}
+
 bool StelProjectorStereographic::backward(Vec3d &v) const
 {
 	v[0] /= widthStretch;
@@ -228,6 +377,47 @@ bool StelProjectorFisheye::forward(Vec3f &v) const
 	return false;
 }
 
+struct FisheyeKernel
+{
+	static void forward(int n, float* x, float* y, float* z, float widthStretch)
+	{
+		for (int i=0; i<n; ++i)
+		{
+			const float rq1 = x[i]*x[i] + y[i]*y[i];
+			if (rq1 > 0.f)
+			{
+				const float h = std::sqrt(rq1);
+				const float f = std::atan2(h,-z[i]) / h;
+				x[i] *= f*widthStretch;
+				y[i] *= f;
+				z[i] = std::sqrt(rq1 + z[i]*z[i]);
+			}
+			else if (z[i] < 0.f)
+			{
+				x[i] = 0.f;
+				y[i] = 0.f;
+				z[i] = 1.f;
+			}
+			else
+			{
+				x[i] = MAX_FLOAT;
+				y[i] = MAX_FLOAT;
+				z[i] = std::numeric_limits<float>::min();
+			}
+		}
+	}
+};
+
+void StelProjectorFisheye::project(int n, const Vec3d* in, Vec3f* out)
+{
+	projectBlocks<FisheyeKernel>(n, in, out);
+}
+
+void StelProjectorFisheye::project(int n, const Vec3f* in, Vec3f* out)
+{
+	projectBlocks<FisheyeKernel>(n, in, out);
+}
+
 bool StelProjectorFisheye::backward(Vec3d &v) const
 {
 	v[0] /= widthStretch;
@@ -279,6 +469,33 @@ bool StelProjectorHammer::forward(Vec3f &v) const
 	return true;
 }
 
+struct HammerKernel
+{
+	static void forward(int n, float* x, float* y, float* z, float widthStretch)
+	{
+		for (int i=0; i<n; ++i)
+		{
+			const float r = std::sqrt(x[i]*x[i] + y[i]*y[i] + z[i]*z[i]);
+			const float alpha = std::atan2(x[i],-z[i]);
+			const float cosDelta = std::sqrt(1.f-y[i]*y[i]/(r*r));
+			const float h = std::sqrt(1.+cosDelta*std::cos(alpha/2.f));
+			x[i] = 2.f*M_SQRT2*cosDelta*std::sin(alpha/2.f)/h * widthStretch;
+			y[i] = M_SQRT2*y[i]/r/h;
+			z[i] = r;
+		}
+	}
+};
+
+void StelProjectorHammer::project(int n, const Vec3d* in, Vec3f* out)
+{
+	projectBlocks<HammerKernel>(n, in, out);
+}
+
+void StelProjectorHammer::project(int n, const Vec3f* in, Vec3f* out)
+{
+	projectBlocks<HammerKernel>(n, in, out);
+}
+
 bool StelProjectorHammer::backward(Vec3d &v) const
 {
 	v[0] /= widthStretch;
@@ -333,6 +550,32 @@ bool StelProjectorCylinder::forward(Vec3f &v) const
 	return rval;
 }
 
+struct CylinderKernel
+{
+	static void forward(int n, float* x, float* y, float* z, float widthStretch)
+	{
+		for (int i=0; i<n; ++i)
+		{
+			const float r = std::sqrt(x[i]*x[i] + y[i]*y[i] + z[i]*z[i]);
+			const float alpha = std::atan2(x[i],-z[i]);
+			const float delta = std::asin(y[i]/r);
+			x[i] = alpha*widthStretch;
+			y[i] = delta;
+			z[i] = r;
+		}
+	}
+};
+
+void StelProjectorCylinder::project(int n, const Vec3d* in, Vec3f* out)
+{
+	projectBlocks<CylinderKernel>(n, in, out);
+}
+
+void StelProjectorCylinder::project(int n, const Vec3f* in, Vec3f* out)
+{
+	projectBlocks<CylinderKernel>(n, in, out);
+}
+
 bool StelProjectorCylinder::backward(Vec3d &v) const
 {
 	v[0] /= widthStretch;
@@ -381,6 +624,31 @@ bool StelProjectorMercator::forward(Vec3f &v) const
 	return rval;
 }
 
+struct MercatorKernel
+{
+	static void forward(int n, float* x, float* y, float* z, float widthStretch)
+	{
+		for (int i=0; i<n; ++i)
+		{
+			const float r = std::sqrt(x[i]*x[i] + y[i]*y[i] + z[i]*z[i]);
+			const float sin_delta = y[i]/r;
+			x[i] = std::atan2(x[i],-z[i]) *widthStretch;
+			y[i] = 0.5f*std::log((1.f+sin_delta)/(1.f-sin_delta));
+			z[i] = r;
+		}
+	}
+};
+
+void StelProjectorMercator::project(int n, const Vec3d* in, Vec3f* out)
+{
+	projectBlocks<MercatorKernel>(n, in, out);
+}
+
+void StelProjectorMercator::project(int n, const Vec3f* in, Vec3f* out)
+{
+	projectBlocks<MercatorKernel>(n, in, out);
+}
+
 
 bool StelProjectorMercator::backward(Vec3d &v) const
 {
@@ -434,6 +702,31 @@ bool StelProjectorOrthographic::forward(Vec3f &v) const
 	return rval;
 }
 
+struct OrthographicKernel
+{
+	static void forward(int n, float* x, float* y, float* z, float widthStretch)
+	{
+		for (int i=0; i<n; ++i)
+		{
+			const float r = std::sqrt(x[i]*x[i] + y[i]*y[i] + z[i]*z[i]);
+			const float h = 1.f/r;
+			x[i] *= h *widthStretch;
+			y[i] *= h;
+			z[i] = r;
+		}
+	}
+};
+
+void StelProjectorOrthographic::project(int n, const Vec3d* in, Vec3f* out)
+{
+	projectBlocks<OrthographicKernel>(n, in, out);
+}
+
+void StelProjectorOrthographic::project(int n, const Vec3f* in, Vec3f* out)
+{
+	projectBlocks<OrthographicKernel>(n, in, out);
+}
+
 bool StelProjectorOrthographic::backward(Vec3d &v) const
 {
 	v[0] /= widthStretch;
@@ -487,6 +780,32 @@ bool StelProjectorSinusoidal::forward(Vec3f &v) const
 	return rval;
 }
 
+struct SinusoidalKernel
+{
+	static void forward(int n, float* x, float* y, float* z, float widthStretch)
+	{
+		for (int i=0; i<n; ++i)
+		{
+			const float r = std::sqrt(x[i]*x[i] + y[i]*y[i] + z[i]*z[i]);
+			const float alpha = std::atan2(x[i],-z[i]);
+			const float delta = std::asin(y[i]/r);
+			x[i] = alpha*std::cos(delta) *widthStretch;
+			y[i] = delta;
+			z[i] = r;
+		}
+	}
+};
+
+void StelProjectorSinusoidal::project(int n, const Vec3d* in, Vec3f* out)
+{
+	projectBlocks<SinusoidalKernel>(n, in, out);
+}
+
+void StelProjectorSinusoidal::project(int n, const Vec3f* in, Vec3f* out)
+{
+	projectBlocks<SinusoidalKernel>(n, in, out);
+}
+
 bool StelProjectorSinusoidal::backward(Vec3d &v) const
 {
 	v[0] /= widthStretch;
@@ -529,6 +848,31 @@ bool StelProjectorMiller::forward(Vec3f &v) const
 	return rval;
 }
 
+struct MillerKernel
+{
+	static void forward(int n, float* x, float* y, float* z, float widthStretch)
+	{
+		for (int i=0; i<n; ++i)
+		{
+			const float r = std::sqrt(x[i]*x[i] + y[i]*y[i] + z[i]*z[i]);
+			const float delta = asin(y[i]/r);
+			x[i] = std::atan2(x[i],-z[i]) * widthStretch;
+			y[i] = 1.25f*asinh(tan(0.8f*delta));
+			z[i] = r;
+		}
+	}
+};
+
+void StelProjectorMiller::project(int n, const Vec3d* in, Vec3f* out)
+{
+	projectBlocks<MillerKernel>(n, in, out);
+}
+
+void StelProjectorMiller::project(int n, const Vec3f* in, Vec3f* out)
+{
+	projectBlocks<MillerKernel>(n, in, out);
+}
+
 bool StelProjectorMiller::backward(Vec3d &v) const
 {
 	v[0] /= widthStretch;
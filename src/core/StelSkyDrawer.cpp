@@ -431,14 +431,24 @@ bool StelSkyDrawer::drawPointSource(StelPainter* sPainter, const Vec3f& v, const
 	if (!(checkInScreen ? sPainter->getProjector()->projectCheck(v, win) : sPainter->getProjector()->project(v, win)))
 		return false;
 
+	return drawProjectedPointSource(sPainter, win, rcMag, color, twinkleFactor);
+}
+
+bool StelSkyDrawer::drawProjectedPointSource(StelPainter* sPainter, const Vec3f& win, const RCMag& rcMag, const Vec3f& color, float twinkleFactor)
+{
+	Q_ASSERT(sPainter);
+
+	if (rcMag.radius<=0.f)
+		return false;
+
 	const float radius = rcMag.radius;
 	// Random coef for star twinkling. twinkleFactor can introduce height-dependent twinkling.
 	const float tw = (flagStarTwinkle && (flagHasAtmosphere || flagForcedTwinkle)) ? (1.f-twinkleFactor*twinkleAmount*qrand()/RAND_MAX)*rcMag.luminance : rcMag.luminance;
 
 	// If the rmag is big, draw a big halo
-	if (radius>MAX_LINEAR_RADIUS+5.f)
+	if (radius>getBigHaloRadius())
 	{
-		float cmag = qMin(rcMag.luminance,(float)(radius-(MAX_LINEAR_RADIUS+5.f))/30.f);
+		float cmag = qMin(rcMag.luminance,(float)(radius-getBigHaloRadius())/30.f);
 		float rmag = 150.f;
 		if (cmag>1.f)
 			cmag = 1.f;
@@ -472,6 +482,11 @@ bool StelSkyDrawer::drawPointSource(StelPainter* sPainter, const Vec3f& v, const
 	return true;
 }
 
+float StelSkyDrawer::getBigHaloRadius()
+{
+	return MAX_LINEAR_RADIUS+5.f;
+}
+
 // Draw's the Sun's corona during a solar eclipse on Earth.
 void StelSkyDrawer::drawSunCorona(StelPainter* painter, const Vec3f& v, float radius, const Vec3f& color, const float alpha)
 {
@@ -105,6 +105,19 @@ public:
 
 	bool drawPointSource(StelPainter* sPainter, const Vec3f& v, const RCMag &rcMag, const Vec3f& bcolor, bool checkInScreen=false, float twinkleFactor=1.0f);
 
+	//! Same as drawPointSource(), for a source which was already projected and found on screen,
+	//! e.g. in a worker thread. Only the twinkling and the vertices are computed here.
+	//! @param win the position of the source on screen, as returned by StelProjector::project()
+	bool drawProjectedPointSource(StelPainter* sPainter, const Vec3f& win, const RCMag &rcMag, unsigned int bV, float twinkleFactor=1.0f)
+	{
+		return drawProjectedPointSource(sPainter, win, rcMag, colorTable[bV], twinkleFactor);
+	}
+
+	bool drawProjectedPointSource(StelPainter* sPainter, const Vec3f& win, const RCMag &rcMag, const Vec3f& bcolor, float twinkleFactor=1.0f);
+
+	//! Get the radius above which drawPointSource() adds a big halo around the point.
+	static float getBigHaloRadius();
+
 	void drawSunCorona(StelPainter* painter, const Vec3f& v, float radius, const Vec3f& color, const float alpha);
 
 	//! Terminate drawing of a 3D model, draw the halo
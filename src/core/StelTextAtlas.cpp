@@ -0,0 +1,257 @@
+/*
+ * Stellarium
+ * Copyright (C) 2017 Stellarium Developers
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Suite 500, Boston, MA  02110-1335, USA.
+ */
+
+#include "StelTextAtlas.hpp"
+
+#include <QGlyphRun>
+#include <QOpenGLContext>
+#include <QOpenGLFunctions>
+#include <QOpenGLTexture>
+#include <QPainter>
+#include <QRawFont>
+#include <QTextLayout>
+#include <QtMath>
+
+#include <cmath>
+
+// Empty pixels around each glyph, so that linear filtering of rotated labels does not pick up the neighbours
+static const int GLYPH_PADDING = 1;
+// Maximum number of glyphs in the cached layouts
+static const int LAYOUT_CACHE_LIMIT = 200000;
+
+StelTextAtlas::StelTextAtlas()
+	: layouts(LAYOUT_CACHE_LIMIT)
+	, renderedGlyphs(0)
+{
+}
+
+StelTextAtlas::~StelTextAtlas()
+{
+	clear();
+}
+
+void StelTextAtlas::clear()
+{
+	for (int i=0; i<pages.size(); ++i)
+		delete pages[i].texture;
+	pages.clear();
+	glyphs.clear();
+	fontKeys.clear();
+	layouts.clear();
+}
+
+const StelTextAtlas::Layout* StelTextAtlas::getLayout(const QString& str, const QFont& font)
+{
+	const QString key = font.key() + QLatin1Char('\n') + str;
+	const Layout* cached = layouts.object(key);
+	if (cached)
+		return cached;
+
+	QTextLayout textLayout(str, font);
+	QTextOption option;
+	option.setWrapMode(QTextOption::NoWrap);
+	textLayout.setTextOption(option);
+	textLayout.beginLayout();
+	QTextLine line = textLayout.createLine();
+	if (line.isValid())
+		line.setPosition(QPointF(0., 0.));
+	textLayout.endLayout();
+
+	Layout* layout = new Layout;
+	if (line.isValid())
+	{
+		const qreal ascent = line.ascent();
+		foreach (const QGlyphRun& run, textLayout.glyphRuns())
+		{
+			const QRawFont rawFont = run.rawFont();
+			const QString fontKey = QString("%1,%2,%3,%4,%5").arg(rawFont.familyName()).arg(rawFont.styleName())
+						.arg(rawFont.pixelSize()).arg(rawFont.weight()).arg(rawFont.style());
+			QHash<QString, int>::const_iterator f = fontKeys.constFind(fontKey);
+			if (f==fontKeys.constEnd())
+				f = fontKeys.insert(fontKey, fontKeys.size());
+			const int fontId = f.value();
+
+			const QVector<quint32> indexes = run.glyphIndexes();
+			const QVector<QPointF> positions = run.positions();
+			for (int i=0; i<indexes.size(); ++i)
+			{
+				const QPair<int, quint32> glyphKey(fontId, indexes.at(i));
+				QHash<QPair<int, quint32>, Glyph>::iterator g = glyphs.find(glyphKey);
+				if (g==glyphs.end())
+				{
+					Glyph glyph;
+					if (!addGlyph(rawFont, indexes.at(i), glyph))
+					{
+						delete layout;
+						return Q_NULLPTR;
+					}
+					g = glyphs.insert(glyphKey, glyph);
+				}
+				// Blank glyphs (spaces) only move the pen.
+				if (g.value().page<0)
+					continue;
+				PlacedGlyph placed;
+				// The nodes of a QHash are not moved when it grows: the pointer stays valid until clear().
+				placed.glyph = &g.value();
+				placed.pos = QPointF(positions.at(i).x(), positions.at(i).y()-ascent);
+				layout->glyphs.append(placed);
+			}
+		}
+	}
+
+	layouts.insert(key, layout, qMax(1, layout->glyphs.size()));
+	return layout;
+}
+
+bool StelTextAtlas::addGlyph(const QRawFont& rawFont, quint32 glyphIndex, Glyph& glyph)
+{
+	const QRectF bounds = rawFont.boundingRect(glyphIndex);
+	if (bounds.isEmpty())
+	{
+		glyph.page = -1;
+		return true;
+	}
+	const int x0 = qFloor(bounds.left()) - GLYPH_PADDING;
+	const int y0 = qFloor(bounds.top()) - GLYPH_PADDING;
+	const int w = qCeil(bounds.right()) + GLYPH_PADDING - x0;
+	const int h = qCeil(bounds.bottom()) + GLYPH_PADDING - y0;
+	if (w>PageSize || h>PageSize)
+	{
+		// Glyphs of huge fonts are not drawn.
+		glyph.page = -1;
+		return true;
+	}
+
+	QImage image(w, h, QImage::Format_ARGB32_Premultiplied);
+	image.fill(Qt::transparent);
+	{
+		QGlyphRun run;
+		run.setRawFont(rawFont);
+		run.setGlyphIndexes(QVector<quint32>() << glyphIndex);
+		run.setPositions(QVector<QPointF>() << QPointF(-x0, -y0));
+		QPainter painter(&image);
+		painter.setPen(Qt::white);
+		painter.drawGlyphRun(QPointF(0., 0.), run);
+	}
+
+	int pageIndex;
+	QPoint pos;
+	if (!allocate(w, h, pageIndex, pos))
+		return false;
+
+	// The pages are white, the coverage of the glyph goes into the alpha channel.
+	Page& page = pages[pageIndex];
+	for (int y=0; y<h; ++y)
+	{
+		const QRgb* src = reinterpret_cast<const QRgb*>(image.constScanLine(y));
+		uchar* dst = page.image.scanLine(pos.y()+y) + 4*pos.x();
+		for (int x=0; x<w; ++x)
+			dst[4*x+3] = static_cast<uchar>(qAlpha(src[x]));
+	}
+	page.dirtyTop = qMin(page.dirtyTop, pos.y());
+	page.dirtyBottom = qMax(page.dirtyBottom, pos.y()+h);
+
+	glyph.page = pageIndex;
+	glyph.pageRect = QRect(pos, QSize(w, h));
+	glyph.offset = QPoint(x0, y0);
+	++renderedGlyphs;
+	return true;
+}
+
+bool StelTextAtlas::allocate(int w, int h, int& pageIndex, QPoint& pos)
+{
+	for (pageIndex=0; pageIndex<=pages.size(); ++pageIndex)
+	{
+		if (pageIndex==pages.size())
+		{
+			if (pages.size()>=MaxPages)
+				return false;
+			Page page;
+			page.image = QImage(PageSize, PageSize, QImage::Format_RGBA8888);
+			page.image.fill(QColor(255, 255, 255, 0));
+			pages.append(page);
+		}
+		Page& page = pages[pageIndex];
+		// Start a new row when the glyph does not fit in the current one
+		if (page.shelfX+w>PageSize || h>page.shelfHeight)
+		{
+			if (page.shelfX>0 || page.shelfHeight>0)
+			{
+				if (page.shelfY+page.shelfHeight+h>PageSize)
+					continue;
+				page.shelfY += page.shelfHeight;
+				page.shelfX = 0;
+			}
+			page.shelfHeight = h;
+		}
+		pos = QPoint(page.shelfX, page.shelfY);
+		page.shelfX += w;
+		return true;
+	}
+	return false;
+}
+
+QOpenGLTexture* StelTextAtlas::getPageTexture(int pageIndex)
+{
+	Page& page = pages[pageIndex];
+	if (!page.texture)
+	{
+		page.texture = new QOpenGLTexture(page.image, QOpenGLTexture::DontGenerateMipMaps);
+	}
+	else if (page.dirtyTop<page.dirtyBottom)
+	{
+		// The rows are contiguous in the image, which has the layout of GL_RGBA/GL_UNSIGNED_BYTE.
+		QOpenGLFunctions* gl = QOpenGLContext::currentContext()->functions();
+		page.texture->bind();
+		gl->glPixelStorei(GL_UNPACK_ALIGNMENT, 4);
+		gl->glTexSubImage2D(GL_TEXTURE_2D, 0, 0, page.dirtyTop, PageSize, page.dirtyBottom-page.dirtyTop,
+				    GL_RGBA, GL_UNSIGNED_BYTE, page.image.constScanLine(page.dirtyTop));
+		page.texture->release();
+	}
+	page.dirtyTop = PageSize;
+	page.dirtyBottom = 0;
+	return page.texture;
+}
+
+void StelTextAtlas::getGlyphQuad(const PlacedGlyph& placed, float x, float y, float xshift, float yshift,
+				 bool rotated, float cosr, float sinr, Vec2f corners[4])
+{
+	const Glyph& glyph = *placed.glyph;
+	const float w = glyph.pageRect.width();
+	const float h = glyph.pageRect.height();
+	if (rotated)
+	{
+		// Top left corner of the glyph image in the text frame, y going up
+		const float left = xshift + placed.pos.x() + glyph.offset.x();
+		const float top = yshift - placed.pos.y() - glyph.offset.y();
+		const float xs[4] = {left, left+w, left, left+w};
+		const float ys[4] = {top, top, top-h, top-h};
+		for (int i=0; i<4; ++i)
+			corners[i].set(x + xs[i]*cosr - ys[i]*sinr, y + xs[i]*sinr + ys[i]*cosr);
+	}
+	else
+	{
+		const float left = std::floor(x + xshift + placed.pos.x() + 0.5f) + glyph.offset.x();
+		const float top = std::floor(y + yshift - placed.pos.y() + 0.5f) - glyph.offset.y();
+		corners[0].set(left, top);
+		corners[1].set(left+w, top);
+		corners[2].set(left, top-h);
+		corners[3].set(left+w, top-h);
+	}
+}
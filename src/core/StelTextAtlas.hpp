@@ -0,0 +1,139 @@
+/*
+ * Stellarium
+ * Copyright (C) 2017 Stellarium Developers
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Suite 500, Boston, MA  02110-1335, USA.
+ */
+
+#ifndef _STELTEXTATLAS_HPP_
+#define _STELTEXTATLAS_HPP_
+
+#include "VecMath.hpp"
+
+#include <QCache>
+#include <QFont>
+#include <QHash>
+#include <QImage>
+#include <QPair>
+#include <QRect>
+#include <QString>
+#include <QVector>
+
+class QOpenGLTexture;
+class QRawFont;
+
+//! @class StelTextAtlas
+//! Glyphs rendered once into shared textures (pages), used by StelPainter to draw the labels of a
+//! frame with a few draw calls instead of one texture and one draw call per string.
+//!
+//! Strings are shaped with QTextLayout, so that kerning, ligatures and right-to-left scripts are
+//! handled as by QPainter. The glyph positions of each string and font are cached. Each glyph is
+//! rasterized once with QPainter and packed into the pages in rows of similar heights. When all pages
+//! are full, the atlas must be cleared with clear(): the glyphs are then rendered again as needed.
+//! Only the rows of the pages changed since the last upload are uploaded to the textures.
+//! All methods must be called from the main thread.
+class StelTextAtlas
+{
+public:
+	//! Size of the pages in pixels.
+	static const int PageSize = 1024;
+	//! Maximum number of pages.
+	static const int MaxPages = 4;
+
+	//! A glyph rendered in a page.
+	struct Glyph
+	{
+		Glyph() : page(-1) {}
+		//! Index of the page
+		int page;
+		//! Position of the glyph in the page, in pixels
+		QRect pageRect;
+		//! Offset of the top left corner of the image from the pen position, in pixels (y going down)
+		QPoint offset;
+	};
+
+	//! A glyph placed in a string.
+	struct PlacedGlyph
+	{
+		const Glyph* glyph;
+		//! Pen position relative to the origin of the string on its base line (y going down)
+		QPointF pos;
+	};
+
+	//! The shaped glyphs of a string.
+	struct Layout
+	{
+		QVector<PlacedGlyph> glyphs;
+	};
+
+	StelTextAtlas();
+	~StelTextAtlas();
+
+	//! Get the glyphs of a string drawn with a font, rendering the glyphs not yet in the atlas.
+	//! @return Q_NULLPTR if the atlas is full: it has to be cleared first.
+	//! The returned layout is valid until the next call.
+	const Layout* getLayout(const QString& str, const QFont& font);
+
+	//! Get the texture of a page, uploading the rows of the glyphs added since the last call.
+	//! The GL context must be current.
+	QOpenGLTexture* getPageTexture(int page);
+	//! Get the image of a page. The glyph coverage is in the alpha channel.
+	const QImage& getPageImage(int page) const { return pages.at(page).image; }
+	int getPageCount() const { return pages.size(); }
+
+	//! Remove all glyphs and layouts.
+	//! The glyphs queued for drawing with the pages must be drawn before.
+	void clear();
+
+	//! Compute the corners of the image of a glyph of a string drawn at (x, y) in window coordinates
+	//! (y going up), placed as by QPainter: the base line starts at (x+xshift, y+yshift) in the frame
+	//! rotated by the angle of cosine cosr and sine sinr around (x, y). Unrotated glyphs are aligned
+	//! on pixels, so that they can be sampled without filtering.
+	//! @param corners receives the top left, top right, bottom left and bottom right corners
+	static void getGlyphQuad(const PlacedGlyph& placed, float x, float y, float xshift, float yshift,
+				 bool rotated, float cosr, float sinr, Vec2f corners[4]);
+
+	//! Number of glyphs rendered since the creation of the atlas.
+	int getRenderedGlyphCount() const { return renderedGlyphs; }
+
+private:
+	//! Render a glyph into the pages. Return false if there is no room left.
+	bool addGlyph(const QRawFont& rawFont, quint32 glyphIndex, Glyph& glyph);
+	//! Find room for a w x h image in the pages. Return false if there is no room left.
+	bool allocate(int w, int h, int& page, QPoint& pos);
+
+	struct Page
+	{
+		Page() : texture(Q_NULLPTR), dirtyTop(PageSize), dirtyBottom(0), shelfY(0), shelfHeight(0), shelfX(0) {}
+		QImage image;
+		QOpenGLTexture* texture;
+		// Rows changed since the last upload, none if dirtyTop>=dirtyBottom
+		int dirtyTop;
+		int dirtyBottom;
+		// Current row of glyphs
+		int shelfY;
+		int shelfHeight;
+		int shelfX;
+	};
+	QVector<Page> pages;
+
+	//! Glyphs by font (index in fontKeys) and glyph index in the font
+	QHash<QPair<int, quint32>, Glyph> glyphs;
+	QHash<QString, int> fontKeys;
+	QCache<QString, Layout> layouts;
+	int renderedGlyphs;
+};
+
+#endif // _STELTEXTATLAS_HPP_
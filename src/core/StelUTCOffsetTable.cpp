@@ -0,0 +1,103 @@
+/*
+ * Stellarium
+ * Copyright (C) 2017 Stellarium Developers
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Suite 500, Boston, MA  02110-1335, USA.
+ */
+
+#include "StelUTCOffsetTable.hpp"
+#include "StelUtils.hpp"
+
+#include <QDateTime>
+
+#include <algorithm>
+#include <cmath>
+
+StelUTCOffsetTable::StelUTCOffsetTable()
+	: useDST(true)
+	, endTime(0)
+{
+}
+
+void StelUTCOffsetTable::build(const QString& ianaName, bool useDST)
+{
+	timeZone = QTimeZone(ianaName.toUtf8());
+	this->useDST = useDST;
+	changes.clear();
+	offsets.clear();
+	endTime = 0;
+	// Without the transitions, all offsets are computed by QTimeZone.
+	if (!timeZone.isValid() || !timeZone.hasTransitions())
+		return;
+
+	const QDateTime begin(QDate(FirstYear, 1, 1), QTime(0, 0, 0), Qt::UTC);
+	const QDateTime end(QDate(LastYear+1, 1, 1), QTime(0, 0, 0), Qt::UTC);
+	const QTimeZone::OffsetData first = timeZone.offsetData(begin);
+	changes.append(begin.toMSecsSinceEpoch()/1000);
+	offsets.append(useDST ? first.offsetFromUtc : first.standardTimeOffset);
+	foreach (const QTimeZone::OffsetData& t, timeZone.transitions(begin.addSecs(1), end))
+	{
+		const int offset = useDST ? t.offsetFromUtc : t.standardTimeOffset;
+		// Transitions of the other offset, or of the abbreviation only
+		if (offset==offsets.last())
+			continue;
+		changes.append(t.atUtc.toMSecsSinceEpoch()/1000);
+		offsets.append(offset);
+	}
+	endTime = end.toMSecsSinceEpoch()/1000;
+}
+
+int StelUTCOffsetTable::getOffset(double JD) const
+{
+	const qint64 t = toUnixTime(JD);
+	if (changes.isEmpty() || t<changes.first() || t>=endTime)
+		return computeOffset(JD);
+	// Last change not after t
+	const int i = std::upper_bound(changes.constBegin(), changes.constEnd(), t) - changes.constBegin() - 1;
+	return offsets.at(i);
+}
+
+int StelUTCOffsetTable::computeOffset(double JD) const
+{
+	int year, month, day, hour, minute, second;
+	StelUtils::getDateFromJulianDay(JD, &year, &month, &day);
+	StelUtils::getTimeFromJulianDay(JD, &hour, &minute, &second);
+	// as analogous to second statement in getJDFromDate, nkerr
+	if ( year <= 0 )
+	{
+		year = year - 1;
+	}
+	//getTime/DateFromJulianDay returns UTC time, not local time
+	QDateTime universal(QDate(year, month, day), QTime(hour, minute, second), Qt::UTC);
+	if (!universal.isValid())
+	{
+		// Assumes the GMT shift was always the same before year -4710
+		universal = QDateTime(QDate(-4710, month, day), QTime(hour, minute, second), Qt::UTC);
+	}
+
+	if (useDST)
+		return timeZone.offsetFromUtc(universal);
+	else
+		return timeZone.standardTimeOffset(universal);
+}
+
+qint64 StelUTCOffsetTable::toUnixTime(double JD)
+{
+	// The time of the day is counted from noon, as in StelUtils::getTimeFromJulianDay().
+	// The table only covers dates of the Gregorian calendar, as QDate.
+	const double day = std::floor(JD);
+	const qint64 seconds = static_cast<qint64>(std::floor((JD-day)*86400. + 0.0001));
+	return (static_cast<qint64>(day) - 2440588)*86400 + 43200 + seconds;
+}
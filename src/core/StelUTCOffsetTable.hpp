@@ -0,0 +1,71 @@
+/*
+ * Stellarium
+ * Copyright (C) 2017 Stellarium Developers
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Suite 500, Boston, MA  02110-1335, USA.
+ */
+
+#ifndef _STELUTCOFFSETTABLE_HPP_
+#define _STELUTCOFFSETTABLE_HPP_
+
+#include <QString>
+#include <QTimeZone>
+#include <QVector>
+
+//! @class StelUTCOffsetTable
+//! Offsets from UTC of a time zone, precomputed from the transitions of the zone between FirstYear
+//! and LastYear. Inside these years, getOffset() is a binary search in the table; outside, the offset
+//! is computed by QTimeZone, as StelCore::getUTCOffset() did for every date.
+//! The table is built for one zone and one setting of daylight saving time: call build() again when
+//! one of them changes.
+class StelUTCOffsetTable
+{
+public:
+	StelUTCOffsetTable();
+
+	//! Build the table of a time zone.
+	//! @param ianaName IANA identifier of the time zone
+	//! @param useDST if false, the offsets of the standard time of the zone are used
+	void build(const QString& ianaName, bool useDST);
+	//! Return true if the time zone given to build() is known by QTimeZone.
+	bool isValid() const {return timeZone.isValid();}
+
+	//! Return the offset from UTC [s] of the time zone at a date.
+	//! @param JD Julian day (UT)
+	int getOffset(double JD) const;
+
+	//! First year covered by the table
+	static const int FirstYear = 1600;
+	//! Last year covered by the table
+	static const int LastYear = 2200;
+
+private:
+	//! Return the offset computed by QTimeZone.
+	int computeOffset(double JD) const;
+	//! Convert a Julian day to seconds since 1970-01-01T00:00:00 UTC, truncated to a whole second
+	//! as by StelUtils::getTimeFromJulianDay().
+	static qint64 toUnixTime(double JD);
+
+	QTimeZone timeZone;
+	bool useDST;
+	//! Times of the changes of offset [s since 1970-01-01T00:00:00 UTC]. The first one is the beginning of the table.
+	QVector<qint64> changes;
+	//! Offset from UTC [s] from each change to the next one
+	QVector<int> offsets;
+	//! End of the table [s since 1970-01-01T00:00:00 UTC]
+	qint64 endTime;
+};
+
+#endif // _STELUTCOFFSETTABLE_HPP_
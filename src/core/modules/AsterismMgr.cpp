@@ -475,6 +475,20 @@ void AsterismMgr::updateI18n()
 	{
 		(*iter)->nameI18 = trans.qtranslate((*iter)->englishName, (*iter)->context);
 	}
+	updateNameIndex();
+}
+
+void AsterismMgr::updateNameIndex()
+{
+	QVector<StelObjectNameIndex::Name> names;
+	names.reserve(2*asterisms.size());
+	vector < Asterism * >::const_iterator iter;
+	for (iter = asterisms.begin(); iter != asterisms.end(); ++iter)
+	{
+		names << StelObjectNameIndex::Name((*iter)->getEnglishName(), StelObjectNameIndex::EnglishName, 1);
+		names << StelObjectNameIndex::Name((*iter)->getNameI18n(), StelObjectNameIndex::TranslatedName, 1);
+	}
+	StelApp::getInstance().getStelObjectMgr().getNameIndex().setNames(this, names);
 }
 
 // update faders
@@ -572,34 +586,6 @@ StelObjectP AsterismMgr::searchByName(const QString& name) const
 	return Q_NULLPTR;
 }
 
-QStringList AsterismMgr::listMatchingObjects(const QString& objPrefix, int maxNbItem, bool useStartOfWords, bool inEnglish) const
-{
-	QStringList result;
-	if (maxNbItem <= 0)
-	{
-		return result;
-	}
-
-	vector<Asterism*>::const_iterator iter;
-	for (iter = asterisms.begin(); iter != asterisms.end(); ++iter)
-	{
-		QString name = inEnglish ? (*iter)->getEnglishName() : (*iter)->getNameI18n();
-		if (!matchObjectName(name, objPrefix, useStartOfWords))
-		{
-			continue;
-		}
-
-		result.append(name);
-		if (result.size() >= maxNbItem)
-		{
-			break;
-		}
-	}
-
-	result.sort();
-	return result;
-}
-
 QStringList AsterismMgr::listAllObjects(bool inEnglish) const
 {
 	QStringList result;
@@ -117,12 +117,6 @@ public:
 
 	virtual StelObjectP searchByID(const QString &id) const;
 
-	//! Find and return the list of at most maxNbItem objects auto-completing the passed object name.
-	//! @param objPrefix the case insensitive first letters of the searched object
-	//! @param maxNbItem the maximum number of returned object names
-	//! @param useStartOfWords the autofill mode for returned objects names
-	//! @return a vector of matching object name by order of relevance, or an empty vector if nothing matches
-	virtual QStringList listMatchingObjects(const QString& objPrefix, int maxNbItem=5, bool useStartOfWords=false, bool inEnglish=false) const;
 	virtual QStringList listAllObjects(bool inEnglish) const;
 	virtual QString getName() const { return "Asterisms"; }
 	virtual QString getStelObjectType() const;
@@ -215,6 +209,9 @@ private slots:
 	void updateI18n();
 
 private:
+	//! Register the names of the asterisms in the name index of the StelObjectMgr.
+	void updateNameIndex();
+
 	//! Read asterism names from the given file.
 	//! @param namesFile Name of the file containing the asterism names
 	//!        in a format consisting of abbreviation and translatable english name.
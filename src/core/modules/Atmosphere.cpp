@@ -26,6 +26,9 @@
 #include "StelPainter.hpp"
 #include "StelFileMgr.hpp"
 
+#include "StelModuleMgr.hpp"
+#include "SolarSystem.hpp"
+
 #include <QDebug>
 #include <QSettings>
 #include <QOpenGLShaderProgram>
@@ -48,6 +51,8 @@ Atmosphere::Atmosphere(void)
 	, overrideAverageLuminance(false)
 	, eclipseFactor(1.f)
 	, lightPollutionLuminance(0)
+	, gridValid(false)
+	, gridAverageLuminance(0.f)
 {
 	setFadeDuration(1.5f);
 
@@ -123,6 +128,7 @@ void Atmosphere::computeColor(double JD, Vec3d _sunPos, Vec3d moonPos, float moo
 		viewport = prj->getViewport();
 		delete[] colorGrid;
 		delete [] posGrid;
+		grid.clear();
 		skyResolutionY = StelApp::getInstance().getSettings()->value("landscape/atmosphereybin", 44).toInt();
 		skyResolutionX = (int)floor(0.5+skyResolutionY*(0.5*std::sqrt(3.0))*prj->getViewportWidth()/prj->getViewportHeight());
 		posGrid = new Vec2f[(1+skyResolutionX)*(1+skyResolutionY)];
@@ -244,72 +250,115 @@ void Atmosphere::computeColor(double JD, Vec3d _sunPos, Vec3d moonPos, float moo
 
 	sky.setParamsv(sunPos, 5.f);
 
-	skyb.setLocation(latitude * M_PI/180., altitude, temperature, relativeHumidity);
-	skyb.setSunMoon(moon_pos[2], sunPos[2]);
-
 	// Calculate the date from the julian day.
 	int year, month, day;
 	StelUtils::getDateFromJulianDay(JD, &year, &month, &day);
+
+	// Directions of the grid points, computed again only when the projection changed.
+	if (!updateGridDirections(prj))
+		gridValid = false;
+
+	GridInputs inputs;
+	inputs.sunPos.set(sunPos[0], sunPos[1], sunPos[2]);
+	inputs.moonPos.set(moon_pos[0], moon_pos[1], moon_pos[2]);
+	inputs.latitude = latitude;
+	inputs.altitude = altitude;
+	inputs.temperature = temperature;
+	inputs.relativeHumidity = relativeHumidity;
+	inputs.year = year;
+	inputs.month = month;
+	inputs.moonPhase = moonPhase;
+	inputs.moonMagnitude = moonMagnitude;
+	inputs.eclipseFactor = eclipseFactor;
+	inputs.lightPollutionLuminance = lightPollutionLuminance;
+	inputs.showPlanets = GETSTELMODULE(SolarSystem)->getFlagPlanets();
+	if (gridValid && inputs.isCloseTo(lastInputs))
+	{
+		// The luminance may have been overridden or set for the hidden atmosphere meanwhile
+		if (!overrideAverageLuminance)
+			averageLuminance = gridAverageLuminance;
+		return;
+	}
+	lastInputs = inputs;
+	gridValid = true;
+
+	skyb.setLocation(latitude * M_PI/180., altitude, temperature, relativeHumidity);
+	skyb.setSunMoon(moon_pos[2], sunPos[2]);
 	skyb.setDate(year, month, moonPhase, moonMagnitude);
 
-	// Variables used to compute the average sky luminance
-	float sum_lum = 0.f;
+	// Compute the sky color for every point above the ground
+	gridAverageLuminance = grid.computeLuminances(skyb, inputs.sunPos, inputs.moonPos, inputs.showPlanets,
+						      eclipseFactor, lightPollutionLuminance, colorGrid);
+	const int nbPoints = grid.size();
+
+	colorGridBuffer.bind();
+	colorGridBuffer.write(0, colorGrid, nbPoints*4*4);
+	colorGridBuffer.release();
+	
+	// Update average luminance
+	if (!overrideAverageLuminance)
+		averageLuminance = gridAverageLuminance;
+}
+
+static double squaredDistance(const Vec3f& a, const Vec3f& b)
+{
+	const double dx = static_cast<double>(a[0])-b[0];
+	const double dy = static_cast<double>(a[1])-b[1];
+	const double dz = static_cast<double>(a[2])-b[2];
+	return dx*dx+dy*dy+dz*dz;
+}
+
+bool Atmosphere::GridInputs::isCloseTo(const GridInputs& o) const
+{
+	// Changes below these limits are not visible in the sky brightness.
+	// The directions are compared with the squared length of their difference, computed in double:
+	// 1-cos(angle) of float vectors cannot resolve angles below about 0.03 degrees.
+	static const double maxDirectionChange = 2.4e-9; // squared angle in radians, about 10 arcsec
+	static const float maxRelativeChange = 1e-4f;
+	return squaredDistance(sunPos, o.sunPos) < maxDirectionChange
+		&& squaredDistance(moonPos, o.moonPos) < maxDirectionChange
+		&& latitude==o.latitude && altitude==o.altitude
+		&& temperature==o.temperature && relativeHumidity==o.relativeHumidity
+		&& year==o.year && month==o.month
+		&& fabs(moonPhase-o.moonPhase) < maxRelativeChange
+		&& fabs(moonMagnitude-o.moonMagnitude) < maxRelativeChange
+		&& fabs(eclipseFactor-o.eclipseFactor) <= maxRelativeChange*o.eclipseFactor
+		&& lightPollutionLuminance==o.lightPollutionLuminance
+		&& showPlanets==o.showPlanets;
+}
 
+bool Atmosphere::updateGridDirections(const StelProjectorP& prj)
+{
+	const int nbPoints = (1+skyResolutionX)*(1+skyResolutionY);
 	Vec3d point(1., 0., 0.);
-	float lumi;
+	if (grid.size()==nbPoints)
+	{
+		// Compare a few points to find out whether the projection changed.
+		bool same = true;
+		for (int y=0; y<=skyResolutionY && same; y+=qMax(1, skyResolutionY/2))
+		{
+			for (int x=0; x<=skyResolutionX && same; x+=qMax(1, skyResolutionX/2))
+			{
+				const int i = y*(1+skyResolutionX)+x;
+				prj->unProject(posGrid[i][0], posGrid[i][1], point);
+				same = grid.hasDirection(i, point);
+			}
+		}
+		if (same)
+			return true;
+	}
 
-	// Compute the sky color for every point above the ground
-	for (int i=0; i<(1+skyResolutionX)*(1+skyResolutionY); ++i)
+	grid.resize(nbPoints);
+	for (int i=0; i<nbPoints; ++i)
 	{
 		const Vec2f &v(posGrid[i]);
 		prj->unProject(v[0],v[1],point);
 
 		Q_ASSERT(fabs(point.lengthSquared()-1.0) < 1e-10);
 
-		// Use mirroring for sun only
-		if (point[2]<=0)
-		{
-			point[2] = -point[2];
-			// The sky below the ground is the symmetric of the one above :
-			// it looks nice and gives proper values for brightness estimation
-			// Use the Skybright.cpp 's models for brightness which gives better results.
-			lumi = skyb.getLuminance(moon_pos[0]*point[0]+moon_pos[1]*point[1]-
-					moon_pos[2]*point[2], sunPos[0]*point[0]+sunPos[1]*point[1]+
-					sunPos[2]*point[2], point[2]);
-		}
-		else
-		{
-			// Use the Skybright.cpp 's models for brightness which gives better results.
-			lumi = skyb.getLuminance(moon_pos[0]*point[0]+moon_pos[1]*point[1]+
-					moon_pos[2]*point[2], sunPos[0]*point[0]+sunPos[1]*point[1]+
-					sunPos[2]*point[2], point[2]);
-		}
-		lumi *= eclipseFactor;
-		// Add star background luminance
-		lumi += 0.0001f;
-		// Multiply by the input scale of the ToneConverter (is not done automatically by the xyYtoRGB method called later)
-		//lumi*=eye->getInputScale();
-
-		// Add the light pollution luminance AFTER the scaling to avoid scaling it because it is the cause
-		// of the scaling itself
-		lumi += lightPollutionLuminance;
-
-		// Store for later statistics
-		sum_lum+=lumi;
-
-		// Now need to compute the xy part of the color component
-		// This is done in the openGL shader
-		// Store the back projected position + luminance in the input color to the shader
-		colorGrid[i].set(point[0], point[1], point[2], lumi);
+		grid.setDirection(i, point);
 	}
-	
-	colorGridBuffer.bind();
-	colorGridBuffer.write(0, colorGrid, (1+skyResolutionX)*(1+skyResolutionY)*4*4);
-	colorGridBuffer.release();
-	
-	// Update average luminance
-	if (!overrideAverageLuminance)
-		averageLuminance = sum_lum/((1+skyResolutionX)*(1+skyResolutionY));
+	return false;
 }
 
 // override computable luminance. This is for special operations only, e.g. for scripting of brightness-balanced image export.
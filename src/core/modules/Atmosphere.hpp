@@ -25,7 +25,9 @@
 #include "VecMath.hpp"
 
 #include "Skybright.hpp"
+#include "AtmosphereGrid.hpp"
 #include "StelFader.hpp"
+#include "StelProjectorType.hpp"
 
 #include <QOpenGLBuffer>
 
@@ -80,6 +82,24 @@ public:
 	float getLightPollutionLuminance() const { return lightPollutionLuminance; }
 
 private:
+	//! Inputs of the sky brightness, kept to reuse the grid between frames.
+	struct GridInputs
+	{
+		Vec3f sunPos, moonPos;  //!< unit vectors
+		float latitude, altitude, temperature, relativeHumidity;
+		int year, month;
+		float moonPhase, moonMagnitude;
+		float eclipseFactor;
+		float lightPollutionLuminance;
+		bool showPlanets;
+		//! Whether the sky brightness computed with o can be used for these inputs.
+		bool isCloseTo(const GridInputs& o) const;
+	};
+
+	//! Compute the directions of the grid points if the projection changed.
+	//! @return true if they are unchanged.
+	bool updateGridDirections(const StelProjectorP& prj);
+
 	Vec4i viewport;
 	Skylight sky;
 	Skybright skyb;
@@ -90,6 +110,11 @@ private:
 	QOpenGLBuffer indicesBuffer;
 	Vec4f* colorGrid;
 	QOpenGLBuffer colorGridBuffer;
+	//! Directions of the grid points in the alt-azimuthal frame.
+	AtmosphereGrid grid;
+	GridInputs lastInputs;
+	bool gridValid;   //!< whether colorGrid was computed for lastInputs and the current directions
+	float gridAverageLuminance;   //!< average luminance of colorGrid
 
 	//! The average luminance of the atmosphere in cd/m2
 	float averageLuminance;
@@ -0,0 +1,144 @@
+/*
+ * Stellarium
+ * Copyright (C) 2017 Stellarium Developers
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Suite 500, Boston, MA  02110-1335, USA.
+ */
+
+#include "AtmosphereGrid.hpp"
+#include "Skybright.hpp"
+
+#include <QThread>
+#include <QtConcurrent>
+
+#include <algorithm>
+#include <cmath>
+
+//! Computes the luminances of the points of one job, for QtConcurrent.
+class AtmosphereGrid::Chunk
+{
+public:
+	Chunk(const AtmosphereGrid* grid, const Skybright* skyb, const Vec3f& sunPos, const Vec3f& moonPos, bool showPlanets,
+	      float eclipseFactor, float lightPollutionLuminance, Vec4f* colors, float* sums)
+		: grid(grid), skyb(skyb), sunPos(sunPos), moonPos(moonPos), showPlanets(showPlanets)
+		, eclipseFactor(eclipseFactor), lightPollutionLuminance(lightPollutionLuminance), colors(colors), sums(sums) {}
+	void operator()(const int& start) const;
+private:
+	const AtmosphereGrid* grid;
+	const Skybright* skyb;
+	Vec3f sunPos;
+	Vec3f moonPos;
+	bool showPlanets;
+	float eclipseFactor;
+	float lightPollutionLuminance;
+	Vec4f* colors;
+	float* sums;    //!< receives the sum of the luminances of each job
+};
+
+void AtmosphereGrid::Chunk::operator()(const int& start) const
+{
+	const int n = qMin(start+PointsPerJob, grid->size())-start;
+	const float* x = grid->x.constData()+start;
+	const float* y = grid->y.constData()+start;
+	const float* z = grid->z.constData()+start;
+	const float* mirror = grid->mirror.constData()+start;
+
+	float cosMoon[PointsPerJob];
+	float cosSun[PointsPerJob];
+	float lum[PointsPerJob];
+	for (int i=0; i<n; ++i)
+	{
+		// Use mirroring for sun only
+		cosMoon[i] = moonPos[0]*x[i]+moonPos[1]*y[i]+mirror[i]*moonPos[2]*z[i];
+		cosSun[i] = sunPos[0]*x[i]+sunPos[1]*y[i]+sunPos[2]*z[i];
+	}
+	// Use the Skybright.cpp 's models for brightness which gives better results.
+	// No Sun and Moon on the sky: https://bugs.launchpad.net/stellarium/+bug/1499699
+	if (showPlanets)
+		skyb->getLuminances(cosMoon, cosSun, z, lum, n);
+	else
+		std::fill(lum, lum+n, 0.f);
+
+	float sum = 0.f;
+	Vec4f* c = colors+start;
+	for (int i=0; i<n; ++i)
+	{
+		// Add star background luminance
+		// Add the light pollution luminance AFTER the scaling to avoid scaling it because it is the cause
+		// of the scaling itself
+		const float lumi = lum[i]*eclipseFactor + 0.0001f + lightPollutionLuminance;
+		// Store for later statistics
+		sum += lumi;
+		// Now need to compute the xy part of the color component
+		// This is done in the openGL shader
+		// Store the back projected position + luminance in the input color to the shader
+		c[i].set(x[i], y[i], z[i], lumi);
+	}
+	sums[start/PointsPerJob] = sum;
+}
+
+void AtmosphereGrid::resize(int n)
+{
+	x.resize(n);
+	y.resize(n);
+	z.resize(n);
+	mirror.resize(n);
+}
+
+void AtmosphereGrid::clear()
+{
+	resize(0);
+}
+
+void AtmosphereGrid::setDirection(int i, const Vec3d& dir)
+{
+	x[i] = dir[0];
+	y[i] = dir[1];
+	// The sky below the ground is the symmetric of the one above :
+	// it looks nice and gives proper values for brightness estimation
+	mirror[i] = dir[2]<=0 ? -1.f : 1.f;
+	z[i] = dir[2]<=0 ? -dir[2] : dir[2];
+}
+
+bool AtmosphereGrid::hasDirection(int i, const Vec3d& dir) const
+{
+	return std::fabs(dir[0]-x[i])<1e-6 && std::fabs(dir[1]-y[i])<1e-6 && std::fabs(dir[2]-mirror[i]*z[i])<1e-6;
+}
+
+float AtmosphereGrid::computeLuminances(const Skybright& skyb, const Vec3f& sunPos, const Vec3f& moonPos, bool showPlanets,
+					float eclipseFactor, float lightPollutionLuminance, Vec4f* colors) const
+{
+	const int n = size();
+	if (n==0)
+		return 0.f;
+	QVector<int> starts;
+	for (int i=0; i<n; i+=PointsPerJob)
+		starts.append(i);
+	QVector<float> sums(starts.size());
+	const Chunk chunk(this, &skyb, sunPos, moonPos, showPlanets, eclipseFactor, lightPollutionLuminance, colors, sums.data());
+	if (starts.size()>1 && QThread::idealThreadCount()>1)
+		QtConcurrent::blockingMap(starts, chunk);
+	else
+	{
+		foreach (int start, starts)
+			chunk(start);
+	}
+
+	// Variables used to compute the average sky luminance
+	float sum = 0.f;
+	foreach (float s, sums)
+		sum += s;
+	return sum/n;
+}
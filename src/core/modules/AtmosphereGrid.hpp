@@ -0,0 +1,65 @@
+/*
+ * Stellarium
+ * Copyright (C) 2017 Stellarium Developers
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Suite 500, Boston, MA  02110-1335, USA.
+ */
+
+#ifndef _ATMOSPHEREGRID_HPP_
+#define _ATMOSPHEREGRID_HPP_
+
+#include "VecMath.hpp"
+
+#include <QVector>
+
+class Skybright;
+
+//! @class AtmosphereGrid
+//! Luminances of the points of the grid drawn by Atmosphere, computed with Skybright.
+//! The directions of the points are kept as arrays between frames, so that each point only costs
+//! the evaluation of the sky brightness model. Large grids are split in chunks evaluated by the
+//! threads of the global thread pool. This class does not need StelApp, so that it can be tested.
+class AtmosphereGrid
+{
+public:
+	//! Number of points evaluated at once, and by one job of the thread pool.
+	static const int PointsPerJob = 4096;
+
+	int size() const {return x.size();}
+	void resize(int n);
+	void clear();
+
+	//! Set the direction of a point in the alt-azimuthal frame (a unit vector).
+	//! The sky below the horizon is the symmetric of the one above.
+	void setDirection(int i, const Vec3d& dir);
+	//! Whether the direction of a point differs from dir by less than about 1e-6.
+	bool hasDirection(int i, const Vec3d& dir) const;
+
+	//! Compute the luminances of all points.
+	//! @param sunPos, moonPos unit vectors of the directions of the Sun and Moon in the alt-azimuthal frame
+	//! @param showPlanets false to ignore the Sun and Moon, see Skybright::getLuminance()
+	//! @param colors receives size() values: the mirrored direction of each point and its luminance in cd/m2
+	//! @return the average luminance in cd/m2
+	float computeLuminances(const Skybright& skyb, const Vec3f& sunPos, const Vec3f& moonPos, bool showPlanets,
+				float eclipseFactor, float lightPollutionLuminance, Vec4f* colors) const;
+
+private:
+	class Chunk;
+
+	//! Directions of the points, mirrored above the horizon (mirror is -1 for the points below the horizon).
+	QVector<float> x, y, z, mirror;
+};
+
+#endif // _ATMOSPHEREGRID_HPP_
@@ -855,6 +855,20 @@ void ConstellationMgr::updateI18n()
 	{
 		(*iter)->nameI18 = trans.qtranslate((*iter)->englishName, (*iter)->context);
 	}
+	updateNameIndex();
+}
+
+void ConstellationMgr::updateNameIndex()
+{
+	QVector<StelObjectNameIndex::Name> names;
+	names.reserve(2*constellations.size());
+	vector < Constellation * >::const_iterator iter;
+	for (iter = constellations.begin(); iter != constellations.end(); ++iter)
+	{
+		names << StelObjectNameIndex::Name((*iter)->getEnglishName(), StelObjectNameIndex::EnglishName, 0);
+		names << StelObjectNameIndex::Name((*iter)->getNameI18n(), StelObjectNameIndex::TranslatedName, 0);
+	}
+	StelApp::getInstance().getStelObjectMgr().getNameIndex().setNames(this, names);
 }
 
 // update faders
@@ -1394,34 +1408,6 @@ StelObjectP ConstellationMgr::searchByID(const QString &id) const
 	return Q_NULLPTR;
 }
 
-QStringList ConstellationMgr::listMatchingObjects(const QString& objPrefix, int maxNbItem, bool useStartOfWords, bool inEnglish) const
-{
-	QStringList result;
-	if (maxNbItem <= 0)
-	{
-		return result;
-	}
-
-	vector<Constellation*>::const_iterator iter;
-	for (iter = constellations.begin(); iter != constellations.end(); ++iter)
-	{
-		QString name = inEnglish ? (*iter)->getEnglishName() : (*iter)->getNameI18n();
-		if (!matchObjectName(name, objPrefix, useStartOfWords))
-		{
-			continue;
-		}
-
-		result.append(name);
-		if (result.size() >= maxNbItem)
-		{
-			break;
-		}
-	}
-
-	result.sort();
-	return result;
-}
-
 QStringList ConstellationMgr::listAllObjects(bool inEnglish) const
 {
 	QStringList result;
@@ -137,14 +137,6 @@ public:
 
 	virtual StelObjectP searchByID(const QString &id) const;
 
-	// GZ: I see dubious descriptions and non-fitting var names: objPrefix should just be "string" or "obj",
-	// and useStartOfWord likely should be described as "decide if start of word is searched"  (2x)
-	//! Find and return the list of at most maxNbItem objects auto-completing the passed object name.
-	//! @param objPrefix the case insensitive first letters of the searched object
-	//! @param maxNbItem the maximum number of returned object names
-	//! @param useStartOfWords the autofill mode for returned objects names
-	//! @return a vector of matching object name by order of relevance, or an empty vector if nothing matches
-	virtual QStringList listMatchingObjects(const QString& objPrefix, int maxNbItem=5, bool useStartOfWords=false, bool inEnglish=false) const;
 	virtual QStringList listAllObjects(bool inEnglish) const;
 	virtual QString getName() const { return "Constellations"; }
 	virtual QString getStelObjectType() const;
@@ -306,6 +298,9 @@ private slots:
 	void deselectConstellations(void);
 
 private:
+	//! Register the names of the constellations in the name index of the StelObjectMgr.
+	void updateNameIndex();
+
 	//! Read constellation names from the given file.
 	//! @param namesFile Name of the file containing the constellation names
 	//!        in a format consisting of abbreviation, native name and translatable english name.
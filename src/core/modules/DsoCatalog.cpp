@@ -0,0 +1,249 @@
+/*
+ * Stellarium
+ * Copyright (C) 2017 Stellarium Developers
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Suite 500, Boston, MA  02110-1335, USA.
+ */
+
+#include "DsoCatalog.hpp"
+#include "StelGeodesicGrid.hpp"
+#include "StelUtils.hpp"
+
+#include <QDataStream>
+#include <QDateTime>
+#include <QDebug>
+#include <QDir>
+#include <QFileInfo>
+
+#include <cstring>
+
+const char DsoCatalog::Magic[4] = {'S', 'D', 'S', 'O'};
+
+// Highest zone level accepted by load(), to bound the size of the zone index.
+static const quint32 MAX_ZONE_LEVEL = 7;
+
+DsoCatalog::DsoCatalog()
+	: header(Q_NULLPTR)
+	, records(Q_NULLPTR)
+	, zoneIndex(Q_NULLPTR)
+	, zoneRecords(Q_NULLPTR)
+	, strings(Q_NULLPTR)
+	, stringsSize(0)
+{
+}
+
+DsoCatalog::~DsoCatalog()
+{
+	clear();
+}
+
+void DsoCatalog::clear()
+{
+	file.close();
+	header = Q_NULLPTR;
+	records = Q_NULLPTR;
+	zoneIndex = Q_NULLPTR;
+	zoneRecords = Q_NULLPTR;
+	strings = Q_NULLPTR;
+	stringsSize = 0;
+}
+
+bool DsoCatalog::load(const QString& catalogPath)
+{
+	clear();
+	if (!file.open(catalogPath, Magic, Version, sizeof(Header), "DSO catalogue"))
+		return false;
+
+	const uchar* data = file.getData();
+	const Header* h = reinterpret_cast<const Header*>(data);
+	const quint64 count = h->count;
+	const quint64 nrOfZones = h->zoneLevel<=MAX_ZONE_LEVEL ? StelGeodesicGrid::nrOfZones(h->zoneLevel) : 0;
+	if (nrOfZones==0
+	    || !file.containsSection(h->recordsOffset, count, sizeof(Record), 8)
+	    || !file.containsSection(h->zoneIndexOffset, nrOfZones+1, sizeof(quint32), 8)
+	    || !file.containsSection(h->zoneRecordsOffset, count, sizeof(quint32), 8)
+	    || !file.containsStrings(h->stringsOffset, h->stringsSize))
+	{
+		qWarning() << "Invalid DSO catalogue" << QDir::toNativeSeparators(catalogPath);
+		clear();
+		return false;
+	}
+	const quint32* zones = reinterpret_cast<const quint32*>(data+h->zoneIndexOffset);
+	const quint32* zoneRecs = reinterpret_cast<const quint32*>(data+h->zoneRecordsOffset);
+	bool validZones = zones[0]==0 && zones[nrOfZones]==count;
+	for (quint64 z=0; z<nrOfZones && validZones; ++z)
+		validZones = zones[z]<=zones[z+1];
+	for (quint64 i=0; i<count && validZones; ++i)
+		validZones = zoneRecs[i]<count;
+	if (!validZones)
+	{
+		qWarning() << "Invalid zone index in DSO catalogue" << QDir::toNativeSeparators(catalogPath);
+		clear();
+		return false;
+	}
+
+	header = h;
+	records = reinterpret_cast<const Record*>(data+h->recordsOffset);
+	zoneIndex = zones;
+	zoneRecords = zoneRecs;
+	strings = reinterpret_cast<const char*>(data+h->stringsOffset);
+	stringsSize = h->stringsSize;
+	return true;
+}
+
+int DsoCatalog::size() const
+{
+	return header ? static_cast<int>(header->count) : 0;
+}
+
+int DsoCatalog::getZoneLevel() const
+{
+	return header ? static_cast<int>(header->zoneLevel) : 0;
+}
+
+QString DsoCatalog::getString(quint32 offset) const
+{
+	return StelMappedCatalog::getString(strings, stringsSize, offset);
+}
+
+bool DsoCatalog::isImportOf(const QString& datPath, const QString& version) const
+{
+	if (!header)
+		return false;
+	const QFileInfo info(datPath);
+	return info.exists()
+		&& header->sourceSize==static_cast<quint64>(info.size())
+		&& header->sourceModified==info.lastModified().toMSecsSinceEpoch()
+		&& qstrncmp(header->sourceVersion, version.toLatin1().constData(), sizeof(header->sourceVersion))==0;
+}
+
+bool DsoCatalog::write(const QString& catalogPath, Header& h, const QVector<Record>& records, StringTable& strings)
+{
+	// Index the records by zone, keeping the order of the source catalogue in each zone.
+	// The records themselves keep the order of the source catalogue.
+	const StelGeodesicGrid grid(ZoneLevel);
+	const int nrOfZones = StelGeodesicGrid::nrOfZones(ZoneLevel);
+	QVector<quint32> zoneIndex(nrOfZones+1, 0);
+	QVector<int> zones(records.size());
+	for (int i=0; i<records.size(); ++i)
+	{
+		const Record& r = records.at(i);
+		zones[i] = grid.getZoneNumberForPoint(Vec3f(r.pos[0], r.pos[1], r.pos[2]), ZoneLevel);
+		++zoneIndex[zones[i]+1];
+	}
+	for (int z=0; z<nrOfZones; ++z)
+		zoneIndex[z+1] += zoneIndex[z];
+	QVector<quint32> zoneRecords(records.size());
+	QVector<quint32> next(zoneIndex);
+	for (int i=0; i<records.size(); ++i)
+		zoneRecords[next[zones.at(i)]++] = i;
+
+	StelMappedCatalog::initSignature(h.signature, Magic, Version);
+	h.count = records.size();
+	h.zoneLevel = ZoneLevel;
+	h.recordsOffset = StelMappedCatalog::align8(sizeof(Header));
+	h.zoneIndexOffset = StelMappedCatalog::align8(h.recordsOffset + h.count*sizeof(Record));
+	h.zoneRecordsOffset = StelMappedCatalog::align8(h.zoneIndexOffset + zoneIndex.size()*sizeof(quint32));
+	h.stringsOffset = h.zoneRecordsOffset + zoneRecords.size()*sizeof(quint32);
+	h.stringsSize = strings.data.size();
+
+	StelMappedCatalog::Writer out(catalogPath, "DSO catalogue");
+	if (!out.open())
+		return false;
+	out.write(0, &h, sizeof(Header));
+	out.write(h.recordsOffset, records.constData(), h.count*sizeof(Record));
+	out.write(h.zoneIndexOffset, zoneIndex.constData(), zoneIndex.size()*sizeof(quint32));
+	out.write(h.zoneRecordsOffset, zoneRecords.constData(), zoneRecords.size()*sizeof(quint32));
+	out.write(h.stringsOffset, strings.data);
+	return out.commit(h.stringsOffset+h.stringsSize);
+}
+
+void DsoCatalog::readRecord(QDataStream& in, Record& r, StringTable& strings)
+{
+	QString mTypeString, Ced, PK, PNG, SNRG, ACO;
+	in	>> r.DSO_nb >> r.ra >> r.dec >> r.bMag >> r.vMag >> r.type >> mTypeString >> r.majorAxisSize >> r.minorAxisSize
+		>> r.orientationAngle >> r.redshift >> r.redshiftErr >> r.parallax >> r.parallaxErr >> r.oDistance >> r.oDistanceErr
+		>> r.NGC_nb >> r.IC_nb >> r.M_nb >> r.C_nb >> r.B_nb >> r.Sh2_nb >> r.VdB_nb >> r.RCW_nb >> r.LDN_nb >> r.LBN_nb >> r.Cr_nb
+		>> r.Mel_nb >> r.PGC_nb >> r.UGC_nb >> Ced >> r.Arp_nb >> r.VV_nb >> PK >> PNG >> SNRG >> ACO;
+
+	// Same computation as in Nebula::readDSO()
+	Vec3d pos;
+	StelUtils::spheToRect(r.ra, r.dec, pos);
+	r.pos[0] = pos[0];
+	r.pos[1] = pos[1];
+	r.pos[2] = pos[2];
+	r.mTypeString = strings.add(mTypeString);
+	r.Ced_nb = strings.add(Ced);
+	r.PK_nb = strings.add(PK);
+	r.PNG_nb = strings.add(PNG);
+	r.SNRG_nb = strings.add(SNRG);
+	r.ACO_nb = strings.add(ACO);
+}
+
+bool DsoCatalog::importDat(const QString& datPath, const QString& catalogPath, const QString& version)
+{
+	QFile in(datPath);
+	if (!in.open(QIODevice::ReadOnly))
+	{
+		qWarning() << "Cannot open DSO catalogue" << QDir::toNativeSeparators(datPath);
+		return false;
+	}
+
+	// The source is identified by its state before it is read.
+	Header h;
+	memset(&h, 0, sizeof(Header));
+	const QFileInfo info(datPath);
+	h.sourceSize = info.size();
+	h.sourceModified = info.lastModified().toMSecsSinceEpoch();
+	qstrncpy(h.sourceVersion, version.toLatin1().constData(), sizeof(h.sourceVersion));
+
+	// Let's begin use gzipped data
+	QDataStream ins(StelUtils::uncompress(in.readAll()));
+	in.close();
+	ins.setVersion(QDataStream::Qt_5_2);
+
+	QString datVersion, edition;
+	ins >> datVersion >> edition;
+	if (datVersion.isEmpty())
+		datVersion = "3.1"; // The first version of extended edition of the catalog
+	if (edition.isEmpty())
+		edition = "unknown";
+	qDebug() << "[...]" << QString("Stellarium DSO Catalog, version %1 (%2 edition)").arg(datVersion).arg(edition);
+	if (StelUtils::compareVersions(datVersion, version)!=0)
+	{
+		qDebug() << "WARNING: Mismatch the version of catalog! The expected version of catalog is" << version;
+		return false;
+	}
+
+	StringTable strings;
+	QVector<Record> records;
+	while (!ins.atEnd())
+	{
+		Record r;
+		memset(&r, 0, sizeof(Record));
+		readRecord(ins, r, strings);
+		if (ins.status()!=QDataStream::Ok)
+		{
+			qWarning() << "Truncated DSO catalogue" << QDir::toNativeSeparators(datPath);
+			return false;
+		}
+		records.append(r);
+	}
+
+	if (!write(catalogPath, h, records, strings))
+		return false;
+	qDebug() << "Imported" << records.size() << "DSO records";
+	return true;
+}
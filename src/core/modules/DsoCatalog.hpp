@@ -0,0 +1,168 @@
+/*
+ * Stellarium
+ * Copyright (C) 2017 Stellarium Developers
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Suite 500, Boston, MA  02110-1335, USA.
+ */
+
+#ifndef _DSOCATALOG_HPP_
+#define _DSOCATALOG_HPP_
+
+#include "StelMappedCatalog.hpp"
+
+#include <QString>
+#include <QVector>
+
+class QDataStream;
+
+//! @class DsoCatalog
+//! Read-only, memory-mapped binary catalogue of deep-sky objects. The gzipped catalog.dat file
+//! (written by NebulaMgr::convertDSOCatalog()) is imported once into this format, which is then
+//! mapped into memory at startup instead of being uncompressed and deserialized into Nebula objects.
+//! NebulaMgr only creates the Nebula object of a record when it is needed.
+//!
+//! The file contains, after a header:
+//! - one fixed-size record per object, in the order of catalog.dat (when several records have
+//!   the same designation, the first one is the object of this designation),
+//! - the indices of the records sorted by zone of the geodesic grid at getZoneLevel(), and the
+//!   position of the first of them for each zone, to find the objects of a region of the sky
+//!   without testing all records,
+//! - a table of UTF-8 strings.
+//!
+//! The header keeps the size, the modification time and the expected format version of the
+//! catalog.dat file it was imported from, see isImportOf().
+//!
+//! The file is read and written with StelMappedCatalog, as MinorBodyCatalog.
+class DsoCatalog
+{
+public:
+	//! Data of one deep-sky object, as in Nebula (160 bytes).
+	struct Record
+	{
+		float ra;                   //!< [rad], J2000.0
+		float dec;                  //!< [rad], J2000.0
+		float pos[3];               //!< Cartesian equatorial position (J2000.0) of the object
+		float bMag;
+		float vMag;                 //!< For dark nebulae, the opacity
+		float majorAxisSize;        //!< [deg]
+		float minorAxisSize;        //!< [deg]
+		qint32 orientationAngle;    //!< [deg]
+		float oDistance;            //!< Mpc for galaxies, kpc for other objects
+		float oDistanceErr;
+		float redshift;
+		float redshiftErr;
+		float parallax;
+		float parallaxErr;
+		quint32 type;               //!< a Nebula::NebulaType
+		quint32 DSO_nb;
+		quint32 M_nb;
+		quint32 NGC_nb;
+		quint32 IC_nb;
+		quint32 C_nb;
+		quint32 B_nb;
+		quint32 Sh2_nb;
+		quint32 VdB_nb;
+		quint32 RCW_nb;
+		quint32 LDN_nb;
+		quint32 LBN_nb;
+		quint32 Cr_nb;
+		quint32 Mel_nb;
+		quint32 PGC_nb;
+		quint32 UGC_nb;
+		quint32 Arp_nb;
+		quint32 VV_nb;
+		quint32 mTypeString;        //!< offsets in the string table
+		quint32 Ced_nb;
+		quint32 PK_nb;
+		quint32 PNG_nb;
+		quint32 SNRG_nb;
+		quint32 ACO_nb;
+	};
+
+	DsoCatalog();
+	~DsoCatalog();
+
+	//! Map a catalogue file into memory.
+	//! @return false if the file cannot be read or is not a valid catalogue for this machine.
+	bool load(const QString& catalogPath);
+	//! Unmap the catalogue.
+	void clear();
+
+	bool isLoaded() const {return header!=Q_NULLPTR;}
+	int size() const;
+
+	const Record& getRecord(int index) const {return records[index];}
+	QString getString(quint32 offset) const;
+	//! Return the magnitude used to filter the objects to draw: V, or B if V is unknown.
+	static float getMagnitude(const Record& r) {return r.vMag>90.f ? r.bMag : r.vMag;}
+
+	//! Level of the geodesic grid used to sort the records.
+	int getZoneLevel() const;
+	//! The records of a zone are getZoneRecord(i) for getZoneBegin(zone) <= i < getZoneEnd(zone).
+	int getZoneBegin(int zone) const {return static_cast<int>(zoneIndex[zone]);}
+	int getZoneEnd(int zone) const {return static_cast<int>(zoneIndex[zone+1]);}
+	//! Index of a record in the records sorted by zone.
+	int getZoneRecord(int i) const {return static_cast<int>(zoneRecords[i]);}
+
+	//! Return whether the loaded catalogue was imported from datPath in its current state (same size
+	//! and modification time) with the same expected version of the catalog.dat format.
+	bool isImportOf(const QString& datPath, const QString& version) const;
+
+	//! Convert a Stellarium DSO catalogue (catalog.dat) to a catalogue.
+	//! @param version the expected version of the catalog.dat format; other versions are rejected.
+	//! @return false if the file cannot be read or has another version.
+	static bool importDat(const QString& datPath, const QString& catalogPath, const QString& version);
+
+	//! Magic number at the beginning of a catalogue file.
+	static const char Magic[4];
+	//! Version of the file format.
+	static const quint32 Version = 2;
+	//! Level of the geodesic grid used by importDat(). About 18 objects per zone with the default catalogue.
+	static const int ZoneLevel = 4;
+
+private:
+	//! File header (96 bytes).
+	struct Header
+	{
+		StelMappedCatalog::Signature signature;
+		quint32 count;
+		quint32 zoneLevel;
+		quint32 reserved0;
+		quint64 recordsOffset;
+		quint64 zoneIndexOffset;
+		quint64 zoneRecordsOffset;
+		quint64 stringsOffset;
+		quint64 stringsSize;
+		quint64 sourceSize;         //!< [bytes] of the imported catalog.dat
+		qint64 sourceModified;      //!< [ms] since 1970-01-01 UTC, of the imported catalog.dat
+		char sourceVersion[16];     //!< expected catalog.dat version, 0-terminated
+	};
+
+	typedef StelMappedCatalog::StringTable StringTable;
+	//! Read a record of catalog.dat, in the format written by NebulaMgr::convertDSOCatalog().
+	static void readRecord(QDataStream& in, Record& r, StringTable& strings);
+	//! Index the records by zone and write the file, replacing it only if it is complete.
+	static bool write(const QString& catalogPath, Header& h, const QVector<Record>& records, StringTable& strings);
+
+	StelMappedCatalog file;
+	const Header* header;
+	const Record* records;
+	const quint32* zoneIndex;
+	const quint32* zoneRecords;
+	const char* strings;
+	quint64 stringsSize;
+};
+
+#endif // _DSOCATALOG_HPP_
@@ -0,0 +1,254 @@
+/*
+ * Stellarium
+ * Copyright (C) 2017 Stellarium Developers
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Suite 500, Boston, MA  02110-1335, USA.
+ */
+
+#include "EphemerisEngine.hpp"
+#include "EphemWrapper.hpp"
+#include "SolarSystem.hpp"
+#include "Orbit.hpp"
+#include "StelApp.hpp"
+#include "StelCore.hpp"
+#include "StelModuleMgr.hpp"
+#include "StelObserver.hpp"
+#include "StelUtils.hpp"
+
+#include <QMutex>
+#include <QThread>
+#include <QtConcurrent>
+
+// Defined in SolarSystem.cpp
+void ellipticalOrbitPosFunc(double jd, double xyz[3], void* userDataPtr);
+void cometOrbitPosFunc(double jd, double xyz[3], void* userDataPtr);
+
+// The theories of the moons of Mars, Jupiter, Saturn and Uranus keep their last results
+// in static variables, so only one thread at a time may call them.
+static QMutex theoryMutex;
+
+// The planets and the Moon use an EphemContext per thread, see EphemWrapper.hpp.
+static bool isReentrant(posFuncType func)
+{
+	return func==&get_sun_helio_coordsv
+		|| func==&get_mercury_helio_coordsv
+		|| func==&get_venus_helio_coordsv
+		|| func==&get_earth_helio_coordsv
+		|| func==&get_mars_helio_coordsv
+		|| func==&get_jupiter_helio_coordsv
+		|| func==&get_saturn_helio_coordsv
+		|| func==&get_uranus_helio_coordsv
+		|| func==&get_neptune_helio_coordsv
+		|| func==&get_pluto_helio_coordsv
+		|| func==&get_lunar_parent_coordsv;
+}
+
+// Time step for the velocity computation by central differences [d]
+static const double VELOCITY_STEP = 0.01;
+
+// Number of dates computed by one job of computeStatesParallel()
+static const int DATES_PER_JOB = 64;
+
+EphemerisEngine::EphemerisEngine(const QList<PlanetP>& bodies, const PlanetP& observer)
+	: bodies(bodies)
+	, observer(observer)
+	, flagLightTravelTime(false)
+	, flagFullState(true)
+	, flagTopocentric(false)
+	, topoLatitude(0.)
+	, topoLongitude(0.)
+	, topoRho(0.)
+	, topoSigma(0.)
+{
+	SolarSystem* ssystem = GETSTELMODULE(SolarSystem);
+	earth = ssystem->getEarth();
+	flagLightTravelTime = ssystem->getFlagLightTravelTime();
+
+	const StelCore* core = StelApp::getInstance().getCore();
+	if (core->getUseTopocentricCoordinates() && core->getCurrentPlanet()==observer && observer->parent)
+	{
+		const StelObserver* position = core->getCurrentObserver();
+		flagTopocentric = true;
+		topoLatitude = qBound(-90., (double)position->getCurrentLocation().latitude, 90.);
+		topoLongitude = position->getCurrentLocation().longitude;
+		topoRho = position->getDistanceFromCenter();
+		topoSigma = position->getCurrentLocation().latitude*M_PI/180.0 - position->getTopographicOffsetFromCenter().v[2];
+	}
+}
+
+void EphemerisEngine::computeRelativePos(const Planet* body, double jde, double* xyz)
+{
+	if (body->coordFunc==&cometOrbitPosFunc)
+	{
+		// Don't let the comet update its velocity vector and tails for this date.
+		static_cast<CometOrbit*>(body->orbitPtr)->positionAtTimevInVSOP87Coordinates(jde, xyz, false);
+	}
+	else if (body->coordFunc==&ellipticalOrbitPosFunc || isReentrant(body->coordFunc))
+	{
+		body->coordFunc(jde, xyz, body->orbitPtr);
+	}
+	else
+	{
+		QMutexLocker lock(&theoryMutex);
+		body->coordFunc(jde, xyz, body->orbitPtr);
+	}
+}
+
+Vec3d EphemerisEngine::computeHeliocentricEclipticPos(const Planet* body, double jde)
+{
+	Vec3d pos(0.);
+	for (const Planet* p=body; p; p=p->parent.data())
+	{
+		double xyz[3];
+		computeRelativePos(p, jde, xyz);
+		pos += Vec3d(xyz[0], xyz[1], xyz[2]);
+	}
+	return pos;
+}
+
+Mat4d EphemerisEngine::computeRotEquatorialToVsop87(const Planet* body, double jde)
+{
+	Q_ASSERT(body->parent);
+	Mat4d rot = body->computeRotLocalToParent(jde);
+	for (const Planet* p=body->parent.data(); p->parent; p=p->parent.data())
+		rot = p->computeRotLocalToParent(jde) * rot;
+	return rot;
+}
+
+double EphemerisEngine::lightTimeDate(const Planet* body, double jde, const Vec3d& observerPos) const
+{
+	if (!flagLightTravelTime || body==observer.data())
+		return jde;
+	// Same single iteration as in SolarSystem::computePositions()
+	const Vec3d pos = computeHeliocentricEclipticPos(body, jde);
+	return jde - (pos-observerPos).length() * (AU / (SPEED_OF_LIGHT * 86400.));
+}
+
+EphemerisEngine::BodyState EphemerisEngine::computeState(int bodyIndex, double jde) const
+{
+	Q_ASSERT(bodyIndex>=0 && bodyIndex<bodies.size());
+	const Planet* body = bodies.at(bodyIndex).data();
+	const Vec3d observerPos = computeHeliocentricEclipticPos(observer.data(), jde);
+	const double date = lightTimeDate(body, jde, observerPos);
+
+	BodyState state;
+	state.heliocentricPos = computeHeliocentricEclipticPos(body, date);
+	if (!flagFullState)
+		return state;
+
+	state.heliocentricVel = (computeHeliocentricEclipticPos(body, date+VELOCITY_STEP)
+				 - computeHeliocentricEclipticPos(body, date-VELOCITY_STEP)) / (2.*VELOCITY_STEP);
+
+	Planet::MagnitudeGeometry g;
+	g.observerHelioPos = observerPos;
+	g.planetHelioPos = state.heliocentricPos;
+	g.parentHelioPos = body->parent ? computeHeliocentricEclipticPos(body->parent.data(), date) : Vec3d(0.);
+	g.earthHelioPos = (observer==earth) ? observerPos : computeHeliocentricEclipticPos(earth.data(), jde);
+	g.jde = jde;
+	g.observerOnEarth = (observer==earth);
+	// Eclipses of the Sun are not computed here.
+	g.sunShadowFactor = 1.;
+	state.vMagnitude = body->computeVMagnitude(g);
+	return state;
+}
+
+Vec3d EphemerisEngine::computeTopocentricObserverPos(double jd, double jde, const Vec3d& centerPos) const
+{
+	if (!flagTopocentric)
+		return centerPos;
+	const Mat4d rotAltAzToVsop87 = computeRotEquatorialToVsop87(observer.data(), jde)
+			* Mat4d::zrotation((observer->getSiderealTime(jd, jde)+topoLongitude)*M_PI/180.)
+			* Mat4d::yrotation((90.-topoLatitude)*M_PI/180.);
+	return centerPos + rotAltAzToVsop87.multiplyWithoutTranslation(Vec3d(topoRho*sin(topoSigma), 0., topoRho*cos(topoSigma)));
+}
+
+Vec3d EphemerisEngine::computeJ2000EquatorialPos(int bodyIndex, double jd, double jde) const
+{
+	Q_ASSERT(bodyIndex>=0 && bodyIndex<bodies.size());
+	const Planet* body = bodies.at(bodyIndex).data();
+	// The light time is computed from the center of the observer body, as in SolarSystem::computePositions().
+	Vec3d centerPos = computeHeliocentricEclipticPos(observer.data(), jde);
+	Vec3d pos;
+	if (!body->parent)
+	{
+		// The Sun is drawn at its light time corrected position, see SolarSystem::getLightTimeSunPosition().
+		if (flagLightTravelTime)
+			pos = centerPos - computeHeliocentricEclipticPos(observer.data(), jde - centerPos.length() * (AU / (SPEED_OF_LIGHT * 86400.)));
+		else
+			pos.set(0., 0., 0.);
+	}
+	else
+	{
+		const double date = lightTimeDate(body, jde, centerPos);
+		pos = computeHeliocentricEclipticPos(body, date);
+		// Planet::computePosition() moves the parents of a moon to the date of the moon,
+		// so a moon of the observer body is seen at its position relative to the body at this date.
+		for (const Planet* p=body->parent.data(); p; p=p->parent.data())
+		{
+			if (p==observer.data())
+			{
+				centerPos = computeHeliocentricEclipticPos(observer.data(), date);
+				break;
+			}
+		}
+	}
+	return StelCore::matVsop87ToJ2000.multiplyWithoutTranslation(pos - computeTopocentricObserverPos(jd, jde, centerPos));
+}
+
+void EphemerisEngine::computeRange(const QVector<double>& jdes, int start, int end, BodyState* result) const
+{
+	const int n = bodies.size();
+	for (int i=start; i<end; ++i)
+	{
+		for (int b=0; b<n; ++b)
+			result[i*n+b] = computeState(b, jdes.at(i));
+	}
+}
+
+QVector<EphemerisEngine::BodyState> EphemerisEngine::computeStates(const QVector<double>& jdes) const
+{
+	QVector<BodyState> result(jdes.size()*bodies.size());
+	computeRange(jdes, 0, jdes.size(), result.data());
+	return result;
+}
+
+//! Functor for QtConcurrent: computes the states of all bodies for a range of dates.
+class ComputeEphemerisChunk
+{
+public:
+	ComputeEphemerisChunk(const EphemerisEngine* engine, const QVector<double>* jdes, EphemerisEngine::BodyState* result)
+		: engine(engine), jdes(jdes), result(result) {}
+	void operator()(const int& start)
+	{
+		engine->computeRange(*jdes, start, qMin(start+DATES_PER_JOB, jdes->size()), result);
+	}
+private:
+	const EphemerisEngine* engine;
+	const QVector<double>* jdes;
+	EphemerisEngine::BodyState* result;
+};
+
+QVector<EphemerisEngine::BodyState> EphemerisEngine::computeStatesParallel(const QVector<double>& jdes) const
+{
+	if (QThread::idealThreadCount()<2 || jdes.size()<=DATES_PER_JOB)
+		return computeStates(jdes);
+
+	QVector<BodyState> result(jdes.size()*bodies.size());
+	QVector<int> starts;
+	for (int i=0; i<jdes.size(); i+=DATES_PER_JOB)
+		starts.append(i);
+	QtConcurrent::blockingMap(starts, ComputeEphemerisChunk(this, &jdes, result.data()));
+	return result;
+}
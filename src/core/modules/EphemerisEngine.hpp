@@ -0,0 +1,114 @@
+/*
+ * Stellarium
+ * Copyright (C) 2017 Stellarium Developers
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Suite 500, Boston, MA  02110-1335, USA.
+ */
+
+#ifndef _EPHEMERISENGINE_HPP_
+#define _EPHEMERISENGINE_HPP_
+
+#include "Planet.hpp"
+#include "VecMath.hpp"
+
+#include <QList>
+#include <QVector>
+
+//! @class EphemerisEngine
+//! Computes positions, velocities and magnitudes of solar system bodies for arbitrary dates
+//! without changing the state of the Planet objects, of the SolarSystem or of the StelCore.
+//! This is meant for searches over many dates (phenomena, observability, ephemeris tables)
+//! which would otherwise have to call StelCore::update() for each date and disturb the view.
+//! All methods are const and may be called from several threads at the same time.
+//! The bodies must stay loaded while an engine refers to them.
+class EphemerisEngine
+{
+public:
+	//! State of one body at one date.
+	struct BodyState
+	{
+		BodyState() : vMagnitude(0.f) {}
+		Vec3d heliocentricPos;  //!< heliocentric ecliptic (VSOP87) position [AU]
+		Vec3d heliocentricVel;  //!< heliocentric ecliptic (VSOP87) velocity [AU/d]
+		float vMagnitude;       //!< apparent visual magnitude seen from the observer body
+	};
+
+	//! @param bodies the bodies to compute
+	//! @param observer the body of the observer, used for light time and magnitudes.
+	//! If it is the current planet of the StelCore and topocentric coordinates are used,
+	//! computeJ2000EquatorialPos() is corrected for the current location on it.
+	EphemerisEngine(const QList<PlanetP>& bodies, const PlanetP& observer);
+
+	//! Set whether the positions are corrected for the light travel time to the observer.
+	//! The default is the setting of the SolarSystem module.
+	void setFlagLightTravelTime(bool b) {flagLightTravelTime=b;}
+	bool getFlagLightTravelTime() const {return flagLightTravelTime;}
+
+	//! Set whether velocities and magnitudes are computed. When false, only positions are filled,
+	//! which is about 3 times faster. The default is true.
+	void setFlagFullState(bool b) {flagFullState=b;}
+	bool getFlagFullState() const {return flagFullState;}
+
+	const QList<PlanetP>& getBodies() const {return bodies;}
+
+	//! Compute the state of the body with index bodyIndex in getBodies() at date jde.
+	BodyState computeState(int bodyIndex, double jde) const;
+
+	//! Compute the states of all bodies at all dates.
+	//! @return the states, body index running fastest: result[i*getBodies().size()+b]
+	//! is the state of body b at date jdes[i].
+	QVector<BodyState> computeStates(const QVector<double>& jdes) const;
+
+	//! Same as computeStates(), with the dates split over the threads of the global thread pool.
+	QVector<BodyState> computeStatesParallel(const QVector<double>& jdes) const;
+
+	//! Compute the J2000 equatorial position of a body as seen from the observer at the dates jd (UT)
+	//! and jde (TT), i.e. the equivalent of Planet::getJ2000EquatorialPos() after StelCore::update()
+	//! at this date, including the topocentric correction and the light time corrected Sun.
+	Vec3d computeJ2000EquatorialPos(int bodyIndex, double jd, double jde) const;
+
+	//! Compute the heliocentric ecliptic position of a body at date jde by summing
+	//! up the positions of the body and of its parents. The Planet objects are not changed.
+	static Vec3d computeHeliocentricEclipticPos(const Planet* body, double jde);
+
+	//! Compute the rotation from the equatorial coordinates of a body to VSOP87 at date jde,
+	//! i.e. Planet::getRotEquatorialToVsop87() after StelCore::update() at this date.
+	static Mat4d computeRotEquatorialToVsop87(const Planet* body, double jde);
+
+private:
+	//! Compute the position of a body relative to its parent.
+	static void computeRelativePos(const Planet* body, double jde, double* xyz);
+	//! Light time corrected date at which the body has to be computed.
+	double lightTimeDate(const Planet* body, double jde, const Vec3d& observerPos) const;
+	//! Heliocentric ecliptic position of the observer at its location, as in StelCore::updateTransformMatrices().
+	Vec3d computeTopocentricObserverPos(double jd, double jde, const Vec3d& centerPos) const;
+	void computeRange(const QVector<double>& jdes, int start, int end, BodyState* result) const;
+
+	QList<PlanetP> bodies;
+	PlanetP observer;
+	PlanetP earth;
+	bool flagLightTravelTime;
+	bool flagFullState;
+	// Location on the observer body, see StelCore::updateTransformMatrices()
+	bool flagTopocentric;
+	double topoLatitude;   // [deg]
+	double topoLongitude;  // [deg]
+	double topoRho;        // distance from the center [AU]
+	double topoSigma;      // difference between geographic and geocentric latitude [rad]
+
+	friend class ComputeEphemerisChunk;
+};
+
+#endif // _EPHEMERISENGINE_HPP_
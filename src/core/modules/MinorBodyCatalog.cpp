@@ -0,0 +1,699 @@
+/*
+ * Stellarium
+ * Copyright (C) 2017 Stellarium Developers
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Suite 500, Boston, MA  02110-1335, USA.
+ */
+
+#include "MinorBodyCatalog.hpp"
+#include "Orbit.hpp"
+#include "Planet.hpp"
+#include "StelCore.hpp"
+#include "StelIniParser.hpp"
+#include "StelUtils.hpp"
+
+#include <QDebug>
+#include <QDir>
+#include <QHash>
+#include <QSettings>
+#include <QTextStream>
+#include <QtConcurrent>
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+
+const char MinorBodyCatalog::Magic[4] = {'S', 'S', 'M', 'B'};
+
+// Number of bodies per job of computeMagnitudes()
+static const int BODIES_PER_JOB = 4096;
+
+// Case insensitive order of the name index
+struct NameLessThan
+{
+	bool operator()(const QPair<QString, quint32>& a, const QPair<QString, quint32>& b) const
+	{
+		return QString::compare(a.first, b.first, Qt::CaseInsensitive)<0;
+	}
+};
+
+//! A body being imported.
+struct MinorBodyCatalog::Body
+{
+	Elements elements;
+	Details details;
+	QString name;
+};
+
+//! Functor for QtConcurrent: magnitudes of a range of bodies.
+class MinorBodyCatalog::MagnitudeChunk
+{
+public:
+	MagnitudeChunk(const MinorBodyCatalog* catalog, OrbitBatch* batches, double jde, const Vec3d& observerHelioPos, float* mags)
+		: catalog(catalog), batches(batches), jde(jde), observerHelioPos(observerHelioPos), mags(mags) {}
+	void operator()(const int& start)
+	{
+		const int end = qMin(start+BODIES_PER_JOB, catalog->size());
+		// Positions of the whole chunk at once, then the magnitudes. The orbits are those of the
+		// Planet objects. Their orientation is only computed at the first call, each job owns its batch.
+		OrbitBatch& batch = batches[start/BODIES_PER_JOB];
+		if (batch.indices.isEmpty())
+		{
+			for (int i=start; i<end; ++i)
+			{
+				const Elements& e = catalog->getElements(i);
+				if (e.flags & EllipticOrbit)
+				{
+					const Details& d = catalog->getDetails(i);
+					batch.indices.append(~batch.ellipticals.add(e.pericenterDistance, e.eccentricity, e.inclination,
+										    e.ascendingNode, e.argOfPericenter, d.ellipticalMeanAnomaly,
+										    d.ellipticalPeriod, d.ellipticalEpoch, 0., 0., 0.));
+				}
+				else
+					batch.indices.append(batch.comets.add(e.pericenterDistance, e.eccentricity, e.inclination, e.ascendingNode,
+									      e.argOfPericenter, e.timeAtPericenter, e.meanMotion));
+			}
+		}
+		QVector<double> cx(batch.comets.size()), cy(batch.comets.size()), cz(batch.comets.size());
+		batch.comets.computePositions(jde, cx.data(), cy.data(), cz.data());
+		QVector<double> ex(batch.ellipticals.size()), ey(batch.ellipticals.size()), ez(batch.ellipticals.size());
+		batch.ellipticals.computePositions(jde, ex.data(), ey.data(), ez.data());
+		for (int i=start; i<end; ++i)
+		{
+			const int k = batch.indices.at(i-start);
+			mags[i] = computeMagnitude(i, k>=0 ? Vec3d(cx[k], cy[k], cz[k]) : Vec3d(ex[~k], ey[~k], ez[~k]));
+		}
+	}
+private:
+	float computeMagnitude(int index, const Vec3d& pos) const
+	{
+		const Elements& e = catalog->getElements(index);
+		double h = e.absoluteMagnitude;
+		double g = e.slopeParameter;
+		if (h<=-99.)
+		{
+			// Estimate H from the size, like Planet::computeVMagnitude() does with radius and albedo.
+			const Details& d = catalog->getDetails(index);
+			if (d.radius<=0.f || d.albedo<=0.f)
+				return 99.f;
+			h = 5.*std::log10(1329./(2.*d.radius*std::sqrt(d.albedo)));
+			g = 0.15;
+		}
+		const double r = pos.length();
+		const double delta = (pos-observerHelioPos).length();
+		if (e.type==Comet)
+			return h + 5.*std::log10(delta) + 2.5*g*std::log10(r);
+
+		const double robs = observerHelioPos.length();
+		const double cosChi = qBound(-1., (delta*delta + r*r - robs*robs)/(2.*delta*r), 1.);
+		const double tanPhaseAngleHalf = std::tan(std::acos(cosChi)*0.5);
+		const double phi1 = std::exp(-3.33 * std::pow(tanPhaseAngleHalf, 0.63));
+		const double phi2 = std::exp(-1.87 * std::pow(tanPhaseAngleHalf, 1.22));
+		return h - 2.5*std::log10((1.-g)*phi1 + g*phi2) + 5.*std::log10(r*delta);
+	}
+
+	const MinorBodyCatalog* catalog;
+	OrbitBatch* batches;
+	double jde;
+	Vec3d observerHelioPos;
+	float* mags;
+};
+
+MinorBodyCatalog::MinorBodyCatalog()
+	: header(Q_NULLPTR)
+	, elements(Q_NULLPTR)
+	, details(Q_NULLPTR)
+	, nameIndex(Q_NULLPTR)
+	, strings(Q_NULLPTR)
+	, stringsSize(0)
+{
+}
+
+MinorBodyCatalog::~MinorBodyCatalog()
+{
+	clear();
+}
+
+void MinorBodyCatalog::clear()
+{
+	file.close();
+	header = Q_NULLPTR;
+	elements = Q_NULLPTR;
+	details = Q_NULLPTR;
+	nameIndex = Q_NULLPTR;
+	strings = Q_NULLPTR;
+	stringsSize = 0;
+	batches.clear();
+}
+
+bool MinorBodyCatalog::load(const QString& catalogPath)
+{
+	clear();
+	if (!file.open(catalogPath, Magic, Version, sizeof(Header), "minor body catalogue"))
+		return false;
+
+	const uchar* data = file.getData();
+	const Header* h = reinterpret_cast<const Header*>(data);
+	const quint64 count = h->count;
+	bool valid = file.containsSection(h->elementsOffset, count, sizeof(Elements), 8)
+		&& file.containsSection(h->detailsOffset, count, sizeof(Details), 8)
+		&& file.containsSection(h->nameIndexOffset, count, sizeof(quint32), 8)
+		&& file.containsStrings(h->stringsOffset, h->stringsSize);
+	const quint32* names = reinterpret_cast<const quint32*>(data+h->nameIndexOffset);
+	for (quint64 i=0; valid && i<count; ++i)
+		valid = names[i]<count;
+	if (!valid)
+	{
+		qWarning() << "Invalid minor body catalogue" << QDir::toNativeSeparators(catalogPath);
+		clear();
+		return false;
+	}
+
+	header = h;
+	elements = reinterpret_cast<const Elements*>(data+h->elementsOffset);
+	details = reinterpret_cast<const Details*>(data+h->detailsOffset);
+	nameIndex = reinterpret_cast<const quint32*>(data+h->nameIndexOffset);
+	strings = reinterpret_cast<const char*>(data+h->stringsOffset);
+	stringsSize = h->stringsSize;
+	batches.resize((size()+BODIES_PER_JOB-1)/BODIES_PER_JOB);
+	return true;
+}
+
+int MinorBodyCatalog::size() const
+{
+	return header ? static_cast<int>(header->count) : 0;
+}
+
+QString MinorBodyCatalog::getString(quint32 offset) const
+{
+	return StelMappedCatalog::getString(strings, stringsSize, offset);
+}
+
+QString MinorBodyCatalog::getTypeString(quint8 type)
+{
+	switch (type)
+	{
+		case DwarfPlanet:
+			return "dwarf planet";
+		case Cubewano:
+			return "cubewano";
+		case Plutino:
+			return "plutino";
+		case ScatteredDiscObject:
+			return "scattered disc object";
+		case OortCloudObject:
+			return "Oort cloud object";
+		case Comet:
+			return "comet";
+		case Sednoid:
+			return "sednoid";
+		case Star:
+			return "star";
+		case MajorPlanet:
+			return "planet";
+		case Moon:
+			return "moon";
+		case Observer:
+			return "observer";
+		case Artificial:
+			return "artificial";
+		case Undefined:
+			return "UNDEFINED";
+		default:
+			return "asteroid";
+	}
+}
+
+int MinorBodyCatalog::compareName(int index, const QString& name, int length) const
+{
+	const QString bodyName = getEnglishName(nameIndex[index]);
+	return QString::compare(length<0 ? bodyName : bodyName.left(length), name, Qt::CaseInsensitive);
+}
+
+int MinorBodyCatalog::findByEnglishName(const QString& name) const
+{
+	int lo = 0;
+	int hi = size();
+	while (lo<hi)
+	{
+		const int mid = (lo+hi)/2;
+		const int c = compareName(mid, name, -1);
+		if (c==0)
+			return nameIndex[mid];
+		if (c<0)
+			lo = mid+1;
+		else
+			hi = mid;
+	}
+	return -1;
+}
+
+QVector<int> MinorBodyCatalog::findByPrefix(const QString& prefix, int maxNbItem) const
+{
+	QVector<int> result;
+	if (prefix.isEmpty())
+		return result;
+	// First name which is not smaller than the prefix
+	int lo = 0;
+	int hi = size();
+	while (lo<hi)
+	{
+		const int mid = (lo+hi)/2;
+		if (compareName(mid, prefix, prefix.length())<0)
+			lo = mid+1;
+		else
+			hi = mid;
+	}
+	for (int i=lo; i<size() && result.size()<maxNbItem && compareName(i, prefix, prefix.length())==0; ++i)
+		result.append(nameIndex[i]);
+	return result;
+}
+
+Vec3d MinorBodyCatalog::computeHeliocentricPos(int index, double jde) const
+{
+	const Elements& e = elements[index];
+	// Same orbit as created by SolarSystem, without the velocity.
+	Vec3d pos;
+	if (e.flags & EllipticOrbit)
+	{
+		const Details& d = details[index];
+		const EllipticalOrbit orbit(e.pericenterDistance, e.eccentricity, e.inclination, e.ascendingNode, e.argOfPericenter,
+					    d.ellipticalMeanAnomaly, d.ellipticalPeriod, d.ellipticalEpoch, 0., 0., 0.);
+		orbit.positionAtTimevInVSOP87Coordinates(jde, pos);
+		return pos;
+	}
+	CometOrbit orbit(e.pericenterDistance, e.eccentricity, e.inclination, e.ascendingNode, e.argOfPericenter,
+			 e.timeAtPericenter, 0., e.meanMotion, 0., 0., 0.);
+	orbit.positionAtTimevInVSOP87Coordinates(jde, pos, false);
+	return pos;
+}
+
+void MinorBodyCatalog::computeMagnitudes(double jde, const Vec3d& observerHelioPos, float* mags) const
+{
+	QVector<int> starts;
+	for (int i=0; i<size(); i+=BODIES_PER_JOB)
+		starts.append(i);
+	QtConcurrent::blockingMap(starts, MagnitudeChunk(this, batches.data(), jde, observerHelioPos, mags));
+}
+
+void MinorBodyCatalog::initElements(Elements& e, Details& d)
+{
+	memset(&e, 0, sizeof(Elements));
+	memset(&d, 0, sizeof(Details));
+	e.absoluteMagnitude = -99.f;
+	e.slopeParameter = 0.15f;
+	e.flags = CloseOrbit;
+	d.rotationPeriod = 1.;
+	d.rotationEpoch = J2000;
+	d.albedo = 0.25f;
+	d.roughness = 0.9f;
+	d.colorIndexBV = 99.f;
+	d.color[0] = d.color[1] = d.color[2] = 1.f;
+	d.outgasIntensity = 0.1f;
+	d.outgasFalloff = 0.1f;
+	d.dustWidthFactor = 1.5f;
+	d.dustLengthFactor = 0.4f;
+	d.dustBrightnessFactor = 1.5f;
+	d.orbitGoodDays = 1000.f;
+}
+
+bool MinorBodyCatalog::write(const QString& catalogPath, QVector<Body>& bodies, StringTable& strings)
+{
+	Header h;
+	memset(&h, 0, sizeof(Header));
+	StelMappedCatalog::initSignature(h.signature, Magic, Version);
+	h.count = bodies.size();
+	h.elementsOffset = StelMappedCatalog::align8(sizeof(Header));
+	h.detailsOffset = StelMappedCatalog::align8(h.elementsOffset + h.count*sizeof(Elements));
+	h.nameIndexOffset = StelMappedCatalog::align8(h.detailsOffset + h.count*sizeof(Details));
+	h.stringsOffset = h.nameIndexOffset + h.count*sizeof(quint32);
+	h.stringsSize = strings.data.size();
+
+	// Index of the bodies sorted by name, in the order used by compareName()
+	QVector<QPair<QString, quint32> > names;
+	names.reserve(bodies.size());
+	for (int i=0; i<bodies.size(); ++i)
+		names.append(qMakePair(bodies.at(i).name, quint32(i)));
+	std::sort(names.begin(), names.end(), NameLessThan());
+
+	StelMappedCatalog::Writer out(catalogPath, "minor body catalogue");
+	if (!out.open())
+		return false;
+	out.write(0, &h, sizeof(Header));
+	for (int i=0; i<bodies.size(); ++i)
+		out.write(h.elementsOffset, &bodies.at(i).elements, sizeof(Elements));
+	for (int i=0; i<bodies.size(); ++i)
+		out.write(h.detailsOffset, &bodies.at(i).details, sizeof(Details));
+	for (int i=0; i<names.size(); ++i)
+		out.write(h.nameIndexOffset, &names.at(i).second, sizeof(quint32));
+	out.write(h.stringsOffset, strings.data);
+	return out.commit(h.stringsOffset+h.stringsSize);
+}
+
+bool MinorBodyCatalog::importIni(const QString& iniPath, const QString& catalogPath)
+{
+	QSettings pd(iniPath, StelIniFormat);
+	if (pd.status() != QSettings::NoError)
+	{
+		qWarning() << "ERROR while parsing" << QDir::toNativeSeparators(iniPath);
+		return false;
+	}
+
+	QHash<QString, quint8> types;
+	for (quint8 t=Asteroid; t<Undefined; ++t)
+		types.insert(getTypeString(t), t);
+
+	QVector<Body> bodies;
+	StringTable strings;
+	foreach (const QString& secname, pd.childGroups())
+	{
+		Body b;
+		Elements& e = b.elements;
+		Details& d = b.details;
+		initElements(e, d);
+		b.name = pd.value(secname+"/name").toString().simplified();
+
+		// The catalogue only describes minor bodies around the Sun. Everything else
+		// has to be loaded from the INI file by SolarSystem.
+		const QString funcName = pd.value(secname+"/coord_func").toString();
+		const QString type = pd.value(secname+"/type").toString();
+		if (b.name.isEmpty() || b.name.contains("Pluto")
+		    || pd.value(secname+"/parent", "Sun").toString()!="Sun"
+		    || (funcName!="ell_orbit" && funcName!="comet_orbit")
+		    || pd.value(secname+"/rings", 0).toBool())
+		{
+			qDebug() << "Section" << secname << "cannot be stored in a minor body catalogue";
+			return false;
+		}
+		// Like Planet, keep unknown types as UNDEFINED
+		e.type = types.value(type, Undefined);
+		if (e.type==Undefined)
+			qDebug() << "Section" << secname << "has an unknown type" << type;
+
+		// Orbit: the same computations as in SolarSystem::loadPlanets(), converted to the elements of CometOrbit.
+		// ell_orbit gives distances in km, comet_orbit in AU.
+		const double unit = (funcName=="ell_orbit") ? AU : 1.;
+		e.eccentricity = pd.value(secname+"/orbit_Eccentricity", 0.0).toDouble();
+		double pericenterDistance = pd.value(secname+"/orbit_PericenterDistance", -1e100).toDouble();
+		double semiMajorAxis;
+		if (pericenterDistance <= 0.0)
+		{
+			semiMajorAxis = pd.value(secname+"/orbit_SemiMajorAxis", -1e100).toDouble();
+			if (semiMajorAxis <= -1e100 || e.eccentricity==1.0)
+			{
+				qWarning() << "ERROR: " << b.name << ": you must provide orbit_PericenterDistance or orbit_SemiMajorAxis";
+				continue;
+			}
+			semiMajorAxis /= unit;
+			pericenterDistance = semiMajorAxis * (1.0-e.eccentricity);
+		}
+		else
+		{
+			pericenterDistance /= unit;
+			semiMajorAxis = (e.eccentricity == 1.0) ? 0.0 : pericenterDistance / (1.0-e.eccentricity);
+		}
+		e.pericenterDistance = pericenterDistance;
+
+		double meanMotion = pd.value(secname+"/orbit_MeanMotion", -1e100).toDouble();
+		if (meanMotion <= -1e100)
+		{
+			const double period = pd.value(secname+"/orbit_Period", -1e100).toDouble();
+			if (period <= -1e100)
+				meanMotion = (e.eccentricity == 1.0)
+						? 0.01720209895 * (1.5/pericenterDistance) * std::sqrt(0.5/pericenterDistance)
+						: 0.01720209895 / (fabs(semiMajorAxis)*std::sqrt(fabs(semiMajorAxis)));
+			else
+				meanMotion = 2.0*M_PI/period;
+		}
+		else if (funcName=="comet_orbit")
+			meanMotion *= (M_PI/180.0);
+		e.meanMotion = meanMotion;
+
+		e.inclination = pd.value(secname+"/orbit_Inclination").toDouble()*(M_PI/180.0);
+		e.ascendingNode = pd.value(secname+"/orbit_AscendingNode").toDouble()*(M_PI/180.0);
+		double argOfPericenter = pd.value(secname+"/orbit_ArgOfPericenter", -1e100).toDouble();
+		if (argOfPericenter <= -1e100)
+			argOfPericenter = pd.value(secname+"/orbit_LongOfPericenter").toDouble()*(M_PI/180.0) - e.ascendingNode;
+		else
+			argOfPericenter *= (M_PI/180.0);
+		e.argOfPericenter = argOfPericenter;
+
+		double timeAtPericenter = pd.value(secname+"/orbit_TimeAtPericenter", -1e100).toDouble();
+		if (timeAtPericenter <= -1e100)
+		{
+			const double epoch = pd.value(secname+"/orbit_Epoch", funcName=="ell_orbit" ? J2000 : -1e100).toDouble();
+			double meanAnomaly = pd.value(secname+"/orbit_MeanAnomaly", -1e100).toDouble();
+			if (meanAnomaly <= -1e100 && funcName=="ell_orbit")
+				meanAnomaly = pd.value(secname+"/orbit_MeanLongitude").toDouble() - (argOfPericenter+e.ascendingNode)*(180.0/M_PI);
+			if (epoch <= -1e100 || meanAnomaly <= -1e100)
+			{
+				qWarning() << "ERROR: " << b.name << ": when you do not provide orbit_TimeAtPericenter, you must provide both "
+					   << "orbit_Epoch and orbit_MeanAnomaly";
+				continue;
+			}
+			timeAtPericenter = epoch - meanAnomaly*(M_PI/180.0) / meanMotion;
+		}
+		e.timeAtPericenter = timeAtPericenter;
+		d.orbitGoodDays = pd.value(secname+"/orbit_good", 1000).toFloat();
+
+		e.flags = 0;
+		if (funcName=="ell_orbit" && e.type!=Comet)
+		{
+			// Keep the elements of EllipticalOrbit, which ignores orbit_TimeAtPericenter and orbit_good.
+			// These bodies are always computed with EllipticalOrbit, also in computeMagnitudes().
+			// Comet objects need a CometOrbit, so comets always keep the converted elements.
+			double ellipticalMeanAnomaly = pd.value(secname+"/orbit_MeanAnomaly", -1e100).toDouble();
+			if (ellipticalMeanAnomaly <= -1e100)
+				ellipticalMeanAnomaly = pd.value(secname+"/orbit_MeanLongitude").toDouble()*(M_PI/180.0) - (argOfPericenter+e.ascendingNode);
+			else
+				ellipticalMeanAnomaly *= (M_PI/180.0);
+			d.ellipticalMeanAnomaly = ellipticalMeanAnomaly;
+			d.ellipticalPeriod = 2.0*M_PI/meanMotion;
+			d.ellipticalEpoch = pd.value(secname+"/orbit_Epoch", J2000).toDouble();
+			e.flags |= EllipticOrbit;
+		}
+		if (pd.value(secname+"/closeOrbit", true).toBool() && e.eccentricity<1.0)
+			e.flags |= CloseOrbit;
+		if (pd.value(secname+"/hidden", false).toBool())
+			e.flags |= Hidden;
+		if (pd.value(secname+"/halo", true).toBool())
+			e.flags |= Halo;
+		if (pd.value(secname+"/atmosphere", false).toBool())
+			e.flags |= Atmosphere;
+
+		// Magnitude system
+		e.absoluteMagnitude = pd.value(secname+"/absolute_magnitude", -99).toFloat();
+		if (e.type==Comet)
+		{
+			e.slopeParameter = pd.value(secname+"/slope_parameter", 4.0).toFloat();
+			if (e.slopeParameter<0.f || e.slopeParameter>20.f)
+				e.slopeParameter = 4.f;
+			const double q = pd.value(secname+"/orbit_PericenterDistance", -1e100).toDouble();
+			d.semiMajorAxis = (e.eccentricity<1 && q>0) ? q/(1.0-e.eccentricity) : 0.;
+		}
+		else
+		{
+			e.slopeParameter = pd.value(secname+"/slope_parameter", 0.15).toFloat();
+			if (e.slopeParameter<0.f || e.slopeParameter>1.f)
+				e.slopeParameter = 0.15f;
+			d.semiMajorAxis = pd.value(secname+"/orbit_SemiMajorAxis", 0).toDouble();
+		}
+
+		// Physical data
+		d.radius = pd.value(secname+"/radius").toFloat();
+		d.oblateness = pd.value(secname+"/oblateness", 0.0).toFloat();
+		d.albedo = pd.value(secname+"/albedo", 0.25f).toFloat();
+		d.roughness = pd.value(secname+"/roughness", 0.9f).toFloat();
+		d.colorIndexBV = pd.value(secname+"/color_index_bv", 99.f).toFloat();
+		const Vec3f color = StelUtils::strToVec3f(pd.value(secname+"/color", "1.0,1.0,1.0").toString());
+		d.color[0] = color[0];
+		d.color[1] = color[1];
+		d.color[2] = color[2];
+		d.outgasIntensity = pd.value(secname+"/outgas_intensity", 0.1f).toFloat();
+		d.outgasFalloff = pd.value(secname+"/outgas_falloff", 0.1f).toFloat();
+		d.dustWidthFactor = pd.value(secname+"/dust_widthfactor", 1.5f).toFloat();
+		d.dustLengthFactor = pd.value(secname+"/dust_lengthfactor", 0.4f).toFloat();
+		d.dustBrightnessFactor = pd.value(secname+"/dust_brightnessfactor", 1.5f).toFloat();
+
+		// Rotation, see SolarSystem::loadPlanets()
+		double rotObliquity = pd.value(secname+"/rot_obliquity", 0.).toDouble()*(M_PI/180.0);
+		double rotAscNode = pd.value(secname+"/rot_equator_ascending_node", 0.).toDouble()*(M_PI/180.0);
+		const double J2000NPoleRA = pd.value(secname+"/rot_pole_ra", 0.).toDouble()*M_PI/180.;
+		const double J2000NPoleDE = pd.value(secname+"/rot_pole_de", 0.).toDouble()*M_PI/180.;
+		if (J2000NPoleRA || J2000NPoleDE)
+		{
+			Vec3d J2000NPole;
+			StelUtils::spheToRect(J2000NPoleRA, J2000NPoleDE, J2000NPole);
+			Vec3d vsop87Pole(StelCore::matJ2000ToVsop87.multiplyWithoutTranslation(J2000NPole));
+			double ra, de;
+			StelUtils::rectToSphe(&ra, &de, vsop87Pole);
+			rotObliquity = (M_PI_2 - de);
+			rotAscNode = (ra + M_PI_2);
+		}
+		d.rotationPeriod = pd.value(secname+"/rot_periode", pd.value(secname+"/orbit_Period", 24.).toDouble()).toDouble()/24.;
+		d.rotationOffset = pd.value(secname+"/rot_rotation_offset", 0.).toDouble();
+		d.rotationEpoch = pd.value(secname+"/rot_epoch", J2000).toDouble();
+		d.rotationObliquity = rotObliquity;
+		d.rotationAscendingNode = rotAscNode;
+		d.rotationPrecessionRate = pd.value(secname+"/rot_precession_rate", 0.).toDouble()*M_PI/(180*36525);
+		d.orbitVisualizationPeriod = pd.value(secname+"/orbit_visualization_period", 0.).toDouble();
+
+		// Names and strings
+		d.minorPlanetNumber = pd.value(secname+"/minor_planet_number", 0).toInt();
+		d.englishName = strings.add(b.name);
+		d.provisionalDesignation = strings.add(pd.value(secname+"/provisional_designation").toString());
+		d.texMap = strings.add(pd.value(secname+"/tex_map", "nomap.png").toString());
+		d.model = strings.add(pd.value(secname+"/model").toString());
+		d.spectralTypeT = strings.add(pd.value(secname+"/spec_t").toString());
+		d.spectralTypeB = strings.add(pd.value(secname+"/spec_b").toString());
+		if (!isMinorPlanetType(e.type) && e.type!=Comet)
+		{
+			// Default normal map of Planet objects as in SolarSystem::loadPlanets()
+			const QString normalMapName = (e.flags & Hidden) ? QString() : b.name.toLower().append("_normals.png");
+			d.normalsMap = strings.add(pd.value(secname+"/normals_map", normalMapName).toString());
+		}
+
+		bodies.append(b);
+	}
+
+	if (bodies.isEmpty())
+	{
+		qWarning() << "No minor bodies found in" << QDir::toNativeSeparators(iniPath);
+		return false;
+	}
+	return write(catalogPath, bodies, strings);
+}
+
+// Decode the packed epoch of MPCORB.DAT, e.g. K194R = 2019-04-27 (0h TT).
+static bool unpackMpcEpoch(const QString& packed, double* jde)
+{
+	if (packed.length()!=5)
+		return false;
+	const QChar c = packed.at(0);
+	if (c<'I' || c>'L')
+		return false;
+	bool ok;
+	const int year = (c.toLatin1()-'A'+10)*100 + packed.mid(1, 2).toInt(&ok);
+	if (!ok)
+		return false;
+	const int month = QString(packed.at(3)).toInt(&ok, 32);
+	if (!ok || month<1 || month>12)
+		return false;
+	const int day = QString(packed.at(4)).toInt(&ok, 32);
+	if (!ok || day<1 || day>31)
+		return false;
+	return StelUtils::getJDFromDate(jde, year, month, day, 0, 0, 0);
+}
+
+bool MinorBodyCatalog::importMpcorb(const QString& mpcorbPath, const QString& catalogPath)
+{
+	QFile in(mpcorbPath);
+	if (!in.open(QIODevice::ReadOnly | QIODevice::Text))
+	{
+		qWarning() << "Cannot open" << QDir::toNativeSeparators(mpcorbPath);
+		return false;
+	}
+
+	QVector<Body> bodies;
+	StringTable strings;
+	QRegExp numberedRx("^\\((\\d+)\\)\\s+(.+)$");
+	// The file may start with a text header which ends with a line of dashes.
+	bool inHeader = true;
+	int lineNumber = 0;
+	int errors = 0;
+	QTextStream stream(&in);
+	while (!stream.atEnd())
+	{
+		const QString line = stream.readLine();
+		++lineNumber;
+		if (inHeader)
+		{
+			if (line.startsWith("-----"))
+				inHeader = false;
+			// Files without header start directly with the orbits.
+			if (line.length()<160 || line.at(0)=='-')
+				continue;
+		}
+		inHeader = false;
+		if (line.trimmed().isEmpty())
+			continue;
+
+		// Column layout: see https://www.minorplanetcenter.net/iau/info/MPOrbitFormat.html
+		bool ok[8];
+		const double h = line.mid(8, 5).toDouble(&ok[0]);
+		const double g = line.mid(14, 5).toDouble(&ok[1]);
+		const double meanAnomaly = line.mid(26, 9).toDouble(&ok[2]);
+		const double argOfPericenter = line.mid(37, 9).toDouble(&ok[3]);
+		const double ascendingNode = line.mid(48, 9).toDouble(&ok[4]);
+		const double inclination = line.mid(59, 9).toDouble(&ok[5]);
+		const double eccentricity = line.mid(70, 9).toDouble(&ok[6]);
+		const double meanMotion = line.mid(80, 11).toDouble(&ok[7]);
+		const double semiMajorAxis = line.mid(92, 11).toDouble();
+		double epoch;
+		if (line.length()<103 || !ok[2] || !ok[3] || !ok[4] || !ok[5] || !ok[6] || !ok[7]
+		    || meanMotion<=0. || eccentricity>=1. || !unpackMpcEpoch(line.mid(20, 5), &epoch))
+		{
+			if (errors++<10)
+				qWarning() << "Invalid orbit in" << QDir::toNativeSeparators(mpcorbPath) << "line" << lineNumber;
+			continue;
+		}
+
+		Body b;
+		Elements& e = b.elements;
+		Details& d = b.details;
+		initElements(e, d);
+		e.type = Asteroid;
+		e.eccentricity = eccentricity;
+		e.pericenterDistance = semiMajorAxis*(1.0-eccentricity);
+		e.inclination = inclination*(M_PI/180.0);
+		e.ascendingNode = ascendingNode*(M_PI/180.0);
+		e.argOfPericenter = argOfPericenter*(M_PI/180.0);
+		e.meanMotion = meanMotion*(M_PI/180.0);
+		e.timeAtPericenter = epoch - meanAnomaly*(M_PI/180.0)/e.meanMotion;
+		if (ok[0])
+		{
+			e.absoluteMagnitude = h;
+			e.slopeParameter = (ok[1] && g>=0. && g<=1.) ? g : 0.15;
+			// Typical albedo of the SolarSystemEditor imports
+			d.albedo = 0.15f;
+			d.radius = 0.5 * 1329. / std::sqrt(d.albedo) * std::pow(10., -0.2*h);
+		}
+		d.semiMajorAxis = semiMajorAxis;
+
+		const QString readable = line.mid(166, 28).trimmed();
+		if (numberedRx.exactMatch(readable))
+		{
+			d.minorPlanetNumber = numberedRx.cap(1).toInt();
+			b.name = numberedRx.cap(2);
+		}
+		else
+		{
+			b.name = readable.isEmpty() ? line.left(7).trimmed() : readable;
+			d.provisionalDesignation = strings.add(b.name);
+		}
+		d.englishName = strings.add(b.name);
+		d.texMap = strings.add("nomap.png");
+		bodies.append(b);
+	}
+
+	if (errors)
+		qWarning() << errors << "invalid orbits skipped in" << QDir::toNativeSeparators(mpcorbPath);
+	if (bodies.isEmpty())
+	{
+		qWarning() << "No minor bodies found in" << QDir::toNativeSeparators(mpcorbPath);
+		return false;
+	}
+	return write(catalogPath, bodies, strings);
+}
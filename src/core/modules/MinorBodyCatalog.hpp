@@ -0,0 +1,226 @@
+/*
+ * Stellarium
+ * Copyright (C) 2017 Stellarium Developers
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Suite 500, Boston, MA  02110-1335, USA.
+ */
+
+#ifndef _MINORBODYCATALOG_HPP_
+#define _MINORBODYCATALOG_HPP_
+
+#include "VecMath.hpp"
+#include "Orbit.hpp"
+#include "StelMappedCatalog.hpp"
+
+#include <QString>
+#include <QStringList>
+#include <QVector>
+
+//! @class MinorBodyCatalog
+//! Read-only, memory-mapped binary catalogue of minor bodies (asteroids, comets, TNOs...) in
+//! heliocentric orbits. It replaces the parsing of ssystem_minor.ini with QSettings, which does not
+//! scale to the size of the MPCORB database: the INI file (or MPCORB.DAT) is imported once into the
+//! binary format, which is then mapped into memory at startup.
+//!
+//! The file contains, after a header:
+//! - the orbital elements of all bodies, in compact records meant to be evaluated in bulk
+//!   (e.g. to find out which bodies are bright enough to be drawn),
+//! - the descriptive data needed to create the Planet, MinorPlanet or Comet object of one body,
+//! - an index of the records sorted by name, for searching,
+//! - a table of UTF-8 strings.
+//!
+//! The file is read and written with StelMappedCatalog. The orbital elements are those of CometOrbit,
+//! i.e. the orbit is evaluated the same way as for the bodies defined with coord_func=comet_orbit in
+//! ssystem_minor.ini. Bodies defined with coord_func=ell_orbit also keep the elements of EllipticalOrbit
+//! in their Details, so that their positions are exactly those computed when loaded from the INI file.
+class MinorBodyCatalog
+{
+public:
+	//! Kind of body, stored in Elements::type. There is one value for each type string of Planet.
+	//! As in SolarSystem::loadPlanets(), the types Asteroid to OortCloudObject give MinorPlanet objects,
+	//! Comet gives Comet objects, and all other types give Planet objects.
+	enum BodyType
+	{
+		Asteroid = 0,
+		DwarfPlanet,
+		Cubewano,
+		Plutino,
+		ScatteredDiscObject,
+		OortCloudObject,
+		Comet,
+		Sednoid,
+		Star,
+		MajorPlanet,       //!< type="planet"
+		Moon,
+		Observer,
+		Artificial,
+		Undefined          //!< any other type string
+	};
+
+	//! Bits of Elements::flags.
+	enum BodyFlag
+	{
+		Hidden = 1,        //!< the body is never drawn
+		CloseOrbit = 2,    //!< the orbit line is drawn closed
+		EllipticOrbit = 4, //!< defined with ell_orbit, the Planet object uses EllipticalOrbit with the elements of Details
+		Halo = 8,          //!< only for Planet objects, see Planet::hasHalo()
+		Atmosphere = 16    //!< only for Planet objects, see Planet::hasAtmosphere()
+	};
+
+	//! Orbital elements and magnitude parameters of one body (72 bytes).
+	struct Elements
+	{
+		double pericenterDistance;  //!< [AU]
+		double eccentricity;
+		double inclination;         //!< [rad]
+		double ascendingNode;       //!< [rad]
+		double argOfPericenter;     //!< [rad]
+		double timeAtPericenter;    //!< [JDE]
+		double meanMotion;          //!< [rad/d], for parabolic orbits W/dt as in CometOrbit
+		float absoluteMagnitude;    //!< H for asteroids, absolute magnitude for comets, -99 if unknown
+		float slopeParameter;       //!< G for asteroids, 2.5*n for comets
+		quint8 type;                //!< a BodyType
+		quint8 flags;               //!< a combination of BodyFlag
+		quint16 reserved0;
+		quint32 reserved1;
+	};
+
+	//! Descriptive data of one body, only read when its Planet object is created (176 bytes).
+	struct Details
+	{
+		double semiMajorAxis;               //!< [AU], 0 if unknown
+		double rotationPeriod;              //!< [d]
+		double rotationOffset;
+		double rotationEpoch;               //!< [JDE]
+		double rotationObliquity;           //!< [rad], relative to VSOP87
+		double rotationAscendingNode;       //!< [rad], relative to VSOP87
+		double rotationPrecessionRate;      //!< [rad/d]
+		double orbitVisualizationPeriod;    //!< [d]
+		double ellipticalMeanAnomaly;       //!< [rad], only with EllipticOrbit
+		double ellipticalPeriod;            //!< [d], only with EllipticOrbit
+		double ellipticalEpoch;             //!< [JDE], only with EllipticOrbit
+		float radius;                       //!< [km]
+		float oblateness;
+		float albedo;
+		float roughness;
+		float colorIndexBV;                 //!< 99 if unknown
+		float color[3];
+		float outgasIntensity;
+		float outgasFalloff;
+		float dustWidthFactor;
+		float dustLengthFactor;
+		float dustBrightnessFactor;
+		float orbitGoodDays;
+		qint32 minorPlanetNumber;           //!< 0 if not numbered
+		quint32 englishName;                //!< offsets in the string table
+		quint32 provisionalDesignation;
+		quint32 texMap;
+		quint32 model;
+		quint32 spectralTypeT;
+		quint32 spectralTypeB;
+		quint32 normalsMap;                 //!< only for Planet objects
+	};
+
+	MinorBodyCatalog();
+	~MinorBodyCatalog();
+
+	//! Map a catalogue file into memory.
+	//! @return false if the file cannot be read or is not a valid catalogue for this machine.
+	bool load(const QString& catalogPath);
+	//! Unmap the catalogue.
+	void clear();
+
+	bool isLoaded() const {return header!=Q_NULLPTR;}
+	int size() const;
+
+	const Elements& getElements(int index) const {return elements[index];}
+	const Details& getDetails(int index) const {return details[index];}
+	QString getEnglishName(int index) const {return getString(details[index].englishName);}
+	QString getString(quint32 offset) const;
+	//! Return the type string used in ssystem_minor.ini, e.g. "asteroid" or "comet".
+	static QString getTypeString(quint8 type);
+	//! Return whether bodies of this type are MinorPlanet objects.
+	static bool isMinorPlanetType(quint8 type) {return type<Comet;}
+
+	//! Find a body by English name (case insensitive).
+	//! @return the index of the body, or -1 if not found.
+	int findByEnglishName(const QString& name) const;
+	//! Return the indices of the bodies whose name starts with prefix (case insensitive), in name order.
+	QVector<int> findByPrefix(const QString& prefix, int maxNbItem) const;
+
+	//! Compute the heliocentric ecliptic (VSOP87) position of a body at date jde.
+	Vec3d computeHeliocentricPos(int index, double jde) const;
+	//! Estimate the apparent magnitudes of all bodies at date jde as seen from observerHelioPos,
+	//! with the same formulae as MinorPlanet and Comet. Bodies without absolute magnitude get 99.
+	//! The work is split over the threads of the global thread pool. Not reentrant: the orbits are
+	//! prepared for CometOrbitBatch at the first call, so only call it from one thread at a time.
+	//! @param mags receives size() values
+	void computeMagnitudes(double jde, const Vec3d& observerHelioPos, float* mags) const;
+
+	//! Convert a Stellarium minor body INI file (the ssystem_minor.ini format) to a catalogue.
+	//! Only bodies in heliocentric orbits given by ell_orbit or comet_orbit are supported.
+	//! @return false if the file cannot be read, or contains sections which cannot be stored in a catalogue.
+	static bool importIni(const QString& iniPath, const QString& catalogPath);
+	//! Convert the MPC orbit database of minor planets (MPCORB.DAT) to a catalogue.
+	//! @return false if the file cannot be read or contains no valid orbits.
+	static bool importMpcorb(const QString& mpcorbPath, const QString& catalogPath);
+
+	//! Magic number at the beginning of a catalogue file.
+	static const char Magic[4];
+	//! Version of the file format.
+	static const quint32 Version = 3;
+
+private:
+	//! File header (64 bytes).
+	struct Header
+	{
+		StelMappedCatalog::Signature signature;
+		quint32 count;
+		quint64 elementsOffset;
+		quint64 detailsOffset;
+		quint64 nameIndexOffset;
+		quint64 stringsOffset;
+		quint64 stringsSize;
+		quint64 reserved;
+	};
+
+	struct Body;
+	class MagnitudeChunk;
+	typedef StelMappedCatalog::StringTable StringTable;
+	//! Sort the bodies by name and write the file.
+	static bool write(const QString& catalogPath, QVector<Body>& bodies, StringTable& strings);
+	static void initElements(Elements& e, Details& d);
+	int compareName(int index, const QString& name, int length) const;
+
+	StelMappedCatalog file;
+	const Header* header;
+	const Elements* elements;
+	const Details* details;
+	const quint32* nameIndex;
+	const char* strings;
+	quint64 stringsSize;
+	//! Orbits of the bodies of one job of computeMagnitudes(): the bodies with EllipticOrbit in ellipticals,
+	//! the others in comets. indices holds for each body its index in comets, or ~index in ellipticals.
+	struct OrbitBatch
+	{
+		CometOrbitBatch comets;
+		EllipticalOrbitBatch ellipticals;
+		QVector<int> indices;
+	};
+	//! Orbits of each job of computeMagnitudes(), filled at its first call.
+	mutable QVector<OrbitBatch> batches;
+};
+
+#endif // _MINORBODYCATALOG_HPP_
@@ -21,6 +21,7 @@
 
 #include "Nebula.hpp"
 #include "NebulaMgr.hpp"
+#include "DsoCatalog.hpp"
 #include "StelTexture.hpp"
 
 #include "StelUtils.hpp"
@@ -951,23 +952,50 @@ QString Nebula::getDSODesignation() const
 	return str;
 }
 
-void Nebula::readDSO(QDataStream &in)
+void Nebula::readDSO(const DsoCatalog& catalog, int index)
 {
-	float	ra, dec;
-	unsigned int oType;
-
-	in	>> DSO_nb >> ra >> dec >> bMag >> vMag >> oType >> mTypeString >> majorAxisSize >> minorAxisSize
-		>> orientationAngle >> redshift >> redshiftErr >> parallax >> parallaxErr >> oDistance >> oDistanceErr
-		>> NGC_nb >> IC_nb >> M_nb >> C_nb >> B_nb >> Sh2_nb >> VdB_nb >> RCW_nb >> LDN_nb >> LBN_nb >> Cr_nb
-		>> Mel_nb >> PGC_nb >> UGC_nb >> Ced_nb >> Arp_nb >> VV_nb >> PK_nb >> PNG_nb >> SNRG_nb >> ACO_nb;
+	const DsoCatalog::Record& r = catalog.getRecord(index);
+	DSO_nb = r.DSO_nb;
+	bMag = r.bMag;
+	vMag = r.vMag;
+	mTypeString = catalog.getString(r.mTypeString);
+	majorAxisSize = r.majorAxisSize;
+	minorAxisSize = r.minorAxisSize;
+	orientationAngle = r.orientationAngle;
+	redshift = r.redshift;
+	redshiftErr = r.redshiftErr;
+	parallax = r.parallax;
+	parallaxErr = r.parallaxErr;
+	oDistance = r.oDistance;
+	oDistanceErr = r.oDistanceErr;
+	NGC_nb = r.NGC_nb;
+	IC_nb = r.IC_nb;
+	M_nb = r.M_nb;
+	C_nb = r.C_nb;
+	B_nb = r.B_nb;
+	Sh2_nb = r.Sh2_nb;
+	VdB_nb = r.VdB_nb;
+	RCW_nb = r.RCW_nb;
+	LDN_nb = r.LDN_nb;
+	LBN_nb = r.LBN_nb;
+	Cr_nb = r.Cr_nb;
+	Mel_nb = r.Mel_nb;
+	PGC_nb = r.PGC_nb;
+	UGC_nb = r.UGC_nb;
+	Ced_nb = catalog.getString(r.Ced_nb);
+	Arp_nb = r.Arp_nb;
+	VV_nb = r.VV_nb;
+	PK_nb = catalog.getString(r.PK_nb);
+	PNG_nb = catalog.getString(r.PNG_nb);
+	SNRG_nb = catalog.getString(r.SNRG_nb);
+	ACO_nb = catalog.getString(r.ACO_nb);
 
 	int f = NGC_nb + IC_nb + M_nb + C_nb + B_nb + Sh2_nb + VdB_nb + RCW_nb + LDN_nb + LBN_nb + Cr_nb + Mel_nb + PGC_nb + UGC_nb + Arp_nb + VV_nb;
 	if (f==0 && Ced_nb.isEmpty() && PK_nb.isEmpty() && PNG_nb.isEmpty() && SNRG_nb.isEmpty() && ACO_nb.isEmpty())
 		withoutID = true;
 
-	StelUtils::spheToRect(ra,dec,XYZ);
-	Q_ASSERT(fabs(XYZ.lengthSquared()-1.)<0.000000001);
-	nType = (Nebula::NebulaType)oType;
+	StelUtils::spheToRect(r.ra, r.dec, XYZ);
+	nType = (Nebula::NebulaType)r.type;
 	pointRegion = SphericalRegionP(new SphericalPoint(getJ2000EquatorialPos(Q_NULLPTR)));
 }
 
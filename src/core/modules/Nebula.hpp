@@ -29,7 +29,7 @@
 #include <QString>
 
 class StelPainter;
-class QDataStream;
+class DsoCatalog;
 
 // This only draws nebula icons. For the DSO images, see StelSkylayerMgr and StelSkyImageTile.
 class Nebula : public StelObject
@@ -214,7 +214,8 @@ private:
 			nameI18Aliases.append(trans.qtranslate(alias));
 	}
 
-	void readDSO(QDataStream& in);
+	//! Initialize the nebula from a record of a memory-mapped catalogue.
+	void readDSO(const DsoCatalog& catalog, int index);
 
 	void drawLabel(StelPainter& sPainter, float maxMagLabel) const;
 	void drawHints(StelPainter& sPainter, float maxMagHints) const;
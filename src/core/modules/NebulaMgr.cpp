@@ -39,6 +39,7 @@
 #include "StelPainter.hpp"
 #include "RefractionExtinction.hpp"
 #include "StelActionMgr.hpp"
+#include "StelGeodesicGrid.hpp"
 
 #include <algorithm>
 #include <vector>
@@ -49,6 +50,8 @@
 #include <QStringList>
 #include <QRegExp>
 #include <QDir>
+#include <QElapsedTimer>
+#include <QFileInfo>
 
 // Define version of valid Stellarium DSO Catalog
 // This number must be incremented each time the content or file format of the stars catalogs change
@@ -136,8 +139,7 @@ void NebulaMgr::setFlagOutlines(const bool flag) {if(Nebula::flagUseOutlines!=fl
 bool NebulaMgr::getFlagOutlines(void) const {return Nebula::flagUseOutlines;}
 
 NebulaMgr::NebulaMgr(void)
-	: nebGrid(200)
-	, hintsAmount(0)
+	: hintsAmount(0)
 	, labelsAmount(0)
 	, flagConverter(false)
 	, flagDecimalCoordinates(true)
@@ -406,49 +408,58 @@ void NebulaMgr::init()
 
 struct DrawNebulaFuncObject
 {
-	DrawNebulaFuncObject(float amaxMagHints, float amaxMagLabels, StelPainter* p, StelCore* aCore, bool acheckMaxMagHints)
+	DrawNebulaFuncObject(float amaxMagHints, float amaxMagLabels, StelPainter* p, StelCore* aCore)
 		: maxMagHints(amaxMagHints)
 		, maxMagLabels(amaxMagLabels)
 		, sPainter(p)
 		, core(aCore)
-		, checkMaxMagHints(acheckMaxMagHints)
 	{
 		angularSizeLimit = 5.f/sPainter->getProjector()->getPixelPerRadAtCenter()*180.f/M_PI;
 	}
-	void operator()(StelRegionObject* obj)
+	//! Filter the records by magnitude and size, before their Nebula objects are created.
+	bool isVisible(const DsoCatalog::Record& r) const
 	{
-		if (checkMaxMagHints)
-			return;
-
-		Nebula* n = static_cast<Nebula*>(obj);
-		float mag = n->vMag;
-		if (mag>90.f)
-			mag = n->bMag;
+		const float mag = DsoCatalog::getMagnitude(r);
 
 		StelSkyDrawer *drawer = core->getSkyDrawer();
-		// filter out DSOs which are too dim to be seen (e.g. for bino observers)		
+		// filter out DSOs which are too dim to be seen (e.g. for bino observers)
 		if ((drawer->getFlagNebulaMagnitudeLimit()) && (mag > drawer->getCustomNebulaMagnitudeLimit()))
-			return;
+			return false;
 
+		return r.majorAxisSize>angularSizeLimit || r.majorAxisSize==0.f || mag <= maxMagHints;
+	}
+	void operator()(Nebula* n)
+	{
 		if (!n->objectInDisplayedCatalog())
 			return;
 
-		if (n->majorAxisSize>angularSizeLimit || n->majorAxisSize==0.f || mag <= maxMagHints)
-		{
-			sPainter->getProjector()->project(n->XYZ,n->XY);
-			n->drawLabel(*sPainter, maxMagLabels);
-			n->drawHints(*sPainter, maxMagHints);
-			n->drawOutlines(*sPainter, maxMagHints);
-		}
+		sPainter->getProjector()->project(n->XYZ,n->XY);
+		n->drawLabel(*sPainter, maxMagLabels);
+		n->drawHints(*sPainter, maxMagHints);
+		n->drawOutlines(*sPainter, maxMagHints);
 	}
 	float maxMagHints;
 	float maxMagLabels;
 	StelPainter* sPainter;
 	StelCore* core;
 	float angularSizeLimit;
-	bool checkMaxMagHints;
 };
 
+// Append the records of a zone which pass the filters of func and, if region is set, lie in region.
+static void findVisibleRecords(const DsoCatalog& catalog, int zone, const SphericalRegion* region,
+			       const DrawNebulaFuncObject& func, QVector<int>& result)
+{
+	for (int j=catalog.getZoneBegin(zone); j<catalog.getZoneEnd(zone); ++j)
+	{
+		const int i = catalog.getZoneRecord(j);
+		const DsoCatalog::Record& r = catalog.getRecord(i);
+		if (region && !region->contains(Vec3d(r.pos[0], r.pos[1], r.pos[2])))
+			continue;
+		if (func.isVisible(r))
+			result.append(i);
+	}
+}
+
 void NebulaMgr::setCatalogFilters(Nebula::CatalogGroup cflags)
 {
 	if(static_cast<int>(cflags) != static_cast<int>(Nebula::catalogFilters))
@@ -492,8 +503,22 @@ void NebulaMgr::draw(StelCore* core)
 	float maxMagHints  = computeMaxMagHint(skyDrawer);
 	float maxMagLabels = skyDrawer->getLimitMagnitude()-2.f+(labelsAmount*1.2f)-2.f;
 	sPainter.setFont(nebulaFont);
-	DrawNebulaFuncObject func(maxMagHints, maxMagLabels, &sPainter, core, hintsFader.getInterstate()<=0.f);
-	nebGrid.processIntersectingPointInRegions(p.data(), func);
+	if (hintsFader.getInterstate()>0.f && dsoCatalog.isLoaded())
+	{
+		DrawNebulaFuncObject func(maxMagHints, maxMagLabels, &sPainter, core);
+
+		// The Nebula objects are only created for the records which pass the filters.
+		QVector<int> visible;
+		const int zoneLevel = dsoCatalog.getZoneLevel();
+		const GeodesicSearchResult* searchResult = core->getGeodesicGrid(zoneLevel)->search(p->getBoundingSphericalCaps(), zoneLevel);
+		int zone;
+		for (GeodesicSearchInsideIterator it(*searchResult, zoneLevel); (zone = it.next()) >= 0;)
+			findVisibleRecords(dsoCatalog, zone, Q_NULLPTR, func, visible);
+		for (GeodesicSearchBorderIterator it(*searchResult, zoneLevel); (zone = it.next()) >= 0;)
+			findVisibleRecords(dsoCatalog, zone, p.data(), func, visible);
+		foreach (int i, visible)
+			func(getDSO(i).data());
+	}
 
 	if (GETSTELMODULE(StelObjectMgr)->getFlagSelectedObjectPointer())
 		drawPointer(core, sPainter);
@@ -532,70 +557,187 @@ void NebulaMgr::drawPointer(const StelCore* core, StelPainter& sPainter)
 	}
 }
 
-// Search by name
+// Search by English name, then by designation
 NebulaP NebulaMgr::search(const QString& name)
 {
-	QString uname = name.toUpper();
+	NebulaP n = englishNameIndex.value(name.toUpper());
+	if (n.isNull())
+		n = searchDesignation(name);
+	return n;
+}
 
-	foreach (const NebulaP& n, dsoArray)
+// Upper case designation without spaces, as used in the keys of designationIndex
+static QString designationKey(const QString& designation)
+{
+	QString key;
+	key.reserve(designation.size());
+	for (int i=0; i<designation.size(); ++i)
 	{
-		QString testName = n->getEnglishName().toUpper();
-		if (testName==uname) return n;
+		const QChar c = designation.at(i);
+		if (!c.isSpace())
+			key.append(c.toUpper());
 	}
+	return key;
+}
 
-	// If no match found, try search by catalog reference
-	static QRegExp catNumRx("^(M|NGC|IC|C|B|VDB|RCW|LDN|LBN|CR|MEL|PGC|UGC|ARP|VV)\\s*(\\d+)$");
-	if (catNumRx.exactMatch(uname))
-	{
-		QString cat = catNumRx.capturedTexts().at(1);
-		int num = catNumRx.capturedTexts().at(2).toInt();
-
-		//qWarning() << "[SEARCH]" << cat << num;
-
-		if (cat == "M") return searchM(num);
-		if (cat == "NGC") return searchNGC(num);
-		if (cat == "IC") return searchIC(num);
-		if (cat == "C") return searchC(num);
-		if (cat == "B") return searchB(num);
-		if (cat == "VDB") return searchVdB(num);
-		if (cat == "RCW") return searchRCW(num);
-		if (cat == "LDN") return searchLDN(num);
-		if (cat == "LBN") return searchLBN(num);
-		if (cat == "CR") return searchCr(num);
-		if (cat == "MEL") return searchMel(num);
-		if (cat == "PGC") return searchPGC(num);
-		if (cat == "UGC") return searchUGC(num);
-		if (cat == "ARP") return searchArp(num);
-		if (cat == "VV") return searchVV(num);
+NebulaP NebulaMgr::searchNameOrDesignation(const QString& name, const QHash<QString, NebulaP>& nameIndex) const
+{
+	// NGC numbers first, then the common names and aliases, then the other designations
+	NebulaP n;
+	if (name.trimmed().startsWith("NGC", Qt::CaseInsensitive))
+		n = searchDesignation(name);
+	if (n.isNull())
+		n = nameIndex.value(name.toUpper());
+	if (n.isNull())
+		n = searchDesignation(name);
+	return n;
+}
+
+NebulaP NebulaMgr::searchDesignation(const QString& designation) const
+{
+	QString key = designationKey(designation);
+	// Abell clusters are indexed as ACO
+	if (key.startsWith("ABELL"))
+		key.replace(0, 5, "ACO");
+	return getDSO(designationIndex.value(key, -1));
+}
+
+void NebulaMgr::indexDesignations(int index)
+{
+	const DsoCatalog::Record& r = dsoCatalog.getRecord(index);
+	QStringList keys;
+	if (r.M_nb > 0)
+		keys << QString("M%1").arg(r.M_nb);
+	if (r.NGC_nb > 0)
+		keys << QString("NGC%1").arg(r.NGC_nb);
+	if (r.IC_nb > 0)
+		keys << QString("IC%1").arg(r.IC_nb);
+	if (r.C_nb > 0)
+		keys << QString("C%1").arg(r.C_nb);
+	if (r.B_nb > 0)
+		keys << QString("B%1").arg(r.B_nb);
+	if (r.Sh2_nb > 0)
+		keys << QString("SH2-%1").arg(r.Sh2_nb);
+	if (r.VdB_nb > 0)
+		keys << QString("VDB%1").arg(r.VdB_nb);
+	if (r.RCW_nb > 0)
+		keys << QString("RCW%1").arg(r.RCW_nb);
+	if (r.LDN_nb > 0)
+		keys << QString("LDN%1").arg(r.LDN_nb);
+	if (r.LBN_nb > 0)
+		keys << QString("LBN%1").arg(r.LBN_nb);
+	if (r.Cr_nb > 0)
+		keys << QString("CR%1").arg(r.Cr_nb);
+	if (r.Mel_nb > 0)
+		keys << QString("MEL%1").arg(r.Mel_nb);
+	if (r.PGC_nb > 0)
+		keys << QString("PGC%1").arg(r.PGC_nb);
+	if (r.UGC_nb > 0)
+		keys << QString("UGC%1").arg(r.UGC_nb);
+	if (r.Arp_nb > 0)
+		keys << QString("ARP%1").arg(r.Arp_nb);
+	if (r.VV_nb > 0)
+		keys << QString("VV%1").arg(r.VV_nb);
+	if (r.Ced_nb)
+		keys << "CED" + designationKey(dsoCatalog.getString(r.Ced_nb));
+	if (r.PK_nb)
+		keys << "PK" + designationKey(dsoCatalog.getString(r.PK_nb));
+	if (r.PNG_nb)
+		keys << "PNG" + designationKey(dsoCatalog.getString(r.PNG_nb));
+	if (r.SNRG_nb)
+		keys << "SNRG" + designationKey(dsoCatalog.getString(r.SNRG_nb));
+	if (r.ACO_nb)
+		keys << "ACO" + designationKey(dsoCatalog.getString(r.ACO_nb));
+
+	// The first record of the catalogue with a designation is found.
+	foreach (const QString& key, keys)
+	{
+		if (!designationIndex.contains(key))
+			designationIndex.insert(key, index);
 	}
-	static QRegExp dCatNumRx("^(SH)\\s*\\d-\\s*(\\d+)$");
-	if (dCatNumRx.exactMatch(uname))
-	{
-		QString dcat = dCatNumRx.capturedTexts().at(1);
-		int dnum = dCatNumRx.capturedTexts().at(2).toInt();
+}
 
-		if (dcat == "SH") return searchSh2(dnum);
+NebulaP NebulaMgr::getDSO(int index) const
+{
+	if (index<0 || index>=dsoArray.size())
+		return NebulaP();
+	NebulaP& n = dsoArray[index];
+	if (n.isNull())
+	{
+		n = NebulaP(new Nebula);
+		n->readDSO(dsoCatalog, index);
 	}
-	static QRegExp sCatNumRx("^(CED|PK|ACO|ABELL)\\s*(.+)$");
-	if (sCatNumRx.exactMatch(uname))
+	return n;
+}
+
+const QVector<NebulaP>& NebulaMgr::getAllDeepSkyObjects() const
+{
+	for (int i=0; i<dsoArray.size(); ++i)
+		getDSO(i);
+	return dsoArray;
+}
+
+QList<NebulaP> NebulaMgr::getDeepSkyObjectsOfTypes(const QList<Nebula::NebulaType>& types) const
+{
+	QList<NebulaP> result;
+	for (int i=0; i<dsoCatalog.size(); ++i)
 	{
-		QString cat = sCatNumRx.capturedTexts().at(1);
-		QString num = sCatNumRx.capturedTexts().at(2).trimmed();
+		if (types.contains(static_cast<Nebula::NebulaType>(dsoCatalog.getRecord(i).type)))
+			result.append(getDSO(i));
+	}
+	return result;
+}
 
-		if (cat == "CED") return searchCed(num);
-		if (cat == "PK") return searchPK(num);
-		if (cat == "ACO" || cat == "ABELL") return searchACO(num);
+// Whether a record has a designation in a catalogue of getDeepSkyObjectsByType().
+// The designations which are strings are offsets in the string table, 0 for none.
+static bool isInCatalog(const DsoCatalog::Record& r, int catalog)
+{
+	switch (catalog)
+	{
+		case 100: return r.M_nb>0;
+		case 101: return r.C_nb>0;
+		case 102: return r.B_nb>0;
+		case 103: return r.Sh2_nb>0;
+		case 104: return r.VdB_nb>0;
+		case 105: return r.RCW_nb>0;
+		case 106: return r.Cr_nb>0;
+		case 107: return r.Mel_nb>0;
+		case 108: return r.NGC_nb>0;
+		case 109: return r.IC_nb>0;
+		case 110: return r.LBN_nb>0;
+		case 111: return r.LDN_nb>0;
+		case 112: return r.PGC_nb>0;
+		case 113: return r.UGC_nb>0;
+		case 114: return r.Ced_nb!=0;
+		case 115: return r.Arp_nb>0;
+		case 116: return r.VV_nb>0;
+		case 117: return r.PK_nb!=0;
+		case 118: return r.PNG_nb!=0;
+		case 119: return r.SNRG_nb!=0;
+		case 120: return r.ACO_nb!=0;
+		default: return false;
 	}
-	static QRegExp gCatNumRx("^(PN|SNR)\\s*G(.+)$");
-	if (gCatNumRx.exactMatch(uname))
-	{
-		QString cat = gCatNumRx.capturedTexts().at(1);
-		QString num = gCatNumRx.capturedTexts().at(2).trimmed();
+}
 
-		if (cat == "PN") return searchPNG(num);
-		if (cat == "SNR") return searchSNRG(num);
+QList<NebulaP> NebulaMgr::getDeepSkyObjectsOfCatalog(int catalog) const
+{
+	QList<NebulaP> result;
+	for (int i=0; i<dsoCatalog.size(); ++i)
+	{
+		if (isInCatalog(dsoCatalog.getRecord(i), catalog))
+			result.append(getDSO(i));
 	}
-	return NebulaP();
+	return result;
+}
+
+QList<NebulaP> NebulaMgr::searchByNames(const QStringList& names, bool inEnglish) const
+{
+	const QHash<QString, NebulaP>& nameIndex = inEnglish ? englishNameIndex : i18nNameIndex;
+	QList<NebulaP> result;
+	result.reserve(names.size());
+	foreach (const QString& name, names)
+		result << searchNameOrDesignation(name, nameIndex);
+	return result;
 }
 
 void NebulaMgr::loadNebulaSet(const QString& setName)
@@ -605,8 +747,11 @@ void NebulaMgr::loadNebulaSet(const QString& setName)
 	QString dsoOutlinesPath		= StelFileMgr::findFile("nebulae/" + setName + "/outlines.dat");
 
 	dsoArray.clear();
+	dsoCatalog.clear();
 	dsoIndex.clear();
-	nebGrid.clear();
+	designationIndex.clear();
+	englishNameIndex.clear();
+	i18nNameIndex.clear();
 
 	if (flagConverter)
 	{
@@ -634,41 +779,60 @@ NebulaP NebulaMgr::search(const Vec3d& apos)
 {
 	Vec3d pos = apos;
 	pos.normalize();
-	NebulaP plusProche;
+	int plusProche = -1;
 	float anglePlusProche=0.0f;
-	foreach (const NebulaP& n, dsoArray)
+	for (int i=0; i<dsoCatalog.size(); ++i)
 	{
-		if (n->XYZ*pos>anglePlusProche)
+		const DsoCatalog::Record& r = dsoCatalog.getRecord(i);
+		const float cosAngle = r.pos[0]*pos[0] + r.pos[1]*pos[1] + r.pos[2]*pos[2];
+		if (cosAngle>anglePlusProche)
 		{
-			anglePlusProche=n->XYZ*pos;
-			plusProche=n;
+			anglePlusProche=cosAngle;
+			plusProche=i;
 		}
 	}
 	if (anglePlusProche>0.999f)
 	{
-		return plusProche;
+		return getDSO(plusProche);
 	}
 	else return NebulaP();
 }
 
 
-QList<StelObjectP> NebulaMgr::searchAround(const Vec3d& av, double limitFov, const StelCore*) const
+QList<StelObjectP> NebulaMgr::searchAround(const Vec3d& av, double limitFov, const StelCore* core) const
 {
 	QList<StelObjectP> result;
-	if (!getFlagShow())
+	if (!getFlagShow() || !dsoCatalog.isLoaded())
 		return result;
 
 	Vec3d v(av);
 	v.normalize();
 	double cosLimFov = cos(limitFov * M_PI/180.);
+
+	// Only the records of the zones around v are tested, and only the Nebula objects found are created.
+	QVector<SphericalCap> caps;
+	caps.append(SphericalCap(v, cosLimFov));
+	const int zoneLevel = dsoCatalog.getZoneLevel();
+	const GeodesicSearchResult* searchResult = core->getGeodesicGrid(zoneLevel)->search(caps, zoneLevel);
+	QVector<int> zones;
+	int zone;
+	for (GeodesicSearchInsideIterator it(*searchResult, zoneLevel); (zone = it.next()) >= 0;)
+		zones.append(zone);
+	for (GeodesicSearchBorderIterator it(*searchResult, zoneLevel); (zone = it.next()) >= 0;)
+		zones.append(zone);
 	Vec3d equPos;
-	foreach (const NebulaP& n, dsoArray)
+	foreach (int z, zones)
 	{
-		equPos = n->XYZ;
-		equPos.normalize();
-		if (equPos*v>=cosLimFov)
+		for (int j=dsoCatalog.getZoneBegin(z); j<dsoCatalog.getZoneEnd(z); ++j)
 		{
-			result.push_back(qSharedPointerCast<StelObject>(n));
+			const int i = dsoCatalog.getZoneRecord(j);
+			const DsoCatalog::Record& r = dsoCatalog.getRecord(i);
+			equPos.set(r.pos[0], r.pos[1], r.pos[2]);
+			equPos.normalize();
+			if (equPos*v>=cosLimFov)
+			{
+				result.push_back(qSharedPointerCast<StelObject>(getDSO(i)));
+			}
 		}
 	}
 	return result;
@@ -676,178 +840,113 @@ QList<StelObjectP> NebulaMgr::searchAround(const Vec3d& av, double limitFov, con
 
 NebulaP NebulaMgr::searchDSO(unsigned int DSO)
 {
-	if (dsoIndex.contains(DSO))
-		return dsoIndex[DSO];
-	return NebulaP();
+	return getDSO(dsoIndex.value(DSO, -1));
 }
 
 
 NebulaP NebulaMgr::searchM(unsigned int M)
 {
-	foreach (const NebulaP& n, dsoArray)
-		if (n->M_nb == M)
-			return n;
-	return NebulaP();
+	return getDSO(designationIndex.value(QString("M%1").arg(M), -1));
 }
 
 NebulaP NebulaMgr::searchNGC(unsigned int NGC)
 {
-	foreach (const NebulaP& n, dsoArray)
-		if (n->NGC_nb == NGC)
-			return n;
-	return NebulaP();
+	return getDSO(designationIndex.value(QString("NGC%1").arg(NGC), -1));
 }
 
 NebulaP NebulaMgr::searchIC(unsigned int IC)
 {
-	foreach (const NebulaP& n, dsoArray)
-		if (n->IC_nb == IC)
-			return n;
-	return NebulaP();
+	return getDSO(designationIndex.value(QString("IC%1").arg(IC), -1));
 }
 
 NebulaP NebulaMgr::searchC(unsigned int C)
 {
-	foreach (const NebulaP& n, dsoArray)
-		if (n->C_nb == C)
-			return n;
-	return NebulaP();
+	return getDSO(designationIndex.value(QString("C%1").arg(C), -1));
 }
 
 NebulaP NebulaMgr::searchB(unsigned int B)
 {
-	foreach (const NebulaP& n, dsoArray)
-		if (n->B_nb == B)
-			return n;
-	return NebulaP();
+	return getDSO(designationIndex.value(QString("B%1").arg(B), -1));
 }
 
 NebulaP NebulaMgr::searchSh2(unsigned int Sh2)
 {
-	foreach (const NebulaP& n, dsoArray)
-		if (n->Sh2_nb == Sh2)
-			return n;
-	return NebulaP();
+	return getDSO(designationIndex.value(QString("SH2-%1").arg(Sh2), -1));
 }
 
 NebulaP NebulaMgr::searchVdB(unsigned int VdB)
 {
-	foreach (const NebulaP& n, dsoArray)
-		if (n->VdB_nb == VdB)
-			return n;
-	return NebulaP();
+	return getDSO(designationIndex.value(QString("VDB%1").arg(VdB), -1));
 }
 
 NebulaP NebulaMgr::searchRCW(unsigned int RCW)
 {
-	foreach (const NebulaP& n, dsoArray)
-		if (n->RCW_nb == RCW)
-			return n;
-	return NebulaP();
+	return getDSO(designationIndex.value(QString("RCW%1").arg(RCW), -1));
 }
 
 NebulaP NebulaMgr::searchLDN(unsigned int LDN)
 {
-	foreach (const NebulaP& n, dsoArray)
-		if (n->LDN_nb == LDN)
-			return n;
-	return NebulaP();
+	return getDSO(designationIndex.value(QString("LDN%1").arg(LDN), -1));
 }
 
 NebulaP NebulaMgr::searchLBN(unsigned int LBN)
 {
-	foreach (const NebulaP& n, dsoArray)
-		if (n->LBN_nb == LBN)
-			return n;
-	return NebulaP();
+	return getDSO(designationIndex.value(QString("LBN%1").arg(LBN), -1));
 }
 
 NebulaP NebulaMgr::searchCr(unsigned int Cr)
 {
-	foreach (const NebulaP& n, dsoArray)
-		if (n->Cr_nb == Cr)
-			return n;
-	return NebulaP();
+	return getDSO(designationIndex.value(QString("CR%1").arg(Cr), -1));
 }
 
 NebulaP NebulaMgr::searchMel(unsigned int Mel)
 {
-	foreach (const NebulaP& n, dsoArray)
-		if (n->Mel_nb == Mel)
-			return n;
-	return NebulaP();
+	return getDSO(designationIndex.value(QString("MEL%1").arg(Mel), -1));
 }
 
 NebulaP NebulaMgr::searchPGC(unsigned int PGC)
 {
-	foreach (const NebulaP& n, dsoArray)
-		if (n->PGC_nb == PGC)
-			return n;
-	return NebulaP();
+	return getDSO(designationIndex.value(QString("PGC%1").arg(PGC), -1));
 }
 
 NebulaP NebulaMgr::searchUGC(unsigned int UGC)
 {
-	foreach (const NebulaP& n, dsoArray)
-		if (n->UGC_nb == UGC)
-			return n;
-	return NebulaP();
+	return getDSO(designationIndex.value(QString("UGC%1").arg(UGC), -1));
 }
 
 NebulaP NebulaMgr::searchCed(QString Ced)
 {
-	foreach (const NebulaP& n, dsoArray)
-		if (n->Ced_nb.trimmed().toUpper() == Ced.trimmed().toUpper())
-			return n;
-	return NebulaP();
+	return getDSO(designationIndex.value("CED" + designationKey(Ced), -1));
 }
 
 NebulaP NebulaMgr::searchArp(unsigned int Arp)
 {
-	foreach (const NebulaP& n, dsoArray)
-		if (n->Arp_nb == Arp)
-			return n;
-	return NebulaP();
+	return getDSO(designationIndex.value(QString("ARP%1").arg(Arp), -1));
 }
 
 NebulaP NebulaMgr::searchVV(unsigned int VV)
 {
-	foreach (const NebulaP& n, dsoArray)
-		if (n->VV_nb == VV)
-			return n;
-	return NebulaP();
+	return getDSO(designationIndex.value(QString("VV%1").arg(VV), -1));
 }
 
 NebulaP NebulaMgr::searchPK(QString PK)
 {
-	foreach (const NebulaP& n, dsoArray)
-		if (n->PK_nb.trimmed().toUpper() == PK.trimmed().toUpper())
-			return n;
-	return NebulaP();
+	return getDSO(designationIndex.value("PK" + designationKey(PK), -1));
 }
 
 NebulaP NebulaMgr::searchPNG(QString PNG)
 {
-	foreach (const NebulaP& n, dsoArray)
-		if (n->PNG_nb.trimmed().toUpper() == PNG.trimmed().toUpper())
-			return n;
-	return NebulaP();
+	return getDSO(designationIndex.value("PNG" + designationKey(PNG), -1));
 }
 
 NebulaP NebulaMgr::searchSNRG(QString SNRG)
 {
-	foreach (const NebulaP& n, dsoArray)
-		if (n->SNRG_nb.trimmed().toUpper() == SNRG.trimmed().toUpper())
-			return n;
-	return NebulaP();
+	return getDSO(designationIndex.value("SNRG" + designationKey(SNRG), -1));
 }
 
 NebulaP NebulaMgr::searchACO(QString ACO)
 {
-	foreach (const NebulaP& n, dsoArray)
-		if (n->ACO_nb.trimmed().toUpper() == ACO.trimmed().toUpper())
-			return n;
-	return NebulaP();
+	return getDSO(designationIndex.value("ACO" + designationKey(ACO), -1));
 }
 
 QString NebulaMgr::getLatestSelectedDSODesignation()
@@ -1187,50 +1286,40 @@ void NebulaMgr::convertDSOCatalog(const QString &in, const QString &out, bool de
 
 bool NebulaMgr::loadDSOCatalog(const QString &filename)
 {
-	QFile in(filename);
-	if (!in.open(QIODevice::ReadOnly))
-		return false;
-
-	qDebug() << "Loading DSO data ...";
+	QElapsedTimer timer;
+	timer.start();
 
-	// Let's begin use gzipped data
-	QDataStream ins(StelUtils::uncompress(in.readAll()));
-	ins.setVersion(QDataStream::Qt_5_2);
-
-	QString version = "", edition= "";
-	int totalRecords=0;
-	while (!ins.atEnd())
+	// The memory-mapped catalogue is a cache of catalog.dat in the user directory, one per source path.
+	const QFileInfo sourceInfo(filename);
+	const QString catalogDir = StelFileMgr::getUserDir()+"/data";
+	const QString catalogPath = QString("%1/dso-%2.cat").arg(catalogDir)
+				    .arg(qHash(sourceInfo.absoluteFilePath()), 8, 16, QChar('0'));
+	const bool upToDate = QFileInfo(catalogPath).exists() && dsoCatalog.load(catalogPath)
+			      && dsoCatalog.isImportOf(filename, StellariumDSOCatalogVersion);
+	if (!upToDate)
 	{
-		if (totalRecords==0) // Read the version of catalog
-		{
-			ins >> version >> edition;
-			if (version.isEmpty())
-				version = "3.1"; // The first version of extended edition of the catalog
-			if (edition.isEmpty())
-				edition = "unknown";
-			qDebug() << "[...]" << QString("Stellarium DSO Catalog, version %1 (%2 edition)").arg(version).arg(edition);
-			if (StelUtils::compareVersions(version, StellariumDSOCatalogVersion)!=0)
-			{
-				qDebug() << "WARNING: Mismatch the version of catalog! The expected version of catalog is" << StellariumDSOCatalogVersion;
-				++totalRecords;
-				break;
-			}
-		}
-		else
+		qDebug() << "Importing DSO data ...";
+		dsoCatalog.clear();
+		QDir().mkpath(catalogDir);
+		if (!DsoCatalog::importDat(filename, catalogPath, StellariumDSOCatalogVersion) || !dsoCatalog.load(catalogPath))
 		{
-			// Create a new Nebula record
-			NebulaP e = NebulaP(new Nebula);
-			e->readDSO(ins);
-
-			dsoArray.append(e);
-			nebGrid.insert(qSharedPointerCast<StelRegionObject>(e));
-			if (e->DSO_nb!=0)
-				dsoIndex.insert(e->DSO_nb, e);
+			QFile::remove(catalogPath);
+			return false;
 		}
-		++totalRecords;
+		qDebug() << "Imported" << QDir::toNativeSeparators(filename) << "in" << timer.elapsed() << "ms";
+	}
+
+	qDebug() << "Loading DSO data ...";
+	// The Nebula objects are created when needed, see getDSO().
+	dsoArray.fill(NebulaP(), dsoCatalog.size());
+	for (int i=0; i<dsoCatalog.size(); ++i)
+	{
+		const DsoCatalog::Record& r = dsoCatalog.getRecord(i);
+		if (r.DSO_nb!=0)
+			dsoIndex.insert(r.DSO_nb, i);
+		indexDesignations(i);
 	}
-	in.close();
-	qDebug() << "Loaded" << --totalRecords << "DSO records";
+	qDebug() << "Loaded" << dsoCatalog.size() << "DSO records";
 	return true;
 }
 
@@ -1464,7 +1553,10 @@ void NebulaMgr::updateSkyCulture(const QString& skyCultureDir)
 	QString namesFile = StelFileMgr::findFile("skycultures/" + skyCultureDir + "/dso_names.fab");
 
 	foreach (const NebulaP& n, dsoArray)
-		n->removeAllNames();
+	{
+		if (!n.isNull())
+			n->removeAllNames();
+	}
 
 	if (namesFile.isEmpty())
 	{
@@ -1537,975 +1629,156 @@ void NebulaMgr::updateSkyCulture(const QString& skyCultureDir)
 void NebulaMgr::updateI18n()
 {
 	const StelTranslator& trans = StelApp::getInstance().getLocaleMgr().getSkyTranslator();
+	// Only the Nebula objects already created can have a name.
 	foreach (NebulaP n, dsoArray)
-		n->translateName(trans);
-}
-
-
-//! Return the matching Nebula object's pointer if exists or an "empty" StelObjectP
-StelObjectP NebulaMgr::searchByNameI18n(const QString& nameI18n) const
-{
-	QString objw = nameI18n.toUpper();
-
-	// Search by NGC numbers (possible formats are "NGC31" or "NGC 31")
-	if (objw.left(3) == "NGC")
 	{
-		foreach (const NebulaP& n, dsoArray)
-		{
-			if (QString("NGC%1").arg(n->NGC_nb) == objw || QString("NGC %1").arg(n->NGC_nb) == objw)
-				return qSharedPointerCast<StelObject>(n);
-		}
+		if (!n.isNull())
+			n->translateName(trans);
 	}
 
-	// Search by common names
+	// Common names take precedence over the aliases.
+	englishNameIndex.clear();
+	i18nNameIndex.clear();
 	foreach (const NebulaP& n, dsoArray)
 	{
-		QString objwcap = n->nameI18.toUpper();
-		if (objwcap==objw)
-			return qSharedPointerCast<StelObject>(n);
+		if (n.isNull() || n->englishName.isEmpty())
+			continue;
+		const QString englishName = n->englishName.toUpper();
+		if (!englishNameIndex.contains(englishName))
+			englishNameIndex.insert(englishName, n);
+		const QString nameI18n = n->nameI18.toUpper();
+		if (!i18nNameIndex.contains(nameI18n))
+			i18nNameIndex.insert(nameI18n, n);
 	}
-
-	// Search by aliases of common names
 	foreach (const NebulaP& n, dsoArray)
 	{
-		foreach(QString objwcapa, n->nameI18Aliases)
-		{
-			if (objwcapa.toUpper()==objw)
-				return qSharedPointerCast<StelObject>(n);
-		}
-	}
-
-	// Search by IC numbers (possible formats are "IC466" or "IC 466")
-	if (objw.left(2) == "IC")
-	{
-		foreach (const NebulaP& n, dsoArray)
-		{
-			if (QString("IC%1").arg(n->IC_nb) == objw || QString("IC %1").arg(n->IC_nb) == objw)
-				return qSharedPointerCast<StelObject>(n);
-		}
-	}
-
-
-	// Search by Messier numbers (possible formats are "M31" or "M 31")
-	if (objw.left(1) == "M" && objw.left(3) != "MEL")
-	{
-		foreach (const NebulaP& n, dsoArray)
-		{
-			if (QString("M%1").arg(n->M_nb) == objw || QString("M %1").arg(n->M_nb) == objw)
-				return qSharedPointerCast<StelObject>(n);
-		}
-	}
-
-	// Search by Caldwell numbers (possible formats are "C31" or "C 31")
-	if (objw.left(1) == "C" && objw.left(2) != "CR" && objw.left(3) != "CED")
-	{
-		foreach (const NebulaP& n, dsoArray)
-		{
-			if (QString("C%1").arg(n->C_nb) == objw || QString("C %1").arg(n->C_nb) == objw)
-				return qSharedPointerCast<StelObject>(n);
-		}
-	}
-
-	// Search by Barnard numbers (possible formats are "B31" or "B 31")
-	if (objw.left(1) == "B")
-	{
-		foreach (const NebulaP& n, dsoArray)
-		{
-			if (QString("B%1").arg(n->B_nb) == objw || QString("B %1").arg(n->B_nb) == objw)
-				return qSharedPointerCast<StelObject>(n);
-		}
-	}
-
-	// Search by Sharpless numbers (possible formats are "Sh2-31" or "Sh 2-31")
-	if (objw.left(2) == "SH")
-	{
-		foreach (const NebulaP& n, dsoArray)
-		{
-			if (QString("SH2-%1").arg(n->Sh2_nb) == objw || QString("SH 2-%1").arg(n->Sh2_nb) == objw)
-				return qSharedPointerCast<StelObject>(n);
-		}
-	}
-
-	// Search by Van den Bergh numbers (possible formats are "VdB31" or "VdB 31")
-	if (objw.left(3) == "VDB")
-	{
-		foreach (const NebulaP& n, dsoArray)
-		{
-			if (QString("VDB%1").arg(n->VdB_nb) == objw || QString("VDB %1").arg(n->VdB_nb) == objw)
-				return qSharedPointerCast<StelObject>(n);
-		}
-	}
-
-	// Search by RCW numbers (possible formats are "RCW31" or "RCW 31")
-	if (objw.left(3) == "RCW")
-	{
-		foreach (const NebulaP& n, dsoArray)
-		{
-			if (QString("RCW%1").arg(n->RCW_nb) == objw || QString("RCW %1").arg(n->RCW_nb) == objw)
-				return qSharedPointerCast<StelObject>(n);
-		}
-	}
-
-	// Search by LDN numbers (possible formats are "LDN31" or "LDN 31")
-	if (objw.left(3) == "LDN")
-	{
-		foreach (const NebulaP& n, dsoArray)
-		{
-			if (QString("LDN%1").arg(n->LDN_nb) == objw || QString("LDN %1").arg(n->LDN_nb) == objw)
-				return qSharedPointerCast<StelObject>(n);
-		}
-	}
-
-	// Search by LBN numbers (possible formats are "LBN31" or "LBN 31")
-	if (objw.left(3) == "LBN")
-	{
-		foreach (const NebulaP& n, dsoArray)
-		{
-			if (QString("LBN%1").arg(n->LBN_nb) == objw || QString("LBN %1").arg(n->LBN_nb) == objw)
-				return qSharedPointerCast<StelObject>(n);
-		}
-	}
-
-	// Search by Collinder numbers (possible formats are "Cr31" or "Cr 31")
-	if (objw.left(2) == "CR")
-	{
-		foreach (const NebulaP& n, dsoArray)
-		{
-			if (QString("CR%1").arg(n->Cr_nb) == objw || QString("CR %1").arg(n->Cr_nb) == objw)
-				return qSharedPointerCast<StelObject>(n);
-		}
-	}
-
-	// Search by Melotte numbers (possible formats are "Mel31" or "Mel 31")
-	if (objw.left(3) == "MEL")
-	{
-		foreach (const NebulaP& n, dsoArray)
-		{
-			if (QString("MEL%1").arg(n->Mel_nb) == objw || QString("MEL %1").arg(n->Mel_nb) == objw)
-				return qSharedPointerCast<StelObject>(n);
-		}
-	}
-
-	// Search by PGC numbers (possible formats are "PGC31" or "PGC 31")
-	if (objw.left(3) == "PGC")
-	{
-		foreach (const NebulaP& n, dsoArray)
-		{
-			if (QString("PGC%1").arg(n->PGC_nb) == objw || QString("PGC %1").arg(n->PGC_nb) == objw)
-				return qSharedPointerCast<StelObject>(n);
-		}
-	}
-
-	// Search by UGC numbers (possible formats are "UGC31" or "UGC 31")
-	if (objw.left(3) == "UGC")
-	{
-		foreach (const NebulaP& n, dsoArray)
-		{
-			if (QString("UGC%1").arg(n->UGC_nb) == objw || QString("UGC %1").arg(n->UGC_nb) == objw)
-				return qSharedPointerCast<StelObject>(n);
-		}
-	}
-
-	// Search by Arp numbers (possible formats are "ARP31" or "ARP 31")
-	if (objw.left(3) == "ARP")
-	{
-		foreach (const NebulaP& n, dsoArray)
-		{
-			if (QString("ARP%1").arg(n->Arp_nb) == objw || QString("ARP %1").arg(n->Arp_nb) == objw)
-				return qSharedPointerCast<StelObject>(n);
-		}
-	}
-
-	// Search by VV numbers (possible formats are "VV31" or "VV 31")
-	if (objw.left(2) == "VV")
-	{
-		foreach (const NebulaP& n, dsoArray)
-		{
-			if (QString("VV%1").arg(n->VV_nb) == objw || QString("VV %1").arg(n->VV_nb) == objw)
-				return qSharedPointerCast<StelObject>(n);
-		}
-	}
-
-	// Search by Cederblad numbers (possible formats are "Ced31" or "Ced 31")
-	if (objw.left(3) == "CED")
-	{
-		foreach (const NebulaP& n, dsoArray)
+		if (n.isNull())
+			continue;
+		foreach (const QString& alias, n->englishAliases)
 		{
-			if (QString("CED%1").arg(n->Ced_nb.trimmed().toUpper()) == objw.trimmed() || QString("CED %1").arg(n->Ced_nb.trimmed().toUpper()) == objw.trimmed())
-				return qSharedPointerCast<StelObject>(n);
+			if (!englishNameIndex.contains(alias.toUpper()))
+				englishNameIndex.insert(alias.toUpper(), n);
 		}
-	}
-
-	// Search by PK numbers
-	if (objw.left(2) == "PK")
-	{
-		foreach (const NebulaP& n, dsoArray)
+		foreach (const QString& alias, n->nameI18Aliases)
 		{
-			if (QString("PK%1").arg(n->PK_nb.trimmed().toUpper()) == objw.trimmed() || QString("PK %1").arg(n->PK_nb.trimmed().toUpper()) == objw.trimmed())
-				return qSharedPointerCast<StelObject>(n);
+			if (!i18nNameIndex.contains(alias.toUpper()))
+				i18nNameIndex.insert(alias.toUpper(), n);
 		}
 	}
 
-	// Search by PN G numbers
-	if (objw.left(2) == "PN")
-	{
-		foreach (const NebulaP& n, dsoArray)
-		{
-			if (QString("PNG%1").arg(n->PNG_nb.trimmed().toUpper()) == objw.trimmed() || QString("PN G%1").arg(n->PNG_nb.trimmed().toUpper()) == objw.trimmed())
-				return qSharedPointerCast<StelObject>(n);
-		}
-	}
+	updateNameIndex();
+}
 
-	// Search by SNR G numbers
-	if (objw.left(3) == "SNR")
+void NebulaMgr::updateNameIndex()
+{
+	typedef StelObjectNameIndex::Name Name;
+	QVector<Name> names;
+	names.reserve(3*dsoArray.size());
+	// Only the Nebula objects already created can have a name.
+	foreach (const NebulaP& n, dsoArray)
 	{
-		foreach (const NebulaP& n, dsoArray)
-		{
-			if (QString("SNRG%1").arg(n->SNRG_nb.trimmed().toUpper()) == objw.trimmed() || QString("SNR G%1").arg(n->SNRG_nb.trimmed().toUpper()) == objw.trimmed())
-				return qSharedPointerCast<StelObject>(n);
-		}
-	}
+		if (n.isNull())
+			continue;
+		if (!n->englishName.isEmpty())
+		{
+			names << Name(n->englishName, StelObjectNameIndex::EnglishName, 1);
+			names << Name(n->nameI18, StelObjectNameIndex::TranslatedName, 1);
+		}
+		foreach (const QString& alias, n->englishAliases)
+			names << Name(alias, StelObjectNameIndex::EnglishName, 1);
+		foreach (const QString& alias, n->nameI18Aliases)
+			names << Name(alias, StelObjectNameIndex::TranslatedName, 1);
+	}
+
+	// Designations, ranked by the popularity of the catalogues, read from the records without creating the Nebula objects
+	for (int i=0; i<dsoCatalog.size(); ++i)
+	{
+		const DsoCatalog::Record& r = dsoCatalog.getRecord(i);
+		if (r.M_nb > 0)
+			names << Name(QString("M %1").arg(r.M_nb), StelObjectNameIndex::Designation, 2);
+		if (r.NGC_nb > 0)
+			names << Name(QString("NGC %1").arg(r.NGC_nb), StelObjectNameIndex::Designation, 3);
+		if (r.IC_nb > 0)
+			names << Name(QString("IC %1").arg(r.IC_nb), StelObjectNameIndex::Designation, 3);
+		if (r.C_nb > 0)
+			names << Name(QString("C %1").arg(r.C_nb), StelObjectNameIndex::Designation, 3);
+		if (r.B_nb > 0)
+			names << Name(QString("B %1").arg(r.B_nb), StelObjectNameIndex::Designation, 4);
+		if (r.Sh2_nb > 0)
+			names << Name(QString("SH 2-%1").arg(r.Sh2_nb), StelObjectNameIndex::Designation, 4);
+		if (r.VdB_nb > 0)
+			names << Name(QString("VdB %1").arg(r.VdB_nb), StelObjectNameIndex::Designation, 4);
+		if (r.RCW_nb > 0)
+			names << Name(QString("RCW %1").arg(r.RCW_nb), StelObjectNameIndex::Designation, 4);
+		if (r.LDN_nb > 0)
+			names << Name(QString("LDN %1").arg(r.LDN_nb), StelObjectNameIndex::Designation, 4);
+		if (r.LBN_nb > 0)
+			names << Name(QString("LBN %1").arg(r.LBN_nb), StelObjectNameIndex::Designation, 4);
+		if (r.Cr_nb > 0)
+			names << Name(QString("Cr %1").arg(r.Cr_nb), StelObjectNameIndex::Designation, 4);
+		if (r.Mel_nb > 0)
+			names << Name(QString("Mel %1").arg(r.Mel_nb), StelObjectNameIndex::Designation, 4);
+		if (r.Arp_nb > 0)
+			names << Name(QString("Arp %1").arg(r.Arp_nb), StelObjectNameIndex::Designation, 4);
+		if (r.VV_nb > 0)
+			names << Name(QString("VV %1").arg(r.VV_nb), StelObjectNameIndex::Designation, 4);
+		if (r.Ced_nb)
+			names << Name(QString("Ced %1").arg(dsoCatalog.getString(r.Ced_nb).trimmed()), StelObjectNameIndex::Designation, 4);
+		if (r.PK_nb)
+			names << Name(QString("PK %1").arg(dsoCatalog.getString(r.PK_nb).trimmed()), StelObjectNameIndex::Designation, 4);
+		if (r.PNG_nb)
+			names << Name(QString("PN G%1").arg(dsoCatalog.getString(r.PNG_nb).trimmed()), StelObjectNameIndex::Designation, 4);
+		if (r.SNRG_nb)
+			names << Name(QString("SNR G%1").arg(dsoCatalog.getString(r.SNRG_nb).trimmed()), StelObjectNameIndex::Designation, 4);
+		if (r.ACO_nb)
+			names << Name(QString("ACO %1").arg(dsoCatalog.getString(r.ACO_nb).trimmed()), StelObjectNameIndex::Designation, 4);
+		if (r.PGC_nb > 0)
+			names << Name(QString("PGC %1").arg(r.PGC_nb), StelObjectNameIndex::Designation, 5);
+		if (r.UGC_nb > 0)
+			names << Name(QString("UGC %1").arg(r.UGC_nb), StelObjectNameIndex::Designation, 5);
+	}
+	StelApp::getInstance().getStelObjectMgr().getNameIndex().setNames(this, names);
+}
 
-	// Search by ACO numbers (possible formats are "ACO31", "ACO 31", "Abell31" or "Abell 31")
-	if (objw.left(2) == "ACO" || objw.left(5) == "ABELL")
-	{
-		foreach (const NebulaP& n, dsoArray)
-		{
-			if (QString("ACO%1").arg(n->ACO_nb.trimmed().toUpper()) == objw.trimmed()
-			|| QString("ACO %1").arg(n->ACO_nb.trimmed().toUpper()) == objw.trimmed()
-			|| QString("ABELL%1").arg(n->ACO_nb.trimmed().toUpper()) == objw.trimmed()
-			|| QString("ABELL %1").arg(n->ACO_nb.trimmed().toUpper()) == objw.trimmed())
-				return qSharedPointerCast<StelObject>(n);
-		}
-	}
 
-	return StelObjectP();
+//! Return the matching Nebula object's pointer if exists or an "empty" StelObjectP
+StelObjectP NebulaMgr::searchByNameI18n(const QString& nameI18n) const
+{
+	return qSharedPointerCast<StelObject>(searchNameOrDesignation(nameI18n, i18nNameIndex));
 }
 
-
-//! Return the matching Nebula object's pointer if exists or Q_NULLPTR
-//! TODO split common parts of this and I18 fn above into a separate fn.
-//! TODO Decide whether empty StelObjectP or Q_NULLPTR is the better return type and select the same for both.
+//! Return the matching Nebula object's pointer if exists or an "empty" StelObjectP
 StelObjectP NebulaMgr::searchByName(const QString& name) const
 {
-	QString objw = name.toUpper();
+	return qSharedPointerCast<StelObject>(searchNameOrDesignation(name, englishNameIndex));
+}
 
-	// Search by NGC numbers (possible formats are "NGC31" or "NGC 31")
-	if (objw.startsWith("NGC"))
+QStringList NebulaMgr::listAllObjects(bool inEnglish) const
+{
+	QStringList result;
+	// Only the objects with a name are listed. They were all created when their names were loaded,
+	// so that the null pointers of dsoArray are skipped without creating the other objects.
+	foreach(const NebulaP& n, dsoArray)
 	{
-		foreach (const NebulaP& n, dsoArray)
+		if (!n.isNull() && !n->getEnglishName().isEmpty())
 		{
-			if (QString("NGC%1").arg(n->NGC_nb) == objw || QString("NGC %1").arg(n->NGC_nb) == objw)
-				return qSharedPointerCast<StelObject>(n);
+			if (inEnglish)
+				result << n->getEnglishName();
+			else
+				result << n->getNameI18n();
 		}
 	}
+	return result;
+}
 
-	// Search by common names
-	foreach (const NebulaP& n, dsoArray)
-	{
-		QString objwcap = n->englishName.toUpper();
-		if (objwcap==objw)
-			return qSharedPointerCast<StelObject>(n);
-	}
-
-	// Search by aliases of common names
-	foreach (const NebulaP& n, dsoArray)
-	{
-		foreach(QString objwcapa, n->englishAliases)
-		{
-			if (objwcapa.toUpper()==objw)
-				return qSharedPointerCast<StelObject>(n);
-		}
-	}
-
-	// Search by IC numbers (possible formats are "IC466" or "IC 466")
-	if (objw.startsWith("IC"))
-	{
-		foreach (const NebulaP& n, dsoArray)
-		{
-			if (QString("IC%1").arg(n->IC_nb) == objw || QString("IC %1").arg(n->IC_nb) == objw)
-				return qSharedPointerCast<StelObject>(n);
-		}
-	}
-
-	// Search by Messier numbers (possible formats are "M31" or "M 31")
-	if (objw.startsWith("M") && !objw.startsWith("ME"))
-	{
-		foreach (const NebulaP& n, dsoArray)
-		{
-			if (QString("M%1").arg(n->M_nb) == objw || QString("M %1").arg(n->M_nb) == objw)
-				return qSharedPointerCast<StelObject>(n);
-		}
-	}
-
-	// Search by Caldwell numbers (possible formats are "C31" or "C 31")
-	if (objw.startsWith("C") && !objw.startsWith("CR") && !objw.startsWith("CE"))
-	{
-		foreach (const NebulaP& n, dsoArray)
-		{
-			if (QString("C%1").arg(n->C_nb) == objw || QString("C %1").arg(n->C_nb) == objw)
-				return qSharedPointerCast<StelObject>(n);
-		}
-	}
-
-	// Search by Barnard numbers (possible formats are "B31" or "B 31")
-	if (objw.startsWith("B"))
-	{
-		foreach (const NebulaP& n, dsoArray)
-		{
-			if (QString("B%1").arg(n->B_nb) == objw || QString("B %1").arg(n->B_nb) == objw)
-				return qSharedPointerCast<StelObject>(n);
-		}
-	}
-
-	// Search by Sharpless numbers (possible formats are "Sh2-31" or "Sh 2-31")
-	if (objw.startsWith("SH"))
-	{
-		foreach (const NebulaP& n, dsoArray)
-		{
-			if (QString("SH2-%1").arg(n->Sh2_nb) == objw || QString("SH 2-%1").arg(n->Sh2_nb) == objw)
-				return qSharedPointerCast<StelObject>(n);
-		}
-	}
-
-	// Search by Van den Bergh numbers (possible formats are "VdB31" or "VdB 31")
-	if (objw.startsWith("VDB"))
-	{
-		foreach (const NebulaP& n, dsoArray)
-		{
-			if (QString("VDB%1").arg(n->VdB_nb) == objw || QString("VDB %1").arg(n->VdB_nb) == objw)
-				return qSharedPointerCast<StelObject>(n);
-		}
-	}
-
-	// Search by RCW numbers (possible formats are "RCW31" or "RCW 31")
-	if (objw.startsWith("RCW"))
-	{
-		foreach (const NebulaP& n, dsoArray)
-		{
-			if (QString("RCW%1").arg(n->RCW_nb) == objw || QString("RCW %1").arg(n->RCW_nb) == objw)
-				return qSharedPointerCast<StelObject>(n);
-		}
-	}
-
-	// Search by LDN numbers (possible formats are "LDN31" or "LDN 31")
-	if (objw.startsWith("LDN"))
-	{
-		foreach (const NebulaP& n, dsoArray)
-		{
-			if (QString("LDN%1").arg(n->LDN_nb) == objw || QString("LDN %1").arg(n->LDN_nb) == objw)
-				return qSharedPointerCast<StelObject>(n);
-		}
-	}
-
-	// Search by LBN numbers (possible formats are "LBN31" or "LBN 31")
-	if (objw.startsWith("LBN"))
-	{
-		foreach (const NebulaP& n, dsoArray)
-		{
-			if (QString("LBN%1").arg(n->LBN_nb) == objw || QString("LBN %1").arg(n->LBN_nb) == objw)
-				return qSharedPointerCast<StelObject>(n);
-		}
-	}
-
-	// Search by Collinder numbers (possible formats are "Cr31" or "Cr 31")
-	if (objw.startsWith("CR") || objw.startsWith("COL"))
-	{
-		foreach (const NebulaP& n, dsoArray)
-		{
-			if (QString("CR%1").arg(n->Cr_nb) == objw || QString("CR %1").arg(n->Cr_nb) == objw)
-				return qSharedPointerCast<StelObject>(n);
-		}
-	}
-
-	// Search by Melotte numbers (possible formats are "Mel31" or "Mel 31")
-	if (objw.startsWith("MEL"))
-	{
-		foreach (const NebulaP& n, dsoArray)
-		{
-			if (QString("MEL%1").arg(n->Mel_nb) == objw || QString("MEL %1").arg(n->Mel_nb) == objw)
-				return qSharedPointerCast<StelObject>(n);
-		}
-	}
-
-	// Search by PGC numbers (possible formats are "PGC31" or "PGC 31")
-	if (objw.startsWith("PGC"))
-	{
-		foreach (const NebulaP& n, dsoArray)
-		{
-			if (QString("PGC%1").arg(n->PGC_nb) == objw || QString("PGC %1").arg(n->PGC_nb) == objw)
-				return qSharedPointerCast<StelObject>(n);
-		}
-	}
-
-	// Search by UGC numbers (possible formats are "UGC31" or "UGC 31")
-	if (objw.startsWith("UGC"))
-	{
-		foreach (const NebulaP& n, dsoArray)
-		{
-			if (QString("UGC%1").arg(n->UGC_nb) == objw || QString("UGC %1").arg(n->UGC_nb) == objw)
-				return qSharedPointerCast<StelObject>(n);
-		}
-	}
-
-	// Search by Arp numbers (possible formats are "Arp31" or "Arp 31")
-	if (objw.startsWith("ARP"))
-	{
-		foreach (const NebulaP& n, dsoArray)
-		{
-			if (QString("ARP%1").arg(n->Arp_nb) == objw || QString("ARP %1").arg(n->Arp_nb) == objw)
-				return qSharedPointerCast<StelObject>(n);
-		}
-	}
-
-	// Search by VV numbers (possible formats are "VV31" or "VV 31")
-	if (objw.startsWith("VV"))
-	{
-		foreach (const NebulaP& n, dsoArray)
-		{
-			if (QString("VV%1").arg(n->VV_nb) == objw || QString("VV %1").arg(n->VV_nb) == objw)
-				return qSharedPointerCast<StelObject>(n);
-		}
-	}
-
-	// Search by Cederblad numbers (possible formats are "Ced31" or "Ced 31")
-	if (objw.startsWith("CED"))
-	{
-		foreach (const NebulaP& n, dsoArray)
-		{
-			if (QString("CED%1").arg(n->Ced_nb.trimmed().toUpper()) == objw.trimmed() || QString("CED %1").arg(n->Ced_nb.trimmed().toUpper()) == objw.trimmed())
-				return qSharedPointerCast<StelObject>(n);
-		}
-	}
-
-	// Search by PK numbers
-	if (objw.startsWith("PK"))
-	{
-		foreach (const NebulaP& n, dsoArray)
-		{
-			if (QString("PK%1").arg(n->PK_nb.trimmed().toUpper()) == objw.trimmed() || QString("PK %1").arg(n->PK_nb.trimmed().toUpper()) == objw.trimmed())
-				return qSharedPointerCast<StelObject>(n);
-		}
-	}
-
-	// Search by PN G numbers
-	if (objw.startsWith("PN"))
-	{
-		foreach (const NebulaP& n, dsoArray)
-		{
-			if (QString("PNG%1").arg(n->PNG_nb.trimmed().toUpper()) == objw.trimmed() || QString("PN G%1").arg(n->PNG_nb.trimmed().toUpper()) == objw.trimmed())
-				return qSharedPointerCast<StelObject>(n);
-		}
-	}
-
-	// Search by SNR G numbers
-	if (objw.startsWith("SNR"))
-	{
-		foreach (const NebulaP& n, dsoArray)
-		{
-			if (QString("SNRG%1").arg(n->SNRG_nb.trimmed().toUpper()) == objw.trimmed() || QString("SNR G%1").arg(n->SNRG_nb.trimmed().toUpper()) == objw.trimmed())
-				return qSharedPointerCast<StelObject>(n);
-		}
-	}
-
-	// Search by ACO numbers
-	if (objw.startsWith("ACO") || objw.startsWith("ABELL"))
-	{
-		foreach (const NebulaP& n, dsoArray)
-		{
-			if (QString("ACO%1").arg(n->ACO_nb.trimmed().toUpper()) == objw.trimmed()
-			|| QString("ACO %1").arg(n->ACO_nb.trimmed().toUpper()) == objw.trimmed()
-			|| QString("ABELL%1").arg(n->ACO_nb.trimmed().toUpper()) == objw.trimmed()
-			|| QString("ABELL %1").arg(n->ACO_nb.trimmed().toUpper()) == objw.trimmed())
-				return qSharedPointerCast<StelObject>(n);
-		}
-	}
-
-	return Q_NULLPTR;
-}
-
-//! Find and return the list of at most maxNbItem objects auto-completing the passed object name
-QStringList NebulaMgr::listMatchingObjects(const QString& objPrefix, int maxNbItem, bool useStartOfWords, bool inEnglish) const
-{
-	QStringList result;
-	if (maxNbItem <= 0)
-	{
-		return result;
-	}
-
-	QString objw = objPrefix.toUpper();
-
-	// Search by Messier objects number (possible formats are "M31" or "M 31")
-	if (objw.size()>=1 && objw.left(1)=="M" && objw.left(3)!="MEL")
-	{
-		foreach (const NebulaP& n, dsoArray)
-		{
-			if (n->M_nb==0) continue;
-			QString constw = QString("M%1").arg(n->M_nb);
-			QString constws = constw.mid(0, objw.size());
-			if (constws==objw)
-			{
-				result << constws;
-				continue;	// Prevent adding both forms for name
-			}
-			constw = QString("M %1").arg(n->M_nb);
-			constws = constw.mid(0, objw.size());
-			if (constws==objw)
-				result << constw;
-		}
-	}
-
-	// Search by Melotte objects number (possible formats are "Mel31" or "Mel 31")
-	if (objw.size()>=1 && objw.left(3)=="MEL")
-	{
-		foreach (const NebulaP& n, dsoArray)
-		{
-			if (n->Mel_nb==0) continue;
-			QString constw = QString("MEL%1").arg(n->Mel_nb);
-			QString constws = constw.mid(0, objw.size());
-			if (constws==objw)
-			{
-				result << constws;
-				continue;	// Prevent adding both forms for name
-			}
-			constw = QString("MEL %1").arg(n->Mel_nb);
-			constws = constw.mid(0, objw.size());
-			if (constws==objw)
-				result << constw;
-		}
-	}
-
-	// Search by IC objects number (possible formats are "IC466" or "IC 466")
-	if (objw.size()>=1 && objw.left(2)=="IC")
-	{
-		foreach (const NebulaP& n, dsoArray)
-		{
-			if (n->IC_nb==0) continue;
-			QString constw = QString("IC%1").arg(n->IC_nb);
-			QString constws = constw.mid(0, objw.size());
-			if (constws==objw)
-			{
-				result << constws;
-				continue;	// Prevent adding both forms for name
-			}
-			constw = QString("IC %1").arg(n->IC_nb);
-			constws = constw.mid(0, objw.size());
-			if (constws==objw)
-				result << constw;
-		}
-	}
-
-	// Search by NGC numbers (possible formats are "NGC31" or "NGC 31")
-	foreach (const NebulaP& n, dsoArray)
-	{
-		if (n->NGC_nb==0) continue;
-		QString constw = QString("NGC%1").arg(n->NGC_nb);
-		QString constws = constw.mid(0, objw.size());
-		if (constws==objw)
-		{
-			result << constws;
-			continue;
-		}
-		constw = QString("NGC %1").arg(n->NGC_nb);
-		constws = constw.mid(0, objw.size());
-		if (constws==objw)
-			result << constw;
-	}
-
-	// Search by PGC object numbers (possible formats are "PGC31" or "PGC 31")
-	if (objw.size()>=1 && objw.left(3)=="PGC")
-	{
-		foreach (const NebulaP& n, dsoArray)
-		{
-			if (n->PGC_nb==0) continue;
-			QString constw = QString("PGC%1").arg(n->PGC_nb);
-			QString constws = constw.mid(0, objw.size());
-			if (constws==objw)
-			{
-				result << constws;	// Prevent adding both forms for name
-				continue;
-			}
-			constw = QString("PGC %1").arg(n->PGC_nb);
-			constws = constw.mid(0, objw.size());
-			if (constws==objw)
-				result << constw;
-		}
-	}
-
-	// Search by UGC object numbers (possible formats are "UGC31" or "UGC 31")
-	if (objw.size()>=1 && objw.left(3)=="UGC")
-	{
-		foreach (const NebulaP& n, dsoArray)
-		{
-			if (n->UGC_nb==0) continue;
-			QString constw = QString("UGC%1").arg(n->UGC_nb);
-			QString constws = constw.mid(0, objw.size());
-			if (constws==objw)
-			{
-				result << constws;
-				continue;	// Prevent adding both forms for name
-			}
-			constw = QString("UGC %1").arg(n->UGC_nb);
-			constws = constw.mid(0, objw.size());
-			if (constws==objw)
-				result << constw;
-		}
-	}
-
-	// Search by Caldwell objects number (possible formats are "C31" or "C 31")
-	if (objw.size()>=1 && objw.left(1)=="C" && objw.left(2)!="CR" && objw.left(2)!="CE")
-	{
-		foreach (const NebulaP& n, dsoArray)
-		{
-			if (n->C_nb==0) continue;
-			QString constw = QString("C%1").arg(n->C_nb);
-			QString constws = constw.mid(0, objw.size());
-			if (constws==objw)
-			{
-				result << constws;
-				continue;	// Prevent adding both forms for name
-			}
-			constw = QString("C %1").arg(n->C_nb);
-			constws = constw.mid(0, objw.size());
-			if (constws==objw)
-				result << constw;
-		}
-	}
-
-	// Search by Collinder objects number (possible formats are "Cr31" or "Cr 31")
-	if (objw.size()>=1 && objw.left(2)=="CR")
-	{
-		foreach (const NebulaP& n, dsoArray)
-		{
-			if (n->Cr_nb==0) continue;
-			QString constw = QString("CR%1").arg(n->Cr_nb);
-			QString constws = constw.mid(0, objw.size());
-			if (constws==objw)
-			{
-				result << constws;
-				continue;	// Prevent adding both forms for name
-			}
-			constw = QString("CR %1").arg(n->Cr_nb);
-			constws = constw.mid(0, objw.size());
-			if (constws==objw)
-				result << constw;
-		}
-	}
-
-	// Search by Ced objects number (possible formats are "Ced31" or "Ced 31")
-	if (objw.size()>=1 && objw.left(3)=="CED")
-	{
-		foreach (const NebulaP& n, dsoArray)
-		{
-			if (n->Ced_nb.isEmpty()) continue;
-			QString constw = QString("Ced%1").arg(n->Ced_nb.trimmed());
-			QString constws = constw.mid(0, objw.size());
-			if (constws.toUpper()==objw.toUpper())
-			{
-				result << constws;
-				continue;	// Prevent adding both forms for name
-			}
-			constw = QString("Ced %1").arg(n->Ced_nb.trimmed());
-			constws = constw.mid(0, objw.size());
-			if (constws.toUpper()==objw.toUpper())
-				result << constw;
-		}
-	}
-
-	// Search by Barnard objects number (possible formats are "B31" or "B 31")
-	if (objw.size()>=1 && objw.left(1)=="B")
-	{
-		foreach (const NebulaP& n, dsoArray)
-		{
-			if (n->B_nb==0) continue;
-			QString constw = QString("B%1").arg(n->B_nb);
-			QString constws = constw.mid(0, objw.size());
-			if (constws==objw)
-			{
-				result << constws;
-				continue;	// Prevent adding both forms for name
-			}
-			constw = QString("B %1").arg(n->B_nb);
-			constws = constw.mid(0, objw.size());
-			if (constws==objw)
-				result << constw;
-		}
-	}
-
-	// Search by Sharpless objects number (possible formats are "Sh2-31" or "Sh 2-31")
-	if (objw.size()>=1 && objw.left(2)=="SH")
-	{
-		foreach (const NebulaP& n, dsoArray)
-		{
-			if (n->Sh2_nb==0) continue;
-			QString constw = QString("SH2-%1").arg(n->Sh2_nb);
-			QString constws = constw.mid(0, objw.size());
-			if (constws==objw)
-			{
-				result << constws;
-				continue;	// Prevent adding both forms for name
-			}
-			constw = QString("SH 2-%1").arg(n->Sh2_nb);
-			constws = constw.mid(0, objw.size());
-			if (constws==objw)
-				result << constw;
-		}
-	}
-
-	// Search by Van den Bergh objects number (possible formats are "VdB31" or "VdB 31")
-	if (objw.size()>=1 && objw.left(3)=="VDB")
-	{
-		foreach (const NebulaP& n, dsoArray)
-		{
-			if (n->VdB_nb==0) continue;
-			QString constw = QString("VDB%1").arg(n->VdB_nb);
-			QString constws = constw.mid(0, objw.size());
-			if (constws==objw)
-			{
-				result << constws;
-				continue;	// Prevent adding both forms for name
-			}
-			constw = QString("VDB %1").arg(n->VdB_nb);
-			constws = constw.mid(0, objw.size());
-			if (constws==objw)
-				result << constw;
-		}
-	}
-
-	// Search by RCW objects number (possible formats are "RCW31" or "RCW 31")
-	if (objw.size()>=1 && objw.left(3)=="RCW")
-	{
-		foreach (const NebulaP& n, dsoArray)
-		{
-			if (n->RCW_nb==0) continue;
-			QString constw = QString("RCW%1").arg(n->RCW_nb);
-			QString constws = constw.mid(0, objw.size());
-			if (constws==objw)
-			{
-				result << constws;
-				continue;	// Prevent adding both forms for name
-			}
-			constw = QString("RCW %1").arg(n->RCW_nb);
-			constws = constw.mid(0, objw.size());
-			if (constws==objw)
-				result << constw;
-		}
-	}
-
-	// Search by LDN objects number (possible formats are "LDN31" or "LDN 31")
-	if (objw.size()>=1 && objw.left(3)=="LDN")
-	{
-		foreach (const NebulaP& n, dsoArray)
-		{
-			if (n->LDN_nb==0) continue;
-			QString constw = QString("LDN%1").arg(n->LDN_nb);
-			QString constws = constw.mid(0, objw.size());
-			if (constws==objw)
-			{
-				result << constws;
-				continue;	// Prevent adding both forms for name
-			}
-			constw = QString("LDN %1").arg(n->LDN_nb);
-			constws = constw.mid(0, objw.size());
-			if (constws==objw)
-				result << constw;
-		}
-	}
-
-	// Search by LBN objects number (possible formats are "LBN31" or "LBN 31")
-	if (objw.size()>=1 && objw.left(3)=="LBN")
-	{
-		foreach (const NebulaP& n, dsoArray)
-		{
-			if (n->LBN_nb==0) continue;
-			QString constw = QString("LBN%1").arg(n->LBN_nb);
-			QString constws = constw.mid(0, objw.size());
-			if (constws==objw)
-			{
-				result << constws;
-				continue;	// Prevent adding both forms for name
-			}
-			constw = QString("LBN %1").arg(n->LBN_nb);
-			constws = constw.mid(0, objw.size());
-			if (constws==objw)
-				result << constw;
-		}
-	}
-
-	// Search by Arp objects number
-	if (objw.size()>=1 && objw.left(3)=="ARP")
-	{
-		foreach (const NebulaP& n, dsoArray)
-		{
-			if (n->Arp_nb==0) continue;
-			QString constw = QString("ARP%1").arg(n->Arp_nb);
-			QString constws = constw.mid(0, objw.size());
-			if (constws==objw)
-			{
-				result << constws;
-				continue;	// Prevent adding both forms for name
-			}
-			constw = QString("ARP %1").arg(n->Arp_nb);
-			constws = constw.mid(0, objw.size());
-			if (constws==objw)
-				result << constw;
-		}
-	}
-
-	// Search by VV objects number
-	if (objw.size()>=1 && objw.left(2)=="VV")
-	{
-		foreach (const NebulaP& n, dsoArray)
-		{
-			if (n->VV_nb==0) continue;
-			QString constw = QString("VV%1").arg(n->VV_nb);
-			QString constws = constw.mid(0, objw.size());
-			if (constws==objw)
-			{
-				result << constws;
-				continue;	// Prevent adding both forms for name
-			}
-			constw = QString("VV %1").arg(n->VV_nb);
-			constws = constw.mid(0, objw.size());
-			if (constws==objw)
-				result << constw;
-		}
-	}
-
-	// Search by PK objects number
-	if (objw.size()>=1 && objw.left(2)=="PK")
-	{
-		foreach (const NebulaP& n, dsoArray)
-		{
-			if (n->PK_nb.isEmpty()) continue;
-			QString constw = QString("PK%1").arg(n->PK_nb.trimmed());
-			QString constws = constw.mid(0, objw.size());
-			if (constws.toUpper()==objw.toUpper())
-			{
-				result << constws;
-				continue;	// Prevent adding both forms for name
-			}
-			constw = QString("PK %1").arg(n->PK_nb.trimmed());
-			constws = constw.mid(0, objw.size());
-			if (constws.toUpper()==objw.toUpper())
-				result << constw;
-		}
-	}
-
-	// Search by PN G objects number
-	if (objw.size()>=1 && objw.left(2)=="PN")
-	{
-		foreach (const NebulaP& n, dsoArray)
-		{
-			if (n->PNG_nb.isEmpty()) continue;
-			QString constw = QString("PNG%1").arg(n->PNG_nb.trimmed());
-			QString constws = constw.mid(0, objw.size());
-			if (constws.toUpper()==objw.toUpper())
-			{
-				result << constws;
-				continue;	// Prevent adding both forms for name
-			}
-			constw = QString("PN G%1").arg(n->PNG_nb.trimmed());
-			constws = constw.mid(0, objw.size());
-			if (constws.toUpper()==objw.toUpper())
-				result << constw;
-		}
-	}
-
-	// Search by SNR G objects number
-	if (objw.size()>=1 && objw.left(3)=="SNR")
-	{
-		foreach (const NebulaP& n, dsoArray)
-		{
-			if (n->SNRG_nb.isEmpty()) continue;
-			QString constw = QString("SNRG%1").arg(n->SNRG_nb.trimmed());
-			QString constws = constw.mid(0, objw.size());
-			if (constws.toUpper()==objw.toUpper())
-			{
-				result << constws;
-				continue;	// Prevent adding both forms for name
-			}
-			constw = QString("SNR G%1").arg(n->SNRG_nb.trimmed());
-			constws = constw.mid(0, objw.size());
-			if (constws.toUpper()==objw.toUpper())
-				result << constw;
-		}
-	}
-
-	// Search by ACO objects number
-	if (objw.size()>=1 && (objw.left(3)=="ACO" || objw.left(5)=="ABELL"))
-	{
-		foreach (const NebulaP& n, dsoArray)
-		{
-			if (n->ACO_nb.isEmpty()) continue;
-			QString constw = QString("ACO%1").arg(n->ACO_nb.trimmed());
-			QString constws = constw.mid(0, objw.size());
-			if (constws.toUpper()==objw.toUpper())
-			{
-				result << constws;
-				continue;	// Prevent adding both forms for name
-			}
-			constw = QString("ACO %1").arg(n->ACO_nb.trimmed());
-			constws = constw.mid(0, objw.size());
-			if (constws.toUpper()==objw.toUpper())
-				result << constw;
-		}
-	}
-
-	// Search by common names
-	foreach (const NebulaP& n, dsoArray)
-	{
-		QString name = inEnglish ? n->englishName : n->nameI18;
-		if (matchObjectName(name, objPrefix, useStartOfWords))
-		{
-			result.append(name);
-		}
-	}
-
-	// Search by aliases of common names
-	foreach (const NebulaP& n, dsoArray)
-	{
-		QStringList nameList = inEnglish ? n->englishAliases : n->nameI18Aliases;
-		foreach(QString name, nameList)
-		{
-			if (matchObjectName(name, objPrefix, useStartOfWords))
-				result.append(name);
-		}
-	}
-
-	result.sort();
-	if (result.size() > maxNbItem)
-	{
-		result.erase(result.begin() + maxNbItem, result.end());
-	}
-
-	return result;
-}
-
-QStringList NebulaMgr::listAllObjects(bool inEnglish) const
-{
-	QStringList result;
-	foreach(const NebulaP& n, dsoArray)
-	{
-		if (!n->getEnglishName().isEmpty())
-		{
-			if (inEnglish)
-				result << n->getEnglishName();
-			else
-				result << n->getNameI18n();
-		}
-	}
-	return result;
-}
-
-QStringList NebulaMgr::listAllObjectsByType(const QString &objType, bool inEnglish) const
-{
-	QStringList result;
-	int type = objType.toInt();
-	switch (type)
+QStringList NebulaMgr::listAllObjectsByType(const QString &objType, bool inEnglish) const
+{
+	QStringList result;
+	int type = objType.toInt();
+	switch (type)
 	{
 		case 0: // Bright galaxies?
-			foreach(const NebulaP& n, dsoArray)
+			foreach(const NebulaP& n, getDeepSkyObjectsOfTypes(QList<Nebula::NebulaType>() << Nebula::NebGx))
 			{
 				if (n->nType==type && qMin(n->vMag, n->bMag)<=10.)
 				{
@@ -2528,133 +1801,133 @@ QStringList NebulaMgr::listAllObjectsByType(const QString &objType, bool inEngli
 			}
 			break;
 		case 100: // Messier Catalogue?
-			foreach(const NebulaP& n, dsoArray)
+			foreach(const NebulaP& n, getDeepSkyObjectsOfCatalog(type))
 			{
 				if (n->M_nb>0)
 					result << QString("M%1").arg(n->M_nb);
 			}
 			break;
 		case 101: // Caldwell Catalogue?
-			foreach(const NebulaP& n, dsoArray)
+			foreach(const NebulaP& n, getDeepSkyObjectsOfCatalog(type))
 			{
 				if (n->C_nb>0)
 					result << QString("C%1").arg(n->C_nb);
 			}
 			break;
 		case 102: // Barnard Catalogue?
-			foreach(const NebulaP& n, dsoArray)
+			foreach(const NebulaP& n, getDeepSkyObjectsOfCatalog(type))
 			{
 				if (n->B_nb>0)
 					result << QString("B %1").arg(n->B_nb);
 			}
 			break;
 		case 103: // Sharpless Catalogue?
-			foreach(const NebulaP& n, dsoArray)
+			foreach(const NebulaP& n, getDeepSkyObjectsOfCatalog(type))
 			{
 				if (n->Sh2_nb>0)
 					result << QString("SH 2-%1").arg(n->Sh2_nb);
 			}
 			break;
 		case 104: // Van den Bergh Catalogue
-			foreach(const NebulaP& n, dsoArray)
+			foreach(const NebulaP& n, getDeepSkyObjectsOfCatalog(type))
 			{
 				if (n->VdB_nb>0)
 					result << QString("VdB %1").arg(n->VdB_nb);
 			}
 			break;
 		case 105: // RCW Catalogue
-			foreach(const NebulaP& n, dsoArray)
+			foreach(const NebulaP& n, getDeepSkyObjectsOfCatalog(type))
 			{
 				if (n->RCW_nb>0)
 					result << QString("RCW %1").arg(n->RCW_nb);
 			}
 			break;
 		case 106: // Collinder Catalogue
-			foreach(const NebulaP& n, dsoArray)
+			foreach(const NebulaP& n, getDeepSkyObjectsOfCatalog(type))
 			{
 				if (n->Cr_nb>0)
 					result << QString("Cr %1").arg(n->Cr_nb);
 			}
 			break;
 		case 107: // Melotte Catalogue
-			foreach(const NebulaP& n, dsoArray)
+			foreach(const NebulaP& n, getDeepSkyObjectsOfCatalog(type))
 			{
 				if (n->Mel_nb>0)
 					result << QString("Mel %1").arg(n->Mel_nb);
 			}
 			break;
 		case 108: // New General Catalogue
-			foreach(const NebulaP& n, dsoArray)
+			foreach(const NebulaP& n, getDeepSkyObjectsOfCatalog(type))
 			{
 				if (n->NGC_nb>0)
 					result << QString("NGC %1").arg(n->NGC_nb);
 			}
 			break;
 		case 109: // Index Catalogue
-			foreach(const NebulaP& n, dsoArray)
+			foreach(const NebulaP& n, getDeepSkyObjectsOfCatalog(type))
 			{
 				if (n->IC_nb>0)
 					result << QString("IC %1").arg(n->IC_nb);
 			}
 			break;
 		case 110: // Lynds' Catalogue of Bright Nebulae
-			foreach(const NebulaP& n, dsoArray)
+			foreach(const NebulaP& n, getDeepSkyObjectsOfCatalog(type))
 			{
 				if (n->LBN_nb>0)
 					result << QString("LBN %1").arg(n->LBN_nb);
 			}
 			break;
 		case 111: // Lynds' Catalogue of Dark Nebulae
-			foreach(const NebulaP& n, dsoArray)
+			foreach(const NebulaP& n, getDeepSkyObjectsOfCatalog(type))
 			{
 				if (n->LDN_nb>0)
 					result << QString("LDN %1").arg(n->LDN_nb);
 			}
 			break;
 		case 114: // Cederblad Catalog
-			foreach(const NebulaP& n, dsoArray)
+			foreach(const NebulaP& n, getDeepSkyObjectsOfCatalog(type))
 			{
 				if (!n->Ced_nb.isEmpty())
 					result << QString("Ced %1").arg(n->Ced_nb);
 			}
 			break;
 		case 115: // Atlas of Peculiar Galaxies (Arp)
-			foreach(const NebulaP& n, dsoArray)
+			foreach(const NebulaP& n, getDeepSkyObjectsOfCatalog(type))
 			{
 				if (n->Arp_nb>0)
 					result << QString("Arp %1").arg(n->Arp_nb);
 			}
 			break;
 		case 116: // The Catalogue of Interacting Galaxies by Vorontsov-Velyaminov (VV)
-			foreach(const NebulaP& n, dsoArray)
+			foreach(const NebulaP& n, getDeepSkyObjectsOfCatalog(type))
 			{
 				if (n->VV_nb>0)
 					result << QString("VV %1").arg(n->VV_nb);
 			}
 			break;
 		case 117: // Catalogue of Galactic Planetary Nebulae (PK)
-			foreach(const NebulaP& n, dsoArray)
+			foreach(const NebulaP& n, getDeepSkyObjectsOfCatalog(type))
 			{
 				if (!n->PK_nb.isEmpty())
 					result << QString("PK %1").arg(n->PK_nb);
 			}
 			break;
 		case 118: // Strasbourg-ESO Catalogue of Galactic Planetary Nebulae by Acker et. al. (PN G)
-			foreach(const NebulaP& n, dsoArray)
+			foreach(const NebulaP& n, getDeepSkyObjectsOfCatalog(type))
 			{
 				if (!n->PNG_nb.isEmpty())
 					result << QString("PN G%1").arg(n->PNG_nb);
 			}
 			break;
 		case 119: // A catalogue of Galactic supernova remnants by Green (SNR G)
-			foreach(const NebulaP& n, dsoArray)
+			foreach(const NebulaP& n, getDeepSkyObjectsOfCatalog(type))
 			{
 				if (!n->SNRG_nb.isEmpty())
 					result << QString("SNR G%1").arg(n->SNRG_nb);
 			}
 			break;
 		case 120: // A Catalog of Rich Clusters of Galaxies by Abell et. al. (ACO)
-			foreach(const NebulaP& n, dsoArray)
+			foreach(const NebulaP& n, getDeepSkyObjectsOfCatalog(type))
 			{
 				if (!n->ACO_nb.isEmpty())
 					result << QString("ACO %1").arg(n->ACO_nb);
@@ -2719,7 +1992,7 @@ QStringList NebulaMgr::listAllObjectsByType(const QString &objType, bool inEngli
 		}
 		default:
 		{
-			foreach (const NebulaP& n, dsoArray)
+			foreach (const NebulaP& n, getDeepSkyObjectsOfTypes(QList<Nebula::NebulaType>() << static_cast<Nebula::NebulaType>(type)))
 			{
 				if (n->nType==type)
 				{
@@ -2790,151 +2063,27 @@ QList<NebulaP> NebulaMgr::getDeepSkyObjectsByType(const QString &objType)
 	switch (type)
 	{
 		case 100: // Messier Catalogue?
-			foreach(const NebulaP& n, dsoArray)
-			{
-				if (n->M_nb>0)
-					dso.append(n);
-			}
-			break;
 		case 101: // Caldwell Catalogue?
-			foreach(const NebulaP& n, dsoArray)
-			{
-				if (n->C_nb>0)
-					dso.append(n);
-			}
-			break;
 		case 102: // Barnard Catalogue?
-			foreach(const NebulaP& n, dsoArray)
-			{
-				if (n->B_nb>0)
-					dso.append(n);
-			}
-			break;
 		case 103: // Sharpless Catalogue?
-			foreach(const NebulaP& n, dsoArray)
-			{
-				if (n->Sh2_nb>0)
-					dso.append(n);
-			}
-			break;
 		case 104: // Van den Bergh Catalogue
-			foreach(const NebulaP& n, dsoArray)
-			{
-				if (n->VdB_nb>0)
-					dso.append(n);
-			}
-			break;
 		case 105: // RCW Catalogue
-			foreach(const NebulaP& n, dsoArray)
-			{
-				if (n->RCW_nb>0)
-					dso.append(n);
-			}
-			break;
 		case 106: // Collinder Catalogue
-			foreach(const NebulaP& n, dsoArray)
-			{
-				if (n->Cr_nb>0)
-					dso.append(n);
-			}
-			break;
 		case 107: // Melotte Catalogue
-			foreach(const NebulaP& n, dsoArray)
-			{
-				if (n->Mel_nb>0)
-					dso.append(n);
-			}
-			break;
 		case 108: // New General Catalogue
-			foreach(const NebulaP& n, dsoArray)
-			{
-				if (n->NGC_nb>0)
-					dso.append(n);
-			}
-			break;
 		case 109: // Index Catalogue
-			foreach(const NebulaP& n, dsoArray)
-			{
-				if (n->IC_nb>0)
-					dso.append(n);
-			}
-			break;
 		case 110: // Lynds' Catalogue of Bright Nebulae
-			foreach(const NebulaP& n, dsoArray)
-			{
-				if (n->LBN_nb>0)
-					dso.append(n);
-			}
-			break;
 		case 111: // Lynds' Catalogue of Dark Nebulae
-			foreach(const NebulaP& n, dsoArray)
-			{
-				if (n->LDN_nb>0)
-					dso.append(n);
-			}
-			break;
 		case 112: // Principal Galaxy Catalog
-			foreach(const NebulaP& n, dsoArray)
-			{
-				if (n->PGC_nb>0)
-					dso.append(n);
-			}
-			break;
 		case 113: // The Uppsala General Catalogue of Galaxies
-			foreach(const NebulaP& n, dsoArray)
-			{
-				if (n->UGC_nb>0)
-					dso.append(n);
-			}
-			break;
 		case 114: // Cederblad Catalog
-			foreach(const NebulaP& n, dsoArray)
-			{
-				if (!n->Ced_nb.isEmpty())
-					dso.append(n);
-			}
-			break;
 		case 115: // Atlas of Peculiar Galaxies (Arp)
-			foreach(const NebulaP& n, dsoArray)
-			{
-				if (n->Arp_nb>0)
-					dso.append(n);
-			}
-			break;
 		case 116: // The Catalogue of Interacting Galaxies by Vorontsov-Velyaminov (VV)
-			foreach(const NebulaP& n, dsoArray)
-			{
-				if (n->VV_nb>0)
-					dso.append(n);
-			}
-			break;
 		case 117: // Catalogue of Galactic Planetary Nebulae (PK)
-			foreach(const NebulaP& n, dsoArray)
-			{
-				if (!n->PK_nb.isEmpty())
-					dso.append(n);
-			}
-			break;
 		case 118: // Strasbourg-ESO Catalogue of Galactic Planetary Nebulae by Acker et. al. (PN G)
-			foreach(const NebulaP& n, dsoArray)
-			{
-				if (!n->PNG_nb.isEmpty())
-					dso.append(n);
-			}
-			break;
 		case 119: // A catalogue of Galactic supernova remnants by Green (SNR G)
-			foreach(const NebulaP& n, dsoArray)
-			{
-				if (!n->SNRG_nb.isEmpty())
-					dso.append(n);
-			}
-			break;
 		case 120: // A Catalog of Rich Clusters of Galaxies by Abell et. al. (ACO)
-			foreach(const NebulaP& n, dsoArray)
-			{
-				if (!n->ACO_nb.isEmpty())
-					dso.append(n);
-			}
+			dso = getDeepSkyObjectsOfCatalog(type);
 			break;
 		case 150: // Dwarf galaxies
 		{
@@ -3004,14 +2153,8 @@ QList<NebulaP> NebulaMgr::getDeepSkyObjectsByType(const QString &objType)
 			break;
 		}
 		default:
-		{
-			foreach (const NebulaP& n, dsoArray)
-			{
-				if (n->nType==type)
-					dso.append(n);
-			}
+			dso = getDeepSkyObjectsOfTypes(QList<Nebula::NebulaType>() << static_cast<Nebula::NebulaType>(type));
 			break;
-		}
 	}
 
 	return dso;
@@ -24,10 +24,10 @@
 
 #include "StelObjectType.hpp"
 #include "StelFader.hpp"
-#include "StelSphericalIndex.hpp"
 #include "StelObjectModule.hpp"
 #include "StelTextureTypes.hpp"
 #include "Nebula.hpp"
+#include "DsoCatalog.hpp"
 
 #include <QString>
 #include <QStringList>
@@ -334,12 +334,15 @@ public:
 
 	virtual StelObjectP searchByID(const QString &id) const { return searchByName(id); }
 
-	//! Find and return the list of at most maxNbItem objects auto-completing the passed object English name.
-	//! @param objPrefix the case insensitive first letters of the searched object
-	//! @param maxNbItem the maximum number of returned object names
-	//! @param useStartOfWords the autofill mode for returned objects names
-	//! @return a list of matching object name by order of relevance, or an empty list if nothing match
-	virtual QStringList listMatchingObjects(const QString& objPrefix, int maxNbItem=5, bool useStartOfWords=false, bool inEnglish=false) const;
+	//! Find the DSO of a list of names or designations in one pass, e.g. to import an observing list.
+	//! The names and the designations ("M 31", "NGC224", "Sh 2-155", "Abell 1656"...) are case insensitive.
+	//! @param names the common names, aliases or designations of the objects
+	//! @param inEnglish whether the common names are English (true) or translated (false)
+	//! @return the objects in the order of the names, with a null pointer for each name not found
+	//! @note Not a slot: scripts and RemoteControl resolve one name per call with searchByName(),
+	//! which is a hash lookup as well, and cannot use NebulaP.
+	QList<NebulaP> searchByNames(const QStringList& names, bool inEnglish=true) const;
+
 	//! @note Loading deep-sky objects with the proper names only.
 	virtual QStringList listAllObjects(bool inEnglish) const;
 	virtual QStringList listAllObjectsByType(const QString& objType, bool inEnglish) const;
@@ -355,7 +358,13 @@ public:
 	QString getLatestSelectedDSODesignation();
 
 	//! Get the list of all deep-sky objects.
-	const QVector<NebulaP>& getAllDeepSkyObjects() const { return dsoArray; }
+	//! @note the Nebula objects are created on demand; this creates all of them.
+	//! Use getDeepSkyObjectsOfTypes() or getDeepSkyObjectsByType() to create only the objects needed.
+	const QVector<NebulaP>& getAllDeepSkyObjects() const;
+
+	//! Get the deep-sky objects of some types, in the order of the catalogue.
+	//! @note only the Nebula objects of these types are created.
+	QList<NebulaP> getDeepSkyObjectsOfTypes(const QList<Nebula::NebulaType>& types) const;
 
 	//! Get the list of deep-sky objects by type.
 	QList<NebulaP> getDeepSkyObjectsByType(const QString& objType);
@@ -874,6 +883,8 @@ private slots:
 	void updateSkyCulture(const QString& skyCultureDir);
 
 private:
+	//! Register the names and designations of the DSO in the name index of the StelObjectMgr.
+	void updateNameIndex();
 
 	//! Search for a nebula object by name. e.g. M83, NGC 1123, IC 1234.
 	NebulaP search(const QString& name);
@@ -892,6 +903,23 @@ private:
 	//! Draw a nice animated pointer around the object
 	void drawPointer(const StelCore* core, StelPainter& sPainter);
 
+	//! Find a DSO in the order of the former linear searches of searchByName(): NGC designations
+	//! first, then the common names and aliases of nameIndex, then the other designations.
+	NebulaP searchNameOrDesignation(const QString& name, const QHash<QString, NebulaP>& nameIndex) const;
+	//! Find a DSO by designation, spaces and case being ignored.
+	NebulaP searchDesignation(const QString& designation) const;
+	//! Add the designations of a record of the catalogue to designationIndex.
+	void indexDesignations(int index);
+
+	//! Return the Nebula object of a record of the catalogue, creating it if needed.
+	//! Although const, it fills dsoArray: like the rest of NebulaMgr, it must only be called
+	//! from the main thread.
+	//! @param index the index of the record, or -1 for a null pointer
+	NebulaP getDSO(int index) const;
+	//! Get the deep-sky objects of a catalogue, as numbered in getDeepSkyObjectsByType() (100 for Messier...),
+	//! creating only their Nebula objects.
+	QList<NebulaP> getDeepSkyObjectsOfCatalog(int catalog) const;
+
 	NebulaP searchDSO(unsigned int DSO);
 	NebulaP searchM(unsigned int M);
 	NebulaP searchNGC(unsigned int NGC);
@@ -915,7 +943,7 @@ private:
 	NebulaP searchSNRG(QString SNRG);
 	NebulaP searchACO(QString ACO);
 
-	// Load catalog of DSO
+	// Load catalog of DSO, through its memory-mapped copy in the user directory
 	bool loadDSOCatalog(const QString& filename);
 	void convertDSOCatalog(const QString& in, const QString& out, bool decimal);
 	// Load proper names for DSO
@@ -923,15 +951,22 @@ private:
 	// Load outlines for DSO
 	bool loadDSOOutlines(const QString& filename);
 
-	QVector<NebulaP> dsoArray;		// The DSO list
-	QHash<unsigned int, NebulaP> dsoIndex;
+	//! The records of all DSO
+	DsoCatalog dsoCatalog;
+	//! The Nebula objects of the records, in the order of the records, null until they are needed
+	//! (see getDSO()). Not protected by a lock: only used from the main thread.
+	mutable QVector<NebulaP> dsoArray;
+	//! The record indices by DSO number
+	QHash<unsigned int, int> dsoIndex;
+	//! The record indices by designation, keyed by catalogue and number in upper case without spaces, e.g. "NGC224"
+	QHash<QString, int> designationIndex;
+	//! The DSO by upper case common names and aliases
+	QHash<QString, NebulaP> englishNameIndex;
+	QHash<QString, NebulaP> i18nNameIndex;
 
 	LinearFader hintsFader;
 	LinearFader flagShow;
 
-	//! The internal grid for fast positional lookup
-	StelSphericalIndex nebGrid;
-
 	//! The amount of hints (between 0 and 10)
 	double hintsAmount;
 	//! The amount of labels (between 0 and 10)
@@ -819,12 +819,9 @@ void NomenclatureItem::update(double deltaTime)
 	labelsFader.update((int)(deltaTime*1000));
 }
 
-void NomenclatureItem::draw(StelCore* core, StelPainter *painter)
+Vec3d NomenclatureItem::computeXYZ(const StelCore* core) const
 {
-	if (!getFlagLabels())
-		return;
-
-	Vec3d srcPos, XYZ0; // AW: XYZ is gobal variable with equatorial J2000.0 coordinates
+	Vec3d XYZ0;
 	Vec3d equPos = planet->getJ2000EquatorialPos(core);
 
 	// Calculate the radius of the planet. It is necessary to re-scale it
@@ -841,7 +838,24 @@ void NomenclatureItem::draw(StelCore* core, StelPainter *painter)
 
 	/* We have to calculate feature's coordinates in VSOP87 (this is Ecliptic J2000 coordinates). Feature's original coordinates are in planetocentric system, so we have to multiply it by the rotation matrix.
 	   planet->getRotEquatorialToVsop87() gives us the rotation matrix between Equatorial (on date) coordinates and Ecliptic J2000 coordinates. So we have to make another change to obtain the rotation matrix using Equatorial J2000: we have to multiplay by core->matVsop87ToJ2000 */
-	XYZ = equPos + (core->matVsop87ToJ2000 * planet->getRotEquatorialToVsop87()) * XYZ0;
+	return equPos + (core->matVsop87ToJ2000 * planet->getRotEquatorialToVsop87()) * XYZ0;
+}
+
+Vec3d NomenclatureItem::getPlanetocentricDirection() const
+{
+	const double nlatitude = latitude * M_PI/180.0;
+	const double nlongitude = longitude * M_PI/180.0;
+	return Vec3d(cos(nlatitude) * cos(nlongitude), cos(nlatitude) * sin(nlongitude), sin(nlatitude));
+}
+
+void NomenclatureItem::draw(StelCore* core, StelPainter *painter)
+{
+	if (!getFlagLabels())
+		return;
+
+	Vec3d srcPos; // AW: XYZ is gobal variable with equatorial J2000.0 coordinates
+	Vec3d equPos = planet->getJ2000EquatorialPos(core);
+	XYZ = computeXYZ(core);
 	// In case we are located at a labeled site, don't show this label or any labels within 150 km. Else we have bad flicker...
 	if (XYZ.lengthSquared()< 150.*150.*AU_KM*AU_KM )
 		return;
@@ -163,6 +163,10 @@ private:
 	static Vec3f color;
 
 	QString getNomenclatureTypeLatinString() const;
+	//! Compute the J2000 equatorial position of the feature at the current time of core.
+	Vec3d computeXYZ(const StelCore* core) const;
+	//! Unit vector towards the feature in the rotating frame of the planet (x towards longitude 0, z towards the north pole).
+	Vec3d getPlanetocentricDirection() const;
 
 	PlanetP planet;
 	int identificator;
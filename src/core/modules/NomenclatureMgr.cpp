@@ -29,10 +29,14 @@
 #include "StelLocaleMgr.hpp"
 #include "NomenclatureMgr.hpp"
 #include "NomenclatureItem.hpp"
+#include "StelGeodesicGrid.hpp"
 
 #include <QSettings>
 #include <QFile>
 #include <QDir>
+#include <QHash>
+
+#include <cmath>
 
 NomenclatureMgr::NomenclatureMgr()
 {
@@ -364,25 +368,151 @@ void NomenclatureMgr::loadNomenclature()
 		planetSurfNamesFile.close();
 		qDebug() << "Loaded" << readOk << "/" << totalRecords << "items of planetary surface nomenclature";
 
+		buildPlanetFeatures();
+	}
+}
+
+void NomenclatureMgr::indexFeatureZones(const QVector<Vec3d>& directions, QVector<int>& zoneBegin, QVector<int>& order)
+{
+	const StelGeodesicGrid grid(ZoneLevel);
+	const int nrOfZones = StelGeodesicGrid::nrOfZones(ZoneLevel);
+	QVector<int> zones(directions.size());
+	zoneBegin.fill(0, nrOfZones+1);
+	for (int i=0; i<directions.size(); ++i)
+	{
+		const Vec3d& d = directions.at(i);
+		zones[i] = grid.getZoneNumberForPoint(Vec3f(d[0], d[1], d[2]), ZoneLevel);
+		++zoneBegin[zones[i]+1];
+	}
+	for (int z=0; z<nrOfZones; ++z)
+		zoneBegin[z+1] += zoneBegin[z];
+	order.resize(directions.size());
+	QVector<int> next(zoneBegin);
+	for (int i=0; i<directions.size(); ++i)
+		order[next[zones.at(i)]++] = i;
+}
+
+void NomenclatureMgr::getVisibleZones(const StelGeodesicGrid* grid, const Vec3d& observerDir, double radiusOverDistance, QVector<int>& zones)
+{
+	// A feature at the unit vector d is closer to the observer than the centre of the body when
+	// |d*r - observerDir*dist| <= dist, i.e. when d*observerDir >= r/(2*dist).
+	QVector<SphericalCap> caps(1, SphericalCap(observerDir, 0.5*radiusOverDistance));
+	const GeodesicSearchResult* searchResult = grid->search(caps, ZoneLevel);
+	int zone;
+	zones.clear();
+	for (GeodesicSearchInsideIterator it(*searchResult, ZoneLevel); (zone = it.next()) >= 0;)
+		zones.append(zone);
+	for (GeodesicSearchBorderIterator it(*searchResult, ZoneLevel); (zone = it.next()) >= 0;)
+		zones.append(zone);
+}
+
+void NomenclatureMgr::buildPlanetFeatures()
+{
+	planetFeatures.clear();
+
+	QHash<Planet*, int> groups;
+	// Direction of each feature of each body
+	QVector<QVector<Vec3d> > directions;
+	foreach (const NomenclatureItemP& nItem, nomenclatureItems)
+	{
+		if (!nItem->initialized)
+			continue;
+		int g = groups.value(nItem->planet.data(), -1);
+		if (g<0)
+		{
+			g = planetFeatures.size();
+			groups.insert(nItem->planet.data(), g);
+			PlanetFeatures pf;
+			pf.planet = nItem->planet;
+			pf.maxSize = 0.f;
+			planetFeatures.append(pf);
+			directions.append(QVector<Vec3d>());
+		}
+		PlanetFeatures& pf = planetFeatures[g];
+		pf.items.append(nItem);
+		pf.maxSize = qMax(pf.maxSize, nItem->size);
+		directions[g].append(nItem->getPlanetocentricDirection());
+	}
+
+	// Sort the features of each body by zone, keeping the order of the file in each zone.
+	QVector<int> order;
+	for (int g=0; g<planetFeatures.size(); ++g)
+	{
+		PlanetFeatures& pf = planetFeatures[g];
+		indexFeatureZones(directions.at(g), pf.zoneBegin, order);
+		QVector<NomenclatureItemP> sorted(pf.items.size());
+		for (int i=0; i<order.size(); ++i)
+			sorted[i] = pf.items.at(order.at(i));
+		pf.items.swap(sorted);
 	}
 }
 
 void NomenclatureMgr::deinit()
 {
+	planetFeatures.clear();
 	nomenclatureItems.clear();
 	texPointer.clear();
 }
 
+bool NomenclatureMgr::isBodyVisible(StelCore* core, const PlanetFeatures& pf, const SphericalCap& viewportCap, double pixelPerRad) const
+{
+	const Vec3d equPos = pf.planet->getJ2000EquatorialPos(core);
+	const double dist = equPos.length();
+	const double r = pf.planet->getRadius() * pf.planet->getSphereScale();
+	if (dist>r)
+	{
+		// The features are at least at dist-r from the observer, so the largest one gives an upper
+		// limit of the size of the labels tested in NomenclatureItem::draw().
+		const double maxScreenSize = std::atan2(pf.maxSize*pf.planet->getSphereScale()/AU, dist-r)*pixelPerRad;
+		if (maxScreenSize<=50.)
+			return false;
+
+		// Disk of the body
+		const double sinRadius = r/dist;
+		if (!viewportCap.intersects(SphericalCap(equPos/dist, std::sqrt(1.-sinRadius*sinRadius))))
+			return false;
+	}
+	return pf.planet->getVMagnitude(core)<20.;
+}
+
 void NomenclatureMgr::draw(StelCore* core)
 {
 	StelProjectorP prj = core->getProjection(StelCore::FrameJ2000);
 	StelPainter painter(prj);
 	painter.setFont(font);
 
-	foreach (const NomenclatureItemP& nItem, nomenclatureItems)
+	const SphericalCap& viewportCap = prj->getBoundingCap();
+	const double pixelPerRad = prj->getPixelPerRadAtCenter();
+	QVector<int> zones;
+	foreach (const PlanetFeatures& pf, planetFeatures)
+	{
+		if (!isBodyVisible(core, pf, viewportCap, pixelPerRad))
+			continue;
+
+		// NomenclatureItem::draw() only draws the features closer to the observer than the center of
+		// the body: only the zones of these features, in the rotating frame of the body, are visited.
+		const Vec3d equPos = pf.planet->getJ2000EquatorialPos(core);
+		const double dist = equPos.length();
+		const double r = pf.planet->getRadius() * pf.planet->getSphereScale();
+		if (dist<=0. || r>2.*dist)
+			continue;
+		const Mat4d rotJ2000ToPlanet = Mat4d::zrotation(-pf.planet->getSiderealTime(core->getJD(), core->getJDE())*M_PI/180.)
+					       * (core->matVsop87ToJ2000 * pf.planet->getRotEquatorialToVsop87()).transpose();
+		getVisibleZones(core->getGeodesicGrid(ZoneLevel), rotJ2000ToPlanet.multiplyWithoutTranslation(-equPos/dist), r/dist, zones);
+		foreach (int z, zones)
+		{
+			for (int i=pf.zoneBegin.at(z); i<pf.zoneBegin.at(z+1); ++i)
+				pf.items.at(i)->draw(core, &painter);
+		}
+	}
+
+	// The features of culled bodies are not updated by their draw(), but the position of the selected
+	// one is still shown by the pointer and the info text.
+	const QList<StelObjectP> selected = GETSTELMODULE(StelObjectMgr)->getSelectedObject("NomenclatureItem");
+	if (!selected.empty())
 	{
-		if (nItem && nItem->initialized)
-			nItem->draw(core, &painter);
+		NomenclatureItemP nItem = qSharedPointerCast<NomenclatureItem>(selected[0]);
+		nItem->XYZ = nItem->computeXYZ(core);
 	}
 
 	if (GETSTELMODULE(StelObjectMgr)->getFlagSelectedObjectPointer())
@@ -411,29 +541,41 @@ void NomenclatureMgr::drawPointer(StelCore* core, StelPainter& painter)
 	}
 }
 
-QList<StelObjectP> NomenclatureMgr::searchAround(const Vec3d& av, double limitFov, const StelCore*) const
+QList<StelObjectP> NomenclatureMgr::searchAround(const Vec3d& av, double limitFov, const StelCore* core) const
 {
 	QList<StelObjectP> result;
+	if (!getFlagLabels())
+		return result;
 
 	Vec3d v(av);
 	v.normalize();
 	double cosLimFov = cos(limitFov * M_PI/180.);
 	Vec3d equPos;
 
-	foreach(const NomenclatureItemP& nItem, nomenclatureItems)
+	// Only the features of the bodies whose disk is in the field of view around v are tested.
+	foreach (const PlanetFeatures& pf, planetFeatures)
 	{
-		if (nItem->initialized)
+		Vec3d planetPos = pf.planet->getJ2000EquatorialPos(core);
+		const double dist = planetPos.length();
+		const double r = pf.planet->getRadius() * pf.planet->getSphereScale();
+		if (dist>r)
 		{
-			equPos = nItem->XYZ;
+			planetPos/=dist;
+			if (std::acos(qBound(-1., planetPos*v, 1.)) > limitFov*M_PI/180. + std::asin(r/dist))
+				continue;
+		}
+
+		foreach (const NomenclatureItemP& nItem, pf.items)
+		{
+			equPos = nItem->computeXYZ(core);
 			equPos.normalize();
-			if (equPos[0]*v[0] + equPos[1]*v[1] + equPos[2]*v[2]>=cosLimFov)
+			if (equPos*v>=cosLimFov)
 			{
 				result.append(qSharedPointerCast<StelObject>(nItem));
 			}
 		}
 	}
 
-
 	return result;
 }
 
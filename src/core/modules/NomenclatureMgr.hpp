@@ -27,9 +27,12 @@
 
 #include <QFont>
 #include <QList>
+#include <QVector>
 
 class StelPainter;
 class QSettings;
+class SphericalCap;
+class StelGeodesicGrid;
 
 typedef QSharedPointer<NomenclatureItem> NomenclatureItemP;
 
@@ -65,6 +68,7 @@ public:
 	//! @param limitFov the field of view around the position v in which to search for satellites.
 	//! @param core the StelCore to use for computations.
 	//! @return an list containing the satellites located inside the limitFov circle around position v.
+	//! @note the features are only found while their labels are displayed, see getFlagLabels().
 	virtual QList<StelObjectP> searchAround(const Vec3d& v, double limitFov, const StelCore* core) const;
 
 	//! Return the matching satellite object's pointer if exists or Q_NULLPTR.
@@ -88,6 +92,19 @@ public:
 	virtual QString getName() const { return "Geological features"; }
 	virtual QString getStelObjectType() const { return NomenclatureItem::NOMENCLATURE_TYPE; }
 
+	///////////////////////////////////////////////////////////////////////////
+	// Index of the features of a body by zone, used by draw()	//! Sort the features of a body by zone of the geodesic grid at ZoneLevel.
+	//! @param directions unit vectors towards the features in the rotating frame of the body
+	//! @param zoneBegin set to the index in order of the first feature of each zone, followed by the number of features
+	//! @param order set to the indices of the features sorted by zone, in the order of directions in each zone
+	static void indexFeatureZones(const QVector<Vec3d>& directions, QVector<int>& zoneBegin, QVector<int>& order);
+	//! Get the zones of the geodesic grid at ZoneLevel which contain the features closer to the observer
+	//! than the centre of the body, the only ones drawn by NomenclatureItem::draw().
+	//! @param grid a geodesic grid of level ZoneLevel or more
+	//! @param observerDir unit vector from the centre of the body towards the observer, in the rotating frame of the body
+	//! @param radiusOverDistance radius of the body divided by the distance of the observer from its centre, at most 2
+	static void getVisibleZones(const StelGeodesicGrid* grid, const Vec3d& observerDir, double radiusOverDistance, QVector<int>& zones);
+
 public slots:
 	///////////////////////////////////////////////////////////////////////////
 	// Other public methods
@@ -119,14 +136,33 @@ signals:
 	void nomenclatureColorChanged(const Vec3f & color) const;
 
 private:
+	//! The features of one body, sorted by zone of the geodesic grid at ZoneLevel, with the
+	//! directions of the features in the rotating frame of the body as points of the grid.
+	struct PlanetFeatures
+	{
+		PlanetP planet;
+		QVector<NomenclatureItemP> items;
+		//! Index in items of the first feature of each zone, and the number of features at the end
+		QVector<int> zoneBegin;
+		//! Size of the largest feature [km]
+		float maxSize;
+	};
+
 	//! Load nomenclature for solar system bodies
 	void loadNomenclature();
+	//! Group nomenclatureItems by planet into planetFeatures.
+	void buildPlanetFeatures();
+	//! Return false if no feature of the body can be drawn: the body is outside the viewport, too
+	//! faint, or too small for the labels of its features.
+	//! @param pixelPerRad the scale of the projection at the center of the viewport
+	bool isBodyVisible(StelCore* core, const PlanetFeatures& pf, const SphericalCap& viewportCap, double pixelPerRad) const;
 
 	// Font used for displaying our text
 	QFont font;
 	QSettings* conf;
 	StelTextureSP texPointer;	
 	QList<NomenclatureItemP> nomenclatureItems;
+	QVector<PlanetFeatures> planetFeatures;
 };
 
 #endif /*_NOMENCLATUREMGR_HPP_*/
@@ -273,6 +273,201 @@ void CometOrbit::positionAtTimevInVSOP87Coordinates(double JDE, double *v, bool
 	}
 }
 
+void CometOrbitBatch::Lane::clear()
+{
+	q.clear(); e.clear(); n.clear(); t0.clear();
+	Px.clear(); Py.clear(); Pz.clear();
+	Qx.clear(); Qy.clear(); Qz.clear();
+	index.clear();
+}
+
+void CometOrbitBatch::clear()
+{
+	elliptic.clear();
+	hyperbolic.clear();
+	parabolic.clear();
+	count=0;
+}
+
+int CometOrbitBatch::add(double pericenterDistance, double eccentricity, double inclination, double ascendingNode,
+			 double argOfPerhelion, double timeAtPerihelion, double meanMotion)
+{
+	Lane& l = (eccentricity < 1.0 ? elliptic : (eccentricity > 1.0 ? hyperbolic : parabolic));
+	// Same expressions as in Init3D(), which CometOrbit evaluates for every position.
+	const double cw = cos(argOfPerhelion);
+	const double sw = sin(argOfPerhelion);
+	const double cOm = cos(ascendingNode);
+	const double sOm = sin(ascendingNode);
+	const double ci = cos(inclination);
+	const double si = sin(inclination);
+	l.Px.append(-sw*sOm*ci+cw*cOm);
+	l.Qx.append(-cw*sOm*ci-sw*cOm);
+	l.Py.append( sw*cOm*ci+cw*sOm);
+	l.Qy.append( cw*cOm*ci-sw*sOm);
+	l.Pz.append( sw*si);
+	l.Qz.append( cw*si);
+	l.q.append(pericenterDistance);
+	l.e.append(eccentricity);
+	l.n.append(meanMotion);
+	l.t0.append(timeAtPerihelion);
+	l.index.append(count);
+	return count++;
+}
+
+// Same iteration as InitEll(). Instead of leaving the loop, a converged body keeps its E
+// (same test as in InitEll()), so that the result is the same as that of the scalar code.
+void CometOrbitBatch::computeElliptic(const Lane& l, double JDE, double* rCosNu, double* rSinNu)
+{
+	const int size = l.size();
+	const double* q = l.q.constData();
+	const double* e = l.e.constData();
+	const double* n = l.n.constData();
+	const double* t0 = l.t0.constData();
+	QVector<double> MBuf(size), EBuf(size);
+	QVector<int> activeBuf(size);
+	double* M = MBuf.data();
+	double* E = EBuf.data();
+	int* active = activeBuf.data();
+
+	for (int k=0; k<size; ++k)
+	{
+		double Mk = fmod(n[k]*(JDE-t0[k]), 2*M_PI);
+		Mk += (Mk < 0.0) * (2.0*M_PI);
+		const double s = sin(Mk);
+		M[k] = Mk;
+		E[k] = Mk+0.85*e[k]*((s > 0.0) - (s < 0.0));
+		active[k] = 1;
+	}
+	// f1 is always positive for e<1, so sign(f1) is not needed.
+	for (int it=0; it<Iterations; ++it)
+	{
+		for (int k=0; k<size; ++k)
+		{
+			const double f2=e[k]*sin(E[k]);
+			const double f=E[k]-f2-M[k];
+			const double f1=1.0-e[k]*cos(E[k]);
+			const double En = E[k] + (-5.0*f)/(f1+std::sqrt(fabs(16.0*f1*f1-20.0*f*f2)));
+			const int converged = fabs(En-E[k]) < EPSILON;
+			E[k] = active[k] ? En : E[k];
+			active[k] &= !converged;
+		}
+		// Most bodies converge in a few iterations
+		int remaining = 0;
+		for (int k=0; k<size; ++k)
+			remaining |= active[k];
+		if (!remaining)
+			break;
+	}
+	for (int k=0; k<size; ++k)
+	{
+		const double h1 = q[k]*std::sqrt((1.0+e[k])/(1.0-e[k]));
+		rCosNu[k] = q[k]/(1.0-e[k])*(cos(E[k])-e[k]);
+		rSinNu[k] = h1*sin(E[k]);
+	}
+	// Bodies not converged yet (or NaN) are left to the scalar code.
+	for (int k=0; k<size; ++k)
+	{
+		if (active[k])
+			InitEll(q[k], n[k], e[k], JDE-t0[k], rCosNu[k], rSinNu[k]);
+	}
+}
+
+// Same iteration as InitHyp(), with converged bodies kept as in computeElliptic().
+void CometOrbitBatch::computeHyperbolic(const Lane& l, double JDE, double* rCosNu, double* rSinNu)
+{
+	const int size = l.size();
+	const double* q = l.q.constData();
+	const double* e = l.e.constData();
+	const double* n = l.n.constData();
+	const double* t0 = l.t0.constData();
+	QVector<double> MBuf(size), EBuf(size);
+	QVector<int> activeBuf(size);
+	double* M = MBuf.data();
+	double* E = EBuf.data();
+	int* active = activeBuf.data();
+
+	for (int k=0; k<size; ++k)
+	{
+		const double Mk = n[k]*(JDE-t0[k]);
+		M[k] = Mk;
+		E[k] = ((Mk > 0.0) - (Mk < 0.0))*log(2.0*fabs(Mk)/e[k] + 1.85);
+		active[k] = 1;
+	}
+	// f1 = e*cosh(E)-1 is always positive for e>1.
+	for (int it=0; it<Iterations; ++it)
+	{
+		for (int k=0; k<size; ++k)
+		{
+			const double f2=e[k]*sinh(E[k]);
+			const double f=f2-E[k]-M[k];
+			const double f1=e[k]*cosh(E[k])-1.0;
+			const double En = E[k] + (-5.0*f)/(f1+std::sqrt(fabs(16.0*f1*f1-20.0*f*f2)));
+			const int converged = fabs(En-E[k]) < EPSILON;
+			E[k] = active[k] ? En : E[k];
+			active[k] &= !converged;
+		}
+		// Most bodies converge in a few iterations
+		int remaining = 0;
+		for (int k=0; k<size; ++k)
+			remaining |= active[k];
+		if (!remaining)
+			break;
+	}
+	for (int k=0; k<size; ++k)
+	{
+		const double a = q[k]/(e[k]-1.0);
+		rCosNu[k] = a*(e[k]-cosh(E[k]));
+		rSinNu[k] = a*std::sqrt(e[k]*e[k]-1.0)*sinh(E[k]);
+	}
+	for (int k=0; k<size; ++k)
+	{
+		if (active[k])
+			InitHyp(q[k], n[k], e[k], JDE-t0[k], rCosNu[k], rSinNu[k]);
+	}
+}
+
+// Closed solution as in InitPar().
+void CometOrbitBatch::computeParabolic(const Lane& l, double JDE, double* rCosNu, double* rSinNu)
+{
+	const int size = l.size();
+	const double* q = l.q.constData();
+	const double* n = l.n.constData();
+	const double* t0 = l.t0.constData();
+	for (int k=0; k<size; ++k)
+	{
+		const double W=(JDE-t0[k])*n[k];
+		const double Y=cbrt(W+std::sqrt(W*W+1.));
+		const double tanNu2=Y-1.0/Y;
+		rCosNu[k]=q[k]*(1.0-tanNu2*tanNu2);
+		rSinNu[k]=2.0*q[k]*tanNu2;
+	}
+}
+
+void CometOrbitBatch::scatter(const Lane& l, const double* rCosNu, const double* rSinNu, double* x, double* y, double* z)
+{
+	const int size = l.size();
+	const int* index = l.index.constData();
+	for (int k=0; k<size; ++k)
+	{
+		const int j = index[k];
+		x[j] = l.Px[k]*rCosNu[k]+l.Qx[k]*rSinNu[k];
+		y[j] = l.Py[k]*rCosNu[k]+l.Qy[k]*rSinNu[k];
+		z[j] = l.Pz[k]*rCosNu[k]+l.Qz[k]*rSinNu[k];
+	}
+}
+
+void CometOrbitBatch::computePositions(double JDE, double* x, double* y, double* z) const
+{
+	QVector<double> rCosNu(qMax(elliptic.size(), qMax(hyperbolic.size(), parabolic.size())));
+	QVector<double> rSinNu(rCosNu.size());
+	computeElliptic(elliptic, JDE, rCosNu.data(), rSinNu.data());
+	scatter(elliptic, rCosNu.constData(), rSinNu.constData(), x, y, z);
+	computeHyperbolic(hyperbolic, JDE, rCosNu.data(), rSinNu.data());
+	scatter(hyperbolic, rCosNu.constData(), rSinNu.constData(), x, y, z);
+	computeParabolic(parabolic, JDE, rCosNu.data(), rSinNu.data());
+	scatter(parabolic, rCosNu.constData(), rSinNu.constData(), x, y, z);
+}
+
 
 
 EllipticalOrbit::EllipticalOrbit(double pericenterDistance,
@@ -531,6 +726,183 @@ void EllipticalOrbit::sample(double, double, int nSamples, OrbitSampleProc& proc
 		proc.sample(positionAtE(dE * i));
 }
 
+void EllipticalOrbitBatch::Lane::clear()
+{
+	q.clear(); e.clear(); M0.clear(); n.clear(); epoch.clear();
+	Px.clear(); Py.clear(); Pz.clear();
+	Qx.clear(); Qy.clear(); Qz.clear();
+	index.clear();
+}
+
+void EllipticalOrbitBatch::clear()
+{
+	for (int m=0; m<NbMethods; ++m)
+		lanes[m].clear();
+	count=0;
+}
+
+int EllipticalOrbitBatch::add(double pericenterDistance, double eccentricity, double inclination, double ascendingNode,
+			      double argOfPeriapsis, double meanAnomalyAtEpoch, double period, double epoch,
+			      double parentRotObliquity, double parentRotAscendingnode, double parentRotJ2000Longitude)
+{
+	// Same choice as in EllipticalOrbit::eccentricAnomaly()
+	Method method;
+	if (eccentricity == 0.0)
+		method = Circular;
+	else if (eccentricity < 0.2)
+		method = LowEccentricity;
+	else if (eccentricity < 0.9)
+		method = MediumEccentricity;
+	else if (eccentricity < 1.0)
+		method = HighEccentricity;
+	else if (eccentricity == 1.0)
+		method = Parabolic;
+	else
+		method = Hyperbolic;
+	Lane& l = lanes[method];
+
+	// Rotation of positionAtE(), followed by the rotation to VSOP87 of the orbit.
+	// With the parameters of the bodies orbiting the Sun the second one is the identity.
+	const EllipticalOrbit orbit(pericenterDistance, eccentricity, inclination, ascendingNode, argOfPeriapsis, meanAnomalyAtEpoch,
+				    period, epoch, parentRotObliquity, parentRotAscendingnode, parentRotJ2000Longitude);
+	const Mat4d R = Mat4d::zrotation(ascendingNode) * Mat4d::xrotation(inclination) * Mat4d::zrotation(argOfPeriapsis);
+	const double* V = orbit.rotateToVsop87;
+	l.Px.append(V[0]*R[0] + V[1]*R[1] + V[2]*R[2]);
+	l.Py.append(V[3]*R[0] + V[4]*R[1] + V[5]*R[2]);
+	l.Pz.append(V[6]*R[0] + V[7]*R[1] + V[8]*R[2]);
+	l.Qx.append(V[0]*R[4] + V[1]*R[5] + V[2]*R[6]);
+	l.Qy.append(V[3]*R[4] + V[4]*R[5] + V[5]*R[6]);
+	l.Qz.append(V[6]*R[4] + V[7]*R[5] + V[8]*R[6]);
+	l.q.append(pericenterDistance);
+	l.e.append(eccentricity);
+	l.M0.append(meanAnomalyAtEpoch);
+	l.n.append(2.0 * M_PI / period);
+	l.epoch.append(epoch);
+	l.index.append(count);
+	return count++;
+}
+
+// The iterations of EllipticalOrbit::eccentricAnomaly() and the positions of positionAtE(),
+// with the same expressions. All bodies of a lane take the same branches.
+void EllipticalOrbitBatch::computeLane(Method method, const Lane& l, double JDE, double* x, double* y, double* z)
+{
+	const int size = l.size();
+	const double* q = l.q.constData();
+	const double* e = l.e.constData();
+	const double* M0 = l.M0.constData();
+	const double* n = l.n.constData();
+	const double* epoch = l.epoch.constData();
+	QVector<double> MBuf(size), EBuf(size), XBuf(size), ZBuf(size);
+	double* M = MBuf.data();
+	double* E = EBuf.data();
+	double* X = XBuf.data();
+	double* Z = ZBuf.data();
+
+	for (int k=0; k<size; ++k)
+		M[k] = M0[k] + (JDE-epoch[k]) * n[k];
+
+	switch (method)
+	{
+		case Circular:
+			for (int k=0; k<size; ++k)
+				E[k] = M[k];
+			break;
+		case LowEccentricity:
+			// SolveKeplerFunc1, 5 iterations
+			for (int k=0; k<size; ++k)
+				E[k] = M[k];
+			for (int it=0; it<5; ++it)
+				for (int k=0; k<size; ++k)
+					E[k] = M[k] + e[k] * sin(E[k]);
+			break;
+		case MediumEccentricity:
+			// SolveKeplerFunc2, 6 iterations
+			for (int k=0; k<size; ++k)
+				E[k] = M[k];
+			for (int it=0; it<6; ++it)
+				for (int k=0; k<size; ++k)
+					E[k] = E[k] + (M[k] + e[k] * sin(E[k]) - E[k]) / (1 - e[k] * cos(E[k]));
+			break;
+		case HighEccentricity:
+			// SolveKeplerLaguerreConway, 8 iterations. f1 is always positive for e<1, so sign(f1) is 1.
+			for (int k=0; k<size; ++k)
+			{
+				const double s = sin(M[k]);
+				E[k] = M[k] + 0.85 * e[k] * ((s > 0.0) - (s < 0.0));
+			}
+			for (int it=0; it<8; ++it)
+			{
+				for (int k=0; k<size; ++k)
+				{
+					const double s = e[k] * sin(E[k]);
+					const double c = e[k] * cos(E[k]);
+					const double f = E[k] - s - M[k];
+					const double f1 = 1 - c;
+					E[k] += -5 * f / (f1 + std::sqrt(fabs(16 * f1 * f1 - 20 * f * s)));
+				}
+			}
+			break;
+		case Hyperbolic:
+			// SolveKeplerLaguerreConwayHyp, 30 iterations. f1 is always positive for e>1.
+			for (int k=0; k<size; ++k)
+				E[k] = log(2 * M[k] / e[k] + 1.85);
+			for (int it=0; it<30; ++it)
+			{
+				for (int k=0; k<size; ++k)
+				{
+					const double s = e[k] * sinh(E[k]);
+					const double c = e[k] * cosh(E[k]);
+					const double f = s - E[k] - M[k];
+					const double f1 = c - 1;
+					E[k] += -5 * f / (f1 + std::sqrt(fabs(16 * f1 * f1 - 20 * f * s)));
+				}
+			}
+			break;
+		default:
+			break;
+	}
+
+	if (method==Parabolic)
+	{
+		// Not handled by positionAtE() either
+		for (int k=0; k<size; ++k)
+			X[k] = Z[k] = 0.0;
+	}
+	else if (method==Hyperbolic)
+	{
+		for (int k=0; k<size; ++k)
+		{
+			const double a = q[k] / (1.0 - e[k]);
+			X[k] = -a * (e[k] - cosh(E[k]));
+			Z[k] = -a * std::sqrt(e[k] * e[k] - 1) * -sinh(E[k]);
+		}
+	}
+	else
+	{
+		for (int k=0; k<size; ++k)
+		{
+			const double a = q[k] / (1.0 - e[k]);
+			X[k] = a * (cos(E[k]) - e[k]);
+			Z[k] = a * std::sqrt(1 - e[k] * e[k]) * -sin(E[k]);
+		}
+	}
+
+	const int* index = l.index.constData();
+	for (int k=0; k<size; ++k)
+	{
+		const int j = index[k];
+		x[j] = l.Px[k]*X[k] + l.Qx[k]*(-Z[k]);
+		y[j] = l.Py[k]*X[k] + l.Qy[k]*(-Z[k]);
+		z[j] = l.Pz[k]*X[k] + l.Qz[k]*(-Z[k]);
+	}
+}
+
+void EllipticalOrbitBatch::computePositions(double JDE, double* x, double* y, double* z) const
+{
+	for (int m=0; m<NbMethods; ++m)
+		computeLane(static_cast<Method>(m), lanes[m], JDE, x, y, z);
+}
+
 /*
  * Stuff found unused and deactivated pre-0.15
 Vec3d CachingOrbit::positionAtTime(double JDE) const
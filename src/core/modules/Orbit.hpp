@@ -15,6 +15,8 @@
 
 #include "VecMath.hpp"
 
+#include <QVector>
+
 class OrbitSampleProc;
 
 //! @internal
@@ -60,6 +62,7 @@ public:
 	virtual void sample(double, double, int, OrbitSampleProc&) const;
 
 private:
+	friend class EllipticalOrbitBatch;
 	//! returns eccentric anomaly E for Mean anomaly M
 	double eccentricAnomaly(const double M) const;
 	Vec3d positionAtE(const double E) const;
@@ -115,6 +118,103 @@ private:
 	const double orbitGood; //! orb. elements are only valid for this time from perihel [days]. Don't draw the object outside.
 };
 
+//! @class CometOrbitBatch
+//! Positions of many bodies in heliocentric CometOrbit orbits (parent Sun, no rotation) at one date.
+//! The elements are stored in one array per quantity, separately for elliptic, hyperbolic and parabolic
+//! orbits. Kepler's equation is solved for all bodies of a kind with the same fixed number of
+//! Laguerre-Conway iterations in loops without branches, which the compiler can vectorize. A body
+//! keeps its solution from the iteration where it passes the convergence test of CometOrbit, and
+//! bodies which have not converged after these iterations are solved again with the code of CometOrbit,
+//! so the positions are the same as those of CometOrbit::positionAtTimevInVSOP87Coordinates().
+class CometOrbitBatch
+{
+public:
+	CometOrbitBatch() : count(0) {}
+
+	//! Number of Laguerre-Conway iterations done for every body.
+	static const int Iterations = 8;
+
+	void clear();
+	int size() const { return count; }
+	//! Add a body. The parameters are those of the CometOrbit constructor.
+	//! @return the index of the body in the arrays filled by computePositions()
+	int add(double pericenterDistance, double eccentricity, double inclination, double ascendingNode,
+		double argOfPerhelion, double timeAtPerihelion, double meanMotion);
+	//! Compute the heliocentric VSOP87 positions [AU] of all bodies at date JDE.
+	//! @param x, y, z arrays receiving size() values
+	void computePositions(double JDE, double* x, double* y, double* z) const;
+
+private:
+	//! Elements of the bodies of one kind of orbit. P and Q are the orientation vectors of Init3D().
+	struct Lane
+	{
+		QVector<double> q, e, n, t0;
+		QVector<double> Px, Py, Pz, Qx, Qy, Qz;
+		QVector<int> index; //! index of the body in the output arrays
+		void clear();
+		int size() const { return index.size(); }
+	};
+	static void computeElliptic(const Lane& l, double JDE, double* rCosNu, double* rSinNu);
+	static void computeHyperbolic(const Lane& l, double JDE, double* rCosNu, double* rSinNu);
+	static void computeParabolic(const Lane& l, double JDE, double* rCosNu, double* rSinNu);
+	static void scatter(const Lane& l, const double* rCosNu, const double* rSinNu, double* x, double* y, double* z);
+
+	Lane elliptic;
+	Lane hyperbolic;
+	Lane parabolic;
+	int count;
+};
+
+//! @class EllipticalOrbitBatch
+//! Positions of many bodies in EllipticalOrbit orbits at one date.
+//! The bodies are grouped by the method which EllipticalOrbit::eccentricAnomaly() uses for their
+//! eccentricity. EllipticalOrbit solves Kepler's equation with a fixed number of iterations for each
+//! method, so the same iterations are done for all bodies of a group in loops without branches,
+//! which the compiler can vectorize. The positions are those of
+//! EllipticalOrbit::positionAtTimevInVSOP87Coordinates(), up to rounding of the rotation to VSOP87.
+class EllipticalOrbitBatch
+{
+public:
+	EllipticalOrbitBatch() : count(0) {}
+
+	void clear();
+	int size() const { return count; }
+	//! Add a body. The parameters are those of the EllipticalOrbit constructor.
+	//! @return the index of the body in the arrays filled by computePositions()
+	int add(double pericenterDistance, double eccentricity, double inclination, double ascendingNode,
+		double argOfPeriapsis, double meanAnomalyAtEpoch, double period, double epoch,
+		double parentRotObliquity, double parentRotAscendingnode, double parentRotJ2000Longitude);
+	//! Compute the positions [AU] of all bodies relative to their parents at date JDE.
+	//! @param x, y, z arrays receiving size() values
+	void computePositions(double JDE, double* x, double* y, double* z) const;
+
+private:
+	//! Methods of EllipticalOrbit::eccentricAnomaly()
+	enum Method
+	{
+		Circular,
+		LowEccentricity,     //!< e<0.2
+		MediumEccentricity,  //!< e<0.9
+		HighEccentricity,    //!< e<1
+		Parabolic,
+		Hyperbolic,
+		NbMethods
+	};
+	//! Elements of the bodies of one method. P and Q are the first two columns of the rotation to VSOP87.
+	struct Lane
+	{
+		QVector<double> q, e, M0, n, epoch;
+		QVector<double> Px, Py, Pz, Qx, Qy, Qz;
+		QVector<int> index; //! index of the body in the output arrays
+		void clear();
+		int size() const { return index.size(); }
+	};
+	static void computeLane(Method method, const Lane& l, double JDE, double* x, double* y, double* z);
+
+	Lane lanes[NbMethods];
+	int count;
+};
+
 
 class OrbitSampleProc
 {
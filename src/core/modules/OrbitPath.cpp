@@ -0,0 +1,253 @@
+/*
+ * Stellarium
+ * Copyright (C) 2017 Stellarium Developers
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Suite 500, Boston, MA  02110-1335, USA.
+ */
+
+#include "OrbitPath.hpp"
+
+#include <climits>
+#include <cmath>
+
+// Largest distance between the line and the orbit, as an angle seen from the observer [rad]
+static const double MAX_DEVIATION = 5e-4;
+// Largest number of bisections of one segment (up to 2^MAX_DEPTH-1 intermediate samples)
+static const int MAX_DEPTH = 6;
+// Smallest distance to the observer used in the tests [AU], to avoid refining without end close to the observer
+static const double MIN_DISTANCE = 1e-5;
+
+QAtomicInt OrbitPath::frameBudget(20000);
+int OrbitPath::frameSampleBudget = 20000;
+Vec3d OrbitPath::frameObserverPos(0.);
+int OrbitPath::frameNumber = 0;
+int OrbitPath::stalestFrame = INT_MAX;
+QAtomicInt OrbitPath::nextStalestFrame(INT_MAX);
+
+OrbitPath::OrbitPath(int segments)
+	: segments(segments)
+	, head(0)
+	, step(0.)
+	, centerJDE(0.)
+	, valid(false)
+	, postponedFrame(-1)
+{
+}
+
+void OrbitPath::setStep(double s)
+{
+	step = s;
+	valid = false;
+}
+
+void OrbitPath::clear()
+{
+	ring.clear();
+	ring.squeeze();
+	head = 0;
+	valid = false;
+	postponedFrame = -1;
+}
+
+void OrbitPath::beginFrame(int sampleBudget, const Vec3d& observerHelioPos)
+{
+	frameBudget.store(sampleBudget);
+	frameSampleBudget = sampleBudget;
+	frameObserverPos = observerHelioPos;
+	++frameNumber;
+	stalestFrame = nextStalestFrame.fetchAndStoreRelaxed(INT_MAX);
+}
+
+bool OrbitPath::takeBudget(int n)
+{
+	// The paths postponed for the longest time may use a second budget once the budget of the frame
+	// is used up. So each frame serves them first, and the paths postponed later have to wait for them.
+	// The last path served may exceed the budget, it is only a limit of the work per frame.
+	const int limit = (postponedFrame>=0 && postponedFrame<=stalestFrame) ? -frameSampleBudget : 0;
+	int budget = frameBudget.loadAcquire();
+	while (budget>limit)
+	{
+		if (frameBudget.testAndSetRelaxed(budget, budget-n))
+		{
+			postponedFrame = -1;
+			return true;
+		}
+		budget = frameBudget.loadAcquire();
+	}
+
+	if (postponedFrame<0)
+		postponedFrame = frameNumber;
+	int stalest = nextStalestFrame.loadAcquire();
+	while (postponedFrame<stalest && !nextStalestFrame.testAndSetRelaxed(stalest, postponedFrame))
+		stalest = nextStalestFrame.loadAcquire();
+	return false;
+}
+
+bool OrbitPath::update(double dateJDE, const Sampler& sampler, const Vec3d& parentPos, bool recomputeAll)
+{
+	if (step<=0.)
+		return true;
+
+	// Number of steps to move, rounded as in the former Planet::computePosition()
+	const int delta = valid ? static_cast<int>((dateJDE>centerJDE ? 0.5 : -0.5) + (dateJDE-centerJDE)/step) : 0;
+
+	if (valid && !recomputeAll && delta>0 && delta<segments)
+	{
+		if (!takeBudget(delta))
+			return false;
+		for (int j=0; j<delta; ++j)
+		{
+			// The oldest segment becomes the newest one.
+			const double jde = at(segments-1).sample.jde + step;
+			Segment& s = ring[head];
+			s.sample = Sample(jde, sampler.computePos(jde));
+			s.refined.clear();
+			head = (head+1)%segments;
+			refineSegment(segments-2, sampler, parentPos);
+		}
+		centerJDE += delta*step;
+	}
+	else if (valid && !recomputeAll && delta<0 && -delta<segments)
+	{
+		if (!takeBudget(-delta))
+			return false;
+		for (int j=0; j<-delta; ++j)
+		{
+			// The newest segment becomes the oldest one.
+			const double jde = at(0).sample.jde - step;
+			head = (head+segments-1)%segments;
+			Segment& s = ring[head];
+			s.sample = Sample(jde, sampler.computePos(jde));
+			s.refined.clear();
+			at(segments-1).refined.clear();
+			refineSegment(0, sampler, parentPos);
+		}
+		centerJDE += delta*step;
+	}
+	else if (!valid || delta || recomputeAll)
+	{
+		if (!takeBudget(segments))
+			return false;
+		ring.resize(segments);
+		head = 0;
+		for (int d=0; d<segments; ++d)
+		{
+			const double jde = dateJDE + (d-segments/2)*step;
+			ring[d].sample = Sample(jde, sampler.computePos(jde));
+			ring[d].refined.clear();
+		}
+		for (int d=0; d<segments-1; ++d)
+			refineSegment(d, sampler, parentPos);
+		centerJDE = dateJDE;
+		valid = true;
+	}
+	return true;
+}
+
+// Angle between the lines p0-p1 and p1-p2
+static double turningAngle(const Vec3d& p0, const Vec3d& p1, const Vec3d& p2)
+{
+	const Vec3d a = p1-p0;
+	const Vec3d b = p2-p1;
+	const double l = a.length()*b.length();
+	if (l<=0.)
+		return 0.;
+	const double c = (a*b)/l;
+	return std::acos(c>1. ? 1. : (c<-1. ? -1. : c));
+}
+
+void OrbitPath::refineSegment(int i, const Sampler& sampler, const Vec3d& parentPos)
+{
+	Segment& s = at(i);
+	s.refined.clear();
+	if (i+1>=segments)
+		return;
+	const Sample& next = at(i+1).sample;
+
+	// Estimate the distance of the orbit to the line from the turning angles at both ends:
+	// on an arc of angle a, the chord of length c is at c*a/8 from the arc. Using c*a/4 gives some margin.
+	double angle = 0.;
+	if (i>0)
+		angle = turningAngle(at(i-1).sample.pos, s.sample.pos, next.pos);
+	if (i+2<segments)
+		angle = qMax(angle, turningAngle(s.sample.pos, next.pos, at(i+2).sample.pos));
+	const double chord = (next.pos-s.sample.pos).length();
+	const double distance = qMax(MIN_DISTANCE, ((s.sample.pos+next.pos)*0.5+parentPos-frameObserverPos).length());
+	if (chord*angle*0.25 <= MAX_DEVIATION*distance)
+		return;
+
+	const int n = subdivide(s.sample, next, sampler, parentPos, 1, s.refined);
+	frameBudget.fetchAndAddRelaxed(-n);
+}
+
+int OrbitPath::subdivide(const Sample& s0, const Sample& s1, const Sampler& sampler, const Vec3d& parentPos,
+			 int depth, QVector<Sample>& out)
+{
+	const double jde = 0.5*(s0.jde+s1.jde);
+	const Sample s(jde, sampler.computePos(jde));
+	const double distance = qMax(MIN_DISTANCE, (s.pos+parentPos-frameObserverPos).length());
+	const bool finer = depth<MAX_DEPTH && (s.pos-(s0.pos+s1.pos)*0.5).length() > MAX_DEVIATION*distance;
+	int n = 1;
+	if (finer)
+		n += subdivide(s0, s, sampler, parentPos, depth+1, out);
+	out.append(s);
+	if (finer)
+		n += subdivide(s, s1, sampler, parentPos, depth+1, out);
+	return n;
+}
+
+void OrbitPath::getPoints(double dateJDE, const Vec3d& pos, bool close, QVector<Vec3d>& points) const
+{
+	// Keep the capacity of a vector reused by the caller.
+	points.resize(0);
+	if (!valid)
+		return;
+	int count = 2;
+	for (int i=0; i<segments; ++i)
+		count += 1 + at(i).refined.size();
+	points.reserve(count);
+	// While the update is postponed, the date may be outside of the samples.
+	double jde = dateJDE;
+	const double first = at(0).sample.jde;
+	if (close && (jde<first || jde>at(segments-1).sample.jde))
+	{
+		const double period = segments*step;
+		jde = first + std::fmod(std::fmod(jde-first, period)+period, period);
+	}
+	bool inserted = false;
+	for (int i=0; i<segments; ++i)
+	{
+		const Segment& s = at(i);
+		if (!inserted && jde<=s.sample.jde)
+		{
+			points.append(pos);
+			inserted = true;
+		}
+		points.append(s.sample.pos);
+		foreach (const Sample& r, s.refined)
+		{
+			if (!inserted && jde<=r.jde)
+			{
+				points.append(pos);
+				inserted = true;
+			}
+			points.append(r.pos);
+		}
+	}
+	if (!inserted)
+		points.append(pos);
+	if (close && !points.isEmpty())
+		points.append(points.first());
+}
@@ -0,0 +1,131 @@
+/*
+ * Stellarium
+ * Copyright (C) 2017 Stellarium Developers
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Suite 500, Boston, MA  02110-1335, USA.
+ */
+
+#ifndef _ORBITPATH_HPP_
+#define _ORBITPATH_HPP_
+
+#include "VecMath.hpp"
+
+#include <QAtomicInt>
+#include <QVector>
+
+//! @class OrbitPath
+//! Cached samples of the orbit line of a body, in the coordinates relative to its parent.
+//! The samples are spaced by a base time step (a fraction of the orbital period) and centered
+//! on the date of the last update. They are kept in a ring buffer: when the date moves by a few
+//! steps, the samples at one end are dropped and new ones are computed at the other end only.
+//! Where the line between two samples would visibly differ from the orbit as seen from the observer
+//! (near the pericenter of eccentric orbits, or for orbits close to the observer), intermediate
+//! samples are added by bisection.
+//!
+//! All paths share a budget of samples per frame, given to beginFrame(). When it is used up, the
+//! updates of the remaining paths are postponed to the next frames and the old lines are drawn
+//! meanwhile, so that showing the orbits of many bodies does not stall the animation. The paths
+//! postponed for the longest time may overdraw the budget, so that they are updated before the
+//! paths postponed later, whatever the order of the calls to update().
+//! update() may be called from several threads for different paths.
+class OrbitPath
+{
+public:
+	//! Computes the position of the body relative to its parent at a date.
+	class Sampler
+	{
+	public:
+		virtual ~Sampler() {}
+		virtual Vec3d computePos(double jde) const = 0;
+	};
+
+	//! @param segments number of base samples
+	OrbitPath(int segments);
+
+	//! Set the time between the base samples [d]. 0 means no orbit line. Invalidates the samples.
+	void setStep(double step);
+	double getStep() const {return step;}
+
+	bool isValid() const {return valid;}
+	//! Whether the samples have to be moved for the date dateJDE.
+	bool needsUpdate(double dateJDE) const {return !valid || fabs(centerJDE-dateJDE)>step;}
+	//! Move the samples to be centered on dateJDE.
+	//! @param parentPos heliocentric position of the parent, to estimate the distances to the observer
+	//! @param recomputeAll compute all samples again, e.g. when they depend on dateJDE (osculating orbits)
+	//! @return false if the update was postponed because the budget of the frame is used up.
+	bool update(double dateJDE, const Sampler& sampler, const Vec3d& parentPos, bool recomputeAll=false);
+	//! Release the samples.
+	void clear();
+
+	//! Get the points of the line in the order of their dates.
+	//! @param dateJDE, pos the current date and position of the body, inserted between the samples
+	//! so that the line always goes through the body, also when the update of the samples was postponed.
+	//! @param close append the first point at the end. The samples then cover one period, and
+	//! a date outside of them is moved by whole periods.
+	//! @param points receives the points. Its capacity is kept, so that a caller can reuse it at every frame.
+	void getPoints(double dateJDE, const Vec3d& pos, bool close, QVector<Vec3d>& points) const;
+
+	//! Start a new frame: reset the budget of new samples shared by all paths.
+	//! Must not be called while paths are updated.
+	//! @param observerHelioPos heliocentric position of the observer
+	static void beginFrame(int sampleBudget, const Vec3d& observerHelioPos);
+
+private:
+	struct Sample
+	{
+		Sample() : jde(0.) {}
+		Sample(double jde, const Vec3d& pos) : jde(jde), pos(pos) {}
+		double jde;
+		Vec3d pos;
+	};
+	//! A base sample and the intermediate samples up to the next base sample.
+	struct Segment
+	{
+		Sample sample;
+		QVector<Sample> refined;
+	};
+
+	//! Segment i counted from the oldest one.
+	Segment& at(int i) {return ring[(head+i)%segments];}
+	const Segment& at(int i) const {return ring[(head+i)%segments];}
+	//! Compute the intermediate samples of segment i.
+	void refineSegment(int i, const Sampler& sampler, const Vec3d& parentPos);
+	//! Add samples between p0 and p1 by bisection. Return the number of samples computed.
+	static int subdivide(const Sample& s0, const Sample& s1, const Sampler& sampler, const Vec3d& parentPos,
+			     int depth, QVector<Sample>& out);
+	//! Take n samples from the budget of the frame. Return false if the budget is used up,
+	//! the path is then postponed.
+	bool takeBudget(int n);
+
+	const int segments;
+	QVector<Segment> ring;
+	int head;
+	double step;
+	double centerJDE;
+	bool valid;
+	//! Frame in which the update was first postponed, -1 if not postponed.
+	int postponedFrame;
+
+	static QAtomicInt frameBudget;
+	static int frameSampleBudget;
+	static Vec3d frameObserverPos;
+	static int frameNumber;
+	//! Smallest postponedFrame of the paths postponed in the previous frame.
+	static int stalestFrame;
+	//! Smallest postponedFrame of the paths postponed in the current frame.
+	static QAtomicInt nextStalestFrame;
+};
+
+#endif // _ORBITPATH_HPP_
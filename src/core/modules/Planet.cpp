@@ -184,10 +184,8 @@ Planet::Planet(const QString& englishName,
 	       const QString& pTypeStr)
 	: flagNativeName(true),
 	  flagTranslatedName(true),
-	  lastOrbitJDE(0.0),
+	  orbitPath(ORBIT_SEGMENTS),
 	  deltaJDE(StelCore::JD_SECOND),
-	  deltaOrbitJDE(0.0),
-	  orbitCached(false),
 	  closeOrbit(acloseOrbit),
 	  englishName(englishName),
 	  nameI18(englishName),
@@ -683,7 +681,7 @@ void Planet::setRotationElements(float _period, float _offset, double _epoch, fl
 	re.precessionRate = _precessionRate;
 	re.siderealPeriod = _siderealPeriod;  // used for drawing orbit lines
 
-	deltaOrbitJDE = re.siderealPeriod/ORBIT_SEGMENTS;
+	orbitPath.setStep(re.siderealPeriod/ORBIT_SEGMENTS);
 }
 
 Vec3d Planet::getJ2000EquatorialPos(const StelCore *core) const
@@ -694,6 +692,24 @@ Vec3d Planet::getJ2000EquatorialPos(const StelCore *core) const
 		return StelCore::matVsop87ToJ2000.multiplyWithoutTranslation(getHeliocentricEclipticPos() - core->getObserverHeliocentricEclipticPos());
 }
 
+class Planet::PathSampler : public OrbitPath::Sampler
+{
+public:
+	PathSampler(const Planet* planet, double dateJDE) : planet(planet), dateJDE(dateJDE) {}
+	virtual Vec3d computePos(double jde) const
+	{
+		double xyz[3];
+		if (planet->osculatingFunc)
+			(*planet->osculatingFunc)(dateJDE, jde, xyz);
+		else
+			planet->coordFunc(jde, xyz, planet->orbitPtr);
+		return Vec3d(xyz[0], xyz[1], xyz[2]);
+	}
+private:
+	const Planet* planet;
+	double dateJDE;
+};
+
 // Compute the position in the parent Planet coordinate system
 // Actually call the provided function to compute the ecliptical position
 void Planet::computePositionWithoutOrbits(const double dateJDE)
@@ -776,133 +792,23 @@ void Planet::computePosition(const double dateJDE)
 {
 	// Make sure the parent position is computed for the dateJDE, otherwise
 	// getHeliocentricPos() would return incorrect values.
-	if (parent)
+	// The position of the Sun is always 0, so it is not touched here: this allows
+	// SolarSystem::computePositions() to compute the planets in several threads.
+	if (parent && parent->parent)
 		parent->computePositionWithoutOrbits(dateJDE);
 
-	if (orbitFader.getInterstate()>0.000001 && deltaOrbitJDE > 0 && (fabs(lastOrbitJDE-dateJDE)>deltaOrbitJDE || !orbitCached))
+	if (orbitFader.getInterstate()>0.000001 && orbitPath.needsUpdate(dateJDE))
 	{
-		StelCore *core=StelApp::getInstance().getCore();
-
-		double calc_date;
-		// int delta_points = (int)(0.5 + (date - lastOrbitJD)/date_increment);
-		int delta_points;
-
-		if( dateJDE > lastOrbitJDE )
-		{
-			delta_points = (int)(0.5 + (dateJDE - lastOrbitJDE)/deltaOrbitJDE);
-		}
-		else
-		{
-			delta_points = (int)(-0.5 + (dateJDE - lastOrbitJDE)/deltaOrbitJDE);
-		}
-		double new_date = lastOrbitJDE + delta_points*deltaOrbitJDE;
-
-		// qDebug( "Updating orbit coordinates for %s (delta %f) (%d points)\n", getEnglishName().toUtf8().data(), deltaOrbitJDE, delta_points);
-
-		if( delta_points > 0 && delta_points < ORBIT_SEGMENTS && orbitCached)
-		{
-
-			for( int d=0; d<ORBIT_SEGMENTS; d++ )
-			{
-				if(d + delta_points >= ORBIT_SEGMENTS-1 )
-				{
-					// calculate new points
-					calc_date = new_date + (d-ORBIT_SEGMENTS/2)*deltaOrbitJDE;
-
-					// date increments between points will not be completely constant though
-					computeTransMatrix(calc_date-core->computeDeltaT(calc_date)/86400.0, calc_date);
-					if (osculatingFunc)
-					{
-						(*osculatingFunc)(dateJDE,calc_date,eclipticPos);
-					}
-					else
-					{
-						coordFunc(calc_date, eclipticPos, orbitPtr);
-					}
-					orbitP[d] = eclipticPos;
-					orbit[d] = getHeliocentricEclipticPos();
-				}
-				else
-				{
-					orbitP[d] = orbitP[d+delta_points];
-					orbit[d] = getHeliocentricPos(orbitP[d]);
-				}
-			}
-
-			lastOrbitJDE = new_date;
-		}
-		else if( delta_points < 0 && abs(delta_points) < ORBIT_SEGMENTS  && orbitCached)
-		{
-
-			for( int d=ORBIT_SEGMENTS-1; d>=0; d-- )
-			{
-				if(d + delta_points < 0 )
-				{
-					// calculate new points
-					calc_date = new_date + (d-ORBIT_SEGMENTS/2)*deltaOrbitJDE;
-
-					computeTransMatrix(calc_date-core->computeDeltaT(calc_date)/86400.0, calc_date);
-					if (osculatingFunc) {
-						(*osculatingFunc)(dateJDE,calc_date,eclipticPos);
-					}
-					else
-					{
-						coordFunc(calc_date, eclipticPos, orbitPtr);
-					}
-					orbitP[d] = eclipticPos;
-					orbit[d] = getHeliocentricEclipticPos();
-				}
-				else
-				{
-					orbitP[d] = orbitP[d+delta_points];
-					orbit[d] = getHeliocentricPos(orbitP[d]);
-				}
-			}
-
-			lastOrbitJDE = new_date;
-
-		}
-		else if( delta_points || !orbitCached)
-		{
-
-			// update all points (less efficient)
-			for( int d=0; d<ORBIT_SEGMENTS; d++ )
-			{
-				calc_date = dateJDE + (d-ORBIT_SEGMENTS/2)*deltaOrbitJDE;
-				computeTransMatrix(calc_date-core->computeDeltaT(calc_date)/86400.0, calc_date);
-				if (osculatingFunc)
-				{
-					(*osculatingFunc)(dateJDE,calc_date,eclipticPos);
-				}
-				else
-				{
-					coordFunc(calc_date, eclipticPos, orbitPtr);
-				}
-				orbitP[d] = eclipticPos;
-				orbit[d] = getHeliocentricEclipticPos();
-			}
-
-			lastOrbitJDE = dateJDE;
-			if (!osculatingFunc) orbitCached = 1;
-		}
-
-
-		// calculate actual Planet position
-		coordFunc(dateJDE, eclipticPos, orbitPtr);
-
-		lastJDE = dateJDE;
-
+		// The samples of osculating orbits depend on dateJDE and are all computed again.
+		orbitPath.update(dateJDE, PathSampler(this, dateJDE), getHeliocentricPos(Vec3d(0.)), osculatingFunc!=Q_NULLPTR);
 	}
-	else if (fabs(lastJDE-dateJDE)>deltaJDE)
+
+	if (fabs(lastJDE-dateJDE)>deltaJDE)
 	{
 		// calculate actual Planet position
 		coordFunc(dateJDE, eclipticPos, orbitPtr);
-		if (orbitFader.getInterstate()>0.000001)
-			for( int d=0; d<ORBIT_SEGMENTS; d++ )
-				orbit[d]=getHeliocentricPos(orbitP[d]);
 		lastJDE = dateJDE;
 	}
-
 }
 
 // Compute the transformation matrix from the local Planet coordinate system to the parent Planet coordinate system.
@@ -917,35 +823,39 @@ void Planet::computeTransMatrix(double JD, double JDE)
 	// not solar equator...
 
 	if (parent)
+		rotLocalToParent = computeRotLocalToParent(JDE);
+}
+
+Mat4d Planet::computeRotLocalToParent(double JDE) const
+{
+	Q_ASSERT(parent);
+	// We can inject a proper precession plus even nutation matrix in this stage, if available.
+	if (englishName=="Earth")
 	{
-		// We can inject a proper precession plus even nutation matrix in this stage, if available.
-		if (englishName=="Earth")
+		// rotLocalToParent = Mat4d::zrotation(re.ascendingNode - re.precessionRate*(jd-re.epoch)) * Mat4d::xrotation(-getRotObliquity(jd));
+		// We follow Capitaine's (2003) formulation P=Rz(Chi_A)*Rx(-omega_A)*Rz(-psi_A)*Rx(eps_o).
+		// ADS: 2011A&A...534A..22V = A&A 534, A22 (2011): Vondrak, Capitane, Wallace: New Precession Expressions, valid for long time intervals:
+		// See also Hilton et al., Report on Precession and the Ecliptic. Cel.Mech.Dyn.Astr. 94:351-367 (2006), eqn (6) and (21).
+		double eps_A, chi_A, omega_A, psi_A;
+		getPrecessionAnglesVondrak(JDE, &eps_A, &chi_A, &omega_A, &psi_A);
+		// Canonical precession rotations: Nodal rotation psi_A,
+		// then rotation by omega_A, the angle between EclPoleJ2000 and EarthPoleOfDate.
+		// The final rotation by chi_A rotates the equinox (zero degree).
+		// To achieve ecliptical coords of date, you just have now to add a rotX by epsilon_A (obliquity of date).
+
+		Mat4d rot = Mat4d::zrotation(-psi_A) * Mat4d::xrotation(-omega_A) * Mat4d::zrotation(chi_A);
+		// Plus nutation IAU-2000B:
+		if (StelApp::getInstance().getCore()->getUseNutation())
 		{
-			// rotLocalToParent = Mat4d::zrotation(re.ascendingNode - re.precessionRate*(jd-re.epoch)) * Mat4d::xrotation(-getRotObliquity(jd));
-			// We follow Capitaine's (2003) formulation P=Rz(Chi_A)*Rx(-omega_A)*Rz(-psi_A)*Rx(eps_o).
-			// ADS: 2011A&A...534A..22V = A&A 534, A22 (2011): Vondrak, Capitane, Wallace: New Precession Expressions, valid for long time intervals:
-			// See also Hilton et al., Report on Precession and the Ecliptic. Cel.Mech.Dyn.Astr. 94:351-367 (2006), eqn (6) and (21).
-			double eps_A, chi_A, omega_A, psi_A;
-			getPrecessionAnglesVondrak(JDE, &eps_A, &chi_A, &omega_A, &psi_A);
-			// Canonical precession rotations: Nodal rotation psi_A,
-			// then rotation by omega_A, the angle between EclPoleJ2000 and EarthPoleOfDate.
-			// The final rotation by chi_A rotates the equinox (zero degree).
-			// To achieve ecliptical coords of date, you just have now to add a rotX by epsilon_A (obliquity of date).
-
-			rotLocalToParent= Mat4d::zrotation(-psi_A) * Mat4d::xrotation(-omega_A) * Mat4d::zrotation(chi_A);
-			// Plus nutation IAU-2000B:
-			if (StelApp::getInstance().getCore()->getUseNutation())
-			{
-				double deltaEps, deltaPsi;
-				getNutationAngles(JDE, &deltaPsi, &deltaEps);
-				//qDebug() << "deltaEps, arcsec" << deltaEps*180./M_PI*3600. << "deltaPsi" << deltaPsi*180./M_PI*3600.;
-				Mat4d nut2000B=Mat4d::xrotation(eps_A) * Mat4d::zrotation(deltaPsi)* Mat4d::xrotation(-eps_A-deltaEps);
-				rotLocalToParent=rotLocalToParent*nut2000B;
-			}
+			double deltaEps, deltaPsi;
+			getNutationAngles(JDE, &deltaPsi, &deltaEps);
+			//qDebug() << "deltaEps, arcsec" << deltaEps*180./M_PI*3600. << "deltaPsi" << deltaPsi*180./M_PI*3600.;
+			Mat4d nut2000B=Mat4d::xrotation(eps_A) * Mat4d::zrotation(deltaPsi)* Mat4d::xrotation(-eps_A-deltaEps);
+			rot=rot*nut2000B;
 		}
-		else
-			rotLocalToParent = Mat4d::zrotation(re.ascendingNode - re.precessionRate*(JDE-re.epoch)) * Mat4d::xrotation(re.obliquity);
+		return rot;
 	}
+	return Mat4d::zrotation(re.ascendingNode - re.precessionRate*(JDE-re.epoch)) * Mat4d::xrotation(re.obliquity);
 }
 
 Mat4d Planet::getRotEquatorialToVsop87(void) const
@@ -1194,16 +1104,29 @@ float Planet::getMeanOppositionMagnitude() const
 
 // Computation of the visual magnitude (V band) of the planet.
 float Planet::getVMagnitude(const StelCore* core) const
+{
+	static SolarSystem *ssystem=GETSTELMODULE(SolarSystem);
+	MagnitudeGeometry g;
+	g.observerHelioPos = core->getObserverHeliocentricEclipticPos();
+	g.planetHelioPos = getHeliocentricEclipticPos();
+	g.parentHelioPos = parent ? parent->getHeliocentricEclipticPos() : Vec3d(0.);
+	g.earthHelioPos = ssystem->getEarth()->getHeliocentricEclipticPos();
+	g.jde = core->getJDE();
+	g.observerOnEarth = (core->getCurrentLocation().planetName=="Earth");
+	g.sunShadowFactor = parent ? 1. : ssystem->getEclipseFactor(core);
+	return computeVMagnitude(g);
+}
+
+float Planet::computeVMagnitude(const MagnitudeGeometry& g) const
 {
 	if (parent == 0)
 	{
 		// Sun, compute the apparent magnitude for the absolute mag (V: 4.83) and observer's distance
 		// Hint: Absolute Magnitude of the Sun in Several Bands: http://mips.as.arizona.edu/~cnaw/sun.html
-		const double distParsec = std::sqrt(core->getObserverHeliocentricEclipticPos().lengthSquared())*AU/PARSEC;
+		const double distParsec = std::sqrt(g.observerHelioPos.lengthSquared())*AU/PARSEC;
 
 		// check how much of it is visible
-		const SolarSystem* ssm = GETSTELMODULE(SolarSystem);
-		double shadowFactor = ssm->getEclipseFactor(core);
+		double shadowFactor = g.sunShadowFactor;
 		// See: Hughes, D. W., Brightness during a solar eclipse // Journal of the British Astronomical Association, vol.110, no.4, p.203-205
 		// URL: http://adsabs.harvard.edu/abs/2000JBAA..110..203H
 		if(shadowFactor < 0.000128)
@@ -1213,9 +1136,9 @@ float Planet::getVMagnitude(const StelCore* core) const
 	}
 
 	// Compute the phase angle i. We need the intermediate results also below, therefore we don't just call getPhaseAngle.
-	const Vec3d& observerHelioPos = core->getObserverHeliocentricEclipticPos();
+	const Vec3d& observerHelioPos = g.observerHelioPos;
 	const double observerRq = observerHelioPos.lengthSquared();
-	const Vec3d& planetHelioPos = getHeliocentricEclipticPos();
+	const Vec3d& planetHelioPos = g.planetHelioPos;
 	const double planetRq = planetHelioPos.lengthSquared();
 	const double observerPlanetRq = (observerHelioPos - planetHelioPos).lengthSquared();
 	const double cos_chi = (observerPlanetRq + planetRq - observerRq)/(2.0*std::sqrt(observerPlanetRq*planetRq));
@@ -1225,7 +1148,7 @@ float Planet::getVMagnitude(const StelCore* core) const
 	// Check if the satellite is inside the inner shadow of the parent planet:
 	if (parent->parent != 0)
 	{
-		const Vec3d& parentHeliopos = parent->getHeliocentricEclipticPos();
+		const Vec3d& parentHeliopos = g.parentHelioPos;
 		const double parent_Rq = parentHeliopos.lengthSquared();
 		const double pos_times_parent_pos = planetHelioPos * parentHeliopos;
 		if (pos_times_parent_pos > parent_Rq)
@@ -1262,7 +1185,7 @@ float Planet::getVMagnitude(const StelCore* core) const
 	}
 
 	// Use empirical formulae for main planets when seen from earth
-	if (core->getCurrentLocation().planetName=="Earth")
+	if (g.observerOnEarth)
 	{
 		const double phaseDeg=phaseAngle*180./M_PI;
 		const double d = 5. * log10(std::sqrt(observerPlanetRq*planetRq));
@@ -1308,12 +1231,11 @@ float Planet::getVMagnitude(const StelCore* core) const
 				{
 					// add rings computation
 					// implemented from Meeus, Astr.Alg.1992
-					const double jde=core->getJDE();
+					const double jde=g.jde;
 					const double T=(jde-2451545.0)/36525.0;
 					const double i=((0.000004*T-0.012998)*T+28.075216)*M_PI/180.0;
 					const double Omega=((0.000412*T+1.394681)*T+169.508470)*M_PI/180.0;
-					static SolarSystem *ssystem=GETSTELMODULE(SolarSystem);
-					const Vec3d saturnEarth=getHeliocentricEclipticPos() - ssystem->getEarth()->getHeliocentricEclipticPos();
+					const Vec3d saturnEarth=g.planetHelioPos - g.earthHelioPos;
 					double lambda=atan2(saturnEarth[1], saturnEarth[0]);
 					double beta=atan2(saturnEarth[2], std::sqrt(saturnEarth[0]*saturnEarth[0]+saturnEarth[1]*saturnEarth[1]));
 					const double sinx=sin(i)*cos(beta)*sin(lambda-Omega)-cos(i)*sin(beta);
@@ -1367,12 +1289,11 @@ float Planet::getVMagnitude(const StelCore* core) const
 				{
 					// add rings computation
 					// implemented from Meeus, Astr.Alg.1992
-					const double jde=core->getJDE();
+					const double jde=g.jde;
 					const double T=(jde-2451545.0)/36525.0;
 					const double i=((0.000004*T-0.012998)*T+28.075216)*M_PI/180.0;
 					const double Omega=((0.000412*T+1.394681)*T+169.508470)*M_PI/180.0;
-					static SolarSystem *ssystem=GETSTELMODULE(SolarSystem);
-					const Vec3d saturnEarth=getHeliocentricEclipticPos() - ssystem->getEarth()->getHeliocentricEclipticPos();
+					const Vec3d saturnEarth=g.planetHelioPos - g.earthHelioPos;
 					double lambda=atan2(saturnEarth[1], saturnEarth[0]);
 					double beta=atan2(saturnEarth[2], std::sqrt(saturnEarth[0]*saturnEarth[0]+saturnEarth[1]*saturnEarth[1]));
 					const double sinx=sin(i)*cos(beta)*sin(lambda-Omega)-cos(i)*sin(beta);
@@ -1406,12 +1327,11 @@ float Planet::getVMagnitude(const StelCore* core) const
 				{
 					// add rings computation
 					// implemented from Meeus, Astr.Alg.1992
-					const double jde=core->getJDE();
+					const double jde=g.jde;
 					const double T=(jde-2451545.0)/36525.0;
 					const double i=((0.000004*T-0.012998)*T+28.075216)*M_PI/180.0;
 					const double Omega=((0.000412*T+1.394681)*T+169.508470)*M_PI/180.0;
-					SolarSystem *ssystem=GETSTELMODULE(SolarSystem);
-					const Vec3d saturnEarth=getHeliocentricEclipticPos() - ssystem->getEarth()->getHeliocentricEclipticPos();
+					const Vec3d saturnEarth=g.planetHelioPos - g.earthHelioPos;
 					double lambda=atan2(saturnEarth[1], saturnEarth[0]);
 					double beta=atan2(saturnEarth[2], std::sqrt(saturnEarth[0]*saturnEarth[0]+saturnEarth[1]*saturnEarth[1]));
 					const double sinB=sin(i)*cos(beta)*sin(lambda-Omega)-cos(i)*sin(beta);
@@ -1443,12 +1363,11 @@ float Planet::getVMagnitude(const StelCore* core) const
 				{
 					// add rings computation
 					// implemented from Meeus, Astr.Alg.1992
-					const double jde=core->getJDE();
+					const double jde=g.jde;
 					const double T=(jde-2451545.0)/36525.0;
 					const double i=((0.000004*T-0.012998)*T+28.075216)*M_PI/180.0;
 					const double Omega=((0.000412*T+1.394681)*T+169.508470)*M_PI/180.0;
-					static SolarSystem *ssystem=GETSTELMODULE(SolarSystem);
-					const Vec3d saturnEarth=getHeliocentricEclipticPos() - ssystem->getEarth()->getHeliocentricEclipticPos();
+					const Vec3d saturnEarth=g.planetHelioPos - g.earthHelioPos;
 					double lambda=atan2(saturnEarth[1], saturnEarth[0]);
 					double beta=atan2(saturnEarth[2], std::sqrt(saturnEarth[0]*saturnEarth[0]+saturnEarth[1]*saturnEarth[1]));
 					const double sinB=sin(i)*cos(beta)*sin(lambda-Omega)-cos(i)*sin(beta);
@@ -3034,19 +2953,22 @@ void Planet::drawOrbit(const StelCore* core)
 
 	sPainter.setColor(orbColor[0], orbColor[1], orbColor[2], orbitFader.getInterstate());
 	Vec3d onscreen;
-	// special case - use current Planet position as center vertex so that draws
-	// on its orbit all the time (since segmented rather than smooth curve)
-	Vec3d savePos = orbit[ORBIT_SEGMENTS/2];
-	orbit[ORBIT_SEGMENTS/2]=getHeliocentricEclipticPos();
-	orbit[ORBIT_SEGMENTS]=orbit[0];
-	int nbIter = closeOrbit ? ORBIT_SEGMENTS : ORBIT_SEGMENTS-1;
-	QVarLengthArray<float, 1024> vertexArray;
+	// The current Planet position is inserted between the samples so that the line
+	// always goes through the planet (since segmented rather than smooth curve)
+	// The buffers are shared by all planets and keep their capacity between frames.
+	static QVector<Vec3d> points;
+	static QVarLengthArray<float, 1024> vertexArray;
+	orbitPath.getPoints(lastJDE, eclipticPos, closeOrbit, points);
+	vertexArray.clear();
+	const Vec3d parentPos = getHeliocentricPos(Vec3d(0.));
+	Vec3d pos, lastPos;
 
 	sPainter.enableClientStates(true, false, false);
 
-	for (int n=0; n<=nbIter; ++n)
+	for (int n=0; n<points.size(); ++n)
 	{
-		if (prj->project(orbit[n],onscreen) && (vertexArray.size()==0 || !prj->intersectViewportDiscontinuity(orbit[n-1], orbit[n])))
+		pos = points.at(n)+parentPos;
+		if (prj->project(pos,onscreen) && (vertexArray.size()==0 || !prj->intersectViewportDiscontinuity(lastPos, pos)))
 		{
 			vertexArray.append(onscreen[0]);
 			vertexArray.append(onscreen[1]);
@@ -3057,8 +2979,8 @@ void Planet::drawOrbit(const StelCore* core)
 			sPainter.drawFromArray(StelPainter::LineStrip, vertexArray.size()/2, 0, false);
 			vertexArray.clear();
 		}
+		lastPos = pos;
 	}
-	orbit[ORBIT_SEGMENTS/2]=savePos;
 	if (!vertexArray.isEmpty())
 	{
 		sPainter.setVertexPointer(2, GL_FLOAT, vertexArray.constData());
@@ -3072,6 +2994,9 @@ void Planet::update(int deltaTime)
 	hintFader.update(deltaTime);
 	labelsFader.update(deltaTime);
 	orbitFader.update(deltaTime);
+	// Release the orbit line once it has faded out.
+	if (!orbitFader && orbitFader.getInterstate()<=0.f && orbitPath.isValid())
+		orbitPath.clear();
 }
 
 void Planet::setApparentMagnitudeAlgorithm(QString algorithm)
@@ -25,6 +25,7 @@
 #include "VecMath.hpp"
 #include "GeomMath.hpp"
 #include "StelFader.hpp"
+#include "OrbitPath.hpp"
 #include "StelTextureTypes.hpp"
 #include "StelProjectorType.hpp"
 
@@ -85,6 +86,7 @@ class Planet : public StelObject
 public:
 	static const QString PLANET_TYPE;
 	friend class SolarSystem;
+	friend class EphemerisEngine;
 
 	Q_ENUMS(PlanetType)
 	Q_ENUMS(PlanetOrbitColorStyle)
@@ -189,6 +191,24 @@ public:
 	virtual double getSatellitesFov(const StelCore* core) const;
 	virtual double getParentSatellitesFov(const StelCore* core) const;
 	virtual float getVMagnitude(const StelCore* core) const;
+
+	//! Positions and date needed to compute the apparent magnitude of a Planet
+	//! without relying on the current state of the solar system, see computeVMagnitude().
+	struct MagnitudeGeometry
+	{
+		Vec3d observerHelioPos;  //!< heliocentric ecliptic position of the observer
+		Vec3d planetHelioPos;    //!< heliocentric ecliptic position of the planet
+		Vec3d parentHelioPos;    //!< heliocentric ecliptic position of the parent planet (shadow of moons)
+		Vec3d earthHelioPos;     //!< heliocentric ecliptic position of the Earth (Saturn's rings)
+		double jde;              //!< date of the positions
+		bool observerOnEarth;    //!< use the empirical formulae for the planets
+		double sunShadowFactor;  //!< visible fraction of the Sun during eclipses, only used for the Sun
+	};
+	//! Compute the apparent visual magnitude for the given geometry.
+	//! getVMagnitude() calls this with the current positions. It uses no other state, so it is safe
+	//! to call from other threads and for other dates, e.g. by EphemerisEngine.
+	virtual float computeVMagnitude(const MagnitudeGeometry& g) const;
+
 	virtual float getSelectPriority(const StelCore* core) const;
 	virtual Vec3f getInfoColor(void) const;
 	virtual QString getType(void) const {return PLANET_TYPE;}
@@ -275,6 +295,9 @@ public:
 	//! Compute the transformation matrix from the local Planet coordinate to the parent Planet coordinate.
 	//! This requires both flavours of JD in cases involving Earth.
 	void computeTransMatrix(double JD, double JDE);
+	//! Compute the matrix set by computeTransMatrix() for the date JDE without changing the Planet.
+	//! The Planet must have a parent.
+	Mat4d computeRotLocalToParent(double JDE) const;
 
 	//! Get the phase angle (rad) for an observer at pos obsPos in heliocentric coordinates (in AU)
 	double getPhaseAngle(const Vec3d& obsPos) const;
@@ -335,12 +358,8 @@ public:
 	LinearFader orbitFader;
 	// draw orbital path of Planet
 	void drawOrbit(const StelCore*);
-	Vec3d orbit[ORBIT_SEGMENTS+1];  // store heliocentric coordinates for drawing the orbit
-	Vec3d orbitP[ORBIT_SEGMENTS+1]; // store local coordinate for orbit
-	double lastOrbitJDE;
+	OrbitPath orbitPath;            // samples of the orbit line, in local coordinates
 	double deltaJDE;                // time difference between positional updates.
-	double deltaOrbitJDE;
-	bool orbitCached;               // whether orbit calculations are cached for drawing orbit yet
 	bool closeOrbit;                // whether to connect the beginning of the orbit line to
 					// the end: good for elliptical orbits, bad for parabolic
 					// and hyperbolic orbits
@@ -563,6 +582,9 @@ protected:
 private:
 	QString iauMoonNumber;
 
+	//! Samples the orbit line for orbitPath.
+	class PathSampler;
+
 	// Shader-related variables
 	struct PlanetShaderVars {
 		// Vertex attributes
@@ -0,0 +1,138 @@
+/*
+ * Stellarium
+ * Copyright (C) 2017 Stellarium Developers
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Suite 500, Boston, MA  02110-1335, USA.
+ */
+
+#ifndef _PLANETSCHEDULER_HPP_
+#define _PLANETSCHEDULER_HPP_
+
+#include <QHash>
+#include <QList>
+#include <QtConcurrent>
+
+//! @class PlanetScheduler
+//! Applies a computation step to all bodies of a hierarchy (Sun, planets, moons) using several threads,
+//! with the same result as applying it serially in the original order.
+//! Computing a body may read and update its parents (e.g. Planet::computePosition() updates the
+//! position of the parent), but not the root (the Sun) nor other bodies. The bodies are split into:
+//! - the serial bodies, which are computed first in the calling thread, in the original order.
+//!   These are all bodies whose computation is not thread-safe (e.g. the planetary theories with
+//!   static caches), and their whole families.
+//! - groups formed by one child of the root and all its descendants, in the original order.
+//!   Each group is computed by one thread, different groups in parallel.
+//! BodyP is a (smart) pointer to a body class with a getParent() method.
+template<class BodyP> class PlanetScheduler
+{
+public:
+	//! Split bodies into serial bodies and independent groups.
+	//! @param bodies all bodies, in the order in which they would be computed serially
+	//! @param isThreadSafe predicate telling whether a body may be computed in any thread
+	template<class Predicate> void build(const QList<BodyP>& bodies, Predicate isThreadSafe)
+	{
+		serialBodies.clear();
+		groups.clear();
+
+		// First pass: find the top ancestor (the child of the root) of each body, and whether all
+		// members of its family can be computed in another thread.
+		QList<BodyP> tops;
+		QHash<BodyP, bool> familyThreadSafe;
+		foreach (const BodyP& b, bodies)
+		{
+			BodyP top = getTop(b);
+			tops.append(top);
+			if (top)
+			{
+				typename QHash<BodyP, bool>::iterator it = familyThreadSafe.find(top);
+				if (it==familyThreadSafe.end())
+					familyThreadSafe.insert(top, isThreadSafe(b));
+				else if (!isThreadSafe(b))
+					it.value() = false;
+			}
+		}
+
+		// Second pass: distribute the bodies, keeping their order.
+		QHash<BodyP, int> groupIndex;
+		for (int i=0; i<bodies.size(); ++i)
+		{
+			const BodyP& top = tops.at(i);
+			if (!top || !familyThreadSafe.value(top))
+			{
+				serialBodies.append(bodies.at(i));
+				continue;
+			}
+			typename QHash<BodyP, int>::const_iterator it = groupIndex.constFind(top);
+			if (it==groupIndex.constEnd())
+			{
+				it = groupIndex.insert(top, groups.size());
+				groups.append(QList<BodyP>());
+			}
+			groups[it.value()].append(bodies.at(i));
+		}
+	}
+
+	const QList<BodyP>& getSerialBodies() const {return serialBodies;}
+	const QList<QList<BodyP> >& getGroups() const {return groups;}
+
+	//! Apply step to every body: first the serial bodies in the calling thread, then the groups
+	//! in the global thread pool. Returns when all bodies are done.
+	//! @param step functor called as step(body). It is copied for each thread.
+	//! @param parallel if false, the groups are computed in the calling thread as well.
+	template<class Step> void run(const Step& step, bool parallel=true)
+	{
+		foreach (const BodyP& b, serialBodies)
+			step(b);
+		if (parallel && groups.size()>1)
+			QtConcurrent::blockingMap(groups, GroupRunner<Step>(step));
+		else
+		{
+			foreach (const QList<BodyP>& group, groups)
+			{
+				foreach (const BodyP& b, group)
+					step(b);
+			}
+		}
+	}
+
+private:
+	//! Return the ancestor of b which is a child of the root, b itself if it is one, or a null pointer for the root.
+	static BodyP getTop(BodyP b)
+	{
+		if (!b->getParent())
+			return BodyP();
+		while (b->getParent()->getParent())
+			b = b->getParent();
+		return b;
+	}
+
+	template<class Step> class GroupRunner
+	{
+	public:
+		GroupRunner(const Step& step) : step(step) {}
+		void operator()(const QList<BodyP>& group) const
+		{
+			foreach (const BodyP& b, group)
+				step(b);
+		}
+	private:
+		Step step;
+	};
+
+	QList<BodyP> serialBodies;
+	QList<QList<BodyP> > groups;
+};
+
+#endif // _PLANETSCHEDULER_HPP_
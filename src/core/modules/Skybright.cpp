@@ -21,9 +21,11 @@
 
 #include "Skybright.hpp"
 #include "StelUtils.hpp"
+#ifndef UNIT_TEST
 #include "StelApp.hpp"
 #include "StelModuleMgr.hpp"
 #include "SolarSystem.hpp"
+#endif
 
 Skybright::Skybright() : SN(1.f)
 {
@@ -102,11 +104,26 @@ float Skybright::getLuminance( float cosDistMoon,
                                const float cosDistSun,
                                const float cosDistZenith) const
 {
+#ifndef UNIT_TEST
 	// No Sun and Moon on the sky
 	// Details: https://bugs.launchpad.net/stellarium/+bug/1499699
 	if (!GETSTELMODULE(SolarSystem)->getFlagPlanets())
 		return 0.f;
+#endif
+	return computeLuminance(cosDistMoon, cosDistSun, cosDistZenith);
+}
+
+void Skybright::getLuminances(const float* cosDistMoon, const float* cosDistSun, const float* cosDistZenith,
+			      float* luminances, const int n) const
+{
+	for (int i=0; i<n; ++i)
+		luminances[i] = computeLuminance(cosDistMoon[i], cosDistSun[i], cosDistZenith[i]);
+}
 
+// The moon and night terms are only computed where they add more than 1% of the daylight brightness,
+// which skips their costly functions for most points of the sky.
+inline float Skybright::computeLuminance(float cosDistMoon, const float cosDistSun, const float cosDistZenith) const
+{
 	// Air mass
 	const float bKX = stelpow10f(-0.4f * K * (1.f / (cosDistZenith + 0.025f*StelUtils::fastExp(-11.f*cosDistZenith))));
 
@@ -150,4 +167,3 @@ float Skybright::getLuminance( float cosDistMoon,
 	//5;	// In cd/m^2 : the 32393895 is empirical term because the
 	// lambert -> cd/m^2 formula seems to be wrong...
 }
-
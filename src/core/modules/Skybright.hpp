@@ -69,7 +69,17 @@ public:
 	//! @param cosDistZenith cos(angular distance between zenith and the position)
 	float getLuminance(float cosDistMoon, const float cosDistSun, const float cosDistZenith) const;
 
+	//! Compute the luminances of n positions at once, with the same results as getLuminance().
+	//! Unlike getLuminance(), this does not check whether the Sun and Moon are shown at all;
+	//! the caller has to do it once for all positions.
+	//! @param luminances receives n values
+	void getLuminances(const float* cosDistMoon, const float* cosDistSun, const float* cosDistZenith,
+			   float* luminances, const int n) const;
+
 private:
+	//! Luminance at one position, without the check of getLuminance().
+	inline float computeLuminance(float cosDistMoon, const float cosDistSun, const float cosDistZenith) const;
+
 	float airMassMoon;  // Air mass for the Moon
 	float airMassSun;   // Air mass for the Sun
 	float magMoon;      // Moon magnitude
@@ -23,6 +23,7 @@
 #include "StelTexture.hpp"
 #include "EphemWrapper.hpp"
 #include "Orbit.hpp"
+#include "OrbitPath.hpp"
 
 #include "StelProjector.hpp"
 #include "StelApp.hpp"
@@ -37,6 +38,7 @@
 #include "Planet.hpp"
 #include "MinorPlanet.hpp"
 #include "Comet.hpp"
+#include "MinorBodyCatalog.hpp"
 #include "StelMainView.hpp"
 
 #include "StelSkyDrawer.hpp"
@@ -61,6 +63,14 @@
 #include <QDebug>
 #include <QDir>
 #include <QHash>
+#include <QSet>
+#include <QElapsedTimer>
+
+#ifndef Q_OS_WIN
+#include <sys/resource.h>
+#endif
+#include <QFileInfo>
+#include <QThread>
 
 SolarSystem::SolarSystem()
 	: shadowPlanetCount(0)
@@ -69,8 +79,15 @@ SolarSystem::SolarSystem()
 	, flagMinorBodyScale(false)
 	, minorBodyScale(1.0)
 	, labelsAmount(false)
+	, minorBodiesLazyThreshold(10000)
+	, catalogBodiesJDE(0.)
+	, catalogBodiesLimitMag(0.f)
+	, catalogBodiesTimer(0.)
+	, planetListChanged(true)
+	, orbitSamplesPerFrame(20000)
 	, flagOrbits(false)
 	, flagLightTravelTime(true)
+	, flagParallelPositions(true)
 	, flagUseObjModels(false)
 	, flagShowObjSelfShadows(true)
 	, flagShow(false)
@@ -100,6 +117,7 @@ SolarSystem::~SolarSystem()
 {
 	// release selected:
 	selected.clear();
+	clearMinorBodyCatalogs();
 	foreach (Orbit* orb, orbits)
 	{
 		delete orb;
@@ -147,6 +165,8 @@ void SolarSystem::init()
 	Q_ASSERT(conf);
 
 	Planet::init();
+	minorBodiesLazyThreshold = conf->value("astro/minor_bodies_lazy_threshold", 10000).toInt();
+	orbitSamplesPerFrame = conf->value("astro/orbit_samples_per_frame", 20000).toInt();
 	loadPlanets();	// Load planets data
 
 	// Compute position and matrix of sun and all the satellites (ie planets)
@@ -164,6 +184,7 @@ void SolarSystem::init()
 	setLabelsAmount(conf->value("astro/labels_amount", 3.).toFloat());
 	setFlagOrbits(conf->value("astro/flag_planets_orbits").toBool());
 	setFlagLightTravelTime(conf->value("astro/flag_light_travel_time", true).toBool());
+	setFlagParallelPositions(conf->value("astro/flag_parallel_positions", QThread::idealThreadCount()>1).toBool());
 	setFlagUseObjModels(conf->value("astro/flag_use_obj_models", false).toBool());
 	setFlagShowObjSelfShadows(conf->value("astro/flag_show_obj_self_shadows", true).toBool());
 	setFlagPointer(conf->value("astro/flag_planets_pointers", true).toBool());
@@ -406,6 +427,7 @@ void SolarSystem::loadPlanets()
 {
 	minorBodies.clear();
 	systemMinorBodies.clear();
+	clearMinorBodyCatalogs();
 	qDebug() << "Loading Solar System data (1: planets and moons) ...";
 	QString solarSystemFile = StelFileMgr::findFile("data/ssystem_major.ini");
 	if (solarSystemFile.isEmpty())
@@ -430,7 +452,8 @@ void SolarSystem::loadPlanets()
 
 	foreach (const QString& solarSystemFile, solarSystemFiles)
 	{
-		if (loadPlanets(solarSystemFile))
+		// Files which cannot be converted to a catalogue (e.g. with moons of minor bodies) are read directly.
+		if (loadMinorBodyCatalog(solarSystemFile, false) || loadPlanets(solarSystemFile))
 		{
 			qDebug() << "File ssystem_minor.ini is loaded successfully...";
 			break;
@@ -453,6 +476,7 @@ void SolarSystem::loadPlanets()
 				}
 			}			
 			systemPlanets.clear();			
+			planetListChanged = true;
 			//Memory leak? What's the proper way of cleaning shared pointers?
 
 			// TODO: 0.16pre what about the orbits list?
@@ -472,6 +496,14 @@ void SolarSystem::loadPlanets()
 		}
 	}
 
+	// Optional: the complete MPC orbit database
+	const QString mpcorbFile = StelFileMgr::findFile("data/MPCORB.DAT");
+	if (!mpcorbFile.isEmpty())
+	{
+		qDebug() << "Loading Solar System data (3: MPC orbit database)...";
+		loadMinorBodyCatalog(mpcorbFile, true);
+	}
+
 	shadowPlanetCount = 0;
 
 	foreach (const PlanetP& planet, systemPlanets)
@@ -479,6 +511,399 @@ void SolarSystem::loadPlanets()
 			shadowPlanetCount++;
 }
 
+// Peak resident set size of the process in kB, logged with the loading times of the catalogues, or -1 if unknown.
+static long peakResidentSetSize()
+{
+#ifdef Q_OS_WIN
+	return -1;
+#else
+	struct rusage usage;
+	if (getrusage(RUSAGE_SELF, &usage)!=0)
+		return -1;
+#ifdef Q_OS_MAC
+	return usage.ru_maxrss/1024; // bytes on macOS
+#else
+	return usage.ru_maxrss;
+#endif
+#endif
+}
+
+bool SolarSystem::loadMinorBodyCatalog(const QString& sourcePath, bool isMpcorb)
+{
+	QElapsedTimer timer;
+	timer.start();
+
+	// The catalogue is a cache of the source file in the user directory, one per source path.
+	const QFileInfo sourceInfo(sourcePath);
+	const QString catalogDir = StelFileMgr::getUserDir()+"/data";
+	const QString catalogPath = QString("%1/%2-%3.cat").arg(catalogDir).arg(sourceInfo.completeBaseName().toLower())
+				    .arg(qHash(sourceInfo.absoluteFilePath()), 8, 16, QChar('0'));
+	const QFileInfo catalogInfo(catalogPath);
+	MinorBodyCatalog* catalog = new MinorBodyCatalog();
+	// A catalogue written by an older version of the format is imported again as well
+	if (!catalogInfo.exists() || catalogInfo.lastModified()<=sourceInfo.lastModified() || !catalog->load(catalogPath))
+	{
+		catalog->clear();
+		QDir().mkpath(catalogDir);
+		const bool ok = isMpcorb ? MinorBodyCatalog::importMpcorb(sourcePath, catalogPath)
+					 : MinorBodyCatalog::importIni(sourcePath, catalogPath);
+		if (!ok)
+		{
+			delete catalog;
+			QFile::remove(catalogPath);
+			return false;
+		}
+		qDebug() << "Imported" << QDir::toNativeSeparators(sourcePath) << "in" << timer.elapsed() << "ms";
+		if (!catalog->load(catalogPath))
+		{
+			delete catalog;
+			QFile::remove(catalogPath);
+			return false;
+		}
+	}
+	if (catalog->size()==0)
+	{
+		delete catalog;
+		QFile::remove(catalogPath);
+		return false;
+	}
+
+	if (catalog->size()<=minorBodiesLazyThreshold)
+	{
+		for (int i=0; i<catalog->size(); ++i)
+		{
+			const QString englishName = catalog->getEnglishName(i);
+			if (!fullyLoadedMinorBodies.contains(englishName))
+			{
+				createCatalogBody(catalog, i, false);
+				fullyLoadedMinorBodies.insert(englishName);
+			}
+		}
+		qDebug() << "Loaded" << catalog->size() << "minor bodies from" << QDir::toNativeSeparators(catalogPath)
+			 << "in" << timer.elapsed() << "ms, peak RSS" << peakResidentSetSize() << "kB";
+		delete catalog;
+	}
+	else
+	{
+		minorBodyCatalogs.append(catalog);
+		// Force updateCatalogBodies() at the next frame
+		catalogBodiesJDE = 0.;
+		catalogBodiesTimer = 1.;
+		qDebug() << "Mapped" << catalog->size() << "minor bodies from" << QDir::toNativeSeparators(catalogPath)
+			 << "in" << timer.elapsed() << "ms, created on demand, peak RSS" << peakResidentSetSize() << "kB";
+	}
+	return true;
+}
+
+PlanetP SolarSystem::createCatalogBody(const MinorBodyCatalog* catalog, int index, bool lazy)
+{
+	PlanetP p = makeCatalogBody(catalog, index, lazy);
+	addCatalogBody(p, lazy);
+	return p;
+}
+
+PlanetP SolarSystem::makeCatalogBody(const MinorBodyCatalog* catalog, int index, bool lazy) const
+{
+	const MinorBodyCatalog::Elements& e = catalog->getElements(index);
+	const MinorBodyCatalog::Details& d = catalog->getDetails(index);
+	const QString englishName = catalog->getEnglishName(index);
+	const QString type = MinorBodyCatalog::getTypeString(e.type);
+	const bool closeOrbit = e.flags & MinorBodyCatalog::CloseOrbit;
+	const bool hidden = e.flags & MinorBodyCatalog::Hidden;
+	const Vec3f color(d.color[0], d.color[1], d.color[2]);
+
+	// The same orbit classes as for the bodies loaded from ssystem_minor.ini
+	void* orb;
+	posFuncType posFunc;
+	if (e.flags & MinorBodyCatalog::EllipticOrbit)
+	{
+		orb = new EllipticalOrbit(e.pericenterDistance,
+					  e.eccentricity,
+					  e.inclination,
+					  e.ascendingNode,
+					  e.argOfPericenter,
+					  d.ellipticalMeanAnomaly,
+					  d.ellipticalPeriod,
+					  d.ellipticalEpoch,
+					  0., 0., 0.);
+		posFunc = &ellipticalOrbitPosFunc;
+	}
+	else
+	{
+		orb = new CometOrbit(e.pericenterDistance,
+				     e.eccentricity,
+				     e.inclination,
+				     e.ascendingNode,
+				     e.argOfPericenter,
+				     e.timeAtPericenter,
+				     d.orbitGoodDays,
+				     e.meanMotion,
+				     0., 0., 0.);
+		posFunc = &cometOrbitPosFunc;
+	}
+
+	Planet* body;
+	if (e.type==MinorBodyCatalog::Comet)
+	{
+		Comet* comet = new Comet(englishName,
+					 d.radius/AU,
+					 d.oblateness,
+					 color, // halo color
+					 d.albedo,
+					 d.roughness,
+					 d.outgasIntensity,
+					 d.outgasFalloff,
+					 catalog->getString(d.texMap),
+					 catalog->getString(d.model),
+					 posFunc,
+					 orb,
+					 Q_NULLPTR,
+					 closeOrbit,
+					 hidden,
+					 type,
+					 d.dustWidthFactor,
+					 d.dustLengthFactor,
+					 d.dustBrightnessFactor);
+		if (e.absoluteMagnitude > -99)
+			comet->setAbsoluteMagnitudeAndSlope(e.absoluteMagnitude, e.slopeParameter);
+		if (d.semiMajorAxis > 0.)
+			comet->setSemiMajorAxis(d.semiMajorAxis);
+		body = comet;
+	}
+	else if (MinorBodyCatalog::isMinorPlanetType(e.type))
+	{
+		StelSkyDrawer* skyDrawer = StelApp::getInstance().getCore()->getSkyDrawer();
+		MinorPlanet* mp = new MinorPlanet(englishName,
+						  d.radius/AU,
+						  d.oblateness,
+						  d.colorIndexBV<99.f ? skyDrawer->indexToColor(BvToColorIndex(d.colorIndexBV))*0.75f : color, // halo color
+						  d.albedo,
+						  d.roughness,
+						  catalog->getString(d.texMap),
+						  catalog->getString(d.model),
+						  posFunc,
+						  orb,
+						  Q_NULLPTR,
+						  closeOrbit,
+						  hidden,
+						  type);
+		if (d.minorPlanetNumber)
+			mp->setMinorPlanetNumber(d.minorPlanetNumber);
+		const QString provisionalDesignation = catalog->getString(d.provisionalDesignation);
+		if (!provisionalDesignation.isEmpty())
+			mp->setProvisionalDesignation(provisionalDesignation);
+		if (e.absoluteMagnitude > -99)
+			mp->setAbsoluteMagnitudeAndSlope(e.absoluteMagnitude, e.slopeParameter);
+		mp->setSemiMajorAxis(d.semiMajorAxis);
+		mp->setColorIndexBV(d.colorIndexBV);
+		mp->setSpectralType(catalog->getString(d.spectralTypeT), catalog->getString(d.spectralTypeB));
+		body = mp;
+	}
+	else
+	{
+		body = new Planet(englishName,
+				  d.radius/AU,
+				  d.oblateness,
+				  color, // halo color
+				  d.albedo,
+				  d.roughness,
+				  catalog->getString(d.texMap),
+				  catalog->getString(d.normalsMap),
+				  catalog->getString(d.model),
+				  posFunc,
+				  orb,
+				  Q_NULLPTR,
+				  closeOrbit,
+				  hidden,
+				  e.flags & MinorBodyCatalog::Atmosphere,
+				  e.flags & MinorBodyCatalog::Halo,
+				  type);
+		body->absoluteMagnitude = e.absoluteMagnitude;
+	}
+
+	// Bodies created on demand may be released while still referenced elsewhere (e.g. by a trail),
+	// so they own their orbit instead of the orbits list.
+	PlanetP p = lazy ? PlanetP(body, &SolarSystem::deleteCatalogBody) : PlanetP(body);
+	p->parent = sun;
+	p->setRotationElements(d.rotationPeriod,
+			       d.rotationOffset,
+			       d.rotationEpoch,
+			       d.rotationObliquity,
+			       d.rotationAscendingNode,
+			       d.rotationPrecessionRate,
+			       d.orbitVisualizationPeriod);
+
+	if (lazy)
+	{
+		p->setFlagHints(getFlagHints());
+		p->setFlagLabels(getFlagLabels());
+		p->setFlagOrbits(getFlagOrbits() && !selected);
+		if (getFlagMinorBodyScale())
+			p->setSphereScale(getMinorBodyScale());
+		p->translateName(StelApp::getInstance().getLocaleMgr().getSkyTranslator());
+	}
+	return p;
+}
+
+void SolarSystem::addCatalogBody(const PlanetP& p, bool lazy)
+{
+	if (!lazy)
+		orbits.push_back(static_cast<Orbit*>(p->orbitPtr));
+	sun->satellites.append(p);
+	// As in loadPlanets(), only MinorPlanet and Comet objects are minor bodies
+	if (p->getPlanetType()>=Planet::isAsteroid && p->getPlanetType()<=Planet::isOCO)
+	{
+		minorBodies << p->getEnglishName();
+		systemMinorBodies.push_back(p);
+	}
+	systemPlanets.push_back(p);
+	planetListChanged = true;
+}
+
+void SolarSystem::deleteCatalogBody(Planet* p)
+{
+	Orbit* orb = static_cast<Orbit*>(p->orbitPtr);
+	delete p;
+	delete orb;
+}
+
+// Predicates for removing the released bodies from the lists in one pass with std::remove_if()
+struct IsReleasedBody
+{
+	IsReleasedBody(const QSet<const Planet*>& released) : released(released) {}
+	bool operator()(const PlanetP& p) const {return released.contains(p.data());}
+	const QSet<const Planet*>& released;
+};
+
+struct IsReleasedName
+{
+	IsReleasedName(const QSet<QString>& names) : names(names) {}
+	bool operator()(const QString& name) const {return names.contains(name);}
+	const QSet<QString>& names;
+};
+
+// Remove the released bodies from a list, keeping the order of the other bodies.
+static void removeCatalogBodies(QList<PlanetP>& list, const QSet<const Planet*>& released)
+{
+	list.erase(std::remove_if(list.begin(), list.end(), IsReleasedBody(released)), list.end());
+}
+
+void SolarSystem::releaseCatalogBodies(const QList<PlanetP>& bodies)
+{
+	if (bodies.isEmpty())
+		return;
+	QSet<const Planet*> released;
+	QSet<QString> names;
+	foreach (const PlanetP& p, bodies)
+	{
+		released.insert(p.data());
+		names.insert(p->getEnglishName());
+	}
+	removeCatalogBodies(sun->satellites, released);
+	removeCatalogBodies(systemPlanets, released);
+	removeCatalogBodies(systemMinorBodies, released);
+	minorBodies.erase(std::remove_if(minorBodies.begin(), minorBodies.end(), IsReleasedName(names)), minorBodies.end());
+	planetListChanged = true;
+}
+
+void SolarSystem::updateCatalogBodies(double deltaTime)
+{
+	if (minorBodyCatalogs.isEmpty() || !sun)
+		return;
+
+	// Add the bodies created by searchCatalogBody() since the last frame
+	QHashIterator<QPair<int, int>, PlanetP> searched(searchedCatalogBodies);
+	while (searched.hasNext())
+	{
+		searched.next();
+		addCatalogBody(searched.value(), true);
+		catalogBodies.insert(searched.key(), searched.value());
+	}
+	searchedCatalogBodies.clear();
+
+	StelCore* core = StelApp::getInstance().getCore();
+	const double jde = core->getJDE();
+	// Create the bodies a bit before they become visible
+	const float limitMag = core->getSkyDrawer()->getLimitMagnitude() + 1.f;
+	catalogBodiesTimer += deltaTime;
+	if (catalogBodiesTimer<1. || (fabs(jde-catalogBodiesJDE)<1. && fabs(limitMag-catalogBodiesLimitMag)<0.25f))
+		return;
+	catalogBodiesTimer = 0.;
+	catalogBodiesJDE = jde;
+	catalogBodiesLimitMag = limitMag;
+
+	const QList<StelObjectP> selection = GETSTELMODULE(StelObjectMgr)->getSelectedObject("Planet");
+	const Vec3d observerPos = core->getObserverHeliocentricEclipticPos();
+	QVector<float> mags;
+	bool created = false;
+	QList<PlanetP> released;
+	for (int c=0; c<minorBodyCatalogs.size(); ++c)
+	{
+		const MinorBodyCatalog* catalog = minorBodyCatalogs.at(c);
+		mags.resize(catalog->size());
+		catalog->computeMagnitudes(jde, observerPos, mags.data());
+
+		QMutableHashIterator<QPair<int, int>, PlanetP> it(catalogBodies);
+		while (it.hasNext())
+		{
+			it.next();
+			if (it.key().first!=c || mags.at(it.key().second)<limitMag || selected==it.value()
+			    || selection.contains(qSharedPointerCast<StelObject>(it.value())))
+				continue;
+			released << it.value();
+			it.remove();
+		}
+
+		for (int i=0; i<catalog->size(); ++i)
+		{
+			if (mags.at(i)>=limitMag || (catalog->getElements(i).flags & MinorBodyCatalog::Hidden)
+			    || catalogBodies.contains(qMakePair(c, i)) || fullyLoadedMinorBodies.contains(catalog->getEnglishName(i)))
+				continue;
+			catalogBodies.insert(qMakePair(c, i), createCatalogBody(catalog, i, true));
+			created = true;
+		}
+	}
+	releaseCatalogBodies(released);
+
+	// The new bodies need their positions before they are drawn.
+	if (created)
+		computePositions(jde, core->getCurrentPlanet());
+}
+
+PlanetP SolarSystem::searchCatalogBody(const QString& englishName) const
+{
+	for (int c=0; c<minorBodyCatalogs.size(); ++c)
+	{
+		const int i = minorBodyCatalogs.at(c)->findByEnglishName(englishName);
+		if (i<0)
+			continue;
+		const QPair<int, int> key(c, i);
+		if (catalogBodies.contains(key))
+			return catalogBodies.value(key);
+		if (searchedCatalogBodies.contains(key))
+			return searchedCatalogBodies.value(key);
+
+		// The body is added to the solar system by the next updateCatalogBodies().
+		PlanetP p = makeCatalogBody(minorBodyCatalogs.at(c), i, true);
+		StelCore* core = StelApp::getInstance().getCore();
+		p->computePosition(core->getJDE());
+		p->computeTransMatrix(core->getJD(), core->getJDE());
+		searchedCatalogBodies.insert(key, p);
+		return p;
+	}
+	return PlanetP();
+}
+
+void SolarSystem::clearMinorBodyCatalogs()
+{
+	foreach (MinorBodyCatalog* catalog, minorBodyCatalogs)
+		delete catalog;
+	minorBodyCatalogs.clear();
+	catalogBodies.clear();
+	searchedCatalogBodies.clear();
+	fullyLoadedMinorBodies.clear();
+}
+
 unsigned char SolarSystem::BvToColorIndex(float bV)
 {
 	double dBV = bV;
@@ -961,6 +1386,7 @@ bool SolarSystem::loadPlanets(const QString& filePath)
 		if ((type == "asteroid" || type == "dwarf planet" || type == "cubewano" || type == "plutino" || type == "scattered disc object" || type == "Oort cloud object") && !englishName.contains("Pluto"))
 		{
 			minorBodies << englishName;
+			fullyLoadedMinorBodies.insert(englishName);
 
 			Vec3f color = Vec3f(1.f, 1.f, 1.f);
 			float bV = pd.value(secname+"/color_index_bv", 99.f).toFloat();
@@ -1024,6 +1450,7 @@ bool SolarSystem::loadPlanets(const QString& filePath)
 		else if (type == "comet")
 		{
 			minorBodies << englishName;
+			fullyLoadedMinorBodies.insert(englishName);
 			p = PlanetP(new Comet(englishName,
 					      pd.value(secname+"/radius").toDouble()/AU,
 					      pd.value(secname+"/oblateness", 0.0).toDouble(),
@@ -1159,6 +1586,7 @@ bool SolarSystem::loadPlanets(const QString& filePath)
 		}
 
 		systemPlanets.push_back(p);
+		planetListChanged = true;
 		readOk++;
 	}
 
@@ -1185,16 +1613,83 @@ bool SolarSystem::loadPlanets(const QString& filePath)
 	return true;
 }
 
+//! Functor for PlanetScheduler: one step of SolarSystem::computePositions() for one body.
+class ComputePlanetStep
+{
+public:
+	enum Step
+	{
+		PositionWithoutOrbits,
+		Position,
+		LightTimePosition,
+		TransMatrix,
+		LightTimeTransMatrix
+	};
+
+	ComputePlanetStep(Step step, double dateJDE, double dateJD=0., const Vec3d& observerPos=Vec3d(0.))
+		: step(step), dateJDE(dateJDE), dateJD(dateJD), observerPos(observerPos) {}
+
+	void operator()(const PlanetP& p) const
+	{
+		switch (step)
+		{
+			case PositionWithoutOrbits:
+				p->computePositionWithoutOrbits(dateJDE);
+				break;
+			case Position:
+				p->computePosition(dateJDE);
+				break;
+			case LightTimePosition:
+				p->computePosition(dateJDE-lightSpeedCorrection(p));
+				break;
+			case TransMatrix:
+				p->computeTransMatrix(dateJD, dateJDE);
+				break;
+			case LightTimeTransMatrix:
+			{
+				const double light_speed_correction = lightSpeedCorrection(p);
+				p->computeTransMatrix(dateJD-light_speed_correction, dateJDE-light_speed_correction);
+				break;
+			}
+		}
+	}
+
+private:
+	double lightSpeedCorrection(const PlanetP& p) const
+	{
+		return (p->getHeliocentricEclipticPos()-observerPos).length() * (AU / (SPEED_OF_LIGHT * 86400.));
+	}
+
+	Step step;
+	double dateJDE;
+	double dateJD;
+	Vec3d observerPos;
+};
+
+// Only bodies computed from orbital elements are thread-safe, the planetary theories keep
+// their last results in static variables.
+bool SolarSystem::isOrbitBased(const PlanetP& p)
+{
+	return p->coordFunc==&ellipticalOrbitPosFunc || p->coordFunc==&cometOrbitPosFunc;
+}
+
+void SolarSystem::buildPositionScheduler()
+{
+	positionScheduler.build(systemPlanets, &SolarSystem::isOrbitBased);
+	planetsByDistance = systemPlanets;
+	planetListChanged = false;
+}
+
 // Compute the position for every elements of the solar system.
 // The order is not important since the position is computed relatively to the mother body
 void SolarSystem::computePositions(double dateJDE, PlanetP observerPlanet)
 {
+	if (planetListChanged)
+		buildPositionScheduler();
+	OrbitPath::beginFrame(orbitSamplesPerFrame, observerPlanet->getHeliocentricEclipticPos());
 	if (flagLightTravelTime)
 	{
-		foreach (PlanetP p, systemPlanets)
-		{
-			p->computePositionWithoutOrbits(dateJDE);
-		}
+		positionScheduler.run(ComputePlanetStep(ComputePlanetStep::PositionWithoutOrbits, dateJDE), flagParallelPositions);
 		// BEGIN HACK: 0.16.0post for solar aberration/light time correction
 		// This fixes eclipse bug LP:#1275092) and outer planet rendering bug (LP:#1699648) introduced by the first fix in 0.16.0.
 		// We compute a "light time corrected position" for the sun and apply it only for rendering, not for other computations.
@@ -1209,18 +1704,11 @@ void SolarSystem::computePositions(double dateJDE, PlanetP observerPlanet)
 		// We must reset observerPlanet for the next step!
 		observerPlanet->computePosition(dateJDE);
 		// END HACK FOR SOLAR LIGHT TIME/ABERRATION
-		foreach (PlanetP p, systemPlanets)
-		{
-			const double light_speed_correction = (p->getHeliocentricEclipticPos()-obsPosJDE).length() * (AU / (SPEED_OF_LIGHT * 86400.));
-			p->computePosition(dateJDE-light_speed_correction);
-		}
+		positionScheduler.run(ComputePlanetStep(ComputePlanetStep::LightTimePosition, dateJDE, 0., obsPosJDE), flagParallelPositions);
 	}
 	else
 	{
-		foreach (PlanetP p, systemPlanets)
-		{
-			p->computePosition(dateJDE);
-		}
+		positionScheduler.run(ComputePlanetStep(ComputePlanetStep::Position, dateJDE), flagParallelPositions);
 		lightTimeSunPosition.set(0.,0.,0.);
 	}
 	computeTransMatrices(dateJDE, observerPlanet->getHeliocentricEclipticPos());
@@ -1232,21 +1720,12 @@ void SolarSystem::computeTransMatrices(double dateJDE, const Vec3d& observerPos)
 {
 	double dateJD=dateJDE - (StelApp::getInstance().getCore()->computeDeltaT(dateJDE))/86400.0;
 
+	if (planetListChanged)
+		buildPositionScheduler();
 	if (flagLightTravelTime)
-	{
-		foreach (PlanetP p, systemPlanets)
-		{
-			const double light_speed_correction = (p->getHeliocentricEclipticPos()-observerPos).length() * (AU / (SPEED_OF_LIGHT * 86400));
-			p->computeTransMatrix(dateJD-light_speed_correction, dateJDE-light_speed_correction);
-		}
-	}
+		positionScheduler.run(ComputePlanetStep(ComputePlanetStep::LightTimeTransMatrix, dateJDE, dateJD, observerPos), flagParallelPositions);
 	else
-	{
-		foreach (PlanetP p, systemPlanets)
-		{
-			p->computeTransMatrix(dateJD, dateJDE);
-		}
-	}
+		positionScheduler.run(ComputePlanetStep(ComputePlanetStep::TransMatrix, dateJDE, dateJD), flagParallelPositions);
 }
 
 // And sort them from the furthest to the closest to the observer
@@ -1274,7 +1753,9 @@ void SolarSystem::draw(StelCore* core)
 	}
 
 	// And sort them from the furthest to the closest
-	sort(systemPlanets.begin(),systemPlanets.end(),biggerDistance());
+	if (planetListChanged)
+		buildPositionScheduler();
+	sort(planetsByDistance.begin(),planetsByDistance.end(),biggerDistance());
 
 	if (trailFader.getInterstate()>0.0000001f)
 	{
@@ -1289,7 +1770,7 @@ void SolarSystem::draw(StelCore* core)
 			5.f+(core->getSkyDrawer()->getLimitMagnitude()-5.f)*1.2f) +(labelsAmount-3.f)*1.2f;
 
 	// Draw the elements
-	foreach (const PlanetP& p, systemPlanets)
+	foreach (const PlanetP& p, planetsByDistance)
 	{
 		p->draw(core, maxMagLabel, planetNameFont);
 	}
@@ -1360,7 +1841,7 @@ PlanetP SolarSystem::searchByEnglishName(QString planetEnglishName) const
 		if (p->getEnglishName() == planetEnglishName)
 			return p;
 	}
-	return PlanetP();
+	return searchCatalogBody(planetEnglishName);
 }
 
 PlanetP SolarSystem::searchMinorPlanetByEnglishName(QString planetEnglishName) const
@@ -1381,7 +1862,8 @@ StelObjectP SolarSystem::searchByNameI18n(const QString& planetNameI18) const
 		if (p->getNameI18n() == planetNameI18)
 			return qSharedPointerCast<StelObject>(p);
 	}
-	return StelObjectP();
+	// The names of minor bodies are not translated.
+	return qSharedPointerCast<StelObject>(searchCatalogBody(planetNameI18));
 }
 
 
@@ -1392,7 +1874,7 @@ StelObjectP SolarSystem::searchByName(const QString& name) const
 		if (p->getEnglishName() == name || p->getCommonEnglishName() == name)
 			return qSharedPointerCast<StelObject>(p);
 	}
-	return StelObjectP();
+	return qSharedPointerCast<StelObject>(searchCatalogBody(name));
 }
 
 float SolarSystem::getPlanetVMagnitude(QString planetName, bool withExtinction) const
@@ -1536,6 +2018,22 @@ void SolarSystem::updateI18n()
 	const StelTranslator& trans = StelApp::getInstance().getLocaleMgr().getSkyTranslator();
 	foreach (PlanetP p, systemPlanets)
 		p->translateName(trans);
+	updateNameIndex();
+}
+
+void SolarSystem::updateNameIndex()
+{
+	typedef StelObjectNameIndex::Name Name;
+	QVector<Name> names;
+	names.reserve(2*systemPlanets.size());
+	foreach (const PlanetP& p, systemPlanets)
+	{
+		const Planet::PlanetType type = p->getPlanetType();
+		const int rank = (type==Planet::isPlanet || type==Planet::isStar) ? 0 : (type==Planet::isMoon ? 1 : 2);
+		names << Name(p->getEnglishName(), StelObjectNameIndex::EnglishName, rank);
+		names << Name(p->getNameI18n(), StelObjectNameIndex::TranslatedName, rank);
+	}
+	StelApp::getInstance().getStelObjectMgr().getNameIndex().setNames(this, names);
 }
 
 void SolarSystem::setFlagTrails(bool b)
@@ -1665,6 +2163,8 @@ void SolarSystem::setSelected(PlanetP obj)
 
 void SolarSystem::update(double deltaTime)
 {
+	updateCatalogBodies(deltaTime);
+
 	trailFader.update(deltaTime*1000);
 	if (trailFader.getInterstate()>0.f)
 	{
@@ -1721,6 +2221,27 @@ QStringList SolarSystem::listAllObjects(bool inEnglish) const
 	return result;
 }
 
+QStringList SolarSystem::listMatchingUnindexedObjects(const QString& objPrefix, int maxNbItem, bool useStartOfWords, bool inEnglish) const
+{
+	Q_UNUSED(useStartOfWords);
+	Q_UNUSED(inEnglish);
+	QStringList result;
+	// Only the start of the names is searched in the catalogues.
+	for (int c=0; c<minorBodyCatalogs.size() && result.size()<maxNbItem; ++c)
+	{
+		const MinorBodyCatalog* catalog = minorBodyCatalogs.at(c);
+		foreach (int i, catalog->findByPrefix(objPrefix, maxNbItem))
+		{
+			const QString name = catalog->getEnglishName(i);
+			if (!result.contains(name))
+				result.append(name);
+			if (result.size()>=maxNbItem)
+				break;
+		}
+	}
+	return result;
+}
+
 QStringList SolarSystem::listAllObjectsByType(const QString &objType, bool inEnglish) const
 {
 	QStringList result;
@@ -2252,6 +2773,7 @@ void SolarSystem::reloadPlanets()
 	}
 	systemPlanets.clear();
 	systemMinorBodies.clear();
+	planetListChanged = true;
 	// Memory leak? What's the proper way of cleaning shared pointers?
 
 	// Also delete Comet textures (loaded in loadPlanets()
@@ -2472,7 +2994,9 @@ bool SolarSystem::removeMinorPlanet(QString name)
 		orbits.removeOne(orbPtr);
 	systemPlanets.removeOne(candidate);
 	systemMinorBodies.removeOne(candidate);
+	planetListChanged = true;
 	candidate.clear();
+	updateNameIndex();
 	return true;
 }
 
@@ -28,11 +28,16 @@
 #include "StelObjectModule.hpp"
 #include "StelTextureTypes.hpp"
 #include "Planet.hpp"
+#include "PlanetScheduler.hpp"
 #include "StelGui.hpp"
 
 #include <QFont>
+#include <QHash>
+#include <QPair>
+#include <QSet>
 
 class Orbit;
+class MinorBodyCatalog;
 class StelTranslator;
 class StelObject;
 class StelCore;
@@ -333,6 +338,9 @@ public:
 
 	virtual QStringList listAllObjects(bool inEnglish) const;
 	virtual QStringList listAllObjectsByType(const QString& objType, bool inEnglish) const;
+	//! Lists the bodies of the minor body catalogues auto-completing the passed object name.
+	//! The names of the Planet objects are registered in the name index.
+	virtual QStringList listMatchingUnindexedObjects(const QString& objPrefix, int maxNbItem, bool useStartOfWords, bool inEnglish) const;
 	virtual QString getName() const { return "Solar System"; }
 	virtual QString getStelObjectType() const { return Planet::PLANET_TYPE; }
 
@@ -384,6 +392,10 @@ public slots:
 	//! calculation is used or not.
 	bool getFlagLightTravelTime(void) const {return flagLightTravelTime;}
 
+	//! Set whether the positions of the bodies computed from orbital elements are computed in several threads.
+	void setFlagParallelPositions(bool b) {flagParallelPositions=b;}
+	bool getFlagParallelPositions(void) const {return flagParallelPositions;}
+
 	//! Set flag whether to use OBJ models for rendering, where available
 	void setFlagUseObjModels(bool b) { if(b!=flagUseObjModels) { flagUseObjModels = b; emit flagUseObjModelsChanged(b); } }
 	//! Get the current value of the flag which determines wether to use OBJ models for rendering, where available
@@ -915,6 +927,13 @@ private:
 	//! observerPos is needed for light travel time computation.
 	void computeTransMatrices(double dateJDE, const Vec3d& observerPos = Vec3d(0.));
 
+	//! Split systemPlanets for computePositions() and computeTransMatrices(): the bodies computed from
+	//! orbital elements, and their moons, can be computed in parallel, one thread per family.
+	//! The planetary theories keep static caches and are computed in the calling thread.
+	//! Called when systemPlanets changed, see planetListChanged.
+	void buildPositionScheduler();
+	static bool isOrbitBased(const PlanetP& p);
+
 	//! Draw a nice animated pointer around the object.
 	void drawPointer(const StelCore* core);
 
@@ -927,6 +946,34 @@ private:
 	//! Load planet data from the given file
 	bool loadPlanets(const QString& filePath);
 
+	//! Load minor bodies through a MinorBodyCatalog. The source file (ssystem_minor.ini or MPCORB.DAT)
+	//! is imported into a catalogue in the user data directory when it is newer than the catalogue.
+	//! Catalogues with up to astro/minor_bodies_lazy_threshold bodies are loaded completely. For larger
+	//! catalogues, Planet objects are only created for the bodies which are bright enough to be drawn,
+	//! selected or searched for, see updateCatalogBodies().
+	//! @return false if the source file cannot be converted into a catalogue.
+	bool loadMinorBodyCatalog(const QString& sourcePath, bool isMpcorb);
+	//! Create the Planet object of a body of a catalogue and add it to the solar system.
+	//! @param lazy true for bodies created on demand, which may be released again.
+	PlanetP createCatalogBody(const MinorBodyCatalog* catalog, int index, bool lazy);
+	//! Create the Planet object of a body of a catalogue without adding it to the solar system.
+	PlanetP makeCatalogBody(const MinorBodyCatalog* catalog, int index, bool lazy) const;
+	//! Add a Planet object created by makeCatalogBody() to the solar system.
+	void addCatalogBody(const PlanetP& p, bool lazy);
+	//! Remove Planet objects created on demand from the solar system.
+	//! The lists of bodies are only traversed once, whatever the number of released bodies.
+	void releaseCatalogBodies(const QList<PlanetP>& bodies);
+	//! Deleter of the Planet objects created on demand, which own their orbit.
+	static void deleteCatalogBody(Planet* p);
+	//! Create and release the Planet objects of the lazily loaded catalogues according to their
+	//! magnitudes. This runs at most once per second and only when the date or the limiting magnitude changed.
+	void updateCatalogBodies(double deltaTime);
+	//! Find a body of the lazily loaded catalogues by English name and create its Planet object.
+	//! A new object is kept in searchedCatalogBodies until updateCatalogBodies() adds it to the solar system.
+	PlanetP searchCatalogBody(const QString& englishName) const;
+	//! Delete the minor body catalogues.
+	void clearMinorBodyCatalogs();
+
 	void recreateTrails();
 
 	//! Calculate a color of Solar system bodies
@@ -969,9 +1016,33 @@ private:
 	//! List of all the minor bodies of the solar system.
 	QList<PlanetP> systemMinorBodies;
 
+	//! Lazily loaded minor body catalogues, see loadMinorBodyCatalog().
+	QList<MinorBodyCatalog*> minorBodyCatalogs;
+	//! Planet objects created for the bodies of minorBodyCatalogs, by catalogue and body index.
+	QHash<QPair<int, int>, PlanetP> catalogBodies;
+	//! Planet objects created by the const searchCatalogBody(), only used from the main thread.
+	mutable QHash<QPair<int, int>, PlanetP> searchedCatalogBodies;
+	//! Names of the minor bodies loaded completely, which are skipped in minorBodyCatalogs.
+	QSet<QString> fullyLoadedMinorBodies;
+	int minorBodiesLazyThreshold;
+	double catalogBodiesJDE;
+	float catalogBodiesLimitMag;
+	double catalogBodiesTimer;
+	//! Order in which the bodies are computed in computePositions().
+	PlanetScheduler<PlanetP> positionScheduler;
+	//! Set whenever bodies are added to or removed from systemPlanets, so that
+	//! positionScheduler and planetsByDistance are built again before they are used.
+	bool planetListChanged;
+	//! systemPlanets sorted from the furthest to the closest to the observer, for draw().
+	//! systemPlanets itself keeps its order, which is the order of computation.
+	QList<PlanetP> planetsByDistance;
+	//! Number of orbit line samples which may be computed per frame by all bodies, see OrbitPath.
+	int orbitSamplesPerFrame;
+
 	// Master settings
 	bool flagOrbits;
 	bool flagLightTravelTime;
+	bool flagParallelPositions;
 	bool flagUseObjModels;
 	bool flagShowObjSelfShadows;
 
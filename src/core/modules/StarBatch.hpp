@@ -0,0 +1,117 @@
+/*
+ * Stellarium
+ * Copyright (C) 2017 Stellarium Developers
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Suite 500, Boston, MA  02110-1335, USA.
+ */
+
+#ifndef _STARBATCH_HPP_
+#define _STARBATCH_HPP_
+
+#include "ZoneData.hpp"
+#include "StelSphereGeometry.hpp"
+#include "RefractionExtinction.hpp"
+
+#include <QVector>
+#include <cmath>
+
+//! @struct StarBatch
+//! Structure-of-arrays buffers for a batch of stars of one zone, used by
+//! SpecialZoneArray<Star>::collectVisibleStars(). Each stage is a plain loop
+//! over float arrays which the compiler can vectorize for the target.
+struct StarBatch
+{
+	//! Number of stars decoded at once. Small enough for the buffers to stay in L1 cache.
+	enum {Size = 256};
+
+	StarBatch() : n(0), reachedCutoff(false) {}
+
+	//! Decode at most Size of the count stars starting at s, which belong to zone z.
+	//! Stars are sorted by magnitude, so decoding stops at the first star fainter than cutoffMagStep.
+	//! Fills the positions in the J2000 frame, including proper motion, and marks all stars visible.
+	//! @return the number of decoded stars, also stored in n
+	template<class Star>
+	int decode(const ZoneData* z, const Star* s, int count, int cutoffMagStep, float movementFactor)
+	{
+		n = qMin(count, (int)Size);
+		reachedCutoff = false;
+		for (int i=0;i<n;++i)
+		{
+			if (s[i].getMag() > cutoffMagStep)
+			{
+				n = i;
+				reachedCutoff = true;
+				break;
+			}
+			u0[i] = (float)s[i].getX0()+movementFactor*s[i].getDx0();
+			u1[i] = (float)s[i].getX1()+movementFactor*s[i].getDx1();
+		}
+
+		const float cx = z->center[0], cy = z->center[1], cz = z->center[2];
+		const float a0x = z->axis0[0], a0y = z->axis0[1], a0z = z->axis0[2];
+		const float a1x = z->axis1[0], a1y = z->axis1[1], a1z = z->axis1[2];
+		for (int i=0;i<n;++i)
+		{
+			px[i] = a0x*u0[i] + a1x*u1[i] + cx;
+			py[i] = a0y*u0[i] + a1y*u1[i] + cy;
+			pz[i] = a0z*u0[i] + a1z*u1[i] + cz;
+			invLen[i] = 1.f/std::sqrt(px[i]*px[i]+py[i]*py[i]+pz[i]*pz[i]);
+			visible[i] = 1;
+		}
+		return n;
+	}
+
+	//! Clear the visible flag of the stars which are outside one of the caps.
+	void cull(const QVector<SphericalCap>& caps)
+	{
+		foreach (const SphericalCap& cap, caps)
+		{
+			const float nx = cap.n[0], ny = cap.n[1], nz = cap.n[2];
+			const float d = cap.d;
+			for (int i=0;i<n;++i)
+				visible[i] &= ((px[i]*nx+py[i]*ny+pz[i]*nz)*invLen[i] >= d);
+		}
+	}
+
+	//! Compute the sine of the geometric altitude (altZ) and the extinction (extMagShift) of the stars.
+	//! @param m the J2000->AltAz matrix, see StelCore::getMatJ2000ToAltAz()
+	void extinct(const Mat4d& m, const Extinction& extinction)
+	{
+		// Altitude row of the matrix (column-major, see Vector3::transfo4d)
+		const float mz0 = m.r[2], mz1 = m.r[6], mz2 = m.r[10], mz3 = m.r[14];
+		for (int i=0;i<n;++i)
+		{
+			altZ[i] = (mz0*px[i] + mz1*py[i] + mz2*pz[i])*invLen[i] + mz3;
+			extMagShift[i] = 0.f;
+		}
+		extinction.forward(altZ, extMagShift, n);
+	}
+
+	//! Number of stars in the batch.
+	int n;
+	//! Whether decode() stopped at the magnitude cutoff.
+	bool reachedCutoff;
+	float u0[Size], u1[Size];
+	//! Position in the J2000 frame, not normalized.
+	float px[Size], py[Size], pz[Size];
+	float invLen[Size];
+	//! Sine of the geometric altitude, filled by extinct().
+	float altZ[Size];
+	//! Extinction in magnitudes, filled by extinct().
+	float extMagShift[Size];
+	int visible[Size];
+};
+
+#endif // _STARBATCH_HPP_
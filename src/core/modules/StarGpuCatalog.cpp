@@ -0,0 +1,174 @@
+/*
+ * Stellarium
+ * Copyright (C) 2017 Stellarium Developers
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Suite 500, Boston, MA  02110-1335, USA.
+ */
+
+#include "StarGpuCatalog.hpp"
+#include "StarGpuProgram.hpp"
+#include "ZoneArray.hpp"
+#include "StelApp.hpp"
+#include "StelCore.hpp"
+#include "StelFileMgr.hpp"
+#include "StelGeodesicGrid.hpp"
+#include "StelPainter.hpp"
+#include "StelSkyDrawer.hpp"
+#include "StelTexture.hpp"
+#include "StelTextureMgr.hpp"
+#include "RefractionExtinction.hpp"
+
+#include <QDebug>
+#include <QOpenGLBuffer>
+#include <QOpenGLContext>
+
+#include <algorithm>
+#include <climits>
+
+StarGpuCatalog::StarGpuCatalog()
+	: program(Q_NULLPTR)
+{
+	texHalo = StelApp::getInstance().getTextureManager().createTexture(StelFileMgr::getInstallationDir()+"/textures/star16x16.png");
+	program = new StarGpuProgram();
+	if (!program->isValid())
+	{
+		delete program;
+		program = Q_NULLPTR;
+	}
+}
+
+StarGpuCatalog::~StarGpuCatalog()
+{
+	foreach (const LevelBuffer& l, levels)
+		delete l.buffer;
+	levels.clear();
+	delete program;
+	program = Q_NULLPTR;
+}
+
+bool StarGpuCatalog::canHandle(const ZoneArray* z)
+{
+	// The catalogues with named (Hipparcos) stars use 256 magnitude steps and
+	// go through the CPU path, which also draws the labels.
+	return z->mag_steps <= 32 && (qint64)z->getNrOfStars()*sizeof(StaticStarVertex) < INT_MAX;
+}
+
+const StarGpuCatalog::LevelBuffer* StarGpuCatalog::getLevelBuffer(const ZoneArray* z)
+{
+	QMap<int, LevelBuffer>::const_iterator it = levels.constFind(z->level);
+	if (it!=levels.constEnd())
+		return it->buffer ? &(*it) : Q_NULLPTR;
+
+	// Remember failed uploads too, so that they are not tried again every frame
+	LevelBuffer& l = levels[z->level];
+	QVector<StaticStarVertex> vertices;
+	z->fillStaticVertices(vertices, l.zoneStart);
+
+	QOpenGLBuffer* buffer = new QOpenGLBuffer(QOpenGLBuffer::VertexBuffer);
+	buffer->setUsagePattern(QOpenGLBuffer::StaticDraw);
+	if (!buffer->create())
+	{
+		qWarning() << "StarGpuCatalog: could not create vertex buffer for level" << z->level;
+		delete buffer;
+		return Q_NULLPTR;
+	}
+	buffer->bind();
+	buffer->allocate(vertices.constData(), vertices.size()*sizeof(StaticStarVertex));
+	buffer->release();
+	l.buffer = buffer;
+	return &l;
+}
+
+bool StarGpuCatalog::draw(StelPainter* sPainter, StelCore* core, const ZoneArray* z, const GeodesicSearchResult& searchResult,
+			  const RCMag* rcmag_table, int limitMagIndex)
+{
+	StarGpuProgram::Params params;
+	if (!program || !canHandle(z) || !StarGpuProgram::setProjection(params, sPainter->getProjector()))
+		return false;
+
+	// The brightest stars of the level get the largest points. Bigger ones need the big halo
+	// of StelSkyDrawer::drawPointSource or do not fit into the point size range of the driver.
+	const float maxRadius = rcmag_table[0].radius;
+	if (maxRadius>StelSkyDrawer::getBigHaloRadius() || 2.f*maxRadius>program->getMaxPointSize())
+		return false;
+
+	StelSkyDrawer* drawer = core->getSkyDrawer();
+	const Extinction& extinction=drawer->getExtinction();
+	const bool withExtinction=drawer->getFlagHasAtmosphere() && extinction.getExtinctionCoefficient()>=0.01f;
+	const float k = 0.001f*z->mag_range/z->mag_steps;
+
+	// Same artificial cutoff as in ZoneArray::draw
+	int cutoffMagStep=limitMagIndex;
+	if (drawer->getFlagStarMagnitudeLimit())
+	{
+		cutoffMagStep = ((int)(drawer->getCustomStarMagnitudeLimit()*1000.f) - z->mag_min)*z->mag_steps/z->mag_range;
+		if (cutoffMagStep>limitMagIndex)
+			cutoffMagStep = limitMagIndex;
+	}
+	// Extinction can make stars use any entry up to the cutoff
+	if (withExtinction ? cutoffMagStep>StarGpuProgram::RCMagEntries : z->mag_steps>StarGpuProgram::RCMagEntries)
+		return false;
+
+	const LevelBuffer* l = getLevelBuffer(z);
+	if (!l)
+		return false;
+
+	// Collect the visible zones and merge adjacent ones into contiguous vertex ranges
+	zones.resize(0);
+	int zone;
+	for (GeodesicSearchInsideIterator it(searchResult,z->level);(zone = it.next()) >= 0;)
+		zones.append(zone);
+	for (GeodesicSearchBorderIterator it(searchResult,z->level);(zone = it.next()) >= 0;)
+		zones.append(zone);
+	if (zones.isEmpty())
+		return true;
+	std::sort(zones.begin(), zones.end());
+	ranges.resize(0);
+	int first = zones[0];
+	for (int i=1;i<=zones.size();++i)
+	{
+		if (i<zones.size() && zones[i]==zones[i-1]+1)
+			continue;
+		const int start = l->zoneStart[first];
+		ranges.append(qMakePair(start, l->zoneStart[zones[i-1]+1]-start));
+		if (i<zones.size())
+			first = zones[i];
+	}
+
+	for (int i=0;i<StarGpuProgram::RCMagEntries;++i)
+	{
+		params.rcmag[2*i] = rcmag_table[i].radius;
+		params.rcmag[2*i+1] = rcmag_table[i].luminance;
+	}
+	static const double d2000 = 2451545.0;
+	params.movementFactor = (M_PI/180.)*(0.0001/3600.) * ((core->getJDE()-d2000)/365.25) / z->star_position_scale;
+	params.cutoffMag = cutoffMagStep;
+	params.withExtinction = withExtinction;
+	const Mat4d& a = core->getMatJ2000ToAltAz();
+	params.altRow.set(a.r[2], a.r[6], a.r[10], a.r[14]);
+	params.extMagSteps = extinction.getExtinctionCoefficient()/k;
+	params.undergroundMode = extinction.getUndergroundExtinctionMode();
+	// Same condition as StelSkyDrawer::drawPointSource. A new seed every frame makes the stars twinkle.
+	if (drawer->getFlagTwinkle() && (drawer->getFlagHasAtmosphere() || drawer->getFlagForcedTwinkle()))
+	{
+		params.twinkleAmount = drawer->getTwinkleAmount();
+		params.twinkleSeed = (float)qrand()/RAND_MAX;
+	}
+
+	texHalo->bind();
+	sPainter->setBlending(true, GL_ONE, GL_ONE);
+	program->draw(l->buffer, ranges, params);
+	return true;
+}
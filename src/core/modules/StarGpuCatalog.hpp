@@ -0,0 +1,88 @@
+/*
+ * Stellarium
+ * Copyright (C) 2017 Stellarium Developers
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Suite 500, Boston, MA  02110-1335, USA.
+ */
+
+#ifndef _STARGPUCATALOG_HPP_
+#define _STARGPUCATALOG_HPP_
+
+#include "StelTextureTypes.hpp"
+
+#include <QMap>
+#include <QPair>
+#include <QVector>
+
+class ZoneArray;
+class StarGpuProgram;
+class StelCore;
+class StelPainter;
+class GeodesicSearchResult;
+class QOpenGLBuffer;
+struct RCMag;
+
+//! @class StarGpuCatalog
+//! Alternative render path for the faint star catalogues which keeps the stars on the GPU.
+//! Each ZoneArray level is uploaded once into a static vertex buffer, one contiguous range per
+//! geodesic zone. Per frame, only the ranges of the visible zones are drawn as point sprites by
+//! StarGpuProgram, which runs proper motion, projection, extinction, magnitude cutoff and
+//! twinkling in the vertex shader. Only the projections supported by StarGpuProgram::setProjection()
+//! are handled, and only levels without named stars whose magnitude steps fit into the RCMag
+//! uniform array and whose stars are small enough to be drawn without the big halo of
+//! StelSkyDrawer::drawPointSource(). Everything else is drawn by the CPU path of StarMgr,
+//! which stays the fallback.
+class StarGpuCatalog
+{
+public:
+	//! Must be called with the OpenGL context current.
+	StarGpuCatalog();
+	~StarGpuCatalog();
+
+	//! Get whether the stars of a level can be drawn by this class at all.
+	static bool canHandle(const ZoneArray* z);
+
+	//! Draw the visible zones of a level.
+	//! @param sPainter the painter used to draw the stars, with its projector in J2000 frame
+	//! @param core the core, for the current date and extinction
+	//! @param z the level to draw. It is uploaded to the GPU the first time it is drawn.
+	//! @param searchResult the zones to draw
+	//! @param rcmag_table the RCMag table of the level, as computed in StarMgr::draw
+	//! @param limitMagIndex index from rcmag_table at which stars are not visible anymore
+	//! @return false if nothing was drawn and the caller has to use the CPU path
+	bool draw(StelPainter* sPainter, StelCore* core, const ZoneArray* z, const GeodesicSearchResult& searchResult,
+		  const RCMag* rcmag_table, int limitMagIndex);
+
+private:
+	//! The vertex buffer of one level and the index of the first vertex of each zone.
+	struct LevelBuffer
+	{
+		LevelBuffer() : buffer(Q_NULLPTR) {}
+		QOpenGLBuffer* buffer;
+		QVector<int> zoneStart;
+	};
+
+	//! Upload a level, return Q_NULLPTR on failure.
+	const LevelBuffer* getLevelBuffer(const ZoneArray* z);
+
+	QMap<int, LevelBuffer> levels;
+	StelTextureSP texHalo;
+	StarGpuProgram* program;
+	//! Reused between frames to avoid allocations.
+	QVector<int> zones;
+	QVector<QPair<int, int> > ranges;
+};
+
+#endif // _STARGPUCATALOG_HPP_
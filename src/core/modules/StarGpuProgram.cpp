@@ -0,0 +1,295 @@
+/*
+ * Stellarium
+ * Copyright (C) 2017 Stellarium Developers
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Suite 500, Boston, MA  02110-1335, USA.
+ */
+
+#include "StarGpuProgram.hpp"
+#include "ZoneData.hpp"
+#include "StelProjectorClasses.hpp"
+
+#include <QDebug>
+#include <QOpenGLBuffer>
+#include <QOpenGLShaderProgram>
+
+#include <cstddef>
+
+// Not defined in the OpenGL ES headers. On desktop OpenGL, they must be enabled
+// for gl_PointSize and gl_PointCoord to work, on OpenGL ES they are always on.
+#ifndef GL_VERTEX_PROGRAM_POINT_SIZE
+#define GL_VERTEX_PROGRAM_POINT_SIZE 0x8642
+#endif
+#ifndef GL_POINT_SPRITE
+#define GL_POINT_SPRITE 0x8861
+#endif
+// Not in the OpenGL 1.1 headers of Windows
+#ifndef GL_ALIASED_POINT_SIZE_RANGE
+#define GL_ALIASED_POINT_SIZE_RANGE 0x846D
+#endif
+
+// The vertex attributes are read from the buffer with these offsets and sizes
+Q_STATIC_ASSERT(sizeof(StaticStarVertex)==28);
+
+StarGpuProgram::Params::Params()
+	: projectionType(0)
+	, widthStretch(1.f)
+	, movementFactor(0.f)
+	, cutoffMag(0.f)
+	, withExtinction(false)
+	, altRow(0.f, 0.f, 1.f, 0.f)
+	, extMagSteps(0.f)
+	, undergroundMode(0)
+	, twinkleAmount(0.f)
+	, twinkleSeed(0.f)
+{
+	for (int i=0;i<RCMagEntries*2;++i)
+		rcmag[i] = 0.f;
+}
+
+StarGpuProgram::StarGpuProgram()
+	: QOpenGLFunctions(QOpenGLContext::currentContext())
+	, program(Q_NULLPTR)
+	, maxPointSize(1.f)
+{
+	QOpenGLContext* context = QOpenGLContext::currentContext();
+	GLfloat pointSizeRange[2] = {1.f, 1.f};
+	glGetFloatv(GL_ALIASED_POINT_SIZE_RANGE, pointSizeRange);
+	maxPointSize = pointSizeRange[1];
+
+	// gl_PointCoord needs GLSL 1.20 on desktop OpenGL. Qt defines away the
+	// precision qualifiers there, so the same source works for OpenGL ES 2.
+	const QByteArray header = context->isOpenGLES() ? "" : "#version 120\n";
+
+	// The RCMag table is packed as two (radius, luminance) pairs per vec4 to
+	// stay within the minimal number of vertex uniforms of OpenGL ES 2.
+	// The twinkling uses a hash of the position instead of qrand() like
+	// StelSkyDrawer::drawPointSource, with the same amplitude and altitude dependence.
+	QOpenGLShader vshader(QOpenGLShader::Vertex);
+	const QByteArray vsrc = header +
+		"attribute highp vec3 pos;\n"
+		"attribute highp vec3 pm;\n"
+		"attribute mediump vec4 colorMag;\n"
+		"uniform highp mat4 modelView;\n"
+		"uniform highp mat4 projectionMatrix;\n"
+		"uniform highp float movementFactor;\n"
+		"uniform int projectionType;\n"
+		"uniform highp vec2 viewportCenter;\n"
+		"uniform highp vec2 pixelPerRad;\n"
+		"uniform highp float widthStretch;\n"
+		"uniform mediump vec4 rcmag[64];\n"
+		"uniform mediump float cutoffMag;\n"
+		"uniform bool withExtinction;\n"
+		"uniform highp vec4 altRow;\n"
+		"uniform mediump float extMagSteps;\n"
+		"uniform int undergroundMode;\n"
+		"uniform mediump float twinkleAmount;\n"
+		"uniform highp float twinkleSeed;\n"
+		"varying mediump vec3 outColor;\n"
+		"highp float airmass(highp float cosZ)\n"
+		"{\n"
+		"    if (cosZ<-0.035)\n"
+		"    {\n"
+		"        if (undergroundMode==0) return 0.;\n"
+		"        if (undergroundMode==1) return 42.;\n"
+		"        cosZ = min(1., -0.035 - (cosZ+0.035));\n"
+		"    }\n"
+		"    highp float nom=(1.002432*cosZ+0.148386)*cosZ+0.0096467;\n"
+		"    highp float denum=((cosZ+0.149864)*cosZ+0.0102963)*cosZ+0.000303978;\n"
+		"    return nom/denum;\n"
+		"}\n"
+		"void main(void)\n"
+		"{\n"
+		"    highp vec3 p = pos + movementFactor*pm;\n"
+		"    mediump float mag = floor(colorMag.a*255.+0.5);\n"
+		"    bool visible = true;\n"
+		"    mediump float twinkleFactor = 1.;\n"
+		"    if (withExtinction)\n"
+		"    {\n"
+		"        highp float sinAlt = dot(altRow.xyz, normalize(p)) + altRow.w;\n"
+		"        mag += float(int(airmass(sinAlt)*extMagSteps));\n"
+		"        visible = mag < cutoffMag && mag >= 0.;\n"
+		"        twinkleFactor = min(1., 1.-0.9*sinAlt);\n"
+		"    }\n"
+		"    else\n"
+		"        visible = mag <= cutoffMag;\n"
+		"    mediump vec2 rl = vec2(0.);\n"
+		"    if (visible)\n"
+		"    {\n"
+		"        int idx = int(mag);\n"
+		"        mediump vec4 pair = rcmag[idx/2];\n"
+		"        rl = (idx-2*(idx/2)==0) ? pair.xy : pair.zw;\n"
+		"    }\n"
+		"    highp vec3 v = (modelView*vec4(p, 1.)).xyz;\n"
+		"    highp vec2 xy;\n"
+		"    if (projectionType==0)\n"
+		"    {\n"
+		"        visible = visible && v.z<0.;\n"
+		"        xy = vec2(v.x*widthStretch, v.y)/(-v.z);\n"
+		"    }\n"
+		"    else\n"
+		"    {\n"
+		"        highp float h = 0.5*(length(v)-v.z);\n"
+		"        visible = visible && h>0.;\n"
+		"        xy = vec2(v.x*widthStretch, v.y)/h;\n"
+		"    }\n"
+		"    if (!visible || rl.x<=0.)\n"
+		"    {\n"
+		"        // Move the vertex out of the clip volume\n"
+		"        gl_Position = vec4(2., 2., 2., 1.);\n"
+		"        gl_PointSize = 1.;\n"
+		"        outColor = vec3(0.);\n"
+		"        return;\n"
+		"    }\n"
+		"    if (twinkleAmount>0.)\n"
+		"    {\n"
+		"        highp float r = fract(sin(dot(pos, vec3(12.9898, 78.233, 37.719)) + 6.2831853*twinkleSeed)*43758.5453);\n"
+		"        rl.y *= 1.-twinkleFactor*twinkleAmount*r;\n"
+		"    }\n"
+		"    highp vec2 win = viewportCenter + pixelPerRad*xy;\n"
+		"    gl_Position = projectionMatrix * vec4(win.x, win.y, 0, 1);\n"
+		"    gl_PointSize = 2.*rl.x;\n"
+		"    outColor = colorMag.rgb*rl.y;\n"
+		"}\n";
+	vshader.compileSourceCode(vsrc);
+	if (!vshader.log().isEmpty()) { qWarning() << "StarGpuProgram: Warnings while compiling vshader: " << vshader.log(); }
+
+	QOpenGLShader fshader(QOpenGLShader::Fragment);
+	const QByteArray fsrc = header +
+		"varying mediump vec3 outColor;\n"
+		"uniform sampler2D tex;\n"
+		"void main(void)\n"
+		"{\n"
+		"    gl_FragColor = texture2D(tex, gl_PointCoord)*vec4(outColor, 1.);\n"
+		"}\n";
+	fshader.compileSourceCode(fsrc);
+	if (!fshader.log().isEmpty()) { qWarning() << "StarGpuProgram: Warnings while compiling fshader: " << fshader.log(); }
+
+	program = new QOpenGLShaderProgram(context);
+	program->addShader(&vshader);
+	program->addShader(&fshader);
+	// Same check as StelPainter::linkProg, which is not used to keep this class independent of StelPainter
+	const bool linked = program->link();
+	const QString log = program->log();
+	if (!linked || (!log.isEmpty() && !log.contains("Link was successful") && !(log=="No errors.")))
+		qWarning() << QString("StarGpuProgram: Warnings while linking star shader program:\n%1").arg(log);
+	if (!linked)
+	{
+		delete program;
+		program = Q_NULLPTR;
+		return;
+	}
+	vars.pos = program->attributeLocation("pos");
+	vars.pm = program->attributeLocation("pm");
+	vars.colorMag = program->attributeLocation("colorMag");
+	vars.modelView = program->uniformLocation("modelView");
+	vars.projectionMatrix = program->uniformLocation("projectionMatrix");
+	vars.movementFactor = program->uniformLocation("movementFactor");
+	vars.projectionType = program->uniformLocation("projectionType");
+	vars.viewportCenter = program->uniformLocation("viewportCenter");
+	vars.pixelPerRad = program->uniformLocation("pixelPerRad");
+	vars.widthStretch = program->uniformLocation("widthStretch");
+	vars.rcmag = program->uniformLocation("rcmag");
+	vars.cutoffMag = program->uniformLocation("cutoffMag");
+	vars.withExtinction = program->uniformLocation("withExtinction");
+	vars.altRow = program->uniformLocation("altRow");
+	vars.extMagSteps = program->uniformLocation("extMagSteps");
+	vars.undergroundMode = program->uniformLocation("undergroundMode");
+	vars.twinkleAmount = program->uniformLocation("twinkleAmount");
+	vars.twinkleSeed = program->uniformLocation("twinkleSeed");
+	vars.texture = program->uniformLocation("tex");
+}
+
+StarGpuProgram::~StarGpuProgram()
+{
+	delete program;
+	program = Q_NULLPTR;
+}
+
+bool StarGpuProgram::setProjection(Params& params, const StelProjectorP& prj)
+{
+	// With refraction the model-view transformation is not linear
+	if (dynamic_cast<StelProjector::Mat4dTransform*>(prj->getModelViewTransform().data())==Q_NULLPTR)
+		return false;
+	if (dynamic_cast<const StelProjectorPerspective*>(prj.data()))
+		params.projectionType = 0;
+	else if (dynamic_cast<const StelProjectorStereographic*>(prj.data()))
+		params.projectionType = 1;
+	else
+		return false;
+
+	const Mat4f& m = prj->getProjectionMatrix();
+	params.projectionMatrix = QMatrix4x4(m[0], m[4], m[8], m[12], m[1], m[5], m[9], m[13], m[2], m[6], m[10], m[14], m[3], m[7], m[11], m[15]);
+	const Mat4d mv = prj->getModelViewTransform()->getApproximateLinearTransfo();
+	params.modelView = QMatrix4x4(mv[0], mv[4], mv[8], mv[12], mv[1], mv[5], mv[9], mv[13], mv[2], mv[6], mv[10], mv[14], mv[3], mv[7], mv[11], mv[15]);
+	params.viewportCenter = prj->getViewportCenter();
+	params.pixelPerRad = prj->getFlippedPixelPerRad();
+	params.widthStretch = prj->getWidthStretch();
+	return true;
+}
+
+void StarGpuProgram::draw(QOpenGLBuffer* buffer, const QVector<QPair<int, int> >& ranges, const Params& params)
+{
+	Q_ASSERT(program);
+	const bool isDesktopGL = !QOpenGLContext::currentContext()->isOpenGLES();
+	if (isDesktopGL)
+	{
+		glEnable(GL_VERTEX_PROGRAM_POINT_SIZE);
+		glEnable(GL_POINT_SPRITE);
+	}
+
+	program->bind();
+	program->setUniformValue(vars.modelView, params.modelView);
+	program->setUniformValue(vars.projectionMatrix, params.projectionMatrix);
+	program->setUniformValue(vars.movementFactor, params.movementFactor);
+	program->setUniformValue(vars.projectionType, params.projectionType);
+	program->setUniformValue(vars.viewportCenter, params.viewportCenter[0], params.viewportCenter[1]);
+	program->setUniformValue(vars.pixelPerRad, params.pixelPerRad[0], params.pixelPerRad[1]);
+	program->setUniformValue(vars.widthStretch, params.widthStretch);
+	program->setUniformValueArray(vars.rcmag, params.rcmag, RCMagEntries/2, 4);
+	program->setUniformValue(vars.cutoffMag, params.cutoffMag);
+	program->setUniformValue(vars.withExtinction, (GLint)params.withExtinction);
+	program->setUniformValue(vars.altRow, params.altRow[0], params.altRow[1], params.altRow[2], params.altRow[3]);
+	program->setUniformValue(vars.extMagSteps, params.extMagSteps);
+	program->setUniformValue(vars.undergroundMode, params.undergroundMode);
+	program->setUniformValue(vars.twinkleAmount, params.twinkleAmount);
+	program->setUniformValue(vars.twinkleSeed, params.twinkleSeed);
+	program->setUniformValue(vars.texture, 0);
+
+	buffer->bind();
+	program->setAttributeBuffer(vars.pos, GL_FLOAT, offsetof(StaticStarVertex, pos), 3, sizeof(StaticStarVertex));
+	program->enableAttributeArray(vars.pos);
+	program->setAttributeBuffer(vars.pm, GL_FLOAT, offsetof(StaticStarVertex, pm), 3, sizeof(StaticStarVertex));
+	program->enableAttributeArray(vars.pm);
+	program->setAttributeBuffer(vars.colorMag, GL_UNSIGNED_BYTE, offsetof(StaticStarVertex, color), 4, sizeof(StaticStarVertex));
+	program->enableAttributeArray(vars.colorMag);
+
+	for (int i=0;i<ranges.size();++i)
+	{
+		if (ranges[i].second>0)
+			glDrawArrays(GL_POINTS, ranges[i].first, ranges[i].second);
+	}
+
+	program->disableAttributeArray(vars.pos);
+	program->disableAttributeArray(vars.pm);
+	program->disableAttributeArray(vars.colorMag);
+	buffer->release();
+	program->release();
+	if (isDesktopGL)
+	{
+		glDisable(GL_VERTEX_PROGRAM_POINT_SIZE);
+		glDisable(GL_POINT_SPRITE);
+	}
+}
@@ -0,0 +1,116 @@
+/*
+ * Stellarium
+ * Copyright (C) 2017 Stellarium Developers
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Suite 500, Boston, MA  02110-1335, USA.
+ */
+
+#ifndef _STARGPUPROGRAM_HPP_
+#define _STARGPUPROGRAM_HPP_
+
+#include "StelProjectorType.hpp"
+#include "VecMath.hpp"
+
+#include <QMatrix4x4>
+#include <QOpenGLFunctions>
+#include <QPair>
+#include <QVector>
+
+class QOpenGLBuffer;
+class QOpenGLShaderProgram;
+
+//! @class StarGpuProgram
+//! The shader program of StarGpuCatalog. It draws ranges of a vertex buffer of StaticStarVertex
+//! as point sprites, with proper motion, projection, extinction, magnitude cutoff and twinkling
+//! computed in the vertex shader. It only needs an OpenGL context and no StelApp, so that it
+//! can be tested offscreen, including with a software renderer such as Mesa llvmpipe.
+class StarGpuProgram : protected QOpenGLFunctions
+{
+public:
+	//! Number of entries of the RCMag table available to the vertex shader.
+	static const int RCMagEntries = 128;
+
+	//! The per frame parameters of the vertex shader.
+	struct Params
+	{
+		Params();
+		QMatrix4x4 modelView;          //! J2000 to view frame, see setProjection()
+		QMatrix4x4 projectionMatrix;   //! see StelProjector::getProjectionMatrix()
+		int projectionType;            //! see setProjection()
+		Vec2f viewportCenter;          //! see StelProjector::getViewportCenter()
+		Vec2f pixelPerRad;             //! see StelProjector::getFlippedPixelPerRad()
+		float widthStretch;            //! see StelProjector::getWidthStretch()
+		float movementFactor;          //! same as in ZoneArray::draw
+		float rcmag[RCMagEntries*2];   //! radius and luminance of each magnitude step
+		float cutoffMag;               //! faintest drawn magnitude step
+		bool withExtinction;
+		Vec4f altRow;                  //! altitude row of StelCore::getMatJ2000ToAltAz()
+		float extMagSteps;             //! extinction coefficient in magnitude steps
+		int undergroundMode;           //! see Extinction::UndergroundExtinctionMode
+		float twinkleAmount;           //! see StelSkyDrawer::getTwinkleAmount(), 0 to disable twinkling
+		float twinkleSeed;             //! in [0,1], changes the twinkling of all stars
+	};
+
+	//! Must be called with the OpenGL context current.
+	StarGpuProgram();
+	~StarGpuProgram();
+
+	//! Get whether the shaders were compiled and linked.
+	bool isValid() const {return program!=Q_NULLPTR;}
+
+	//! Get the largest point size supported by the OpenGL implementation, in pixels.
+	float getMaxPointSize() const {return maxPointSize;}
+
+	//! Set the projection dependent parameters from a projector.
+	//! Only perspective and stereographic projections with a linear model-view
+	//! transformation (i.e. no refraction) have an implementation in the vertex shader.
+	//! @return false if the projection is not supported
+	static bool setProjection(Params& params, const StelProjectorP& prj);
+
+	//! Draw ranges of vertices.
+	//! The halo texture must be bound to texture unit 0 and the blending set by the caller.
+	//! @param buffer vertex buffer of StaticStarVertex
+	//! @param ranges index of the first vertex and number of vertices of each range
+	void draw(QOpenGLBuffer* buffer, const QVector<QPair<int, int> >& ranges, const Params& params);
+
+private:
+	QOpenGLShaderProgram* program;
+	struct ShaderVars
+	{
+		int pos;
+		int pm;
+		int colorMag;
+		int modelView;
+		int projectionMatrix;
+		int movementFactor;
+		int projectionType;
+		int viewportCenter;
+		int pixelPerRad;
+		int widthStretch;
+		int rcmag;
+		int cutoffMag;
+		int withExtinction;
+		int altRow;
+		int extMagSteps;
+		int undergroundMode;
+		int twinkleAmount;
+		int twinkleSeed;
+		int texture;
+	};
+	ShaderVars vars;
+	float maxPointSize;
+};
+
+#endif // _STARGPUPROGRAM_HPP_
@@ -42,6 +42,7 @@
 #include "StelPainter.hpp"
 #include "StelJsonParser.hpp"
 #include "ZoneArray.hpp"
+#include "StarGpuCatalog.hpp"
 #include "StelSkyDrawer.hpp"
 #include "RefractionExtinction.hpp"
 #include "StelModuleMgr.hpp"
@@ -56,6 +57,7 @@
 #include <QFileInfo>
 #include <QDir>
 #include <QCryptographicHash>
+#include <QtConcurrent>
 
 #include <errno.h>
 
@@ -67,6 +69,55 @@ static QStringList component_array;
 // It should always matchs the version field of the defaultStarsConfig.json file
 static const int StarCatalogFormatVersion = 9;
 
+// One zone of a ZoneArray to be processed by CollectVisibleStars in StarMgr::draw.
+// The jobs are kept from frame to frame, so that the star vectors keep their capacity.
+struct ZoneDrawJob
+{
+	ZoneDrawJob() : zone(-1), isInside(false) {}
+	int zone;
+	bool isInside;
+	QVector<StarDrawRecord> stars;
+};
+
+// Functor used with QtConcurrent to find and project the visible stars of zones in worker threads.
+// Each job owns its own result vector, so the workers share no mutable state.
+class CollectVisibleStars
+{
+public:
+	CollectVisibleStars(const ZoneArray* z, int limitMagIndex, StelCore* core, int maxMagStarName,
+			    const QVector<SphericalCap>& viewportCaps, const StelProjectorP& prj, const RCMag* rcmag_table)
+		: z(z), limitMagIndex(limitMagIndex), core(core), maxMagStarName(maxMagStarName), viewportCaps(viewportCaps)
+		, prj(prj), rcmag_table(rcmag_table) {}
+	void operator()(ZoneDrawJob& job) const
+	{
+		job.stars.resize(0);
+		z->collectVisibleStars(job.zone, job.isInside, limitMagIndex, core, maxMagStarName, viewportCaps, job.stars);
+
+		// Project here as well, so that only the twinkling and the vertices are left to the main thread.
+		StarDrawRecord* out = job.stars.data();
+		for (const StarDrawRecord* star=job.stars.constData();star<job.stars.constData()+job.stars.size();++star)
+		{
+			if (rcmag_table[star->rcMagIndex].radius<=0.f)
+				continue;
+			Vec3f win;
+			if (!(job.isInside ? prj->project(star->pos, win) : prj->projectCheck(star->pos, win)))
+				continue;
+			*out = *star;
+			out->win = win;
+			++out;
+		}
+		job.stars.resize(out-job.stars.data());
+	}
+private:
+	const ZoneArray* z;
+	int limitMagIndex;
+	StelCore* core;
+	int maxMagStarName;
+	const QVector<SphericalCap>& viewportCaps;
+	const StelProjectorP& prj;
+	const RCMag* rcmag_table;
+};
+
 // Initialise statics
 bool StarMgr::flagSciNames = true;
 QHash<int,QString> StarMgr::commonNamesMap;
@@ -139,6 +190,9 @@ StarMgr::StarMgr(void)
 	: flagStarName(false)
 	, labelsAmount(0.)
 	, gravityLabel(false)
+	, flagBatchedDraw(false)
+	, flagParallelDraw(false)
+	, gpuCatalog(Q_NULLPTR)
 	, hipIndex(new HipIndexStruct[NR_OF_HIP+1])
 {
 	setObjectName("StarMgr");
@@ -170,6 +224,7 @@ StarMgr::~StarMgr(void)
 	gridLevels.clear();
 	if (hipIndex)
 		delete[] hipIndex;
+	delete gpuCatalog;
 }
 
 // Allow untranslated name here if set in constellationMgr!
@@ -433,6 +488,10 @@ void StarMgr::init()
 	setFlagStars(conf->value("astro/flag_stars", true).toBool());
 	setFlagLabels(conf->value("astro/flag_star_name",true).toBool());
 	setLabelsAmount(conf->value("stars/labels_amount",3.f).toFloat());
+	flagBatchedDraw = conf->value("stars/flag_batched_draw", false).toBool();
+	flagParallelDraw = conf->value("stars/flag_parallel_draw", false).toBool();
+	if (conf->value("stars/flag_gpu_catalog", false).toBool())
+		gpuCatalog = new StarGpuCatalog();
 
 	// Load colors from config file
 	QString defaultColor = conf->value("color/default_color").toString();
@@ -1096,6 +1155,15 @@ int StarMgr::getMaxSearchLevel() const
 }
 
 
+void StarMgr::addDrawJob(int i, int zone, bool isInside)
+{
+	if (i>=drawJobs.size())
+		drawJobs.resize(i+1);
+	ZoneDrawJob& job = drawJobs[i];
+	job.zone = zone;
+	job.isInside = isInside;
+}
+
 // Draw all the stars
 void StarMgr::draw(StelCore* core)
 {
@@ -1163,10 +1231,39 @@ void StarMgr::draw(StelCore* core)
 		}
 		int zone;
 		
-		for (GeodesicSearchInsideIterator it1(*geodesic_search_result,z->level);(zone = it1.next()) >= 0;)
-			z->draw(&sPainter, zone, true, rcmag_table, limitMagIndex, core, maxMagStarName, names_brightness, viewportCaps);
-		for (GeodesicSearchBorderIterator it1(*geodesic_search_result,z->level);(zone = it1.next()) >= 0;)
-			z->draw(&sPainter, zone, false, rcmag_table, limitMagIndex, core, maxMagStarName,names_brightness, viewportCaps);
+		// Levels resident on the GPU need no work per star on the CPU
+		if (gpuCatalog && gpuCatalog->draw(&sPainter, core, z, *geodesic_search_result, rcmag_table, limitMagIndex))
+			continue;
+
+		if (flagParallelDraw)
+		{
+			// Collect the visible stars of all zones of this level in the thread pool,
+			// then hand them to the sky drawer in the order of the serial path so
+			// that the output (including twinkling) does not depend on the scheduling.
+			int nbJobs = 0;
+			for (GeodesicSearchInsideIterator it1(*geodesic_search_result,z->level);(zone = it1.next()) >= 0;)
+				addDrawJob(nbJobs++, zone, true);
+			for (GeodesicSearchBorderIterator it1(*geodesic_search_result,z->level);(zone = it1.next()) >= 0;)
+				addDrawJob(nbJobs++, zone, false);
+			QtConcurrent::blockingMap(drawJobs.begin(), drawJobs.begin()+nbJobs,
+						  CollectVisibleStars(z, limitMagIndex, core, maxMagStarName, viewportCaps, prj, rcmag_table));
+			for (int i=0;i<nbJobs;++i)
+				ZoneArray::drawProjectedStars(&sPainter, skyDrawer, drawJobs.at(i).stars, rcmag_table, names_brightness);
+		}
+		else if (flagBatchedDraw)
+		{
+			for (GeodesicSearchInsideIterator it1(*geodesic_search_result,z->level);(zone = it1.next()) >= 0;)
+				z->drawBatched(&sPainter, zone, true, rcmag_table, limitMagIndex, core, maxMagStarName, names_brightness, viewportCaps);
+			for (GeodesicSearchBorderIterator it1(*geodesic_search_result,z->level);(zone = it1.next()) >= 0;)
+				z->drawBatched(&sPainter, zone, false, rcmag_table, limitMagIndex, core, maxMagStarName,names_brightness, viewportCaps);
+		}
+		else
+		{
+			for (GeodesicSearchInsideIterator it1(*geodesic_search_result,z->level);(zone = it1.next()) >= 0;)
+				z->draw(&sPainter, zone, true, rcmag_table, limitMagIndex, core, maxMagStarName, names_brightness, viewportCaps);
+			for (GeodesicSearchBorderIterator it1(*geodesic_search_result,z->level);(zone = it1.next()) >= 0;)
+				z->draw(&sPainter, zone, false, rcmag_table, limitMagIndex, core, maxMagStarName,names_brightness, viewportCaps);
+		}
 	}
 	exit_loop:
 
@@ -1282,6 +1379,36 @@ void StarMgr::updateI18n()
 		const QString r = tn.join(" - ");
 		additionalNamesMapI18n[i] = r;
 	}
+	updateNameIndex();
+}
+
+void StarMgr::updateNameIndex()
+{
+	typedef StelObjectNameIndex::Name Name;
+	QVector<Name> names;
+	names.reserve(commonNamesMap.size() + commonNamesMapI18n.size() + sciNamesMapI18n.size() + varStarsMapI18n.size());
+	foreach (const QString& name, commonNamesMap)
+		names << Name(name, StelObjectNameIndex::EnglishName, 1);
+	foreach (const QString& name, commonNamesMapI18n)
+		names << Name(name, StelObjectNameIndex::TranslatedName, 1);
+	foreach (const QString& nameList, additionalNamesMap)
+	{
+		foreach (const QString& name, nameList.split(" - "))
+			names << Name(name, StelObjectNameIndex::EnglishName, 1);
+	}
+	foreach (const QString& nameList, additionalNamesMapI18n)
+	{
+		foreach (const QString& name, nameList.split(" - "))
+			names << Name(name, StelObjectNameIndex::TranslatedName, 1);
+	}
+	// Bayer and Flamsteed designations
+	foreach (const QString& name, sciNamesMapI18n)
+		names << Name(name, StelObjectNameIndex::Designation, 2);
+	foreach (const QString& name, sciAdditionalNamesMapI18n)
+		names << Name(name, StelObjectNameIndex::Designation, 2);
+	foreach (const varstar& v, varStarsMapI18n)
+		names << Name(v.designation, StelObjectNameIndex::Designation, 4);
+	StelApp::getInstance().getStelObjectMgr().getNameIndex().setNames(this, names);
 }
 
 // Search the star by HP number
@@ -1459,9 +1586,11 @@ StelObjectP StarMgr::searchByID(const QString &id) const
 	return searchByName(id);
 }
 
-//! Find and return the list of at most maxNbItem objects auto-completing the passed object name.
-QStringList StarMgr::listMatchingObjects(const QString& objPrefix, int maxNbItem, bool useStartOfWords, bool inEnglish) const
+//! Find the catalogue numbers auto-completing the passed object name. The names of the stars are in the name index.
+QStringList StarMgr::listMatchingUnindexedObjects(const QString& objPrefix, int maxNbItem, bool useStartOfWords, bool inEnglish) const
 {
+	Q_UNUSED(useStartOfWords);
+	Q_UNUSED(inEnglish);
 	QStringList result;
 	if (maxNbItem <= 0)
 	{
@@ -1470,129 +1599,6 @@ QStringList StarMgr::listMatchingObjects(const QString& objPrefix, int maxNbItem
 
 	QString objw = objPrefix.toUpper();
 
-	QMap<QString, int> cNamesIdx = inEnglish ? commonNamesIndex : commonNamesIndexI18n;
-	QMap<QString, int> aNamesIdx = inEnglish ? additionalNamesIndex : additionalNamesIndexI18n;
-
-	// Search for common names
-	if (useStartOfWords)
-	{
-		for (QMap<QString,int>::const_iterator it(cNamesIdx.lowerBound(objw)); it!=cNamesIdx.end(); ++it)
-		{
-			if (it.key().startsWith(objw))
-			{
-				if (maxNbItem<=0)
-					break;
-				result.append(inEnglish ? getCommonEnglishName(it.value()) : getCommonName(it.value()));
-				--maxNbItem;
-			}
-			else
-				break;
-		}
-		for (QMap<QString,int>::const_iterator ita(aNamesIdx.lowerBound(objw)); ita!=aNamesIdx.end(); ++ita)
-		{
-			if (ita.key().startsWith(objw))
-			{
-				if (maxNbItem<=0)
-					break;
-				QStringList names = (inEnglish ? getAdditionalEnglishNames(ita.value()) : getAdditionalNames(ita.value())).split(" - ");
-				foreach (QString name, names)
-				{
-					if (name.contains(objw, Qt::CaseInsensitive))
-					{
-						result.append(name);
-						--maxNbItem;
-					}
-				}
-			}
-			else
-				break;
-		}
-
-	}
-	else
-	{
-		QMapIterator<QString, int> i(cNamesIdx);
-		while (i.hasNext())
-		{
-			i.next();
-			if (i.key().contains(objw))
-			{
-				if (maxNbItem<=0)
-					break;
-				result.append(inEnglish ? getCommonEnglishName(i.value()) : getCommonName(i.value()));
-				--maxNbItem;
-			}
-		}
-		QMapIterator<QString, int> j(aNamesIdx);
-		while (j.hasNext())
-		{
-			j.next();
-			if (j.key().contains(objw))
-			{
-				if (maxNbItem<=0)
-					break;
-				QStringList names = (inEnglish ? getAdditionalEnglishNames(j.value()) : getAdditionalNames(j.value())).split(" - ");
-				foreach (QString name, names)
-				{
-					if (name.contains(objw, Qt::CaseInsensitive))
-					{
-						result.append(name);
-						--maxNbItem;
-					}
-				}
-			}
-		}
-	}
-
-	// Search for sci names
-	QString bayerPattern = objw;
-	QRegExp bayerRegEx(bayerPattern);
-
-	// if the first character is a Greek letter, check if there's an index
-	// after it, such as "alpha1 Cen".
-	if (objw.at(0).unicode() >= 0x0391 && objw.at(0).unicode() <= 0x03A9)
-		bayerRegEx.setPattern(bayerPattern.insert(1,"\\d?"));
-
-	for (QMap<QString,int>::const_iterator it(sciNamesIndexI18n.lowerBound(objw)); it!=sciNamesIndexI18n.end(); ++it)
-	{
-		if (it.key().indexOf(bayerRegEx)==0)
-		{
-			if (maxNbItem<=0)
-				break;
-			result << getSciName(it.value());
-			--maxNbItem;
-		}
-		else if (it.key().at(0) != objw.at(0))
-			break;
-	}
-
-	for (QMap<QString,int>::const_iterator it(sciAdditionalNamesIndexI18n.lowerBound(objw)); it!=sciAdditionalNamesIndexI18n.end(); ++it)
-	{
-		if (it.key().indexOf(bayerRegEx)==0)
-		{
-			if (maxNbItem<=0)
-				break;
-			result << getSciAdditionalName(it.value());
-			--maxNbItem;
-		}
-		else if (it.key().at(0) != objw.at(0))
-			break;
-	}
-
-	// Search for sci names for var stars
-	for (QMap<QString,int>::const_iterator it(varStarsIndexI18n.lowerBound(objw)); it!=varStarsIndexI18n.end(); ++it)
-	{
-		if (it.key().startsWith(objw))
-		{
-			if (maxNbItem<=0)
-				break;
-			result << getGcvsName(it.value());
-			--maxNbItem;
-		}
-		else
-			break;
-	}
-
 	// Add exact Hp catalogue numbers
 	QRegExp hpRx("^(HIP|HP)\\s*(\\d+)\\s*$");
 	hpRx.setCaseSensitivity(Qt::CaseInsensitive);
@@ -35,6 +35,8 @@ class StelPainter;
 class QSettings;
 
 class ZoneArray;
+class StarGpuCatalog;
+struct ZoneDrawJob;
 struct HipIndexStruct;
 
 static const int RCMAG_TABLE_SIZE = 4096;
@@ -152,12 +154,9 @@ public:
 
 	virtual StelObjectP searchByID(const QString &id) const;
 
-	//! Find and return the list of at most maxNbItem objects auto-completing the passed object English name.
-	//! @param objPrefix the case insensitive first letters of the searched object
-	//! @param maxNbItem the maximum number of returned object names
-	//! @param useStartOfWords the autofill mode for returned objects names
-	//! @return a list of matching object name by order of relevance, or an empty list if nothing match
-	virtual QStringList listMatchingObjects(const QString& objPrefix, int maxNbItem=5, bool useStartOfWords=false, bool inEnglish=false) const;
+	//! Find the exact HIP, SAO, HD, HR and WDS catalogue numbers auto-completing the passed object name.
+	//! The common and scientific names of the stars are registered in the name index.
+	virtual QStringList listMatchingUnindexedObjects(const QString& objPrefix, int maxNbItem, bool useStartOfWords, bool inEnglish) const;
 	//! @note Loading stars with the common names only.
 	virtual QStringList listAllObjects(bool inEnglish) const;	
 	virtual QStringList listAllObjectsByType(const QString& objType, bool inEnglish) const;
@@ -367,6 +366,9 @@ private:
 
 	void copyDefaultConfigFile();
 
+	//! Register the common, scientific and variable star names in the name index of the StelObjectMgr.
+	void updateNameIndex();
+
 	//! Loads common names for stars from a file.
 	//! Called when the SkyCulture is updated.
 	//! @param the path to a file containing the common names for bright stars.
@@ -413,6 +415,17 @@ private:
 	bool flagStarName;
 	double labelsAmount;
 	bool gravityLabel;
+	//! Use the batched structure-of-arrays star drawing (ZoneArray::drawBatched) instead of the scalar one.
+	//! Off by default (stars/flag_batched_draw): see the benchmarks of testStarBatch.
+	bool flagBatchedDraw;
+	//! Find and project the visible stars of the zones in the global thread pool (implies the batched drawing).
+	bool flagParallelDraw;
+	//! Zones processed by the thread pool when flagParallelDraw is set, reused from frame to frame.
+	QVector<ZoneDrawJob> drawJobs;
+	//! Set the zone of drawJobs[i], growing drawJobs if needed.
+	void addDrawJob(int i, int zone, bool isInside);
+	//! GPU-resident copy of the faint star catalogues, Q_NULLPTR unless enabled in the config.
+	StarGpuCatalog* gpuCatalog;
 
 	int maxGeodesicGridLevel;
 	int lastMaxSearchLevel;
@@ -18,6 +18,7 @@
  */
 
 #include "ZoneArray.hpp"
+#include "StarBatch.hpp"
 #include "StelApp.hpp"
 #include "StelFileMgr.hpp"
 #include "StelGeodesicGrid.hpp"
@@ -545,6 +546,145 @@ void SpecialZoneArray<Star>::draw(StelPainter* sPainter, int index, bool isInsid
 	}
 }
 
+void ZoneArray::drawBatched(StelPainter* sPainter, int index, bool is_inside, const RCMag* rcmag_table,
+			    int limitMagIndex, StelCore* core, int maxMagStarName, float names_brightness,
+			    const QVector<SphericalCap>& boundingCaps) const
+{
+	QVector<StarDrawRecord> visibleStars;
+	collectVisibleStars(index, is_inside, limitMagIndex, core, maxMagStarName, boundingCaps, visibleStars);
+	drawVisibleStars(sPainter, core->getSkyDrawer(), visibleStars, rcmag_table, !is_inside, names_brightness);
+}
+
+void ZoneArray::drawVisibleStars(StelPainter* sPainter, StelSkyDrawer* drawer, const QVector<StarDrawRecord>& stars,
+				 const RCMag* rcmag_table, bool checkInScreen, float names_brightness)
+{
+	foreach (const StarDrawRecord& star, stars)
+	{
+		const RCMag& rcMag = rcmag_table[star.rcMagIndex];
+		if (drawer->drawPointSource(sPainter, star.pos, rcMag, star.bvIndex, checkInScreen, star.twinkleFactor) && star.labelStar)
+		{
+			const float offset = rcMag.radius*0.7f;
+			const Vec3f colorr = StelSkyDrawer::indexToColor(star.bvIndex)*0.75f;
+			sPainter->setColor(colorr[0], colorr[1], colorr[2],names_brightness);
+			sPainter->drawText(Vec3d(star.pos[0], star.pos[1], star.pos[2]), star.labelStar->getNameI18n(), 0, offset, offset, false);
+		}
+	}
+}
+
+void ZoneArray::drawProjectedStars(StelPainter* sPainter, StelSkyDrawer* drawer, const QVector<StarDrawRecord>& stars,
+				   const RCMag* rcmag_table, float names_brightness)
+{
+	foreach (const StarDrawRecord& star, stars)
+	{
+		const RCMag& rcMag = rcmag_table[star.rcMagIndex];
+		if (drawer->drawProjectedPointSource(sPainter, star.win, rcMag, star.bvIndex, star.twinkleFactor) && star.labelStar)
+		{
+			const float offset = rcMag.radius*0.7f;
+			const Vec3f colorr = StelSkyDrawer::indexToColor(star.bvIndex)*0.75f;
+			sPainter->setColor(colorr[0], colorr[1], colorr[2],names_brightness);
+			sPainter->drawText(Vec3d(star.pos[0], star.pos[1], star.pos[2]), star.labelStar->getNameI18n(), 0, offset, offset, false);
+		}
+	}
+}
+
+// Only the stars of Star1 catalogues have names.
+static inline const Star1* labelStar(const Star1* s) {return s;}
+template<class Star> static inline const Star1* labelStar(const Star*) {return Q_NULLPTR;}
+
+template<class Star>
+void SpecialZoneArray<Star>::collectVisibleStars(int index, bool isInsideViewport, int limitMagIndex, StelCore* core,
+						 int maxMagStarName, const QVector<SphericalCap>& boundingCaps,
+						 QVector<StarDrawRecord>& result) const
+{
+	StelSkyDrawer* drawer = core->getSkyDrawer();
+	static const double d2000 = 2451545.0;
+	const float movementFactor = (M_PI/180.)*(0.0001/3600.) * ((core->getJDE()-d2000)/365.25) / star_position_scale;
+
+	const Extinction& extinction=drawer->getExtinction();
+	const bool withExtinction=drawer->getFlagHasAtmosphere() && extinction.getExtinctionCoefficient()>=0.01f;
+	const float k = 0.001f*mag_range/mag_steps;
+
+	// Same artificial cutoff as in draw()
+	int cutoffMagStep=limitMagIndex;
+	if (drawer->getFlagStarMagnitudeLimit())
+	{
+		cutoffMagStep = ((int)(drawer->getCustomStarMagnitudeLimit()*1000.f) - mag_min)*mag_steps/mag_range;
+		if (cutoffMagStep>limitMagIndex)
+			cutoffMagStep = limitMagIndex;
+	}
+	Q_ASSERT(cutoffMagStep<RCMAG_TABLE_SIZE);
+
+	const SpecialZoneData<Star>* zoneToDraw = getZones() + index;
+	const Mat4d& j2000ToAltAz = core->getMatJ2000ToAltAz();
+
+	StarBatch batch;
+	const Star* s = zoneToDraw->getStars();
+	const Star* lastStar = s + zoneToDraw->size;
+	while (s<lastStar && !batch.reachedCutoff)
+	{
+		const int n = batch.decode(zoneToDraw, s, (int)(lastStar-s), cutoffMagStep, movementFactor);
+		// Cull against the viewport caps if the zone is not strictly inside
+		if (!isInsideViewport)
+			batch.cull(boundingCaps);
+		// Sine of the geometric altitude, needed for extinction and twinkling
+		if (withExtinction)
+			batch.extinct(j2000ToAltAz, extinction);
+
+		// Keep the survivors
+		for (int i=0;i<n;++i)
+		{
+			if (!batch.visible[i])
+				continue;
+
+			const Star* star = s+i;
+			StarDrawRecord rec;
+			rec.rcMagIndex = star->getMag();
+			rec.twinkleFactor = 1.0f;
+			if (withExtinction)
+			{
+				rec.rcMagIndex = star->getMag() + (int)(batch.extMagShift[i]/k);
+				if (rec.rcMagIndex >= cutoffMagStep || rec.rcMagIndex<0)
+					continue;
+				rec.twinkleFactor=qMin(1.0f, 1.0f-0.9f*batch.altZ[i]);
+			}
+
+			// draw() passes normalized vectors only for border zones
+			rec.pos.set(batch.px[i], batch.py[i], batch.pz[i]);
+			if (!isInsideViewport)
+				rec.pos *= batch.invLen[i];
+			rec.bvIndex = star->getBVIndex();
+			rec.labelStar = Q_NULLPTR;
+			if (star->hasName() && rec.rcMagIndex < maxMagStarName && star->hasComponentID()<=1)
+				rec.labelStar = labelStar(star);
+			result.append(rec);
+		}
+		s += n;
+	}
+}
+
+template<class Star>
+void SpecialZoneArray<Star>::fillStaticVertices(QVector<StaticStarVertex>& vertices, QVector<int>& zoneStart) const
+{
+	vertices.resize(nr_of_stars);
+	zoneStart.resize(nr_of_zones+1);
+	StaticStarVertex* v = vertices.data();
+	for (unsigned int zone=0;zone<nr_of_zones;++zone)
+	{
+		const SpecialZoneData<Star>* z = getZones() + zone;
+		zoneStart[zone] = v - vertices.data();
+		for (const Star* s=z->getStars();s<z->getStars()+z->size;++s,++v)
+		{
+			v->pos = z->axis0*(float)s->getX0() + z->axis1*(float)s->getX1() + z->center;
+			v->pm = z->axis0*(float)s->getDx0() + z->axis1*(float)s->getDx1();
+			const Vec3f& color = StelSkyDrawer::indexToColor(s->getBVIndex());
+			for (int i=0;i<3;++i)
+				v->color[i] = (unsigned char)qBound(0, (int)(color[i]*255.f+0.5f), 255);
+			v->mag = (unsigned char)s->getMag();
+		}
+	}
+	zoneStart[nr_of_zones] = nr_of_stars;
+}
+
 template<class Star>
 void SpecialZoneArray<Star>::searchAround(const StelCore* core, int index, const Vec3d &v, double cosLimFov,
 					  QList<StelObjectP > &result)
@@ -68,6 +68,24 @@ struct HipIndexStruct
 	const Star1 *s;
 };
 
+//! @struct StarDrawRecord
+//! A star which passed viewport culling and magnitude cutoff in
+//! ZoneArray::collectVisibleStars(), ready to be handed to StelSkyDrawer.
+struct StarDrawRecord
+{
+	//! J2000 position, normalized for stars of border zones (as in ZoneArray::draw).
+	Vec3f pos;
+	//! Position on screen, only used by ZoneArray::drawProjectedStars().
+	Vec3f win;
+	//! Index in the RCMag table, after extinction.
+	int rcMagIndex;
+	int bvIndex;
+	float twinkleFactor;
+	//! Star whose name is drawn next to it, Q_NULLPTR if the star gets no label.
+	//! The name itself is only looked up when the label is drawn.
+	const Star1* labelStar;
+};
+
 //! @class ZoneArray
 //! Manages all ZoneData structures of a given StelGeodesicGrid level. An
 //! instance of this class is never created directly; the named constructor
@@ -104,6 +122,34 @@ public:
 					  int maxMagStarName, float names_brightness,
 					  const QVector<SphericalCap>& boundingCaps) const = 0;
 
+	//! Pure virtual method. See subclass implementation.
+	virtual void collectVisibleStars(int index, bool is_inside, int limitMagIndex, StelCore* core,
+					 int maxMagStarName, const QVector<SphericalCap>& boundingCaps,
+					 QVector<StarDrawRecord>& result) const = 0;
+
+	//! Same as draw(), but goes through collectVisibleStars() and drawVisibleStars().
+	void drawBatched(StelPainter* sPainter, int index, bool is_inside,
+			 const RCMag* rcmag_table, int limitMagIndex, StelCore* core,
+			 int maxMagStarName, float names_brightness,
+			 const QVector<SphericalCap>& boundingCaps) const;
+
+	//! Hand stars returned by collectVisibleStars() to the sky drawer and draw their labels.
+	//! Must be called from the thread owning the GL context, in the same order
+	//! as the zones would be drawn, in order to obtain deterministic output.
+	//! @param checkInScreen @c true if the stars come from a border zone
+	static void drawVisibleStars(StelPainter* sPainter, StelSkyDrawer* drawer, const QVector<StarDrawRecord>& stars,
+				     const RCMag* rcmag_table, bool checkInScreen, float names_brightness);
+
+	//! Same as drawVisibleStars(), for stars whose screen position was already computed and found on screen.
+	static void drawProjectedStars(StelPainter* sPainter, StelSkyDrawer* drawer, const QVector<StarDrawRecord>& stars,
+				       const RCMag* rcmag_table, float names_brightness);
+
+	//! Pure virtual method. See subclass implementation.
+	virtual void fillStaticVertices(QVector<StaticStarVertex>& vertices, QVector<int>& zoneStart) const = 0;
+
+	//! Get the number of zones in this catalog.
+	unsigned int getNrOfZones() const { return nr_of_zones; }
+
 	//! Get whether or not the catalog was successfully loaded.
 	//! @return @c true if at least one zone was loaded, otherwise @c false
 	bool isInitialized(void) const { return (nr_of_zones>0); }
@@ -184,6 +230,29 @@ protected:
 			  int maxMagStarName, float names_brightness,
 			  const QVector<SphericalCap>& boundingCaps) const;
 
+	//! Find the stars of a zone which have to be drawn, without drawing them.
+	//! The stars of the zone are decoded in batches into structure-of-arrays
+	//! buffers, so that position, proper motion, viewport culling, extinction
+	//! and magnitude cutoff run as tight loops over plain float arrays which
+	//! the compiler can vectorize (SSE/AVX2/NEON, depending on the target).
+	//! This method does not touch OpenGL state and can be called from worker threads.
+	//! @param index zone index to process
+	//! @param isInsideViewport whether the zone is inside the current viewport
+	//! @param limitMagIndex index from rcmag_table at which stars are not visible anymore
+	//! @param core core to use for extinction and proper motion
+	//! @param maxMagStarName magnitude limit of stars that display labels
+	//! @param boundingCaps caps of the viewport used for culling border zones
+	//! @param result the visible stars are appended to this vector, in draw order
+	virtual void collectVisibleStars(int index, bool isInsideViewport, int limitMagIndex, StelCore* core,
+					 int maxMagStarName, const QVector<SphericalCap>& boundingCaps,
+					 QVector<StarDrawRecord>& result) const;
+
+	//! Decode all stars of this catalog for upload into a static vertex buffer.
+	//! @param vertices the stars of all zones, zone after zone
+	//! @param zoneStart index of the first vertex of each zone in vertices,
+	//! with one extra entry holding the total number of vertices
+	virtual void fillStaticVertices(QVector<StaticStarVertex>& vertices, QVector<int>& zoneStart) const;
+
 	virtual void scaleAxis();
 	virtual void searchAround(const StelCore* core, int index,const Vec3d &v,double cosLimFov,
 					  QList<StelObjectP > &result);
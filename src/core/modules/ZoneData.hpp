@@ -48,6 +48,18 @@ struct ZoneData
 	void *stars;
 };
 
+//! @struct StaticStarVertex
+//! Vertex of a star as stored in the static vertex buffers of StarGpuCatalog, see StarGpuProgram.
+//! The J2000 position at epoch JDE is pos + movementFactor*pm, where
+//! movementFactor is the same as in ZoneArray::draw.
+struct StaticStarVertex
+{
+	Vec3f pos;                //! position at J2000.0, not normalized
+	Vec3f pm;                 //! proper motion, in units of the zone axes
+	unsigned char color[3];   //! from StelSkyDrawer::indexToColor
+	unsigned char mag;        //! magnitude index in the RCMag table
+}; // 28 byte
+
 //! @struct SpecialZoneData
 //! Wrapper struct around ZoneData.
 //! @tparam Star either Star1, Star2 or Star3, depending on the brightness of
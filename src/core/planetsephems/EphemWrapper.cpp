@@ -31,6 +31,10 @@ Foundation, Inc., 51 Franklin Street, Suite 500, Boston, MA  02110-1335, USA.
 #include "de430.hpp"
 #include "pluto.h"
 
+#include <QCoreApplication>
+#include <QThread>
+#include <QThreadStorage>
+
 #define EPHEM_MERCURY_ID  0
 #define EPHEM_VENUS_ID    1
 #define EPHEM_EMB_ID    2
@@ -84,6 +88,78 @@ bool EphemWrapper::jd_fits_de430(const double jd)
 	return ((jd > 2287184.5) && (jd < 2688976.5));
 }
 
+static QThreadStorage<EphemContext*> threadContexts;
+
+EphemContext::EphemContext(const int deCacheSlots)
+	: deCacheSlots(deCacheSlots)
+	, de430(Q_NULLPTR)
+	, de431(Q_NULLPTR)
+{
+	InitVsop87Context(&vsop87);
+	InitElp82bContext(&elp82b);
+}
+
+EphemContext::~EphemContext()
+{
+	if (de430)
+		FreeDe430Context(de430);
+	if (de431)
+		FreeDe431Context(de431);
+}
+
+EphemContext* EphemContext::current()
+{
+	const QCoreApplication* app = QCoreApplication::instance();
+	if (!app || QThread::currentThread()==app->thread())
+		return Q_NULLPTR;
+	if (!threadContexts.hasLocalData())
+		threadContexts.setLocalData(new EphemContext());
+	return threadContexts.localData();
+}
+
+void* EphemContext::getDe430Context()
+{
+	if (!de430)
+		de430 = CreateDe430Context(deCacheSlots);
+	return de430;
+}
+
+void* EphemContext::getDe431Context()
+{
+	if (!de431)
+		de431 = CreateDe431Context(deCacheSlots);
+	return de431;
+}
+
+// The following helpers use the global caches if ctx is Q_NULLPTR.
+static bool getDe430Coor(EphemContext* ctx, const double jde, const int planet_id, double * xyz, const int centralBody_id=CENTRAL_PLANET_ID)
+{
+	return ctx ? GetDe430CoorCtx(ctx->getDe430Context(), jde, planet_id, xyz, centralBody_id)
+		   : GetDe430Coor(jde, planet_id, xyz, centralBody_id);
+}
+
+static bool getDe431Coor(EphemContext* ctx, const double jde, const int planet_id, double * xyz, const int centralBody_id=CENTRAL_PLANET_ID)
+{
+	return ctx ? GetDe431CoorCtx(ctx->getDe431Context(), jde, planet_id, xyz, centralBody_id)
+		   : GetDe431Coor(jde, planet_id, xyz, centralBody_id);
+}
+
+static void getVsop87OsculatingCoor(EphemContext* ctx, const double jd0, const double jd, const int body, double *xyz)
+{
+	if (ctx)
+		GetVsop87OsculatingCoorCtx(&ctx->vsop87, jd0, jd, body, xyz);
+	else
+		GetVsop87OsculatingCoor(jd0, jd, body, xyz);
+}
+
+static void getElp82bCoor(EphemContext* ctx, const double jd, double xyz[3])
+{
+	if (ctx)
+		GetElp82bCoorCtx(&ctx->elp82b, jd, xyz);
+	else
+		GetElp82bCoor(jd, xyz);
+}
+
 bool use_de430(const double jd)
 {
 	return StelApp::getInstance().getCore()->de430IsActive() && EphemWrapper::jd_fits_de430(jd);
@@ -104,17 +180,18 @@ void get_planet_helio_coordsv(const double jd, double xyz[3], const int planet_i
 		return;
 	}
 
+	EphemContext* ctx = EphemContext::current();
 	if(use_de430(jd))
 	{
-		deOk=GetDe430Coor(jd, planet_id + 1, xyz);
+		deOk=getDe430Coor(ctx, jd, planet_id + 1, xyz);
 	}
 	else if(use_de431(jd))
 	{
-		deOk=GetDe431Coor(jd, planet_id + 1, xyz);
+		deOk=getDe431Coor(ctx, jd, planet_id + 1, xyz);
 	}
 	if (!deOk) //VSOP87 as fallback
 	{
-		GetVsop87Coor(jd, planet_id, xyz);
+		getVsop87OsculatingCoor(ctx, jd, jd, planet_id, xyz);
 	}
 }
 
@@ -129,17 +206,18 @@ void get_planet_helio_osculating_coordsv(double jd0, double jd, double xyz[3], i
 		return;
 	}
 
+	EphemContext* ctx = EphemContext::current();
 	if(use_de430(jd))
 	{
-		deOk=GetDe430Coor(jd, planet_id + 1, xyz);
+		deOk=getDe430Coor(ctx, jd, planet_id + 1, xyz);
 	}
 	else if(use_de431(jd))
 	{
-		deOk=GetDe431Coor(jd, planet_id + 1, xyz);
+		deOk=getDe431Coor(ctx, jd, planet_id + 1, xyz);
 	}
 	if (!deOk) //VSOP87 as fallback
 	{
-		GetVsop87OsculatingCoor(jd0, jd, planet_id, xyz);
+		getVsop87OsculatingCoor(ctx, jd0, jd, planet_id, xyz);
 	}
 }
 
@@ -158,13 +236,14 @@ void get_pluto_helio_coordsv(double jd,double xyz[3], void* unused)
 		return;
 	}
 
+	EphemContext* ctx = EphemContext::current();
 	if(use_de430(jd))
 	{
-		deOk=GetDe430Coor(jd, EPHEM_JPL_PLUTO_ID, xyz);
+		deOk=getDe430Coor(ctx, jd, EPHEM_JPL_PLUTO_ID, xyz);
 	}
 	else if(use_de431(jd))
 	{
-		deOk=GetDe431Coor(jd, EPHEM_JPL_PLUTO_ID, xyz);
+		deOk=getDe431Coor(ctx, jd, EPHEM_JPL_PLUTO_ID, xyz);
 	}
 	if (!deOk) // fallback to previous solution
 	{
@@ -201,19 +280,20 @@ void get_earth_helio_coordsv(const double jd,double xyz[3], void* unused)
 		return;
 	}
 
+	EphemContext* ctx = EphemContext::current();
 	if(use_de430(jd))
 	{
-		deOk=GetDe430Coor(jd, EPHEM_JPL_EARTH_ID, xyz);
+		deOk=getDe430Coor(ctx, jd, EPHEM_JPL_EARTH_ID, xyz);
 	}
 	else if(use_de431(jd))
 	{
-		deOk=GetDe431Coor(jd, EPHEM_JPL_EARTH_ID, xyz);
+		deOk=getDe431Coor(ctx, jd, EPHEM_JPL_EARTH_ID, xyz);
 	}
 	if (!deOk) //VSOP87 as fallback
 	{
 		double moon[3];
-		GetVsop87Coor(jd,EPHEM_EMB_ID,xyz);
-		GetElp82bCoor(jd,moon);
+		getVsop87OsculatingCoor(ctx,jd,jd,EPHEM_EMB_ID,xyz);
+		getElp82bCoor(ctx,jd,moon);
 		/* Earth != EMB:
 	0.0121505677733761 = mu_m/(1+mu_m),
 	mu_m = mass(moon)/mass(earth) = 0.01230002 */
@@ -304,12 +384,13 @@ void get_lunar_parent_coordsv(double jde,double xyz[3], void* unused)
 {
 	Q_UNUSED(unused);
 	bool deOk=false;
+	EphemContext* ctx = EphemContext::current();
 	if(use_de430(jde))
-		deOk=GetDe430Coor(jde, EPHEM_JPL_MOON_ID, xyz, EPHEM_JPL_EARTH_ID);
+		deOk=getDe430Coor(ctx, jde, EPHEM_JPL_MOON_ID, xyz, EPHEM_JPL_EARTH_ID);
 	else if(use_de431(jde))
-		deOk=GetDe431Coor(jde, EPHEM_JPL_MOON_ID, xyz, EPHEM_JPL_EARTH_ID);
+		deOk=getDe431Coor(ctx, jde, EPHEM_JPL_MOON_ID, xyz, EPHEM_JPL_EARTH_ID);
 	if (!deOk) // fallback...
-		GetElp82bCoor(jde,xyz);
+		getElp82bCoor(ctx, jde,xyz);
 }
 
 void get_phobos_parent_coordsv(double jd,double xyz[3], void* unused)
@@ -35,6 +35,43 @@ Foundation, Inc., 51 Franklin Street, Suite 500, Boston, MA  02110-1335, USA.
 #define DE430_FILENAME  "linux_p1550p2650.430"
 #define DE431_FILENAME  "lnxm13000p17000.431"
 
+#include "vsop87.h"
+#include "elp82b.h"
+
+//! Evaluation state of VSOP87, ELP2000-82B and DE430/DE431 for one thread.
+//! The coordinate functions below use the context of the calling thread, see current().
+//! The main thread keeps using the global caches of these theories, every other thread
+//! gets its own context, so that positions can be computed in several threads at once.
+//! The results are the same as those of the global caches for the same sequence of calls.
+//! Pluto is reentrant as well: it uses the DE context, or else the stateless series of pluto.c.
+//! The theories of the moons (L1, TASS17, GUST86, MarsSat) keep global caches, they are not
+//! reentrant and still must be serialized by the caller.
+class EphemContext
+{
+public:
+	//! Number of DE records cached per context by default.
+	static const int DE_CACHE_SLOTS = 4;
+
+	EphemContext(const int deCacheSlots=DE_CACHE_SLOTS);
+	~EphemContext();
+
+	//! Return the context of the calling thread, or Q_NULLPTR for the main thread.
+	//! The context of a thread is created on first use and deleted when the thread ends.
+	static EphemContext* current();
+
+	struct Vsop87Context vsop87;
+	struct Elp82bContext elp82b;
+	//! Return the DE430 context, created on first use, or Q_NULLPTR if DE430 is not initialized.
+	void* getDe430Context();
+	//! Return the DE431 context, created on first use, or Q_NULLPTR if DE431 is not initialized.
+	void* getDe431Context();
+
+private:
+	const int deCacheSlots;
+	void* de430;
+	void* de431;
+};
+
 class EphemWrapper{
 public:
     static void init_de430(const char* filepath);
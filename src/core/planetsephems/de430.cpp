@@ -36,11 +36,8 @@ THE SOFTWARE.
 
 static void * ephem;
 
-static Vec3d tempECL = Vec3d(0,0,0);
-static Vec3d tempICRF = Vec3d(0,0,0);
 static char nams[JPL_MAX_N_CONSTANTS][6];
 static double vals[JPL_MAX_N_CONSTANTS];
-static double tempXYZ[6];
 #ifdef UNIT_TEST
 // NOTE: Added hook for unit testing
 static const Mat4d matJ2000ToVsop87(Mat4d::xrotation(-23.4392803055555555556*(M_PI/180)) * Mat4d::zrotation(0.0000275*(M_PI/180)));
@@ -65,7 +62,8 @@ void InitDE430(const char* filepath)
 		double jd1, jd2;
 		jd1=jpl_get_double(ephem, JPL_EPHEM_START_JD);
 		jd2=jpl_get_double(ephem, JPL_EPHEM_END_JD);
-		qDebug() << "DE430 init successful. startJD=" << QString::number(jd1, 'f', 4) << "endJD=" << QString::number(jd2, 'f', 4);
+		qDebug() << "DE430 init successful. startJD=" << QString::number(jd1, 'f', 4) << "endJD=" << QString::number(jd2, 'f', 4)
+			 << (jpl_is_mapped(ephem) ? "(memory-mapped)" : "(file access)");
 	}
 }
 
@@ -74,13 +72,21 @@ void TerminateDE430()
   jpl_close_ephemeris(ephem);
 }
 
-bool GetDe430Coor(const double jde, const int planet_id, double * xyz, const int centralBody_id)
+void* CreateDe430Context(const int nCacheSlots)
 {
-    if(initDone)
-    {
-	// This may return some error code!
-	int jplresult=jpl_pleph(ephem, jde, planet_id, centralBody_id, tempXYZ, 0);
+	if (!initDone)
+		return NULL;
+	return jpl_init_context(ephem, nCacheSlots);
+}
+
+void FreeDe430Context(void* context)
+{
+	jpl_free_context(context);
+}
 
+// Check the result of jpl_pleph[_ctx]() and convert its ICRF position to VSOP87 coordinates.
+static bool finishDe430Coor(const int jplresult, const double jde, const int planet_id, const double* tempXYZ, double* xyz)
+{
 	switch (jplresult)
 	{
 		case 0: // all OK.
@@ -111,21 +117,40 @@ bool GetDe430Coor(const double jde, const int planet_id, double * xyz, const int
 			break;
 	}
 
-	jpl_pleph(ephem, jde, planet_id, centralBody_id, tempXYZ, 0);
-
-        tempICRF = Vec3d(tempXYZ[0], tempXYZ[1], tempXYZ[2]);
+	const Vec3d tempICRF = Vec3d(tempXYZ[0], tempXYZ[1], tempXYZ[2]);
 	#ifdef UNIT_TEST
-	tempECL = matJ2000ToVsop87 * tempICRF;
+	const Vec3d tempECL = matJ2000ToVsop87 * tempICRF;
 	#else
-        tempECL = StelCore::matJ2000ToVsop87 * tempICRF;
+	const Vec3d tempECL = StelCore::matJ2000ToVsop87 * tempICRF;
 	#endif
 
-        xyz[0] = tempECL[0];
-        xyz[1] = tempECL[1];
-        xyz[2] = tempECL[2];
+	xyz[0] = tempECL[0];
+	xyz[1] = tempECL[1];
+	xyz[2] = tempECL[2];
 	return true;
-    }
-    return false;
+}
+
+bool GetDe430Coor(const double jde, const int planet_id, double * xyz, const int centralBody_id)
+{
+	if(initDone)
+	{
+		double tempXYZ[6];
+		// This may return some error code!
+		const int jplresult=jpl_pleph(ephem, jde, planet_id, centralBody_id, tempXYZ, 0);
+		return finishDe430Coor(jplresult, jde, planet_id, tempXYZ, xyz);
+	}
+	return false;
+}
+
+bool GetDe430CoorCtx(void* context, const double jde, const int planet_id, double * xyz, const int centralBody_id)
+{
+	if(context)
+	{
+		double tempXYZ[6];
+		const int jplresult=jpl_pleph_ctx(context, jde, planet_id, centralBody_id, tempXYZ, 0);
+		return finishDe430Coor(jplresult, jde, planet_id, tempXYZ, xyz);
+	}
+	return false;
 }
 
 
@@ -34,6 +34,13 @@ void InitDE431(const char* filepath);
 // most of the time centralBody_id likely is the Sun. However, for Moon, use centralBody_id=EPHEM_JPL_EARTH_ID=3
 // return true if OK, false if something was wrong with the JPL functions. In this case, see log for details.
 bool GetDe431Coor(const double jde, const int planet_id, double * xyz, const int centralBody_id=CENTRAL_PLANET_ID);
+
+// Reentrant evaluation: each thread creates its own context, with nCacheSlots cached records of the file.
+// Returns NULL if DE431 has not been initialized successfully. Free the context with FreeDe431Context().
+void* CreateDe431Context(const int nCacheSlots);
+void FreeDe431Context(void* context);
+// Same as GetDe431Coor(), but only the context is modified. Returns false if context is NULL.
+bool GetDe431CoorCtx(void* context, const double jde, const int planet_id, double * xyz, const int centralBody_id=CENTRAL_PLANET_ID);
 // Not possible for a DE.
 //void GetDe431OsculatingCoor(double jd0, double jd, int planet_id, double *xyz, const int centralBody_id=CENTRAL_PLANET_ID);
 
@@ -43,6 +43,7 @@ the original Fortran code:
 
 ****************************************************************/
 
+#include "elp82b.h"
 #include "calc_interpolated_elements.h"
 
 #include <math.h>
@@ -162709,13 +162710,10 @@ void GetElp82bSphericalCoor(const double t,double r[3]) {
   r[2] = (accu[2] + t*(accu[5] + t*accu[8])) * a0_div_ath_times_au;
 }
 
-  /* ugly static variable for caching: */
-static double t_0 = -1e100;
-static double t_1 = -1e100;
-static double t_2 = -1e100;
-static double r_0[3];
-static double r_1[3];
-static double r_2[3];
+  /* cache of GetElp82bCoor(), the reentrant variant uses the callers context: */
+static struct Elp82bContext elp82b_global_context = {
+  -1e100,-1e100,-1e100,{0.0},{0.0},{0.0}
+};
 
 #define DELTA_T (1.0/(24.0*36525.0))
 
@@ -162731,11 +162729,21 @@ static const double q3 =  1.265417e-9;
 static const double q4 = -1.371808e-12;
 static const double q5 = -3.20334e-15;
 
+void InitElp82bContext(struct Elp82bContext *ctx) {
+  ctx->t_0 = -1e100;
+  ctx->t_1 = -1e100;
+  ctx->t_2 = -1e100;
+}
+
 void GetElp82bCoor(const double jd,double xyz[3]) {
+  GetElp82bCoorCtx(&elp82b_global_context,jd,xyz);
+}
+
+void GetElp82bCoorCtx(struct Elp82bContext *ctx,const double jd,double xyz[3]) {
   const double t = (jd - 2451545.0) / 36525.0;
   double r[3];
   CalcInterpolatedElements(t,r,3,&GetElp82bSphericalCoor,DELTA_T,
-                           &t_0,r_0,&t_1,r_1,&t_2,r_2);
+                           &ctx->t_0,ctx->r_0,&ctx->t_1,ctx->r_1,&ctx->t_2,ctx->r_2);
   {
     const double rh = r[2] * cos(r[1]);
     const double x3 = r[2] * sin(r[1]);
@@ -51,6 +51,23 @@ the original Fortran code:
 extern "C" {
 #endif
 
+struct Elp82bContext {
+  /* interpolation cache, see calc_interpolated_elements.h */
+  double t_0,t_1,t_2;
+  double r_0[3];
+  double r_1[3];
+  double r_2[3];
+};
+
+void InitElp82bContext(struct Elp82bContext *ctx);
+  /* Must be called once before the context is used.
+  */
+
+void GetElp82bCoorCtx(struct Elp82bContext *ctx,double jd,double xyz[3]);
+  /* Same as GetElp82bCoor(), with the cache in ctx instead of a global one.
+     Different threads can use different contexts at the same time.
+  */
+
 void GetElp82bCoor(double jd,double xyz[3]);
 
   /* Return the rectangular coordinates of the earths moon
@@ -52,9 +52,31 @@ struct jpl_eph_data {
    double *cache;
    struct interpolation_info iinfo;
    FILE *ifile;
+               /* If the whole file could be memory-mapped,  records are   */
+               /* read from there instead of ifile,  see map_ephemeris().  */
+   const unsigned char *map;
+   uint64_t map_size;
+   void *map_file;
    };
 #pragma pack()
 
+            /* Evaluation state of one thread,  see jpl_init_context().  */
+            /* The ephemeris header above is only read through it,       */
+            /* records are kept in a small least-recently-used cache,    */
+            /* unless they can be used in place from the mapped file.    */
+struct jpl_eph_context {
+   const struct jpl_eph_data *eph;
+   unsigned n_slots;
+   uint32_t *slot_rec;        /* record number held by each slot */
+   unsigned long *slot_used;  /* 'clock' value of the last use of each slot */
+   double *slot_buf;          /* n_slots records of ncoeff doubles */
+   unsigned long clock;
+   unsigned long n_hits, n_misses, n_mapped;
+   double pvsun[9];
+   double pvsun_t;
+   struct interpolation_info iinfo;
+   };
+
 /* 2014 Mar 25:  notes about the file structure :
 
 Bytes 0- 83:  first line ("JPL Planetary Ephemeris DExxx/LExxx")
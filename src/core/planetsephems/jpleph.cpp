@@ -63,6 +63,11 @@ details of the implementation encapsulated.
 #include <stdint.h>
 
 #include "StelUtils.hpp"
+#include <QFile>
+#include <QMutex>
+#ifndef Q_OS_WIN
+#include <sys/resource.h>
+#endif
 /**** include variable and type definitions, specific for this C version */
 
 #include "jpleph.h"
@@ -140,10 +145,13 @@ long DLL_FUNC jpl_get_long(const void *ephem, const int value)
 **           computed,  otherwise not.                                      **
 **                                                                          **
 *****************************************************************************/
-int DLL_FUNC jpl_pleph(void *ephem, const double et, const int ntarg,
+/* Common part of jpl_pleph() and jpl_pleph_ctx():  if ctx is NULL,  the state */
+/* kept in the ephemeris is used,  otherwise the one of the context.            */
+static int pleph_impl(struct jpl_eph_data *eph, struct jpl_eph_context *ctx,
+                      const double et, const int ntarg,
                       const int ncent, double rrd[], const int calc_velocity)
 {
-    struct jpl_eph_data *eph = (struct jpl_eph_data *)ephem;
+    const double *pvsun;
     double pv[13][6]={{0.}};/* pv is the position/velocity array
                              NUMBERED FROM ZERO: 0=Mercury,1=Venus,...
                              8=Pluto,9=Moon,10=Sun,11=SSBary,12=EMBary
@@ -189,7 +197,8 @@ int DLL_FUNC jpl_pleph(void *ephem, const double et, const int ntarg,
 	  //     which accesses it at byte offset 56.
 	  // I see it does explicitly NOT access list[14].
 	  // TODO: check again after next round of travis.
-          rval = jpl_state(ephem, et, list, pv, rrd, 0);
+          rval = (ctx ? jpl_state_ctx(ctx, et, list, pv, rrd, 0)
+                      : jpl_state(eph, et, list, pv, rrd, 0));
         }
         else          /*  quantity doesn't exist in the ephemeris file  */
           rval = JPL_EPH_QUANTITY_NOT_IN_EPHEMERIS;
@@ -213,11 +222,13 @@ int DLL_FUNC jpl_pleph(void *ephem, const double et, const int ntarg,
     }
 
   /*   make call to state   */
-   rval = jpl_state(eph, et, list, pv, rrd, 1);
+   rval = (ctx ? jpl_state_ctx(ctx, et, list, pv, rrd, 1)
+               : jpl_state(eph, et, list, pv, rrd, 1));
+   pvsun = (ctx ? ctx->pvsun : eph->pvsun);
    /* Solar System barycentric Sun state goes to pv[10][] */
    if(ntarg == 11 || ncent == 11)
       for(i = 0; i < 6; i++)
-         pv[10][i] = eph->pvsun[i];
+         pv[10][i] = pvsun[i];
 
    /* Solar System Barycenter coordinates & velocities equal to zero */
    if(ntarg == 12 || ncent == 12)
@@ -249,6 +260,20 @@ int DLL_FUNC jpl_pleph(void *ephem, const double et, const int ntarg,
    return(rval);
 }
 
+int DLL_FUNC jpl_pleph(void *ephem, const double et, const int ntarg,
+                      const int ncent, double rrd[], const int calc_velocity)
+{
+    return(pleph_impl((struct jpl_eph_data *)ephem, NULL, et, ntarg, ncent, rrd, calc_velocity));
+}
+
+int DLL_FUNC jpl_pleph_ctx(void *context, const double et, const int ntarg,
+                      const int ncent, double rrd[], const int calc_velocity)
+{
+    struct jpl_eph_context *ctx = (struct jpl_eph_context *)context;
+
+    return(pleph_impl((struct jpl_eph_data *)ctx->eph, ctx, et, ntarg, ncent, rrd, calc_velocity));
+}
+
 /* Some notes about the information stored in 'iinfo':  the posn_coeff[]
 array contains the Chebyshev polynomials for tc,
 
@@ -577,56 +602,77 @@ static int dimension(const int idx)
 **                       d epsilon dot                                      **
 **                                                                          **
 *****************************************************************************/
-int DLL_FUNC jpl_state(void *ephem, const double et, const int list[14],
-                          double pv[][6], double nut[4], const int bary)
-{
-	struct jpl_eph_data *eph = (struct jpl_eph_data *)ephem;
-	unsigned i, j, n_intervals;
-	uint32_t nr;
-	double *buf = eph->cache;
-	double t[2];
-	const double block_loc = (et - eph->ephem_start) / eph->ephem_step;
-	bool recompute_pvsun;
-	const double aufac = 1.0 / eph->au;
+/* Read record nr of the ephemeris into buf.  The file is shared by all */
+/* contexts,  so seeking and reading must not be interleaved.            */
+static QMutex file_mutex;
 
-	/*   error return for epoch out of range  */
-	if(et < eph->ephem_start || et > eph->ephem_end)
-		return(JPL_EPH_OUTSIDE_RANGE);
-
-	/*   calculate record # and relative time in interval   */
+static int read_record(const struct jpl_eph_data *eph, const uint32_t nr, double *buf)
+{
+	/* Read two blocks ahead to account for header: */
+	const uint64_t offset = (uint64_t)(nr + 2) * eph->recsize;
 
-	nr = (uint32_t)block_loc;
-	t[0] = block_loc - (double)nr;
-	if(!t[0] && nr)
+	if(eph->map)
 	{
-		t[0] = 1.;
-		nr--;
+		if(offset + (uint64_t)eph->ncoeff * sizeof(double) > eph->map_size)
+			return(JPL_EPH_READ_ERROR);
+		memcpy(buf, eph->map + offset, (size_t)eph->ncoeff * sizeof(double));
 	}
-
-	/*   read correct record if not in core (static vector buf[])   */
-	if(nr != eph->curr_cache_loc)
+	else
 	{
-		eph->curr_cache_loc = nr;
-		/* Read two blocks ahead to account for header: */
-		if(FSeek(eph->ifile, (nr + 2) * eph->recsize, SEEK_SET))
-		{
-			// GZ: Make sure we will try again on next call...
-			eph->curr_cache_loc=0;
+		QMutexLocker lock(&file_mutex);
+		if(FSeek(eph->ifile, offset, SEEK_SET))
 			return(JPL_EPH_FSEEK_ERROR);
-		}
 		if(fread(buf, sizeof(double), (size_t)eph->ncoeff, eph->ifile)
 				!= (size_t)eph->ncoeff)
 			return(JPL_EPH_READ_ERROR);
+	}
+
+	if(eph->swap_bytes)
+		swap_64_bit_val(buf, eph->ncoeff);
+	return(0);
+}
+
+/* Return record nr in place in the mapped file,  or NULL if the file is not */
+/* mapped,  needs byte swapping or is too short.                            */
+static const double *mapped_record(const struct jpl_eph_data *eph, const uint32_t nr)
+{
+	const uint64_t offset = (uint64_t)(nr + 2) * eph->recsize;
+
+	if(!eph->map || eph->swap_bytes
+			|| offset + (uint64_t)eph->ncoeff * sizeof(double) > eph->map_size)
+		return(NULL);
+	return((const double *)(eph->map + offset));
+}
 
-		if(eph->swap_bytes)
-			swap_64_bit_val(buf, eph->ncoeff);
+/* Split et into record number and relative time in the record. */
+static void locate_record(const struct jpl_eph_data *eph, const double et, uint32_t *nr, double t[2])
+{
+	const double block_loc = (et - eph->ephem_start) / eph->ephem_step;
+
+	*nr = (uint32_t)block_loc;
+	t[0] = block_loc - (double)*nr;
+	if(!t[0] && *nr)
+	{
+		t[0] = 1.;
+		(*nr)--;
 	}
 	t[1] = eph->ephem_step;
+}
 
-	if(eph->pvsun_t != et)   /* If several calls are made for the same et, */
+/* Interpolate the requested quantities from the record in buf.  iinfo,  */
+/* pvsun and pvsun_t are the evaluation state of the caller.             */
+static void state_from_record(const struct jpl_eph_data *eph, const double *buf, const double t[2],
+			      struct interpolation_info *iinfo, double *pvsun, double *pvsun_t,
+			      const double et, const int list[14], double pv[][6], double nut[4], const int bary)
+{
+	unsigned i, j, n_intervals;
+	bool recompute_pvsun;
+	const double aufac = 1.0 / eph->au;
+
+	if(*pvsun_t != et)   /* If several calls are made for the same et, */
 	{                      /* don't recompute pvsun each time... only on */
 		recompute_pvsun = true;   /* the first run through.                     */
-		eph->pvsun_t = et;
+		*pvsun_t = et;
 	}
 	else
 		recompute_pvsun = false;
@@ -642,7 +688,7 @@ int DLL_FUNC jpl_state(void *ephem, const double et, const int list[14],
 		for(i = 0; i < 15; i++)
 		{
 			unsigned quantities;
-			uint32_t *iptr = &eph->ipt[i + 1][0];
+			const uint32_t *iptr = &eph->ipt[i + 1][0];
 
 			if(i == 14)
 			{
@@ -656,15 +702,15 @@ int DLL_FUNC jpl_state(void *ephem, const double et, const int list[14],
 			}
 			if(n_intervals == iptr[2] && quantities)
 			{
-				double *dest = ((i == 10) ? eph->pvsun : pv[i]);
+				double *dest;
 
 				if(i < 10)
 					dest = pv[i];
 				else if(i == 14)
-					dest = eph->pvsun;
+					dest = pvsun;
 				else
 					dest = nut;
-				interp(&eph->iinfo, &buf[iptr[0]-1], t, (int)iptr[1],
+				interp(iinfo, &buf[iptr[0]-1], t, (int)iptr[1],
 						dimension(i + 1),
 						n_intervals, quantities, dest);
 
@@ -676,7 +722,103 @@ int DLL_FUNC jpl_state(void *ephem, const double et, const int list[14],
 	if(!bary)                             /* gotta correct everybody for */
 		for(i = 0; i < 9; i++)            /* the solar system barycenter */
 			for(j = 0; j < (unsigned)list[i] * 3; j++)
-				pv[i][j] -= eph->pvsun[j];
+				pv[i][j] -= pvsun[j];
+}
+
+int DLL_FUNC jpl_state(void *ephem, const double et, const int list[14],
+                          double pv[][6], double nut[4], const int bary)
+{
+	struct jpl_eph_data *eph = (struct jpl_eph_data *)ephem;
+	uint32_t nr;
+	const double *buf = eph->cache;
+	double t[2];
+
+	/*   error return for epoch out of range  */
+	if(et < eph->ephem_start || et > eph->ephem_end)
+		return(JPL_EPH_OUTSIDE_RANGE);
+
+	/*   calculate record # and relative time in interval   */
+	locate_record(eph, et, &nr, t);
+
+	/*   use the record in place if possible,  else read it if not in core   */
+	const double *mapped = mapped_record(eph, nr);
+	if(mapped)
+		buf = mapped;
+	else if(nr != eph->curr_cache_loc)
+	{
+		const int err = read_record(eph, nr, eph->cache);
+
+		eph->curr_cache_loc = nr;
+		if(err == JPL_EPH_FSEEK_ERROR)
+		{
+			// GZ: Make sure we will try again on next call...
+			eph->curr_cache_loc=0;
+		}
+		if(err)
+			return(err);
+	}
+
+	state_from_record(eph, buf, t, &eph->iinfo, eph->pvsun, &eph->pvsun_t,
+			  et, list, pv, nut, bary);
+	return(0);
+}
+
+int DLL_FUNC jpl_state_ctx(void *context, const double et, const int list[14],
+                          double pv[][6], double nut[4], const int bary)
+{
+	struct jpl_eph_context *ctx = (struct jpl_eph_context *)context;
+	const struct jpl_eph_data *eph = ctx->eph;
+	uint32_t nr;
+	unsigned i, slot = 0;
+	double *buf;
+	double t[2];
+
+	/*   error return for epoch out of range  */
+	if(et < eph->ephem_start || et > eph->ephem_end)
+		return(JPL_EPH_OUTSIDE_RANGE);
+
+	locate_record(eph, et, &nr, t);
+
+	const double *mapped = mapped_record(eph, nr);
+	if(mapped)
+	{
+		ctx->n_mapped++;
+		state_from_record(eph, mapped, t, &ctx->iinfo, ctx->pvsun, &ctx->pvsun_t,
+				  et, list, pv, nut, bary);
+		return(0);
+	}
+
+	/*   look for the record in the cache,  else replace the least recently used slot */
+	for(i = 0; i < ctx->n_slots; i++)
+	{
+		if(ctx->slot_rec[i] == nr)
+		{
+			slot = i;
+			break;
+		}
+		if(ctx->slot_used[i] < ctx->slot_used[slot])
+			slot = i;
+	}
+	buf = ctx->slot_buf + (size_t)slot * eph->ncoeff;
+	if(i < ctx->n_slots)
+		ctx->n_hits++;
+	else
+	{
+		const int err = read_record(eph, nr, buf);
+
+		ctx->n_misses++;
+		if(err)
+		{
+			ctx->slot_rec[slot] = (uint32_t)-1;
+			ctx->slot_used[slot] = 0;
+			return(err);
+		}
+		ctx->slot_rec[slot] = nr;
+	}
+	ctx->slot_used[slot] = ++ctx->clock;
+
+	state_from_record(eph, buf, t, &ctx->iinfo, ctx->pvsun, &ctx->pvsun_t,
+			  et, list, pv, nut, bary);
 	return(0);
 }
 
@@ -745,6 +887,26 @@ const char * jpl_init_error_message(void)
 **      Errors can be determined with the above jpl_init_error_code()     **
 ****************************************************************************/
 
+/* Map the whole ephemeris file read-only,  so that the pages are shared  */
+/* with other processes and records need not be copied.  If this fails,  */
+/* e.g. for DE431 in a 32 bit address space,  the file is read as before. */
+static void map_ephemeris(struct jpl_eph_data *eph, const char *ephemeris_filename)
+{
+   QFile *file = new QFile(QString::fromLocal8Bit(ephemeris_filename));
+   uchar *map = NULL;
+
+   if(file->open(QIODevice::ReadOnly))
+      map = file->map(0, file->size());
+   if(!map)
+   {
+      delete file;
+      return;
+   }
+   eph->map = map;
+   eph->map_size = (uint64_t)file->size();
+   eph->map_file = file;
+}
+
 void * DLL_FUNC jpl_init_ephemeris(const char *ephemeris_filename,
                           char nam[][6], double *val)
 {
@@ -944,6 +1106,8 @@ void * DLL_FUNC jpl_init_ephemeris(const char *ephemeris_filename,
           init_err_code = JPL_INIT_FREAD4_FAILED;
         }
       }
+   if(!init_err_code)
+      map_ephemeris(rval, ephemeris_filename);
   return(rval);
 }
 
@@ -959,9 +1123,100 @@ void DLL_FUNC jpl_close_ephemeris(void *ephem)
    struct jpl_eph_data *eph = (struct jpl_eph_data *)ephem;
 
    fclose(eph->ifile);
+   delete (QFile *)eph->map_file;   /* also unmaps the file */
    free(ephem);
 }
 
+int DLL_FUNC jpl_is_mapped(const void *ephem)
+{
+   return(((const struct jpl_eph_data *)ephem)->map != NULL);
+}
+
+#ifdef UNIT_TEST
+// NOTE: Added hook for unit testing
+void DLL_FUNC jpl_unmap_ephemeris(void *ephem)
+{
+   struct jpl_eph_data *eph = (struct jpl_eph_data *)ephem;
+
+   delete (QFile *)eph->map_file;
+   eph->map_file = NULL;
+   eph->map = NULL;
+   eph->map_size = 0;
+}
+#endif
+
+/****************************************************************************
+**    jpl_init_context(ephem, n_cache_slots)                               **
+*****************************************************************************
+**                                                                         **
+**    Allocate the evaluation state of one thread for an ephemeris opened  **
+**    with jpl_init_ephemeris(),  with a cache of n_cache_slots records.   **
+**    Several slots let a thread alternate between distant epochs without  **
+**    re-reading the records.  Returns NULL if memory isn't alloced.       **
+**    Free the context with jpl_free_context() before closing the file.    **
+****************************************************************************/
+void * DLL_FUNC jpl_init_context(const void *ephem, const int n_cache_slots)
+{
+   const struct jpl_eph_data *eph = (const struct jpl_eph_data *)ephem;
+   const unsigned n_slots = (n_cache_slots > 0 ? (unsigned)n_cache_slots : 1);
+   struct jpl_eph_context *ctx;
+   unsigned i;
+
+   if(!eph)
+      return(NULL);
+               /* Same single allocation trick as in jpl_init_ephemeris(): */
+   ctx = (struct jpl_eph_context *)calloc(sizeof(struct jpl_eph_context)
+                 + n_slots * (sizeof(double) * eph->ncoeff + sizeof(uint32_t) + sizeof(unsigned long)), 1);
+   if(!ctx)
+      return(NULL);
+   ctx->eph = eph;
+   ctx->n_slots = n_slots;
+   ctx->slot_buf = (double *)(ctx + 1);
+   ctx->slot_used = (unsigned long *)(ctx->slot_buf + (size_t)n_slots * eph->ncoeff);
+   ctx->slot_rec = (uint32_t *)(ctx->slot_used + n_slots);
+   for(i = 0; i < n_slots; i++)
+      ctx->slot_rec[i] = (uint32_t)-1;
+   ctx->pvsun_t = -1e100;
+   ctx->iinfo.posn_coeff[0] = 1.0;
+   ctx->iinfo.posn_coeff[1] = -2.0;
+   ctx->iinfo.vel_coeff[0] = 0.0;
+   ctx->iinfo.vel_coeff[1] = 1.0;
+   return(ctx);
+}
+
+void DLL_FUNC jpl_free_context(void *context)
+{
+   free(context);
+}
+
+void DLL_FUNC jpl_get_stats(const void *context, struct jpl_eph_stats *stats)
+{
+   const struct jpl_eph_context *ctx = (const struct jpl_eph_context *)context;
+
+   stats->mapped_reads = ctx->n_mapped;
+   stats->cache_hits = ctx->n_hits;
+   stats->cache_misses = ctx->n_misses;
+#ifdef Q_OS_WIN
+   stats->minor_faults = -1;
+   stats->major_faults = -1;
+#else
+   {
+      struct rusage usage;
+
+      if(getrusage(RUSAGE_SELF, &usage) == 0)
+      {
+         stats->minor_faults = usage.ru_minflt;
+         stats->major_faults = usage.ru_majflt;
+      }
+      else
+      {
+         stats->minor_faults = -1;
+         stats->major_faults = -1;
+      }
+   }
+#endif
+}
+
 /* Added 2011 Jan 18:  random access to any desired JPL constant */
 
 
@@ -969,6 +1224,7 @@ double DLL_FUNC jpl_get_constant(const int idx, void *ephem, char *constant_name
 {
 	struct jpl_eph_data *eph = (struct jpl_eph_data *)ephem;
 	double rval = 0.;
+	QMutexLocker lock(&file_mutex);
 
 	*constant_name = '\0';
 	if(idx >= 0 && idx < (int)eph->ncon)
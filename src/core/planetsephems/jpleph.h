@@ -61,6 +61,38 @@ int DLL_FUNC make_sub_ephem( void *ephem, const char *sub_filename,
                               const double start_jd, const double end_jd);
 double DLL_FUNC jpl_get_constant( const int idx, void *ephem, char *constant_name);
 
+         /* Reentrant evaluation:  jpl_state() and jpl_pleph() keep their */
+         /* cache in the ephemeris itself and must not be called from     */
+         /* several threads.  A context holds that state instead,  with   */
+         /* 'n_cache_slots' records,  so each thread can use its own.     */
+         /* The ephemeris must stay open while contexts use it.           */
+void * DLL_FUNC jpl_init_context( const void *ephem, const int n_cache_slots);
+void DLL_FUNC jpl_free_context( void *context);
+int DLL_FUNC jpl_state_ctx( void *context, const double et, const int list[14],
+                          double pv[][6], double nut[4], const int bary);
+int DLL_FUNC jpl_pleph_ctx( void *context, const double et, const int ntarg,
+                      const int ncent, double rrd[], const int calc_velocity);
+
+         /* The ephemeris file is memory-mapped if possible.  Records     */
+         /* are then read in place,  or copied and byte-swapped into the  */
+         /* cache of the context if the file has the other byte order.    */
+int DLL_FUNC jpl_is_mapped( const void *ephem);
+#ifdef UNIT_TEST
+         /* NOTE: Added hook for unit testing.  Read the records from the */
+         /* file again instead of the map,  to compare both.  Call it     */
+         /* before the ephemeris is evaluated.                            */
+void DLL_FUNC jpl_unmap_ephemeris( void *ephem);
+#endif
+         /* Statistics of a context:  records used in place from the map, */
+         /* records found in the cache,  records read or copied.  Page    */
+         /* faults are those of the whole process so far (-1 if unknown). */
+struct jpl_eph_stats
+   {
+   unsigned long mapped_reads, cache_hits, cache_misses;
+   long minor_faults, major_faults;
+   };
+void DLL_FUNC jpl_get_stats( const void *context, struct jpl_eph_stats *stats);
+
 #ifdef __cplusplus
 }
 #endif
@@ -42,7 +42,9 @@ Furthermore I used the addition formulas
 so that for given T the functions cos and sin have only to be called 12 times.
 
 
-ATTENTION! Due to static caching this solution is not reentrant and cannot be parallelized to run in several threads.
+ATTENTION! GetVsop87Coor() and GetVsop87OsculatingCoor() share one global cache,
+they are not reentrant and cannot be parallelized to run in several threads.
+Use the *Ctx variants with one struct Vsop87Context per thread instead.
 
 ****************************************************************/
 
@@ -54,6 +56,32 @@ ATTENTION! Due to static caching this solution is not reentrant and cannot be pa
 extern "C" {
 #endif
 
+#define VSOP87_DIM (8*6)
+
+struct Vsop87Context {
+  /* interpolation cache, see calc_interpolated_elements.h */
+  double t_0,t_1,t_2;
+  double elem_0[VSOP87_DIM];
+  double elem_1[VSOP87_DIM];
+  double elem_2[VSOP87_DIM];
+  /* elements of the last computed epoch */
+  double jd0;
+  double elem[VSOP87_DIM];
+};
+
+void InitVsop87Context(struct Vsop87Context *ctx);
+  /* Must be called once before the context is used.
+  */
+
+void GetVsop87CoorCtx(struct Vsop87Context *ctx,double jd,int body,double *xyz);
+void GetVsop87OsculatingCoorCtx(struct Vsop87Context *ctx,
+                                const double jd0,const double jd,
+                                const int body,double *xyz);
+  /* Same as GetVsop87Coor() and GetVsop87OsculatingCoor(),
+     with the cache in ctx. The results are the same as those of the
+     global functions for the same sequence of calls.
+  */
+
 void GetVsop87Coor(double jd,int body,double *xyz);
   /* Return the rectangular coordinates of the given planet
      and the given julian date jd expressed in dynamical time (TAI+32.184s).
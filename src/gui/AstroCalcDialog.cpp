@@ -29,6 +29,7 @@
 
 #include "SolarSystem.hpp"
 #include "Planet.hpp"
+#include "EphemerisEngine.hpp"
 #include "NebulaMgr.hpp"
 #include "Nebula.hpp"
 
@@ -1984,7 +1985,6 @@ void AstroCalcDialog::calculatePhenomena()
 
 	QList<NebulaP> dso;
 	dso.clear();
-	QVector<NebulaP> allDSO = dsoMgr->getAllDeepSkyObjects();
 
 	QList<StelObjectP> star, doubleStar, variableStar;
 	star.clear();
@@ -2089,49 +2089,49 @@ void AstroCalcDialog::calculatePhenomena()
 			}
 			break;
 		case 13: // Star clusters
-			foreach(const NebulaP& object, allDSO)
+			foreach(const NebulaP& object, dsoMgr->getDeepSkyObjectsOfTypes(QList<Nebula::NebulaType>() << Nebula::NebCl << Nebula::NebOc << Nebula::NebGc << Nebula::NebSA << Nebula::NebSC << Nebula::NebCn))
 			{
 				if (object->getVMagnitude(core)<brightLimit && (object->getDSOType()==Nebula::NebCl || object->getDSOType()==Nebula::NebOc || object->getDSOType()==Nebula::NebGc || object->getDSOType()==Nebula::NebSA || object->getDSOType()==Nebula::NebSC || object->getDSOType()==Nebula::NebCn))
 					dso.append(object);
 			}
 			break;
 		case 14: // Planetary nebulae
-			foreach(const NebulaP& object, allDSO)
+			foreach(const NebulaP& object, dsoMgr->getDeepSkyObjectsOfTypes(QList<Nebula::NebulaType>() << Nebula::NebPn << Nebula::NebPossPN << Nebula::NebPPN))
 			{
 				if (object->getDSOType()==Nebula::NebPn || object->getDSOType()==Nebula::NebPossPN || object->getDSOType()==Nebula::NebPPN)
 					dso.append(object);
 			}
 			break;
 		case 15: // Bright nebulae
-			foreach(const NebulaP& object, allDSO)
+			foreach(const NebulaP& object, dsoMgr->getDeepSkyObjectsOfTypes(QList<Nebula::NebulaType>() << Nebula::NebN << Nebula::NebBn << Nebula::NebEn << Nebula::NebRn << Nebula::NebHII << Nebula::NebISM << Nebula::NebCn << Nebula::NebSNR))
 			{
 				if (object->getVMagnitude(core)<brightLimit && (object->getDSOType()==Nebula::NebN || object->getDSOType()==Nebula::NebBn || object->getDSOType()==Nebula::NebEn || object->getDSOType()==Nebula::NebRn || object->getDSOType()==Nebula::NebHII || object->getDSOType()==Nebula::NebISM || object->getDSOType()==Nebula::NebCn || object->getDSOType()==Nebula::NebSNR))
 					dso.append(object);
 			}
 			break;
 		case 16: // Dark nebulae
-			foreach(const NebulaP& object, allDSO)
+			foreach(const NebulaP& object, dsoMgr->getDeepSkyObjectsOfTypes(QList<Nebula::NebulaType>() << Nebula::NebDn << Nebula::NebMolCld << Nebula::NebYSO))
 			{
 				if (object->getDSOType()==Nebula::NebDn || object->getDSOType()==Nebula::NebMolCld || object->getDSOType()==Nebula::NebYSO)
 					dso.append(object);
 			}
 			break;
 		case 17: // Galaxies
-			foreach(const NebulaP& object, allDSO)
+			foreach(const NebulaP& object, dsoMgr->getDeepSkyObjectsOfTypes(QList<Nebula::NebulaType>() << Nebula::NebGx << Nebula::NebAGx << Nebula::NebRGx << Nebula::NebQSO << Nebula::NebPossQSO << Nebula::NebBLL << Nebula::NebBLA << Nebula::NebIGx))
 			{
 				if (object->getVMagnitude(core)<brightLimit && (object->getDSOType()==Nebula::NebGx || object->getDSOType()==Nebula::NebAGx || object->getDSOType()==Nebula::NebRGx || object->getDSOType()==Nebula::NebQSO || object->getDSOType()==Nebula::NebPossQSO || object->getDSOType()==Nebula::NebBLL || object->getDSOType()==Nebula::NebBLA || object->getDSOType()==Nebula::NebIGx))
 					dso.append(object);
 			}
 			break;
 		case 18: // Symbiotic stars
-			foreach(const NebulaP& object, allDSO)
+			foreach(const NebulaP& object, dsoMgr->getDeepSkyObjectsOfTypes(QList<Nebula::NebulaType>() << Nebula::NebSymbioticStar))
 			{
 				if (object->getDSOType()==Nebula::NebSymbioticStar)
 					dso.append(object);
 			}
 			break;
 		case 19: // Emission-line stars
-			foreach(const NebulaP& object, allDSO)
+			foreach(const NebulaP& object, dsoMgr->getDeepSkyObjectsOfTypes(QList<Nebula::NebulaType>() << Nebula::NebEmissionLineStar))
 			{
 				if (object->getDSOType()==Nebula::NebEmissionLineStar)
 					dso.append(object);
@@ -2334,13 +2334,17 @@ QMap<double, double> AstroCalcDialog::findClosestApproach(PlanetP &object1, Plan
 		if (step0 > 0.25)
 			step0 = 0.25;
 
+	// The ephemeris engine computes the positions without core->update(), hence without disturbing the scene.
+	// Like the scene, the positions are topocentric when topocentric coordinates are used.
+	const EphemerisEngine engine(QList<PlanetP>() << object1 << object2, core->getCurrentPlanet());
+
 	step = step0;
 	double jd = startJD;
-	prevDist = findDistance(jd, object1, object2, opposition);
+	prevDist = findDistance(jd, engine, opposition);
 	jd += step;
 	while(jd <= stopJD)
 	{
-		dist = findDistance(jd, object1, object2, opposition);
+		dist = findDistance(jd, engine, opposition);
 		sgn = StelUtils::sign(dist - prevDist);
 
 		double factor = qAbs((dist - prevDist)/dist);
@@ -2358,7 +2362,7 @@ QMap<double, double> AstroCalcDialog::findClosestApproach(PlanetP &object1, Plan
 				sgn = prevSgn;
 				while(jd <= stopJD)
 				{
-					dist = findDistance(jd, object1, object2, opposition);
+					dist = findDistance(jd, engine, opposition);
 					sgn = StelUtils::sign(dist - prevDist);
 					if (sgn!=prevSgn)
 						break;
@@ -2369,7 +2373,7 @@ QMap<double, double> AstroCalcDialog::findClosestApproach(PlanetP &object1, Plan
 				}
 			}
 
-			if (findPrecise(&extremum, object1, object2, jd, step, sgn, opposition))
+			if (findPrecise(&extremum, engine, jd, step, sgn, opposition))
 			{
 				double sep = extremum.second*180./M_PI;
 				if (sep<maxSeparation)
@@ -2386,7 +2390,7 @@ QMap<double, double> AstroCalcDialog::findClosestApproach(PlanetP &object1, Plan
 	return separations;
 }
 
-bool AstroCalcDialog::findPrecise(QPair<double, double> *out, PlanetP object1, PlanetP object2, double JD, double step, int prevSign, bool opposition)
+bool AstroCalcDialog::findPrecise(QPair<double, double> *out, const EphemerisEngine& engine, double JD, double step, int prevSign, bool opposition)
 {
 	int sgn;
 	double dist, prevDist;
@@ -2394,20 +2398,20 @@ bool AstroCalcDialog::findPrecise(QPair<double, double> *out, PlanetP object1, P
 	if (out==Q_NULLPTR)
 		return false;
 
-	prevDist = findDistance(JD, object1, object2, opposition);
+	prevDist = findDistance(JD, engine, opposition);
 	step = -step/2.f;
 	prevSign = -prevSign;
 
 	while(true)
 	{
 		JD += step;
-		dist = findDistance(JD, object1, object2, opposition);
+		dist = findDistance(JD, engine, opposition);
 
 		if (qAbs(step)< 1.f/1440.f)
 		{
 			out->first = JD - step/2.0;
-			out->second = findDistance(JD - step/2.0, object1, object2, opposition);
-			if (out->second < findDistance(JD - 5.0, object1, object2, opposition))
+			out->second = findDistance(JD - step/2.0, engine, opposition);
+			if (out->second < findDistance(JD - 5.0, engine, opposition))
 				return true;
 			else
 				return false;
@@ -2423,12 +2427,11 @@ bool AstroCalcDialog::findPrecise(QPair<double, double> *out, PlanetP object1, P
 	}
 }
 
-double AstroCalcDialog::findDistance(double JD, PlanetP object1, PlanetP object2, bool opposition)
+double AstroCalcDialog::findDistance(double JD, const EphemerisEngine& engine, bool opposition)
 {
-	core->setJD(JD);
-	core->update(0);
-	Vec3d obj1 = object1->getJ2000EquatorialPos(core);
-	Vec3d obj2 = object2->getJ2000EquatorialPos(core);
+	const double JDE = JD + core->computeDeltaT(JD)/86400.;
+	Vec3d obj1 = engine.computeJ2000EquatorialPos(0, JD, JDE);
+	Vec3d obj2 = engine.computeJ2000EquatorialPos(1, JD, JDE);
 	double angle = obj1.angle(obj2);
 	if (opposition)
 		angle = M_PI - angle;
@@ -2496,13 +2499,15 @@ QMap<double, double> AstroCalcDialog::findClosestApproach(PlanetP &object1, Nebu
 		if (step0 > 0.25)
 			step0 = 0.25;
 
+	const EphemerisEngine engine(QList<PlanetP>() << object1, core->getCurrentPlanet());
+
 	step = step0;
 	double jd = startJD;
-	prevDist = findDistance(jd, object1, object2);
+	prevDist = findDistance(jd, engine, object2);
 	jd += step;
 	while(jd <= stopJD)
 	{
-		dist = findDistance(jd, object1, object2);
+		dist = findDistance(jd, engine, object2);
 		sgn = StelUtils::sign(dist - prevDist);
 
 		double factor = qAbs((dist - prevDist)/dist);
@@ -2520,7 +2525,7 @@ QMap<double, double> AstroCalcDialog::findClosestApproach(PlanetP &object1, Nebu
 				sgn = prevSgn;
 				while(jd <= stopJD)
 				{
-					dist = findDistance(jd, object1, object2);
+					dist = findDistance(jd, engine, object2);
 					sgn = StelUtils::sign(dist - prevDist);
 					if (sgn!=prevSgn)
 						break;
@@ -2531,7 +2536,7 @@ QMap<double, double> AstroCalcDialog::findClosestApproach(PlanetP &object1, Nebu
 				}
 			}
 
-			if (findPrecise(&extremum, object1, object2, jd, step, sgn))
+			if (findPrecise(&extremum, engine, object2, jd, step, sgn))
 			{
 				double sep = extremum.second*180./M_PI;
 				if (sep<maxSeparation)
@@ -2548,7 +2553,7 @@ QMap<double, double> AstroCalcDialog::findClosestApproach(PlanetP &object1, Nebu
 	return separations;
 }
 
-bool AstroCalcDialog::findPrecise(QPair<double, double> *out, PlanetP object1, NebulaP object2, double JD, double step, int prevSign)
+bool AstroCalcDialog::findPrecise(QPair<double, double> *out, const EphemerisEngine& engine, NebulaP object2, double JD, double step, int prevSign)
 {
 	int sgn;
 	double dist, prevDist;
@@ -2556,20 +2561,20 @@ bool AstroCalcDialog::findPrecise(QPair<double, double> *out, PlanetP object1, N
 	if (out==Q_NULLPTR)
 		return false;
 
-	prevDist = findDistance(JD, object1, object2);
+	prevDist = findDistance(JD, engine, object2);
 	step = -step/2.f;
 	prevSign = -prevSign;
 
 	while(true)
 	{
 		JD += step;
-		dist = findDistance(JD, object1, object2);
+		dist = findDistance(JD, engine, object2);
 
 		if (qAbs(step)< 1.f/1440.f)
 		{
 			out->first = JD - step/2.0;
-			out->second = findDistance(JD - step/2.0, object1, object2);
-			if (out->second < findDistance(JD - 5.0, object1, object2))
+			out->second = findDistance(JD - step/2.0, engine, object2);
+			if (out->second < findDistance(JD - 5.0, engine, object2))
 				return true;
 			else
 				return false;
@@ -2585,11 +2590,10 @@ bool AstroCalcDialog::findPrecise(QPair<double, double> *out, PlanetP object1, N
 	}
 }
 
-double AstroCalcDialog::findDistance(double JD, PlanetP object1, NebulaP object2)
+double AstroCalcDialog::findDistance(double JD, const EphemerisEngine& engine, NebulaP object2)
 {
-	core->setJD(JD);
-	core->update(0);
-	Vec3d obj1 = object1->getJ2000EquatorialPos(core);
+	const double JDE = JD + core->computeDeltaT(JD)/86400.;
+	Vec3d obj1 = engine.computeJ2000EquatorialPos(0, JD, JDE);
 	Vec3d obj2 = object2->getJ2000EquatorialPos(core);
 	return obj1.angle(obj2);
 }
@@ -2896,7 +2900,6 @@ void AstroCalcDialog::calculateWutObjects()
 		wutObjects.clear();
 
 		QList<PlanetP> allObjects = solarSystem->getAllPlanets();
-		QVector<NebulaP> allDSO = dsoMgr->getAllDeepSkyObjects();
 		QList<StelObjectP> hipStars = starMgr->getHipparcosStars();
 		QList<StelACStarData> dblHipStars = starMgr->getHipparcosDoubleStars();
 		QList<StelACStarData> varHipStars = starMgr->getHipparcosVariableStars();
@@ -2972,7 +2975,7 @@ void AstroCalcDialog::calculateWutObjects()
 					}
 					break;
 				case 2: // Bright nebulae
-					foreach(const NebulaP& object, allDSO)
+					foreach(const NebulaP& object, dsoMgr->getDeepSkyObjectsOfTypes(QList<Nebula::NebulaType>() << Nebula::NebN << Nebula::NebBn << Nebula::NebEn << Nebula::NebRn << Nebula::NebHII << Nebula::NebISM << Nebula::NebCn << Nebula::NebSNR))
 					{
 						Nebula::NebulaType ntype = object->getDSOType();
 						if ((bool)(tflags & Nebula::TypeBrightNebulae) && (ntype==Nebula::NebN || ntype==Nebula::NebBn || ntype==Nebula::NebEn || ntype==Nebula::NebRn || ntype==Nebula::NebHII || ntype==Nebula::NebISM || ntype==Nebula::NebCn || ntype==Nebula::NebSNR) && object->getVMagnitudeWithExtinction(core)<=magLimit && object->isAboveRealHorizon(core))
@@ -2993,7 +2996,7 @@ void AstroCalcDialog::calculateWutObjects()
 					}
 					break;
 				case 3: // Dark nebulae
-					foreach(const NebulaP& object, allDSO)
+					foreach(const NebulaP& object, dsoMgr->getDeepSkyObjectsOfTypes(QList<Nebula::NebulaType>() << Nebula::NebDn << Nebula::NebMolCld << Nebula::NebYSO))
 					{
 						Nebula::NebulaType ntype = object->getDSOType();
 						if ((bool)(tflags & Nebula::TypeDarkNebulae) && (ntype==Nebula::NebDn || ntype==Nebula::NebMolCld || ntype==Nebula::NebYSO) && object->isAboveRealHorizon(core))
@@ -3014,7 +3017,7 @@ void AstroCalcDialog::calculateWutObjects()
 					}
 					break;
 				case 4: // Galaxies
-					foreach(const NebulaP& object, allDSO)
+					foreach(const NebulaP& object, dsoMgr->getDeepSkyObjectsOfTypes(QList<Nebula::NebulaType>() << Nebula::NebGx << Nebula::NebAGx << Nebula::NebRGx << Nebula::NebQSO << Nebula::NebPossQSO << Nebula::NebBLL << Nebula::NebBLA << Nebula::NebIGx))
 					{
 						Nebula::NebulaType ntype = object->getDSOType();
 						if ((bool)(tflags & Nebula::TypeGalaxies) && (ntype==Nebula::NebGx || ntype==Nebula::NebAGx || ntype==Nebula::NebRGx || ntype==Nebula::NebQSO || ntype==Nebula::NebPossQSO || ntype==Nebula::NebBLL || ntype==Nebula::NebBLA || ntype==Nebula::NebIGx) && object->getVMagnitudeWithExtinction(core)<=magLimit && object->isAboveRealHorizon(core))
@@ -3035,7 +3038,7 @@ void AstroCalcDialog::calculateWutObjects()
 					}
 					break;
 				case 5: // Star clusters
-					foreach(const NebulaP& object, allDSO)
+					foreach(const NebulaP& object, dsoMgr->getDeepSkyObjectsOfTypes(QList<Nebula::NebulaType>() << Nebula::NebCl << Nebula::NebOc << Nebula::NebGc << Nebula::NebSA << Nebula::NebSC << Nebula::NebCn))
 					{
 						Nebula::NebulaType ntype = object->getDSOType();
 						if ((bool)(tflags & Nebula::TypeStarClusters) && (ntype==Nebula::NebCl || ntype==Nebula::NebOc || ntype==Nebula::NebGc || ntype==Nebula::NebSA || ntype==Nebula::NebSC || ntype==Nebula::NebCn) && object->getVMagnitudeWithExtinction(core)<=magLimit && object->isAboveRealHorizon(core))
@@ -3112,7 +3115,7 @@ void AstroCalcDialog::calculateWutObjects()
 					}
 					break;
 				case 14: // Planetary nebulae
-					foreach(const NebulaP& object, allDSO)
+					foreach(const NebulaP& object, dsoMgr->getDeepSkyObjectsOfTypes(QList<Nebula::NebulaType>() << Nebula::NebPn << Nebula::NebPossPN << Nebula::NebPPN))
 					{
 						Nebula::NebulaType ntype = object->getDSOType();
 						if ((bool)(tflags & Nebula::TypePlanetaryNebulae) && (ntype==Nebula::NebPn || ntype==Nebula::NebPossPN || ntype==Nebula::NebPPN) && object->getVMagnitudeWithExtinction(core)<=magLimit && object->isAboveRealHorizon(core))
@@ -3157,7 +3160,7 @@ void AstroCalcDialog::calculateWutObjects()
 					}
 					break;
 				case 18: // Symbiotic stars
-					foreach(const NebulaP& object, allDSO)
+					foreach(const NebulaP& object, dsoMgr->getDeepSkyObjectsOfTypes(QList<Nebula::NebulaType>() << Nebula::NebSymbioticStar))
 					{
 						Nebula::NebulaType ntype = object->getDSOType();
 						if ((bool)(tflags & Nebula::TypeOther) && (ntype==Nebula::NebSymbioticStar) && object->getVMagnitudeWithExtinction(core)<=magLimit && object->isAboveRealHorizon(core))
@@ -3178,7 +3181,7 @@ void AstroCalcDialog::calculateWutObjects()
 					}
 					break;
 				case 19: // Emission-line stars
-					foreach(const NebulaP& object, allDSO)
+					foreach(const NebulaP& object, dsoMgr->getDeepSkyObjectsOfTypes(QList<Nebula::NebulaType>() << Nebula::NebEmissionLineStar))
 					{
 						Nebula::NebulaType ntype = object->getDSOType();						
 						if ((bool)(tflags & Nebula::TypeOther) && (ntype==Nebula::NebEmissionLineStar) && (object->getVMagnitudeWithExtinction(core)<=magLimit) && object->isAboveRealHorizon(core))
@@ -3199,7 +3202,7 @@ void AstroCalcDialog::calculateWutObjects()
 					}
 					break;
 				case 20: // Supernova candidates
-					foreach(const NebulaP& object, allDSO)
+					foreach(const NebulaP& object, dsoMgr->getDeepSkyObjectsOfTypes(QList<Nebula::NebulaType>() << Nebula::NebSNC))
 					{
 						Nebula::NebulaType ntype = object->getDSOType();
 						bool visible = ((object->getVMagnitudeWithExtinction(core)<=magLimit) || (object->getVMagnitude(core)>90.f && magLimit>=19.f));
@@ -3221,7 +3224,7 @@ void AstroCalcDialog::calculateWutObjects()
 					}
 					break;
 				case 21: // Supernova remnant candidates
-					foreach(const NebulaP& object, allDSO)
+					foreach(const NebulaP& object, dsoMgr->getDeepSkyObjectsOfTypes(QList<Nebula::NebulaType>() << Nebula::NebSNRC))
 					{
 						Nebula::NebulaType ntype = object->getDSOType();
 						bool visible = ((object->getVMagnitudeWithExtinction(core)<=magLimit) || (object->getVMagnitude(core)>90.f && magLimit>=19.f));
@@ -3243,7 +3246,7 @@ void AstroCalcDialog::calculateWutObjects()
 					}
 					break;
 				case 22: // Supernova remnants
-					foreach(const NebulaP& object, allDSO)
+					foreach(const NebulaP& object, dsoMgr->getDeepSkyObjectsOfTypes(QList<Nebula::NebulaType>() << Nebula::NebSNR))
 					{
 						Nebula::NebulaType ntype = object->getDSOType();
 						bool visible = ((object->getVMagnitudeWithExtinction(core)<=magLimit) || (object->getVMagnitude(core)>90.f && magLimit>=19.f));
@@ -3265,7 +3268,7 @@ void AstroCalcDialog::calculateWutObjects()
 					}
 					break;
 				case 23: // Clusters of galaxies
-					foreach(const NebulaP& object, allDSO)
+					foreach(const NebulaP& object, dsoMgr->getDeepSkyObjectsOfTypes(QList<Nebula::NebulaType>() << Nebula::NebGxCl))
 					{
 						Nebula::NebulaType ntype = object->getDSOType();
 						if ((bool)(tflags & Nebula::TypeGalaxyClusters) && (ntype==Nebula::NebGxCl) && object->getVMagnitudeWithExtinction(core)<=magLimit && object->isAboveRealHorizon(core))
@@ -39,6 +39,7 @@
 
 class Ui_astroCalcDialogForm;
 class QListWidgetItem;
+class EphemerisEngine;
 
 class AstroCalcDialog : public StelDialog
 {
@@ -224,13 +225,13 @@ private:
 	//! angular separation ("conjunction" defined as equality of right ascension
 	//! of two body) and current solution is not accurate and slow.
 	QMap<double, double> findClosestApproach(PlanetP& object1, PlanetP& object2, double startJD, double stopJD, double maxSeparation, bool opposition);
-	double findDistance(double JD, PlanetP object1, PlanetP object2, bool opposition);
-	bool findPrecise(QPair<double, double>* out, PlanetP object1, PlanetP object2, double JD, double step, int prevSign, bool opposition);
+	double findDistance(double JD, const EphemerisEngine& engine, bool opposition);
+	bool findPrecise(QPair<double, double>* out, const EphemerisEngine& engine, double JD, double step, int prevSign, bool opposition);
 	void fillPhenomenaTable(const QMap<double, double> list, const PlanetP object1, const PlanetP object2, bool opposition);
 
 	QMap<double, double> findClosestApproach(PlanetP& object1, NebulaP& object2, double startJD, double stopJD, double maxSeparation);
-	double findDistance(double JD, PlanetP object1, NebulaP object2);
-	bool findPrecise(QPair<double, double>* out, PlanetP object1, NebulaP object2, double JD, double step, int prevSign);
+	double findDistance(double JD, const EphemerisEngine& engine, NebulaP object2);
+	bool findPrecise(QPair<double, double>* out, const EphemerisEngine& engine, NebulaP object2, double JD, double step, int prevSign);
 	void fillPhenomenaTable(const QMap<double, double> list, const PlanetP object1, const NebulaP object2);
 
 	QMap<double, double> findClosestApproach(PlanetP& object1, StelObjectP& object2, double startJD, double stopJD, double maxSeparation);
@@ -181,7 +181,7 @@ void LocationDialog::handleDialogSizeChanged(QSizeF size)
 
 void LocationDialog::reloadLocations()
 {
-	allModel->setStringList(StelApp::getInstance().getLocationMgr().getAllMap().keys());
+	allModel->setStringList(StelApp::getInstance().getLocationMgr().getAllIDs());
 }
 
 // Update the widget to make sure it is synchrone if the location is changed programmatically
@@ -0,0 +1,264 @@
+/*
+ * Stellarium
+ * Copyright (C) 2017 Stellarium Developers
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Suite 500, Boston, MA  02110-1335, USA.
+ */
+
+#include <QObject>
+#include <QtDebug>
+#include <QtTest>
+
+#include <cmath>
+
+#include "tests/testCometOrbitBatch.hpp"
+#include "Orbit.hpp"
+
+QTEST_GUILESS_MAIN(TestCometOrbitBatch)
+
+#define NB_BODIES 20000
+#define J2000 2451545.0
+// Gaussian gravitational constant, as in SolarSystem::loadPlanets()
+#define GAUSS_K 0.01720209895
+
+static double randomValue(double min, double max)
+{
+	return min + (max-min)*qrand()/RAND_MAX;
+}
+
+// Mean motion computed from the elements as when orbit_MeanMotion is not given in ssystem_minor.ini
+static double meanMotion(double q, double e)
+{
+	if (e==1.0)
+		return GAUSS_K * (1.5/q) * std::sqrt(0.5/q);
+	const double a = std::fabs(q/(1.0-e));
+	return GAUSS_K / (a*std::sqrt(a));
+}
+
+void TestCometOrbitBatch::initTestCase()
+{
+	qsrand(1);
+	bodies.reserve(NB_BODIES);
+	for (int k=0; k<NB_BODIES; ++k)
+	{
+		Elements b;
+		// 70% elliptic, including near-parabolic orbits, 20% hyperbolic, 10% parabolic
+		const int kind = k%10;
+		if (kind<6)
+			b.e = randomValue(0., 0.98);
+		else if (kind<7)
+			b.e = randomValue(0.98, 0.999);
+		else if (kind<9)
+			b.e = randomValue(1.0001, 1.5);
+		else
+			b.e = 1.0;
+		b.q = randomValue(0.3, 6.);
+		b.i = randomValue(0., M_PI);
+		b.Om = randomValue(0., 2.*M_PI);
+		b.w = randomValue(0., 2.*M_PI);
+		b.t0 = J2000 + randomValue(-2000., 2000.);
+		b.n = meanMotion(b.q, b.e);
+		bodies.append(b);
+	}
+
+	asteroids.reserve(NB_BODIES);
+	for (int k=0; k<NB_BODIES; ++k)
+	{
+		Elements b;
+		b.e = randomValue(0., 0.35);
+		b.q = randomValue(1.3, 4.5);
+		b.i = randomValue(0., 0.6);
+		b.Om = randomValue(0., 2.*M_PI);
+		b.w = randomValue(0., 2.*M_PI);
+		b.t0 = J2000 + randomValue(-2000., 2000.);
+		b.n = meanMotion(b.q, b.e);
+		asteroids.append(b);
+
+		EllipticalElements ell;
+		ell.q = b.q;
+		ell.e = b.e;
+		ell.i = b.i;
+		ell.Om = b.Om;
+		ell.w = b.w;
+		ell.M0 = randomValue(0., 2.*M_PI);
+		ell.period = 2.*M_PI/b.n;
+		ell.epoch = b.t0;
+		ell.parentObliquity = ell.parentNode = ell.parentLongitude = 0.;
+		ellipticalAsteroids.append(ell);
+	}
+
+	ellipticalBodies.reserve(NB_BODIES);
+	for (int k=0; k<NB_BODIES; ++k)
+	{
+		EllipticalElements b;
+		// One branch of EllipticalOrbit::eccentricAnomaly() each
+		const int kind = k%10;
+		if (kind==0)
+			b.e = 0.;
+		else if (kind<3)
+			b.e = randomValue(0., 0.2);
+		else if (kind<6)
+			b.e = randomValue(0.2, 0.9);
+		else if (kind<8)
+			b.e = randomValue(0.9, 0.999);
+		else if (kind<9)
+			b.e = 1.;
+		else
+			b.e = randomValue(1.0001, 1.5);
+		b.q = randomValue(0.3, 6.);
+		b.i = randomValue(0., M_PI);
+		b.Om = randomValue(0., 2.*M_PI);
+		b.w = randomValue(0., 2.*M_PI);
+		b.M0 = randomValue(0., 2.*M_PI);
+		b.period = randomValue(100., 5000.);
+		// EllipticalOrbit only handles positive mean anomalies of hyperbolic orbits
+		b.epoch = b.e>1. ? J2000-5000. : J2000 + randomValue(-2000., 2000.);
+		// Like moons, with the rotation of the parent planet
+		const bool rotatedParent = k%7==0;
+		b.parentObliquity = rotatedParent ? randomValue(0., M_PI) : 0.;
+		b.parentNode = rotatedParent ? randomValue(0., 2.*M_PI) : 0.;
+		b.parentLongitude = rotatedParent ? randomValue(0., 2.*M_PI) : 0.;
+		ellipticalBodies.append(b);
+	}
+}
+
+void TestCometOrbitBatch::testBatchSameAsCometOrbit_data()
+{
+	QTest::addColumn<double>("jde");
+	QTest::newRow("J2000") << J2000;
+	QTest::newRow("J2000+1000d") << J2000+1000.;
+	QTest::newRow("J1990") << J2000-3652.5;
+	QTest::newRow("2017-09-04") << 2458000.5;
+}
+
+void TestCometOrbitBatch::testBatchSameAsCometOrbit()
+{
+	QFETCH(double, jde);
+	CometOrbitBatch batch;
+	foreach (const Elements& b, bodies)
+		batch.add(b.q, b.e, b.i, b.Om, b.w, b.t0, b.n);
+	QCOMPARE(batch.size(), bodies.size());
+
+	QVector<double> x(batch.size()), y(batch.size()), z(batch.size());
+	batch.computePositions(jde, x.data(), y.data(), z.data());
+	for (int k=0; k<bodies.size(); ++k)
+	{
+		const Elements& b = bodies.at(k);
+		// Parameters of the orbits created by SolarSystem for bodies orbiting the Sun
+		CometOrbit orbit(b.q, b.e, b.i, b.Om, b.w, b.t0, 0., b.n, 0., 0., 0.);
+		Vec3d pos;
+		orbit.positionAtTimevInVSOP87Coordinates(jde, pos, false);
+		const double error = qMax(std::fabs(pos[0]-x[k]), qMax(std::fabs(pos[1]-y[k]), std::fabs(pos[2]-z[k])));
+		QVERIFY2(error<=1e-12, qPrintable(QString("body %1 (e=%2, q=%3): position differs by %4 AU")
+						  .arg(k).arg(b.e, 0, 'f', 6).arg(b.q).arg(error)));
+	}
+}
+
+void TestCometOrbitBatch::benchmarkCometOrbit()
+{
+	QVector<CometOrbit*> orbits;
+	orbits.reserve(asteroids.size());
+	foreach (const Elements& b, asteroids)
+		orbits.append(new CometOrbit(b.q, b.e, b.i, b.Om, b.w, b.t0, 0., b.n, 0., 0., 0.));
+	QVector<double> x(orbits.size()), y(orbits.size()), z(orbits.size());
+	double jde = J2000;
+	QBENCHMARK {
+		for (int k=0; k<orbits.size(); ++k)
+		{
+			Vec3d pos;
+			orbits[k]->positionAtTimevInVSOP87Coordinates(jde, pos, false);
+			x[k] = pos[0];
+			y[k] = pos[1];
+			z[k] = pos[2];
+		}
+		jde += 1.;
+	}
+	qDeleteAll(orbits);
+}
+
+void TestCometOrbitBatch::benchmarkBatch()
+{
+	CometOrbitBatch batch;
+	foreach (const Elements& b, asteroids)
+		batch.add(b.q, b.e, b.i, b.Om, b.w, b.t0, b.n);
+	QVector<double> x(batch.size()), y(batch.size()), z(batch.size());
+	double jde = J2000;
+	QBENCHMARK {
+		batch.computePositions(jde, x.data(), y.data(), z.data());
+		jde += 1.;
+	}
+}
+
+void TestCometOrbitBatch::testEllipticalBatchSameAsEllipticalOrbit_data()
+{
+	testBatchSameAsCometOrbit_data();
+}
+
+void TestCometOrbitBatch::testEllipticalBatchSameAsEllipticalOrbit()
+{
+	QFETCH(double, jde);
+	EllipticalOrbitBatch batch;
+	foreach (const EllipticalElements& b, ellipticalBodies)
+		batch.add(b.q, b.e, b.i, b.Om, b.w, b.M0, b.period, b.epoch, b.parentObliquity, b.parentNode, b.parentLongitude);
+	QCOMPARE(batch.size(), ellipticalBodies.size());
+
+	QVector<double> x(batch.size()), y(batch.size()), z(batch.size());
+	batch.computePositions(jde, x.data(), y.data(), z.data());
+	for (int k=0; k<ellipticalBodies.size(); ++k)
+	{
+		const EllipticalElements& b = ellipticalBodies.at(k);
+		EllipticalOrbit orbit(b.q, b.e, b.i, b.Om, b.w, b.M0, b.period, b.epoch, b.parentObliquity, b.parentNode, b.parentLongitude);
+		Vec3d pos;
+		orbit.positionAtTimevInVSOP87Coordinates(jde, pos);
+		const double error = qMax(std::fabs(pos[0]-x[k]), qMax(std::fabs(pos[1]-y[k]), std::fabs(pos[2]-z[k])));
+		QVERIFY2(error<=1e-12, qPrintable(QString("body %1 (e=%2, q=%3): position differs by %4 AU")
+						  .arg(k).arg(b.e, 0, 'f', 6).arg(b.q).arg(error)));
+	}
+}
+
+void TestCometOrbitBatch::benchmarkEllipticalOrbit()
+{
+	QVector<EllipticalOrbit*> orbits;
+	orbits.reserve(ellipticalAsteroids.size());
+	foreach (const EllipticalElements& b, ellipticalAsteroids)
+		orbits.append(new EllipticalOrbit(b.q, b.e, b.i, b.Om, b.w, b.M0, b.period, b.epoch, 0., 0., 0.));
+	QVector<double> x(orbits.size()), y(orbits.size()), z(orbits.size());
+	double jde = J2000;
+	QBENCHMARK {
+		for (int k=0; k<orbits.size(); ++k)
+		{
+			Vec3d pos;
+			orbits[k]->positionAtTimevInVSOP87Coordinates(jde, pos);
+			x[k] = pos[0];
+			y[k] = pos[1];
+			z[k] = pos[2];
+		}
+		jde += 1.;
+	}
+	qDeleteAll(orbits);
+}
+
+void TestCometOrbitBatch::benchmarkEllipticalBatch()
+{
+	EllipticalOrbitBatch batch;
+	foreach (const EllipticalElements& b, ellipticalAsteroids)
+		batch.add(b.q, b.e, b.i, b.Om, b.w, b.M0, b.period, b.epoch, 0., 0., 0.);
+	QVector<double> x(batch.size()), y(batch.size()), z(batch.size());
+	double jde = J2000;
+	QBENCHMARK {
+		batch.computePositions(jde, x.data(), y.data(), z.data());
+		jde += 1.;
+	}
+}
@@ -0,0 +1,60 @@
+/*
+ * Stellarium
+ * Copyright (C) 2017 Stellarium Developers
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Suite 500, Boston, MA  02110-1335, USA.
+ */
+
+#ifndef _TESTCOMETORBITBATCH_HPP_
+#define _TESTCOMETORBITBATCH_HPP_
+
+#include <QObject>
+#include <QTest>
+#include <QVector>
+
+class TestCometOrbitBatch : public QObject
+{
+Q_OBJECT
+private slots:
+	void initTestCase();
+	void testBatchSameAsCometOrbit_data();
+	void testBatchSameAsCometOrbit();
+	void benchmarkCometOrbit();
+	void benchmarkBatch();
+	void testEllipticalBatchSameAsEllipticalOrbit_data();
+	void testEllipticalBatchSameAsEllipticalOrbit();
+	void benchmarkEllipticalOrbit();
+	void benchmarkEllipticalBatch();
+private:
+	//! Elements in the order of the CometOrbit constructor, without orbitGoodDays.
+	struct Elements
+	{
+		double q, e, i, Om, w, t0, n;
+	};
+	//! Elements in the order of the EllipticalOrbit constructor.
+	struct EllipticalElements
+	{
+		double q, e, i, Om, w, M0, period, epoch, parentObliquity, parentNode, parentLongitude;
+	};
+	QVector<Elements> bodies;
+	//! Elliptic orbits with moderate eccentricities, like most minor planets.
+	QVector<Elements> asteroids;
+	//! Orbits of all kinds handled by EllipticalOrbit::eccentricAnomaly(), some with a rotated parent.
+	QVector<EllipticalElements> ellipticalBodies;
+	//! The asteroids, as ell_orbit of bodies orbiting the Sun.
+	QVector<EllipticalElements> ellipticalAsteroids;
+};
+
+#endif // _TESTCOMETORBITBATCH_HPP_
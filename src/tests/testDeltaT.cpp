@@ -26,6 +26,7 @@
 #include <QtGlobal>
 
 #include "StelUtils.hpp"
+#include "StelDeltaTCache.hpp"
 
 QTEST_GUILESS_MAIN(TestDeltaT)
 
@@ -337,3 +338,95 @@ void TestDeltaT::testDeltaTByStephensonMorrison1984WideDates()
 							.toUtf8());
 	}
 }
+
+// A DeltaT algorithm, as set by StelCore::setCurrentDeltaTAlgorithm()
+struct DeltaTModel
+{
+	const char* name;
+	double (*function)(const double JD);
+	double nDot;
+	bool useMoon;
+	bool useDE430;
+};
+
+// Custom algorithm, with the default coefficients
+static double getDeltaTByCustomEquation(const double JD)
+{
+	int year, month, day;
+	StelUtils::getDateFromJulianDay(JD, &year, &month, &day);
+	double u = (StelUtils::getDecYear(year, month, day)-1820.)/100.;
+	return -20. + u*(0. + u*32.);
+}
+
+// As StelCore::computeDeltaTDirect()
+static double computeModelDeltaT(const double JD, const void* context)
+{
+	const DeltaTModel* model = static_cast<const DeltaTModel*>(context);
+	double deltaT = model->function(JD);
+	if (model->useMoon)
+		deltaT += StelUtils::getMoonSecularAcceleration(JD, model->nDot, model->useDE430 && JD>2287184.5 && JD<2688976.5);
+	return deltaT;
+}
+
+void TestDeltaT::testDeltaTCache()
+{
+	static const DeltaTModel models[] = {
+		{"WithoutCorrection",			StelUtils::getDeltaTwithoutCorrection,		-26.0,		false, false},
+		{"Schoch",				StelUtils::getDeltaTBySchoch,			-29.68,		true, false},
+		{"Clemence",				StelUtils::getDeltaTByClemence,			-22.44,		true, false},
+		{"IAU",					StelUtils::getDeltaTByIAU,			-22.44,		true, false},
+		{"AstronomicalEphemeris",		StelUtils::getDeltaTByAstronomicalEphemeris,	-22.44,		true, false},
+		{"TuckermanGoldstine",			StelUtils::getDeltaTByTuckermanGoldstine,	-22.44,		true, false},
+		{"MullerStephenson",			StelUtils::getDeltaTByMullerStephenson,		-37.5,		true, false},
+		{"Stephenson1978",			StelUtils::getDeltaTByStephenson1978,		-30.0,		true, false},
+		{"SchmadelZech1979",			StelUtils::getDeltaTBySchmadelZech1979,		-23.8946,	true, false},
+		{"MorrisonStephenson1982",		StelUtils::getDeltaTByMorrisonStephenson1982,	-26.0,		true, false},
+		{"StephensonMorrison1984",		StelUtils::getDeltaTByStephensonMorrison1984,	-26.0,		true, false},
+		{"StephensonHoulden",			StelUtils::getDeltaTByStephensonHoulden,	-26.0,		true, false},
+		{"Espenak",				StelUtils::getDeltaTByEspenak,			-23.8946,	true, false},
+		{"Borkowski",				StelUtils::getDeltaTByBorkowski,		-23.895,	true, false},
+		{"SchmadelZech1988",			StelUtils::getDeltaTBySchmadelZech1988,		-26.0,		true, false},
+		{"ChaprontTouze",			StelUtils::getDeltaTByChaprontTouze,		-23.8946,	true, false},
+		{"StephensonMorrison1995",		StelUtils::getDeltaTByStephensonMorrison1995,	-26.0,		true, false},
+		{"Stephenson1997",			StelUtils::getDeltaTByStephenson1997,		-26.0,		true, false},
+		{"ChaprontMeeus",			StelUtils::getDeltaTByChaprontMeeus,		-25.7376,	true, false},
+		{"JPLHorizons",				StelUtils::getDeltaTByJPLHorizons,		-25.7376,	true, false},
+		{"MeeusSimons",				StelUtils::getDeltaTByMeeusSimons,		-25.7376,	true, false},
+		{"ReingoldDershowitz",			StelUtils::getDeltaTByReingoldDershowitz,	-26.0,		true, false},
+		{"MontenbruckPfleger",			StelUtils::getDeltaTByMontenbruckPfleger,	-26.0,		true, false},
+		{"MorrisonStephenson2004",		StelUtils::getDeltaTByMorrisonStephenson2004,	-26.0,		true, false},
+		{"Reijs",				StelUtils::getDeltaTByReijs,			-26.0,		true, false},
+		{"EspenakMeeus",			StelUtils::getDeltaTByEspenakMeeus,		-25.858,	true, false},
+		{"EspenakMeeus (DE430)",		StelUtils::getDeltaTByEspenakMeeus,		-25.858,	true, true},
+		{"EspenakMeeusZeroMoonAccel",		StelUtils::getDeltaTByEspenakMeeus,		-25.858,	false, false},
+		{"Banjevic",				StelUtils::getDeltaTByBanjevic,			-26.0,		true, false},
+		{"IslamSadiqQureshi",			StelUtils::getDeltaTByIslamSadiqQureshi,	-26.0,		false, false},
+		{"KhalidSultanaZaidi",			StelUtils::getDeltaTByKhalidSultanaZaidi,	-26.0,		false, false},
+		{"StephensonMorrisonHohenkerk2016",	StelUtils::getDeltaTByStephensonMorrisonHohenkerk2016,	-25.82,	true, false},
+		{"Custom",				getDeltaTByCustomEquation,			-26.0,		true, false}
+	};
+
+	// Dates from year -1000 to 3000, at various times of the day
+	QVector<double> dates;
+	for (double JD=1355807.5; JD<2817152.5; JD+=9.71+0.005*(dates.size()%97))
+		dates.append(JD);
+
+	for (unsigned int m=0; m<sizeof(models)/sizeof(models[0]); ++m)
+	{
+		const DeltaTModel& model = models[m];
+		StelDeltaTCache cache(computeModelDeltaT, &model);
+		QVector<double> batch(dates.size());
+		cache.getDeltaT(dates.constData(), batch.data(), dates.size());
+		for (int i=0; i<dates.size(); ++i)
+		{
+			const double JD = dates.at(i);
+			const double expected = computeModelDeltaT(JD, &model);
+			const double result = cache.getDeltaT(JD);
+			QVERIFY2(qAbs(result-expected)<=StelDeltaTCache::Tolerance,
+				 QString("algorithm=%1 JD=%2 result=%3 expected=%4")
+				 .arg(model.name).arg(JD, 0, 'f', 5).arg(result, 0, 'f', 4).arg(expected, 0, 'f', 4).toUtf8());
+			QVERIFY2(batch.at(i)==result, QString("algorithm=%1 JD=%2 batch=%3 single=%4")
+				 .arg(model.name).arg(JD, 0, 'f', 5).arg(batch.at(i), 0, 'f', 4).arg(result, 0, 'f', 4).toUtf8());
+		}
+	}
+}
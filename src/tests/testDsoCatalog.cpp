@@ -0,0 +1,280 @@
+/*
+ * Stellarium
+ * Copyright (C) 2017 Stellarium Developers
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Suite 500, Boston, MA  02110-1335, USA.
+ */
+
+#include <QObject>
+#include <QtDebug>
+#include <QtTest>
+#include <QDataStream>
+#include <QFile>
+#include <QSet>
+
+#include <cmath>
+
+#include "tests/testDsoCatalog.hpp"
+#include "DsoCatalog.hpp"
+#include "StelGeodesicGrid.hpp"
+#include "StelUtils.hpp"
+
+QTEST_GUILESS_MAIN(TestDsoCatalog)
+
+#define CATALOG_VERSION "3.2"
+
+static TestDsoCatalog::DatRecord makeRecord(int id)
+{
+	TestDsoCatalog::DatRecord r;
+	r.id = id;
+	// Spread over the sphere, including the poles and both sides of RA 0
+	r.ra = std::fmod(id*2.399963f, 2.f*M_PI) - (id%3==0 ? 2.f*M_PI : 0.f);
+	r.dec = std::asin(2.f*((id*0.618034f)-std::floor(id*0.618034f))-1.f);
+	if (id%97==0)
+		r.dec = (id%2 ? 1.f : -1.f)*M_PI/2.f;
+	r.bMag = 5.f+id%150*0.1f;
+	r.vMag = id%5==0 ? 99.f : 4.f+id%150*0.1f;
+	r.type = id%20;
+	r.mType = id%4==0 ? QString() : QString("SB%1").arg(QChar('a'+id%3));
+	r.majorAxisSize = id%7*0.1f;
+	r.minorAxisSize = id%7*0.05f;
+	r.orientationAngle = id%180;
+	r.z = id*1e-5f;
+	r.zErr = 1e-6f;
+	r.plx = 0.f;
+	r.plxErr = 0.f;
+	r.dist = id*0.3f;
+	r.distErr = 0.1f;
+	r.NGC = id%2 ? id : 0;
+	r.IC = id%3 ? 0 : id;
+	r.M = id<=110 ? id : 0;
+	r.C = 0;
+	r.B = 0;
+	r.Sh2 = id%11 ? 0 : id;
+	r.VdB = r.RCW = r.LDN = r.LBN = r.Cr = r.Mel = 0;
+	r.PGC = id*10;
+	r.UGC = 0;
+	r.Ced = id%13 ? QString() : QString("%1a").arg(id);
+	r.Arp = r.VV = 0;
+	r.PK = id%17 ? QString() : QString("%1+09.1").arg(id%360);
+	r.PNG = id%19 ? QString() : QString("%1.1+01.2").arg(id%360);
+	r.SNRG = QString();
+	r.ACO = id%23 ? QString() : QString::number(id);
+	return r;
+}
+
+static bool writeDat(const QString& path, const QVector<TestDsoCatalog::DatRecord>& records, const QString& version, int truncate=0)
+{
+	QByteArray data;
+	QDataStream out(&data, QIODevice::WriteOnly);
+	out.setVersion(QDataStream::Qt_5_2);
+	out << version << QString("test");
+	foreach (const TestDsoCatalog::DatRecord& r, records)
+	{
+		out << r.id << r.ra << r.dec << r.bMag << r.vMag << r.type << r.mType << r.majorAxisSize << r.minorAxisSize
+		    << r.orientationAngle << r.z << r.zErr << r.plx << r.plxErr << r.dist << r.distErr << r.NGC << r.IC << r.M << r.C
+		    << r.B << r.Sh2 << r.VdB << r.RCW << r.LDN << r.LBN << r.Cr << r.Mel << r.PGC << r.UGC << r.Ced << r.Arp << r.VV << r.PK
+		    << r.PNG << r.SNRG << r.ACO;
+	}
+	data.chop(truncate);
+	QFile file(path);
+	if (!file.open(QIODevice::WriteOnly))
+		return false;
+	// A zlib stream, as gzip accepted by StelUtils::uncompress()
+	file.write(qCompress(data).mid(4));
+	return true;
+}
+
+static QByteArray readAll(const QString& path)
+{
+	QFile file(path);
+	file.open(QIODevice::ReadOnly);
+	return file.readAll();
+}
+
+void TestDsoCatalog::initTestCase()
+{
+	QVERIFY(dir.isValid());
+	for (int id=1; id<=2000; ++id)
+		source << makeRecord(id);
+	// Several records with the same designation: the first one must stay first.
+	DatRecord duplicate = makeRecord(2001);
+	duplicate.NGC = 1;
+	duplicate.M = 1;
+	source << duplicate;
+	source.prepend(makeRecord(2002));
+	QVERIFY(writeDat(path("catalog.dat"), source, CATALOG_VERSION));
+}
+
+void TestDsoCatalog::testRoundTrip()
+{
+	const QString catalogPath = path("roundtrip.cat");
+	QVERIFY(DsoCatalog::importDat(path("catalog.dat"), catalogPath, CATALOG_VERSION));
+	DsoCatalog catalog;
+	QVERIFY(catalog.load(catalogPath));
+	QCOMPARE(catalog.size(), source.size());
+
+	// The records keep the order of catalog.dat.
+	for (int i=0; i<source.size(); ++i)
+	{
+		const DatRecord& s = source.at(i);
+		const DsoCatalog::Record& r = catalog.getRecord(i);
+		QCOMPARE(r.DSO_nb, (quint32)s.id);
+		QCOMPARE(r.ra, s.ra);
+		QCOMPARE(r.dec, s.dec);
+		Vec3d pos;
+		StelUtils::spheToRect(s.ra, s.dec, pos);
+		QCOMPARE(r.pos[0], (float)pos[0]);
+		QCOMPARE(r.pos[1], (float)pos[1]);
+		QCOMPARE(r.pos[2], (float)pos[2]);
+		QCOMPARE(r.bMag, s.bMag);
+		QCOMPARE(r.vMag, s.vMag);
+		QCOMPARE(r.type, s.type);
+		QCOMPARE(catalog.getString(r.mTypeString), s.mType);
+		QCOMPARE(r.majorAxisSize, s.majorAxisSize);
+		QCOMPARE(r.minorAxisSize, s.minorAxisSize);
+		QCOMPARE(r.orientationAngle, s.orientationAngle);
+		QCOMPARE(r.redshift, s.z);
+		QCOMPARE(r.redshiftErr, s.zErr);
+		QCOMPARE(r.parallax, s.plx);
+		QCOMPARE(r.parallaxErr, s.plxErr);
+		QCOMPARE(r.oDistance, s.dist);
+		QCOMPARE(r.oDistanceErr, s.distErr);
+		QCOMPARE(r.NGC_nb, (quint32)s.NGC);
+		QCOMPARE(r.IC_nb, (quint32)s.IC);
+		QCOMPARE(r.M_nb, (quint32)s.M);
+		QCOMPARE(r.Sh2_nb, (quint32)s.Sh2);
+		QCOMPARE(r.PGC_nb, (quint32)s.PGC);
+		QCOMPARE(catalog.getString(r.Ced_nb), s.Ced);
+		QCOMPARE(catalog.getString(r.PK_nb), s.PK);
+		QCOMPARE(catalog.getString(r.PNG_nb), s.PNG);
+		QCOMPARE(catalog.getString(r.SNRG_nb), s.SNRG);
+		QCOMPARE(catalog.getString(r.ACO_nb), s.ACO);
+		QCOMPARE(DsoCatalog::getMagnitude(r), s.vMag>90.f ? s.bMag : s.vMag);
+	}
+	// The first record with NGC 1 and M 1 is the one of catalog.dat
+	int first = -1;
+	for (int i=0; i<catalog.size() && first<0; ++i)
+	{
+		if (catalog.getRecord(i).NGC_nb==1)
+			first = i;
+	}
+	QCOMPARE(catalog.getRecord(first).DSO_nb, 1u);
+	QCOMPARE(catalog.getRecord(catalog.size()-1).DSO_nb, 2001u);
+}
+
+void TestDsoCatalog::testZoneIndex()
+{
+	const QString catalogPath = path("zones.cat");
+	QVERIFY(DsoCatalog::importDat(path("catalog.dat"), catalogPath, CATALOG_VERSION));
+	DsoCatalog catalog;
+	QVERIFY(catalog.load(catalogPath));
+	const int level = catalog.getZoneLevel();
+	QCOMPARE(level, (int)DsoCatalog::ZoneLevel);
+	const StelGeodesicGrid grid(level);
+
+	// Each record is in the list of its zone, once, in the order of the records.
+	QVector<int> seen(catalog.size(), 0);
+	for (int z=0; z<StelGeodesicGrid::nrOfZones(level); ++z)
+	{
+		QVERIFY(catalog.getZoneBegin(z)<=catalog.getZoneEnd(z));
+		int previous = -1;
+		for (int j=catalog.getZoneBegin(z); j<catalog.getZoneEnd(z); ++j)
+		{
+			const int i = catalog.getZoneRecord(j);
+			QVERIFY(i>previous);
+			previous = i;
+			++seen[i];
+			const DsoCatalog::Record& r = catalog.getRecord(i);
+			QCOMPARE(grid.getZoneNumberForPoint(Vec3f(r.pos[0], r.pos[1], r.pos[2]), level), z);
+		}
+	}
+	QCOMPARE(seen, QVector<int>(catalog.size(), 1));
+
+	// The zones around a point contain all the records close to it
+	const Vec3d centers[3] = {Vec3d(1., 0., 0.), Vec3d(0., 0., 1.), Vec3d(-0.3, 0.5, -0.8)};
+	for (int c=0; c<3; ++c)
+	{
+		Vec3d v = centers[c];
+		v.normalize();
+		const double cosLimit = std::cos(10.*M_PI/180.);
+		QVector<SphericalCap> caps;
+		caps.append(SphericalCap(v, cosLimit));
+		const GeodesicSearchResult* result = grid.search(caps, level);
+		QSet<int> found;
+		int zone;
+		for (GeodesicSearchInsideIterator it(*result, level); (zone = it.next()) >= 0;)
+			for (int j=catalog.getZoneBegin(zone); j<catalog.getZoneEnd(zone); ++j)
+				found.insert(catalog.getZoneRecord(j));
+		for (GeodesicSearchBorderIterator it(*result, level); (zone = it.next()) >= 0;)
+			for (int j=catalog.getZoneBegin(zone); j<catalog.getZoneEnd(zone); ++j)
+				found.insert(catalog.getZoneRecord(j));
+		for (int i=0; i<catalog.size(); ++i)
+		{
+			const DsoCatalog::Record& r = catalog.getRecord(i);
+			Vec3d pos(r.pos[0], r.pos[1], r.pos[2]);
+			pos.normalize();
+			if (pos*v>=cosLimit)
+				QVERIFY(found.contains(i));
+		}
+	}
+}
+
+void TestDsoCatalog::testIsImportOf()
+{
+	const QString datPath = path("changing.dat");
+	const QString catalogPath = path("changing.cat");
+	QVERIFY(writeDat(datPath, source, CATALOG_VERSION));
+	QVERIFY(DsoCatalog::importDat(datPath, catalogPath, CATALOG_VERSION));
+	DsoCatalog catalog;
+	QVERIFY(catalog.load(catalogPath));
+	QVERIFY(catalog.isImportOf(datPath, CATALOG_VERSION));
+	QVERIFY(!catalog.isImportOf(datPath, "3.3"));
+	QVERIFY(!catalog.isImportOf(path("catalog.dat.missing"), CATALOG_VERSION));
+
+	// A source with another size
+	QVERIFY(writeDat(datPath, source.mid(0, 100), CATALOG_VERSION));
+	QVERIFY(!catalog.isImportOf(datPath, CATALOG_VERSION));
+	catalog.clear();
+	QVERIFY(!catalog.isImportOf(datPath, CATALOG_VERSION));
+}
+
+void TestDsoCatalog::testFailedImport()
+{
+	const QString catalogPath = path("kept.cat");
+	QVERIFY(DsoCatalog::importDat(path("catalog.dat"), catalogPath, CATALOG_VERSION));
+	const QByteArray before = readAll(catalogPath);
+	QVERIFY(!before.isEmpty());
+
+	// Another version of catalog.dat
+	QVERIFY(writeDat(path("other.dat"), source, "3.1"));
+	QVERIFY(!DsoCatalog::importDat(path("other.dat"), catalogPath, CATALOG_VERSION));
+	QCOMPARE(readAll(catalogPath), before);
+
+	// A truncated catalog.dat
+	QVERIFY(writeDat(path("truncated.dat"), source, CATALOG_VERSION, 10));
+	QVERIFY(!DsoCatalog::importDat(path("truncated.dat"), catalogPath, CATALOG_VERSION));
+	QCOMPARE(readAll(catalogPath), before);
+
+	// A file which is not a catalogue
+	QFile garbage(path("garbage.cat"));
+	QVERIFY(garbage.open(QIODevice::WriteOnly));
+	garbage.write(QByteArray(200, 'x'));
+	garbage.close();
+	DsoCatalog catalog;
+	QVERIFY(!catalog.load(path("garbage.cat")));
+	QVERIFY(!catalog.isLoaded());
+	QVERIFY(catalog.load(catalogPath));
+}
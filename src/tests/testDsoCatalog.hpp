@@ -0,0 +1,62 @@
+/*
+ * Stellarium
+ * Copyright (C) 2017 Stellarium Developers
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Suite 500, Boston, MA  02110-1335, USA.
+ */
+
+#ifndef _TESTDSOCATALOG_HPP_
+#define _TESTDSOCATALOG_HPP_
+
+#include <QObject>
+#include <QTemporaryDir>
+#include <QtTest>
+#include <QVector>
+
+//! Import generated catalog.dat files into DsoCatalog files and read them back.
+class TestDsoCatalog : public QObject
+{
+	Q_OBJECT
+public:
+	//! A record of catalog.dat, as written by NebulaMgr::convertDSOCatalog()
+	struct DatRecord
+	{
+		int id;
+		float ra, dec, bMag, vMag;
+		unsigned int type;
+		QString mType;
+		float majorAxisSize, minorAxisSize;
+		int orientationAngle;
+		float z, zErr, plx, plxErr, dist, distErr;
+		int NGC, IC, M, C, B, Sh2, VdB, RCW, LDN, LBN, Cr, Mel, PGC, UGC;
+		QString Ced;
+		int Arp, VV;
+		QString PK, PNG, SNRG, ACO;
+	};
+
+private slots:
+	void initTestCase();
+	void testRoundTrip();
+	void testZoneIndex();
+	void testIsImportOf();
+	void testFailedImport();
+private:
+	QString path(const QString& name) const { return dir.path()+"/"+name; }
+
+	QTemporaryDir dir;
+	QVector<DatRecord> source;
+};
+
+#endif // _TESTDSOCATALOG_HPP_
@@ -20,6 +20,7 @@
 #include "tests/testEphemeris.hpp"
 
 #include <QDebug>
+#include <QFile>
 #include <QVariantList>
 #include <QString>
 #include <QtGlobal>
@@ -27,8 +28,12 @@
 #include "StelFileMgr.hpp"
 #include "EphemWrapper.hpp"
 #include "vsop87.h"
+#include "elp82b.h"
 #include "de430.hpp"
 #include "de431.hpp"
+#include "jpleph.h"
+
+#include <cstring>
 
 QTEST_GUILESS_MAIN(TestEphemeris)
 
@@ -1764,3 +1769,204 @@ void TestEphemeris::testNeptuneHeliocentricEphemerisDe431()
 		}
 	}
 }
+
+QVector<double> TestEphemeris::contextEpochs()
+{
+	QVector<double> epochs;
+	for (int i=0; i<1000; ++i)
+		epochs.append(2451545.0 - 18262.5 + (i/10)*365.3 + (i%10)*0.0173);
+	return epochs;
+}
+
+static QString xyzDifference(const double* expected, const double* actual, const double jd, const int body)
+{
+	return QString("jd=%1 body=%2: %3 %4 %5 instead of %6 %7 %8")
+			.arg(jd, 0, 'f', 6).arg(body)
+			.arg(actual[0], 0, 'g', 17).arg(actual[1], 0, 'g', 17).arg(actual[2], 0, 'g', 17)
+			.arg(expected[0], 0, 'g', 17).arg(expected[1], 0, 'g', 17).arg(expected[2], 0, 'g', 17);
+}
+
+void TestEphemeris::testVsop87ContextSameAsGlobal()
+{
+	struct Vsop87Context ctx;
+	InitVsop87Context(&ctx);
+	foreach (const double jd, contextEpochs())
+	{
+		for (int body=0; body<8; ++body)
+		{
+			double expected[3], actual[3];
+			GetVsop87Coor(jd, body, expected);
+			GetVsop87CoorCtx(&ctx, jd, body, actual);
+			QVERIFY2(memcmp(expected, actual, sizeof(expected))==0, qPrintable(xyzDifference(expected, actual, jd, body)));
+			GetVsop87OsculatingCoor(jd, jd+100., body, expected);
+			GetVsop87OsculatingCoorCtx(&ctx, jd, jd+100., body, actual);
+			QVERIFY2(memcmp(expected, actual, sizeof(expected))==0, qPrintable("osculating, " + xyzDifference(expected, actual, jd, body)));
+		}
+	}
+}
+
+void TestEphemeris::testElp82bContextSameAsGlobal()
+{
+	struct Elp82bContext ctx;
+	InitElp82bContext(&ctx);
+	foreach (const double jd, contextEpochs())
+	{
+		double expected[3], actual[3];
+		GetElp82bCoor(jd, expected);
+		GetElp82bCoorCtx(&ctx, jd, actual);
+		QVERIFY2(memcmp(expected, actual, sizeof(expected))==0, qPrintable(xyzDifference(expected, actual, jd, 10)));
+	}
+}
+
+void TestEphemeris::testDe430ContextSameAsGlobal()
+{
+	if (de430FilePath.isEmpty())
+		QSKIP("DE430 ephemeris file not found");
+	InitDE430(QFile::encodeName(de430FilePath).constData());
+	void* ctx = CreateDe430Context(EphemContext::DE_CACHE_SLOTS);
+	QVERIFY(ctx);
+	foreach (const double jd, contextEpochs())
+	{
+		// The planets, Pluto and the Moon relative to the Sun, and the Moon relative to the Earth
+		for (int target=1; target<=11; ++target)
+		{
+			const int center = (target==11) ? 3 : CENTRAL_BODY_ID;
+			const int body = (target==11) ? 10 : target;
+			double expected[3], actual[3];
+			QVERIFY(GetDe430Coor(jd, body, expected, center));
+			QVERIFY(GetDe430CoorCtx(ctx, jd, body, actual, center));
+			QVERIFY2(memcmp(expected, actual, sizeof(expected))==0, qPrintable(xyzDifference(expected, actual, jd, body)));
+		}
+	}
+	FreeDe430Context(ctx);
+}
+
+void TestEphemeris::testDe431ContextSameAsGlobal()
+{
+	if (de431FilePath.isEmpty())
+		QSKIP("DE431 ephemeris file not found");
+	InitDE431(QFile::encodeName(de431FilePath).constData());
+	void* ctx = CreateDe431Context(EphemContext::DE_CACHE_SLOTS);
+	QVERIFY(ctx);
+	foreach (const double jd, contextEpochs())
+	{
+		for (int target=1; target<=11; ++target)
+		{
+			const int center = (target==11) ? 3 : CENTRAL_BODY_ID;
+			const int body = (target==11) ? 10 : target;
+			double expected[3], actual[3];
+			QVERIFY(GetDe431Coor(jd, body, expected, center));
+			QVERIFY(GetDe431CoorCtx(ctx, jd, body, actual, center));
+			QVERIFY2(memcmp(expected, actual, sizeof(expected))==0, qPrintable(xyzDifference(expected, actual, jd, body)));
+		}
+	}
+	FreeDe431Context(ctx);
+}
+
+void* TestEphemeris::openDe430(bool mapped) const
+{
+	void* ephem = jpl_init_ephemeris(QFile::encodeName(de430FilePath).constData(), Q_NULLPTR, Q_NULLPTR);
+	if (!ephem)
+		return Q_NULLPTR;
+	if (!jpl_is_mapped(ephem))
+	{
+		// Mapping failed, e.g. no address space left, so there is nothing to compare
+		jpl_close_ephemeris(ephem);
+		return Q_NULLPTR;
+	}
+	if (!mapped)
+		jpl_unmap_ephemeris(ephem);
+	return ephem;
+}
+
+QVector<double> TestEphemeris::randomEpochs(const void* ephem, int count)
+{
+	const double start = jpl_get_double(ephem, JPL_EPHEM_START_JD);
+	const double end = jpl_get_double(ephem, JPL_EPHEM_END_JD);
+	QVector<double> epochs;
+	qsrand(430);
+	for (int i=0; i<count; ++i)
+		epochs.append(start + (end-start)*qrand()/(RAND_MAX+1.));
+	return epochs;
+}
+
+void TestEphemeris::testDe430MappedSameAsFileAccess()
+{
+	if (de430FilePath.isEmpty())
+		QSKIP("DE430 ephemeris file not found");
+	void* mapped = openDe430(true);
+	void* file = openDe430(false);
+	if (!mapped || !file)
+	{
+		if (mapped) jpl_close_ephemeris(mapped);
+		if (file) jpl_close_ephemeris(file);
+		QSKIP("DE430 ephemeris file cannot be memory-mapped");
+	}
+	void* mappedContext = jpl_init_context(mapped, 4);
+	void* fileContext = jpl_init_context(file, 4);
+
+	// Both the cache of the ephemeris and the one of a context, with all bodies
+	// relative to the solar system barycenter
+	const QVector<double> epochs = randomEpochs(mapped, 2000);
+	foreach (const double et, epochs)
+	{
+		for (int target=1; target<=11; ++target)
+		{
+			double expected[6], actual[6];
+			QCOMPARE(jpl_pleph(file, et, target, 12, expected, 1), 0);
+			QCOMPARE(jpl_pleph(mapped, et, target, 12, actual, 1), 0);
+			QVERIFY2(memcmp(expected, actual, sizeof(expected))==0, qPrintable(QString("et=%1 target=%2").arg(et, 0, 'f', 6).arg(target)));
+			QCOMPARE(jpl_pleph_ctx(fileContext, et, target, 12, expected, 1), 0);
+			QCOMPARE(jpl_pleph_ctx(mappedContext, et, target, 12, actual, 1), 0);
+			QVERIFY2(memcmp(expected, actual, sizeof(expected))==0, qPrintable(QString("context, et=%1 target=%2").arg(et, 0, 'f', 6).arg(target)));
+		}
+	}
+
+	jpl_free_context(mappedContext);
+	jpl_free_context(fileContext);
+	jpl_close_ephemeris(mapped);
+	jpl_close_ephemeris(file);
+}
+
+void TestEphemeris::benchmarkDe430RandomEpochs_data()
+{
+	QTest::addColumn<bool>("mapped");
+	QTest::addColumn<bool>("context");
+	QTest::newRow("context, mapped") << true << true;
+	QTest::newRow("context, file access") << false << true;
+	// The reader as it was before the contexts and the memory map
+	QTest::newRow("jpl_pleph, file access") << false << false;
+}
+
+void TestEphemeris::benchmarkDe430RandomEpochs()
+{
+	QFETCH(bool, mapped);
+	QFETCH(bool, context);
+	if (de430FilePath.isEmpty())
+		QSKIP("DE430 ephemeris file not found");
+	void* ephem = openDe430(mapped);
+	if (!ephem)
+		QSKIP("DE430 ephemeris file cannot be memory-mapped");
+	// A small cache, so that most epochs need another record as in a time search
+	void* ctx = jpl_init_context(ephem, 2);
+	const QVector<double> epochs = randomEpochs(ephem, 1000);
+
+	double rrd[6];
+	if (context)
+	{
+		QBENCHMARK {
+			foreach (const double et, epochs)
+				jpl_pleph_ctx(ctx, et, 3, 12, rrd, 1);
+		}
+	}
+	else
+	{
+		QBENCHMARK {
+			foreach (const double et, epochs)
+				jpl_pleph(ephem, et, 3, 12, rrd, 1);
+		}
+	}
+
+	jpl_free_context(ctx);
+	jpl_close_ephemeris(ephem);
+}
@@ -22,6 +22,7 @@
 
 #include <QObject>
 #include <QTest>
+#include <QVector>
 
 class TestEphemeris : public QObject
 {
@@ -53,8 +54,25 @@ private slots:
 	void testSaturnHeliocentricEphemerisDe431();
 	void testUranusHeliocentricEphemerisDe431();
 	void testNeptuneHeliocentricEphemerisDe431();
+	// Reentrant contexts give the same results as the global caches
+	void testVsop87ContextSameAsGlobal();
+	void testElp82bContextSameAsGlobal();
+	void testDe430ContextSameAsGlobal();
+	void testDe431ContextSameAsGlobal();
+	// JPL reader with and without memory mapping
+	void testDe430MappedSameAsFileAccess();
+	void benchmarkDe430RandomEpochs_data();
+	void benchmarkDe430RandomEpochs();
 
 private:
+	//! Open the DE430 file, memory-mapped or not. Return Q_NULLPTR if not possible.
+	void* openDe430(bool mapped) const;
+	//! Random epochs within the range of an ephemeris, the same for each call.
+	static QVector<double> randomEpochs(const void* ephem, int count);
+	//! Epochs for the comparison of contexts and global caches: short steps within the
+	//! interpolation intervals of VSOP87 and ELP82B, and long jumps, within the range of DE430.
+	static QVector<double> contextEpochs();
+
 	QString de430FilePath, de431FilePath;
 	QVariantList mercury, venus, mars, jupiter, saturn, uranus, neptune;
 
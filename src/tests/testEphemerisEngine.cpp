@@ -0,0 +1,131 @@
+/*
+ * Stellarium
+ * Copyright (C) 2017 Stellarium Developers
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Suite 500, Boston, MA  02110-1335, USA.
+ */
+
+#include "tests/testEphemerisEngine.hpp"
+
+#include "EphemerisEngine.hpp"
+#include "SolarSystem.hpp"
+#include "StelApp.hpp"
+#include "StelCore.hpp"
+#include "StelFileMgr.hpp"
+#include "StelIniParser.hpp"
+#include "StelLocation.hpp"
+#include "StelMainView.hpp"
+#include "StelModuleMgr.hpp"
+#include "StelTranslator.hpp"
+#include "StelUtils.hpp"
+
+#include <QSettings>
+#include <QSignalSpy>
+
+QTEST_MAIN(TestEphemerisEngine)
+
+// With light time, the scene leaves the Earth at the date of the Moon (about 1.3 s earlier),
+// which moves the planets and the Sun by up to 0.3 arcsec. The engine does not copy this.
+static const double ANGLE_TOLERANCE = 1./3600.*M_PI/180.;
+static const double DISTANCE_TOLERANCE = 1e-5;
+
+void TestEphemerisEngine::initTestCase()
+{
+	conf = Q_NULLPTR;
+	mainView = Q_NULLPTR;
+	QVERIFY(userDir.isValid());
+	StelFileMgr::init();
+	StelFileMgr::setUserDir(userDir.path());
+
+	conf = new QSettings(userDir.path() + "/config.ini", StelIniFormat);
+	conf->setValue("main/check_requirements", false);
+	conf->setValue("video/fullscreen", false);
+	conf->setValue("video/screen_w", 320);
+	conf->setValue("video/screen_h", 240);
+	StelTranslator::init(StelFileMgr::getInstallationDir() + "/data/iso639-1.utf8");
+
+	mainView = new StelMainView(conf);
+	QSignalSpy drawn(mainView, SIGNAL(drawEnded()));
+	mainView->show();
+	// StelApp is initialized with the OpenGL context, before the first frame is drawn.
+	if (drawn.isEmpty() && !drawn.wait(120000))
+		QSKIP("Stellarium could not be started, an OpenGL context is required");
+}
+
+void TestEphemerisEngine::cleanupTestCase()
+{
+	if (mainView)
+	{
+		mainView->deinit();
+		delete mainView;
+	}
+	delete conf;
+}
+
+void TestEphemerisEngine::testSameAsCoreUpdate_data()
+{
+	QTest::addColumn<QString>("body");
+	QTest::addColumn<bool>("lightTime");
+	QTest::addColumn<bool>("topocentric");
+
+	foreach (const QString& body, QStringList() << "Moon" << "Mars" << "Venus" << "Sun")
+	{
+		QTest::newRow(qPrintable(body + " geocentric")) << body << false << false;
+		QTest::newRow(qPrintable(body + " topocentric")) << body << false << true;
+		QTest::newRow(qPrintable(body + " topocentric light time")) << body << true << true;
+	}
+}
+
+void TestEphemerisEngine::testSameAsCoreUpdate()
+{
+	QFETCH(QString, body);
+	QFETCH(bool, lightTime);
+	QFETCH(bool, topocentric);
+
+	StelCore* core = StelApp::getInstance().getCore();
+	SolarSystem* ssystem = GETSTELMODULE(SolarSystem);
+	PlanetP planet = ssystem->searchByEnglishName(body);
+	QVERIFY(planet);
+
+	StelLocation location;
+	location.name = "Test";
+	location.planetName = "Earth";
+	location.latitude = 52.5f;
+	location.longitude = 13.4f;
+	location.altitude = 1000;
+	core->moveObserverTo(location, 0., 0.);
+	core->setTimeRate(0.);
+	core->setUseTopocentricCoordinates(topocentric);
+	ssystem->setFlagLightTravelTime(lightTime);
+
+	const EphemerisEngine engine(QList<PlanetP>() << planet, core->getCurrentPlanet());
+	QCOMPARE(engine.getFlagLightTravelTime(), lightTime);
+
+	// About 10 years, at all times of the day
+	for (int i=0; i<50; ++i)
+	{
+		core->setJD(2451545.0 + i*73.37);
+		core->update(0.);
+		const Vec3d expected = planet->getJ2000EquatorialPos(core);
+		const Vec3d actual = engine.computeJ2000EquatorialPos(0, core->getJD(), core->getJDE());
+		const QString where = QString("JD %1: angle %2 arcsec, distance %3 AU instead of %4 AU")
+				.arg(core->getJD(), 0, 'f', 5)
+				.arg(actual.angle(expected)*180./M_PI*3600.)
+				.arg(actual.length(), 0, 'g', 12)
+				.arg(expected.length(), 0, 'g', 12);
+		QVERIFY2(actual.angle(expected) < ANGLE_TOLERANCE, qPrintable(where));
+		QVERIFY2(fabs(actual.length()/expected.length()-1.) < DISTANCE_TOLERANCE, qPrintable(where));
+	}
+}
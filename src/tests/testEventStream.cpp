@@ -0,0 +1,119 @@
+/*
+ * Stellarium
+ * Copyright (C) 2017 Stellarium Developers
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Suite 500, Boston, MA  02110-1335, USA.
+ */
+
+#include <QObject>
+#include <QtDebug>
+#include <QtTest>
+#include <QElapsedTimer>
+#include <QTcpServer>
+#include <QTcpSocket>
+
+#include "tests/testEventStream.hpp"
+#include "EventQueue.hpp"
+#include "httpresponse.h"
+
+QTEST_GUILESS_MAIN(TestEventStream)
+
+static QByteArray createEvent(int i)
+{
+	return QByteArray("data: ")+QByteArray::number(i)+"\n\n";
+}
+
+void TestEventStream::testQueueBounding()
+{
+	EventQueue queue(8);
+	QVERIFY(!queue.hasChanges());
+	for (int i=0; i<8; ++i)
+		queue.enqueue(createEvent(i));
+	QCOMPARE(queue.size(), 8);
+	QCOMPARE(queue.getDropped(), 0);
+
+	// A slow client never holds more than maxSize events
+	for (int i=8; i<1000; ++i)
+	{
+		queue.enqueue(createEvent(i));
+		QCOMPARE(queue.size(), 8);
+	}
+	QCOMPARE(queue.getDropped(), 1000-8);
+	QVERIFY(queue.hasChanges());
+}
+
+void TestEventStream::testDropOldest()
+{
+	EventQueue queue(4);
+	for (int i=0; i<10; ++i)
+		queue.enqueue(createEvent(i));
+	QCOMPARE(queue.getDropped(), 6);
+
+	// The newest events are kept, the oldest first
+	QList<QByteArray> events;
+	queue.takeAll(events);
+	QCOMPARE(events.size(), 4);
+	for (int i=0; i<4; ++i)
+		QCOMPARE(events.at(i), createEvent(6+i));
+	QCOMPARE(queue.size(), 0);
+
+	// The dropped events are remembered until the client gets the state
+	QCOMPARE(queue.getDropped(), 6);
+	QVERIFY(queue.hasChanges());
+}
+
+void TestEventStream::testClear()
+{
+	EventQueue queue(4);
+	for (int i=0; i<6; ++i)
+		queue.enqueue(createEvent(i));
+	queue.clear();
+	QCOMPARE(queue.size(), 0);
+	QCOMPARE(queue.getDropped(), 0);
+	QVERIFY(!queue.hasChanges());
+
+	// The queue is usable again after the state was sent
+	queue.enqueue(createEvent(6));
+	QList<QByteArray> events;
+	queue.takeAll(events);
+	QCOMPARE(events, QList<QByteArray>() << createEvent(6));
+	QCOMPARE(queue.getDropped(), 0);
+}
+
+void TestEventStream::testWriteTimeout()
+{
+	QTcpServer server;
+	QVERIFY(server.listen(QHostAddress::LocalHost));
+	QTcpSocket client;
+	client.connectToHost(QHostAddress::LocalHost, server.serverPort());
+	QVERIFY(server.waitForNewConnection(5000));
+	QTcpSocket* socket = server.nextPendingConnection();
+	QVERIFY(socket);
+	QVERIFY(client.waitForConnected(5000));
+
+	// The client never reads, so the send and receive buffers fill up
+	HttpResponse response(socket);
+	response.setWriteTimeout(200);
+	response.setHeader("Content-Type","text/event-stream; charset=utf-8");
+	const QByteArray chunk(65536, 'x');
+	QElapsedTimer timer;
+	timer.start();
+	for (int i=0; i<4096 && response.isConnected(); ++i)
+		response.write(chunk);
+
+	// The blocked write gave up and disconnected the client, instead of waiting forever
+	QVERIFY(!response.isConnected());
+	QVERIFY(timer.elapsed()<10000);
+}
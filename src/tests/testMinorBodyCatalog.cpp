@@ -0,0 +1,366 @@
+/*
+ * Stellarium
+ * Copyright (C) 2017 Stellarium Developers
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Suite 500, Boston, MA  02110-1335, USA.
+ */
+
+#include "tests/testMinorBodyCatalog.hpp"
+
+#include "MinorBodyCatalog.hpp"
+#include "SolarSystem.hpp"
+#include "StelApp.hpp"
+#include "StelCore.hpp"
+#include "StelFileMgr.hpp"
+#include "StelIniParser.hpp"
+#include "StelMainView.hpp"
+#include "StelModuleMgr.hpp"
+#include "StelTranslator.hpp"
+#include "StelUtils.hpp"
+
+#include <QDir>
+#include <QFile>
+#include <QSettings>
+#include <QSignalSpy>
+#include <QTextStream>
+
+#include <cmath>
+#include <cstring>
+
+QTEST_MAIN(TestMinorBodyCatalog)
+
+static bool writeText(const QString& path, const QString& text)
+{
+	QFile file(path);
+	if (!file.open(QIODevice::WriteOnly | QIODevice::Text))
+		return false;
+	QTextStream(&file) << text;
+	return true;
+}
+
+static QByteArray readAll(const QString& path)
+{
+	QFile file(path);
+	file.open(QIODevice::ReadOnly);
+	return file.readAll();
+}
+
+static bool writeAll(const QString& path, const QByteArray& data)
+{
+	QFile file(path);
+	return file.open(QIODevice::WriteOnly) && file.write(data)==data.size();
+}
+
+// A line of MPCORB.DAT, see https://www.minorplanetcenter.net/iau/info/MPOrbitFormat.html
+static QString mpcorbLine(const QString& readable, double h, const QString& epoch, double meanAnomaly, double argOfPericenter,
+			  double ascendingNode, double inclination, double eccentricity, double meanMotion, double semiMajorAxis)
+{
+	QString line(202, ' ');
+	line.replace(0, 7, "0000001");
+	line.replace(8, 5, QString("%1").arg(h, 5, 'f', 2));
+	line.replace(14, 5, QString("%1").arg(0.12, 5, 'f', 2));
+	line.replace(20, 5, epoch);
+	line.replace(26, 9, QString("%1").arg(meanAnomaly, 9, 'f', 5));
+	line.replace(37, 9, QString("%1").arg(argOfPericenter, 9, 'f', 5));
+	line.replace(48, 9, QString("%1").arg(ascendingNode, 9, 'f', 5));
+	line.replace(59, 9, QString("%1").arg(inclination, 9, 'f', 5));
+	line.replace(70, 9, QString("%1").arg(eccentricity, 9, 'f', 7));
+	line.replace(80, 11, QString("%1").arg(meanMotion, 11, 'f', 8));
+	line.replace(92, 11, QString("%1").arg(semiMajorAxis, 11, 'f', 7));
+	line.replace(166, readable.length(), readable);
+	return line;
+}
+
+void TestMinorBodyCatalog::initTestCase()
+{
+	QVERIFY(dir.isValid());
+	StelFileMgr::init();
+}
+
+void TestMinorBodyCatalog::testImportShippedIni()
+{
+	const QString iniPath = StelFileMgr::findFile("data/ssystem_minor.ini", StelFileMgr::File);
+	if (iniPath.isEmpty())
+		QSKIP("data/ssystem_minor.ini not found");
+
+	QVERIFY(MinorBodyCatalog::importIni(iniPath, path("shipped.cat")));
+	MinorBodyCatalog catalog;
+	QVERIFY(catalog.load(path("shipped.cat")));
+
+	// Every section is stored, whatever its type
+	QSettings pd(iniPath, StelIniFormat);
+	const QStringList sections = pd.childGroups();
+	QCOMPARE(catalog.size(), sections.size());
+	foreach (const QString& secname, sections)
+	{
+		const QString name = pd.value(secname+"/name").toString().simplified();
+		const int index = catalog.findByEnglishName(name);
+		QVERIFY2(index>=0, qPrintable(name));
+		QCOMPARE(MinorBodyCatalog::getTypeString(catalog.getElements(index).type), pd.value(secname+"/type").toString());
+	}
+
+	const int sedna = catalog.findByEnglishName("Sedna");
+	QVERIFY(sedna>=0);
+	const MinorBodyCatalog::Elements& e = catalog.getElements(sedna);
+	const MinorBodyCatalog::Details& d = catalog.getDetails(sedna);
+	QCOMPARE(int(e.type), int(MinorBodyCatalog::Sednoid));
+	QCOMPARE(d.minorPlanetNumber, 90377);
+	QCOMPARE(e.flags & (MinorBodyCatalog::Halo|MinorBodyCatalog::Atmosphere), int(MinorBodyCatalog::Halo));
+	QCOMPARE(catalog.getString(d.normalsMap), QString("sedna_normals.png"));
+}
+
+void TestMinorBodyCatalog::testPlanetTypes()
+{
+	const QString body("coord_func=comet_orbit\n"
+			   "orbit_PericenterDistance=2.5\n"
+			   "orbit_Eccentricity=0.1\n"
+			   "orbit_TimeAtPericenter=2451545.0\n"
+			   "radius=100\n");
+	QVERIFY(writeText(path("types.ini"),
+			  "[one]\nname=One\ntype=planet\nhalo=false\natmosphere=true\nnormals_map=one.png\n" + body +
+			  "[two]\nname=Two\ntype=asteroid\nhalo=false\n" + body +
+			  "[three]\nname=Three\ntype=spaceship\nhidden=true\n" + body));
+	QVERIFY(MinorBodyCatalog::importIni(path("types.ini"), path("types.cat")));
+	MinorBodyCatalog catalog;
+	QVERIFY(catalog.load(path("types.cat")));
+	QCOMPARE(catalog.size(), 3);
+
+	const int one = catalog.findByEnglishName("One");
+	QCOMPARE(int(catalog.getElements(one).type), int(MinorBodyCatalog::MajorPlanet));
+	QCOMPARE(catalog.getElements(one).flags & (MinorBodyCatalog::Halo|MinorBodyCatalog::Atmosphere), int(MinorBodyCatalog::Atmosphere));
+	QCOMPARE(catalog.getString(catalog.getDetails(one).normalsMap), QString("one.png"));
+
+	// MinorPlanet objects have no normal map
+	const int two = catalog.findByEnglishName("Two");
+	QVERIFY(MinorBodyCatalog::isMinorPlanetType(catalog.getElements(two).type));
+	QCOMPARE(catalog.getString(catalog.getDetails(two).normalsMap), QString());
+
+	// Unknown types are kept as UNDEFINED, hidden bodies have no default normal map
+	const int three = catalog.findByEnglishName("Three");
+	QCOMPARE(int(catalog.getElements(three).type), int(MinorBodyCatalog::Undefined));
+	QCOMPARE(MinorBodyCatalog::getTypeString(catalog.getElements(three).type), QString("UNDEFINED"));
+	QVERIFY(catalog.getElements(three).flags & MinorBodyCatalog::Hidden);
+	QCOMPARE(catalog.getString(catalog.getDetails(three).normalsMap), QString());
+}
+
+void TestMinorBodyCatalog::testIniRoundTrip()
+{
+	// One body of each orbit function: ell_orbit gives distances in km, comet_orbit in AU.
+	QVERIFY(writeText(path("roundtrip.ini"),
+			  "[elliptic]\nname=Elliptic\ntype=asteroid\ncoord_func=ell_orbit\n"
+			  "orbit_SemiMajorAxis=448793619\norbit_Eccentricity=0.2\norbit_Inclination=10\n"
+			  "orbit_AscendingNode=80\norbit_ArgOfPericenter=70\norbit_MeanAnomaly=0\norbit_Epoch=2451545.0\n"
+			  "absolute_magnitude=5.5\nslope_parameter=0.2\nminor_planet_number=1234\nradius=100\nhidden=true\n"
+			  "[parabolic]\nname=C/2000 A1 (Parabolic)\ntype=comet\ncoord_func=comet_orbit\n"
+			  "orbit_PericenterDistance=1.5\norbit_Eccentricity=1\norbit_Inclination=120\n"
+			  "orbit_AscendingNode=30\norbit_ArgOfPericenter=40\norbit_TimeAtPericenter=2451600.5\n"
+			  "absolute_magnitude=8\nslope_parameter=3\nradius=5\n"));
+	QVERIFY(MinorBodyCatalog::importIni(path("roundtrip.ini"), path("roundtrip.cat")));
+	// The import is deterministic
+	QVERIFY(MinorBodyCatalog::importIni(path("roundtrip.ini"), path("roundtrip2.cat")));
+	QCOMPARE(readAll(path("roundtrip.cat")), readAll(path("roundtrip2.cat")));
+
+	MinorBodyCatalog catalog;
+	QVERIFY(catalog.load(path("roundtrip.cat")));
+	QCOMPARE(catalog.size(), 2);
+
+	const int elliptic = catalog.findByEnglishName("ELLIPTIC");
+	QVERIFY(elliptic>=0);
+	const MinorBodyCatalog::Elements& e = catalog.getElements(elliptic);
+	const MinorBodyCatalog::Details& d = catalog.getDetails(elliptic);
+	QCOMPARE(int(e.type), int(MinorBodyCatalog::Asteroid));
+	QCOMPARE(e.flags & (MinorBodyCatalog::Hidden|MinorBodyCatalog::CloseOrbit|MinorBodyCatalog::EllipticOrbit),
+		 MinorBodyCatalog::Hidden|MinorBodyCatalog::CloseOrbit|MinorBodyCatalog::EllipticOrbit);
+	QVERIFY(qAbs(e.pericenterDistance - 448793619./AU*0.8)<1e-12);
+	QCOMPARE(e.eccentricity, 0.2);
+	QVERIFY(qAbs(e.inclination - 10.*M_PI/180.)<1e-15);
+	QCOMPARE(e.absoluteMagnitude, 5.5f);
+	QCOMPARE(e.slopeParameter, 0.2f);
+	QCOMPARE(d.minorPlanetNumber, 1234);
+	QCOMPARE(d.radius, 100.f);
+	// Mean anomaly 0 at the epoch: the body is at its pericenter.
+	QVERIFY(qAbs(e.timeAtPericenter - 2451545.0)<1e-9);
+	QVERIFY(qAbs(catalog.computeHeliocentricPos(elliptic, 2451545.0).length() - e.pericenterDistance)<1e-9);
+
+	const int parabolic = catalog.findByEnglishName("C/2000 A1 (Parabolic)");
+	QVERIFY(parabolic>=0);
+	QCOMPARE(int(catalog.getElements(parabolic).type), int(MinorBodyCatalog::Comet));
+	QCOMPARE(catalog.getElements(parabolic).flags & MinorBodyCatalog::CloseOrbit, 0);
+	QCOMPARE(catalog.getElements(parabolic).slopeParameter, 3.f);
+	QVERIFY(qAbs(catalog.computeHeliocentricPos(parabolic, 2451600.5).length() - 1.5)<1e-9);
+
+	QCOMPARE(catalog.findByPrefix("c/2000", 10), QVector<int>() << parabolic);
+	QCOMPARE(catalog.findByEnglishName("Ellipti"), -1);
+}
+
+void TestMinorBodyCatalog::testMpcorbRoundTrip()
+{
+	QStringList lines;
+	lines << "MINOR PLANET CENTER ORBIT DATABASE (MPCORB)"
+	      << "----------------------------------------------------------------------------------------------------------------"
+	      << mpcorbLine("(1) Ceres", 3.34, "K194R", 162.68631, 73.73161, 80.26859, 10.58862, 0.0775571, 0.21406009, 2.7676569)
+	      << mpcorbLine("2019 AB", 18.5, "K194R", 10., 20., 30., 5., 0.3, 0.25, 2.5)
+	      // Hyperbolic orbits are not valid in MPCORB.DAT
+	      << mpcorbLine("2019 AC", 18.5, "K194R", 10., 20., 30., 5., 1.5, 0.25, 2.5);
+	QVERIFY(writeText(path("MPCORB.DAT"), lines.join("\n")+"\n"));
+	QVERIFY(MinorBodyCatalog::importMpcorb(path("MPCORB.DAT"), path("mpcorb.cat")));
+
+	MinorBodyCatalog catalog;
+	QVERIFY(catalog.load(path("mpcorb.cat")));
+	QCOMPARE(catalog.size(), 2);
+
+	const int ceres = catalog.findByEnglishName("Ceres");
+	QVERIFY(ceres>=0);
+	const MinorBodyCatalog::Elements& e = catalog.getElements(ceres);
+	const MinorBodyCatalog::Details& d = catalog.getDetails(ceres);
+	QCOMPARE(int(e.type), int(MinorBodyCatalog::Asteroid));
+	QCOMPARE(d.minorPlanetNumber, 1);
+	QCOMPARE(catalog.getString(d.provisionalDesignation), QString());
+	QCOMPARE(e.absoluteMagnitude, 3.34f);
+	QCOMPARE(e.slopeParameter, 0.12f);
+	QCOMPARE(e.eccentricity, 0.0775571);
+	QVERIFY(qAbs(e.pericenterDistance - 2.7676569*(1.-0.0775571))<1e-12);
+	QVERIFY(qAbs(e.argOfPericenter - 73.73161*M_PI/180.)<1e-12);
+	QVERIFY(qAbs(e.ascendingNode - 80.26859*M_PI/180.)<1e-12);
+	QVERIFY(qAbs(e.inclination - 10.58862*M_PI/180.)<1e-12);
+	QVERIFY(qAbs(e.meanMotion - 0.21406009*M_PI/180.)<1e-12);
+	// K194R is 2019-04-27.0 TT
+	QVERIFY(qAbs(e.timeAtPericenter - (2458600.5 - 162.68631/0.21406009))<1e-6);
+
+	const int unnumbered = catalog.findByEnglishName("2019 AB");
+	QVERIFY(unnumbered>=0);
+	QCOMPARE(catalog.getDetails(unnumbered).minorPlanetNumber, 0);
+	QCOMPARE(catalog.getString(catalog.getDetails(unnumbered).provisionalDesignation), QString("2019 AB"));
+	QCOMPARE(catalog.findByEnglishName("2019 AC"), -1);
+
+	// A file without valid orbits is not imported
+	QVERIFY(writeText(path("invalid.dat"), lines.at(4)+"\n"));
+	QVERIFY(!MinorBodyCatalog::importMpcorb(path("invalid.dat"), path("invalid.cat")));
+	QVERIFY(!QFile::exists(path("invalid.cat")));
+}
+
+void TestMinorBodyCatalog::testRejectInvalid_data()
+{
+	QVERIFY(writeText(path("valid.ini"),
+			  "[one]\nname=One\ntype=asteroid\ncoord_func=comet_orbit\norbit_PericenterDistance=2.5\n"
+			  "orbit_Eccentricity=0.1\norbit_TimeAtPericenter=2451545.0\n"
+			  "[two]\nname=Two\ntype=asteroid\ncoord_func=comet_orbit\norbit_PericenterDistance=3.5\n"
+			  "orbit_Eccentricity=0.1\norbit_TimeAtPericenter=2451545.0\n"));
+	QVERIFY(MinorBodyCatalog::importIni(path("valid.ini"), path("valid.cat")));
+	const QByteArray valid = readAll(path("valid.cat"));
+	QVERIFY(valid.size()>64);
+
+	// Offsets in the header, see MinorBodyCatalog::Header
+	const quint32 version = MinorBodyCatalog::Version-1;
+	const quint32 otherByteOrder = 0x04030201;
+	const quint64 hugeOffset = Q_UINT64_C(0xfffffffffffffff8);
+	quint64 nameIndexOffset;
+	memcpy(&nameIndexOffset, valid.constData()+32, sizeof(quint64));
+	const quint32 badName = 2;
+
+	QTest::addColumn<QByteArray>("data");
+	QTest::addColumn<bool>("loads");
+	QTest::newRow("valid") << valid << true;
+	QTest::newRow("empty") << QByteArray() << false;
+	QTest::newRow("magic") << QByteArray(valid).replace(0, 4, "XXXX") << false;
+	QTest::newRow("older version") << QByteArray(valid).replace(4, 4, reinterpret_cast<const char*>(&version), 4) << false;
+	QTest::newRow("byte order") << QByteArray(valid).replace(8, 4, reinterpret_cast<const char*>(&otherByteOrder), 4) << false;
+	QTest::newRow("truncated header") << valid.left(40) << false;
+	QTest::newRow("truncated") << valid.left(valid.size()-1) << false;
+	QTest::newRow("elements offset") << QByteArray(valid).replace(16, 8, reinterpret_cast<const char*>(&hugeOffset), 8) << false;
+	QTest::newRow("name index") << QByteArray(valid).replace(int(nameIndexOffset), 4, reinterpret_cast<const char*>(&badName), 4) << false;
+	QTest::newRow("strings") << QByteArray(valid).replace(valid.size()-1, 1, "x") << false;
+}
+
+void TestMinorBodyCatalog::testRejectInvalid()
+{
+	QFETCH(QByteArray, data);
+	QFETCH(bool, loads);
+	QVERIFY(writeAll(path("test.cat"), data));
+	MinorBodyCatalog catalog;
+	QCOMPARE(catalog.load(path("test.cat")), loads);
+	QCOMPARE(catalog.isLoaded(), loads);
+	QCOMPARE(catalog.size(), loads ? 2 : 0);
+}
+
+void TestMinorBodyCatalog::testLazyBodies()
+{
+	// A user directory with an MPCORB.DAT of two bodies, which is always mapped and never loaded completely
+	QTemporaryDir userDir;
+	QVERIFY(userDir.isValid());
+	QVERIFY(QDir(userDir.path()).mkpath("data"));
+	QVERIFY(writeText(userDir.path()+"/data/MPCORB.DAT",
+			  mpcorbLine("(900001) Testbright", -9.9, "K194R", 10., 20., 30., 5., 0.1, 0.25, 2.5) + "\n" +
+			  mpcorbLine("(900002) Testfaint", 30., "K194R", 10., 20., 30., 5., 0.1, 0.25, 2.5) + "\n"));
+	StelFileMgr::setUserDir(userDir.path());
+
+	QSettings conf(userDir.path() + "/config.ini", StelIniFormat);
+	conf.setValue("main/check_requirements", false);
+	conf.setValue("video/fullscreen", false);
+	conf.setValue("video/screen_w", 320);
+	conf.setValue("video/screen_h", 240);
+	conf.setValue("astro/minor_bodies_lazy_threshold", 0);
+	// Without atmosphere the limiting magnitude does not depend on the time of the day
+	conf.setValue("landscape/flag_atmosphere", false);
+	StelTranslator::init(StelFileMgr::getInstallationDir() + "/data/iso639-1.utf8");
+
+	StelMainView mainView(&conf);
+	QSignalSpy drawn(&mainView, SIGNAL(drawEnded()));
+	mainView.show();
+	if (drawn.isEmpty() && !drawn.wait(120000))
+	{
+		mainView.deinit();
+		QSKIP("Stellarium could not be started, an OpenGL context is required");
+	}
+
+	StelCore* core = StelApp::getInstance().getCore();
+	SolarSystem* ssystem = GETSTELMODULE(SolarSystem);
+	core->setTimeRate(0.);
+	core->setJD(2458600.5);
+	core->update(0.);
+	ssystem->update(1.);
+
+	// Only the bright body is created
+	PlanetP bright = ssystem->searchByEnglishName("Testbright");
+	QVERIFY(bright);
+	QVERIFY(ssystem->getAllMinorBodies().contains(bright));
+	QVERIFY(ssystem->getMinorBodiesList().contains("Testbright"));
+	QVERIFY(!ssystem->getMinorBodiesList().contains("Testfaint"));
+
+	// The faint body is created when searched for, and added at the next update
+	PlanetP faint = ssystem->searchByEnglishName("Testfaint");
+	QVERIFY(faint);
+	QCOMPARE(faint->getPlanetType(), Planet::isAsteroid);
+	QCOMPARE(ssystem->searchByEnglishName("Testfaint"), faint);
+	QVERIFY(!ssystem->getAllPlanets().contains(faint));
+	ssystem->update(0.);
+	QVERIFY(ssystem->getAllPlanets().contains(faint));
+	QVERIFY(ssystem->getAllMinorBodies().contains(faint));
+	QVERIFY(ssystem->getMinorBodiesList().contains("Testfaint"));
+
+	// It is released when the date changes, the bright body stays
+	core->setJD(2458602.5);
+	core->update(0.);
+	ssystem->update(1.);
+	QVERIFY(!ssystem->getAllPlanets().contains(faint));
+	QVERIFY(!ssystem->getAllMinorBodies().contains(faint));
+	QVERIFY(!ssystem->getMinorBodiesList().contains("Testfaint"));
+	QVERIFY(ssystem->getAllMinorBodies().contains(bright));
+	QCOMPARE(ssystem->getMinorBodiesList().count("Testbright"), 1);
+
+	faint.clear();
+	bright.clear();
+	mainView.deinit();
+}
@@ -0,0 +1,136 @@
+/*
+ * Stellarium
+ * Copyright (C) 2017 Stellarium Developers
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Suite 500, Boston, MA  02110-1335, USA.
+ */
+
+#include <QObject>
+#include <QtDebug>
+#include <QtTest>
+#include <QSet>
+
+#include <cmath>
+
+#include "tests/testNomenclatureZones.hpp"
+#include "NomenclatureMgr.hpp"
+#include "StelGeodesicGrid.hpp"
+
+QTEST_GUILESS_MAIN(TestNomenclatureZones)
+
+// Features spread evenly over the body (Fibonacci sphere), in the rotating frame of the body
+static QVector<Vec3d> directions;
+
+void TestNomenclatureZones::initTestCase()
+{
+	const int n = 5000;
+	const double goldenAngle = M_PI*(3.-std::sqrt(5.));
+	directions.clear();
+	for (int i=0; i<n; ++i)
+	{
+		const double z = 1. - (2.*i + 1.)/n;
+		const double r = std::sqrt(1. - z*z);
+		directions.append(Vec3d(r*std::cos(goldenAngle*i), r*std::sin(goldenAngle*i), z));
+	}
+	// Features at the poles and on the prime meridian, where the zones of the grid meet
+	directions << Vec3d(0., 0., 1.) << Vec3d(0., 0., -1.) << Vec3d(1., 0., 0.) << Vec3d(-1., 0., 0.);
+}
+
+void TestNomenclatureZones::testIndex()
+{
+	QVector<int> zoneBegin, order;
+	NomenclatureMgr::indexFeatureZones(directions, zoneBegin, order);
+	const int nrOfZones = StelGeodesicGrid::nrOfZones(NomenclatureMgr::ZoneLevel);
+	QCOMPARE(zoneBegin.size(), nrOfZones+1);
+	QCOMPARE(zoneBegin.first(), 0);
+	QCOMPARE(zoneBegin.last(), directions.size());
+	QCOMPARE(order.size(), directions.size());
+
+	const StelGeodesicGrid grid(NomenclatureMgr::ZoneLevel);
+	QVector<bool> seen(directions.size(), false);
+	for (int z=0; z<nrOfZones; ++z)
+	{
+		QVERIFY(zoneBegin.at(z)<=zoneBegin.at(z+1));
+		for (int i=zoneBegin.at(z); i<zoneBegin.at(z+1); ++i)
+		{
+			const int f = order.at(i);
+			QVERIFY(f>=0 && f<directions.size() && !seen.at(f));
+			seen[f] = true;
+			const Vec3d& d = directions.at(f);
+			QCOMPARE(grid.getZoneNumberForPoint(Vec3f(d[0], d[1], d[2]), NomenclatureMgr::ZoneLevel), z);
+			// The order of the features is kept in each zone.
+			if (i>zoneBegin.at(z))
+				QVERIFY(order.at(i-1)<f);
+		}
+	}
+}
+
+void TestNomenclatureZones::testVisibleZones_data()
+{
+	QTest::addColumn<Vec3d>("observerDir");
+	QTest::addColumn<double>("radiusOverDistance");
+
+	const Vec3d dirs[] = {Vec3d(0., 0., 1.), Vec3d(0., 0., -1.), Vec3d(1., 0., 0.), Vec3d(0.3, -0.8, 0.52), Vec3d(-0.6, 0.1, -0.79)};
+	const double ratios[] = {1e-3, 0.05, 0.5, 1., 1.99};
+	for (int i=0; i<5; ++i)
+	{
+		Vec3d d = dirs[i];
+		d.normalize();
+		for (int j=0; j<5; ++j)
+			QTest::newRow(qPrintable(QString("direction %1, r/dist %2").arg(i).arg(ratios[j]))) << d << ratios[j];
+	}
+}
+
+void TestNomenclatureZones::testVisibleZones()
+{
+	QFETCH(Vec3d, observerDir);
+	QFETCH(double, radiusOverDistance);
+
+	// Position of the centre of the body seen from the observer at distance 1, and of the features.
+	const Vec3d equPos = -observerDir;
+	const double r = radiusOverDistance;
+
+	// Test of NomenclatureItem::draw() on all features
+	QSet<int> expected;
+	for (int i=0; i<directions.size(); ++i)
+	{
+		const Vec3d XYZ = equPos + directions.at(i)*r;
+		if (XYZ.length()<=equPos.length())
+			expected.insert(i);
+	}
+
+	// The same test on the features of the zones of the visible hemisphere only
+	QVector<int> zoneBegin, order, zones;
+	NomenclatureMgr::indexFeatureZones(directions, zoneBegin, order);
+	const StelGeodesicGrid grid(NomenclatureMgr::ZoneLevel);
+	NomenclatureMgr::getVisibleZones(&grid, observerDir, radiusOverDistance, zones);
+	QSet<int> found;
+	int visited = 0;
+	foreach (int z, zones)
+	{
+		for (int i=zoneBegin.at(z); i<zoneBegin.at(z+1); ++i)
+		{
+			const int f = order.at(i);
+			++visited;
+			const Vec3d XYZ = equPos + directions.at(f)*r;
+			if (XYZ.length()<=equPos.length())
+				found.insert(f);
+		}
+	}
+
+	QCOMPARE(found, expected);
+	// At most a hemisphere of features is visited, plus the zones of about 8 degrees on its border.
+	QVERIFY2(visited<0.65*directions.size(), qPrintable(QString("%1 features of %2 visited").arg(visited).arg(directions.size())));
+}
@@ -0,0 +1,230 @@
+/*
+ * Stellarium
+ * Copyright (C) 2017 Stellarium Developers
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Suite 500, Boston, MA  02110-1335, USA.
+ */
+
+#include <QObject>
+#include <QtDebug>
+#include <QtTest>
+
+#include <cmath>
+
+#include "tests/testOrbitPath.hpp"
+#include "OrbitPath.hpp"
+
+QTEST_GUILESS_MAIN(TestOrbitPath)
+
+// As in Planet, one base sample per degree of the orbit
+#define SEGMENTS 360
+#define STEP 1.0
+#define J2000 2451545.0
+
+//! Circular orbit of radius 1 AU in the ecliptic, with a period of SEGMENTS*STEP days.
+class CircleSampler : public OrbitPath::Sampler
+{
+public:
+	Vec3d computePos(double jde) const
+	{
+		const double a = 2.*M_PI*(jde-J2000)/(SEGMENTS*STEP);
+		return Vec3d(std::cos(a), std::sin(a), 0.);
+	}
+};
+
+// Observer far enough for the line of the base samples to need no intermediate samples
+static const Vec3d observerPos(0., 0., 10.);
+
+static bool samePoints(const QVector<Vec3d>& a, const QVector<Vec3d>& b)
+{
+	if (a.size()!=b.size())
+		return false;
+	for (int i=0; i<a.size(); ++i)
+	{
+		if ((a.at(i)-b.at(i)).length()>1e-12)
+			return false;
+	}
+	return true;
+}
+
+void TestOrbitPath::init()
+{
+	// Forget the paths postponed by the previous tests
+	OrbitPath::beginFrame(1000000, observerPos);
+	OrbitPath::beginFrame(1000000, observerPos);
+}
+
+void TestOrbitPath::testFullUpdate()
+{
+	const CircleSampler sampler;
+	OrbitPath path(SEGMENTS);
+	QVERIFY(!path.isValid());
+	QVERIFY(path.update(J2000, sampler, Vec3d(0.)));
+	QVERIFY(!path.isValid());
+
+	path.setStep(STEP);
+	QVERIFY(path.needsUpdate(J2000));
+	QVERIFY(path.update(J2000, sampler, Vec3d(0.)));
+	QVERIFY(path.isValid());
+	QVERIFY(!path.needsUpdate(J2000+0.5*STEP));
+	QVERIFY(path.needsUpdate(J2000+1.5*STEP));
+
+	// The samples are centered on the date, the body is inserted before the sample at its date
+	QVector<Vec3d> points;
+	const Vec3d bodyPos = sampler.computePos(J2000);
+	path.getPoints(J2000, bodyPos, false, points);
+	QCOMPARE(points.size(), SEGMENTS+1);
+	QVERIFY((points.first()-sampler.computePos(J2000-(SEGMENTS/2)*STEP)).length()<1e-12);
+	QVERIFY((points.last()-sampler.computePos(J2000+(SEGMENTS/2-1)*STEP)).length()<1e-12);
+	QVERIFY((points.at(SEGMENTS/2)-bodyPos).length()<1e-12);
+
+	path.getPoints(J2000, bodyPos, true, points);
+	QCOMPARE(points.size(), SEGMENTS+2);
+	QVERIFY((points.last()-points.first()).length()<1e-12);
+
+	path.clear();
+	QVERIFY(!path.isValid());
+	path.getPoints(J2000, bodyPos, true, points);
+	QVERIFY(points.isEmpty());
+}
+
+void TestOrbitPath::testMovedSameAsFull_data()
+{
+	QTest::addColumn<double>("days");
+	QTest::newRow("1 step later") << 1.*STEP;
+	QTest::newRow("10 steps later") << 10.*STEP;
+	QTest::newRow("10 steps earlier") << -10.*STEP;
+	QTest::newRow("359 steps later") << 359.*STEP;
+	QTest::newRow("2 periods later") << 2.*SEGMENTS*STEP;
+}
+
+void TestOrbitPath::testMovedSameAsFull()
+{
+	QFETCH(double, days);
+	const CircleSampler sampler;
+	OrbitPath moved(SEGMENTS), full(SEGMENTS);
+	moved.setStep(STEP);
+	full.setStep(STEP);
+	QVERIFY(moved.update(J2000, sampler, Vec3d(0.)));
+	QVERIFY(moved.update(J2000+days, sampler, Vec3d(0.)));
+	QVERIFY(full.update(J2000+days, sampler, Vec3d(0.)));
+
+	QVector<Vec3d> movedPoints, fullPoints;
+	const Vec3d bodyPos = sampler.computePos(J2000+days);
+	moved.getPoints(J2000+days, bodyPos, true, movedPoints);
+	full.getPoints(J2000+days, bodyPos, true, fullPoints);
+	QVERIFY(samePoints(movedPoints, fullPoints));
+}
+
+void TestOrbitPath::testLineThroughBody()
+{
+	const CircleSampler sampler;
+	OrbitPath path(SEGMENTS);
+	path.setStep(STEP);
+	QVERIFY(path.update(J2000, sampler, Vec3d(0.)));
+
+	// Between two samples
+	const double jde = J2000 + 10.25*STEP;
+	const Vec3d bodyPos = sampler.computePos(jde);
+	QVector<Vec3d> points;
+	path.getPoints(jde, bodyPos, false, points);
+	QCOMPARE(points.size(), SEGMENTS+1);
+	const int i = SEGMENTS/2+11;
+	QVERIFY((points.at(i)-bodyPos).length()<1e-12);
+	QVERIFY((points.at(i-1)-sampler.computePos(J2000+10.*STEP)).length()<1e-12);
+	QVERIFY((points.at(i+1)-sampler.computePos(J2000+11.*STEP)).length()<1e-12);
+}
+
+void TestOrbitPath::testPostponedLineThroughBody()
+{
+	const CircleSampler sampler;
+	OrbitPath path(SEGMENTS);
+	path.setStep(STEP);
+	QVERIFY(path.update(J2000, sampler, Vec3d(0.)));
+
+	// The update for a date beyond the samples is postponed
+	OrbitPath::beginFrame(0, observerPos);
+	const double jde = J2000 + (SEGMENTS+10.5)*STEP;
+	QVERIFY(path.needsUpdate(jde));
+	QVERIFY(!path.update(jde, sampler, Vec3d(0.)));
+	const Vec3d bodyPos = sampler.computePos(jde);
+
+	// Closed orbits: the date is moved by one period, between the samples of 10 and 11 days after J2000
+	QVector<Vec3d> points;
+	path.getPoints(jde, bodyPos, true, points);
+	QCOMPARE(points.size(), SEGMENTS+2);
+	const int i = SEGMENTS/2+11;
+	QVERIFY((points.at(i)-bodyPos).length()<1e-12);
+	QVERIFY((points.at(i-1)-sampler.computePos(J2000+10.*STEP)).length()<1e-12);
+
+	// Open orbits: the line is extended to the body
+	path.getPoints(jde, bodyPos, false, points);
+	QCOMPARE(points.size(), SEGMENTS+1);
+	QVERIFY((points.last()-bodyPos).length()<1e-12);
+	const double earlier = J2000 - SEGMENTS*STEP;
+	path.getPoints(earlier, sampler.computePos(earlier), false, points);
+	QCOMPARE(points.size(), SEGMENTS+1);
+	QVERIFY((points.first()-sampler.computePos(earlier)).length()<1e-12);
+}
+
+void TestOrbitPath::testBudget()
+{
+	const CircleSampler sampler;
+	OrbitPath first(SEGMENTS), second(SEGMENTS);
+	first.setStep(STEP);
+	second.setStep(STEP);
+
+	// The budget is a limit of the work per frame: the first path may exceed it.
+	OrbitPath::beginFrame(SEGMENTS/2, observerPos);
+	QVERIFY(first.update(J2000, sampler, Vec3d(0.)));
+	QVERIFY(!second.update(J2000, sampler, Vec3d(0.)));
+	QVERIFY(!second.isValid());
+
+	OrbitPath::beginFrame(SEGMENTS/2, observerPos);
+	QVERIFY(second.update(J2000, sampler, Vec3d(0.)));
+	QVERIFY(second.isValid());
+}
+
+// The paths are always updated in the same order, and the first ones use up the budget of each
+// frame. The last one must not wait forever.
+void TestOrbitPath::testPostponedPathsServed()
+{
+	const CircleSampler sampler;
+	QVector<OrbitPath*> paths;
+	for (int i=0; i<3; ++i)
+	{
+		paths.append(new OrbitPath(SEGMENTS));
+		paths.last()->setStep(STEP);
+	}
+
+	double jde = J2000;
+	for (int frame=0; frame<10; ++frame)
+	{
+		// Each path which is up to date needs half of the budget to follow the date.
+		jde += (SEGMENTS/2)*STEP;
+		OrbitPath::beginFrame(SEGMENTS, observerPos);
+		foreach (OrbitPath* path, paths)
+		{
+			if (path->needsUpdate(jde))
+				path->update(jde, sampler, Vec3d(0.));
+		}
+	}
+	foreach (OrbitPath* path, paths)
+	{
+		QVERIFY(path->isValid());
+		QVERIFY(!path->needsUpdate(jde));
+	}
+	qDeleteAll(paths);
+}
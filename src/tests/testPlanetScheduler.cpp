@@ -0,0 +1,300 @@
+/*
+ * Stellarium
+ * Copyright (C) 2017 Stellarium Developers
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Suite 500, Boston, MA  02110-1335, USA.
+ */
+
+#include <QObject>
+#include <QtDebug>
+#include <QtTest>
+#include <QSharedPointer>
+#include <cmath>
+#include <cstring>
+
+#include "tests/testPlanetScheduler.hpp"
+#include "PlanetScheduler.hpp"
+#include "Orbit.hpp"
+
+QTEST_GUILESS_MAIN(TestPlanetScheduler)
+
+// A body which behaves like Planet for the scheduler: computing it updates the position of its
+// parent for the same date, unless the parent is the root. Its position is either a simple
+// analytic function, or computed by one of the orbit classes used by SolarSystem.
+class TestBody;
+typedef QSharedPointer<TestBody> TestBodyP;
+
+class TestBody
+{
+public:
+	TestBody(int id, const TestBodyP& parent, bool threadSafe)
+		: id(id), parent(parent), threadSafe(threadSafe), lastJDE(-1e10)
+		, ellipticalOrbit(Q_NULLPTR), cometOrbit(Q_NULLPTR)
+	{
+		pos[0] = pos[1] = pos[2] = 0.;
+	}
+	~TestBody()
+	{
+		delete ellipticalOrbit;
+		delete cometOrbit;
+	}
+
+	TestBodyP getParent() const {return parent;}
+
+	void computePositionWithoutOrbits(double jde)
+	{
+		if (std::fabs(lastJDE-jde)<=1e-5)
+			return;
+		if (ellipticalOrbit)
+			ellipticalOrbit->positionAtTimevInVSOP87Coordinates(jde, pos);
+		else if (cometOrbit)
+			cometOrbit->positionAtTimevInVSOP87Coordinates(jde, pos);
+		else
+		{
+			const double a = 0.3 + 0.01*id;
+			const double n = 0.017/(1.+0.05*id);
+			pos[0] = a*std::cos(n*(jde-2451545.) + id);
+			pos[1] = a*std::sin(n*(jde-2451545.) + id);
+			pos[2] = 0.001*id*std::sin(0.1*jde);
+		}
+		lastJDE = jde;
+	}
+
+	void computePosition(double jde)
+	{
+		if (parent && parent->parent)
+			parent->computePositionWithoutOrbits(jde);
+		computePositionWithoutOrbits(jde);
+	}
+
+	void getHeliocentricPos(double* xyz) const
+	{
+		xyz[0] = xyz[1] = xyz[2] = 0.;
+		for (const TestBody* b=this; b; b=b->parent.data())
+		{
+			xyz[0] += b->pos[0];
+			xyz[1] += b->pos[1];
+			xyz[2] += b->pos[2];
+		}
+	}
+
+	int id;
+	TestBodyP parent;
+	bool threadSafe;
+	double lastJDE;
+	double pos[3];
+	//! Set to compute the position like SolarSystem's ellipticalOrbitPosFunc or cometOrbitPosFunc.
+	EllipticalOrbit* ellipticalOrbit;
+	CometOrbit* cometOrbit;
+};
+
+static bool isThreadSafe(const TestBodyP& b)
+{
+	return b->threadSafe;
+}
+
+// Same two passes as SolarSystem::computePositions() with light time correction.
+class TestStep
+{
+public:
+	TestStep(bool lightTime, double jde) : lightTime(lightTime), jde(jde) {}
+	void operator()(const TestBodyP& b) const
+	{
+		if (!lightTime)
+		{
+			b->computePositionWithoutOrbits(jde);
+			return;
+		}
+		double xyz[3];
+		b->getHeliocentricPos(xyz);
+		const double dist = std::sqrt((xyz[0]-1.)*(xyz[0]-1.) + xyz[1]*xyz[1] + xyz[2]*xyz[2]);
+		b->computePosition(jde - dist*0.0057755);
+	}
+private:
+	bool lightTime;
+	double jde;
+};
+
+// Build a hierarchy of 200 planets, some of them with moons, in a scrambled order.
+static QList<TestBodyP> buildBodies()
+{
+	QList<TestBodyP> ordered;
+	TestBodyP root(new TestBody(0, TestBodyP(), false));
+	ordered.append(root);
+	int id = 1;
+	for (int i=0; i<200; ++i)
+	{
+		TestBodyP planet(new TestBody(id++, root, i%7!=0));
+		ordered.append(planet);
+		if (i%5==0)
+		{
+			for (int m=0; m<3; ++m)
+			{
+				TestBodyP moon(new TestBody(id++, planet, true));
+				ordered.append(moon);
+				if (m==0 && i%10==0)
+					ordered.append(TestBodyP(new TestBody(id++, moon, true)));
+			}
+		}
+	}
+
+	QList<TestBodyP> bodies;
+	for (int i=0; i<ordered.size(); ++i)
+		bodies.append(ordered.at((i*37)%ordered.size()));
+	return bodies;
+}
+
+// Build a hierarchy like the one of SolarSystem, with the orbit classes used for the minor bodies
+// (CometOrbit) and the moons (EllipticalOrbit): every 10th planet stands for a body computed by a
+// planetary theory, which is not thread-safe. The elements cover elliptic, parabolic and
+// hyperbolic orbits, and the bodies are in a scrambled order.
+static QList<TestBodyP> buildOrbitBodies()
+{
+	QList<TestBodyP> ordered;
+	TestBodyP root(new TestBody(0, TestBodyP(), false));
+	ordered.append(root);
+	int id = 1;
+	for (int i=0; i<300; ++i)
+	{
+		TestBodyP body(new TestBody(id++, root, i%10!=0));
+		const double e = (i%3==0) ? 1.0 : (i%3==1 ? 0.05+0.003*i : 1.0+0.002*i);
+		const double q = 0.3 + 0.1*i;
+		// Same mean motion as SolarSystem::loadPlanet() for comet_orbit without orbit_MeanMotion
+		const double n = (e==1.0) ? 0.01720209895 * (1.5/q) * std::sqrt(0.5/q)
+					  : 0.01720209895 / (std::fabs(q/(1.-e)) * std::sqrt(std::fabs(q/(1.-e))));
+		body->cometOrbit = new CometOrbit(q, e, 0.02*i, 1.1*i, 0.7*i, 2451545.+37.*i-5000., 1e10, n, 0., 0., 0.);
+		ordered.append(body);
+		if (i%6==0)
+		{
+			for (int m=0; m<4; ++m)
+			{
+				TestBodyP moon(new TestBody(id++, body, true));
+				moon->ellipticalOrbit = new EllipticalOrbit(0.002*(m+1), 0.01*m, 0.1*m, 0.3*m, 0.2*m, 0.5*m,
+									    1.5+2.*m, 2451545., 0.05*i, 0.02*i, 0.1*m);
+				ordered.append(moon);
+			}
+		}
+	}
+
+	QList<TestBodyP> bodies;
+	for (int i=0; i<ordered.size(); ++i)
+		bodies.append(ordered.at((i*53)%ordered.size()));
+	return bodies;
+}
+
+void TestPlanetScheduler::testPartition()
+{
+	QList<TestBodyP> bodies = buildBodies();
+	PlanetScheduler<TestBodyP> scheduler;
+	scheduler.build(bodies, &isThreadSafe);
+
+	int count = scheduler.getSerialBodies().size();
+	foreach (const QList<TestBodyP>& group, scheduler.getGroups())
+		count += group.size();
+	QCOMPARE(count, bodies.size());
+
+	bool rootFound = false;
+	foreach (const TestBodyP& b, scheduler.getSerialBodies())
+	{
+		if (!b->parent)
+		{
+			rootFound = true;
+			continue;
+		}
+		const TestBody* top = b.data();
+		while (top->parent->parent)
+			top = top->parent.data();
+		// Serial bodies belong to families with a thread-unsafe planet.
+		QVERIFY(!top->threadSafe);
+	}
+	QVERIFY(rootFound);
+
+	foreach (const QList<TestBodyP>& group, scheduler.getGroups())
+	{
+		const TestBody* top = Q_NULLPTR;
+		int lastIndex = -1;
+		foreach (const TestBodyP& b, group)
+		{
+			QVERIFY(b->threadSafe);
+			const TestBody* t = b.data();
+			while (t->parent->parent)
+				t = t->parent.data();
+			if (!top)
+				top = t;
+			// One family per group, in the original order.
+			QVERIFY(t==top);
+			const int index = bodies.indexOf(b);
+			QVERIFY(index>lastIndex);
+			lastIndex = index;
+		}
+	}
+}
+
+void TestPlanetScheduler::testSameAsSerial()
+{
+	QList<TestBodyP> serial = buildBodies();
+	QList<TestBodyP> parallel = buildBodies();
+	PlanetScheduler<TestBodyP> scheduler;
+	scheduler.build(parallel, &isThreadSafe);
+
+	for (int i=0; i<500; ++i)
+	{
+		const double jde = 2451545. + 13.7*(i-250) + 0.001*i;
+		foreach (const TestBodyP& b, serial)
+			TestStep(false, jde)(b);
+		foreach (const TestBodyP& b, serial)
+			TestStep(true, jde)(b);
+
+		scheduler.run(TestStep(false, jde));
+		scheduler.run(TestStep(true, jde));
+
+		for (int b=0; b<serial.size(); ++b)
+		{
+			QCOMPARE(parallel.at(b)->id, serial.at(b)->id);
+			QVERIFY(std::memcmp(parallel.at(b)->pos, serial.at(b)->pos, sizeof(serial.at(b)->pos))==0);
+			QVERIFY(std::memcmp(&parallel.at(b)->lastJDE, &serial.at(b)->lastJDE, sizeof(double))==0);
+		}
+	}
+}
+
+void TestPlanetScheduler::testOrbitsSameAsSerial()
+{
+	QList<TestBodyP> serial = buildOrbitBodies();
+	QList<TestBodyP> parallel = buildOrbitBodies();
+	// Built once, as SolarSystem does until its list of bodies changes
+	PlanetScheduler<TestBodyP> scheduler;
+	scheduler.build(parallel, &isThreadSafe);
+	QVERIFY(scheduler.getGroups().size()>1);
+
+	for (int i=0; i<400; ++i)
+	{
+		const double jde = 2451545. + 36.53*(i-200) + 0.0007*i;
+		foreach (const TestBodyP& b, serial)
+			TestStep(false, jde)(b);
+		foreach (const TestBodyP& b, serial)
+			TestStep(true, jde)(b);
+
+		scheduler.run(TestStep(false, jde));
+		scheduler.run(TestStep(true, jde));
+
+		for (int b=0; b<serial.size(); ++b)
+		{
+			QCOMPARE(parallel.at(b)->id, serial.at(b)->id);
+			QVERIFY2(std::memcmp(parallel.at(b)->pos, serial.at(b)->pos, sizeof(serial.at(b)->pos))==0,
+				 qPrintable(QString("body %1 at JDE %2").arg(serial.at(b)->id).arg(jde, 0, 'f', 4)));
+			QVERIFY(std::memcmp(&parallel.at(b)->lastJDE, &serial.at(b)->lastJDE, sizeof(double))==0);
+		}
+	}
+}
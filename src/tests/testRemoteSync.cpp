@@ -0,0 +1,752 @@
+/*
+ * Stellarium
+ * Copyright (C) 2017 Stellarium Developers
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Suite 500, Boston, MA  02110-1335, USA.
+ */
+
+#include <QObject>
+#include <QtDebug>
+#include <QtTest>
+#include <QCoreApplication>
+#include <QElapsedTimer>
+#include <QRegularExpression>
+#include <QTcpServer>
+#include <QTcpSocket>
+#include <cmath>
+
+#include "tests/testRemoteSync.hpp"
+#include "SyncClient.hpp"
+#include "SyncClientHandlers.hpp"
+#include "SyncClock.hpp"
+#include "SyncMessages.hpp"
+#include "SyncProtocol.hpp"
+#include "SyncServer.hpp"
+#include "SyncServerEventSenders.hpp"
+#include "SyncStateFrame.hpp"
+
+QTEST_GUILESS_MAIN(TestRemoteSync)
+
+using namespace SyncProtocol;
+
+// Deterministic pseudo-random numbers in [0, 1)
+class Random
+{
+public:
+	Random(quint32 seed) : state(seed) {}
+	double next()
+	{
+		state = state*1664525u + 1013904223u;
+		return (state>>8) / 16777216.0;
+	}
+private:
+	quint32 state;
+};
+
+static Vec3d toVector(double azimuth, double altitude)
+{
+	return Vec3d(std::cos(altitude)*std::cos(azimuth), std::cos(altitude)*std::sin(azimuth), std::sin(altitude));
+}
+
+namespace
+{
+	// Sends the frames of an encoder, as StateFrameEventSender does with the state of the application
+	class EncoderEventSender : public SyncServerEventSender
+	{
+	public:
+		EncoderEventSender() : SyncServerEventSender(Q_NULLPTR), serverTime(0), frames(0), bytes(0) {}
+
+		SyncStateEncoder encoder;
+		qint64 serverTime;
+		int frames; //broadcast by update()
+		qint64 bytes; //of the messages broadcast by update()
+	protected:
+		void newClientConnected(SyncRemotePeer& client) Q_DECL_OVERRIDE
+		{
+			foreach (const QByteArray& payload, encoder.encodeKeyFrame(serverTime))
+			{
+				StateFrame msg;
+				msg.payload = payload;
+				client.writeMessage(msg);
+			}
+		}
+		void update() Q_DECL_OVERRIDE
+		{
+			const QList<QByteArray> payloads = encoder.encodeFrame(serverTime);
+			if (!payloads.isEmpty())
+				++frames;
+			foreach (const QByteArray& payload, payloads)
+			{
+				StateFrame msg;
+				msg.payload = payload;
+				broadcastMessage(msg);
+				bytes += SYNC_HEADER_SIZE + payload.size();
+			}
+		}
+	};
+
+	// A SyncServer which sends the frames of an EncoderEventSender instead of the state of the application
+	class LoopbackServer : public SyncServer
+	{
+	public:
+		LoopbackServer() : sender(Q_NULLPTR) {}
+
+		//! Created by start()
+		EncoderEventSender* sender;
+	protected:
+		void createSenders() Q_DECL_OVERRIDE
+		{
+			sender = new EncoderEventSender();
+			addSender(sender);
+		}
+	};
+
+	// Counts the replies to the CLOCK_SYNC requests, which ClientClockSyncHandler adds to the clock
+	class ClockSyncCounter : public SyncMessageHandler
+	{
+	public:
+		ClockSyncCounter() : replies(0) {}
+		bool handleMessage(QDataStream& stream, tPayloadSize dataSize, SyncRemotePeer& peer) Q_DECL_OVERRIDE
+		{
+			++replies;
+			return handler.handleMessage(stream, dataSize, peer);
+		}
+
+		int replies;
+	private:
+		ClientClockSyncHandler handler;
+	};
+
+	// Decodes the STATE_FRAMEs received by a client
+	class FrameRecorder : public SyncMessageHandler
+	{
+	public:
+		FrameRecorder(const QElapsedTimer* timer) : timer(timer), sequence(0), messages(0), frames(0) {}
+		bool handleMessage(QDataStream& stream, tPayloadSize dataSize, SyncRemotePeer& peer) Q_DECL_OVERRIDE
+		{
+			Q_UNUSED(peer);
+			StateFrame msg;
+			SyncStateFrame frame;
+			if (!msg.deserialize(stream, dataSize) || !decoder.decode(msg.payload, frame))
+				return false;
+			++messages;
+			sequence = frame.sequence;
+			for (int i=0; i<frame.properties.size(); ++i)
+				properties[frame.properties.at(i).first] = frame.properties.at(i).second;
+			if (!frame.has(SyncStateFrame::KeyFrame) && !frame.has(SyncStateFrame::Continued))
+			{
+				++frames;
+				if (timer)
+					arrivalTimes.insert(frame.sequence, timer->nsecsElapsed());
+			}
+			return true;
+		}
+
+		SyncStateDecoder decoder;
+		QMap<QString, QVariant> properties;
+		const QElapsedTimer* timer;
+		quint32 sequence; //of the last message
+		int messages;
+		int frames; //without the key frame and Continued frames
+		QHash<quint32, qint64> arrivalTimes; //[ns] of timer, by sequence
+	};
+
+	// A client of the server over loopback: a SyncRemotePeer with the handlers of SyncClient
+	// for the connection and the clock, and a FrameRecorder for the state frames
+	struct LoopbackClient
+	{
+		LoopbackClient(SyncClient* owner, quint16 port, const QElapsedTimer* timer = Q_NULLPTR)
+			: errorHandler(owner)
+			, authHandler(owner)
+			, recorder(timer)
+		{
+			QVector<SyncMessageHandler*> handlers(MSGTYPE_SIZE);
+			handlers[ERROR] = &errorHandler;
+			handlers[SERVER_CHALLENGE] = &authHandler;
+			handlers[SERVER_CHALLENGERESPONSEVALID] = &authHandler;
+			handlers[ALIVE] = &aliveHandler;
+			handlers[CLOCK_SYNC] = &clockHandler;
+			handlers[LOCATION] = &dummyHandler;
+			handlers[SELECTION] = &dummyHandler;
+			handlers[STATE_FRAME] = &recorder;
+			QTcpSocket* socket = new QTcpSocket();
+			peer = new SyncRemotePeer(socket, true, handlers);
+			socket->connectToHost(QHostAddress::LocalHost, port);
+		}
+		~LoopbackClient()
+		{
+			delete peer;
+		}
+
+		ClientErrorHandler errorHandler;
+		ClientAuthHandler authHandler;
+		ClientAliveHandler aliveHandler;
+		ClockSyncCounter clockHandler;
+		DummyMessageHandler dummyHandler;
+		FrameRecorder recorder;
+		SyncRemotePeer* peer;
+	};
+
+	// The clients have received a number of messages
+	struct ReceivedMessages
+	{
+		ReceivedMessages(const LoopbackClient* client, int count) : client(client), count(count) {}
+		bool operator()() const { return client->recorder.messages>=count; }
+		const LoopbackClient* client;
+		int count;
+	};
+
+	// The clients have received a frame
+	struct ReceivedFrame
+	{
+		ReceivedFrame(const QList<LoopbackClient*>& clients, quint32 sequence) : clients(clients), sequence(sequence) {}
+		bool operator()() const
+		{
+			foreach (const LoopbackClient* c, clients)
+			{
+				if (!c->recorder.decoder.hasKeyFrame() || c->recorder.sequence!=sequence)
+					return false;
+			}
+			return true;
+		}
+		QList<LoopbackClient*> clients;
+		quint32 sequence;
+	};
+
+	// A client has received a number of replies to its CLOCK_SYNC requests
+	struct ReceivedClockSyncs
+	{
+		ReceivedClockSyncs(const LoopbackClient* client, int count) : client(client), count(count) {}
+		bool operator()() const { return client->clockHandler.replies>=count; }
+		const LoopbackClient* client;
+		int count;
+	};
+}
+
+// A port for SyncServer::start()
+static quint16 getFreePort()
+{
+	QTcpServer probe;
+	if (!probe.listen(QHostAddress::LocalHost))
+		return 0;
+	return probe.serverPort();
+}
+
+// Run the event loop, which serves the server and the clients, until the condition is true.
+// Returns false after 5 s.
+template<class Condition>
+static bool processEventsUntil(const Condition& condition)
+{
+	QElapsedTimer timer;
+	timer.start();
+	while (!condition())
+	{
+		if (timer.elapsed()>5000)
+			return false;
+		QCoreApplication::processEvents(QEventLoop::AllEvents, 1);
+	}
+	return true;
+}
+
+// Size of a message of the previous protocol version, which sent each change in its own message
+static qint64 getV1PropertySize(const QString& id, const QVariant& value)
+{
+	QByteArray data;
+	QDataStream stream(&data, QIODevice::WriteOnly);
+	stream.setVersion(SYNC_DATASTREAM_VERSION);
+	stream<<id.toUtf8()<<value;
+	return SYNC_HEADER_SIZE + data.size();
+}
+
+void TestRemoteSync::testClockOffset()
+{
+	// The server clock is 1234 ms ahead. The messages take 2 ms, plus a random queueing time in each
+	// direction, except for every 5th exchange.
+	const qint64 offset = 1234;
+	Random random(1);
+	SyncClock clock;
+	QVERIFY(!clock.isValid());
+	QCOMPARE(clock.getOffset(), 0.0);
+	for (int i=0; i<40; ++i)
+	{
+		const qint64 forward = 2 + (i%5 ? static_cast<qint64>(30*random.next()) : 0);
+		const qint64 backward = 2 + (i%5 ? static_cast<qint64>(30*random.next()) : 0);
+		const qint64 t0 = 1000000 + 100*i;
+		const qint64 t1 = t0 + forward + offset;
+		const qint64 t2 = t1 + 1;
+		const qint64 t3 = t2 - offset + backward;
+		clock.addSample(t0, t1, t2, t3);
+		QVERIFY(clock.isValid());
+		// Each window has an exchange without queueing
+		if (i>=4)
+		{
+			QCOMPARE(clock.getOffset(), 1234.0);
+			QCOMPARE(clock.getDelay(), 4.0);
+		}
+	}
+	QVERIFY(clock.getJitter()>0.0);
+	QCOMPARE(clock.toLocalTime(5000), qint64(5000-1234));
+	QCOMPARE(clock.toRemoteTime(5000), qint64(5000+1234));
+
+	clock.clear();
+	QVERIFY(!clock.isValid());
+	QCOMPARE(clock.toLocalTime(5000), qint64(5000));
+}
+
+void TestRemoteSync::testServerLoopback()
+{
+	const quint16 port = getFreePort();
+	LoopbackServer server;
+	QVERIFY(server.start(port));
+	EncoderEventSender* sender = server.sender;
+	QVERIFY(sender);
+
+	// Properties too large for one message, which the key frame sends in several
+	QMap<QString, QVariant> expected;
+	for (int i=0; i<40; ++i)
+	{
+		const QString id = QString("Module%1.text").arg(i);
+		expected[id] = QString(2000, QChar('a'+i%26));
+		sender->encoder.setProperty(id, expected[id]);
+	}
+	sender->encoder.setView(toVector(0.5, 0.3));
+	sender->encoder.setFov(40.0);
+	sender->encoder.setTime(1000, 2457000.5, 1.0);
+	server.update();
+	QCOMPARE(sender->frames, 1);
+	const int keyFrameParts = sender->encoder.encodeKeyFrame(0).size();
+	QVERIFY(keyFrameParts>1);
+
+	SyncClient owner(SyncClient::NONE, QStringList());
+	LoopbackClient client(&owner, port);
+	QVERIFY(processEventsUntil(ReceivedMessages(&client, keyFrameParts)));
+	QVERIFY(client.peer->isAuthenticated());
+	QCOMPARE(client.recorder.properties, expected);
+	QCOMPARE(client.recorder.decoder.getState().fov, 40.0);
+	QCOMPARE(client.recorder.decoder.getState().jDay, 2457000.5);
+
+	// The following frames, broadcast by the server
+	const QList<LoopbackClient*> clients = QList<LoopbackClient*>() << &client;
+	Vec3d view;
+	double fov = 0.0;
+	for (int tick=1; tick<=60; ++tick)
+	{
+		view = toVector(0.5+0.01*tick, 0.3);
+		fov = 40.0-0.1*tick;
+		sender->serverTime = 16*tick;
+		sender->encoder.setView(view);
+		sender->encoder.setFov(fov);
+		if (tick%10==0)
+		{
+			const QString id = QString("Module%1.text").arg(tick);
+			expected[id] = tick;
+			sender->encoder.setProperty(id, tick);
+		}
+		server.update();
+		QVERIFY(processEventsUntil(ReceivedFrame(clients, sender->encoder.getSequence())));
+	}
+	QCOMPARE(client.recorder.frames, 60);
+	for (int i=0; i<3; ++i)
+		QVERIFY(std::fabs(client.recorder.decoder.getState().viewAltAz[i]-view[i]) <= SyncStateEncoder::Tolerance);
+	QVERIFY(std::fabs(client.recorder.decoder.getState().fov-fov) <= SyncStateEncoder::Tolerance*fov);
+	QCOMPARE(client.recorder.properties, expected);
+
+	// ClientAuthHandler sent the first CLOCK_SYNC request, ServerClockSyncHandler replies to each
+	for (int i=1; i<SyncClock::WindowSize; ++i)
+	{
+		QVERIFY(processEventsUntil(ReceivedClockSyncs(&client, i)));
+		client.peer->requestClockSync();
+	}
+	QVERIFY(processEventsUntil(ReceivedClockSyncs(&client, SyncClock::WindowSize)));
+	// Both ends use the same clock: the error is at most half the delay, plus the resolution of the clock
+	const SyncClock& clock = client.peer->getClock();
+	qDebug() << "Loopback clock offset" << clock.getOffset() << "ms, delay" << clock.getDelay() << "ms, jitter" << clock.getJitter() << "ms";
+	QVERIFY(clock.isValid());
+	QVERIFY(std::fabs(clock.getOffset()) <= 0.5*clock.getDelay() + 1.0);
+}
+
+void TestRemoteSync::testFrameRoundTrip()
+{
+	SyncStateEncoder encoder;
+	SyncStateDecoder decoder;
+	SyncStateFrame frame;
+	QVERIFY(decoder.decode(encoder.encodeKeyFrame(0).first(), frame));
+	QVERIFY(frame.has(SyncStateFrame::KeyFrame));
+
+	Random random(2);
+	QMap<QString, QVariant> expected, received;
+	double azimuth = 0.3, altitude = 0.2, fov = 60.0;
+	int frames = 0, viewDeltaFrames = 0, emptyFrames = 0;
+	for (int tick=0; tick<500; ++tick)
+	{
+		// Moves during 60 ticks out of 100
+		const bool moving = tick%100<60;
+		if (moving)
+		{
+			azimuth += 0.01*random.next();
+			altitude += 0.002*(random.next()-0.5);
+		}
+		// A jump, which cannot be sent as a difference
+		if (tick==250)
+			azimuth += 2.0;
+		if (tick%50<10)
+			fov *= 0.97;
+		const Vec3d view = toVector(azimuth, altitude);
+		encoder.setView(view);
+		encoder.setFov(fov);
+		if (tick%40==0)
+			encoder.setTime(1000+tick, 2457000.5+tick, tick%80 ? 1.0 : 0.0);
+		if (tick%7==0)
+		{
+			// Only the last value of a frame is sent
+			const QString id = QString("Module%1.flag").arg(tick%5);
+			encoder.setProperty(id, tick%3!=0);
+			encoder.setProperty(id, tick%3==0);
+			expected[id] = tick%3==0;
+		}
+		if (tick%11==0)
+		{
+			encoder.setProperty("LandscapeMgr.currentLandscapeID", QString("landscape%1").arg(tick%4));
+			expected["LandscapeMgr.currentLandscapeID"] = QString("landscape%1").arg(tick%4);
+		}
+		if (tick%13==0)
+		{
+			encoder.setProperty("StelSkyDrawer.absoluteStarScale", 0.5*tick);
+			expected["StelSkyDrawer.absoluteStarScale"] = 0.5*tick;
+		}
+
+		const QList<QByteArray> payloads = encoder.encodeFrame(16*tick);
+		if (payloads.isEmpty())
+		{
+			++emptyFrames;
+			continue;
+		}
+		QCOMPARE(payloads.size(), 1);
+		QVERIFY(decoder.decode(payloads.first(), frame));
+		++frames;
+		QCOMPARE(frame.sequence, encoder.getSequence());
+		QCOMPARE(frame.serverTime, qint64(16*tick));
+		if (frame.has(SyncStateFrame::ViewDelta))
+			++viewDeltaFrames;
+		if (tick==250)
+			QVERIFY(frame.has(SyncStateFrame::View) && !frame.has(SyncStateFrame::ViewDelta));
+		// After the motion stopped, the view is sent once more
+		if (tick%100>61)
+			QVERIFY(!frame.has(SyncStateFrame::View));
+		for (int i=0; i<3; ++i)
+			QVERIFY(std::fabs(frame.state.viewAltAz[i]-view[i]) <= SyncStateEncoder::Tolerance);
+		QVERIFY(std::fabs(frame.state.fov-fov) <= SyncStateEncoder::Tolerance*fov);
+		if (frame.has(SyncStateFrame::Time))
+		{
+			QCOMPARE(frame.state.lastTimeSyncTime, qint64(1000+tick));
+			QCOMPARE(frame.state.jDay, 2457000.5+tick);
+		}
+		for (int i=0; i<frame.properties.size(); ++i)
+			received[frame.properties.at(i).first] = frame.properties.at(i).second;
+	}
+	QCOMPARE(received, expected);
+	QVERIFY(viewDeltaFrames>frames/2);
+	QVERIFY(emptyFrames>0);
+}
+
+void TestRemoteSync::testKeyFrame()
+{
+	SyncStateEncoder encoder;
+	SyncStateDecoder first, second;
+	SyncStateFrame frame;
+	QVERIFY(first.decode(encoder.encodeKeyFrame(0).first(), frame));
+
+	QMap<QString, QVariant> firstProperties, secondProperties;
+	encoder.setTime(1000, 2457000.5, 1.0);
+	for (int tick=0; tick<200; ++tick)
+	{
+		if (tick==100)
+		{
+			// A new client, between two frames
+			QVERIFY(second.decode(encoder.encodeKeyFrame(16*tick).first(), frame));
+			QVERIFY(frame.has(SyncStateFrame::KeyFrame));
+			QVERIFY(frame.has(SyncStateFrame::Time));
+			QVERIFY(second.getState().viewAltAz==first.getState().viewAltAz);
+			QCOMPARE(second.getState().fov, first.getState().fov);
+			for (int i=0; i<frame.properties.size(); ++i)
+				secondProperties[frame.properties.at(i).first] = frame.properties.at(i).second;
+			QCOMPARE(secondProperties, firstProperties);
+		}
+
+		encoder.setView(toVector(0.003*tick, 0.5));
+		encoder.setFov(30.0 + 0.1*tick);
+		encoder.setProperty(QString("Module%1.value").arg(tick%9), tick);
+		const QList<QByteArray> payloads = encoder.encodeFrame(16*tick);
+		QCOMPARE(payloads.size(), 1);
+		const QByteArray& payload = payloads.first();
+		QVERIFY(first.decode(payload, frame));
+		for (int i=0; i<frame.properties.size(); ++i)
+			firstProperties[frame.properties.at(i).first] = frame.properties.at(i).second;
+		if (tick>=100)
+		{
+			QVERIFY(second.decode(payload, frame));
+			for (int i=0; i<frame.properties.size(); ++i)
+				secondProperties[frame.properties.at(i).first] = frame.properties.at(i).second;
+		}
+	}
+
+	// Both clients have exactly the same values
+	QVERIFY(second.getState().viewAltAz==first.getState().viewAltAz);
+	QCOMPARE(second.getState().fov, first.getState().fov);
+	QCOMPARE(second.getState().jDay, first.getState().jDay);
+	QCOMPARE(secondProperties, firstProperties);
+}
+
+void TestRemoteSync::testContinuedFrames()
+{
+	// Small messages, so that the properties of a frame need several of them
+	const int MaxPayloadSize = 200;
+	SyncStateEncoder encoder;
+	SyncStateDecoder decoder;
+	SyncStateFrame frame;
+	QVERIFY(decoder.decode(encoder.encodeKeyFrame(0, MaxPayloadSize).first(), frame));
+
+	QMap<QString, QVariant> expected, received;
+	encoder.setFov(60.0);
+	encoder.setTime(1000, 2457000.5, 1.0);
+	for (int i=0; i<20; ++i)
+	{
+		const QString id = QString("Module%1.text").arg(i);
+		expected[id] = QString(30+i, QChar('a'+i));
+		encoder.setProperty(id, expected[id]);
+	}
+	// A value which does not fit in a message is not sent
+	encoder.setProperty("Module.large", QString(MaxPayloadSize, QChar('x')));
+	QTest::ignoreMessage(QtWarningMsg, QRegularExpression("too large to be sent"));
+	const QList<QByteArray> payloads = encoder.encodeFrame(16, MaxPayloadSize);
+	QVERIFY(payloads.size()>1);
+	for (int i=0; i<payloads.size(); ++i)
+	{
+		QVERIFY(payloads.at(i).size()<=MaxPayloadSize);
+		QVERIFY(decoder.decode(payloads.at(i), frame));
+		QCOMPARE(frame.sequence, encoder.getSequence());
+		QCOMPARE(frame.serverTime, qint64(16));
+		// Only the first part has the state
+		QCOMPARE(frame.has(SyncStateFrame::Continued), i>0);
+		QCOMPARE(frame.has(SyncStateFrame::Time), i==0);
+		QCOMPARE(frame.state.fov, 60.0);
+		for (int j=0; j<frame.properties.size(); ++j)
+			received[frame.properties.at(j).first] = frame.properties.at(j).second;
+	}
+	QCOMPARE(received, expected);
+
+	// A part only follows its frame
+	SyncStateDecoder other;
+	QVERIFY(!other.decode(payloads.last(), frame));
+	encoder.setFov(50.0);
+	const QList<QByteArray> next = encoder.encodeFrame(32, MaxPayloadSize);
+	QCOMPARE(next.size(), 1);
+	QVERIFY(decoder.decode(next.first(), frame));
+	QVERIFY(!decoder.decode(payloads.last(), frame));
+
+	// A new client gets all values in the parts of the key frame
+	QTest::ignoreMessage(QtWarningMsg, QRegularExpression("too large to be sent"));
+	const QList<QByteArray> keyFrame = encoder.encodeKeyFrame(48, MaxPayloadSize);
+	QVERIFY(keyFrame.size()>1);
+	received.clear();
+	foreach (const QByteArray& payload, keyFrame)
+	{
+		QVERIFY(payload.size()<=MaxPayloadSize);
+		QVERIFY(other.decode(payload, frame));
+		for (int j=0; j<frame.properties.size(); ++j)
+			received[frame.properties.at(j).first] = frame.properties.at(j).second;
+	}
+	QCOMPARE(received, expected);
+	QCOMPARE(other.getState().fov, 50.0);
+	QCOMPARE(other.getState().jDay, 2457000.5);
+}
+
+void TestRemoteSync::testInvalidFrames()
+{
+	SyncStateEncoder encoder;
+	encoder.setFov(10.0);
+	const QByteArray keyFrame = encoder.encodeKeyFrame(0).first();
+	encoder.setFov(20.0);
+	const QByteArray frame1 = encoder.encodeFrame(1).first();
+	encoder.setFov(30.0);
+	const QByteArray frame2 = encoder.encodeFrame(2).first();
+
+	SyncStateDecoder decoder;
+	SyncStateFrame frame;
+	QVERIFY(!decoder.decode(frame1, frame));
+	QVERIFY(decoder.decode(keyFrame, frame));
+	QVERIFY(!decoder.decode(frame2, frame));
+	QVERIFY(!decoder.decode(frame1.left(frame1.size()-1), frame));
+	QVERIFY(!decoder.decode(frame1 + QByteArray(1, '\0'), frame));
+	// The rejected frames did not change the state
+	QVERIFY(decoder.decode(frame1, frame));
+	QCOMPARE(frame.state.fov, 20.0);
+	QVERIFY(decoder.decode(frame2, frame));
+	QVERIFY(frame.has(SyncStateFrame::FovDelta));
+	QCOMPARE(frame.state.fov, 30.0);
+}
+
+void TestRemoteSync::testInterpolation()
+{
+	SyncStateInterpolator interpolator;
+	Vec3d view;
+	double fov;
+	QVERIFY(!interpolator.getState(0, view, fov));
+
+	// Frames every 20 ms, which arrive 5 ms later, for a rotation of 0.001 rad/ms and a zoom of 0.01 deg/ms
+	for (int i=0; i<=50; ++i)
+	{
+		const qint64 t = 20*i;
+		interpolator.addSample(1000+t, 1005+t, toVector(0.001*t, 0.0), 10.0+0.01*t);
+	}
+	QVERIFY(std::fabs(interpolator.getDelay()-25.0) < 1.0);
+
+	QVERIFY(interpolator.getState(1990, view, fov));
+	QVERIFY(std::fabs(std::atan2(view[1], view[0]) - 0.990) < 1e-6);
+	QVERIFY(std::fabs(fov - 19.90) < 1e-9);
+	QVERIFY(std::fabs(view.length() - 1.0) < 1e-12);
+
+	// After the last frame, the motion continues for at most MaxExtrapolation
+	QVERIFY(interpolator.getState(2100, view, fov));
+	QVERIFY(std::fabs(std::atan2(view[1], view[0]) - 1.1) < 1e-3);
+	QVERIFY(std::fabs(fov - 21.0) < 1e-9);
+	Vec3d limitView;
+	double limitFov;
+	QVERIFY(interpolator.getState(2000+SyncStateInterpolator::MaxExtrapolation, limitView, limitFov));
+	QVERIFY(interpolator.getState(5000, view, fov));
+	QVERIFY(view==limitView);
+	QCOMPARE(fov, limitFov);
+
+	// The motion stopped: the last values are repeated
+	interpolator.addSample(2020, 2025, toVector(1.0, 0.0), 20.0);
+	QVERIFY(interpolator.getState(2100, view, fov));
+	QVERIFY(std::fabs(std::atan2(view[1], view[0]) - 1.0) < 1e-12);
+	QCOMPARE(fov, 20.0);
+
+	// Before the first sample kept
+	QVERIFY(interpolator.getState(0, view, fov));
+	QVERIFY(std::fabs(fov - (10.0+0.01*(1000-20*(SyncStateInterpolator::MaxSamples-2)))) < 1e-9);
+}
+
+void TestRemoteSync::benchmarkLoopback()
+{
+	const int NrOfClients = 8;
+	const int NrOfTicks = 1200;
+	// The last client connects during the session, and starts with a key frame
+	const int LateClientTick = 600;
+
+	const quint16 port = getFreePort();
+	LoopbackServer server;
+	QVERIFY(server.start(port));
+	EncoderEventSender* sender = server.sender;
+	QVERIFY(sender);
+	SyncClient owner(SyncClient::NONE, QStringList());
+	QElapsedTimer timer;
+	timer.start();
+	QHash<quint32, qint64> sendTimes;
+
+	QList<LoopbackClient*> clients;
+	qint64 v1Bytes = 0;
+	double azimuth = 0.0, altitude = 0.3, fov = 60.0;
+	qint64 lastTimeSyncTime = 0;
+	for (int tick=0; tick<NrOfTicks; ++tick)
+	{
+		while (clients.size()<(tick<LateClientTick ? NrOfClients-1 : NrOfClients))
+		{
+			LoopbackClient* c = new LoopbackClient(&owner, port, &timer);
+			clients.append(c);
+			// Authenticated, with the key frame
+			QVERIFY(processEventsUntil(ReceivedMessages(c, 1)));
+		}
+
+		// A session at 60 frames per second: the view pans during 80 frames out of 120, and zooms
+		// during 20 of them. Some properties change every 15 frames, the time every 200 frames.
+		const qint64 serverTime = tick*16;
+		const bool moving = tick%120<80;
+		if (moving)
+		{
+			azimuth += 0.004;
+			altitude += 0.0005*std::sin(0.05*tick);
+			v1Bytes += SYNC_HEADER_SIZE + 24;
+		}
+		if (tick%120>=20 && tick%120<40)
+		{
+			fov *= 0.99;
+			v1Bytes += SYNC_HEADER_SIZE + 8;
+		}
+		sender->serverTime = serverTime;
+		sender->encoder.setView(toVector(azimuth, altitude));
+		sender->encoder.setFov(fov);
+		if (tick%200==0)
+		{
+			lastTimeSyncTime = serverTime;
+			sender->encoder.setTime(lastTimeSyncTime, 2457000.5+tick/86400., tick%400 ? 10.0 : 1.0);
+			v1Bytes += SYNC_HEADER_SIZE + 24;
+		}
+		if (tick%15==0)
+		{
+			sender->encoder.setProperty("StarMgr.flagStarsDisplayed", tick%30!=0);
+			sender->encoder.setProperty("StarMgr.flagStarsDisplayed", tick%30==0);
+			sender->encoder.setProperty("StelSkyDrawer.absoluteStarScale", 1.0+0.01*tick);
+			sender->encoder.setProperty("ConstellationMgr.linesDisplayed", tick%45==0);
+			v1Bytes += 2*getV1PropertySize("StarMgr.flagStarsDisplayed", true)
+				 + getV1PropertySize("StelSkyDrawer.absoluteStarScale", 1.0)
+				 + getV1PropertySize("ConstellationMgr.linesDisplayed", true);
+		}
+
+		const int serverFrames = sender->frames;
+		const qint64 sendTime = timer.nsecsElapsed();
+		server.update();
+		if (sender->frames==serverFrames)
+			continue;
+		sendTimes.insert(sender->encoder.getSequence(), sendTime);
+		QVERIFY(processEventsUntil(ReceivedFrame(clients, sender->encoder.getSequence())));
+	}
+
+	double sum = 0.0, sumOfSquares = 0.0, maxLatency = 0.0;
+	int count = 0;
+	const Vec3d finalView = toVector(azimuth, altitude);
+	foreach (LoopbackClient* c, clients)
+	{
+		// All clients decoded the same values
+		const SyncState& state = c->recorder.decoder.getState();
+		QVERIFY(state.viewAltAz==clients.first()->recorder.decoder.getState().viewAltAz);
+		QCOMPARE(state.fov, clients.first()->recorder.decoder.getState().fov);
+		QCOMPARE(state.lastTimeSyncTime, lastTimeSyncTime);
+		for (int i=0; i<3; ++i)
+			QVERIFY(std::fabs(state.viewAltAz[i]-finalView[i]) <= SyncStateEncoder::Tolerance);
+		QVERIFY(std::fabs(state.fov-fov) <= SyncStateEncoder::Tolerance*fov);
+		for (QHash<quint32, qint64>::const_iterator it=c->recorder.arrivalTimes.constBegin(); it!=c->recorder.arrivalTimes.constEnd(); ++it)
+		{
+			const double latency = (it.value()-sendTimes.value(it.key()))/1000.0;
+			sum += latency;
+			sumOfSquares += latency*latency;
+			maxLatency = qMax(maxLatency, latency);
+			++count;
+		}
+	}
+	QCOMPARE(clients.first()->recorder.frames, sender->frames);
+	QVERIFY(clients.last()->recorder.frames<sender->frames);
+
+	const double meanLatency = sum/count;
+	const double jitter = std::sqrt(qMax(0.0, sumOfSquares/count - meanLatency*meanLatency));
+	qDebug() << "Loopback benchmark:" << clients.size() << "clients," << NrOfTicks << "ticks," << sender->frames << "state frames";
+	qDebug() << "  bytes per client: previous protocol" << v1Bytes << ", state frames" << sender->bytes
+		 << QString("(%1%)").arg(100.0*sender->bytes/v1Bytes, 0, 'f', 1);
+	qDebug() << "  latency: mean" << meanLatency << "us, jitter" << jitter << "us, max" << maxLatency << "us";
+	QVERIFY(sender->bytes<v1Bytes);
+
+	qDeleteAll(clients);
+}
@@ -0,0 +1,244 @@
+/*
+ * Stellarium
+ * Copyright (C) 2017 Stellarium Developers
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Suite 500, Boston, MA  02110-1335, USA.
+ */
+
+#include <QObject>
+#include <QtDebug>
+#include <QtTest>
+#include <cmath>
+
+#include "tests/testSatellitePasses.hpp"
+#include "SatellitePasses.hpp"
+#include "gsatellite/stdsat.h"
+#include "gsatellite/mathUtils.hpp"
+
+QTEST_GUILESS_MAIN(TestSatellitePasses)
+
+// Start of the time windows, a few days after the epoch of the elements below
+static const double START_JD = 2457900.0;
+
+static SatellitePassPredictor::Elements makeElements(const QString& id, const char* tle1, const char* tle2)
+{
+	SatellitePassPredictor::Elements e;
+	e.id = id;
+	e.name = id;
+	e.tle1 = tle1;
+	e.tle2 = tle2;
+	return e;
+}
+
+// A low orbit, and two eccentric orbits whose passes last hours and may have several local maxima of elevation.
+static SatellitePassPredictor::Elements iss()
+{
+	return makeElements("25544", "1 25544U 98067A   17146.57350904  .00001688  00000-0  32974-4 0  9994",
+				     "2 25544  51.6413 146.0488 0005140 194.6814 258.0121 15.53931367 58393");
+}
+
+static SatellitePassPredictor::Elements molniya129()
+{
+	return makeElements("07780", "1 07780U 75036A   17146.01115490  .00000145  00000-0 -44359-3 0  9992",
+				     "2 07780  61.6378 136.2027 7349115 272.4653  13.4238  2.00698936308538");
+}
+
+static SatellitePassPredictor::Elements molniya186()
+{
+	return makeElements("22671", "1 22671U 93035A   17146.49073786  .00000055  00000-0  35382-4 0  9996",
+				     "2 22671  63.0139 228.2896 4895744 339.0650   6.4164  5.62528284248339");
+}
+
+// Elevation of the satellite in degrees, with the topocentric coordinates of Orbital Coordinate Systems, Part II (T.S. Kelso)
+static double elevation(gSatTEME& satellite, const SatellitePassPredictor::Observer& observer, double jd)
+{
+	const gTime t(jd);
+	satellite.setEpoch(t);
+	const gVector p = satellite.getPos();
+	const double lat = observer.latitude*KDEG2RAD;
+	const double theta = t.toThetaLMST(observer.longitude*KDEG2RAD);
+	const double c = 1/std::sqrt(1 + __f*(__f - 2)*Sqr(std::sin(lat)));
+	const double sq = Sqr(1 - __f)*c;
+	const double r = (KEARTHRADIUS*c + observer.altitude/1000)*std::cos(lat);
+	const double dx = p[0] - r*std::cos(theta);
+	const double dy = p[1] - r*std::sin(theta);
+	const double dz = p[2] - (KEARTHRADIUS*sq + observer.altitude/1000)*std::sin(lat);
+	const double up = std::cos(lat)*std::cos(theta)*dx + std::cos(lat)*std::sin(theta)*dy + std::sin(lat)*dz;
+	return std::asin(up/std::sqrt(dx*dx + dy*dy + dz*dz))/KDEG2RAD;
+}
+
+void TestSatellitePasses::testSameAsSampling_data()
+{
+	QTest::addColumn<int>("satellite");
+	QTest::addColumn<double>("latitude");
+	QTest::addColumn<double>("longitude");
+	QTest::addColumn<double>("minElevation");
+
+	const char* names[] = {"ISS", "Molniya 1-29", "Molniya 1-86"};
+	for (int s=0; s<3; ++s)
+	{
+		QTest::newRow(qPrintable(QString("%1, Paris").arg(names[s]))) << s << 48.85 << 2.35 << 0.;
+		QTest::newRow(qPrintable(QString("%1, Cape Town").arg(names[s]))) << s << -33.9 << 18.4 << 0.;
+		QTest::newRow(qPrintable(QString("%1, Svalbard").arg(names[s]))) << s << 78.2 << 15.6 << 0.;
+		QTest::newRow(qPrintable(QString("%1, equator, above 10 deg").arg(names[s]))) << s << 0. << -60. << 10.;
+	}
+}
+
+void TestSatellitePasses::testSameAsSampling()
+{
+	QFETCH(int, satellite);
+	QFETCH(double, latitude);
+	QFETCH(double, longitude);
+	QFETCH(double, minElevation);
+
+	const SatellitePassPredictor::Elements elements = satellite==0 ? iss() : (satellite==1 ? molniya129() : molniya186());
+	const SatellitePassPredictor::Observer observer(latitude, longitude, 0.);
+	const double endJD = START_JD + 2.;
+	QList<SatellitePass> passes;
+	QVERIFY(SatellitePassPredictor::computePasses(elements, observer, START_JD, endJD, minElevation, passes));
+
+	// Passes found by sampling the elevation every 2 seconds
+	struct SampledPass { double aos, los, maxElevation; };
+	QVector<SampledPass> sampled;
+	QByteArray t1(elements.tle1), t2(elements.tle2);
+	gSatTEME orbit("test", t1.data(), t2.data());
+	const double step = 2./86400.;
+	bool above = false;
+	for (double jd=START_JD; jd<=endJD; jd+=step)
+	{
+		const double el = elevation(orbit, observer, jd);
+		if (el>=minElevation)
+		{
+			if (!above)
+			{
+				SampledPass p = {jd, jd, el};
+				sampled.append(p);
+				above = true;
+			}
+			sampled.last().los = jd;
+			sampled.last().maxElevation = qMax(sampled.last().maxElevation, el);
+		}
+		else
+			above = false;
+	}
+
+	QCOMPARE(passes.size(), sampled.size());
+	for (int i=0; i<passes.size(); ++i)
+	{
+		const SatellitePass& pass = passes.at(i);
+		const SampledPass& expected = sampled.at(i);
+		QVERIFY2(qAbs(pass.aos-expected.aos)<=1.5*step && qAbs(pass.los-expected.los)<=1.5*step,
+			 qPrintable(QString("pass %1: AOS %2 s, LOS %3 s from the sampling").arg(i)
+				    .arg((pass.aos-expected.aos)*86400.).arg((pass.los-expected.los)*86400.)));
+		// The closest approach is the highest point of the whole pass, not only of its first local maximum.
+		QVERIFY2(pass.maxElevation>=expected.maxElevation-1e-3 && pass.maxElevation<=expected.maxElevation+0.1,
+			 qPrintable(QString("pass %1: maximum elevation %2 instead of %3").arg(i).arg(pass.maxElevation).arg(expected.maxElevation)));
+		QVERIFY(pass.aos<=pass.tca && pass.tca<=pass.los);
+		QVERIFY(pass.aosAzimuth>=0. && pass.aosAzimuth<360.);
+		if (i>0)
+			QVERIFY(passes.at(i-1).los<pass.aos);
+	}
+}
+
+void TestSatellitePasses::testWindowCut()
+{
+	// Molniya 1-29 is above the horizon of Cape Town at the start of the window.
+	const SatellitePassPredictor::Elements elements = molniya129();
+	const SatellitePassPredictor::Observer observer(-33.9, 18.4, 0.);
+	QByteArray t1(elements.tle1), t2(elements.tle2);
+	gSatTEME orbit("test", t1.data(), t2.data());
+	QVERIFY(elevation(orbit, observer, START_JD)>0.);
+
+	QList<SatellitePass> passes;
+	QVERIFY(SatellitePassPredictor::computePasses(elements, observer, START_JD, START_JD+1., 0., passes));
+	QVERIFY(!passes.isEmpty());
+	QCOMPARE(passes.first().aos, START_JD);
+	QVERIFY(passes.first().maxElevation>=elevation(orbit, observer, START_JD)-1e-3);
+
+	// The same pass cut at the end of the window
+	const double end = passes.first().aos + 0.5*(passes.first().los-passes.first().aos);
+	QList<SatellitePass> cut;
+	QVERIFY(SatellitePassPredictor::computePasses(elements, observer, START_JD, end, 0., cut));
+	QCOMPARE(cut.size(), 1);
+	QCOMPARE(cut.first().los, end);
+}
+
+void TestSatellitePasses::testInvalidElements()
+{
+	QList<SatellitePass> passes;
+	const SatellitePassPredictor::Observer observer(48.85, 2.35, 0.);
+	// No mean motion
+	SatellitePassPredictor::Elements elements = makeElements("1", "1 25544U 98067A   17146.57350904  .00001688  00000-0  32974-4 0  9994",
+								  "2 25544  51.6413 146.0488 0005140 194.6814 258.0121  0.00000000 58393");
+	QVERIFY(!SatellitePassPredictor::computePasses(elements, observer, START_JD, START_JD+1., 0., passes));
+	QVERIFY(passes.isEmpty());
+	// Perigee below the surface of the Earth
+	elements.tle2 = "2 25544  51.6413 146.0488 9905140 194.6814 258.0121 15.53931367 58393";
+	QVERIFY(!SatellitePassPredictor::computePasses(elements, observer, START_JD, START_JD+1., 0., passes));
+	QVERIFY(passes.isEmpty());
+	// Empty window
+	QVERIFY(!SatellitePassPredictor::computePasses(iss(), observer, START_JD, START_JD, 0., passes));
+}
+
+void TestSatellitePasses::testPredictor()
+{
+	SatellitePassPredictor predictor;
+	QList<SatellitePassPredictor::Elements> satellites;
+	satellites << iss() << molniya129() << molniya186();
+	const SatellitePassPredictor::Observer observer(48.85, 2.35, 0.);
+
+	const QList<SatellitePass> passes = predictor.predict(satellites, observer, START_JD, START_JD+1., 0.);
+	QVERIFY(!passes.isEmpty());
+	int count = 0;
+	foreach (const SatellitePassPredictor::Elements& e, satellites)
+	{
+		QList<SatellitePass> own;
+		QVERIFY(SatellitePassPredictor::computePasses(e, observer, START_JD, START_JD+1., 0., own));
+		count += own.size();
+	}
+	QCOMPARE(passes.size(), count);
+	for (int i=1; i<passes.size(); ++i)
+		QVERIFY(passes.at(i-1).tca<=passes.at(i).tca);
+
+	// A part of the window is served from the cache, with the passes of a computation of this window:
+	// the passes in progress at its start and end are cut there.
+	const double start = 0.5*(passes.first().aos + passes.first().los);
+	const double end = 0.5*(passes.last().aos + passes.last().los);
+	const QList<SatellitePass> part = predictor.predict(satellites, observer, start, end, 0.);
+	SatellitePassPredictor fresh;
+	const QList<SatellitePass> expected = fresh.predict(satellites, observer, start, end, 0.);
+	QCOMPARE(part.size(), expected.size());
+	bool cutAtStart = false, cutAtEnd = false;
+	for (int i=0; i<part.size(); ++i)
+	{
+		const SatellitePass& p = part.at(i);
+		const SatellitePass& e = expected.at(i);
+		QCOMPARE(p.id, e.id);
+		QVERIFY(p.aos>=start && p.los<=end && p.aos<=p.tca && p.tca<=p.los);
+		QVERIFY2(qAbs(p.aos-e.aos)<=2./86400. && qAbs(p.los-e.los)<=2./86400. && qAbs(p.tca-e.tca)<=5./86400.,
+			 qPrintable(QString("pass %1 of %2: AOS %3 s, TCA %4 s, LOS %5 s from the computation of the window").arg(i).arg(p.id)
+				    .arg((p.aos-e.aos)*86400.).arg((p.tca-e.tca)*86400.).arg((p.los-e.los)*86400.)));
+		QVERIFY(qAbs(p.maxElevation-e.maxElevation)<=1e-2);
+		cutAtStart = cutAtStart || p.aos==start;
+		cutAtEnd = cutAtEnd || p.los==end;
+	}
+	QVERIFY(cutAtStart && cutAtEnd);
+
+	// Another observer is computed again.
+	const QList<SatellitePass> other = predictor.predict(satellites, SatellitePassPredictor::Observer(-33.9, 18.4, 0.), START_JD, START_JD+1., 0.);
+	QVERIFY(other.isEmpty() || other.first().tca!=passes.first().tca);
+	predictor.clear();
+	QCOMPARE(predictor.predict(satellites, observer, START_JD, START_JD+1., 0.).size(), passes.size());
+}
@@ -0,0 +1,212 @@
+/*
+ * Stellarium
+ * Copyright (C) 2017 Stellarium Developers
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Suite 500, Boston, MA  02110-1335, USA.
+ */
+
+#include <QObject>
+#include <QtDebug>
+#include <QtTest>
+
+#include <cmath>
+
+#include "tests/testSkybright.hpp"
+#include "AtmosphereGrid.hpp"
+
+QTEST_GUILESS_MAIN(TestSkybright)
+
+static const float DEG = static_cast<float>(M_PI)/180.f;
+
+// Same parameters as the reference values of testSameAsBaseline()
+static void setParameters(Skybright& skyb, float sunAlt, float moonAlt, float moonMag)
+{
+	skyb.setLocation(static_cast<float>(45.*M_PI/180.), 200.f, 15.f, 40.f);
+	skyb.setDate(2017, 6, 1.f, moonMag);
+	skyb.setSunMoon(std::sin(moonAlt*DEG), std::sin(sunAlt*DEG));
+}
+
+void TestSkybright::initTestCase()
+{
+	// Sun 10 degrees below the horizon, Moon 30 degrees above: all terms of the model contribute.
+	setParameters(skyb, -10.f, 30.f, -10.f);
+	sunPos.set(std::cos(-10.f*DEG), 0.f, std::sin(-10.f*DEG));
+	moonPos.set(std::cos(30.f*DEG)*std::cos(2.f), std::cos(30.f*DEG)*std::sin(2.f), std::sin(30.f*DEG));
+}
+
+void TestSkybright::makeGrid(int nbPoints, bool fullSphere)
+{
+	directions.resize(nbPoints);
+	cosDistMoon.resize(nbPoints);
+	cosDistSun.resize(nbPoints);
+	cosDistZenith.resize(nbPoints);
+	for (int i=0; i<nbPoints; ++i)
+	{
+		// Points spread over the upper hemisphere, as the mirrored atmosphere grid
+		const float alt = (fullSphere ? static_cast<float>(M_PI)*(i%97)/97.f - 0.5f*static_cast<float>(M_PI)
+					      : 0.5f*static_cast<float>(M_PI)*(i%97)/97.f);
+		const float az = 2.f*static_cast<float>(M_PI)*(i%389)/389.f;
+		const Vec3f dir(std::cos(alt)*std::cos(az), std::cos(alt)*std::sin(az), std::sin(alt));
+		directions[i].set(dir[0], dir[1], dir[2]);
+		cosDistSun[i] = sunPos.dot(dir);
+		cosDistMoon[i] = moonPos.dot(dir);
+		cosDistZenith[i] = dir[2];
+	}
+}
+
+// Luminances computed with Skybright::getLuminance() before it was split for getLuminances(),
+// when the moonlight and night sky terms were only computed when they contribute.
+void TestSkybright::testSameAsBaseline_data()
+{
+	QTest::addColumn<float>("sunAlt");
+	QTest::addColumn<float>("moonAlt");
+	QTest::addColumn<float>("moonMag");
+	QTest::addColumn<float>("alt");
+	QTest::addColumn<float>("az");
+	QTest::addColumn<float>("expected");
+	QTest::newRow("day, zenith") << 30.f << 20.f << -10.f << 90.f << 0.f << 2565.84229f;
+	QTest::newRow("day, horizon sunward") << 30.f << 20.f << -10.f << 0.5f << 0.f << 15259.6807f;
+	QTest::newRow("day, low") << 30.f << 20.f << -10.f << 5.f << 1.f << 9692.52344f;
+	QTest::newRow("day, anti-sun") << 30.f << 20.f << -10.f << 45.f << static_cast<float>(M_PI) << 2971.10132f;
+	QTest::newRow("day, near moon") << 30.f << 20.f << -10.f << 21.f << 2.f << 4828.25781f;
+	QTest::newRow("day, moon") << 30.f << 20.f << -10.f << 20.f << 2.f << 4978.10156f;
+	QTest::newRow("twilight, zenith") << -10.f << 30.f << -10.f << 90.f << 0.f << 0.0157167464f;
+	QTest::newRow("twilight, horizon sunward") << -10.f << 30.f << -10.f << 0.5f << 0.f << 0.583820581f;
+	QTest::newRow("twilight, low") << -10.f << 30.f << -10.f << 5.f << 1.f << 0.168101877f;
+	QTest::newRow("twilight, anti-sun") << -10.f << 30.f << -10.f << 45.f << static_cast<float>(M_PI) << 0.0182581134f;
+	QTest::newRow("twilight, near moon") << -10.f << 30.f << -10.f << 31.f << 2.f << 0.062958993f;
+	QTest::newRow("twilight, moon") << -10.f << 30.f << -10.f << 30.f << 2.f << 0.0828432813f;
+	QTest::newRow("night full moon, zenith") << -30.f << 40.f << -12.7f << 90.f << 0.f << 0.00710600335f;
+	QTest::newRow("night full moon, horizon sunward") << -30.f << 40.f << -12.7f << 0.5f << 0.f << 0.0206731092f;
+	QTest::newRow("night full moon, low") << -30.f << 40.f << -12.7f << 5.f << 1.f << 0.0224831905f;
+	QTest::newRow("night full moon, anti-sun") << -30.f << 40.f << -12.7f << 45.f << static_cast<float>(M_PI) << 0.00981862564f;
+	QTest::newRow("night full moon, near moon") << -30.f << 40.f << -12.7f << 41.f << 2.f << 0.360204488f;
+	QTest::newRow("night full moon, moon") << -30.f << 40.f << -12.7f << 40.f << 2.f << 0.57216388f;
+	QTest::newRow("night no moon, zenith") << -30.f << -20.f << -10.f << 90.f << 0.f << 0.000196633613f;
+	QTest::newRow("night no moon, horizon sunward") << -30.f << -20.f << -10.f << 0.5f << 0.f << 8.58318714e-08f;
+	QTest::newRow("night no moon, low") << -30.f << -20.f << -10.f << 5.f << 1.f << 4.06184081e-05f;
+	QTest::newRow("night no moon, anti-sun") << -30.f << -20.f << -10.f << 45.f << static_cast<float>(M_PI) << 0.000214657819f;
+	QTest::newRow("night no moon, near moon") << -30.f << -20.f << -10.f << -19.f << 2.f << 0.000268120901f;
+	QTest::newRow("night no moon, moon") << -30.f << -20.f << -10.f << -20.f << 2.f << 0.000297506136f;
+}
+
+void TestSkybright::testSameAsBaseline()
+{
+	QFETCH(float, sunAlt);
+	QFETCH(float, moonAlt);
+	QFETCH(float, moonMag);
+	QFETCH(float, alt);
+	QFETCH(float, az);
+	QFETCH(float, expected);
+
+	Skybright sb;
+	setParameters(sb, sunAlt, moonAlt, moonMag);
+	const float x = std::cos(alt*DEG)*std::cos(az);
+	const float y = std::cos(alt*DEG)*std::sin(az);
+	const float z = std::sin(alt*DEG);
+	const float moonAz = 2.f;
+	const float cosSun = std::cos(sunAlt*DEG)*x + std::sin(sunAlt*DEG)*z;
+	const float cosMoon = std::cos(moonAlt*DEG)*(std::cos(moonAz)*x+std::sin(moonAz)*y) + std::sin(moonAlt*DEG)*z;
+
+	const float single = sb.getLuminance(cosMoon, cosSun, z);
+	QVERIFY2(std::fabs(single-expected) <= 1e-4f*expected, qPrintable(QString("getLuminance: %1 instead of %2").arg(single).arg(expected)));
+
+	// The same position in a batch
+	const int n = 64;
+	QVector<float> cosMoons(n, cosMoon), cosSuns(n, cosSun), cosZeniths(n, z), lum(n);
+	sb.getLuminances(cosMoons.constData(), cosSuns.constData(), cosZeniths.constData(), lum.data(), n);
+	for (int i=0; i<n; ++i)
+		QVERIFY2(std::fabs(lum.at(i)-expected) <= 1e-4f*expected, qPrintable(QString("getLuminances: %1 instead of %2").arg(lum.at(i)).arg(expected)));
+}
+
+// AtmosphereGrid gives the same luminances as the loop of Atmosphere::computeColor() calling getLuminance() for each point.
+void TestSkybright::testAtmosphereGrid()
+{
+	makeGrid(3*AtmosphereGrid::PointsPerJob+100, true);
+	AtmosphereGrid grid;
+	grid.resize(directions.size());
+	for (int i=0; i<directions.size(); ++i)
+	{
+		grid.setDirection(i, directions.at(i));
+		QVERIFY(grid.hasDirection(i, directions.at(i)));
+	}
+	const float eclipseFactor = 0.5f;
+	const float lightPollutionLuminance = 0.002f;
+	QVector<Vec4f> colors(grid.size());
+	const float average = grid.computeLuminances(skyb, sunPos, moonPos, true, eclipseFactor, lightPollutionLuminance, colors.data());
+
+	double sum = 0.;
+	for (int i=0; i<directions.size(); ++i)
+	{
+		// Same float arithmetic as the grid, with the sky below the ground mirrored for the Moon only
+		const Vec3d& dir = directions.at(i);
+		const float mirror = dir[2]<=0 ? -1.f : 1.f;
+		const Vec3f point(dir[0], dir[1], dir[2]<=0 ? -dir[2] : dir[2]);
+		float lumi = skyb.getLuminance(moonPos[0]*point[0]+moonPos[1]*point[1]+mirror*moonPos[2]*point[2],
+					       sunPos[0]*point[0]+sunPos[1]*point[1]+sunPos[2]*point[2], point[2]);
+		lumi = lumi*eclipseFactor + 0.0001f + lightPollutionLuminance;
+		sum += lumi;
+		const Vec4f& c = colors.at(i);
+		QVERIFY2(std::fabs(c[0]-point[0])<1e-6 && std::fabs(c[1]-point[1])<1e-6 && std::fabs(c[2]-point[2])<1e-6,
+			 qPrintable(QString("point %1: direction differs").arg(i)));
+		QVERIFY2(std::fabs(c[3]-lumi) <= 1e-4f*lumi, qPrintable(QString("point %1: luminance %2 instead of %3").arg(i).arg(c[3]).arg(lumi)));
+	}
+	QVERIFY(std::fabs(average-sum/directions.size()) <= 1e-4*average);
+
+	// Without Sun and Moon, only the background remains
+	const float background = grid.computeLuminances(skyb, sunPos, moonPos, false, eclipseFactor, lightPollutionLuminance, colors.data());
+	QVERIFY(std::fabs(background-(0.0001f+lightPollutionLuminance)) < 1e-6f);
+}
+
+void TestSkybright::benchmarkLuminances_data()
+{
+	QTest::addColumn<int>("resolutionX");
+	QTest::addColumn<int>("resolutionY");
+	QTest::newRow("64x48") << 64 << 48;
+	QTest::newRow("256x192") << 256 << 192;
+	QTest::newRow("1024x768") << 1024 << 768;
+}
+
+void TestSkybright::benchmarkLuminances()
+{
+	QFETCH(int, resolutionX);
+	QFETCH(int, resolutionY);
+	makeGrid((1+resolutionX)*(1+resolutionY));
+	QVector<float> lum(cosDistZenith.size());
+	QBENCHMARK {
+		skyb.getLuminances(cosDistMoon.constData(), cosDistSun.constData(), cosDistZenith.constData(), lum.data(), lum.size());
+	}
+}
+
+// The work of Atmosphere::computeColor() for each frame in which the Sun or Moon moved
+void TestSkybright::benchmarkAtmosphereGrid_data()
+{
+	benchmarkLuminances_data();
+}
+
+void TestSkybright::benchmarkAtmosphereGrid()
+{
+	QFETCH(int, resolutionX);
+	QFETCH(int, resolutionY);
+	makeGrid((1+resolutionX)*(1+resolutionY), true);
+	AtmosphereGrid grid;
+	grid.resize(directions.size());
+	for (int i=0; i<directions.size(); ++i)
+		grid.setDirection(i, directions.at(i));
+	QVector<Vec4f> colors(grid.size());
+	QBENCHMARK {
+		grid.computeLuminances(skyb, sunPos, moonPos, true, 1.f, 0.f, colors.data());
+	}
+}
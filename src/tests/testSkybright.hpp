@@ -0,0 +1,53 @@
+/*
+ * Stellarium
+ * Copyright (C) 2017 Stellarium Developers
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Suite 500, Boston, MA  02110-1335, USA.
+ */
+
+#ifndef _TESTSKYBRIGHT_HPP_
+#define _TESTSKYBRIGHT_HPP_
+
+#include <QObject>
+#include <QtTest>
+#include <QVector>
+
+#include "Skybright.hpp"
+#include "VecMath.hpp"
+
+class TestSkybright : public QObject
+{
+	Q_OBJECT
+private slots:
+	void initTestCase();
+	void testSameAsBaseline_data();
+	void testSameAsBaseline();
+	void testAtmosphereGrid();
+	void benchmarkLuminances_data();
+	void benchmarkLuminances();
+	void benchmarkAtmosphereGrid_data();
+	void benchmarkAtmosphereGrid();
+private:
+	//! Fill the directions and direction cosines of a grid of nbPoints points over the sky,
+	//! below the horizon as well if fullSphere is true.
+	void makeGrid(int nbPoints, bool fullSphere=false);
+
+	Skybright skyb;
+	Vec3f sunPos, moonPos;
+	QVector<Vec3d> directions;
+	QVector<float> cosDistMoon, cosDistSun, cosDistZenith;
+};
+
+#endif // _TESTSKYBRIGHT_HPP_
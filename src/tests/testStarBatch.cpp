@@ -0,0 +1,223 @@
+/*
+ * Stellarium
+ * Copyright (C) 2017 Stellarium Developers
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Suite 500, Boston, MA  02110-1335, USA.
+ */
+
+#include <QObject>
+#include <QtDebug>
+#include <QtTest>
+#include <QtEndian>
+
+#include <cstring>
+#include <cmath>
+
+#include "tests/testStarBatch.hpp"
+#include "StarBatch.hpp"
+
+QTEST_GUILESS_MAIN(TestStarBatch)
+
+#define NB_STARS 50000
+#define POSITION_SCALE 1e-9f
+
+//! A star which passed culling, with its extinction.
+struct CulledStar
+{
+	int index;
+	Vec3f pos;
+	float extMagShift;
+};
+
+static Star1 makeStar1(int x0, int x1, int dx0, int dx1, int mag, int bV)
+{
+	uchar d[28];
+	std::memset(d, 0, sizeof(d));
+	qToLittleEndian<qint32>(x0, d+4);
+	qToLittleEndian<qint32>(x1, d+8);
+	d[12] = (uchar)bV;
+	d[13] = (uchar)mag;
+	qToLittleEndian<qint32>(dx0, d+16);
+	qToLittleEndian<qint32>(dx1, d+20);
+	Star1 s;
+	std::memcpy(&s, d, sizeof(s));
+	return s;
+}
+
+// The scalar loop of SpecialZoneArray<Star>::draw() for a border zone, without the drawing.
+static void perStarLoop(const ZoneData& z, const QVector<Star1>& stars, int cutoffMagStep, float movementFactor,
+			const QVector<SphericalCap>& caps, const Mat4d& j2000ToAltAz, const Extinction& extinction,
+			QVector<CulledStar>& result)
+{
+	Vec3f vf;
+	for (int i=0;i<stars.size();++i)
+	{
+		const Star1* s = stars.constData()+i;
+		if (s->getMag() > cutoffMagStep)
+			break;
+		s->getJ2000Pos(&z, movementFactor, vf);
+		vf.normalize();
+		bool isVisible = true;
+		foreach (const SphericalCap& cap, caps)
+		{
+			if (!cap.contains(vf))
+				isVisible = false;
+		}
+		if (!isVisible)
+			continue;
+
+		Vec3f altAz(vf);
+		altAz.normalize();
+		altAz.transfo4d(j2000ToAltAz);
+		float extMagShift=0.0f;
+		extinction.forward(altAz, &extMagShift);
+		CulledStar c = {i, vf, extMagShift};
+		result.append(c);
+	}
+}
+
+// The same with StarBatch, as in SpecialZoneArray<Star>::collectVisibleStars().
+static void batchedLoop(const ZoneData& z, const QVector<Star1>& stars, int cutoffMagStep, float movementFactor,
+			const QVector<SphericalCap>& caps, const Mat4d& j2000ToAltAz, const Extinction& extinction,
+			QVector<CulledStar>& result)
+{
+	StarBatch batch;
+	const Star1* s = stars.constData();
+	const Star1* lastStar = s + stars.size();
+	while (s<lastStar && !batch.reachedCutoff)
+	{
+		const int n = batch.decode(&z, s, (int)(lastStar-s), cutoffMagStep, movementFactor);
+		batch.cull(caps);
+		batch.extinct(j2000ToAltAz, extinction);
+		for (int i=0;i<n;++i)
+		{
+			if (!batch.visible[i])
+				continue;
+			CulledStar c = {(int)(s-stars.constData())+i, Vec3f(batch.px[i], batch.py[i], batch.pz[i])*batch.invLen[i], batch.extMagShift[i]};
+			result.append(c);
+		}
+		s += n;
+	}
+}
+
+void TestStarBatch::initTestCase()
+{
+	// A zone of about 2 degrees around (1,0,0), as scaled by SpecialZoneArray::scaleAxis()
+	zone.center.set(1.f, 0.f, 0.f);
+	zone.axis0.set(0.f, POSITION_SCALE, 0.f);
+	zone.axis1.set(0.f, 0.f, POSITION_SCALE);
+	zone.size = NB_STARS;
+	zone.stars = Q_NULLPTR;
+
+	// Stars sorted by magnitude as in the catalogues, with proper motions of up to 1"/yr
+	qsrand(1);
+	stars.reserve(NB_STARS);
+	for (int i=0;i<NB_STARS;++i)
+	{
+		const int x0 = (qrand()%40001 - 20000)*1000;
+		const int x1 = (qrand()%40001 - 20000)*1000;
+		const int dx0 = qrand()%20001 - 10000;
+		const int dx1 = qrand()%20001 - 10000;
+		stars.append(makeStar1(x0, x1, dx0, dx1, i*256/NB_STARS, qrand()%128));
+	}
+
+	// 50 years after J2000
+	movementFactor = (M_PI/180.)*(0.0001/3600.) * 50. / POSITION_SCALE;
+	cutoffMagStep = 240;
+
+	// Two caps cutting through the zone, as for a border zone
+	caps << SphericalCap(Vec3d(std::cos(0.01), std::sin(0.01), 0.), std::cos(0.015));
+	caps << SphericalCap(Vec3d(std::cos(0.005), 0., -std::sin(0.005)), std::cos(0.02));
+
+	j2000ToAltAz = Mat4d::xrotation(0.4) * Mat4d::yrotation(-1.1);
+	extinction.setExtinctionCoefficient(0.2f);
+}
+
+void TestStarBatch::testBatchSameAsPerStar()
+{
+	QVector<CulledStar> expected, actual;
+	perStarLoop(zone, stars, cutoffMagStep, movementFactor, caps, j2000ToAltAz, extinction, expected);
+	batchedLoop(zone, stars, cutoffMagStep, movementFactor, caps, j2000ToAltAz, extinction, actual);
+	QVERIFY(expected.size()>NB_STARS/10);
+	QVERIFY(expected.size()<NB_STARS*9/10);
+
+	// Both paths do the same float operations in a different order, so stars
+	// lying on the border of a cap may be culled by one path only.
+	int ie=0, ia=0, nbBorder=0;
+	while (ie<expected.size() && ia<actual.size())
+	{
+		const CulledStar& e = expected.at(ie);
+		const CulledStar& a = actual.at(ia);
+		if (e.index!=a.index)
+		{
+			++nbBorder;
+			if (e.index<a.index)
+				++ie;
+			else
+				++ia;
+			continue;
+		}
+		QVERIFY2(std::fabs(e.pos[0]-a.pos[0])<1e-6f && std::fabs(e.pos[1]-a.pos[1])<1e-6f && std::fabs(e.pos[2]-a.pos[2])<1e-6f,
+			 qPrintable(QString("star %1: position differs").arg(e.index)));
+		QVERIFY2(std::fabs(e.extMagShift-a.extMagShift)<1e-4f, qPrintable(QString("star %1: extinction %2 vs %3").arg(e.index).arg(e.extMagShift).arg(a.extMagShift)));
+		++ie;
+		++ia;
+	}
+	nbBorder += expected.size()-ie + actual.size()-ia;
+	QVERIFY2(nbBorder<=NB_STARS/10000, qPrintable(QString("%1 stars culled differently").arg(nbBorder)));
+}
+
+void TestStarBatch::benchmarkPerStar()
+{
+	QVector<CulledStar> result;
+	result.reserve(NB_STARS);
+	QBENCHMARK {
+		result.clear();
+		perStarLoop(zone, stars, cutoffMagStep, movementFactor, caps, j2000ToAltAz, extinction, result);
+	}
+}
+
+void TestStarBatch::benchmarkBatched()
+{
+	QVector<CulledStar> result;
+	result.reserve(NB_STARS);
+	QBENCHMARK {
+		result.clear();
+		batchedLoop(zone, stars, cutoffMagStep, movementFactor, caps, j2000ToAltAz, extinction, result);
+	}
+}
+
+// Zones inside the viewport are drawn without culling: the most common case when zoomed out.
+void TestStarBatch::benchmarkPerStarInside()
+{
+	const QVector<SphericalCap> noCaps;
+	QVector<CulledStar> result;
+	result.reserve(NB_STARS);
+	QBENCHMARK {
+		result.clear();
+		perStarLoop(zone, stars, cutoffMagStep, movementFactor, noCaps, j2000ToAltAz, extinction, result);
+	}
+}
+
+void TestStarBatch::benchmarkBatchedInside()
+{
+	const QVector<SphericalCap> noCaps;
+	QVector<CulledStar> result;
+	result.reserve(NB_STARS);
+	QBENCHMARK {
+		result.clear();
+		batchedLoop(zone, stars, cutoffMagStep, movementFactor, noCaps, j2000ToAltAz, extinction, result);
+	}
+}
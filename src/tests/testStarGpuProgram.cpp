@@ -0,0 +1,267 @@
+/*
+ * Stellarium
+ * Copyright (C) 2017 Stellarium Developers
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Suite 500, Boston, MA  02110-1335, USA.
+ */
+
+#include <QObject>
+#include <QtDebug>
+#include <QtTest>
+#include <QOffscreenSurface>
+#include <QOpenGLBuffer>
+#include <QOpenGLContext>
+#include <QOpenGLFramebufferObject>
+#include <QOpenGLFunctions>
+#include <QOpenGLTexture>
+
+#include <climits>
+#include <cmath>
+
+#include "tests/testStarGpuProgram.hpp"
+#include "StelProjectorClasses.hpp"
+
+QTEST_MAIN(TestStarGpuProgram)
+
+#define IMAGE_SIZE 256
+#define STAR_RADIUS 2.f
+
+static StaticStarVertex makeStar(const Vec3d& pos, int mag)
+{
+	StaticStarVertex v;
+	v.pos.set(pos[0], pos[1], pos[2]);
+	v.pm.set(0.f, 0.f, 0.f);
+	v.color[0] = v.color[1] = v.color[2] = 255;
+	v.mag = mag;
+	return v;
+}
+
+//! Sum of the red channel in a square around a position in window coordinates (y up),
+//! and the centroid of the lit pixels.
+static int sumAround(const QImage& image, const Vec3d& win, Vec2d* centroid=Q_NULLPTR)
+{
+	int sum = 0;
+	double cx = 0., cy = 0.;
+	const int x0 = (int)std::floor(win[0]);
+	const int y0 = (int)std::floor(win[1]);
+	for (int x=x0-6;x<=x0+6;++x)
+	{
+		for (int y=y0-6;y<=y0+6;++y)
+		{
+			if (x<0 || y<0 || x>=image.width() || y>=image.height())
+				continue;
+			// QOpenGLFramebufferObject::toImage() returns the rows top down
+			const int w = qRed(image.pixel(x, image.height()-1-y));
+			sum += w;
+			cx += w*(x+0.5);
+			cy += w*(y+0.5);
+		}
+	}
+	if (centroid && sum>0)
+		centroid->set(cx/sum, cy/sum);
+	return sum;
+}
+
+void TestStarGpuProgram::initTestCase()
+{
+	surface = Q_NULLPTR;
+	context = Q_NULLPTR;
+	fbo = Q_NULLPTR;
+	texture = Q_NULLPTR;
+	program = Q_NULLPTR;
+
+	surface = new QOffscreenSurface();
+	surface->create();
+	context = new QOpenGLContext();
+	if (!context->create() || !context->makeCurrent(surface))
+		QSKIP("No OpenGL context available");
+	qDebug() << "OpenGL renderer:" << (const char*)context->functions()->glGetString(GL_RENDERER);
+
+	program = new StarGpuProgram();
+	QVERIFY(program->isValid());
+	QVERIFY(program->getMaxPointSize()>=2.f*STAR_RADIUS);
+
+	fbo = new QOpenGLFramebufferObject(IMAGE_SIZE, IMAGE_SIZE);
+	QVERIFY(fbo->isValid());
+
+	// A uniformly white halo, so that every covered pixel gets the full star color
+	QImage white(16, 16, QImage::Format_RGB32);
+	white.fill(Qt::white);
+	texture = new QOpenGLTexture(white);
+	texture->setMinMagFilters(QOpenGLTexture::Nearest, QOpenGLTexture::Nearest);
+}
+
+void TestStarGpuProgram::cleanupTestCase()
+{
+	delete program;
+	delete texture;
+	delete fbo;
+	if (context)
+		context->doneCurrent();
+	delete context;
+	delete surface;
+}
+
+StelProjectorP TestStarGpuProgram::createProjector(const QString& name)
+{
+	StelProjector::ModelViewTranformP transform(new StelProjector::Mat4dTransform(Mat4d::identity()));
+	StelProjectorP prj;
+	if (name=="Perspective")
+		prj = StelProjectorP(new StelProjectorPerspective(transform));
+	else if (name=="Stereographic")
+		prj = StelProjectorP(new StelProjectorStereographic(transform));
+	Q_ASSERT(prj);
+
+	StelProjector::StelProjectorParams params;
+	params.viewportXywh.set(0, 0, IMAGE_SIZE, IMAGE_SIZE);
+	params.viewportCenter.set(IMAGE_SIZE/2, IMAGE_SIZE/2);
+	params.viewportFovDiameter = IMAGE_SIZE;
+	params.fov = 60.f;
+	params.zNear = 0.000001f;
+	params.zFar = 500.f;
+	prj->init(params);
+	return prj;
+}
+
+QImage TestStarGpuProgram::render(const QVector<StaticStarVertex>& stars, const StarGpuProgram::Params& params)
+{
+	QOpenGLFunctions* gl = context->functions();
+	fbo->bind();
+	gl->glViewport(0, 0, IMAGE_SIZE, IMAGE_SIZE);
+	gl->glClearColor(0.f, 0.f, 0.f, 1.f);
+	gl->glClear(GL_COLOR_BUFFER_BIT);
+	gl->glEnable(GL_BLEND);
+	gl->glBlendFunc(GL_ONE, GL_ONE);
+	texture->bind(0);
+
+	QOpenGLBuffer buffer(QOpenGLBuffer::VertexBuffer);
+	buffer.create();
+	buffer.bind();
+	buffer.allocate(stars.constData(), stars.size()*sizeof(StaticStarVertex));
+	buffer.release();
+	program->draw(&buffer, QVector<QPair<int, int> >() << qMakePair(0, stars.size()), params);
+	buffer.destroy();
+
+	texture->release(0);
+	gl->glDisable(GL_BLEND);
+	const QImage image = fbo->toImage();
+	fbo->release();
+	return image;
+}
+
+//! Parameters drawing stars of magnitude steps up to 9 with the same radius and full luminance.
+static StarGpuProgram::Params brightStarsParams()
+{
+	StarGpuProgram::Params params;
+	for (int i=0;i<10;++i)
+	{
+		params.rcmag[2*i] = STAR_RADIUS;
+		params.rcmag[2*i+1] = 1.f;
+	}
+	params.cutoffMag = 9.f;
+	return params;
+}
+
+void TestStarGpuProgram::testProjection_data()
+{
+	QTest::addColumn<QString>("projection");
+	QTest::newRow("Perspective") << "Perspective";
+	QTest::newRow("Stereographic") << "Stereographic";
+}
+
+void TestStarGpuProgram::testProjection()
+{
+	QFETCH(QString, projection);
+	const StelProjectorP prj = createProjector(projection);
+	StarGpuProgram::Params params = brightStarsParams();
+	QVERIFY(StarGpuProgram::setProjection(params, prj));
+
+	// Directions in the view frame, far enough apart for the stars not to overlap.
+	// The last one is behind the observer and must not be drawn.
+	QVector<Vec3d> directions;
+	directions << Vec3d(0., 0., -1.) << Vec3d(0.2, 0.1, -1.) << Vec3d(-0.25, 0.2, -1.)
+		   << Vec3d(0.1, -0.3, -1.) << Vec3d(-0.3, -0.25, -1.) << Vec3d(0.05, 0.05, 1.);
+	QVector<StaticStarVertex> stars;
+	foreach (const Vec3d& d, directions)
+		stars.append(makeStar(d, 0));
+	const QImage image = render(stars, params);
+
+	int totalSum = 0;
+	for (int i=0;i<directions.size()-1;++i)
+	{
+		Vec3d win;
+		QVERIFY(prj->project(directions[i], win));
+		Vec2d centroid;
+		const int sum = sumAround(image, win, &centroid);
+		QVERIFY2(sum>0, qPrintable(QString("star %1 not drawn").arg(i)));
+		QVERIFY2(std::fabs(centroid[0]-win[0])<1. && std::fabs(centroid[1]-win[1])<1.,
+			 qPrintable(QString("star %1 drawn at %2,%3 instead of %4,%5").arg(i).arg(centroid[0]).arg(centroid[1]).arg(win[0]).arg(win[1])));
+		totalSum += sum;
+	}
+
+	// Nothing else was drawn, in particular not the star behind the observer
+	int imageSum = 0;
+	for (int y=0;y<image.height();++y)
+		for (int x=0;x<image.width();++x)
+			imageSum += qRed(image.pixel(x, y));
+	QCOMPARE(imageSum, totalSum);
+}
+
+void TestStarGpuProgram::testMagnitudeCutoff()
+{
+	const StelProjectorP prj = createProjector("Perspective");
+	StarGpuProgram::Params params = brightStarsParams();
+	QVERIFY(StarGpuProgram::setProjection(params, prj));
+	params.cutoffMag = 4.f;
+
+	const Vec3d bright(0.2, 0.1, -1.);
+	const Vec3d faint(-0.2, -0.1, -1.);
+	QVector<StaticStarVertex> stars;
+	stars << makeStar(bright, 4) << makeStar(faint, 5);
+	const QImage image = render(stars, params);
+
+	Vec3d win;
+	QVERIFY(prj->project(bright, win));
+	QVERIFY(sumAround(image, win)>0);
+	QVERIFY(prj->project(faint, win));
+	QCOMPARE(sumAround(image, win), 0);
+}
+
+void TestStarGpuProgram::testTwinkle()
+{
+	const StelProjectorP prj = createProjector("Perspective");
+	StarGpuProgram::Params params = brightStarsParams();
+	QVERIFY(StarGpuProgram::setProjection(params, prj));
+
+	const Vec3d pos(0.1, 0.1, -1.);
+	Vec3d win;
+	QVERIFY(prj->project(pos, win));
+	const QVector<StaticStarVertex> stars(1, makeStar(pos, 0));
+	const int steady = sumAround(render(stars, params), win);
+	QVERIFY(steady>0);
+
+	// Twinkling only dims the star, by a different amount for each seed
+	params.twinkleAmount = 1.f;
+	int minSum = INT_MAX, maxSum = 0;
+	for (int i=0;i<10;++i)
+	{
+		params.twinkleSeed = 0.1f*i;
+		const int sum = sumAround(render(stars, params), win);
+		QVERIFY(sum<=steady);
+		minSum = qMin(minSum, sum);
+		maxSum = qMax(maxSum, sum);
+	}
+	QVERIFY(minSum<maxSum);
+}
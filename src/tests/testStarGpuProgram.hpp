@@ -0,0 +1,62 @@
+/*
+ * Stellarium
+ * Copyright (C) 2017 Stellarium Developers
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Suite 500, Boston, MA  02110-1335, USA.
+ */
+
+#ifndef _TESTSTARGPUPROGRAM_HPP_
+#define _TESTSTARGPUPROGRAM_HPP_
+
+#include <QObject>
+#include <QImage>
+#include <QTest>
+#include <QVector>
+
+#include "StarGpuProgram.hpp"
+#include "ZoneData.hpp"
+
+class QOffscreenSurface;
+class QOpenGLContext;
+class QOpenGLFramebufferObject;
+class QOpenGLTexture;
+
+//! Render stars with the shader program of StarGpuCatalog into an offscreen buffer and compare
+//! their positions with StelProjector. Runs with any OpenGL 2.1 or OpenGL ES 2 implementation,
+//! e.g. without a GPU with QT_QPA_PLATFORM=offscreen LIBGL_ALWAYS_SOFTWARE=1 (Mesa llvmpipe).
+//! The test is skipped if no OpenGL context can be created.
+class TestStarGpuProgram : public QObject
+{
+Q_OBJECT
+private slots:
+	void initTestCase();
+	void cleanupTestCase();
+	void testProjection_data();
+	void testProjection();
+	void testMagnitudeCutoff();
+	void testTwinkle();
+private:
+	StelProjectorP createProjector(const QString& name);
+	//! Draw the stars and return the rendered image.
+	QImage render(const QVector<StaticStarVertex>& stars, const StarGpuProgram::Params& params);
+
+	QOffscreenSurface* surface;
+	QOpenGLContext* context;
+	QOpenGLFramebufferObject* fbo;
+	QOpenGLTexture* texture;
+	StarGpuProgram* program;
+};
+
+#endif // _TESTSTARGPUPROGRAM_HPP_
@@ -0,0 +1,106 @@
+/*
+ * Stellarium
+ * Copyright (C) 2017 Stellarium Developers
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Suite 500, Boston, MA  02110-1335, USA.
+ */
+
+#include <QObject>
+#include <QtDebug>
+#include <QtTest>
+#include <cmath>
+
+#include "tests/testStelIAUConstellationIndex.hpp"
+#include "StelFileMgr.hpp"
+
+QTEST_GUILESS_MAIN(TestStelIAUConstellationIndex)
+
+void TestStelIAUConstellationIndex::initTestCase()
+{
+	StelFileMgr::init();
+	const QString spansPath = StelFileMgr::findFile("data/constellations_spans.dat", StelFileMgr::File);
+	if (spansPath.isEmpty())
+		QSKIP("data/constellations_spans.dat not found");
+	QVERIFY(index.load(spansPath));
+	QVERIFY(!index.isEmpty());
+}
+
+void TestStelIAUConstellationIndex::testKnownPositions()
+{
+	// B1875.0 positions taken from the spans of the table
+	QCOMPARE(index.find(1.0, 89.0), QString("UMi"));
+	QCOMPARE(index.find(10.0, 87.0), QString("UMi"));
+	QCOMPARE(index.find(12.0, -89.0), QString("Oct"));
+	QCOMPARE(index.find(5.5, 5.0), QString("Ori"));
+	QCOMPARE(index.find(0.7, 41.0), QString("And"));
+	QCOMPARE(index.find(13.4, -11.0), QString("Vir"));
+}
+
+void TestStelIAUConstellationIndex::testSameAsScan()
+{
+	// A dense grid, off the limits of the spans
+	int mismatches = 0;
+	for (double dec=-89.95; dec<90.; dec+=0.1)
+	{
+		for (double ra=0.0013; ra<24.; ra+=1./120.)
+		{
+			if (index.find(ra, dec)!=index.scan(ra, dec))
+			{
+				if (++mismatches<=10)
+					qWarning() << "Mismatch at RA" << ra << "Dec" << dec << ":" << index.find(ra, dec) << "instead of" << index.scan(ra, dec);
+			}
+		}
+	}
+	QCOMPARE(mismatches, 0);
+}
+
+void TestStelIAUConstellationIndex::testSpanLimits()
+{
+	// Most limits of the spans are multiples of 15 minutes of RA and 15 arcminutes of declination:
+	// test on them, where the inequalities of the algorithm matter, and just next to them.
+	int mismatches = 0;
+	for (double dec=-90.; dec<=90.; dec+=0.25)
+	{
+		for (double ra=0.; ra<24.; ra+=0.25)
+		{
+			if (index.find(ra, dec)!=index.scan(ra, dec))
+				++mismatches;
+			if (index.find(ra+1e-9, dec-1e-9)!=index.scan(ra+1e-9, dec-1e-9))
+				++mismatches;
+		}
+	}
+	QCOMPARE(mismatches, 0);
+}
+
+void TestStelIAUConstellationIndex::testBatch()
+{
+	QVector<Vec3d> positions;
+	QStringList expected;
+	for (double dec=-89.5; dec<90.; dec+=0.7)
+	{
+		for (double ra=0.01; ra<24.; ra+=0.05)
+		{
+			const double raRad = ra*M_PI/12.;
+			const double decRad = dec*M_PI/180.;
+			const Vec3d pos(std::cos(decRad)*std::cos(raRad), std::cos(decRad)*std::sin(raRad), std::sin(decRad));
+			positions << pos;
+			double r, d;
+			StelIAUConstellationIndex::rectToRaDec(pos, r, d);
+			expected << index.scan(r, d);
+		}
+	}
+	QCOMPARE(index.find(positions, false), expected);
+	QCOMPARE(index.find(positions, true), expected);
+}
@@ -0,0 +1,344 @@
+/*
+ * Stellarium
+ * Copyright (C) 2017 Stellarium Developers
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Suite 500, Boston, MA  02110-1335, USA.
+ */
+
+#include <QObject>
+#include <QtDebug>
+#include <QtTest>
+#include <QFile>
+#include <QFileInfo>
+#include <QSet>
+#include <QStringList>
+
+#include <algorithm>
+#include <cmath>
+
+#include "tests/testStelLocationCatalog.hpp"
+#include "StelLocationCatalog.hpp"
+#include "StelLocationMgr.hpp"
+#include "StelLocaleMgr.hpp"
+
+QTEST_GUILESS_MAIN(TestStelLocationCatalog)
+
+// StelLocation.cpp is linked without StelLocationMgr and StelLocaleMgr, which need a StelApp.
+// The functions it uses keep the strings unchanged here.
+QString StelLocationMgr::sanitizeTimezoneStringForLocationDB(QString tzString)
+{
+	return tzString;
+}
+
+QString StelLocationMgr::sanitizeTimezoneStringFromLocationDB(QString dbString)
+{
+	return dbString;
+}
+
+QString StelLocaleMgr::countryCodeToString(const QString& countryCode)
+{
+	return countryCode;
+}
+
+static StelLocation makeLocation(int i, float longitude, float latitude, const QString& planetName)
+{
+	StelLocation loc;
+	loc.name = QString("Place %1").arg(i);
+	loc.state = i%3 ? QString() : QString("State %1").arg(i%7);
+	loc.country = QString("Country %1").arg(i%11);
+	loc.planetName = planetName;
+	loc.ianaTimeZone = i%5 ? "Europe/Paris" : "UTC";
+	loc.landscapeKey = i%13 ? QString() : "guereins";
+	loc.longitude = longitude;
+	loc.latitude = latitude;
+	loc.altitude = i%4000-100;
+	loc.population = i*10;
+	loc.bortleScaleIndex = 1+i%9;
+	loc.role = i%2 ? 'C' : 'N';
+	loc.isUserLocation = false;
+	return loc;
+}
+
+// Positions spread over the sphere [deg]
+static float spreadLongitude(int i, float step)
+{
+	return std::fmod(i*step, 360.f)-180.f;
+}
+
+static float spreadLatitude(int i)
+{
+	const float f = i*0.618034f-std::floor(i*0.618034f);
+	return std::asin(2.f*f-1.f)*180.f/M_PI;
+}
+
+static QVector<int> scanNearby(const StelLocationCatalog& catalog, const QVector<QString>& planets, const QString& planetName,
+			       float longitude, float latitude, float radiusDegrees)
+{
+	QVector<int> result;
+	for (int i=0; i<catalog.size(); ++i)
+	{
+		const StelLocationCatalog::Coordinates& c = catalog.getCoordinates(i);
+		if (planets.at(i)==planetName
+		    && StelLocation::distanceDegrees(longitude, latitude, c.longitude, c.latitude)<=radiusDegrees)
+			result.append(i);
+	}
+	return result;
+}
+
+static QVector<QString> getPlanets(const StelLocationCatalog& catalog)
+{
+	QVector<QString> planets(catalog.size());
+	for (int i=0; i<catalog.size(); ++i)
+		planets[i] = catalog.getLocation(i).planetName;
+	return planets;
+}
+
+// The positions of the searches: spread over the sphere, around the antimeridian and around the poles [deg]
+static QVector<QPair<float, float> > getQueries()
+{
+	QVector<QPair<float, float> > queries;
+	for (int i=1; i<=40; ++i)
+		queries << qMakePair(spreadLongitude(i, 97.3f), spreadLatitude(i+1000));
+	queries << qMakePair(180.f, 0.f) << qMakePair(-180.f, 30.f) << qMakePair(179.99f, 10.f) << qMakePair(-179.99f, -10.f)
+		<< qMakePair(360.f, 5.f) << qMakePair(-190.f, 20.f) << qMakePair(0.f, 90.f) << qMakePair(0.f, -90.f)
+		<< qMakePair(120.f, 89.95f) << qMakePair(-60.f, -89.95f) << qMakePair(180.f, 89.99f) << qMakePair(-179.5f, -89.5f);
+	return queries;
+}
+
+void TestStelLocationCatalog::initTestCase()
+{
+	QVERIFY(dir.isValid());
+	int i = 0;
+	for (; i<2000; ++i)
+	{
+		const StelLocation loc = makeLocation(i, spreadLongitude(i, 137.508f), spreadLatitude(i), "Earth");
+		locations.insert(loc.getID(), loc);
+	}
+	for (; i<2200; ++i)
+	{
+		const StelLocation loc = makeLocation(i, spreadLongitude(i, 222.5f), spreadLatitude(i), "Mars");
+		locations.insert(loc.getID(), loc);
+	}
+	// Around the antimeridian, including longitudes out of [-180, 180]
+	const float longitudes[] = {180.f, -180.f, 179.999f, -179.999f, 179.5f, -179.5f, 200.f, -350.f};
+	const float latitudes[] = {0.f, 30.f, -60.f};
+	for (unsigned int l=0; l<sizeof(longitudes)/sizeof(longitudes[0]); ++l)
+		for (unsigned int b=0; b<sizeof(latitudes)/sizeof(latitudes[0]); ++b)
+		{
+			const StelLocation loc = makeLocation(i++, longitudes[l], latitudes[b], "Earth");
+			locations.insert(loc.getID(), loc);
+		}
+	// Around the poles
+	const float polar[][2] = {{0.f, 90.f}, {90.f, 90.f}, {45.f, -90.f}, {-120.f, 89.9f}, {60.f, -89.9f}, {10.f, 89.99f}, {179.9f, -89.99f}};
+	for (unsigned int p=0; p<sizeof(polar)/sizeof(polar[0]); ++p)
+	{
+		const StelLocation loc = makeLocation(i++, polar[p][0], polar[p][1], "Earth");
+		locations.insert(loc.getID(), loc);
+	}
+
+	QFile source(path("source.bin"));
+	QVERIFY(source.open(QIODevice::WriteOnly));
+	source.write(QByteArray(100, 'x'));
+	source.close();
+	QVERIFY(StelLocationCatalog::write(path("locations.cat"), locations, 1234u, QFileInfo(path("source.bin"))));
+}
+
+void TestStelLocationCatalog::testRoundTrip()
+{
+	StelLocationCatalog catalog;
+	QVERIFY(catalog.load(path("locations.cat")));
+	QCOMPARE(catalog.size(), locations.size());
+	QCOMPARE(catalog.getTimeZonesHash(), 1234u);
+
+	QSet<QString> ids;
+	for (int i=0; i<catalog.size(); ++i)
+	{
+		const QString id = catalog.getID(i);
+		QVERIFY(locations.contains(id));
+		QVERIFY(!ids.contains(id));
+		ids.insert(id);
+		const StelLocation& s = locations[id];
+		const StelLocation loc = catalog.getLocation(i);
+		QCOMPARE(loc.name, s.name);
+		QCOMPARE(loc.state, s.state);
+		QCOMPARE(loc.country, s.country);
+		QCOMPARE(catalog.getCountry(i), s.country);
+		QCOMPARE(loc.planetName, s.planetName);
+		QCOMPARE(loc.ianaTimeZone, s.ianaTimeZone);
+		QCOMPARE(loc.landscapeKey, s.landscapeKey);
+		QCOMPARE(loc.altitude, s.altitude);
+		QCOMPARE(loc.population, s.population);
+		QCOMPARE(loc.bortleScaleIndex, s.bortleScaleIndex);
+		QCOMPARE(loc.role, s.role);
+		QVERIFY(!loc.isUserLocation);
+		QCOMPARE(loc.latitude, s.latitude);
+		// The longitudes are stored in [-180, 180]
+		QVERIFY(loc.longitude>=-180.f && loc.longitude<=180.f);
+		if (std::fabs(s.longitude)<=180.f)
+			QCOMPARE(loc.longitude, s.longitude);
+		else
+			QVERIFY(StelLocation::distanceDegrees(loc.longitude, loc.latitude, s.longitude, s.latitude)<1e-3f);
+		QCOMPARE(catalog.getCoordinates(i).longitude, loc.longitude);
+		QCOMPARE(catalog.getCoordinates(i).latitude, loc.latitude);
+	}
+}
+
+void TestStelLocationCatalog::testFindID()
+{
+	StelLocationCatalog catalog;
+	QVERIFY(catalog.load(path("locations.cat")));
+	QCOMPARE(catalog.getIDs(), locations.keys());
+	foreach (const QString& id, locations.keys())
+	{
+		const int i = catalog.findID(id);
+		QVERIFY(i>=0);
+		QCOMPARE(catalog.getID(i), id);
+	}
+	QCOMPARE(catalog.findID(QString()), -1);
+	QCOMPARE(catalog.findID("Place 1"), -1);
+	QCOMPARE(catalog.findID("Place 1, Country 1x"), -1);
+	QCOMPARE(catalog.findID("zzz"), -1);
+	catalog.clear();
+	QCOMPARE(catalog.findID(locations.firstKey()), -1);
+	QVERIFY(catalog.getIDs().isEmpty());
+}
+
+void TestStelLocationCatalog::testFindNearby()
+{
+	StelLocationCatalog catalog;
+	QVERIFY(catalog.load(path("locations.cat")));
+	const QVector<QString> planets = getPlanets(catalog);
+	const QVector<QPair<float, float> > queries = getQueries();
+	const float radii[] = {0.f, 0.05f, 0.5f, 1.f, 2.5f, 10.f, 45.f, 91.f, 180.f};
+	const QStringList planetNames = QStringList() << "Earth" << "Mars" << "Moon";
+	foreach (const QString& planetName, planetNames)
+	{
+		for (int q=0; q<queries.size(); ++q)
+		{
+			for (unsigned int r=0; r<sizeof(radii)/sizeof(radii[0]); ++r)
+			{
+				const float longitude = queries.at(q).first;
+				const float latitude = queries.at(q).second;
+				QVector<int> found = catalog.findNearby(planetName, longitude, latitude, radii[r]);
+				std::sort(found.begin(), found.end());
+				const QVector<int> expected = scanNearby(catalog, planets, planetName, longitude, latitude, radii[r]);
+				QCOMPARE(found, expected);
+			}
+		}
+	}
+	// The locations at longitude 180 and -180 are found with a radius of 0
+	QCOMPARE(catalog.findNearby("Earth", 180.f, 0.f, 0.f).size(), 2);
+}
+
+void TestStelLocationCatalog::testFindNearest()
+{
+	StelLocationCatalog catalog;
+	QVERIFY(catalog.load(path("locations.cat")));
+	const QVector<QString> planets = getPlanets(catalog);
+	const QVector<QPair<float, float> > queries = getQueries();
+	const float maxDistances[] = {0.01f, 1.f, 5.f, 180.f};
+	const QStringList planetNames = QStringList() << "Earth" << "Mars" << "Moon";
+	foreach (const QString& planetName, planetNames)
+	{
+		for (int q=0; q<queries.size(); ++q)
+		{
+			const float longitude = queries.at(q).first;
+			const float latitude = queries.at(q).second;
+			int nearest = -1;
+			float nearestDistance = 0.f;
+			for (int i=0; i<catalog.size(); ++i)
+			{
+				if (planets.at(i)!=planetName)
+					continue;
+				const StelLocationCatalog::Coordinates& c = catalog.getCoordinates(i);
+				const float d = StelLocation::distanceDegrees(longitude, latitude, c.longitude, c.latitude);
+				if (nearest<0 || d<nearestDistance)
+				{
+					nearest = i;
+					nearestDistance = d;
+				}
+			}
+			for (unsigned int m=0; m<sizeof(maxDistances)/sizeof(maxDistances[0]); ++m)
+			{
+				float distance = -1.f;
+				const int i = catalog.findNearest(planetName, longitude, latitude, maxDistances[m], &distance);
+				if (nearest<0 || nearestDistance>maxDistances[m])
+				{
+					QCOMPARE(i, -1);
+					continue;
+				}
+				// Another location at the same distance may be found.
+				QVERIFY(i>=0);
+				QCOMPARE(planets.at(i), planetName);
+				QCOMPARE(distance, nearestDistance);
+				const StelLocationCatalog::Coordinates& c = catalog.getCoordinates(i);
+				QCOMPARE(StelLocation::distanceDegrees(longitude, latitude, c.longitude, c.latitude), nearestDistance);
+			}
+		}
+	}
+}
+
+void TestStelLocationCatalog::testIsImportOf()
+{
+	const QString sourcePath = path("changing.bin");
+	const QString catalogPath = path("changing.cat");
+	QFile source(sourcePath);
+	QVERIFY(source.open(QIODevice::WriteOnly));
+	source.write(QByteArray(100, 'x'));
+	source.close();
+	QVERIFY(StelLocationCatalog::write(catalogPath, locations, 0u, QFileInfo(sourcePath)));
+	StelLocationCatalog catalog;
+	QVERIFY(catalog.load(catalogPath));
+	QVERIFY(catalog.isImportOf(sourcePath));
+	QVERIFY(!catalog.isImportOf(path("changing.bin.missing")));
+
+	// A source with another size
+	QVERIFY(source.open(QIODevice::WriteOnly | QIODevice::Append));
+	source.write(QByteArray(10, 'y'));
+	source.close();
+	QVERIFY(!catalog.isImportOf(sourcePath));
+	catalog.clear();
+	QVERIFY(!catalog.isImportOf(sourcePath));
+}
+
+void TestStelLocationCatalog::testInvalidFile()
+{
+	QFile valid(path("locations.cat"));
+	QVERIFY(valid.open(QIODevice::ReadOnly));
+	const QByteArray data = valid.readAll();
+	valid.close();
+
+	// A truncated file
+	QFile truncated(path("truncated.cat"));
+	QVERIFY(truncated.open(QIODevice::WriteOnly));
+	truncated.write(data.left(data.size()/2));
+	truncated.close();
+	StelLocationCatalog catalog;
+	QVERIFY(!catalog.load(path("truncated.cat")));
+	QVERIFY(!catalog.isLoaded());
+	QCOMPARE(catalog.size(), 0);
+
+	// A file which is not a location file
+	QFile garbage(path("garbage.cat"));
+	QVERIFY(garbage.open(QIODevice::WriteOnly));
+	garbage.write(QByteArray(200, 'x'));
+	garbage.close();
+	QVERIFY(!catalog.load(path("garbage.cat")));
+	QVERIFY(!catalog.isLoaded());
+
+	// A file which cannot be written
+	QVERIFY(!StelLocationCatalog::write(path("missing/locations.cat"), locations, 0u, QFileInfo(path("source.bin"))));
+	QVERIFY(catalog.load(path("locations.cat")));
+}
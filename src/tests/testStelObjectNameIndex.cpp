@@ -0,0 +1,341 @@
+/*
+ * Stellarium
+ * Copyright (C) 2017 Stellarium Developers
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Suite 500, Boston, MA  02110-1335, USA.
+ */
+
+#include <QObject>
+#include <QtDebug>
+#include <QtTest>
+#include <QElapsedTimer>
+
+#include <algorithm>
+
+#include "tests/testStelObjectNameIndex.hpp"
+
+QTEST_GUILESS_MAIN(TestStelObjectNameIndex)
+
+typedef StelObjectNameIndex::Name Name;
+
+// The index only uses the modules as keys.
+static const StelObjectModule* module(int i)
+{
+	return reinterpret_cast<const StelObjectModule*>(quintptr(0x1000*(i+1)));
+}
+
+static QVector<Name> names(const QStringList& list, StelObjectNameIndex::NameType type=StelObjectNameIndex::Designation, int rank=0)
+{
+	QVector<Name> result;
+	foreach (const QString& n, list)
+		result << Name(n, type, rank);
+	return result;
+}
+
+void TestStelObjectNameIndex::testFold()
+{
+	QCOMPARE(StelObjectNameIndex::fold("M 31"), QString("m31"));
+	QCOMPARE(StelObjectNameIndex::fold("NGC 224"), QString("ngc224"));
+	QCOMPARE(StelObjectNameIndex::fold(QString::fromUtf8("\xC3\x85ngstr\xC3\xB6m")), QString("angstrom"));
+	QCOMPARE(StelObjectNameIndex::fold("Barnard's Star"), QString("barnardsstar"));
+	// The number following a Greek letter is optional
+	QCOMPARE(StelObjectNameIndex::fold(QString::fromUtf8("\xCE\xB1\x31 Cen")), QString::fromUtf8("\xCE\xB1""cen"));
+	QCOMPARE(StelObjectNameIndex::fold(QString::fromUtf8("\xCE\x91 Cen")), QString::fromUtf8("\xCE\xB1""cen"));
+	// but not after other letters
+	QCOMPARE(StelObjectNameIndex::fold("V1 Cyg"), QString("v1cyg"));
+	QCOMPARE(StelObjectNameIndex::fold(" - "), QString());
+
+	QVector<int> wordStarts;
+	QCOMPARE(StelObjectNameIndex::fold("Eta Carinae Nebula", &wordStarts), QString("etacarinaenebula"));
+	QCOMPARE(wordStarts, QVector<int>() << 0 << 3 << 10);
+	wordStarts.clear();
+	StelObjectNameIndex::fold("  C/1995 O1 (Hale-Bopp)", &wordStarts);
+	QCOMPARE(wordStarts, QVector<int>() << 0 << 1 << 5 << 7 << 11);
+}
+
+void TestStelObjectNameIndex::testOrder()
+{
+	StelObjectNameIndex index;
+	index.setNames(module(0), names(QStringList() << "M 33" << "M 31" << "M 3" << "M 310" << "Mars"));
+	// Exact match first, then by length, then alphabetically
+	QCOMPARE(index.listMatchingNames("m3", 10, true, true), QStringList() << "M 3" << "M 31" << "M 33" << "M 310");
+	QCOMPARE(index.listMatchingNames("M 3", 2, true, true), QStringList() << "M 3" << "M 31");
+	QCOMPARE(index.listMatchingNames("m 3 1", 10, true, true), QStringList() << "M 31" << "M 310");
+	QCOMPARE(index.listMatchingNames("x", 10, true, true), QStringList());
+	QCOMPARE(index.listMatchingNames("", 10, true, true), QStringList());
+	QCOMPARE(index.listMatchingNames("m", 0, true, true), QStringList());
+
+	// Lower ranks first, before the length
+	QVector<Name> ranked;
+	ranked << Name("Marfik", StelObjectNameIndex::Designation, 0) << Name("Mars", StelObjectNameIndex::Designation, 1)
+	       << Name("Marsic", StelObjectNameIndex::Designation, 0);
+	index.setNames(module(0), ranked);
+	QCOMPARE(index.listMatchingNames("mar", 10, true, true), QStringList() << "Marfik" << "Marsic" << "Mars");
+	QCOMPARE(index.listMatchingNames("mar", 1, true, true), QStringList() << "Marfik");
+	// but after the exact matches
+	QCOMPARE(index.listMatchingNames("mars", 10, true, true), QStringList() << "Mars" << "Marsic");
+}
+
+void TestStelObjectNameIndex::testStartOfWords()
+{
+	StelObjectNameIndex index;
+	index.setNames(module(0), names(QStringList() << "Eta Carinae" << "Carina Nebula" << "Scar"
+					<< QString::fromUtf8("\xCE\xB1\x31 Cen") << QString::fromUtf8("\xCE\xB1\x32 Cen")));
+	QCOMPARE(index.listMatchingNames("car", 10, true, true), QStringList() << "Carina Nebula");
+	// Names starting with the text before the names with a word starting with it
+	QCOMPARE(index.listMatchingNames("car", 10, false, true), QStringList() << "Carina Nebula" << "Eta Carinae");
+	// Not in the middle of a word
+	QCOMPARE(index.listMatchingNames("ar", 10, false, true), QStringList());
+	QCOMPARE(index.listMatchingNames("nebula", 10, false, true), QStringList() << "Carina Nebula");
+	QCOMPARE(index.listMatchingNames(QString::fromUtf8("\xCE\xB1 cen"), 10, true, true),
+		 QStringList() << QString::fromUtf8("\xCE\xB1\x31 Cen") << QString::fromUtf8("\xCE\xB1\x32 Cen"));
+	QCOMPARE(index.listMatchingNames(QString::fromUtf8("\xCE\xB1\x32 cen"), 10, true, true),
+		 QStringList() << QString::fromUtf8("\xCE\xB1\x31 Cen") << QString::fromUtf8("\xCE\xB1\x32 Cen"));
+}
+
+void TestStelObjectNameIndex::testLanguage()
+{
+	StelObjectNameIndex index;
+	QVector<Name> list;
+	list << Name("Polaris", StelObjectNameIndex::EnglishName)
+	     << Name("Polarstern", StelObjectNameIndex::TranslatedName)
+	     << Name("Pollux", StelObjectNameIndex::EnglishName)
+	     << Name("Pollux", StelObjectNameIndex::TranslatedName)
+	     << Name("PGC 1", StelObjectNameIndex::Designation);
+	index.setNames(module(0), list);
+	QCOMPARE(index.listMatchingNames("pol", 10, true, true), QStringList() << "Pollux" << "Polaris");
+	QCOMPARE(index.listMatchingNames("pol", 10, true, false), QStringList() << "Pollux" << "Polarstern");
+	QCOMPARE(index.listMatchingNames("p", 10, true, false), QStringList() << "PGC 1" << "Pollux" << "Polarstern");
+}
+
+void TestStelObjectNameIndex::testModules()
+{
+	StelObjectNameIndex index;
+	index.setNames(module(0), names(QStringList() << "Sirius" << "Sirrah"));
+	index.setNames(module(1), names(QStringList() << "Sirius" << "Siren"));
+	QVERIFY(index.contains(module(0)));
+	QVERIFY(!index.contains(module(2)));
+	// A name registered by several modules is listed once
+	QCOMPARE(index.listMatchingNames("si", 10, true, true), QStringList() << "Siren" << "Sirius" << "Sirrah");
+	QCOMPARE(index.listMatchingNames("si", 10, true, true, module(1)), QStringList() << "Siren" << "Sirius");
+
+	// setNames() replaces the names of a module only
+	index.setNames(module(1), names(QStringList() << "Sirona"));
+	QCOMPARE(index.listMatchingNames("si", 10, true, true), QStringList() << "Sirius" << "Sirona" << "Sirrah");
+	index.removeNames(module(0));
+	QVERIFY(!index.contains(module(0)));
+	QCOMPARE(index.listMatchingNames("si", 10, true, true), QStringList() << "Sirona");
+}
+
+namespace
+{
+	// Reference implementation: scan all the names
+	struct ScanEntry
+	{
+		QString name;
+		int type;
+		int rank;
+		QString folded;
+		QVector<int> wordStarts;
+	};
+
+	struct ScanMatch
+	{
+		QString name;
+		int relevance;
+		int rank;
+		bool operator<(const ScanMatch& o) const
+		{
+			if (relevance!=o.relevance)
+				return relevance<o.relevance;
+			if (rank!=o.rank)
+				return rank<o.rank;
+			if (name.size()!=o.name.size())
+				return name.size()<o.name.size();
+			return name<o.name;
+		}
+	};
+
+	QStringList scan(const QVector<QVector<ScanEntry> >& modules, const QString& text, int maxNbItem, bool useStartOfWords, bool inEnglish)
+	{
+		const QString folded = StelObjectNameIndex::fold(text);
+		const int typeMask = inEnglish ? StelObjectNameIndex::EnglishName : StelObjectNameIndex::TranslatedName;
+		QMap<QString, ScanMatch> best;
+		foreach (const QVector<ScanEntry>& entries, modules)
+		{
+			foreach (const ScanEntry& e, entries)
+			{
+				if (!(e.type & typeMask))
+					continue;
+				int relevance = -1;
+				if (e.folded.startsWith(folded))
+					relevance = e.folded==folded ? 0 : 1;
+				else if (!useStartOfWords)
+				{
+					for (int w=1; w<e.wordStarts.size() && relevance<0; ++w)
+					{
+						if (e.folded.mid(e.wordStarts.at(w)).startsWith(folded))
+							relevance = 2;
+					}
+				}
+				if (relevance<0)
+					continue;
+				ScanMatch m;
+				m.name = e.name;
+				m.relevance = relevance;
+				m.rank = e.rank;
+				if (!best.contains(e.name) || m<best.value(e.name))
+					best.insert(e.name, m);
+			}
+		}
+		QList<ScanMatch> matches = best.values();
+		std::sort(matches.begin(), matches.end());
+		QStringList result;
+		for (int i=0; i<matches.size() && i<maxNbItem; ++i)
+			result << matches.at(i).name;
+		return result;
+	}
+}
+
+void TestStelObjectNameIndex::testSameAsScan()
+{
+	static const char* words[] = {"Alpha", "Andromeda", "Alcor", "Algol", "Crab", "Cat's Eye", "Carina",
+				      "Eagle", "Eta", "Great", "Ring", "Nebula", "Cluster", "Omega", "Orion", "Owl"};
+	static const char* catalogs[] = {"NGC", "IC", "M", "HIP", "HD", "C", "Sh 2-"};
+	const int nbWords = sizeof(words)/sizeof(words[0]);
+	const int nbCatalogs = sizeof(catalogs)/sizeof(catalogs[0]);
+
+	qsrand(1234);
+	StelObjectNameIndex index;
+	QVector<QVector<ScanEntry> > modules;
+	QStringList queries;
+	for (int m=0; m<3; ++m)
+	{
+		QVector<Name> list;
+		for (int i=0; i<3000; ++i)
+		{
+			QString n;
+			if (qrand()%2)
+				n = QString("%1 %2").arg(catalogs[qrand()%nbCatalogs]).arg(qrand()%2000);
+			else
+			{
+				const int nbNameWords = 1+qrand()%3;
+				QStringList w;
+				for (int k=0; k<nbNameWords; ++k)
+					w << words[qrand()%nbWords];
+				n = w.join(' ');
+			}
+			const int type = 1+qrand()%3;
+			list << Name(n, StelObjectNameIndex::NameType(type), qrand()%4);
+			if (i%50==0)
+				queries << n.left(1+qrand()%qMax(1, n.size()-1));
+		}
+		index.setNames(module(m), list);
+
+		// Names registered several times by a module are merged.
+		QVector<ScanEntry> entries;
+		QHash<QString, int> entryIndex;
+		foreach (const Name& n, list)
+		{
+			if (entryIndex.contains(n.name))
+			{
+				ScanEntry& e = entries[entryIndex.value(n.name)];
+				e.type |= n.type;
+				e.rank = qMin(e.rank, n.rank);
+				continue;
+			}
+			ScanEntry e;
+			e.name = n.name;
+			e.type = n.type;
+			e.rank = n.rank;
+			e.folded = StelObjectNameIndex::fold(n.name, &e.wordStarts);
+			entryIndex.insert(n.name, entries.size());
+			entries << e;
+		}
+		modules << entries;
+	}
+	queries << "n" << "ngc 1" << "a" << "eta" << "ring" << "c 1" << "m 1";
+
+	const int sizes[] = {1, 5, 20, 100};
+	foreach (const QString& q, queries)
+	{
+		for (int s=0; s<4; ++s)
+		{
+			for (int flags=0; flags<4; ++flags)
+			{
+				const bool useStartOfWords = flags&1;
+				const bool inEnglish = flags&2;
+				QCOMPARE(index.listMatchingNames(q, sizes[s], useStartOfWords, inEnglish),
+					 scan(modules, q, sizes[s], useStartOfWords, inEnglish));
+			}
+		}
+	}
+}
+
+// Names of the size of the star and DSO catalogues
+static void fillLargeIndex(StelObjectNameIndex& index, QStringList& queries)
+{
+	QVector<Name> stars;
+	for (int i=1; i<=120000; ++i)
+		stars << Name(QString("HIP %1").arg(i), StelObjectNameIndex::Designation, 2);
+	for (int i=1; i<=9000; ++i)
+		stars << Name(QString("HR %1").arg(i), StelObjectNameIndex::Designation, 2);
+	index.setNames(module(0), stars);
+	QVector<Name> dsos;
+	for (int i=1; i<=7840; ++i)
+		dsos << Name(QString("NGC %1").arg(i), StelObjectNameIndex::Designation, 3);
+	for (int i=1; i<=5386; ++i)
+		dsos << Name(QString("IC %1").arg(i), StelObjectNameIndex::Designation, 3);
+	for (int i=1; i<=110; ++i)
+		dsos << Name(QString("M %1").arg(i), StelObjectNameIndex::Designation, 1);
+	index.setNames(module(1), dsos);
+	queries << "h" << "hip 1" << "hip 4321" << "ngc" << "ngc 22" << "ic 4" << "m" << "m 3" << "1" << "x";
+}
+
+void TestStelObjectNameIndex::testSpeed()
+{
+	StelObjectNameIndex index;
+	QStringList queries;
+	fillLargeIndex(index, queries);
+
+	const int repeat = 20;
+	QElapsedTimer timer;
+	timer.start();
+	for (int i=0; i<repeat; ++i)
+	{
+		foreach (const QString& q, queries)
+		{
+			index.listMatchingNames(q, 5, true, true);
+			index.listMatchingNames(q, 5, false, true);
+		}
+	}
+	const double msPerQuery = timer.nsecsElapsed()*1e-6/(repeat*queries.size()*2);
+	qDebug() << "listMatchingNames:" << msPerQuery << "ms per query with" << 120000+9000+7840+5386+110 << "names";
+#ifdef NDEBUG
+	// Debug builds are not optimized enough to be representative
+	QVERIFY2(msPerQuery<1., qPrintable(QString("%1 ms per query").arg(msPerQuery)));
+#endif
+}
+
+void TestStelObjectNameIndex::benchmarkListMatchingNames()
+{
+	StelObjectNameIndex index;
+	QStringList queries;
+	fillLargeIndex(index, queries);
+	QBENCHMARK {
+		foreach (const QString& q, queries)
+			index.listMatchingNames(q, 5, false, true);
+	}
+}
@@ -0,0 +1,212 @@
+/*
+ * Stellarium
+ * Copyright (C) 2017 Stellarium Developers
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Suite 500, Boston, MA  02110-1335, USA.
+ */
+
+#include "tests/testStelProjector.hpp"
+
+#include "StelProjectorClasses.hpp"
+
+#include <QString>
+#include <QDebug>
+#include <QtMath>
+
+QTEST_GUILESS_MAIN(TestStelProjector)
+
+// Not a multiple of StelProjector::ProjectBlockSize, to test the last block
+static const int NB_POINTS = 1000;
+
+//! A model view transform which is not a Mat4dTransform, to test the projection of the transformed vectors.
+class NormalizingTransform : public StelProjector::ModelViewTranform
+{
+public:
+	NormalizingTransform(const Mat4d& m) : m(m), mf(m[0], m[1], m[2], m[3], m[4], m[5], m[6], m[7], m[8], m[9], m[10], m[11], m[12], m[13], m[14], m[15]) {}
+	void forward(Vec3d& v) const {v.transfo4d(m); v.normalize();}
+	void backward(Vec3d& v) const {v = m.transpose().multiplyWithoutTranslation(v);}
+	void forward(Vec3f& v) const {v.transfo4d(mf); v.normalize();}
+	void backward(Vec3f& v) const {Vec3d vd(v[0], v[1], v[2]); backward(vd); v.set(vd[0], vd[1], vd[2]);}
+	void combine(const Mat4d& c) {m = m*c;}
+	StelProjector::ModelViewTranformP clone() const {return StelProjector::ModelViewTranformP(new NormalizingTransform(m));}
+	Mat4d getApproximateLinearTransfo() const {return m;}
+private:
+	Mat4d m;
+	Mat4f mf;
+};
+
+void TestStelProjector::initTestCase()
+{
+	rotation = Mat4d::zrotation(0.3)*Mat4d::xrotation(-1.1)*Mat4d::yrotation(0.7);
+	const Mat4d inverse = rotation.transpose();
+
+	// Directions in the view frame, away from the singular points of the projections (poles of the
+	// cylindrical projections, point opposite to the center, wrap-around meridian), at various distances.
+	qsrand(42);
+	while (points.size()<NB_POINTS)
+	{
+		Vec3d d(qrand()/(double)RAND_MAX-0.5, qrand()/(double)RAND_MAX-0.5, qrand()/(double)RAND_MAX-0.5);
+		if (d.length()<0.1)
+			continue;
+		d.normalize();
+		if (std::fabs(d[1])>0.95 || d[2]>0.95 || std::fabs(d[2])<0.02 || (d[2]>0. && std::fabs(d[0])<0.02))
+			continue;
+		const double distance = 1. + 9.*qrand()/RAND_MAX;
+		const Vec3d v = inverse.multiplyWithoutTranslation(d*distance);
+		points.append(v);
+		pointsf.append(Vec3f(v[0], v[1], v[2]));
+	}
+}
+
+StelProjectorP TestStelProjector::createProjector(const QString& name, StelProjector::ModelViewTranformP transform)
+{
+	StelProjectorP prj;
+	if (name=="Perspective")
+		prj = StelProjectorP(new StelProjectorPerspective(transform));
+	else if (name=="EqualArea")
+		prj = StelProjectorP(new StelProjectorEqualArea(transform));
+	else if (name=="Stereographic")
+		prj = StelProjectorP(new StelProjectorStereographic(transform));
+	else if (name=="Fisheye")
+		prj = StelProjectorP(new StelProjectorFisheye(transform));
+	else if (name=="Hammer")
+		prj = StelProjectorP(new StelProjectorHammer(transform));
+	else if (name=="Cylinder")
+		prj = StelProjectorP(new StelProjectorCylinder(transform));
+	else if (name=="Mercator")
+		prj = StelProjectorP(new StelProjectorMercator(transform));
+	else if (name=="Orthographic")
+		prj = StelProjectorP(new StelProjectorOrthographic(transform));
+	else if (name=="Sinusoidal")
+		prj = StelProjectorP(new StelProjectorSinusoidal(transform));
+	else if (name=="Miller")
+		prj = StelProjectorP(new StelProjectorMiller(transform));
+	Q_ASSERT(prj);
+
+	StelProjector::StelProjectorParams params;
+	params.viewportXywh.set(0, 0, 1024, 768);
+	params.viewportCenter.set(512.f, 384.f);
+	params.viewportFovDiameter = 768.f;
+	params.fov = 100.f;
+	params.zNear = 0.000001f;
+	params.zFar = 500.f;
+	params.flipHorz = true;
+	params.widthStretch = 1.2f;
+	prj->init(params);
+	return prj;
+}
+
+void TestStelProjector::compare(const QVector<Vec3f>& expected, const QVector<Vec3f>& actual)
+{
+	QCOMPARE(actual.size(), expected.size());
+	for (int i=0; i<expected.size(); ++i)
+	{
+		for (int k=0; k<3; ++k)
+		{
+			const float e = expected[i][k];
+			const float a = actual[i][k];
+			// Points which cannot be projected get huge coordinates.
+			if (!qIsFinite(e) || std::fabs(e)>1e7f)
+			{
+				QVERIFY2(!qIsFinite(a) || std::fabs(a)>1e6f, qPrintable(QString("point %1: expected %2, got %3").arg(i).arg(e).arg(a)));
+				continue;
+			}
+			QVERIFY2(std::fabs(a-e) <= 1e-5f*qMax(1.f, std::fabs(e)),
+				 qPrintable(QString("point %1 coordinate %2: expected %3, got %4").arg(i).arg(k).arg(e, 0, 'g', 9).arg(a, 0, 'g', 9)));
+		}
+	}
+}
+
+static void addProjectorRows()
+{
+	static const char* names[] = {"Perspective", "EqualArea", "Stereographic", "Fisheye", "Hammer",
+				      "Cylinder", "Mercator", "Orthographic", "Sinusoidal", "Miller"};
+	for (unsigned int i=0; i<sizeof(names)/sizeof(names[0]); ++i)
+	{
+		QTest::newRow(qPrintable(QString("%1 matrix").arg(names[i]))) << QString(names[i]) << true;
+		QTest::newRow(qPrintable(QString("%1 non linear").arg(names[i]))) << QString(names[i]) << false;
+	}
+}
+
+void TestStelProjector::testBatchProjection_data()
+{
+	QTest::addColumn<QString>("name");
+	QTest::addColumn<bool>("matrix");
+	addProjectorRows();
+}
+
+void TestStelProjector::testBatchProjection()
+{
+	QFETCH(QString, name);
+	QFETCH(bool, matrix);
+
+	StelProjector::ModelViewTranformP transform;
+	if (matrix)
+		transform = StelProjector::ModelViewTranformP(new StelProjector::Mat4dTransform(rotation));
+	else
+		transform = StelProjector::ModelViewTranformP(new NormalizingTransform(rotation));
+	StelProjectorP prj = createProjector(name, transform);
+
+	// Double precision input
+	QVector<Vec3f> expected(NB_POINTS), actual(NB_POINTS);
+	prj->StelProjector::project(NB_POINTS, points.constData(), expected.data());
+	prj->project(NB_POINTS, points.constData(), actual.data());
+	compare(expected, actual);
+
+	// Single precision input
+	prj->StelProjector::project(NB_POINTS, pointsf.constData(), expected.data());
+	prj->project(NB_POINTS, pointsf.constData(), actual.data());
+	compare(expected, actual);
+
+	// Sizes smaller than a block
+	for (int n=0; n<3; ++n)
+	{
+		QVector<Vec3f> one(n+1);
+		prj->project(n+1, pointsf.constData()+7, one.data());
+		compare(expected.mid(7, n+1), one);
+	}
+}
+
+void TestStelProjector::benchmarkBatchProjection_data()
+{
+	QTest::addColumn<QString>("name");
+	QTest::addColumn<bool>("batch");
+	static const char* names[] = {"Perspective", "Stereographic", "Hammer"};
+	for (unsigned int i=0; i<sizeof(names)/sizeof(names[0]); ++i)
+	{
+		QTest::newRow(qPrintable(QString("%1 scalar").arg(names[i]))) << QString(names[i]) << false;
+		QTest::newRow(qPrintable(QString("%1 batch").arg(names[i]))) << QString(names[i]) << true;
+	}
+}
+
+void TestStelProjector::benchmarkBatchProjection()
+{
+	QFETCH(QString, name);
+	QFETCH(bool, batch);
+	StelProjectorP prj = createProjector(name, StelProjector::ModelViewTranformP(new StelProjector::Mat4dTransform(rotation)));
+	QVector<Vec3f> out(NB_POINTS);
+	if (batch)
+	{
+		QBENCHMARK {
+			prj->project(NB_POINTS, points.constData(), out.data());
+		}
+	}
+	else
+	{
+		QBENCHMARK {
+			prj->StelProjector::project(NB_POINTS, points.constData(), out.data());
+		}
+	}
+}
@@ -0,0 +1,195 @@
+/*
+ * Stellarium
+ * Copyright (C) 2017 Stellarium Developers
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Suite 500, Boston, MA  02110-1335, USA.
+ */
+
+#include <QObject>
+#include <QtDebug>
+#include <QtTest>
+#include <QFontDatabase>
+#include <QPainter>
+
+#include "tests/testStelTextAtlas.hpp"
+#include "StelTextAtlas.hpp"
+
+QTEST_MAIN(TestStelTextAtlas)
+
+#define IMAGE_WIDTH 400
+#define IMAGE_HEIGHT 100
+
+//! Draw a string with QPainter into a transparent image, as the QPainter path of StelPainter::drawText.
+//! (x, y) are window coordinates, y going up.
+static QImage drawWithQPainter(const QString& str, const QFont& font, float x, float y, float xshift, float yshift)
+{
+	QImage image(IMAGE_WIDTH, IMAGE_HEIGHT, QImage::Format_ARGB32_Premultiplied);
+	image.fill(Qt::transparent);
+	QPainter painter(&image);
+	painter.setFont(font);
+	painter.setPen(Qt::white);
+	painter.drawText(QPointF(x+xshift, IMAGE_HEIGHT-y-yshift), str);
+	return image;
+}
+
+//! Compose a string from the glyph images of the atlas pages, placed as StelPainter::queueText places them.
+static QImage drawWithAtlas(StelTextAtlas& atlas, const QString& str, const QFont& font, float x, float y, float xshift, float yshift)
+{
+	QImage image(IMAGE_WIDTH, IMAGE_HEIGHT, QImage::Format_ARGB32_Premultiplied);
+	image.fill(Qt::transparent);
+	const StelTextAtlas::Layout* layout = atlas.getLayout(str, font);
+	if (!layout)
+		return image;
+	foreach (const StelTextAtlas::PlacedGlyph& placed, layout->glyphs)
+	{
+		Vec2f corners[4];
+		StelTextAtlas::getGlyphQuad(placed, x, y, xshift, yshift, false, 1.f, 0.f, corners);
+		const QImage& page = atlas.getPageImage(placed.glyph->page);
+		const QRect& rect = placed.glyph->pageRect;
+		const int left = qRound(corners[0][0]);
+		const int top = IMAGE_HEIGHT-qRound(corners[0][1]);
+		for (int j=0; j<rect.height(); ++j)
+		{
+			const int row = top+j;
+			if (row<0 || row>=IMAGE_HEIGHT)
+				continue;
+			const uchar* src = page.constScanLine(rect.top()+j) + 4*rect.left();
+			QRgb* dst = reinterpret_cast<QRgb*>(image.scanLine(row));
+			for (int i=0; i<rect.width(); ++i)
+			{
+				const int col = left+i;
+				if (col<0 || col>=IMAGE_WIDTH)
+					continue;
+				// Blending of white with the coverage, as done by StelPainter::flushText
+				const int a = src[4*i+3];
+				const int b = a + qAlpha(dst[col])*(255-a)/255;
+				dst[col] = qRgba(b, b, b, b);
+			}
+		}
+	}
+	return image;
+}
+
+void TestStelTextAtlas::initTestCase()
+{
+	haveFonts = !QFontDatabase().families().isEmpty();
+}
+
+void TestStelTextAtlas::testSameAsQPainter_data()
+{
+	QTest::addColumn<QString>("str");
+	QTest::addColumn<int>("pixelSize");
+	QTest::addColumn<float>("x");
+	QTest::addColumn<float>("y");
+	QTest::addColumn<float>("xshift");
+	QTest::addColumn<float>("yshift");
+
+	const QString strings[4] = {
+		QString("Polaris 12h34m"),
+		QString("AVATAR WAVE Ty"),
+		QString::fromUtf8("\xC3\x89ta Carin\xC3\xA6 \xC3\x85ngstr\xC3\xB6m"),
+		QString::fromUtf8("\xD0\x9F\xD0\xBE\xD0\xBB\xD1\x8F\xD1\x80\xD0\xBD\xD0\xB0\xD1\x8F")
+	};
+	const int sizes[2] = {12, 18};
+	for (int s=0; s<4; ++s)
+	{
+		for (int i=0; i<2; ++i)
+		{
+			QTest::newRow(qPrintable(QString("%1 %2px").arg(strings[s]).arg(sizes[i])))
+				<< strings[s] << sizes[i] << 20.f << 40.f << 0.f << 0.f;
+		}
+	}
+	QTest::newRow("shifted") << strings[0] << 14 << 31.f << 27.f << 5.f << -3.f;
+}
+
+void TestStelTextAtlas::testSameAsQPainter()
+{
+	if (!haveFonts)
+		QSKIP("No font installed");
+	QFETCH(QString, str);
+	QFETCH(int, pixelSize);
+	QFETCH(float, x);
+	QFETCH(float, y);
+	QFETCH(float, xshift);
+	QFETCH(float, yshift);
+
+	QFont font;
+	font.setPixelSize(pixelSize);
+	StelTextAtlas atlas;
+	const QImage expected = drawWithQPainter(str, font, x, y, xshift, yshift);
+	const QImage actual = drawWithAtlas(atlas, str, font, x, y, xshift, yshift);
+
+	qint64 sumExpected = 0, sumDiff = 0;
+	for (int row=0; row<IMAGE_HEIGHT; ++row)
+	{
+		const QRgb* e = reinterpret_cast<const QRgb*>(expected.constScanLine(row));
+		const QRgb* a = reinterpret_cast<const QRgb*>(actual.constScanLine(row));
+		for (int col=0; col<IMAGE_WIDTH; ++col)
+		{
+			sumExpected += qAlpha(e[col]);
+			sumDiff += qAbs(qAlpha(e[col])-qAlpha(a[col]));
+		}
+	}
+	QVERIFY(sumExpected>0);
+	QVERIFY2(sumDiff<=sumExpected/20, qPrintable(QString("difference %1 of %2").arg(sumDiff).arg(sumExpected)));
+}
+
+void TestStelTextAtlas::testLayoutCache()
+{
+	if (!haveFonts)
+		QSKIP("No font installed");
+	QFont font;
+	font.setPixelSize(16);
+	StelTextAtlas atlas;
+	const StelTextAtlas::Layout* layout = atlas.getLayout("Sirius", font);
+	QVERIFY(layout!=Q_NULLPTR);
+	QCOMPARE(layout->glyphs.size(), 6);
+	const int rendered = atlas.getRenderedGlyphCount();
+	QVERIFY(rendered>0 && rendered<=6);
+	QCOMPARE(atlas.getLayout("Sirius", font), layout);
+	// The glyphs of another string are shared
+	QVERIFY(atlas.getLayout("Iris", font)!=Q_NULLPTR);
+	QCOMPARE(atlas.getRenderedGlyphCount(), rendered);
+	// Spaces only move the pen
+	QCOMPARE(atlas.getLayout("Si ri us", font)->glyphs.size(), 6);
+	QCOMPARE(atlas.getRenderedGlyphCount(), rendered);
+}
+
+void TestStelTextAtlas::testClearWhenFull()
+{
+	if (!haveFonts)
+		QSKIP("No font installed");
+	QString str;
+	for (int c=33; c<127; ++c)
+		str += QChar(c);
+	StelTextAtlas atlas;
+	QFont font;
+	bool full = false;
+	for (int pixelSize=40; pixelSize<400 && !full; pixelSize+=4)
+	{
+		font.setPixelSize(pixelSize);
+		full = atlas.getLayout(str, font)==Q_NULLPTR;
+	}
+	QVERIFY(full);
+	QCOMPARE(atlas.getPageCount(), (int)StelTextAtlas::MaxPages);
+
+	atlas.clear();
+	QCOMPARE(atlas.getPageCount(), 0);
+	font.setPixelSize(16);
+	const StelTextAtlas::Layout* layout = atlas.getLayout(str, font);
+	QVERIFY(layout!=Q_NULLPTR);
+	QCOMPARE(layout->glyphs.size(), str.size());
+	QCOMPARE(atlas.getPageCount(), 1);
+}
@@ -0,0 +1,44 @@
+/*
+ * Stellarium
+ * Copyright (C) 2017 Stellarium Developers
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Suite 500, Boston, MA  02110-1335, USA.
+ */
+
+#ifndef _TESTSTELTEXTATLAS_HPP_
+#define _TESTSTELTEXTATLAS_HPP_
+
+#include <QObject>
+#include <QFont>
+#include <QImage>
+#include <QTest>
+
+//! Compare the strings drawn from the glyph atlas of StelPainter with the same strings drawn with
+//! QPainter, and check the caching of the atlas. Needs no display with QT_QPA_PLATFORM=offscreen.
+//! The tests are skipped if no font is installed.
+class TestStelTextAtlas : public QObject
+{
+Q_OBJECT
+private slots:
+	void initTestCase();
+	void testSameAsQPainter_data();
+	void testSameAsQPainter();
+	void testLayoutCache();
+	void testClearWhenFull();
+private:
+	bool haveFonts;
+};
+
+#endif // _TESTSTELTEXTATLAS_HPP_
@@ -0,0 +1,168 @@
+/*
+ * Stellarium
+ * Copyright (C) 2017 Stellarium Developers
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Suite 500, Boston, MA  02110-1335, USA.
+ */
+
+#include <QObject>
+#include <QtDebug>
+#include <QtTest>
+#include <QDateTime>
+#include <QTimeZone>
+
+#include "tests/testStelUTCOffsetTable.hpp"
+#include "StelUTCOffsetTable.hpp"
+#include "StelUtils.hpp"
+
+QTEST_GUILESS_MAIN(TestStelUTCOffsetTable)
+
+// Zones with DST in both hemispheres, without DST, with DST abolished, and with a skipped day (Apia, 2011)
+static const char* zones[] = {"Europe/Paris", "America/New_York", "Australia/Sydney", "Asia/Kolkata",
+			      "America/Sao_Paulo", "Pacific/Apia", "Europe/Moscow"};
+static const int nrOfZones = sizeof(zones)/sizeof(zones[0]);
+
+// Julian day (UT) of a date given in milliseconds since 1970-01-01T00:00:00 UTC
+static double toJD(qint64 msecs)
+{
+	return 2440587.5 + msecs/86400000.;
+}
+
+// Offset computed by QTimeZone, as by StelCore::getUTCOffset() before StelUTCOffsetTable
+static int referenceOffset(const QTimeZone& tz, double JD, bool useDST)
+{
+	int year, month, day, hour, minute, second;
+	StelUtils::getDateFromJulianDay(JD, &year, &month, &day);
+	StelUtils::getTimeFromJulianDay(JD, &hour, &minute, &second);
+	if (year <= 0)
+		year = year - 1;
+	QDateTime universal(QDate(year, month, day), QTime(hour, minute, second), Qt::UTC);
+	if (!universal.isValid())
+		universal = QDateTime(QDate(-4710, month, day), QTime(hour, minute, second), Qt::UTC);
+	return useDST ? tz.offsetFromUtc(universal) : tz.standardTimeOffset(universal);
+}
+
+static void addZoneRows()
+{
+	QTest::addColumn<QString>("zone");
+	QTest::addColumn<bool>("useDST");
+	for (int i=0; i<nrOfZones; ++i)
+	{
+		QTest::newRow(qPrintable(QString("%1, DST").arg(zones[i]))) << QString(zones[i]) << true;
+		QTest::newRow(qPrintable(QString("%1, no DST").arg(zones[i]))) << QString(zones[i]) << false;
+	}
+}
+
+// Compare the offset of the table with the offset computed by QTimeZone
+#define COMPARE_OFFSET(table, tz, JD, useDST) \
+	QVERIFY2(table.getOffset(JD)==referenceOffset(tz, JD, useDST), \
+		 qPrintable(QString("JD %1 (%2): offset %3 s instead of %4 s").arg(JD, 0, 'f', 6) \
+			    .arg(StelUtils::julianDayToISO8601String(JD)).arg(table.getOffset(JD)).arg(referenceOffset(tz, JD, useDST))));
+
+void TestStelUTCOffsetTable::testTransitions_data()
+{
+	addZoneRows();
+}
+
+void TestStelUTCOffsetTable::testTransitions()
+{
+	QFETCH(QString, zone);
+	QFETCH(bool, useDST);
+	const QTimeZone tz(zone.toUtf8());
+	if (!tz.isValid())
+		QSKIP(qPrintable(QString("Time zone %1 is not available").arg(zone)));
+	StelUTCOffsetTable table;
+	table.build(zone, useDST);
+	QVERIFY(table.isValid());
+
+	// One second before, at and after each transition, and between transitions
+	const QDateTime begin(QDate(1900, 1, 1), QTime(0, 0, 0), Qt::UTC);
+	const QDateTime end(QDate(2100, 1, 1), QTime(0, 0, 0), Qt::UTC);
+	const QTimeZone::OffsetDataList transitions = tz.transitions(begin, end);
+	for (int i=0; i<transitions.size(); ++i)
+	{
+		const qint64 t = transitions.at(i).atUtc.toMSecsSinceEpoch();
+		COMPARE_OFFSET(table, tz, toJD(t-1000), useDST)
+		COMPARE_OFFSET(table, tz, toJD(t), useDST)
+		COMPARE_OFFSET(table, tz, toJD(t+1000), useDST)
+		if (i+1<transitions.size())
+			COMPARE_OFFSET(table, tz, toJD((t + transitions.at(i+1).atUtc.toMSecsSinceEpoch())/2), useDST)
+	}
+}
+
+void TestStelUTCOffsetTable::testTableEdges_data()
+{
+	addZoneRows();
+}
+
+void TestStelUTCOffsetTable::testTableEdges()
+{
+	QFETCH(QString, zone);
+	QFETCH(bool, useDST);
+	const QTimeZone tz(zone.toUtf8());
+	if (!tz.isValid())
+		QSKIP(qPrintable(QString("Time zone %1 is not available").arg(zone)));
+	StelUTCOffsetTable table;
+	table.build(zone, useDST);
+	QVERIFY(table.isValid());
+
+	const qint64 first = QDateTime(QDate(StelUTCOffsetTable::FirstYear, 1, 1), QTime(0, 0, 0), Qt::UTC).toMSecsSinceEpoch();
+	const qint64 last = QDateTime(QDate(StelUTCOffsetTable::LastYear+1, 1, 1), QTime(0, 0, 0), Qt::UTC).toMSecsSinceEpoch();
+	const qint64 edges[] = {first, last};
+	for (int e=0; e<2; ++e)
+	{
+		for (qint64 dt=-2000; dt<=2000; dt+=1000)
+			COMPARE_OFFSET(table, tz, toJD(edges[e]+dt), useDST)
+		// Half a year on each side, for the zones whose rules have DST at the edge
+		COMPARE_OFFSET(table, tz, toJD(edges[e]-Q_INT64_C(183)*86400000), useDST)
+		COMPARE_OFFSET(table, tz, toJD(edges[e]+Q_INT64_C(183)*86400000), useDST)
+	}
+	// Far outside the table
+	COMPARE_OFFSET(table, tz, 2268923.5, useDST) // in 1500
+	COMPARE_OFFSET(table, tz, 2634166.5, useDST) // in 2500, winter
+	COMPARE_OFFSET(table, tz, 2634350.5, useDST) // in 2500, summer
+}
+
+void TestStelUTCOffsetTable::testSampledDates_data()
+{
+	addZoneRows();
+}
+
+void TestStelUTCOffsetTable::testSampledDates()
+{
+	QFETCH(QString, zone);
+	QFETCH(bool, useDST);
+	const QTimeZone tz(zone.toUtf8());
+	if (!tz.isValid())
+		QSKIP(qPrintable(QString("Time zone %1 is not available").arg(zone)));
+	StelUTCOffsetTable table;
+	table.build(zone, useDST);
+	QVERIFY(table.isValid());
+
+	// Every 97 days and a few hours from 1590 to 2210, so that all seasons and times of the day are sampled.
+	for (double JD=2301701.5; JD<2528600.; JD+=97.123457)
+		COMPARE_OFFSET(table, tz, JD, useDST)
+}
+
+void TestStelUTCOffsetTable::testInvalidZone()
+{
+	StelUTCOffsetTable table;
+	table.build("Not/A_Zone", true);
+	QVERIFY(!table.isValid());
+	// The zone can be changed after a build.
+	table.build("UTC", false);
+	QVERIFY(table.isValid());
+	QCOMPARE(table.getOffset(2458000.), 0);
+}